@@ -0,0 +1,459 @@
+#include "AssetCooker.h"
+#include "ShaderCookStep.h"
+#include "TextureCookStep.h"
+#include "CubemapCookStep.h"
+#include "../../UnheardEngine.h"
+#include "../../Runtime/Classes/AssetPath.h"
+#include "../../Runtime/Classes/Shader.h"
+#include "../../Runtime/Classes/DerivedDataCache.h"
+#include "../../Runtime/Classes/Thread.h"
+#include "../../Runtime/Engine/Config.h"
+#include "../../Runtime/Engine/Graphic.h"
+#include "../../Runtime/Engine/GameTimer.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+
+UHAssetCooker::UHAssetCooker(const UHCookSettings& InSettings)
+	: Settings(InSettings)
+	, Config(nullptr)
+	, Gfx(nullptr)
+{
+
+}
+
+UHAssetCooker::~UHAssetCooker()
+{
+	ReleaseGraphics();
+}
+
+// command line: [-root path] [-jobs N] [-force] [-dxc path] [-report path] [-gpu name] [-noshaders] [-notextures] [-nocubemaps]
+bool UHAssetCooker::ParseCommandLine(int32_t ArgC, char* ArgV[], UHCookSettings& OutSettings)
+{
+	for (int32_t Idx = 1; Idx < ArgC; Idx++)
+	{
+		const std::string Arg = ArgV[Idx];
+		const bool bHasValue = Idx + 1 < ArgC;
+
+		try
+		{
+			if (Arg == "-root" && bHasValue)
+			{
+				OutSettings.RootPath = ArgV[++Idx];
+			}
+			else if (Arg == "-jobs" && bHasValue)
+			{
+				OutSettings.NumThreads = std::stoi(ArgV[++Idx]);
+			}
+			else if (Arg == "-force")
+			{
+				OutSettings.bForce = true;
+			}
+			else if (Arg == "-dxc" && bHasValue)
+			{
+				OutSettings.CompilerPath = ArgV[++Idx];
+			}
+			else if (Arg == "-report" && bHasValue)
+			{
+				OutSettings.ReportPath = ArgV[++Idx];
+			}
+			else if (Arg == "-gpu" && bHasValue)
+			{
+				OutSettings.GpuName = ArgV[++Idx];
+			}
+			else if (Arg == "-noshaders")
+			{
+				OutSettings.bCookShaders = false;
+			}
+			else if (Arg == "-notextures")
+			{
+				OutSettings.bCookTextures = false;
+			}
+			else if (Arg == "-nocubemaps")
+			{
+				OutSettings.bCookCubemaps = false;
+			}
+			else
+			{
+				UHE_LOG("Unknown or incomplete argument: " + Arg + "\n");
+				return false;
+			}
+		}
+		catch (const std::exception&)
+		{
+			UHE_LOG("Invalid value for argument: " + Arg + "\n");
+			return false;
+		}
+	}
+
+	if (OutSettings.NumThreads < 0)
+	{
+		UHE_LOG("Cook needs a non-negative job count!\n");
+		return false;
+	}
+
+	if (!std::filesystem::is_directory(OutSettings.RootPath))
+	{
+		UHE_LOG("Cook root " + OutSettings.RootPath.generic_string() + " isn't a directory!\n");
+		return false;
+	}
+
+	// the Linux DXC ships with the Vulkan SDK, fall back to PATH lookup
+	if (OutSettings.CompilerPath.empty())
+	{
+		const char* VulkanSDK = std::getenv("VULKAN_SDK");
+		const std::filesystem::path SDKCompiler = VulkanSDK ? std::filesystem::path(VulkanSDK) / "bin" / "dxc" : std::filesystem::path();
+		OutSettings.CompilerPath = (!SDKCompiler.empty() && std::filesystem::exists(SDKCompiler)) ? SDKCompiler : std::filesystem::path("dxc");
+	}
+
+	// report path is relative to where the cooker is launched, not the root
+	if (OutSettings.ReportPath.is_relative())
+	{
+		OutSettings.ReportPath = std::filesystem::absolute(OutSettings.ReportPath);
+	}
+
+	return true;
+}
+
+bool UHAssetCooker::Run()
+{
+	GMainThreadID = std::this_thread::get_id();
+	GCurrentThreadID = GMainThreadID;
+	std::filesystem::current_path(Settings.RootPath);
+
+	const UHClock::time_point StartTime = UHClock::now();
+	if (!Settings.bForce)
+	{
+		Database.Load(GCookDatabasePath);
+	}
+
+	// the derived data cache turns cold cooks into cache hits, e.g. on a fresh checkout or another branch
+	Config = MakeUnique<UHConfigManager>();
+	Config->LoadConfig();
+	GDerivedDataCache.Initialize(Config->EngineSetting());
+
+	// texture compression needs the block compression shaders, make sure they're cooked even if the editor never recorded them
+	std::vector<UniquePtr<UHShader>> CompressionShaders;
+	if (Settings.bCookTextures)
+	{
+		CompressionShaders = UHTextureCookStep::CreateCompressionShaders();
+	}
+
+	bool bStepFailed = false;
+	if (Settings.bCookShaders)
+	{
+		UHShaderCookStep ShaderStep(Settings.CompilerPath);
+		for (const UniquePtr<UHShader>& Shader : CompressionShaders)
+		{
+			ShaderStep.AddShader(*Shader);
+		}
+
+		RunStep(&ShaderStep);
+		Database.Save(GCookDatabasePath);
+	}
+
+	if (Settings.bCookTextures)
+	{
+		if (InitGraphics())
+		{
+			bool bCompressionAvailable = true;
+			for (const UniquePtr<UHShader>& Shader : CompressionShaders)
+			{
+				bCompressionAvailable &= std::filesystem::exists(Shader->GetOutputPath());
+			}
+
+			UHTextureCookStep TextureStep(Gfx.get());
+			TextureStep.SetCompressionAvailable(bCompressionAvailable);
+			RunStep(&TextureStep);
+			Database.Save(GCookDatabasePath);
+		}
+		else
+		{
+			UHE_LOG("Can't initialize offscreen graphic device, textures are skipped!\n");
+			bStepFailed = true;
+		}
+		ReleaseGraphics();
+	}
+
+	// cube lighting is baked on CPU, no device is needed
+	if (Settings.bCookCubemaps)
+	{
+		UHCubemapCookStep CubemapStep;
+		RunStep(&CubemapStep);
+		Database.Save(GCookDatabasePath);
+	}
+
+	GDerivedDataCache.Release();
+	const float WallTimeMS = std::chrono::duration<float, std::milli>(UHClock::now() - StartTime).count();
+	PrintSummary(WallTimeMS);
+	WriteReport(WallTimeMS);
+
+	const bool bAssetFailed = std::any_of(Results.begin(), Results.end(), [](const UHCookResult& InResult)
+		{
+			return InResult.Status == UHCookStatus::Failed;
+		});
+
+	return !bStepFailed && !bAssetFailed;
+}
+
+bool UHAssetCooker::InitGraphics()
+{
+	// texture cooking only needs a device for transfer and compute, there is no window or swap chain
+	GIsOffscreen = true;
+	GIsHeadless = true;
+
+	Config->RenderingSetting().bEnableRayTracing = false;
+	if (!Settings.GpuName.empty())
+	{
+		Config->RenderingSetting().SelectedGpuName = Settings.GpuName;
+	}
+
+	// asset manager is only used by the editor to compile shaders on request, the cooker compiles them beforehand
+	Gfx = MakeUnique<UHGraphic>(nullptr, Config.get());
+	return Gfx->InitGraphics(nullptr);
+}
+
+void UHAssetCooker::ReleaseGraphics()
+{
+	if (Gfx != nullptr)
+	{
+		Gfx->Release();
+		Gfx.reset();
+	}
+}
+
+void UHAssetCooker::RunStep(UHCookStep* InStep)
+{
+	std::vector<UHCookJob> Jobs;
+	InStep->CollectJobs(Jobs);
+	if (Jobs.size() == 0)
+	{
+		UHE_LOG("No " + InStep->GetTypeName() + " to cook.\n");
+		return;
+	}
+
+	const uint32_t NumCores = (std::max)(std::thread::hardware_concurrency(), 1u);
+	const uint32_t NumThreads = std::min(Settings.NumThreads > 0 ? static_cast<uint32_t>(Settings.NumThreads) : NumCores
+		, static_cast<uint32_t>(Jobs.size()));
+	UHE_LOG("Cooking " + std::to_string(Jobs.size()) + " " + InStep->GetTypeName() + " assets with " + std::to_string(NumThreads) + " threads...\n");
+
+	std::vector<UHCookResult> StepResults(Jobs.size());
+	std::atomic<size_t> NumFinished = 0;
+
+	UHParallelFor(static_cast<uint32_t>(Jobs.size()), [&](uint32_t Idx)
+		{
+			CookJob(InStep, Jobs[Idx], StepResults[Idx]);
+			const size_t Finished = ++NumFinished;
+
+			// up to date assets are quiet
+			const UHCookResult& Result = StepResults[Idx];
+			if (Result.Status != UHCookStatus::UpToDate)
+			{
+				char Progress[64];
+				snprintf(Progress, sizeof(Progress), "[%zu/%zu] %s ", Finished, Jobs.size()
+					, Result.Status == UHCookStatus::Cooked ? "Cooked" : "Failed");
+
+				char Timing[64];
+				snprintf(Timing, sizeof(Timing), " (%.1f ms)\n", Result.HashMS + Result.CookMS);
+				UHE_LOG(Progress + Result.OutputPath.generic_string() + Timing + Result.Message);
+			}
+		}, NumThreads);
+
+	Results.insert(Results.end(), StepResults.begin(), StepResults.end());
+}
+
+void UHAssetCooker::CookJob(UHCookStep* InStep, UHCookJob& InJob, UHCookResult& OutResult)
+{
+	GCurrentThreadID = std::this_thread::get_id();
+	OutResult.TypeName = InStep->GetTypeName();
+	OutResult.OutputPath = InJob.OutputPath;
+
+	const UHClock::time_point HashStart = UHClock::now();
+	uint64_t InputHash = 0;
+	const bool bHashed = InStep->HashInputs(InJob, InputHash);
+	InJob.InputHash = InputHash;
+	const UHClock::time_point CookStart = UHClock::now();
+	OutResult.SourcePath = InJob.SourcePath;
+	OutResult.HashMS = std::chrono::duration<float, std::milli>(CookStart - HashStart).count();
+
+	if (!bHashed)
+	{
+		OutResult.Status = UHCookStatus::Failed;
+		OutResult.Message = "Input " + InJob.SourcePath.generic_string() + " is missing.\n";
+		Database.Remove(InJob.OutputPath);
+		return;
+	}
+
+	if (!Settings.bForce && Database.IsUpToDate(InJob.OutputPath, InputHash))
+	{
+		OutResult.Status = UHCookStatus::UpToDate;
+		return;
+	}
+
+	if (InStep->Cook(InJob, OutResult.Message))
+	{
+		OutResult.Status = UHCookStatus::Cooked;
+		Database.Update(InJob.OutputPath, InputHash);
+	}
+	else
+	{
+		OutResult.Status = UHCookStatus::Failed;
+		Database.Remove(InJob.OutputPath);
+	}
+
+	OutResult.CookMS = std::chrono::duration<float, std::milli>(UHClock::now() - CookStart).count();
+}
+
+static const char* GetStatusName(UHCookStatus InStatus)
+{
+	switch (InStatus)
+	{
+	case UHCookStatus::Cooked:
+		return "cooked";
+
+	case UHCookStatus::UpToDate:
+		return "up_to_date";
+
+	default:
+		return "failed";
+	}
+}
+
+void UHAssetCooker::PrintSummary(float InWallTimeMS) const
+{
+	size_t NumCooked = 0;
+	size_t NumUpToDate = 0;
+	size_t NumFailed = 0;
+	double TotalWorkMS = 0.0;
+
+	for (const UHCookResult& Result : Results)
+	{
+		NumCooked += Result.Status == UHCookStatus::Cooked ? 1 : 0;
+		NumUpToDate += Result.Status == UHCookStatus::UpToDate ? 1 : 0;
+		NumFailed += Result.Status == UHCookStatus::Failed ? 1 : 0;
+		TotalWorkMS += Result.HashMS + Result.CookMS;
+	}
+
+	char Summary[256];
+	snprintf(Summary, sizeof(Summary), "Cook finished in %.2f s: %zu cooked, %zu up to date, %zu failed, %.2f s of work over all threads\n"
+		, InWallTimeMS * 0.001f, NumCooked, NumUpToDate, NumFailed, TotalWorkMS * 0.001);
+	UHE_LOG(Summary);
+
+	// the slowest assets are usually what's worth looking at
+	std::vector<const UHCookResult*> Slowest;
+	for (const UHCookResult& Result : Results)
+	{
+		if (Result.Status == UHCookStatus::Cooked)
+		{
+			Slowest.push_back(&Result);
+		}
+	}
+
+	std::sort(Slowest.begin(), Slowest.end(), [](const UHCookResult* A, const UHCookResult* B)
+		{
+			return A->HashMS + A->CookMS > B->HashMS + B->CookMS;
+		});
+
+	const size_t NumSlowest = std::min<size_t>(Slowest.size(), 5);
+	for (size_t Idx = 0; Idx < NumSlowest; Idx++)
+	{
+		char Line[64];
+		snprintf(Line, sizeof(Line), "  %10.1f ms  ", Slowest[Idx]->HashMS + Slowest[Idx]->CookMS);
+		UHE_LOG(Line + Slowest[Idx]->OutputPath.generic_string() + "\n");
+	}
+}
+
+// escape the characters that can appear in paths and compiler messages
+// other control characters aren't allowed in JSON strings, e.g. the color codes of a compiler
+static std::string EscapeJson(const std::string& InString)
+{
+	std::string Escaped;
+	for (const char C : InString)
+	{
+		switch (C)
+		{
+		case '"':
+			Escaped += "\\\"";
+			break;
+		case '\\':
+			Escaped += "\\\\";
+			break;
+		case '\n':
+			Escaped += "\\n";
+			break;
+		case '\r':
+			break;
+		case '\t':
+			Escaped += "\\t";
+			break;
+		default:
+			if (static_cast<unsigned char>(C) < 0x20)
+			{
+				char Code[7];
+				snprintf(Code, sizeof(Code), "\\u%04x", static_cast<unsigned char>(C));
+				Escaped += Code;
+			}
+			else
+			{
+				Escaped += C;
+			}
+			break;
+		}
+	}
+
+	return Escaped;
+}
+
+bool UHAssetCooker::WriteReport(float InWallTimeMS) const
+{
+	std::filesystem::path JsonPath = Settings.ReportPath;
+	std::filesystem::path CsvPath = Settings.ReportPath;
+	JsonPath += ".json";
+	CsvPath += ".csv";
+
+	std::ofstream JsonOut(JsonPath, std::ios::out);
+	std::ofstream CsvOut(CsvPath, std::ios::out);
+	if (!JsonOut.is_open() || !CsvOut.is_open())
+	{
+		UHE_LOG("Failed to write cook report to " + Settings.ReportPath.generic_string() + "!\n");
+		return false;
+	}
+
+	JsonOut << "{\n";
+	JsonOut << "\t\"root\": \"" << EscapeJson(std::filesystem::current_path().generic_string()) << "\",\n";
+	JsonOut << "\t\"wall_time_ms\": " << InWallTimeMS << ",\n";
+	JsonOut << "\t\"forced\": " << (Settings.bForce ? "true" : "false") << ",\n";
+	JsonOut << "\t\"assets\": [\n";
+	CsvOut << "type,status,source,output,hash_ms,cook_ms,total_ms\n";
+
+	for (size_t Idx = 0; Idx < Results.size(); Idx++)
+	{
+		const UHCookResult& Result = Results[Idx];
+		const std::string Source = Result.SourcePath.generic_string();
+		const std::string Output = Result.OutputPath.generic_string();
+		const float TotalMS = Result.HashMS + Result.CookMS;
+
+		JsonOut << "\t\t{ \"type\": \"" << Result.TypeName << "\", \"status\": \"" << GetStatusName(Result.Status)
+			<< "\", \"source\": \"" << EscapeJson(Source) << "\", \"output\": \"" << EscapeJson(Output)
+			<< "\", \"hash_ms\": " << Result.HashMS << ", \"cook_ms\": " << Result.CookMS << ", \"total_ms\": " << TotalMS;
+		if (!Result.Message.empty())
+		{
+			JsonOut << ", \"message\": \"" << EscapeJson(Result.Message) << "\"";
+		}
+		JsonOut << " }" << (Idx + 1 < Results.size() ? ",\n" : "\n");
+
+		CsvOut << Result.TypeName << "," << GetStatusName(Result.Status) << ",\"" << Source << "\",\"" << Output << "\","
+			<< Result.HashMS << "," << Result.CookMS << "," << TotalMS << "\n";
+	}
+
+	JsonOut << "\t]\n";
+	JsonOut << "}\n";
+
+	JsonOut.close();
+	CsvOut.close();
+
+	UHE_LOG("Cook report written to " + JsonPath.generic_string() + " and " + CsvPath.generic_string() + "\n");
+	return true;
+}
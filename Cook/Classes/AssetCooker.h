@@ -0,0 +1,107 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <filesystem>
+#include "CookDatabase.h"
+#include "CookStep.h"
+#include "../../Runtime/CoreGlobals.h"
+
+class UHConfigManager;
+class UHGraphic;
+
+// cook settings, parsed from command line
+struct UHCookSettings
+{
+public:
+	UHCookSettings()
+		: RootPath(".")
+		, ReportPath("CookReport")
+		, NumThreads(0)
+		, bForce(false)
+		, bCookShaders(true)
+		, bCookTextures(true)
+		, bCookCubemaps(true)
+	{
+
+	}
+
+	// project root, the asset paths are relative to it
+	std::filesystem::path RootPath;
+
+	// DXC executable, empty uses VULKAN_SDK or PATH
+	std::filesystem::path CompilerPath;
+
+	// output without extension, .json and .csv will be written
+	std::filesystem::path ReportPath;
+
+	// 0 uses all cores
+	int32_t NumThreads;
+
+	// ignore the cook database and cook everything
+	bool bForce;
+
+	bool bCookShaders;
+	bool bCookTextures;
+	bool bCookCubemaps;
+
+	// override the selected GPU, e.g. "llvmpipe" for a software Vulkan device
+	std::string GpuName;
+};
+
+enum class UHCookStatus
+{
+	Cooked,
+	UpToDate,
+	Failed
+};
+
+// timing of a single asset
+struct UHCookResult
+{
+	UHCookResult()
+		: Status(UHCookStatus::Failed)
+		, HashMS(0.0f)
+		, CookMS(0.0f)
+	{
+
+	}
+
+	std::string TypeName;
+	std::filesystem::path SourcePath;
+	std::filesystem::path OutputPath;
+	UHCookStatus Status;
+	float HashMS;
+	float CookMS;
+	std::string Message;
+};
+
+// standalone asset cooker, runs without window and editor
+// the jobs of each step are spread over all cores, inputs are content-hashed so unchanged assets are skipped
+// a per-asset timing report is written at the end
+class UHAssetCooker
+{
+public:
+	UHAssetCooker(const UHCookSettings& InSettings);
+	~UHAssetCooker();
+
+	static bool ParseCommandLine(int32_t ArgC, char* ArgV[], UHCookSettings& OutSettings);
+
+	// return false if any asset failed to cook
+	bool Run();
+
+private:
+	bool InitGraphics();
+	void ReleaseGraphics();
+	void RunStep(UHCookStep* InStep);
+	void CookJob(UHCookStep* InStep, UHCookJob& InJob, UHCookResult& OutResult);
+	void PrintSummary(float InWallTimeMS) const;
+	bool WriteReport(float InWallTimeMS) const;
+
+	UHCookSettings Settings;
+	UHCookDatabase Database;
+	std::vector<UHCookResult> Results;
+
+	UniquePtr<UHConfigManager> Config;
+	UniquePtr<UHGraphic> Gfx;
+};
@@ -0,0 +1,112 @@
+#include "CookDatabase.h"
+#include "../../UnheardEngine.h"
+#include <fstream>
+
+UHCookDatabase::UHCookDatabase()
+{
+
+}
+
+bool UHCookDatabase::Load(const std::filesystem::path& InPath)
+{
+	std::unique_lock<std::mutex> Lock(RecordLock);
+	Records.clear();
+
+	std::ifstream FileIn(InPath, std::ios::in | std::ios::binary);
+	if (!FileIn.is_open())
+	{
+		// first cook, everything is out of date
+		return false;
+	}
+
+	uint32_t Magic = 0;
+	uint32_t Version = 0;
+	uint64_t NumRecords = 0;
+	FileIn.read(reinterpret_cast<char*>(&Magic), sizeof(Magic));
+	FileIn.read(reinterpret_cast<char*>(&Version), sizeof(Version));
+	FileIn.read(reinterpret_cast<char*>(&NumRecords), sizeof(NumRecords));
+
+	if (!FileIn || Magic != DatabaseMagic || Version != DatabaseVersion)
+	{
+		UHE_LOG("Cook database " + InPath.generic_string() + " is outdated, all assets will be cooked.\n");
+		return false;
+	}
+
+	for (uint64_t Idx = 0; Idx < NumRecords; Idx++)
+	{
+		std::string Output;
+		uint64_t InputHash = 0;
+		UHUtilities::ReadStringData(FileIn, Output);
+		FileIn.read(reinterpret_cast<char*>(&InputHash), sizeof(InputHash));
+
+		if (!FileIn)
+		{
+			UHE_LOG("Cook database " + InPath.generic_string() + " is truncated, all assets will be cooked.\n");
+			Records.clear();
+			return false;
+		}
+		Records[Output] = InputHash;
+	}
+
+	return true;
+}
+
+bool UHCookDatabase::Save(const std::filesystem::path& InPath) const
+{
+	std::unique_lock<std::mutex> Lock(RecordLock);
+
+	if (InPath.has_parent_path())
+	{
+		std::filesystem::create_directories(InPath.parent_path());
+	}
+
+	std::ofstream FileOut(InPath, std::ios::out | std::ios::binary);
+	if (!FileOut.is_open())
+	{
+		UHE_LOG("Failed to write cook database " + InPath.generic_string() + "!\n");
+		return false;
+	}
+
+	const uint32_t Magic = DatabaseMagic;
+	const uint32_t Version = DatabaseVersion;
+	const uint64_t NumRecords = Records.size();
+	FileOut.write(reinterpret_cast<const char*>(&Magic), sizeof(Magic));
+	FileOut.write(reinterpret_cast<const char*>(&Version), sizeof(Version));
+	FileOut.write(reinterpret_cast<const char*>(&NumRecords), sizeof(NumRecords));
+
+	for (const auto& Record : Records)
+	{
+		UHUtilities::WriteStringData(FileOut, Record.first);
+		FileOut.write(reinterpret_cast<const char*>(&Record.second), sizeof(Record.second));
+	}
+
+	FileOut.close();
+	return true;
+}
+
+bool UHCookDatabase::IsUpToDate(const std::filesystem::path& InOutput, uint64_t InHash) const
+{
+	{
+		std::unique_lock<std::mutex> Lock(RecordLock);
+		auto Iter = Records.find(InOutput.generic_string());
+		if (Iter == Records.end() || Iter->second != InHash)
+		{
+			return false;
+		}
+	}
+
+	// the output could be deleted after it's cooked
+	return std::filesystem::exists(InOutput);
+}
+
+void UHCookDatabase::Update(const std::filesystem::path& InOutput, uint64_t InHash)
+{
+	std::unique_lock<std::mutex> Lock(RecordLock);
+	Records[InOutput.generic_string()] = InHash;
+}
+
+void UHCookDatabase::Remove(const std::filesystem::path& InOutput)
+{
+	std::unique_lock<std::mutex> Lock(RecordLock);
+	Records.erase(InOutput.generic_string());
+}
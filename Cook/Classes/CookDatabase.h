@@ -0,0 +1,31 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <filesystem>
+#include <unordered_map>
+#include <mutex>
+#include "../../Runtime/Classes/DerivedDataCache.h"
+
+// incremental cook database, maps an output path to the content hash of the inputs it was cooked from
+// an output is up to date when the hash matches and the file still exists
+class UHCookDatabase
+{
+public:
+	UHCookDatabase();
+
+	bool Load(const std::filesystem::path& InPath);
+	bool Save(const std::filesystem::path& InPath) const;
+
+	// thread-safe
+	bool IsUpToDate(const std::filesystem::path& InOutput, uint64_t InHash) const;
+	void Update(const std::filesystem::path& InOutput, uint64_t InHash);
+	void Remove(const std::filesystem::path& InOutput);
+
+private:
+	// bump when the cook output of any asset type changes, this invalidates all records
+	static constexpr uint32_t DatabaseVersion = 2;
+	static constexpr uint32_t DatabaseMagic = 0x42444355;
+
+	std::unordered_map<std::string, uint64_t> Records;
+	mutable std::mutex RecordLock;
+};
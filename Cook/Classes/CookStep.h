@@ -0,0 +1,39 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <filesystem>
+
+// a single asset to cook, Index refers to the data kept by the step that collected it
+struct UHCookJob
+{
+	UHCookJob()
+		: Index(0)
+		, InputHash(0)
+	{
+
+	}
+
+	std::filesystem::path SourcePath;
+	std::filesystem::path OutputPath;
+	size_t Index;
+
+	// content hash of the inputs, set after HashInputs
+	uint64_t InputHash;
+};
+
+// a cookable asset type
+// jobs are collected on the main thread, then hashed and cooked on the worker threads
+class UHCookStep
+{
+public:
+	virtual ~UHCookStep() {}
+
+	virtual std::string GetTypeName() const = 0;
+	virtual void CollectJobs(std::vector<UHCookJob>& OutJobs) = 0;
+
+	// hash everything the output depends on, return false if an input is missing
+	// steps that only know the source after loading the asset fill it here
+	virtual bool HashInputs(UHCookJob& InOutJob, uint64_t& OutHash) = 0;
+	virtual bool Cook(const UHCookJob& InJob, std::string& OutMessage) = 0;
+};
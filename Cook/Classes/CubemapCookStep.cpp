@@ -0,0 +1,82 @@
+#include "CubemapCookStep.h"
+#include "../../Runtime/Classes/DerivedDataCache.h"
+#include "../../UnheardEngine.h"
+#include "../../Runtime/Classes/AssetPath.h"
+#include "../../Runtime/Classes/TextureCube.h"
+
+std::string UHCubemapCookStep::GetTypeName() const
+{
+	return "Cubemap";
+}
+
+void UHCubemapCookStep::CollectJobs(std::vector<UHCookJob>& OutJobs)
+{
+	if (!std::filesystem::exists(GTextureAssetFolder))
+	{
+		return;
+	}
+
+	for (std::filesystem::recursive_directory_iterator Idx(GTextureAssetFolder), End; Idx != End; Idx++)
+	{
+		if (std::filesystem::is_directory(Idx->path()) || !UHAssetPath::IsTheSameExtension(Idx->path(), GCubemapAssetExtension))
+		{
+			continue;
+		}
+
+		// the cube is both the source and the output, its slices are the input
+		UHCookJob Job;
+		Job.SourcePath = Idx->path();
+		Job.OutputPath = Idx->path();
+		OutJobs.push_back(Job);
+	}
+}
+
+bool UHCubemapCookStep::HashInputs(UHCookJob& InOutJob, uint64_t& OutHash)
+{
+	// the slices can be large, the cube isn't kept until cooking since most cubes are up to date
+	UniquePtr<UHTextureCube> Cube = MakeUnique<UHTextureCube>();
+	if (!Cube->Import(InOutJob.OutputPath))
+	{
+		return false;
+	}
+
+	// the baked lighting is the output, only the slices and what shapes the bake are hashed
+	// so a cube written back by the last cook stays up to date
+	UHContentHasher Hasher;
+	for (int32_t Idx = 0; Idx < 6; Idx++)
+	{
+		Hasher.UpdateVector(Cube->GetCubeData(Idx));
+	}
+
+	const VkExtent2D Extent = Cube->GetExtent();
+	Hasher.UpdateValue(Extent.width);
+	Hasher.UpdateValue(Extent.height);
+	Hasher.UpdateValue(Cube->GetFormat());
+	Hasher.UpdateValue(Cube->GetTextureSettings().bUseMipmap);
+	Hasher.UpdateValue(UHCubemapBaker::GetVersion());
+
+	OutHash = Hasher.GetHash();
+	return true;
+}
+
+bool UHCubemapCookStep::Cook(const UHCookJob& InJob, std::string& OutMessage)
+{
+	UniquePtr<UHTextureCube> Cube = MakeUnique<UHTextureCube>();
+	if (!Cube->Import(InJob.OutputPath))
+	{
+		OutMessage = "Failed to load the cube.\n";
+		return false;
+	}
+
+	if (!Cube->BakeLighting())
+	{
+		OutMessage = "The cube isn't square or its format can't be decoded on CPU.\n";
+		return false;
+	}
+
+	// Export() appends the extension
+	std::filesystem::path OutputPathName = InJob.OutputPath;
+	OutputPathName.replace_extension();
+	Cube->Export(OutputPathName);
+	return true;
+}
@@ -0,0 +1,13 @@
+#pragma once
+#include "CookStep.h"
+
+// bakes SH9 and the prefiltered mips of the cubemap assets, the result is written back to the same .uhcubemap
+// the baker runs on CPU, so this step doesn't need a graphic device
+class UHCubemapCookStep : public UHCookStep
+{
+public:
+	virtual std::string GetTypeName() const override;
+	virtual void CollectJobs(std::vector<UHCookJob>& OutJobs) override;
+	virtual bool HashInputs(UHCookJob& InOutJob, uint64_t& OutHash) override;
+	virtual bool Cook(const UHCookJob& InJob, std::string& OutMessage) override;
+};
@@ -0,0 +1,290 @@
+#include "ShaderCookStep.h"
+#include "../../Runtime/Classes/DerivedDataCache.h"
+#include "../../UnheardEngine.h"
+#include "../../Runtime/Classes/AssetPath.h"
+#include "../../Runtime/Classes/Shader.h"
+#include <fstream>
+#include <unordered_set>
+#include <fcntl.h>
+#include <spawn.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+extern char** environ;
+
+UHShaderCookStep::UHShaderCookStep(const std::filesystem::path& InCompilerPath)
+	: CompilerPath(InCompilerPath)
+	, IncludeHash(0)
+	, CompilerHash(0)
+{
+
+}
+
+void UHShaderCookStep::AddShader(const UHShader& InShader)
+{
+	UHShaderPermutation Permutation;
+	Permutation.SourcePath = InShader.GetSourcePath();
+	Permutation.OutputPath = InShader.GetOutputPath();
+	Permutation.EntryName = InShader.GetEntryName();
+	Permutation.ProfileName = InShader.GetProfileName();
+	Permutation.Defines = InShader.GetShaderDefines();
+	Permutation.ShaderHash = InShader.GetShaderHash();
+	Permutations.push_back(Permutation);
+}
+
+std::string UHShaderCookStep::GetTypeName() const
+{
+	return "Shader";
+}
+
+// the compiler can be a bare name that is looked up in PATH, find the binary so it can be hashed
+static std::filesystem::path FindCompilerBinary(const std::filesystem::path& InCompilerPath)
+{
+	std::error_code Error;
+	const char* SearchPaths = getenv("PATH");
+	if (InCompilerPath.has_parent_path() || std::filesystem::exists(InCompilerPath, Error) || SearchPaths == nullptr)
+	{
+		return InCompilerPath;
+	}
+
+	std::string Paths = SearchPaths;
+	size_t Start = 0;
+	while (Start <= Paths.size())
+	{
+		size_t End = Paths.find(':', Start);
+		if (End == std::string::npos)
+		{
+			End = Paths.size();
+		}
+
+		const std::filesystem::path Candidate = std::filesystem::path(Paths.substr(Start, End - Start)) / InCompilerPath;
+		if (End > Start && std::filesystem::is_regular_file(Candidate, Error))
+		{
+			// follow the symlink, package managers link the binary from elsewhere and the library sits next to the real one
+			const std::filesystem::path Resolved = std::filesystem::canonical(Candidate, Error);
+			return Error ? Candidate : Resolved;
+		}
+		Start = End + 1;
+	}
+
+	return InCompilerPath;
+}
+
+void UHShaderCookStep::CollectJobs(std::vector<UHCookJob>& OutJobs)
+{
+	LoadShaderCaches();
+	IncludeHash = UHShader::HashShaderIncludes();
+	CompilerHash = UHShader::HashShaderCompiler(FindCompilerBinary(CompilerPath));
+
+	std::unordered_set<std::string> AddedOutputs;
+	for (size_t Idx = 0; Idx < Permutations.size(); Idx++)
+	{
+		// the same permutation can be both recorded and required
+		if (!AddedOutputs.insert(Permutations[Idx].OutputPath.generic_string()).second)
+		{
+			continue;
+		}
+
+		UHCookJob Job;
+		Job.SourcePath = Permutations[Idx].SourcePath;
+		Job.OutputPath = Permutations[Idx].OutputPath;
+		Job.Index = Idx;
+		OutJobs.push_back(Job);
+	}
+}
+
+bool UHShaderCookStep::HashInputs(UHCookJob& InOutJob, uint64_t& OutHash)
+{
+	const UHShaderPermutation& Permutation = Permutations[InOutJob.Index];
+	return UHShader::HashCompileInputs(Permutation.SourcePath, Permutation.EntryName, Permutation.ProfileName, Permutation.Defines
+		, IncludeHash, CompilerHash, OutHash);
+}
+
+// run the compiler and collect its output, the arguments are passed as-is so paths with whitespace don't need quotes
+static bool RunCompiler(const std::filesystem::path& InCompilerPath, const std::vector<std::string>& InArgs, std::string& OutLog)
+{
+	const std::string Compiler = InCompilerPath.generic_string();
+	std::vector<char*> ArgV;
+	ArgV.push_back(const_cast<char*>(Compiler.c_str()));
+	for (const std::string& Arg : InArgs)
+	{
+		ArgV.push_back(const_cast<char*>(Arg.c_str()));
+	}
+	ArgV.push_back(nullptr);
+
+	// close-on-exec, otherwise compilers spawned by other workers inherit the write end and the read never ends
+	int32_t Pipe[2];
+	if (pipe2(Pipe, O_CLOEXEC) != 0)
+	{
+		OutLog = "Failed to create pipe for the shader compiler.\n";
+		return false;
+	}
+
+	// redirect both stdout and stderr of the child to the pipe
+	posix_spawn_file_actions_t Actions;
+	posix_spawn_file_actions_init(&Actions);
+	posix_spawn_file_actions_addclose(&Actions, Pipe[0]);
+	posix_spawn_file_actions_adddup2(&Actions, Pipe[1], STDOUT_FILENO);
+	posix_spawn_file_actions_adddup2(&Actions, Pipe[1], STDERR_FILENO);
+	posix_spawn_file_actions_addclose(&Actions, Pipe[1]);
+
+	pid_t ProcessId = 0;
+	const int32_t SpawnResult = posix_spawnp(&ProcessId, Compiler.c_str(), &Actions, nullptr, ArgV.data(), environ);
+	posix_spawn_file_actions_destroy(&Actions);
+	close(Pipe[1]);
+
+	if (SpawnResult != 0)
+	{
+		close(Pipe[0]);
+		OutLog = "Failed to launch " + Compiler + ", set it with -dxc or VULKAN_SDK.\n";
+		return false;
+	}
+
+	char Buffer[2048];
+	ssize_t BytesRead = 0;
+	while ((BytesRead = read(Pipe[0], Buffer, sizeof(Buffer))) > 0)
+	{
+		OutLog.append(Buffer, static_cast<size_t>(BytesRead));
+	}
+	close(Pipe[0]);
+
+	int32_t Status = 0;
+	if (waitpid(ProcessId, &Status, 0) != ProcessId)
+	{
+		return false;
+	}
+
+	// warnings are printed as well, so the exit code decides the result instead of the output
+	return WIFEXITED(Status) && WEXITSTATUS(Status) == 0;
+}
+
+bool UHShaderCookStep::Cook(const UHCookJob& InJob, std::string& OutMessage)
+{
+	const UHShaderPermutation& Permutation = Permutations[InJob.Index];
+
+	// the key is built the same way as the editor's, so SPIR-V is shared between machines with the same compiler build
+	const std::string DerivedDataKey = UHShader::MakeDerivedDataKey(InJob.InputHash);
+	if (GDerivedDataCache.GetFile(DerivedDataKey, Permutation.OutputPath))
+	{
+		WriteShaderCache(Permutation);
+		return true;
+	}
+
+	std::error_code Error;
+	std::filesystem::create_directories(Permutation.OutputPath.parent_path(), Error);
+
+	// the same options as the editor's compile
+	std::vector<std::string> Args = { "-spirv"
+		, "-T", Permutation.ProfileName
+		, "-E", Permutation.EntryName
+		, std::filesystem::absolute(Permutation.SourcePath).generic_string()
+		, "-Fo", std::filesystem::absolute(Permutation.OutputPath).generic_string()
+		, "-HV", "2018"
+		, "-fvk-use-dx-layout"
+		, "-fvk-use-dx-position-w"
+		, "-fspv-target-env=vulkan1.2" };
+
+	// mesh shader extension
+	if (UHUtilities::StringFind(Permutation.ProfileName, "as_") || UHUtilities::StringFind(Permutation.ProfileName, "ms_"))
+	{
+		Args.push_back("-fspv-extension=SPV_EXT_mesh_shader");
+		Args.push_back("-fspv-extension=SPV_EXT_descriptor_indexing");
+	}
+
+	for (const std::string& Define : Permutation.Defines)
+	{
+		Args.push_back("-D");
+		Args.push_back(Define);
+	}
+
+	std::string CompilerLog;
+	if (!RunCompiler(CompilerPath, Args, CompilerLog) || !std::filesystem::exists(Permutation.OutputPath))
+	{
+		OutMessage = CompilerLog;
+		return false;
+	}
+
+	// keep the editor's shader cache in sync, so the editor doesn't compile it again
+	GDerivedDataCache.PutFile(DerivedDataKey, Permutation.OutputPath);
+	WriteShaderCache(Permutation);
+	return true;
+}
+
+void UHShaderCookStep::LoadShaderCaches()
+{
+	if (!std::filesystem::exists(GRawShaderCachePath))
+	{
+		return;
+	}
+
+	// same layout as the editor's shader importer
+	for (std::filesystem::recursive_directory_iterator Idx(GRawShaderCachePath), End; Idx != End; Idx++)
+	{
+		if (std::filesystem::is_directory(Idx->path()) || !UHAssetPath::IsTheSameExtension(Idx->path(), GShaderAssetCacheExtension))
+		{
+			continue;
+		}
+
+		std::ifstream FileIn(Idx->path(), std::ios::in | std::ios::binary);
+
+		UHShaderPermutation Permutation;
+		std::string TempString;
+		int64_t SourceLastModifiedTime = 0;
+
+		UHUtilities::ReadStringData(FileIn, TempString);
+		Permutation.SourcePath = TempString;
+		FileIn.read(reinterpret_cast<char*>(&SourceLastModifiedTime), sizeof(SourceLastModifiedTime));
+		UHUtilities::ReadStringData(FileIn, TempString);
+		Permutation.OutputPath = TempString;
+		UHUtilities::ReadStringData(FileIn, Permutation.EntryName);
+		UHUtilities::ReadStringData(FileIn, Permutation.ProfileName);
+		UHUtilities::ReadStringVectorData(FileIn, Permutation.Defines);
+		FileIn.read(reinterpret_cast<char*>(&Permutation.ShaderHash), sizeof(Permutation.ShaderHash));
+		FileIn.close();
+
+		// include caches have no entry
+		if (Permutation.EntryName.empty() || Permutation.ProfileName.empty())
+		{
+			continue;
+		}
+
+		// material shaders are output to a different path than the hash name of the source
+		const std::filesystem::path CommonOutputPath = GShaderAssetFolder + UHAssetPath::GetShaderOriginSubpath(Permutation.SourcePath)
+			+ std::to_string(Permutation.ShaderHash) + GShaderAssetExtension;
+		if (Permutation.OutputPath != CommonOutputPath)
+		{
+			continue;
+		}
+
+		if (!std::filesystem::exists(Permutation.SourcePath))
+		{
+			UHE_LOG("Shader source " + Permutation.SourcePath.generic_string() + " no longer exists, skipped.\n");
+			continue;
+		}
+
+		Permutations.push_back(Permutation);
+	}
+}
+
+void UHShaderCookStep::WriteShaderCache(const UHShaderPermutation& InPermutation) const
+{
+	const std::string OriginSubpath = UHAssetPath::GetShaderOriginSubpath(InPermutation.SourcePath);
+	std::error_code Error;
+	std::filesystem::create_directories(GRawShaderCachePath + OriginSubpath, Error);
+
+	std::ofstream FileOut(GRawShaderCachePath + OriginSubpath + std::to_string(InPermutation.ShaderHash) + GShaderAssetCacheExtension
+		, std::ios::out | std::ios::binary);
+
+	const int64_t SourceLastModifiedTime = std::filesystem::last_write_time(InPermutation.SourcePath).time_since_epoch().count();
+	std::vector<std::string> Defines = InPermutation.Defines;
+
+	UHUtilities::WriteStringData(FileOut, InPermutation.SourcePath.generic_string());
+	FileOut.write(reinterpret_cast<const char*>(&SourceLastModifiedTime), sizeof(SourceLastModifiedTime));
+	UHUtilities::WriteStringData(FileOut, InPermutation.OutputPath.generic_string());
+	UHUtilities::WriteStringData(FileOut, InPermutation.EntryName);
+	UHUtilities::WriteStringData(FileOut, InPermutation.ProfileName);
+	UHUtilities::WriteStringVectorData(FileOut, Defines);
+	FileOut.write(reinterpret_cast<const char*>(&InPermutation.ShaderHash), sizeof(InPermutation.ShaderHash));
+
+	FileOut.close();
+}
@@ -0,0 +1,47 @@
+#pragma once
+#include "CookStep.h"
+
+class UHShader;
+
+// a shader permutation, either recorded in the editor's shader caches or required by the cooker itself
+struct UHShaderPermutation
+{
+	UHShaderPermutation()
+		: ShaderHash(0)
+	{
+
+	}
+
+	std::filesystem::path SourcePath;
+	std::filesystem::path OutputPath;
+	std::string EntryName;
+	std::string ProfileName;
+	std::vector<std::string> Defines;
+	uint64_t ShaderHash;
+};
+
+// compiles HLSL to SPIR-V with the Linux build of DXC, permutations are compiled in parallel
+// material shaders are translated from the material graph first, that only exists in the editor so they're skipped
+class UHShaderCookStep : public UHCookStep
+{
+public:
+	UHShaderCookStep(const std::filesystem::path& InCompilerPath);
+
+	void AddShader(const UHShader& InShader);
+
+	virtual std::string GetTypeName() const override;
+	virtual void CollectJobs(std::vector<UHCookJob>& OutJobs) override;
+	virtual bool HashInputs(UHCookJob& InOutJob, uint64_t& OutHash) override;
+	virtual bool Cook(const UHCookJob& InJob, std::string& OutMessage) override;
+
+private:
+	void LoadShaderCaches();
+	void WriteShaderCache(const UHShaderPermutation& InPermutation) const;
+
+	std::filesystem::path CompilerPath;
+	std::vector<UHShaderPermutation> Permutations;
+
+	// includes and the compiler are hashed once per cook
+	uint64_t IncludeHash;
+	uint64_t CompilerHash;
+};
@@ -0,0 +1,419 @@
+#include "TextureCookStep.h"
+#include "../../Runtime/Classes/DerivedDataCache.h"
+#include "../../UnheardEngine.h"
+#include "../../Runtime/Classes/AssetPath.h"
+#include "../../Runtime/Classes/Texture2D.h"
+#include "../../Runtime/Classes/Shader.h"
+#include "../../Runtime/Engine/Graphic.h"
+#include <algorithm>
+#include <cstdio>
+#include <unordered_set>
+#include <csetjmp>
+#include <png.h>
+#include <jpeglib.h>
+
+#if WITH_OPENEXR
+#define IMATH_HALF_NO_LOOKUP_TABLE
+#include <ImfRgbaFile.h>
+#endif
+
+UHTextureCookStep::UHTextureCookStep(UHGraphic* InGfx)
+	: Gfx(InGfx)
+	, bCompressionAvailable(false)
+	, CompressorHash(0)
+{
+
+}
+
+std::vector<UniquePtr<UHShader>> UHTextureCookStep::CreateCompressionShaders()
+{
+	// must match the requests in UHBlockCompressionShader and UHBlockCompressionNewShader
+	std::vector<UniquePtr<UHShader>> Shaders;
+	for (const std::string& Entry : { std::string("BlockCompressColor"), std::string("BlockCompressAlpha") })
+	{
+		Shaders.push_back(MakeUnique<UHShader>("BlockCompressionOldShader", "Shaders/BlockCompressionOldShader.hlsl", Entry, "cs_6_0"
+			, std::vector<std::string>{ "USE_" + Entry }));
+	}
+	Shaders.push_back(MakeUnique<UHShader>("BlockCompressionNewShader", "Shaders/BlockCompressionNewShader.hlsl", "BlockCompressHDR", "cs_6_0"
+		, std::vector<std::string>()));
+
+	return Shaders;
+}
+
+void UHTextureCookStep::SetCompressionAvailable(bool bInAvailable)
+{
+	bCompressionAvailable = bInAvailable;
+}
+
+std::string UHTextureCookStep::GetTypeName() const
+{
+	return "Texture";
+}
+
+void UHTextureCookStep::CollectJobs(std::vector<UHCookJob>& OutJobs)
+{
+	CompressorHash = UHTexture2D::GetCompressorHash();
+	if (std::filesystem::exists(GTextureAssetFolder))
+	{
+		for (std::filesystem::recursive_directory_iterator Idx(GTextureAssetFolder), End; Idx != End; Idx++)
+		{
+			if (std::filesystem::is_directory(Idx->path()) || !UHAssetPath::IsTheSameExtension(Idx->path(), GTextureAssetExtension))
+			{
+				continue;
+			}
+
+			// built-in textures are generated by the engine and have no raw source
+			if (UHUtilities::StringFind(Idx->path().generic_string(), GBuiltInTextureAssetPath))
+			{
+				continue;
+			}
+
+			// the source is known after the asset is loaded on the worker thread
+			UHCookJob Job;
+			Job.OutputPath = Idx->path();
+			Job.Index = Textures.size();
+			OutJobs.push_back(Job);
+			Textures.push_back(UHTextureCookData());
+		}
+	}
+
+	CollectRawTextures(OutJobs);
+}
+
+bool UHTextureCookStep::IsSupportedImage(const std::filesystem::path& InPath)
+{
+	return UHAssetPath::IsTheSameExtension(InPath, ".png") || UHAssetPath::IsTheSameExtension(InPath, ".jpg")
+		|| UHAssetPath::IsTheSameExtension(InPath, ".jpeg") || UHAssetPath::IsTheSameExtension(InPath, ".exr");
+}
+
+void UHTextureCookStep::CollectRawTextures(std::vector<UHCookJob>& OutJobs)
+{
+	if (!std::filesystem::exists(GRawTextureAssetPath))
+	{
+		return;
+	}
+
+	// an existing asset at the mirrored path keeps its own settings, it's already collected
+	std::unordered_set<std::string> CollectedOutputs;
+	for (const UHCookJob& Job : OutJobs)
+	{
+		CollectedOutputs.insert(Job.OutputPath.generic_string());
+	}
+
+	// directory iteration order isn't specified, sort so the job order is stable between cooks
+	std::vector<std::filesystem::path> RawSources;
+	for (std::filesystem::recursive_directory_iterator Idx(GRawTextureAssetPath), End; Idx != End; Idx++)
+	{
+		if (!std::filesystem::is_directory(Idx->path()) && IsSupportedImage(Idx->path()))
+		{
+			RawSources.push_back(Idx->path());
+		}
+	}
+	std::sort(RawSources.begin(), RawSources.end());
+
+	for (const std::filesystem::path& RawSource : RawSources)
+	{
+		// RawAssets/Textures/<sub folder>/<name>.png is imported as Assets/Textures/<sub folder>/<name>.uhtexture
+		std::filesystem::path SourcePath = std::filesystem::relative(RawSource, GRawTextureAssetPath);
+		SourcePath.replace_extension();
+
+		const std::filesystem::path OutputPath = std::filesystem::path(GTextureAssetFolder + SourcePath.generic_string() + GTextureAssetExtension);
+		if (!CollectedOutputs.insert(OutputPath.generic_string()).second)
+		{
+			continue;
+		}
+
+		// the default settings of the editor's texture creation
+		UHTextureCookData Texture;
+		Texture.Name = RawSource.stem().generic_string();
+		Texture.SourcePath = SourcePath.generic_string();
+		Texture.RawSourcePath = RawSource;
+		Texture.bHasAsset = false;
+
+		UHCookJob Job;
+		Job.SourcePath = RawSource;
+		Job.OutputPath = OutputPath;
+		Job.Index = Textures.size();
+		OutJobs.push_back(Job);
+		Textures.push_back(Texture);
+	}
+}
+
+bool UHTextureCookStep::HashInputs(UHCookJob& InOutJob, uint64_t& OutHash)
+{
+	// each job owns its slot, so no lock is needed here
+	UHTextureCookData& Texture = Textures[InOutJob.Index];
+	if (Texture.bHasAsset)
+	{
+		UHTexture2D Asset;
+		if (!Asset.Import(InOutJob.OutputPath))
+		{
+			return false;
+		}
+
+		Texture.Name = Asset.GetName();
+		Texture.SourcePath = Asset.GetSourcePath();
+		Texture.RawSourcePath = Asset.GetRawSourcePath();
+		Texture.Settings = Asset.GetTextureSettings();
+	}
+
+	// the compressed flag is an output of the cook, not a setting
+	Texture.Settings.bIsCompressed = false;
+	Texture.Settings.bIsHDR = UHAssetPath::IsTheSameExtension(Texture.RawSourcePath, ".exr");
+	InOutJob.SourcePath = Texture.RawSourcePath;
+
+	UHContentHasher Hasher;
+	if (!Hasher.UpdateFile(Texture.RawSourcePath))
+	{
+		return false;
+	}
+
+	Hasher.Update(Texture.Name);
+	Hasher.Update(Texture.SourcePath);
+	Hasher.Update(Texture.RawSourcePath.generic_string());
+	Hasher.UpdateValue(Texture.Settings.bIsLinear);
+	Hasher.UpdateValue(Texture.Settings.bIsNormal);
+	Hasher.UpdateValue(Texture.Settings.CompressionSetting);
+	Hasher.UpdateValue(Texture.Settings.bIsHDR);
+	Hasher.UpdateValue(Texture.Settings.bUseMipmap);
+
+	// a new mip generator or block compressor changes the output of the same source
+	Hasher.UpdateValue(CompressorHash);
+
+	OutHash = Hasher.GetHash();
+	return true;
+}
+
+bool UHTextureCookStep::Cook(const UHCookJob& InJob, std::string& OutMessage)
+{
+	const UHTextureCookData& Texture = Textures[InJob.Index];
+	if (Texture.Settings.CompressionSetting != UHTextureCompressionSettings::CompressionNone && !bCompressionAvailable)
+	{
+		OutMessage = "Block compression shaders aren't cooked.\n";
+		return false;
+	}
+
+	uint32_t Width = 0;
+	uint32_t Height = 0;
+	std::vector<uint8_t> TextureData;
+	if (!DecodeImage(Texture.RawSourcePath, Width, Height, TextureData, OutMessage))
+	{
+		return false;
+	}
+
+	VkExtent2D Extent;
+	Extent.width = Width;
+	Extent.height = Height;
+
+	// the same format selection as the editor's importer
+	UHTextureFormat DesiredFormat = Texture.Settings.bIsLinear ? UHTextureFormat::UH_FORMAT_RGBA8_UNORM : UHTextureFormat::UH_FORMAT_RGBA8_SRGB;
+	DesiredFormat = Texture.Settings.bIsHDR ? UHTextureFormat::UH_FORMAT_RGBA16F : DesiredFormat;
+
+	UHTexture2D* OutputTex = nullptr;
+	{
+		std::unique_lock<std::mutex> Lock(GfxLock);
+		UniquePtr<UHTexture2D> NewTex = MakeUnique<UHTexture2D>(Texture.Name, Texture.SourcePath, Extent, DesiredFormat, Texture.Settings);
+		OutputTex = Gfx->RequestTexture2D(NewTex, false);
+		if (OutputTex == nullptr)
+		{
+			OutMessage = "Failed to create the texture on GPU.\n";
+			return false;
+		}
+
+		OutputTex->SetRawSourcePath(Texture.RawSourcePath.generic_string());
+		OutputTex->Recreate(true, TextureData);
+	}
+
+	// Export() appends the extension, the folder of a new asset may not exist yet
+	std::filesystem::path OutputPathName = InJob.OutputPath;
+	OutputPathName.replace_extension();
+	std::error_code Error;
+	std::filesystem::create_directories(OutputPathName.parent_path(), Error);
+	OutputTex->Export(OutputPathName);
+
+	std::unique_lock<std::mutex> Lock(GfxLock);
+	Gfx->RequestReleaseTexture2D(OutputTex);
+	return true;
+}
+
+static bool DecodePNG(const std::filesystem::path& InPath, uint32_t& OutWidth, uint32_t& OutHeight, std::vector<uint8_t>& OutData
+	, std::string& OutMessage)
+{
+	png_image Image;
+	memset(&Image, 0, sizeof(Image));
+	Image.version = PNG_IMAGE_VERSION;
+
+	if (!png_image_begin_read_from_file(&Image, InPath.c_str()))
+	{
+		OutMessage = std::string(Image.message) + "\n";
+		return false;
+	}
+
+	// convert everything to RGBA8 as WIC does in the editor
+	Image.format = PNG_FORMAT_RGBA;
+	OutData.resize(PNG_IMAGE_SIZE(Image));
+	if (!png_image_finish_read(&Image, nullptr, OutData.data(), 0, nullptr))
+	{
+		OutMessage = std::string(Image.message) + "\n";
+		png_image_free(&Image);
+		return false;
+	}
+
+	OutWidth = Image.width;
+	OutHeight = Image.height;
+	return true;
+}
+
+// libjpeg aborts by default, jump back to the decoder instead
+struct UHJpegError
+{
+	jpeg_error_mgr Manager;
+	jmp_buf JumpBuffer;
+};
+
+static void OnJpegError(j_common_ptr InInfo)
+{
+	longjmp(reinterpret_cast<UHJpegError*>(InInfo->err)->JumpBuffer, 1);
+}
+
+static bool DecodeJPEG(const std::filesystem::path& InPath, uint32_t& OutWidth, uint32_t& OutHeight, std::vector<uint8_t>& OutData
+	, std::string& OutMessage)
+{
+	FILE* File = fopen(InPath.c_str(), "rb");
+	if (File == nullptr)
+	{
+		OutMessage = "Failed to open " + InPath.generic_string() + "\n";
+		return false;
+	}
+
+	jpeg_decompress_struct Info;
+	UHJpegError Error;
+	std::vector<uint8_t> Row;
+	Info.err = jpeg_std_error(&Error.Manager);
+	Error.Manager.error_exit = OnJpegError;
+
+	if (setjmp(Error.JumpBuffer))
+	{
+		char Message[JMSG_LENGTH_MAX];
+		Error.Manager.format_message(reinterpret_cast<j_common_ptr>(&Info), Message);
+		OutMessage = std::string(Message) + "\n";
+		jpeg_destroy_decompress(&Info);
+		fclose(File);
+		return false;
+	}
+
+	jpeg_create_decompress(&Info);
+	jpeg_stdio_src(&Info, File);
+	jpeg_read_header(&Info, TRUE);
+	Info.out_color_space = JCS_RGB;
+	jpeg_start_decompress(&Info);
+
+	OutWidth = Info.output_width;
+	OutHeight = Info.output_height;
+	OutData.resize(static_cast<size_t>(OutWidth) * OutHeight * 4);
+	Row.resize(static_cast<size_t>(OutWidth) * 3);
+
+	// expand RGB to RGBA with opaque alpha
+	while (Info.output_scanline < Info.output_height)
+	{
+		uint8_t* Dst = OutData.data() + static_cast<size_t>(Info.output_scanline) * OutWidth * 4;
+		JSAMPROW RowPtr = Row.data();
+		jpeg_read_scanlines(&Info, &RowPtr, 1);
+
+		for (uint32_t Idx = 0; Idx < OutWidth; Idx++)
+		{
+			Dst[Idx * 4] = Row[Idx * 3];
+			Dst[Idx * 4 + 1] = Row[Idx * 3 + 1];
+			Dst[Idx * 4 + 2] = Row[Idx * 3 + 2];
+			Dst[Idx * 4 + 3] = 255;
+		}
+	}
+
+	jpeg_finish_decompress(&Info);
+	jpeg_destroy_decompress(&Info);
+	fclose(File);
+	return true;
+}
+
+#if WITH_OPENEXR
+static float SanitizeHalf(float InValue)
+{
+	if (std::isnan(InValue))
+	{
+		return 0.0f;
+	}
+
+	if (std::isinf(InValue))
+	{
+		return 65504.0f;
+	}
+
+	return std::clamp(InValue, 0.0f, 65504.0f);
+}
+
+static bool DecodeEXR(const std::filesystem::path& InPath, uint32_t& OutWidth, uint32_t& OutHeight, std::vector<uint8_t>& OutData
+	, std::string& OutMessage)
+{
+	try
+	{
+		Imf::RgbaInputFile File(InPath.c_str());
+		const Imath::Box2i Window = File.dataWindow();
+		OutWidth = Window.max.x - Window.min.x + 1;
+		OutHeight = Window.max.y - Window.min.y + 1;
+
+		std::vector<Imf::Rgba> Pixels(static_cast<size_t>(OutWidth) * OutHeight);
+		File.setFrameBuffer(Pixels.data() - Window.min.x - static_cast<ptrdiff_t>(Window.min.y) * OutWidth, 1, OutWidth);
+		File.readPixels(Window.min.y, Window.max.y);
+
+		// erase invalid values as the editor does
+		for (Imf::Rgba& Color : Pixels)
+		{
+			Color.r = SanitizeHalf(Color.r);
+			Color.g = SanitizeHalf(Color.g);
+			Color.b = SanitizeHalf(Color.b);
+			Color.a = 1.0f;
+		}
+
+		OutData.resize(Pixels.size() * sizeof(Imf::Rgba));
+		UHMEMCOPY(OutData.data(), Pixels.data(), OutData.size());
+	}
+	catch (const std::exception& Exception)
+	{
+		OutMessage = std::string(Exception.what()) + "\n";
+		return false;
+	}
+
+	return true;
+}
+#endif
+
+bool UHTextureCookStep::DecodeImage(const std::filesystem::path& InPath, uint32_t& OutWidth, uint32_t& OutHeight, std::vector<uint8_t>& OutData
+	, std::string& OutMessage)
+{
+	OutWidth = 0;
+	OutHeight = 0;
+	bool bDecoded = false;
+
+	if (UHAssetPath::IsTheSameExtension(InPath, ".png"))
+	{
+		bDecoded = DecodePNG(InPath, OutWidth, OutHeight, OutData, OutMessage);
+	}
+	else if (UHAssetPath::IsTheSameExtension(InPath, ".jpg") || UHAssetPath::IsTheSameExtension(InPath, ".jpeg"))
+	{
+		bDecoded = DecodeJPEG(InPath, OutWidth, OutHeight, OutData, OutMessage);
+	}
+	else if (UHAssetPath::IsTheSameExtension(InPath, ".exr"))
+	{
+#if WITH_OPENEXR
+		bDecoded = DecodeEXR(InPath, OutWidth, OutHeight, OutData, OutMessage);
+#else
+		OutMessage = "The cooker is built without OpenEXR.\n";
+#endif
+	}
+	else
+	{
+		OutMessage = "Unsupported image format " + InPath.extension().generic_string() + "\n";
+	}
+
+	return bDecoded && OutWidth > 0 && OutHeight > 0;
+}
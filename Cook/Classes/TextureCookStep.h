@@ -0,0 +1,58 @@
+#pragma once
+#include "CookStep.h"
+#include "../../Runtime/Classes/Texture.h"
+#include <mutex>
+
+class UHGraphic;
+class UHShader;
+
+// texture asset to cook, the settings are kept from the existing asset
+// a raw image without an asset is imported with the default settings
+struct UHTextureCookData
+{
+	UHTextureCookData()
+		: bHasAsset(true)
+	{
+
+	}
+
+	std::string Name;
+	std::string SourcePath;
+	std::filesystem::path RawSourcePath;
+	UHTextureSettings Settings;
+	bool bHasAsset;
+};
+
+// re-imports textures from their raw source with the settings stored in the .uhtexture
+// raw images under RawAssets/Textures without an asset yet are imported to the same sub folder under Assets/Textures
+// decoding runs on the worker threads, mip generation and block compression share one offscreen Vulkan device
+class UHTextureCookStep : public UHCookStep
+{
+public:
+	UHTextureCookStep(UHGraphic* InGfx);
+
+	// the block compression shaders have to be cooked before textures, compressed textures fail without them
+	static std::vector<UniquePtr<UHShader>> CreateCompressionShaders();
+	void SetCompressionAvailable(bool bInAvailable);
+
+	virtual std::string GetTypeName() const override;
+	virtual void CollectJobs(std::vector<UHCookJob>& OutJobs) override;
+	virtual bool HashInputs(UHCookJob& InOutJob, uint64_t& OutHash) override;
+	virtual bool Cook(const UHCookJob& InJob, std::string& OutMessage) override;
+
+	// PNG and JPEG always, EXR if the cooker is built with OpenEXR
+	static bool DecodeImage(const std::filesystem::path& InPath, uint32_t& OutWidth, uint32_t& OutHeight, std::vector<uint8_t>& OutData
+		, std::string& OutMessage);
+	static bool IsSupportedImage(const std::filesystem::path& InPath);
+
+private:
+	void CollectRawTextures(std::vector<UHCookJob>& OutJobs);
+
+	UHGraphic* Gfx;
+	std::vector<UHTextureCookData> Textures;
+	bool bCompressionAvailable;
+	uint64_t CompressorHash;
+
+	// the graphic interface isn't thread-safe, e.g. one-time commands share a pool
+	std::mutex GfxLock;
+};
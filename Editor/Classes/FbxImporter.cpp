@@ -60,6 +60,8 @@ UHFbxImportedData UHFbxImporter::ImportRawFbx(std::filesystem::path InPath, std:
 	FbxSDKManager->SetIOSettings(FbxSDKIOSettings);
 	ImportedMaterialNames.clear();
 	FbxNodes.clear();
+	RawMeshes.clear();
+	RawMeshVertexCounts.clear();
 
 	// importer initialization, create fbx importer
 	FbxImporter* FbxSDKImporter = FbxImporter::Create(FbxSDKManager, "UHFbxImporter");
@@ -121,6 +123,8 @@ UHFbxImportedData UHFbxImporter::ImportRawFbx(std::filesystem::path InPath, std:
 				ImportLights(Node, OutData.ImportedLightData);
 			}
 		}
+
+		ProcessImportedMeshes(OutData);
 	}
 
 	FbxSDKImporter->Destroy();
@@ -131,6 +135,8 @@ UHFbxImportedData UHFbxImporter::ImportRawFbx(std::filesystem::path InPath, std:
 	FbxSDKIOSettings = nullptr;
 	ImportedMaterialNames.clear();
 	FbxNodes.clear();
+	RawMeshes.clear();
+	RawMeshVertexCounts.clear();
 
 	return OutData;
 }
@@ -385,9 +391,8 @@ void UHFbxImporter::ImportMeshesAndMaterials(FbxNode* InNode, std::filesystem::p
 	, std::vector<UniquePtr<UHMaterial>>& ImportedMaterial)
 {
 	// model loading here is straight forward, I only load what I need at the moment
-	// if normal/tangent data is missing, I'd rely on Fbx's generation only
-	// vertices and indices are loaded separaterly, so GetPolygonVertices() is the only polygon usage here
-	// this fits graphic API's vertex/index buffer concept well
+	// if normal data is missing, I'd rely on Fbx's generation, tangents are always generated in the post-import stage
+	// triangle corners are loaded as a raw list here, they're welded to vertices/indices in ProcessImportedMeshes()
 	// the caller should check whether it's a mesh node
 	if (InNode == nullptr || InNode->GetMesh()->GetControlPointsCount() == 0)
 	{
@@ -408,11 +413,6 @@ void UHFbxImporter::ImportMeshesAndMaterials(FbxNode* InNode, std::filesystem::p
 		InMesh->GenerateNormals(true);
 	}
 
-	if (InMesh->GetElementTangent() == nullptr)
-	{
-		InMesh->GenerateTangentsData(0, true);
-	}
-
 	FbxAMatrix FinalMatrix = InNode->EvaluateGlobalTransform();
 	FbxVector4 FinalPos = FinalMatrix.GetT();
 	FbxVector4 FinalRot = FinalMatrix.GetR();
@@ -420,23 +420,22 @@ void UHFbxImporter::ImportMeshesAndMaterials(FbxNode* InNode, std::filesystem::p
 
 	// only create UH mesh if it's mesh node and valid transform
 	UniquePtr<UHMesh> NewMesh = MakeUnique<UHMesh>(InNode->GetName());
+
+	// the vertex count this mesh had before welding, one vertex per UV index if there are more UVs than control points
 	const bool bNeedDuplication = InMesh->GetTextureUVCount() >= InMesh->GetControlPointsCount();
-	const int32_t OutputVertexCount = bNeedDuplication ? InMesh->GetTextureUVCount() : InMesh->GetControlPointsCount();
+	RawMeshVertexCounts.push_back(bNeedDuplication ? InMesh->GetTextureUVCount() : InMesh->GetControlPointsCount());
 
-	// start adding mesh infors
-	std::vector<uint32_t> MeshIndices;
-	std::vector<UHVector3> MeshVertices(OutputVertexCount);
-	std::vector<UHVector2> MeshUVs(OutputVertexCount);
-	std::vector<UHVector3> MeshNormals(OutputVertexCount);
-	std::vector<UHVector4> MeshTangents(OutputVertexCount);
+	// start adding mesh infors, one entry per triangle corner
+	const size_t CornerCount = static_cast<size_t>(InMesh->GetPolygonCount()) * 3;
+	UHRawMeshData RawMesh;
+	RawMesh.Positions.resize(CornerCount);
+	RawMesh.UV0.resize(CornerCount);
+	RawMesh.Normals.resize(CornerCount);
 
 	// get source vertices
 	FbxVector4* MeshPos = InMesh->GetControlPoints();
 
-	// iterate all triangles and load vertices/indices/UVs/Normals/Tangents at once
-	// the code below will also reconstruct the triangles based on the UV indices
-	// as there is a chance that a fbx mesh has higher UV counts than vertex counts
-	// in that case, I need to duplicate triangles for the engine use
+	// iterate all triangles and load positions/UVs/normals of each corner
 
 	// accumulate the vertex id for normal/tangent lookup
 	// not sure why FBX SDK uses two different ways in their sample code!
@@ -465,10 +464,7 @@ void UHFbxImporter::ImportMeshesAndMaterials(FbxNode* InNode, std::filesystem::p
 					: ControlIndex;
 			}
 
-			const int32_t OutputIndex = bNeedDuplication ? UVIndex : ControlIndex;
-
-			// indices
-			MeshIndices.push_back(OutputIndex);
+			const int32_t OutputIndex = VertexId;
 
 			// vertices
 			{
@@ -476,14 +472,14 @@ void UHFbxImporter::ImportMeshesAndMaterials(FbxNode* InNode, std::filesystem::p
 				Pos.x = static_cast<float>(MeshPos[ControlIndex][0]);
 				Pos.y = static_cast<float>(MeshPos[ControlIndex][1]);
 				Pos.z = static_cast<float>(MeshPos[ControlIndex][2]);
-				MeshVertices[OutputIndex] = Pos;
+				RawMesh.Positions[OutputIndex] = Pos;
 			}
 
 			// UVs
 			{
 				FbxVector2 UVValue = UVElement->GetDirectArray().GetAt(UVIndex);
-				MeshUVs[OutputIndex].x = static_cast<float>(UVValue[0]);
-				MeshUVs[OutputIndex].y = 1.0f - static_cast<float>(UVValue[1]);
+				RawMesh.UV0[OutputIndex].x = static_cast<float>(UVValue[0]);
+				RawMesh.UV0[OutputIndex].y = 1.0f - static_cast<float>(UVValue[1]);
 			}
 
 			// Normals
@@ -505,72 +501,23 @@ void UHFbxImporter::ImportMeshesAndMaterials(FbxNode* InNode, std::filesystem::p
 				}
 
 				FbxVector4 NormalValue = NormalElement->GetDirectArray().GetAt(NormalIndex);
-				MeshNormals[OutputIndex].x = static_cast<float>(NormalValue[0]);
-				MeshNormals[OutputIndex].y = static_cast<float>(NormalValue[1]);
-				MeshNormals[OutputIndex].z = static_cast<float>(NormalValue[2]);
-			}
-
-			// Tangents
-			{
-				const FbxGeometryElementTangent* TangentElement = InMesh->GetElementTangent();
-				int32_t TangentIndex = UHINDEXNONE;
-
-				if (TangentElement->GetMappingMode() == FbxGeometryElement::eByPolygonVertex)
-				{
-					TangentIndex = TangentElement->GetReferenceMode() == FbxGeometryElement::eIndexToDirect
-						? TangentElement->GetIndexArray().GetAt(VertexId)
-						: VertexId;
-				}
-				else if (TangentElement->GetMappingMode() == FbxGeometryElement::eByControlPoint)
-				{
-					TangentIndex = TangentElement->GetReferenceMode() == FbxGeometryElement::eIndexToDirect
-						? TangentElement->GetIndexArray().GetAt(ControlIndex)
-						: ControlIndex;
-				}
-
-				FbxVector4 TangentValue = TangentElement->GetDirectArray().GetAt(TangentIndex);
-				MeshTangents[OutputIndex].x = static_cast<float>(TangentValue[0]);
-				MeshTangents[OutputIndex].y = static_cast<float>(TangentValue[1]);
-				MeshTangents[OutputIndex].z = static_cast<float>(TangentValue[2]);
-				MeshTangents[OutputIndex].w = static_cast<float>(TangentValue[3]);
+				RawMesh.Normals[OutputIndex].x = static_cast<float>(NormalValue[0]);
+				RawMesh.Normals[OutputIndex].y = static_cast<float>(NormalValue[1]);
+				RawMesh.Normals[OutputIndex].z = static_cast<float>(NormalValue[2]);
 			}
 
 			VertexId++;
 		}
 	}
 
-	NewMesh->SetIndicesData(MeshIndices);
-
-	// get normal, and ensure it's not zero vector
-	for (UHVector3& N : MeshNormals)
-	{
-		if (UHMathHelpers::IsVectorNearlyZero(N))
-		{
-			N = UHVector3(0.0001f, 0.0001f, 0.0001f);
-		}
-	}
-
-	// get tangent
-	for (UHVector4& T : MeshTangents)
-	{
-		if (UHMathHelpers::IsVectorNearlyZero(T))
-		{
-			T = UHVector4(0.0001f, 0.0001f, 0.0001f, 0.0001f);
-		}
-	}
-
 	// setup imported transform at the end
 	UHVector3 Pos = UHVector3(static_cast<float>(FinalPos[0]), static_cast<float>(FinalPos[1]), static_cast<float>(FinalPos[2]));
 	UHVector3 Rot = UHVector3(static_cast<float>(FinalRot[0]), static_cast<float>(FinalRot[1]), static_cast<float>(FinalRot[2]));
 	UHVector3 Scale = UHVector3(static_cast<float>(FinalScale[0]), static_cast<float>(FinalScale[1]), static_cast<float>(FinalScale[2]));
 	NewMesh->SetImportedTransform(Pos, Rot, Scale);
 
-	// set data to UHMesh class
-	NewMesh->SetPositionData(MeshVertices);
-	NewMesh->SetUV0Data(MeshUVs);
-	NewMesh->SetNormalData(MeshNormals);
-	NewMesh->SetTangentData(MeshTangents);
-	NewMesh->RecalculateMeshBound();
+	// vertex data is set after the post-import stage
+	RawMeshes.push_back(UHMOVE(RawMesh));
 
 	// at last, try to import material as well
 	UniquePtr<UHMaterial> NewMat = ImportMaterial(InNode, InTextureRefPath);
@@ -590,6 +537,32 @@ void UHFbxImporter::ImportMeshesAndMaterials(FbxNode* InNode, std::filesystem::p
 	ImportedMesh.push_back(UHMOVE(NewMesh));
 }
 
+void UHFbxImporter::ProcessImportedMeshes(UHFbxImportedData& InOutData)
+{
+	std::vector<UHProcessedMeshData> ProcessedMeshes;
+	UHMeshProcessing::ProcessMeshes(RawMeshes, ProcessedMeshes);
+
+	// set data to UHMesh class, raw meshes are pushed in the same order as imported meshes
+	for (size_t Idx = 0; Idx < ProcessedMeshes.size(); Idx++)
+	{
+		UHMesh* Mesh = InOutData.ImportedMesh[Idx].get();
+		UHProcessedMeshData& Processed = ProcessedMeshes[Idx];
+
+		Mesh->SetIndicesData(Processed.Indices);
+		Mesh->SetPositionData(Processed.Positions);
+		Mesh->SetUV0Data(Processed.UV0);
+		Mesh->SetNormalData(Processed.Normals);
+		Mesh->SetTangentData(Processed.Tangents);
+		Mesh->RecalculateMeshBound();
+
+		UHFbxMeshStats Stats;
+		Stats.Name = Mesh->GetName();
+		Stats.ImportedVertexCount = RawMeshVertexCounts[Idx];
+		Stats.WeldedVertexCount = static_cast<uint32_t>(Processed.Positions.size());
+		InOutData.MeshStats.push_back(Stats);
+	}
+}
+
 void UHFbxImporter::ImportCameras(FbxNode* InNode, std::vector<UHFbxCameraData>& ImportedCameraData)
 {
 	if (InNode == nullptr)
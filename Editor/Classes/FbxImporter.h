@@ -8,6 +8,7 @@
 #include <filesystem>	// for list all files under a directory and subdirectory, C++17 feature
 #include "Runtime/Classes/Math.h"
 #include "Runtime/Classes/Types.h"
+#include "MeshProcessing.h"
 
 class UHMesh;
 class UHMaterial;
@@ -39,10 +40,20 @@ public:
 	UHVector3 Rotation;	// pitch yaw roll
 };
 
+// vertex counts before and after the post-import welding
+struct UHFbxMeshStats
+{
+public:
+	std::string Name;
+	uint32_t ImportedVertexCount;
+	uint32_t WeldedVertexCount;
+};
+
 struct UHFbxImportedData
 {
 public:
 	std::vector<UniquePtr<UHMesh>> ImportedMesh;
+	std::vector<UHFbxMeshStats> MeshStats;
 	std::vector<UniquePtr<UHMaterial>> ImportedMaterial;
 	std::vector<UHFbxCameraData> ImportedCameraData;
 	std::vector<UHFbxLightData> ImportedLightData;
@@ -80,7 +91,12 @@ private:
 	void ImportCameras(FbxNode* InNode, std::vector<UHFbxCameraData>& ImportedCameraData);
 	void ImportLights(FbxNode* InNode, std::vector<UHFbxLightData>& ImportedLightData);
 
+	// generate tangents and weld vertices of all imported meshes in parallel, then fill the UH meshes
+	void ProcessImportedMeshes(UHFbxImportedData& InOutData);
+
 	FbxManager* FbxSDKManager;
+	std::vector<UHRawMeshData> RawMeshes;
+	std::vector<uint32_t> RawMeshVertexCounts;
 	std::vector<std::string> ImportedMaterialNames;
 	std::vector<FbxNode*> FbxNodes;
 	std::string MaterialOutputPath;
@@ -0,0 +1,316 @@
+#include "MeshProcessing.h"
+
+#if WITH_EDITOR
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include "Runtime/Classes/Thread.h"
+
+#if defined(_M_X64) || defined(__SSE2__)
+#include <emmintrin.h>
+#define UH_MESH_PROCESSING_SSE 1
+#else
+#define UH_MESH_PROCESSING_SSE 0
+#endif
+
+// quantization scales of the weld key, anything closer than these steps is treated as the same value
+static constexpr float GWeldPositionScale = 10000.0f;
+static constexpr float GWeldUVScale = 65536.0f;
+static constexpr float GWeldDirectionScale = 1024.0f;
+
+// quantized attributes, 16 lanes so the hash and compare work on 4 SSE registers
+struct alignas(16) UHWeldKey
+{
+	int32_t Value[16] = {};
+};
+
+static int32_t Quantize(float InValue, float InScale)
+{
+	const double Value = std::round(static_cast<double>(InValue) * InScale);
+	return static_cast<int32_t>(std::clamp(Value, static_cast<double>(INT32_MIN), static_cast<double>(INT32_MAX)));
+}
+
+static UHWeldKey MakeWeldKey(const UHVector3& InPos, const UHVector2& InUV, const UHVector3& InNormal, const UHVector4& InTangent)
+{
+	UHWeldKey Key;
+	Key.Value[0] = Quantize(InPos.x, GWeldPositionScale);
+	Key.Value[1] = Quantize(InPos.y, GWeldPositionScale);
+	Key.Value[2] = Quantize(InPos.z, GWeldPositionScale);
+	Key.Value[3] = Quantize(InUV.x, GWeldUVScale);
+	Key.Value[4] = Quantize(InUV.y, GWeldUVScale);
+	Key.Value[5] = Quantize(InNormal.x, GWeldDirectionScale);
+	Key.Value[6] = Quantize(InNormal.y, GWeldDirectionScale);
+	Key.Value[7] = Quantize(InNormal.z, GWeldDirectionScale);
+	Key.Value[8] = Quantize(InTangent.x, GWeldDirectionScale);
+	Key.Value[9] = Quantize(InTangent.y, GWeldDirectionScale);
+	Key.Value[10] = Quantize(InTangent.z, GWeldDirectionScale);
+	Key.Value[11] = InTangent.w < 0.0f ? -1 : 1;
+
+	return Key;
+}
+
+static uint64_t HashWeldKey(const UHWeldKey& InKey)
+{
+	// mix 4 lanes at a time, then fold the lanes into 64-bit
+	alignas(16) uint32_t Lanes[4];
+#if UH_MESH_PROCESSING_SSE
+	__m128i H = _mm_set_epi32(0x27d4eb2f, 0x165667b1, static_cast<int32_t>(0x85ebca6b), static_cast<int32_t>(0x9e3779b9));
+	for (uint32_t Idx = 0; Idx < 4; Idx++)
+	{
+		H = _mm_xor_si128(H, _mm_load_si128(reinterpret_cast<const __m128i*>(InKey.Value) + Idx));
+		H = _mm_add_epi32(H, _mm_slli_epi32(H, 7));
+		H = _mm_xor_si128(H, _mm_srli_epi32(H, 11));
+		H = _mm_add_epi32(H, _mm_shuffle_epi32(H, _MM_SHUFFLE(0, 3, 2, 1)));
+	}
+	_mm_store_si128(reinterpret_cast<__m128i*>(Lanes), H);
+#else
+	Lanes[0] = 0x9e3779b9;
+	Lanes[1] = 0x85ebca6b;
+	Lanes[2] = 0x165667b1;
+	Lanes[3] = 0x27d4eb2f;
+	for (uint32_t Idx = 0; Idx < 4; Idx++)
+	{
+		uint32_t Temp[4];
+		for (uint32_t Ldx = 0; Ldx < 4; Ldx++)
+		{
+			uint32_t H = Lanes[Ldx] ^ static_cast<uint32_t>(InKey.Value[Idx * 4 + Ldx]);
+			H += H << 7;
+			H ^= H >> 11;
+			Temp[Ldx] = H;
+		}
+
+		for (uint32_t Ldx = 0; Ldx < 4; Ldx++)
+		{
+			Lanes[Ldx] = Temp[Ldx] + Temp[(Ldx + 1) & 3];
+		}
+	}
+#endif
+
+	uint64_t X = (static_cast<uint64_t>(Lanes[0]) | (static_cast<uint64_t>(Lanes[1]) << 32))
+		^ ((static_cast<uint64_t>(Lanes[2]) | (static_cast<uint64_t>(Lanes[3]) << 32)) * 0x9e3779b97f4a7c15ull);
+	X ^= X >> 31;
+	X *= 0xbf58476d1ce4e5b9ull;
+	X ^= X >> 27;
+
+	return X;
+}
+
+static bool IsWeldKeyEqual(const UHWeldKey& InA, const UHWeldKey& InB)
+{
+#if UH_MESH_PROCESSING_SSE
+	__m128i Equal = _mm_set1_epi32(-1);
+	for (uint32_t Idx = 0; Idx < 4; Idx++)
+	{
+		Equal = _mm_and_si128(Equal, _mm_cmpeq_epi32(_mm_load_si128(reinterpret_cast<const __m128i*>(InA.Value) + Idx)
+			, _mm_load_si128(reinterpret_cast<const __m128i*>(InB.Value) + Idx)));
+	}
+	return _mm_movemask_epi8(Equal) == 0xffff;
+#else
+	return memcmp(InA.Value, InB.Value, sizeof(InA.Value)) == 0;
+#endif
+}
+
+// open addressing table from keys to the first index that added them
+class UHWeldTable
+{
+public:
+	UHWeldTable(size_t InMaxCount)
+	{
+		size_t Capacity = 16;
+		while (Capacity < InMaxCount * 2)
+		{
+			Capacity <<= 1;
+		}
+
+		Slots.resize(Capacity, UINT32_MAX);
+		Keys.reserve(InMaxCount);
+		Mask = Capacity - 1;
+	}
+
+	// return the index of the existing key, or add the key as the next index
+	uint32_t FindOrAdd(const UHWeldKey& InKey)
+	{
+		for (size_t Slot = HashWeldKey(InKey) & Mask; ; Slot = (Slot + 1) & Mask)
+		{
+			if (Slots[Slot] == UINT32_MAX)
+			{
+				Slots[Slot] = static_cast<uint32_t>(Keys.size());
+				Keys.push_back(InKey);
+				return Slots[Slot];
+			}
+
+			if (IsWeldKeyEqual(Keys[Slots[Slot]], InKey))
+			{
+				return Slots[Slot];
+			}
+		}
+	}
+
+	uint32_t GetCount() const
+	{
+		return static_cast<uint32_t>(Keys.size());
+	}
+
+private:
+	std::vector<uint32_t> Slots;
+	std::vector<UHWeldKey> Keys;
+	size_t Mask;
+};
+
+// UHMathHelpers::IsVectorNearlyZero() compares components with sign, directions need a length test
+static bool IsZeroLength(const UHVector3& InVector)
+{
+	return glm::dot(InVector, InVector) < 1e-12f;
+}
+
+static UHVector3 GetOrthogonalVector(const UHVector3& InNormal)
+{
+	// cross with the axis that is the least aligned with the normal
+	const UHVector3 Axis = (std::abs(InNormal.x) < 0.9f) ? UHVector3(1, 0, 0) : UHVector3(0, 1, 0);
+	return glm::normalize(glm::cross(Axis, InNormal));
+}
+
+static float GetCornerAngle(const UHVector3& InPos, const UHVector3& InPos1, const UHVector3& InPos2)
+{
+	const UHVector3 E1 = InPos1 - InPos;
+	const UHVector3 E2 = InPos2 - InPos;
+	if (IsZeroLength(E1) || IsZeroLength(E2))
+	{
+		return 0.0f;
+	}
+
+	return std::acos(std::clamp(glm::dot(glm::normalize(E1), glm::normalize(E2)), -1.0f, 1.0f));
+}
+
+namespace UHMeshProcessing
+{
+	std::vector<UHVector4> GenerateTangents(UHRawMeshData& InOutMesh)
+	{
+		const size_t CornerCount = InOutMesh.Positions.size();
+		const size_t TriangleCount = CornerCount / 3;
+		std::vector<UHVector4> Tangents(CornerCount);
+
+		// normalize normals and replace zero normals with the face normal
+		for (size_t Tdx = 0; Tdx < TriangleCount; Tdx++)
+		{
+			const UHVector3* P = &InOutMesh.Positions[Tdx * 3];
+			const UHVector3 FaceNormal = glm::cross(P[1] - P[0], P[2] - P[0]);
+
+			for (size_t Cdx = Tdx * 3; Cdx < Tdx * 3 + 3; Cdx++)
+			{
+				UHVector3& N = InOutMesh.Normals[Cdx];
+				if (!IsZeroLength(N))
+				{
+					N = glm::normalize(N);
+				}
+				else
+				{
+					N = IsZeroLength(FaceNormal) ? UHVector3(0, 1, 0) : glm::normalize(FaceNormal);
+				}
+			}
+		}
+
+		// group the corners that share position, normal, UV and UV winding, the winding keeps mirrored UV islands apart
+		UHWeldTable GroupTable(CornerCount);
+		std::vector<uint32_t> CornerGroups(CornerCount);
+		std::vector<UHVector3> TangentSums(CornerCount, UHVector3(0));
+		std::vector<UHVector3> BitangentSums(CornerCount, UHVector3(0));
+
+		for (size_t Tdx = 0; Tdx < TriangleCount; Tdx++)
+		{
+			const UHVector3* P = &InOutMesh.Positions[Tdx * 3];
+			const UHVector2* UV = &InOutMesh.UV0[Tdx * 3];
+
+			// UV.y was flipped by the importer, derive the bitangent with the source V so the handedness matches the previous import
+			const UHVector3 E1 = P[1] - P[0];
+			const UHVector3 E2 = P[2] - P[0];
+			const UHVector2 DUV1 = UHVector2(UV[1].x - UV[0].x, UV[0].y - UV[1].y);
+			const UHVector2 DUV2 = UHVector2(UV[2].x - UV[0].x, UV[0].y - UV[2].y);
+			const float Det = DUV1.x * DUV2.y - DUV2.x * DUV1.y;
+
+			UHVector3 FaceTangent(0);
+			UHVector3 FaceBitangent(0);
+			if (std::abs(Det) > 1e-12f)
+			{
+				FaceTangent = (E1 * DUV2.y - E2 * DUV1.y) / Det;
+				FaceBitangent = (E2 * DUV1.x - E1 * DUV2.x) / Det;
+			}
+
+			for (uint32_t Jdx = 0; Jdx < 3; Jdx++)
+			{
+				const size_t Cdx = Tdx * 3 + Jdx;
+				const UHVector3& N = InOutMesh.Normals[Cdx];
+
+				UHWeldKey Key = MakeWeldKey(P[Jdx], UV[Jdx], N, UHVector4(0));
+				Key.Value[11] = Det < 0.0f ? -1 : 1;
+				CornerGroups[Cdx] = GroupTable.FindOrAdd(Key);
+
+				// project the face tangent to the tangent plane of the corner and weight it with the corner angle
+				const float Angle = GetCornerAngle(P[Jdx], P[(Jdx + 1) % 3], P[(Jdx + 2) % 3]);
+				UHVector3 T = FaceTangent - N * glm::dot(N, FaceTangent);
+				UHVector3 B = FaceBitangent - N * glm::dot(N, FaceBitangent);
+				if (!IsZeroLength(T))
+				{
+					TangentSums[CornerGroups[Cdx]] += glm::normalize(T) * Angle;
+				}
+
+				if (!IsZeroLength(B))
+				{
+					BitangentSums[CornerGroups[Cdx]] += glm::normalize(B) * Angle;
+				}
+			}
+		}
+
+		for (size_t Cdx = 0; Cdx < CornerCount; Cdx++)
+		{
+			const UHVector3& N = InOutMesh.Normals[Cdx];
+			const uint32_t Group = CornerGroups[Cdx];
+
+			// degenerated UVs still need a valid frame
+			UHVector3 T = TangentSums[Group] - N * glm::dot(N, TangentSums[Group]);
+			T = IsZeroLength(T) ? GetOrthogonalVector(N) : glm::normalize(T);
+
+			const float Handedness = glm::dot(glm::cross(N, T), BitangentSums[Group]) < 0.0f ? -1.0f : 1.0f;
+			Tangents[Cdx] = UHVector4(T, Handedness);
+		}
+
+		return Tangents;
+	}
+
+	void WeldVertices(const UHRawMeshData& InMesh, const std::vector<UHVector4>& InTangents, UHProcessedMeshData& OutMesh)
+	{
+		const size_t CornerCount = InMesh.Positions.size();
+		UHWeldTable WeldTable(CornerCount);
+
+		OutMesh = UHProcessedMeshData();
+		OutMesh.Indices.resize(CornerCount);
+
+		// the first corner of a key becomes the vertex, so the vertex order follows the index order
+		for (size_t Cdx = 0; Cdx < CornerCount; Cdx++)
+		{
+			const uint32_t VertexCount = WeldTable.GetCount();
+			const uint32_t VertexIndex = WeldTable.FindOrAdd(MakeWeldKey(InMesh.Positions[Cdx], InMesh.UV0[Cdx], InMesh.Normals[Cdx], InTangents[Cdx]));
+			if (VertexIndex == VertexCount)
+			{
+				OutMesh.Positions.push_back(InMesh.Positions[Cdx]);
+				OutMesh.UV0.push_back(InMesh.UV0[Cdx]);
+				OutMesh.Normals.push_back(InMesh.Normals[Cdx]);
+				OutMesh.Tangents.push_back(InTangents[Cdx]);
+			}
+
+			OutMesh.Indices[Cdx] = VertexIndex;
+		}
+	}
+
+	void ProcessMeshes(std::vector<UHRawMeshData>& InMeshes, std::vector<UHProcessedMeshData>& OutMeshes)
+	{
+		OutMeshes.resize(InMeshes.size());
+		UHParallelFor(static_cast<uint32_t>(InMeshes.size()), [&](uint32_t Idx)
+		{
+			const std::vector<UHVector4> Tangents = GenerateTangents(InMeshes[Idx]);
+			WeldVertices(InMeshes[Idx], Tangents, OutMeshes[Idx]);
+		});
+	}
+}
+
+#endif
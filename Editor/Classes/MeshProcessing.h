@@ -0,0 +1,40 @@
+#pragma once
+#include "../../UnheardEngine.h"
+
+#if WITH_EDITOR
+#include <vector>
+#include "Runtime/Classes/Math.h"
+
+// raw triangle list from the importer, one entry per triangle corner
+struct UHRawMeshData
+{
+	std::vector<UHVector3> Positions;
+	std::vector<UHVector2> UV0;
+	std::vector<UHVector3> Normals;
+};
+
+// indexed mesh after tangent generation and welding
+struct UHProcessedMeshData
+{
+	std::vector<UHVector3> Positions;
+	std::vector<UHVector2> UV0;
+	std::vector<UHVector3> Normals;
+	std::vector<UHVector4> Tangents;
+	std::vector<uint32_t> Indices;
+};
+
+// post-import mesh processing in UHE
+namespace UHMeshProcessing
+{
+	// fix zero normals and generate tangents per corner, MikkTSpace-style
+	// corners sharing position, normal, UV and UV winding are smoothed together with angle weights
+	std::vector<UHVector4> GenerateTangents(UHRawMeshData& InOutMesh);
+
+	// weld identical corners with a hash over the quantized attributes
+	void WeldVertices(const UHRawMeshData& InMesh, const std::vector<UHVector4>& InTangents, UHProcessedMeshData& OutMesh);
+
+	// generate tangents and weld, meshes are processed in parallel
+	void ProcessMeshes(std::vector<UHRawMeshData>& InMeshes, std::vector<UHProcessedMeshData>& OutMeshes);
+}
+
+#endif
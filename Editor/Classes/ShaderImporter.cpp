@@ -5,9 +5,17 @@
 #include <assert.h>
 #include "../../Runtime/Classes/AssetPath.h"
 #include "../../Runtime/Classes/Material.h"
+#include "../../Runtime/Classes/DerivedDataCache.h"
 #include <sstream>
 
+// the exe path, got from DXC GitHub
+static const std::string GShaderCompilerPath = "ThirdParty/DirectXShaderCompiler/bin/x64/dxc.exe";
+
 UHShaderImporter::UHShaderImporter()
+	: IncludeHash(0)
+	, bIncludeHashed(false)
+	, CompilerHash(0)
+	, bCompilerHashed(false)
 {
 	// hard-coded shader include file names, can also be moved to config settings in the future
 	ShaderIncludes.push_back("UHInputs.hlsli");
@@ -220,6 +228,28 @@ bool UHShaderImporter::IsShaderTemplateCached(std::filesystem::path SourcePath,
 	return bCacheFound && IsShaderIncludeCached();
 }
 
+uint64_t UHShaderImporter::GetIncludeHash()
+{
+	if (!bIncludeHashed)
+	{
+		IncludeHash = UHShader::HashShaderIncludes();
+		bIncludeHashed = true;
+	}
+
+	return IncludeHash;
+}
+
+uint64_t UHShaderImporter::GetCompilerHash()
+{
+	if (!bCompilerHashed)
+	{
+		CompilerHash = UHShader::HashShaderCompiler(GShaderCompilerPath);
+		bCompilerHashed = true;
+	}
+
+	return CompilerHash;
+}
+
 bool CompileShader(std::string CommandLine)
 {
 	HANDLE Std_OUT_Rd = NULL;
@@ -251,7 +281,7 @@ bool CompileShader(std::string CommandLine)
 	ZeroMemory(&ProcInfo, sizeof(ProcInfo));
 
 	// start the program up
-	CreateProcessA("ThirdParty/DirectXShaderCompiler/bin/x64/dxc.exe",   // the exe path, got from DXC GitHub
+	CreateProcessA(GShaderCompilerPath.c_str(),   // the exe path
 		const_cast<char*>(CommandLine.c_str()),        // Command line
 		NULL,           // Process handle not inheritable
 		NULL,           // Thread handle not inheritable
@@ -319,6 +349,17 @@ void UHShaderImporter::CompileHLSL(UHShader* InShader)
 		return;
 	}
 
+	// the timestamp cache is local, try the content-addressed derived data before compiling
+	uint64_t InputHash = 0;
+	const bool bUseDerivedData = GDerivedDataCache.IsEnabled() && UHShader::HashCompileInputs(InShader->GetSourcePath(), InShader->GetEntryName()
+		, InShader->GetProfileName(), InShader->GetShaderDefines(), GetIncludeHash(), GetCompilerHash(), InputHash);
+	const std::string DerivedDataKey = UHShader::MakeDerivedDataKey(InputHash);
+	if (bUseDerivedData && GDerivedDataCache.GetFile(DerivedDataKey, OutputShaderPath))
+	{
+		WriteShaderCache(InShader);
+		return;
+	}
+
 	// compile, setup dx layout as well, be careful that the path must include "" mark in case there are folders with whitespace name
 	const std::string QuoteMark = "\"";
 	std::string CompileCmd = " -spirv -T " + InShader->GetProfileName() + " -E " + InShader->GetEntryName() + " "
@@ -351,6 +392,11 @@ void UHShaderImporter::CompileHLSL(UHShader* InShader)
 		return;
 	}
 
+	if (bUseDerivedData)
+	{
+		GDerivedDataCache.PutFile(DerivedDataKey, OutputShaderPath);
+	}
+
 	// write shader cache
 	WriteShaderCache(InShader);
 }
@@ -429,6 +475,17 @@ std::filesystem::path UHShaderImporter::TranslateHLSL(UHShader* InShader, UHMate
 		? InShader->GetOutputPath()
 		: TempShaderPath + GShaderAssetExtension;
 
+	// material code is translated into the temp file, so hashing it covers the graph too
+	uint64_t InputHash = 0;
+	const bool bUseDerivedData = GDerivedDataCache.IsEnabled() && UHShader::HashCompileInputs(TempShaderPath + GRawShaderExtension, InShader->GetEntryName()
+		, InShader->GetProfileName(), InShader->GetShaderDefines(), GetIncludeHash(), GetCompilerHash(), InputHash);
+	const std::string DerivedDataKey = UHShader::MakeDerivedDataKey(InputHash);
+	if (bUseDerivedData && GDerivedDataCache.GetFile(DerivedDataKey, OutputShaderPath))
+	{
+		WriteShaderCache(InShader, OutputShaderPath);
+		return OutputShaderPath;
+	}
+
 	// compile, setup dx layout as well, be careful with path system, quotation mark is needed
 	const std::string QuoteMark = "\"";
 	std::string CompileCmd = " -spirv -T " + InShader->GetProfileName() + " -E " + InShader->GetEntryName() + " "
@@ -461,6 +518,11 @@ std::filesystem::path UHShaderImporter::TranslateHLSL(UHShader* InShader, UHMate
 		return "";
 	}
 
+	if (bUseDerivedData)
+	{
+		GDerivedDataCache.PutFile(DerivedDataKey, OutputShaderPath);
+	}
+
 	// write shader cache
 	WriteShaderCache(InShader, OutputShaderPath);
 
@@ -65,9 +65,18 @@ public:
 	std::filesystem::path TranslateHLSL(UHShader* InShader, UHMaterialCompileData InData);
 
 private:
+	uint64_t GetIncludeHash();
+	uint64_t GetCompilerHash();
+
 	std::vector<UHRawShaderAssetCache> UHRawShadersCache;
 	std::vector<std::string> ShaderIncludes;
 
+	// content hash of all includes for derived data keys, hashed on the first compile
+	uint64_t IncludeHash;
+	bool bIncludeHashed;
+	uint64_t CompilerHash;
+	bool bCompilerHashed;
+
 	// also keep map containers for faster lookup
 	std::unordered_map<size_t, UHRawShaderAssetCache> UHRawShadersCacheMap;
 	std::unordered_map<size_t, bool> UHShaderTemplateCacheMap;
@@ -222,6 +222,12 @@ void UHCubemapDialog::ControlSave()
         return;
     }
 
+    // old cubes without baked lighting are baked on save
+    if (!CurrentCube->HasBakedLighting())
+    {
+        CurrentCube->BakeLighting();
+    }
+
     const std::filesystem::path SourcePath = CurrentCube->GetSourcePath();
     CurrentCube->Export(GTextureAssetFolder + SourcePath.generic_string());
     MessageBoxA(nullptr, "Current editing cube is saved.", "Cubemap Editor", MB_OK);
@@ -232,6 +238,11 @@ void UHCubemapDialog::ControlSaveAll()
     // iterate all textures and save them
     for (UHTextureCube* Tex : AssetMgr->GetCubemaps())
     {
+        if (!Tex->HasBakedLighting())
+        {
+            Tex->BakeLighting();
+        }
+
         const std::filesystem::path SourcePath = Tex->GetSourcePath();
         Tex->Export(GTextureAssetFolder + SourcePath.generic_string());
     }
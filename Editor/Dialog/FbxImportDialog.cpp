@@ -79,6 +79,17 @@ void UHFbxImportDialog::Update(bool& bIsDialogActive)
 			OnImport();
 		}
 
+		// vertex counts before and after welding
+		if (LastMeshStats.size() > 0)
+		{
+			ImGui::NewLine();
+			ImGui::Text("Last import vertex count (imported -> welded):");
+			for (const UHFbxMeshStats& Stats : LastMeshStats)
+			{
+				ImGui::Text("%s: %u -> %u", Stats.Name.c_str(), Stats.ImportedVertexCount, Stats.WeldedVertexCount);
+			}
+		}
+
 		ImGui::TableNextColumn();
 		ImGui::Text("Input File:");
 		ImGui::Text(InputSourceFile.c_str());
@@ -167,6 +178,16 @@ void UHFbxImportDialog::OnImport()
 	FBXImporterInterface->SetMaterialOutputPath(MaterialOutputPath);
 	UHFbxImportedData ImportedData = FBXImporterInterface->ImportRawFbx(InputSourceFile, TextureReferencePath);
 
+	LastMeshStats = ImportedData.MeshStats;
+	uint32_t TotalImportedVertexCount = 0;
+	uint32_t TotalWeldedVertexCount = 0;
+	for (const UHFbxMeshStats& Stats : LastMeshStats)
+	{
+		TotalImportedVertexCount += Stats.ImportedVertexCount;
+		TotalWeldedVertexCount += Stats.WeldedVertexCount;
+	}
+	UHE_LOG("Fbx vertex count after welding: " + std::to_string(TotalImportedVertexCount) + " -> " + std::to_string(TotalWeldedVertexCount) + "\n");
+
 	// Add imported meshes/materials to system, if the assets are already there, do not export them.
 	// @TODO: consider a force overwriting option in the future
 	std::vector<UHMesh*> MeshCache;
@@ -181,6 +202,9 @@ void UHFbxImportDialog::OnImport()
 		ImportMesh->SetSourcePath(UHUtilities::StringReplace(SourcePath.generic_string(), "./", ""));
 		MeshCache.push_back(ImportMesh.get());
 
+		// report how much precision the compressed vertex layout would lose for this mesh
+		ImportMesh->ReportCompressionError();
+
 		if (!std::filesystem::exists(OutPath))
 		{
 			ImportMesh->Export(OutPath);
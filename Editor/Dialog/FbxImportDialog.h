@@ -4,6 +4,7 @@
 #if WITH_EDITOR
 class UHFbxImporter;
 class UHEngine;
+struct UHFbxMeshStats;
 
 class UHFbxImportDialog : public UHDialog
 {
@@ -26,6 +27,9 @@ private:
 	std::string TextureReferencePath;
 	std::string CurrConvertUnitText;
 
+	// vertex counts of the last import
+	std::vector<UHFbxMeshStats> LastMeshStats;
+
 	bool bCreateSceneObjectAfterImport;
 	bool bCreateNewScene;
 };
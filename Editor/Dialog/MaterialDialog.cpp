@@ -163,11 +163,24 @@ void UHMaterialDialog::Update(bool& bIsDialogActive)
     {
         ControlResaveAllMaterials();
     }
+    ImGui::SameLine();
+    if (ImGui::Button("Create Instance"))
+    {
+        ControlCreateInstance();
+    }
     ImGui::NewLine();
 
     // Cull mode list
     if (CurrentMaterial)
     {
+        // instances follow the states of parent
+        const bool bIsInstance = CurrentMaterial->IsMaterialInstance();
+        if (bIsInstance)
+        {
+            ImGui::Text("Instance of: %s", CurrentMaterial->GetParentSourcePath().c_str());
+        }
+        ImGui::BeginDisabled(bIsInstance);
+
         const std::string CurrCullModeText = UHUtilities::ToStringA(GCullModeNames[UH_ENUM_VALUE(CurrentMaterial->GetCullMode())]);
         if (ImGui::BeginCombo("Cull Mode", CurrCullModeText.c_str()))
         {
@@ -200,6 +213,7 @@ void UHMaterialDialog::Update(bool& bIsDialogActive)
             }
             ImGui::EndCombo();
         }
+        ImGui::EndDisabled();
 
         // Material properties
         bool bHasPropertyChanged = false;
@@ -250,11 +264,18 @@ void UHMaterialDialog::Update(bool& bIsDialogActive)
     // only do node operation when a material is selected
     if (CurrentMaterialIndex > -1)
     {
-        TryAddNodes();
-        TryDeleteNodes();
-        TryDisconnectPin();
+        // instances can only override parameters and textures, the graph is from parent
+        if (!CurrentMaterial->IsMaterialInstance())
+        {
+            TryAddNodes();
+            TryDeleteNodes();
+            TryDisconnectPin();
+        }
         TryMoveNodes();
-        TryConnectNodes();
+        if (!CurrentMaterial->IsMaterialInstance())
+        {
+            TryConnectNodes();
+        }
         DrawPinConnectionLine();
         ProcessPopMenu();
     }
@@ -833,6 +854,20 @@ void UHMaterialDialog::ControlResaveAllMaterials()
     ResaveAllMaterials();
 }
 
+void UHMaterialDialog::ControlCreateInstance()
+{
+    if (CurrentMaterialIndex == UHINDEXNONE)
+    {
+        return;
+    }
+
+    UHMaterial* Mat = AssetManager->GetMaterials()[CurrentMaterialIndex];
+    if (UHMaterial* Instance = AssetManager->CreateMaterialInstance(Mat))
+    {
+        MessageBoxA(Dialog, ("Material instance " + Instance->GetSourcePath() + " is created.").c_str(), "Material Editor", MB_OK);
+    }
+}
+
 void UHMaterialDialog::ControlCullMode(const int32_t InCullMode)
 {
     if (CurrentMaterialIndex == UHINDEXNONE)
@@ -899,6 +934,18 @@ void UHMaterialDialog::RecompileMaterial(int32_t MatIndex, bool bDelayRTShaderCr
         }
     }
 
+    // instances share the shaders of this material, refresh if any of them is used as well
+    for (const UHMaterial* Instance : Mat->GetMaterialInstances())
+    {
+        for (const UHObject* Obj : Instance->GetReferenceObjects())
+        {
+            if (Obj->GetObjectClassId() == UHMeshRendererComponent::ClassId)
+            {
+                bNeedRefreshShaders = true;
+            }
+        }
+    }
+
     // only refresh shaders when the material is actually used in rendering
     if (bNeedRefreshShaders)
     {
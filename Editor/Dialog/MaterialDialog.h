@@ -73,6 +73,7 @@ private:
 	void ControlRecompileMaterial();
 	void ControlResaveMaterial();
 	void ControlResaveAllMaterials();
+	void ControlCreateInstance();
 	void ControlCullMode(const int32_t Idx);
 	void ControlBlendMode(const int32_t Idx);
 
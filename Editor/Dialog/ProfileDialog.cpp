@@ -5,6 +5,7 @@
 #include "Runtime/Engine/Config.h"
 #include "Runtime/Engine/Graphic.h"
 #include "Runtime/Classes/GPUQuery.h"
+#include "Runtime/Engine/TraceProfiler.h"
 
 UHProfileDialog::UHProfileDialog()
     : UHDialog(nullptr, nullptr)
@@ -22,7 +23,7 @@ void UHProfileDialog::SyncProfileStatistics(UHProfiler* InProfiler, UHGameTimer*
 
     // convert stats to string and display them
     const UHStatistics& Stats = InProfiler->GetStatistics();
-    const auto& CPUScopeStats = UHGameTimerScope::GetResiteredGameTime();
+    const auto& CPUScopeStats = UHTraceProfiler::GetFrameScopeTimes();
     const auto& GPUScopeStats = UHGPUTimeQueryScope::GetResiteredGPUTime();
 
     static std::vector<std::stringstream> CPUTimeStats;
@@ -35,6 +36,8 @@ void UHProfileDialog::SyncProfileStatistics(UHProfiler* InProfiler, UHGameTimer*
         CPUStatTex << "--CPU Profiles--\n";
         CPUStatTex << "Engine Update Time: " << std::fixed << std::setprecision(4) << Stats.EngineUpdateTime << " ms\n";
         CPUStatTex << "Render Thread Time: " << std::fixed << std::setprecision(4) << Stats.RenderThreadTime << " ms\n";
+        CPUStatTex << "Frame Latency (GT to GPU done): " << std::fixed << std::setprecision(4) << Stats.FrameLatency << " ms\n";
+        CPUStatTex << "Frames In Flight: " << Stats.FramesInFlight << "\n";
         CPUStatTex << "Total CPU Time: " << std::fixed << std::setprecision(4) << Stats.TotalTime << " ms\n";
         CPUStatTex << "FPS: " << std::setprecision(4) << Stats.FPS << "\n\n";
 
@@ -77,7 +80,15 @@ void UHProfileDialog::SyncProfileStatistics(UHProfiler* InProfiler, UHGameTimer*
 
         GPUStatTex << "Total GPU Time: " << TotalGPUTime << " ms\n";
         GPUStatTex << "Total Dedicated VRAM Usage: " << InGfx->GetUsedDedicatedVramMB() << " mb\n";
+        GPUStatTex << "Geometry Pass Bandwidth (estimated): " << Stats.GeometryBandwidthMB << " mb\n";
         GPUStatTex << "Render Resolution: " << InConfig->RenderingSetting().RenderWidth << "x" << InConfig->RenderingSetting().RenderHeight;
+        if (InConfig->RenderingSetting().bEnableTemporalUpscale)
+        {
+            int32_t InternalWidth = 0;
+            int32_t InternalHeight = 0;
+            InConfig->GetInternalResolution(InternalWidth, InternalHeight);
+            GPUStatTex << " (Upscaled from " << InternalWidth << "x" << InternalHeight << ")";
+        }
 
         InGameTimer->Reset();
     }
@@ -92,8 +103,10 @@ void UHProfileDialog::SyncProfileStatistics(UHProfiler* InProfiler, UHGameTimer*
         ImGui::Text(CPUStatTex.str().c_str());
 
         // print time-based cpu stat after regular stat
-        const auto& CPUScopeStats = UHGameTimerScope::GetResiteredGameTime();
-        for (size_t Idx = 0; Idx < CPUScopeStats.size(); Idx++)
+        // the text is refreshed periodically while scope times are refreshed every frame, so use the smaller count
+        const auto& CPUScopeStats = UHTraceProfiler::GetFrameScopeTimes();
+        const size_t NumScopeStats = (std::min)(CPUScopeStats.size(), CPUTimeStats.size());
+        for (size_t Idx = 0; Idx < NumScopeStats; Idx++)
         {
             ImVec4 CPUTimeStatColor;
             if (CPUScopeStats[Idx].second <= 0.1)
@@ -72,6 +72,7 @@ void UHSettingDialog::Update(bool& bIsDialogActive)
     ImGui::InputFloat("FPSLimit", &EngineSettings.FPSLimit);
     ImGui::InputFloat("MeshBufferMemoryBudgetMB*", &EngineSettings.MeshBufferMemoryBudgetMB);
     ImGui::InputFloat("ImageMemoryBudgetMB*", &EngineSettings.ImageMemoryBudgetMB);
+    ImGui::InputFloat("StagingRingSizeMB*", &EngineSettings.StagingRingSizeMB);
     ImGui::NewLine();
 
     // rendering settings
@@ -111,7 +112,21 @@ void UHSettingDialog::Update(bool& bIsDialogActive)
         Engine->SetResizeReason(UHEngineResizeReason::NewResolution);
     }
 
+    // upscaler replaces TAA, the resolution changes after toggling it
+    ImGui::BeginDisabled(RenderingSettings.bEnableTemporalUpscale);
     ImGui::Checkbox("Enable TAA", &RenderingSettings.bTemporalAA);
+    ImGui::EndDisabled();
+    if (ImGui::Checkbox("Enable Temporal Upscale", &RenderingSettings.bEnableTemporalUpscale))
+    {
+        Engine->SetResizeReason(UHEngineResizeReason::NewResolution);
+    }
+    ImGui::BeginDisabled(!RenderingSettings.bEnableTemporalUpscale);
+    ImGui::SliderFloat("Temporal Upscale Ratio", &RenderingSettings.TemporalUpscaleRatio, 0.5f, 1.0f, "%.2f");
+    if (ImGui::IsItemDeactivatedAfterEdit())
+    {
+        Engine->SetResizeReason(UHEngineResizeReason::NewResolution);
+    }
+    ImGui::EndDisabled();
     ImGui::Checkbox("Enable GPU Labeling (For RenderDoc debugging)", &RenderingSettings.bEnableGPULabeling);
     ImGui::Checkbox("Enable Layer Validation*", &RenderingSettings.bEnableLayerValidation);
     if (ImGui::Checkbox("Enable GPU Timing", &RenderingSettings.bEnableGPUTiming))
@@ -119,12 +134,15 @@ void UHSettingDialog::Update(bool& bIsDialogActive)
         GEnableGPUTiming = RenderingSettings.bEnableGPUTiming;
     }
 
+    // visibility buffer IDs are output in depth pre pass, it can't be turned off
+    ImGui::BeginDisabled(Engine->GetGfx()->IsVisibilityBufferEnabled());
     if (ImGui::Checkbox("Enable Depth Pre Pass", &RenderingSettings.bEnableDepthPrePass))
     {
         Engine->GetGfx()->WaitGPU();
         Engine->GetGfx()->SetDepthPrepassActive(RenderingSettings.bEnableDepthPrePass);
         DeferredRenderer->ToggleDepthPrepass();
     }
+    ImGui::EndDisabled();
 
     if (ImGui::Checkbox("Enable Async Compute", &RenderingSettings.bEnableAsyncCompute))
     {
@@ -132,6 +150,15 @@ void UHSettingDialog::Update(bool& bIsDialogActive)
         RenderingSettings.bEnableAsyncCompute ? (void)DeferredRenderer->CreateAsyncComputeQueue() : DeferredRenderer->ReleaseAsyncComputeQueue();
     }
 
+    if (RenderingSettings.bEnableAsyncCompute)
+    {
+        // the passes are scheduled per frame, no need to wait GPU
+        ImGui::Checkbox("Async RT Shadow", &RenderingSettings.bAsyncRTShadow);
+        ImGui::Checkbox("Async RT Indirect Light", &RenderingSettings.bAsyncRTIndirectLight);
+    }
+
+    ImGui::Checkbox("Enable Vertex Compression*", &RenderingSettings.bEnableVertexCompression);
+    ImGui::Checkbox("Enable Visibility Buffer (Mesh shader only)*", &RenderingSettings.bEnableVisibilityBuffer);
     ImGui::Checkbox("Enable Hardware Occlusion", &RenderingSettings.bEnableHardwareOcclusion);
     ImGui::InputInt("Occlusion triangle threshold", &RenderingSettings.OcclusionTriangleThreshold);
 
@@ -193,6 +220,15 @@ void UHSettingDialog::Update(bool& bIsDialogActive)
 
     ImGui::InputFloat("RT Culling Distance", &RenderingSettings.RTCullingRadius);
     ImGui::Checkbox("Ray Tracing Denoise", &RenderingSettings.bDenoiseRayTracing);
+    ImGui::Checkbox("RT Adaptive Rays", &RenderingSettings.bEnableRTAdaptiveRays);
+    if (RenderingSettings.bEnableRTAdaptiveRays)
+    {
+        if (ImGui::InputFloat("RT Ray Budget (ms)", &RenderingSettings.RTRayBudgetMS))
+        {
+            RenderingSettings.RTRayBudgetMS = std::max(RenderingSettings.RTRayBudgetMS, 0.1f);
+        }
+    }
+    ImGui::Checkbox("RT Result Cache", &RenderingSettings.bEnableRTResultCache);
     ImGui::NewLine();
 
     // RT Shadow
@@ -526,6 +526,9 @@ void UHTextureCreationDialog::ControlCubemapCreate()
         std::string SavedPathName = UHUtilities::StringReplace(OutputPathName, "\\", GPathSeparator);
         SavedPathName = UHUtilities::StringReplace(SavedPathName, GTextureAssetFolder, "");
         NewCube->SetSourcePath(SavedPathName);
+
+        // bake sky lighting from the uncompressed slices, so compressed formats can be baked as well
+        NewCube->BakeLighting(SliceData, UncompressedFormat);
         NewCube->Export(GTextureAssetFolder + GPathSeparator + NewCube->GetSourcePath());
 
         CubemapDialog->OnCreationFinished(NewCube);
@@ -627,6 +630,7 @@ void UHTextureCreationDialog::ControlCubemapCreate()
 
         // Step 3 ------------------------------------------------- readback slice data and compress again
         const std::string CubeName = Slices[0]->GetName() + "_Cube";
+        std::vector<uint8_t> UncompressedData[6];
 
         for (int32_t Idx = 0; Idx < 6; Idx++)
         {
@@ -640,6 +644,7 @@ void UHTextureCreationDialog::ControlCubemapCreate()
             // request new slice and recreate with readback data
             CubemapRT[Idx]->SetGfxCache(Gfx);
             const std::vector<uint8_t>& Data = CubemapRT[Idx]->ReadbackTextureData();
+            UncompressedData[Idx] = Data;
             const std::string SliceName = "CubemapCreationSlice" + std::to_string(Idx);
             UniquePtr<UHTexture2D> Slice = MakeUnique<UHTexture2D>(SliceName, SliceName, Slices[Idx]->GetExtent(), Slices[Idx]->GetFormat(), Settings);
             Slices[Idx] = Gfx->RequestTexture2D(Slice, false);
@@ -670,6 +675,7 @@ void UHTextureCreationDialog::ControlCubemapCreate()
                 NewCube->Build(Gfx, Builder);
                 Gfx->EndOneTimeCmd(Cmd);
             }
+            NewCube->BakeLighting(UncompressedData, UncompressedFormat);
             NewCube->Export(GTextureAssetFolder + GPathSeparator + NewCube->GetSourcePath());
 
             CubemapDialog->OnCreationFinished(NewCube);
@@ -63,7 +63,6 @@ void UHEditor::OnEditorUpdate()
     }
 
     Input->SetInputEnabled(!bIsDialogActive);
-    UHGameTimerScope::ClearRegisteredGameTime();
     UHGPUTimeQueryScope::ClearRegisteredGPUTime();
 }
 
@@ -72,7 +72,7 @@ void UHPreviewScene::Render(bool bIsActive)
 		MeshPreviewShader = MakeUnique<UHMeshPreviewShader>(Gfx, "MeshPreviewShader", PreviewRenderPass.RenderPass);
 	}
 
-	UHMatrix4x4 ViewProj = PreviewCamera->GetViewProjMatrixNonJittered();
+	UHMatrix4x4 ViewProj = CurrentMesh->GetPositionDecodeMatrix() * PreviewCamera->GetViewProjMatrixNonJittered();
 	MeshPreviewData->UploadData(&ViewProj, 0);
 	MeshPreviewShader->BindConstant(MeshPreviewData, 0, 0, 0);
 
@@ -109,6 +109,7 @@ void UHPreviewScene::SetMesh(UHMesh* InMesh)
 {
 	CurrentMesh = InMesh;
 	CurrentMesh->CreateGPUBuffers(Gfx);
+	Gfx->GetStagingRing()->FlushAndWait();
 
 	// make camera in front of mesh's center
 	PreviewCamera->SetRotation(UHVector3(0, 0, 0));
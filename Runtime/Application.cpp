@@ -18,8 +18,10 @@ UHEngine* UHApplication::GetEngine()
 
 int32_t UHApplication::Run()
 {
-	// setup rand seed
-	srand((uint32_t)time(nullptr));
+	// setup rand seed, benchmark needs to be deterministic
+	srand(BenchmarkSettings.bEnabled ? 0 : (uint32_t)time(nullptr));
+	GIsOffscreen = GIsOffscreen || HeadlessSettings.bEnabled;
+	GIsHeadless = GIsHeadless || BenchmarkSettings.bEnabled || GIsOffscreen;
 
 	// platform specific initialization
 	Platform = MakeUnique<UHPlatform>();
@@ -34,6 +36,14 @@ int32_t UHApplication::Run()
 		UHStatusDialogScope StatusDialog("Loading...");
 		Engine = MakeUnique<UHEngine>();
 		Engine->LoadConfig();
+		if (HeadlessSettings.bEnabled)
+		{
+			UHHeadless::OverrideConfig(Engine->GetConfigManager(), HeadlessSettings);
+		}
+		if (BenchmarkSettings.bEnabled)
+		{
+			UHBenchmark::OverrideConfig(Engine->GetConfigManager(), BenchmarkSettings);
+		}
 
 		UHClient* Client = Platform->GetClient();
 		if (!Engine->InitEngine(Client))
@@ -45,6 +55,16 @@ int32_t UHApplication::Run()
 		}
 	}
 
+	if (BenchmarkSettings.bEnabled)
+	{
+		return RunBenchmark();
+	}
+
+	if (HeadlessSettings.bEnabled)
+	{
+		return RunHeadless();
+	}
+
 	// game engine loop
 	UHClient* Client = Platform->GetClient();
 	while (true)
@@ -84,6 +104,12 @@ int32_t UHApplication::Run()
 			}
 
 #if WITH_EDITOR               
+			// platform windows are created and submitted on GT with the same graphics queue, sync with render thread first
+			if (ImGui::GetPlatformIO().Viewports.Size > 1)
+			{
+				Engine->GetGfx()->WaitRenderThread();
+			}
+
 			// tricky workaround for HDR toggling, when the platform window of ImGui is outside the main window
 			// the window needs to be re-created to match the swapchain format
 			static bool bIsHDRAvailablePrev = Engine->GetGfx()->IsHDRAvailable();
@@ -114,4 +140,83 @@ int32_t UHApplication::Run()
 
 	Platform->Shutdown();
 	return 0;
+}
+
+void UHApplication::SetBenchmarkSettings(const UHBenchmarkSettings& InSettings)
+{
+	BenchmarkSettings = InSettings;
+}
+
+void UHApplication::SetHeadlessSettings(const UHHeadlessSettings& InSettings)
+{
+	HeadlessSettings = InSettings;
+}
+
+// benchmark loop, it doesn't save config since the settings are overridden
+int32_t UHApplication::RunBenchmark()
+{
+	int32_t ExitCode = 1;
+	{
+		UHBenchmark Benchmark(Engine.get(), BenchmarkSettings);
+		if (Benchmark.Initialize())
+		{
+			UHClient* Client = Platform->GetClient();
+			while (!Benchmark.IsFinished())
+			{
+				Client->ProcessEvents();
+				if (Client->IsQuit())
+				{
+					break;
+				}
+
+				Benchmark.BeginFrame();
+				Engine->Update();
+				Engine->RenderLoop();
+				Benchmark.EndFrame();
+			}
+
+			if (Benchmark.IsFinished() && Benchmark.WriteResults())
+			{
+				ExitCode = 0;
+			}
+		}
+	}
+
+	Engine->ReleaseEngine();
+	Engine.reset();
+	Platform->Shutdown();
+	return ExitCode;
+}
+
+// offscreen loop, it runs the given frame count or until SIGINT/SIGTERM and doesn't save config either
+int32_t UHApplication::RunHeadless()
+{
+	int32_t ExitCode = 1;
+	{
+		UHHeadless Headless(Engine.get(), HeadlessSettings);
+		if (Headless.Initialize())
+		{
+			UHClient* Client = Platform->GetClient();
+			while (!Headless.IsFinished())
+			{
+				Client->ProcessEvents();
+				if (Client->IsQuit())
+				{
+					break;
+				}
+
+				Engine->Update();
+				Engine->RenderLoop();
+				Headless.EndFrame();
+			}
+
+			Headless.Finish();
+			ExitCode = 0;
+		}
+	}
+
+	Engine->ReleaseEngine();
+	Engine.reset();
+	Platform->Shutdown();
+	return ExitCode;
 }
\ No newline at end of file
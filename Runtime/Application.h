@@ -1,6 +1,8 @@
 #pragma once
 #include "Platform/Platform.h"
 #include "Runtime/Engine/Engine.h"
+#include "Runtime/Engine/Benchmark.h"
+#include "Runtime/Engine/Headless.h"
 
 // UnheardEngine application, usually called by the program entry point.
 class UHApplication
@@ -10,7 +12,18 @@ public:
 	int32_t Run();
 	UHEngine* GetEngine();
 
+	// set before Run(), the application runs the benchmark instead of the game loop
+	void SetBenchmarkSettings(const UHBenchmarkSettings& InSettings);
+
+	// set before Run(), the application renders offscreen without a window
+	void SetHeadlessSettings(const UHHeadlessSettings& InSettings);
+
 private:
+	int32_t RunBenchmark();
+	int32_t RunHeadless();
+
 	UniquePtr<UHPlatform> Platform;
 	UniquePtr<UHEngine> Engine;
+	UHBenchmarkSettings BenchmarkSettings;
+	UHHeadlessSettings HeadlessSettings;
 };
\ No newline at end of file
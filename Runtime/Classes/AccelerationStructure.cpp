@@ -3,7 +3,105 @@
 #include "Mesh.h"
 #include "../Engine/Graphic.h"
 #include "../Components/MeshRenderer.h"
+#include "GPUQuery.h"
 #include "Math.h"
+#include <algorithm>
+
+// rebuild top level AS after this number of updates, as the refitted AS degrades over time
+static const uint32_t GTopASMaxUpdateCount = 60;
+
+// rebuild top level AS when the moved instances since last build exceed this ratio of active instances
+static const float GTopASRebuildChangeRatio = 0.5f;
+
+// dirty instances within this gap are merged into a single upload
+static const uint32_t GTopASUploadMergeGap = 8;
+
+// scratch pool size for batched bottom AS builds, it's enlarged when a single build needs more than this
+static const VkDeviceSize GBottomASScratchPoolSize = 32 * 1024 * 1024;
+
+static VkDeviceSize AlignScratchSize(const VkDeviceSize InSize, const VkDeviceSize InAlignment)
+{
+	return (InSize + InAlignment - 1) / InAlignment * InAlignment;
+}
+
+UHTopASInstanceState::UHTopASInstanceState()
+	: WorldMatrix(UHMathHelpers::Identity4x4())
+	, Material(nullptr)
+	, TransformVersion(0)
+	, SquareDistanceToMainCam(0.0f)
+	, bIsEnabled(false)
+{
+
+}
+
+void UHTopASInstanceState::Capture(const UHMeshRendererComponent* InRenderer)
+{
+	WorldMatrix = InRenderer->GetWorldMatrix();
+	Material = InRenderer->GetMaterial();
+	TransformVersion = InRenderer->GetTransformVersion();
+	SquareDistanceToMainCam = InRenderer->GetSquareDistanceToMainCam();
+
+	// check visibility, can't use IsVisible() as it's set by frustum culling
+	bIsEnabled = InRenderer->IsEnabled()
+#if WITH_EDITOR
+		&& InRenderer->IsVisibleInEditor()
+#endif
+		;
+}
+
+void UHTopASTransformTracker::Resize(const uint32_t InCount)
+{
+	BuiltVersions.resize(InCount, 0);
+}
+
+bool UHTopASTransformTracker::IsChanged(const uint32_t InSlot, const UHTopASInstanceState& InState) const
+{
+	return BuiltVersions[InSlot] != InState.TransformVersion;
+}
+
+void UHTopASTransformTracker::Consume(const uint32_t InSlot, const UHTopASInstanceState& InState)
+{
+	BuiltVersions[InSlot] = InState.TransformVersion;
+}
+
+UHTopASBuildTracker::UHTopASBuildTracker()
+	: BuiltInstanceCount(0)
+	, UpdateCountSinceBuild(0)
+	, ChangedCountSinceBuild(0)
+{
+
+}
+
+void UHTopASBuildTracker::MarkChanged()
+{
+	ChangedCountSinceBuild++;
+}
+
+bool UHTopASBuildTracker::IsUpToDate(const size_t InDirtyCount, const uint32_t InActiveCount) const
+{
+	return InDirtyCount == 0 && InActiveCount == BuiltInstanceCount;
+}
+
+bool UHTopASBuildTracker::NeedRebuild(const uint32_t InActiveCount) const
+{
+	return InActiveCount != BuiltInstanceCount
+		|| UpdateCountSinceBuild >= GTopASMaxUpdateCount
+		|| ChangedCountSinceBuild > static_cast<uint32_t>((std::max)(InActiveCount, 1U) * GTopASRebuildChangeRatio);
+}
+
+void UHTopASBuildTracker::OnBuilt(const uint32_t InActiveCount, const bool bIsUpdate)
+{
+	if (bIsUpdate)
+	{
+		UpdateCountSinceBuild++;
+	}
+	else
+	{
+		BuiltInstanceCount = InActiveCount;
+		UpdateCountSinceBuild = 0;
+		ChangedCountSinceBuild = 0;
+	}
+}
 
 UHAccelerationStructure::UHAccelerationStructure()
     : AccelerationStructureBuffer(nullptr)
@@ -13,6 +111,10 @@ UHAccelerationStructure::UHAccelerationStructure()
 	, GeometryKHRCache(VkAccelerationStructureGeometryKHR())
 	, GeometryInfoCache(VkAccelerationStructureBuildGeometryInfoKHR())
 	, RangeInfoCache(VkAccelerationStructureBuildRangeInfoKHR())
+	, MeshCache(nullptr)
+	, BuildScratchSize(0)
+	, AccelerationStructureSize(0)
+	, bIsBuilt(false)
 {
 
 }
@@ -36,7 +138,7 @@ VkDeviceAddress UHAccelerationStructure::GetDeviceAddress(VkAccelerationStructur
 }
 
 // this should called by meshes
-void UHAccelerationStructure::CreaetBottomAS(UHMesh* InMesh, VkCommandBuffer InBuffer)
+void UHAccelerationStructure::CreaetBottomAS(UHMesh* InMesh)
 {
 	// prevent duplicate builds
 	if (!GfxCache->IsRayTracingEnabled() || AccelerationStructure != nullptr)
@@ -46,46 +148,47 @@ void UHAccelerationStructure::CreaetBottomAS(UHMesh* InMesh, VkCommandBuffer InB
 
 	// filling geometry info, always assume Opaque bit here, I'll override it in top-level AS when necessary
 	uint32_t MaxPrimitiveCounts = InMesh->GetIndicesCount() / 3;
-	VkAccelerationStructureGeometryKHR GeometryKHR{};
-	GeometryKHR.sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_GEOMETRY_KHR;
-	GeometryKHR.geometryType = VK_GEOMETRY_TYPE_TRIANGLES_KHR;
-	GeometryKHR.flags = VK_GEOMETRY_OPAQUE_BIT_KHR;
+	GeometryKHRCache = VkAccelerationStructureGeometryKHR{};
+	GeometryKHRCache.sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_GEOMETRY_KHR;
+	GeometryKHRCache.geometryType = VK_GEOMETRY_TYPE_TRIANGLES_KHR;
+	GeometryKHRCache.flags = VK_GEOMETRY_OPAQUE_BIT_KHR;
 
 	// filling triangles VB/IB infos
-	GeometryKHR.geometry.triangles = VkAccelerationStructureGeometryTrianglesDataKHR{};
-	GeometryKHR.geometry.triangles.sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_GEOMETRY_TRIANGLES_DATA_KHR;
+	VkAccelerationStructureGeometryTrianglesDataKHR& Triangles = GeometryKHRCache.geometry.triangles;
+	Triangles = VkAccelerationStructureGeometryTrianglesDataKHR{};
+	Triangles.sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_GEOMETRY_TRIANGLES_DATA_KHR;
 
-	// set format for Vertex position, which is float3
+	// set format for Vertex position, which is float3 or snorm16 x4 when compressed
 	// with proper stride, system should fetch vertex pos properly
-	GeometryKHR.geometry.triangles.vertexFormat = VK_FORMAT_R32G32B32_SFLOAT;
-	GeometryKHR.geometry.triangles.vertexStride = InMesh->GetPositionBuffer()->GetBufferStride();
-	GeometryKHR.geometry.triangles.vertexData.deviceAddress = GetDeviceAddress(InMesh->GetPositionBuffer()->GetBuffer());
-	GeometryKHR.geometry.triangles.maxVertex = InMesh->GetHighestIndex();
+	Triangles.vertexFormat = InMesh->IsVertexCompressed() ? VK_FORMAT_R16G16B16A16_SNORM : VK_FORMAT_R32G32B32_SFLOAT;
+	Triangles.vertexStride = InMesh->GetPositionStride();
+	Triangles.vertexData.deviceAddress = GetDeviceAddress(InMesh->GetPositionBuffer()->GetBuffer());
+	Triangles.maxVertex = InMesh->GetHighestIndex();
 
 	if (InMesh->IsIndexBufer32Bit())
 	{
-		GeometryKHR.geometry.triangles.indexType = VK_INDEX_TYPE_UINT32;
-		GeometryKHR.geometry.triangles.indexData.deviceAddress = GetDeviceAddress(InMesh->GetIndexBuffer()->GetBuffer());
+		Triangles.indexType = VK_INDEX_TYPE_UINT32;
+		Triangles.indexData.deviceAddress = GetDeviceAddress(InMesh->GetIndexBuffer()->GetBuffer());
 	}
 	else
 	{
-		GeometryKHR.geometry.triangles.indexType = VK_INDEX_TYPE_UINT16;
-		GeometryKHR.geometry.triangles.indexData.deviceAddress = GetDeviceAddress(InMesh->GetIndexBuffer16()->GetBuffer());
+		Triangles.indexType = VK_INDEX_TYPE_UINT16;
+		Triangles.indexData.deviceAddress = GetDeviceAddress(InMesh->GetIndexBuffer16()->GetBuffer());
 	}
 
-	// filling geometry info
-	VkAccelerationStructureBuildGeometryInfoKHR GeometryInfo{};
-	GeometryInfo.sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_BUILD_GEOMETRY_INFO_KHR;
-	GeometryInfo.type = VK_ACCELERATION_STRUCTURE_TYPE_BOTTOM_LEVEL_KHR;
-	GeometryInfo.mode = VK_BUILD_ACCELERATION_STRUCTURE_MODE_BUILD_KHR;
-	GeometryInfo.flags = VK_BUILD_ACCELERATION_STRUCTURE_PREFER_FAST_TRACE_BIT_KHR;
-	GeometryInfo.geometryCount = 1;
-	GeometryInfo.pGeometries = &GeometryKHR;
+	// filling geometry info, allow compaction so the AS can be shrunk after build
+	GeometryInfoCache = VkAccelerationStructureBuildGeometryInfoKHR{};
+	GeometryInfoCache.sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_BUILD_GEOMETRY_INFO_KHR;
+	GeometryInfoCache.type = VK_ACCELERATION_STRUCTURE_TYPE_BOTTOM_LEVEL_KHR;
+	GeometryInfoCache.mode = VK_BUILD_ACCELERATION_STRUCTURE_MODE_BUILD_KHR;
+	GeometryInfoCache.flags = VK_BUILD_ACCELERATION_STRUCTURE_PREFER_FAST_TRACE_BIT_KHR | VK_BUILD_ACCELERATION_STRUCTURE_ALLOW_COMPACTION_BIT_KHR;
+	GeometryInfoCache.geometryCount = 1;
+	GeometryInfoCache.pGeometries = &GeometryKHRCache;
 
 	// fetch the size info before creating AS based on geometry info
 	VkAccelerationStructureBuildSizesInfoKHR SizeInfo{};
 	SizeInfo.sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_BUILD_SIZES_INFO_KHR;
-	GVkGetAccelerationStructureBuildSizesKHR(LogicalDevice, VK_ACCELERATION_STRUCTURE_BUILD_TYPE_DEVICE_KHR, &GeometryInfo, &MaxPrimitiveCounts, &SizeInfo);
+	GVkGetAccelerationStructureBuildSizesKHR(LogicalDevice, VK_ACCELERATION_STRUCTURE_BUILD_TYPE_DEVICE_KHR, &GeometryInfoCache, &MaxPrimitiveCounts, &SizeInfo);
 
 	// build bottom-level AS after getting proper sizes
 	AccelerationStructureBuffer = GfxCache->RequestRenderBuffer<uint8_t>(SizeInfo.accelerationStructureSize
@@ -101,6 +204,7 @@ void UHAccelerationStructure::CreaetBottomAS(UHMesh* InMesh, VkCommandBuffer InB
 	if (GVkCreateAccelerationStructureKHR(LogicalDevice, &CreateInfo, nullptr, &AccelerationStructure) != VK_SUCCESS)
 	{
 		UHE_LOG("Failed to create bottom level AS!\n");
+		return;
 	}
 
 #if WITH_EDITOR
@@ -108,115 +212,291 @@ void UHAccelerationStructure::CreaetBottomAS(UHMesh* InMesh, VkCommandBuffer InB
 	GfxCache->SetDebugUtilsObjectName(VK_OBJECT_TYPE_ACCELERATION_STRUCTURE_KHR, (uint64_t)AccelerationStructure, ObjName);
 #endif
 
-	// allocate scratch buffer as well, this buffer is for initialization
-	ScratchBuffer = GfxCache->RequestRenderBuffer<uint8_t>(SizeInfo.buildScratchSize, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT
-		, "BottomLevelAS_ScratchBuffer");
-	GeometryInfo.scratchData.deviceAddress = GetDeviceAddress(ScratchBuffer->GetBuffer());
-
-	// actually build AS, this needs to push command
-	VkAccelerationStructureBuildRangeInfoKHR RangeInfo{};
-	RangeInfo.primitiveCount = MaxPrimitiveCounts;
-	const VkAccelerationStructureBuildRangeInfoKHR* RangeInfos[1] = { &RangeInfo };
-	GeometryInfo.dstAccelerationStructure = AccelerationStructure;
+	// scratch buffer isn't allocated here, it's sub-allocated from a shared pool during batch build
+	RangeInfoCache = VkAccelerationStructureBuildRangeInfoKHR{};
+	RangeInfoCache.primitiveCount = MaxPrimitiveCounts;
+	GeometryInfoCache.dstAccelerationStructure = AccelerationStructure;
 
-	GVkCmdBuildAccelerationStructuresKHR(InBuffer, 1, &GeometryInfo, RangeInfos);
+	MeshCache = InMesh;
+	BuildScratchSize = SizeInfo.buildScratchSize;
+	AccelerationStructureSize = SizeInfo.accelerationStructureSize;
+	bIsBuilt = false;
 }
 
-// this should be called by renderer
-uint32_t UHAccelerationStructure::CreateTopAS(const std::vector<UHMeshRendererComponent*>& InRenderers, VkCommandBuffer InBuffer)
+// batch build of bottom AS, the steps are:
+// 1. sub-allocate scratch from a shared pool and record as many builds as the pool can hold into a single build call
+// 2. query compacted size of each built AS
+// 3. copy-compact the AS to a smaller buffer and release the original one
+void UHAccelerationStructure::BuildBottomASBatch(UHGraphic* InGfx, const std::vector<UHAccelerationStructure*>& InBottomASs)
 {
-	// prevent duplicate builds
-	// to update Top AS, call UpdateTopAS instead
-	if (!GfxCache->IsRayTracingEnabled() || AccelerationStructure)
+	if (!InGfx->IsRayTracingEnabled())
 	{
-		return 0;
+		return;
 	}
 
-	InstanceKHRs.resize(InRenderers.size());
-	RendererCache.resize(InRenderers.size());
+	// collect pending bottom AS
+	std::vector<UHAccelerationStructure*> PendingASs;
+	VkDeviceSize MaxScratchSize = 0;
+	const VkDeviceSize ScratchAlignment = InGfx->GetMinASScratchOffsetAlignment();
+	for (UHAccelerationStructure* AS : InBottomASs)
+	{
+		if (AS && AS->AccelerationStructure != nullptr && !AS->bIsBuilt)
+		{
+			PendingASs.push_back(AS);
+			MaxScratchSize = (std::max)(MaxScratchSize, AlignScratchSize(AS->BuildScratchSize, ScratchAlignment));
+		}
+	}
 
-	// add top-level instance per-renderer
-	uint32_t InstanceCount = 0;
-	for (size_t Idx = 0; Idx < InRenderers.size(); Idx++)
+	if (PendingASs.size() == 0)
 	{
-		// refresh transform once
-		InRenderers[Idx]->Update();
-		UHMaterial* Mat = InRenderers[Idx]->GetMaterial();
+		return;
+	}
 
-		// hit every thing for now
-		VkAccelerationStructureInstanceKHR InstanceKHR{};
-		InstanceKHR.mask = 0xff;
+	const VkDevice Device = InGfx->GetLogicalDevice();
+	const uint32_t ASCount = static_cast<uint32_t>(PendingASs.size());
+
+	// scratch pool, it should be able to hold the largest request at least
+	// allocate extra alignment size in case the buffer address isn't aligned
+	const VkDeviceSize ScratchPoolSize = (std::max)(GBottomASScratchPoolSize, MaxScratchSize);
+	UniquePtr<UHRenderBuffer<uint8_t>> ScratchPool = InGfx->RequestRenderBuffer<uint8_t>(ScratchPoolSize + ScratchAlignment
+		, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT
+		, "BottomLevelAS_ScratchPool");
+	VkDeviceAddress ScratchAddress = PendingASs[0]->GetDeviceAddress(ScratchPool->GetBuffer());
+	ScratchAddress = AlignScratchSize(ScratchAddress, ScratchAlignment);
+
+	UHGPUQuery* CompactedSizeQuery = InGfx->RequestGPUQuery(ASCount, VK_QUERY_TYPE_ACCELERATION_STRUCTURE_COMPACTED_SIZE_KHR);
+
+	// the barrier between batches, the scratch can only be reused after the previous builds are done
+	VkMemoryBarrier BuildBarrier{};
+	BuildBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+	BuildBarrier.srcAccessMask = VK_ACCESS_ACCELERATION_STRUCTURE_WRITE_BIT_KHR;
+	BuildBarrier.dstAccessMask = VK_ACCESS_ACCELERATION_STRUCTURE_READ_BIT_KHR | VK_ACCESS_ACCELERATION_STRUCTURE_WRITE_BIT_KHR;
+
+	VkCommandBuffer BuildCmd = InGfx->BeginOneTimeCmd();
+	vkCmdResetQueryPool(BuildCmd, CompactedSizeQuery->GetQueryPool(), 0, ASCount);
+
+	std::vector<VkAccelerationStructureBuildGeometryInfoKHR> BuildInfos;
+	std::vector<const VkAccelerationStructureBuildRangeInfoKHR*> RangeInfos;
+	std::vector<VkAccelerationStructureKHR> BuiltASs;
+	uint32_t BatchStart = 0;
+	VkDeviceSize ScratchOffset = 0;
+	uint32_t BatchCount = 0;
+
+	for (uint32_t Idx = 0; Idx <= ASCount; Idx++)
+	{
+		const VkDeviceSize ScratchSize = (Idx < ASCount)
+			? AlignScratchSize(PendingASs[Idx]->BuildScratchSize, ScratchAlignment) : 0;
 
-		// set bottom level address
-		VkAccelerationStructureKHR BottomLevelAS = InRenderers[Idx]->GetMesh()->GetBottomLevelAS()->GetAS();
-		InstanceKHR.accelerationStructureReference = GetDeviceAddress(BottomLevelAS);
+		// flush the batch when the pool is full or it reaches the end
+		if (Idx == ASCount || ScratchOffset + ScratchSize > ScratchPoolSize)
+		{
+			if (BuildInfos.size() > 0)
+			{
+				GVkCmdBuildAccelerationStructuresKHR(BuildCmd, static_cast<uint32_t>(BuildInfos.size()), BuildInfos.data(), RangeInfos.data());
+				vkCmdPipelineBarrier(BuildCmd, VK_PIPELINE_STAGE_ACCELERATION_STRUCTURE_BUILD_BIT_KHR, VK_PIPELINE_STAGE_ACCELERATION_STRUCTURE_BUILD_BIT_KHR
+					, 0, 1, &BuildBarrier, 0, nullptr, 0, nullptr);
+
+				GVkCmdWriteAccelerationStructuresPropertiesKHR(BuildCmd, static_cast<uint32_t>(BuiltASs.size()), BuiltASs.data()
+					, VK_QUERY_TYPE_ACCELERATION_STRUCTURE_COMPACTED_SIZE_KHR, CompactedSizeQuery->GetQueryPool(), BatchStart);
+
+				BatchStart += static_cast<uint32_t>(BuildInfos.size());
+				BatchCount++;
+			}
+
+			BuildInfos.clear();
+			RangeInfos.clear();
+			BuiltASs.clear();
+			ScratchOffset = 0;
+		}
+
+		if (Idx == ASCount)
+		{
+			break;
+		}
+
+		UHAccelerationStructure* AS = PendingASs[Idx];
+		AS->GeometryInfoCache.pGeometries = &AS->GeometryKHRCache;
+		AS->GeometryInfoCache.scratchData.deviceAddress = ScratchAddress + ScratchOffset;
+		BuildInfos.push_back(AS->GeometryInfoCache);
+		RangeInfos.push_back(&AS->RangeInfoCache);
+		BuiltASs.push_back(AS->AccelerationStructure);
+		ScratchOffset += ScratchSize;
+		AS->bIsBuilt = true;
+	}
+	InGfx->EndOneTimeCmd(BuildCmd);
+
+	// the scratch pool can be released after the build
+	UH_SAFE_RELEASE(ScratchPool);
+
+	// read back the compacted size, EndOneTimeCmd already waits for the queue
+	std::vector<VkDeviceSize> CompactedSizes(ASCount, 0);
+	if (vkGetQueryPoolResults(Device, CompactedSizeQuery->GetQueryPool(), 0, ASCount, ASCount * sizeof(VkDeviceSize), CompactedSizes.data()
+		, sizeof(VkDeviceSize), VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WAIT_BIT) != VK_SUCCESS)
+	{
+		UHE_LOG("Failed to get compacted size of bottom level AS, compaction is skipped.\n");
+		InGfx->RequestReleaseGPUQuery(CompactedSizeQuery);
+		return;
+	}
+	InGfx->RequestReleaseGPUQuery(CompactedSizeQuery);
 
-		// copy transform3x4
-		UHGPUMatrix3x4 Transform3x4 = UHMathHelpers::MatrixTo3x4(InRenderers[Idx]->GetWorldMatrix());
-		std::copy(&Transform3x4.M[0][0], &Transform3x4.M[0][0] + 12, &InstanceKHR.transform.matrix[0][0]);
+	// copy-compact to the new AS
+	std::vector<UniquePtr<UHRenderBuffer<uint8_t>>> CompactedBuffers(ASCount);
+	std::vector<VkAccelerationStructureKHR> CompactedASs(ASCount, nullptr);
 
-		// cull mode flag, in DXR system, it's default cull back, here just to check the other two modes
-		if (Mat->GetCullMode() == UHCullMode::CullNone)
+	VkCommandBuffer CompactCmd = InGfx->BeginOneTimeCmd();
+	for (uint32_t Idx = 0; Idx < ASCount; Idx++)
+	{
+		UHAccelerationStructure* AS = PendingASs[Idx];
+		if (CompactedSizes[Idx] == 0 || CompactedSizes[Idx] >= AS->AccelerationStructureSize)
 		{
-			InstanceKHR.flags |= VK_GEOMETRY_INSTANCE_TRIANGLE_FACING_CULL_DISABLE_BIT_KHR;
+			continue;
 		}
-		else if (Mat->GetCullMode() == UHCullMode::CullFront)
+
+		CompactedBuffers[Idx] = InGfx->RequestRenderBuffer<uint8_t>(CompactedSizes[Idx]
+			, VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_STORAGE_BIT_KHR | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT
+			, AS->MeshCache->GetName() + "_BottomLevelAS_Buffer");
+
+		VkAccelerationStructureCreateInfoKHR CreateInfo{};
+		CreateInfo.sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_CREATE_INFO_KHR;
+		CreateInfo.type = VK_ACCELERATION_STRUCTURE_TYPE_BOTTOM_LEVEL_KHR;
+		CreateInfo.buffer = CompactedBuffers[Idx]->GetBuffer();
+		CreateInfo.size = CompactedSizes[Idx];
+
+		if (GVkCreateAccelerationStructureKHR(Device, &CreateInfo, nullptr, &CompactedASs[Idx]) != VK_SUCCESS)
 		{
-			InstanceKHR.flags |= VK_GEOMETRY_INSTANCE_TRIANGLE_FLIP_FACING_BIT_KHR;
+			UHE_LOG("Failed to create compacted bottom level AS!\n");
+			UH_SAFE_RELEASE(CompactedBuffers[Idx]);
+			CompactedASs[Idx] = nullptr;
+			continue;
 		}
 
-		// non-opaque flag, cutoff is treated as translucent as well so I can ignore the hit on culled pixel
-		if (Mat->GetBlendMode() > UHBlendMode::Opaque)
+		VkCopyAccelerationStructureInfoKHR CopyInfo{};
+		CopyInfo.sType = VK_STRUCTURE_TYPE_COPY_ACCELERATION_STRUCTURE_INFO_KHR;
+		CopyInfo.src = AS->AccelerationStructure;
+		CopyInfo.dst = CompactedASs[Idx];
+		CopyInfo.mode = VK_COPY_ACCELERATION_STRUCTURE_MODE_COMPACT_KHR;
+		GVkCmdCopyAccelerationStructureKHR(CompactCmd, &CopyInfo);
+	}
+	InGfx->EndOneTimeCmd(CompactCmd);
+
+	// replace with the compacted AS and report the memory saved
+	VkDeviceSize TotalOriginalSize = 0;
+	VkDeviceSize TotalCompactedSize = 0;
+	for (uint32_t Idx = 0; Idx < ASCount; Idx++)
+	{
+		UHAccelerationStructure* AS = PendingASs[Idx];
+		const VkDeviceSize OriginalSize = AS->AccelerationStructureSize;
+		TotalOriginalSize += OriginalSize;
+
+		if (CompactedASs[Idx] == nullptr)
 		{
-			InstanceKHR.flags |= VK_GEOMETRY_INSTANCE_FORCE_NO_OPAQUE_BIT_KHR;
+			TotalCompactedSize += OriginalSize;
+			continue;
 		}
 
-		// set material index * 2 as SBT index, as each material has a default hitgroup and another minimal hitgroup
-		InstanceKHR.instanceShaderBindingTableRecordOffset = Mat->GetBufferDataIndex() * 2;
+		UH_SAFE_RELEASE(AS->AccelerationStructureBuffer);
+		SafeDestroyAccelerationStructure(Device, AS->AccelerationStructure);
+		AS->AccelerationStructureBuffer = UHMOVE(CompactedBuffers[Idx]);
+		AS->AccelerationStructure = CompactedASs[Idx];
+		AS->AccelerationStructureSize = CompactedSizes[Idx];
+		TotalCompactedSize += CompactedSizes[Idx];
 
-		// set material index as custom index also
-		InstanceKHR.instanceCustomIndex = Mat->GetBufferDataIndex();
+#if WITH_EDITOR
+		std::string ObjName = AS->MeshCache->GetName() + "_BottomLevelAS";
+		InGfx->SetDebugUtilsObjectName(VK_OBJECT_TYPE_ACCELERATION_STRUCTURE_KHR, (uint64_t)AS->AccelerationStructure, ObjName);
+#endif
 
-		// cache the instance KHRs and renderers for later use
-		const int32_t RendererIdx = InRenderers[Idx]->GetBufferDataIndex();
-		InstanceKHRs[RendererIdx] = InstanceKHR;
-		RendererCache[RendererIdx] = InRenderers[Idx];
-		InstanceCount++;
+		UHE_LOG("Bottom level AS compacted: " + AS->MeshCache->GetName() + " " + std::to_string(OriginalSize / 1024) + " KB -> "
+			+ std::to_string(CompactedSizes[Idx] / 1024) + " KB, saved " + std::to_string((OriginalSize - CompactedSizes[Idx]) / 1024) + " KB.\n");
+	}
+
+	UHE_LOG("Bottom level AS built: " + std::to_string(ASCount) + " meshes in " + std::to_string(BatchCount) + " batches, "
+		+ std::to_string(TotalOriginalSize / 1024) + " KB -> " + std::to_string(TotalCompactedSize / 1024) + " KB, saved "
+		+ std::to_string((TotalOriginalSize - TotalCompactedSize) / 1024) + " KB in total.\n");
+}
+
+// this should be called by renderer
+uint32_t UHAccelerationStructure::CreateTopAS(const std::vector<UHMeshRendererComponent*>& InRenderers, VkCommandBuffer InBuffer)
+{
+	// prevent duplicate builds
+	// to update Top AS, call UpdateTopAS instead
+	if (!GfxCache->IsRayTracingEnabled() || AccelerationStructure)
+	{
+		return 0;
 	}
 
 	// don't create if there is no instance
+	const uint32_t InstanceCount = static_cast<uint32_t>(InRenderers.size());
 	if (InstanceCount == 0)
 	{
 		return 0;
 	}
-	
-	// create instance KHR buffer for later use
+
+	InstanceKHRs.resize(InstanceCount);
+	RendererCache.resize(InstanceCount, nullptr);
+	MaterialCache.resize(InstanceCount, nullptr);
+	TransformTracker.Resize(InstanceCount);
+	SlotToActive.resize(InstanceCount, -1);
+	ActiveInstanceKHRs.reserve(InstanceCount);
+	ActiveSlots.reserve(InstanceCount);
+	bIsActiveIndexDirty.resize(InstanceCount, false);
+	DirtyActiveIndices.reserve(InstanceCount);
+
+	// add top-level instance per-renderer, each renderer owns a persistent slot at its buffer data index
+	for (size_t Idx = 0; Idx < InRenderers.size(); Idx++)
+	{
+		// refresh transform once
+		InRenderers[Idx]->Update();
+		const uint32_t RendererIdx = static_cast<uint32_t>(InRenderers[Idx]->GetBufferDataIndex());
+
+		// hit every thing for now
+		VkAccelerationStructureInstanceKHR InstanceKHR{};
+		InstanceKHR.mask = 0xff;
+
+		// set renderer index as custom index, as the instance index isn't the renderer index after compaction
+		// hit group shaders lookup the renderer instance and material with it
+		InstanceKHR.instanceCustomIndex = RendererIdx;
+
+		InstanceKHRs[RendererIdx] = InstanceKHR;
+		RendererCache[RendererIdx] = InRenderers[Idx];
+
+		// it's created before GT starts updating, the renderer can be read directly here
+		UHTopASInstanceState State;
+		State.Capture(InRenderers[Idx]);
+		RefreshInstanceTransform(RendererIdx, State);
+		RefreshInstanceMaterial(RendererIdx, State);
+
+		// all instances are active at the beginning, the culled ones are compacted out during update
+		ActivateInstance(RendererIdx);
+	}
+
+	// create instance KHR buffer for later use, it's persistent and sized with the max instance count
 	ASInstanceBuffer = GfxCache->RequestRenderBuffer<VkAccelerationStructureInstanceKHR>(InstanceCount
 		, VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_BUILD_INPUT_READ_ONLY_BIT_KHR | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT
 		, "Scene_TopLevelAS_InstanceBuffer");
-	ASInstanceBuffer->UploadAllData(InstanceKHRs.data());
+	UploadDirtyInstances();
 
 	// setup instance type
-	VkAccelerationStructureGeometryKHR GeometryKHR{};
-	GeometryKHR.sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_GEOMETRY_KHR;
-	GeometryKHR.geometryType = VK_GEOMETRY_TYPE_INSTANCES_KHR;
-	GeometryKHR.geometry.instances = VkAccelerationStructureGeometryInstancesDataKHR{};
-	GeometryKHR.geometry.instances.sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_GEOMETRY_INSTANCES_DATA_KHR;
-	GeometryKHR.geometry.instances.data.deviceAddress = GetDeviceAddress(ASInstanceBuffer->GetBuffer());
+	GeometryKHRCache = VkAccelerationStructureGeometryKHR{};
+	GeometryKHRCache.sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_GEOMETRY_KHR;
+	GeometryKHRCache.geometryType = VK_GEOMETRY_TYPE_INSTANCES_KHR;
+	GeometryKHRCache.geometry.instances = VkAccelerationStructureGeometryInstancesDataKHR{};
+	GeometryKHRCache.geometry.instances.sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_GEOMETRY_INSTANCES_DATA_KHR;
+	GeometryKHRCache.geometry.instances.data.deviceAddress = GetDeviceAddress(ASInstanceBuffer->GetBuffer());
 
 	// geometry count must be 1 when it's top level
-	VkAccelerationStructureBuildGeometryInfoKHR GeometryInfo{};
-	GeometryInfo.sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_BUILD_GEOMETRY_INFO_KHR;
-	GeometryInfo.type = VK_ACCELERATION_STRUCTURE_TYPE_TOP_LEVEL_KHR;
-	GeometryInfo.mode = VK_BUILD_ACCELERATION_STRUCTURE_MODE_BUILD_KHR;
-	GeometryInfo.flags = VK_BUILD_ACCELERATION_STRUCTURE_PREFER_FAST_TRACE_BIT_KHR | VK_BUILD_ACCELERATION_STRUCTURE_ALLOW_UPDATE_BIT_KHR;
-	GeometryInfo.geometryCount = 1;
-	GeometryInfo.pGeometries = &GeometryKHR;
+	GeometryInfoCache = VkAccelerationStructureBuildGeometryInfoKHR{};
+	GeometryInfoCache.sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_BUILD_GEOMETRY_INFO_KHR;
+	GeometryInfoCache.type = VK_ACCELERATION_STRUCTURE_TYPE_TOP_LEVEL_KHR;
+	GeometryInfoCache.mode = VK_BUILD_ACCELERATION_STRUCTURE_MODE_BUILD_KHR;
+	GeometryInfoCache.flags = VK_BUILD_ACCELERATION_STRUCTURE_PREFER_FAST_TRACE_BIT_KHR | VK_BUILD_ACCELERATION_STRUCTURE_ALLOW_UPDATE_BIT_KHR;
+	GeometryInfoCache.geometryCount = 1;
+	GeometryInfoCache.pGeometries = &GeometryKHRCache;
 
-	// fetch the size info before creating AS based on geometry info
+	// fetch the size info before creating AS based on geometry info, use the max instance count
 	VkAccelerationStructureBuildSizesInfoKHR SizeInfo{};
 	SizeInfo.sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_BUILD_SIZES_INFO_KHR;
-	GVkGetAccelerationStructureBuildSizesKHR(LogicalDevice, VK_ACCELERATION_STRUCTURE_BUILD_TYPE_DEVICE_KHR, &GeometryInfo, &InstanceCount, &SizeInfo);
+	GVkGetAccelerationStructureBuildSizesKHR(LogicalDevice, VK_ACCELERATION_STRUCTURE_BUILD_TYPE_DEVICE_KHR, &GeometryInfoCache, &InstanceCount, &SizeInfo);
 
 	// build bottom-level AS after getting proper sizes
 	AccelerationStructureBuffer = GfxCache->RequestRenderBuffer<uint8_t>(SizeInfo.accelerationStructureSize, VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_STORAGE_BIT_KHR
@@ -238,96 +518,244 @@ uint32_t UHAccelerationStructure::CreateTopAS(const std::vector<UHMeshRendererCo
 	GfxCache->SetDebugUtilsObjectName(VK_OBJECT_TYPE_ACCELERATION_STRUCTURE_KHR, (uint64_t)AccelerationStructure, ObjName);
 #endif
 
-	// allocate scratch buffer as well, this buffer is for initialization
-	ScratchBuffer = GfxCache->RequestRenderBuffer<uint8_t>(SizeInfo.buildScratchSize, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT
+	// allocate scratch buffer as well, it's kept for both update and rebuild later
+	ScratchBuffer = GfxCache->RequestRenderBuffer<uint8_t>((std::max)(SizeInfo.buildScratchSize, SizeInfo.updateScratchSize)
+		, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT
 		, "TopLevelAS_ScratchBuffer");
-	GeometryInfo.scratchData.deviceAddress = GetDeviceAddress(ScratchBuffer->GetBuffer());
-
-	// actually build AS, this needs to push command, primitive count is used as instance count in Vulkan spec if it's VK_GEOMETRY_TYPE_INSTANCES_KHR
-	VkAccelerationStructureBuildRangeInfoKHR RangeInfo{};
-	RangeInfo.primitiveCount = InstanceCount;
-	const VkAccelerationStructureBuildRangeInfoKHR* RangeInfos[1] = { &RangeInfo };
-	GeometryInfo.dstAccelerationStructure = AccelerationStructure;
+	GeometryInfoCache.scratchData.deviceAddress = GetDeviceAddress(ScratchBuffer->GetBuffer());
 
-	GVkCmdBuildAccelerationStructuresKHR(InBuffer, 1, &GeometryInfo, RangeInfos);
-
-	GeometryKHRCache = GeometryKHR;
-	GeometryInfoCache = GeometryInfo;
-	RangeInfoCache = RangeInfo;
-
-	// set geometry info as mode update for later use
-	GeometryInfoCache.mode = VK_BUILD_ACCELERATION_STRUCTURE_MODE_UPDATE_KHR;
-	GeometryInfoCache.srcAccelerationStructure = GeometryInfoCache.dstAccelerationStructure;
-	GeometryInfoCache.pGeometries = &GeometryKHRCache;
+	// actually build AS
+	BuildTopAS(InBuffer, false);
 
 	return InstanceCount;
 }
 
 // update top AS
-void UHAccelerationStructure::UpdateTopAS(VkCommandBuffer InBuffer, const int32_t CurrentFrameRT, const float RTCullingDistance)
+void UHAccelerationStructure::UpdateTopAS(VkCommandBuffer InBuffer, const std::vector<UHTopASInstanceState>& InStates, const float RTCullingDistance)
 {
-	for (size_t Idx = 0; Idx < InstanceKHRs.size(); Idx++)
+	if (AccelerationStructure == nullptr)
 	{
-		UHMeshRendererComponent* Renderer = RendererCache[Idx];
+		return;
+	}
 
-		// copy transform3x4 when it's dirty
-		if (Renderer->IsTransformChanged())
+	const uint32_t SlotCount = static_cast<uint32_t>((std::min)(RendererCache.size(), InStates.size()));
+	for (uint32_t Slot = 0; Slot < SlotCount; Slot++)
+	{
+		if (RendererCache[Slot] == nullptr)
 		{
-			UHGPUMatrix3x4 Transform3x4 = UHMathHelpers::MatrixTo3x4(Renderer->GetWorldMatrix());
-			std::copy(&Transform3x4.M[0][0], &Transform3x4.M[0][0] + 12, &InstanceKHRs[Idx].transform.matrix[0][0]);
-
-			// refresh bottom level address
-			VkAccelerationStructureKHR BottomLevelAS = Renderer->GetMesh()->GetBottomLevelAS()->GetAS();
-			InstanceKHRs[Idx].accelerationStructureReference = GetDeviceAddress(BottomLevelAS);
+			continue;
 		}
 
-		// check visibility, can't use IsVisible() as it's set by frustum culling
-		bool bIsVisible = Renderer->IsEnabled()
-#if WITH_EDITOR
-			&& Renderer->IsVisibleInEditor()
-#endif
-			;
+		// compact out the culled instance, the slot is kept for later activation
+		const UHTopASInstanceState& State = InStates[Slot];
+		const int32_t ActiveIdx = SlotToActive[Slot];
+		if (!IsInstanceVisible(State, RTCullingDistance))
+		{
+			if (ActiveIdx >= 0)
+			{
+				DeactivateInstance(Slot);
+			}
+			continue;
+		}
 
-		if (bIsVisible)
+		// newly visible instance, its states could be changed while it's culled, always refresh them
+		if (ActiveIdx < 0)
 		{
-			// only check culling distance when the component is visible
-			bIsVisible &= (Renderer->GetSquareDistanceToMainCam() < RTCullingDistance * RTCullingDistance);
+			RefreshInstanceTransform(Slot, State);
+			RefreshInstanceMaterial(Slot, State);
+			ActivateInstance(Slot);
+			continue;
 		}
-		InstanceKHRs[Idx].mask = bIsVisible ? 0xff : 0;
 
-		// check material state
-		UHMaterial* Mat = RendererCache[Idx]->GetMaterial();
-		InstanceKHRs[Idx].flags = 0;
+		// copy transform3x4 when it's newer than the one built into this TLAS
+		// the other TLAS tracks its own version, so a single-frame move still reaches it in its frame slot
+		bool bIsDirty = false;
+		if (TransformTracker.IsChanged(Slot, State))
+		{
+			RefreshInstanceTransform(Slot, State);
+			BuildTracker.MarkChanged();
+			bIsDirty = true;
+		}
 
-		// cull mode flag, in DXR system, it's default cull back, here just to check the other two modes
-		if (Mat->GetCullMode() == UHCullMode::CullNone)
+		// material states can only be changed in editor, otherwise only check when the material is swapped
+		if (GIsEditor || State.Material != MaterialCache[Slot])
 		{
-			InstanceKHRs[Idx].flags |= VK_GEOMETRY_INSTANCE_TRIANGLE_FACING_CULL_DISABLE_BIT_KHR;
+			bIsDirty |= RefreshInstanceMaterial(Slot, State);
 		}
-		else if (Mat->GetCullMode() == UHCullMode::CullFront)
+
+		if (bIsDirty)
 		{
-			InstanceKHRs[Idx].flags |= VK_GEOMETRY_INSTANCE_TRIANGLE_FLIP_FACING_BIT_KHR;
+			ActiveInstanceKHRs[ActiveIdx] = InstanceKHRs[Slot];
+			MarkActiveInstanceDirty(ActiveIdx);
 		}
+	}
+
+	// nothing changed since last build or update, the AS is still valid
+	const uint32_t ActiveCount = GetActiveInstanceCount();
+	if (BuildTracker.IsUpToDate(DirtyActiveIndices.size(), ActiveCount))
+	{
+		return;
+	}
+
+	UploadDirtyInstances();
+	BuildTopAS(InBuffer, !BuildTracker.NeedRebuild(ActiveCount));
+}
+
+bool UHAccelerationStructure::IsInstanceVisible(const UHTopASInstanceState& InState, const float RTCullingDistance) const
+{
+	// only check culling distance when the component is visible
+	return InState.bIsEnabled && InState.SquareDistanceToMainCam < RTCullingDistance * RTCullingDistance;
+}
+
+void UHAccelerationStructure::RefreshInstanceTransform(const uint32_t InSlot, const UHTopASInstanceState& InState)
+{
+	const UHMeshRendererComponent* Renderer = RendererCache[InSlot];
+	VkAccelerationStructureInstanceKHR& InstanceKHR = InstanceKHRs[InSlot];
+
+	// copy transform3x4, BLAS is built with stored positions so the position decode is merged here
+	UHGPUMatrix3x4 Transform3x4 = UHMathHelpers::MatrixTo3x4(Renderer->GetMesh()->GetPositionDecodeMatrix() * InState.WorldMatrix);
+	std::copy(&Transform3x4.M[0][0], &Transform3x4.M[0][0] + 12, &InstanceKHR.transform.matrix[0][0]);
+	TransformTracker.Consume(InSlot, InState);
+
+	// refresh bottom level address
+	VkAccelerationStructureKHR BottomLevelAS = Renderer->GetMesh()->GetBottomLevelAS()->GetAS();
+	InstanceKHR.accelerationStructureReference = GetDeviceAddress(BottomLevelAS);
+}
+
+// refresh material states of an instance, return true if anything is changed
+bool UHAccelerationStructure::RefreshInstanceMaterial(const uint32_t InSlot, const UHTopASInstanceState& InState)
+{
+	UHMaterial* Mat = InState.Material;
+	MaterialCache[InSlot] = Mat;
+
+	// cull mode flag, in DXR system, it's default cull back, here just to check the other two modes
+	VkGeometryInstanceFlagsKHR Flags = 0;
+	if (Mat->GetCullMode() == UHCullMode::CullNone)
+	{
+		Flags |= VK_GEOMETRY_INSTANCE_TRIANGLE_FACING_CULL_DISABLE_BIT_KHR;
+	}
+	else if (Mat->GetCullMode() == UHCullMode::CullFront)
+	{
+		Flags |= VK_GEOMETRY_INSTANCE_TRIANGLE_FLIP_FACING_BIT_KHR;
+	}
 
-		// non-opaque flag, cutoff is treated as translucent as well so I can ignore the hit on culled pixel
-		if (Mat->GetBlendMode() > UHBlendMode::Opaque)
+	// non-opaque flag, cutoff is treated as translucent as well so I can ignore the hit on culled pixel
+	if (Mat->GetBlendMode() > UHBlendMode::Opaque)
+	{
+		Flags |= VK_GEOMETRY_INSTANCE_FORCE_NO_OPAQUE_BIT_KHR;
+	}
+
+	// set hit group index * 2 as SBT index, as each hit group has a default and another minimal hitgroup
+	// material instances share the hit group of their parent
+	const uint32_t SBTOffset = Mat->GetHitGroupIndex() * 2;
+
+	VkAccelerationStructureInstanceKHR& InstanceKHR = InstanceKHRs[InSlot];
+	if (InstanceKHR.flags == Flags && InstanceKHR.instanceShaderBindingTableRecordOffset == SBTOffset)
+	{
+		return false;
+	}
+
+	InstanceKHR.flags = Flags;
+	InstanceKHR.instanceShaderBindingTableRecordOffset = SBTOffset;
+	return true;
+}
+
+void UHAccelerationStructure::ActivateInstance(const uint32_t InSlot)
+{
+	// append to the end of the active list
+	const uint32_t ActiveIdx = GetActiveInstanceCount();
+	ActiveInstanceKHRs.push_back(InstanceKHRs[InSlot]);
+	ActiveSlots.push_back(InSlot);
+	SlotToActive[InSlot] = static_cast<int32_t>(ActiveIdx);
+	MarkActiveInstanceDirty(ActiveIdx);
+}
+
+void UHAccelerationStructure::DeactivateInstance(const uint32_t InSlot)
+{
+	// swap with the last active instance and pop it, so the active list is always compacted
+	const uint32_t ActiveIdx = static_cast<uint32_t>(SlotToActive[InSlot]);
+	const uint32_t LastIdx = GetActiveInstanceCount() - 1;
+	if (ActiveIdx != LastIdx)
+	{
+		ActiveInstanceKHRs[ActiveIdx] = ActiveInstanceKHRs[LastIdx];
+		ActiveSlots[ActiveIdx] = ActiveSlots[LastIdx];
+		SlotToActive[ActiveSlots[ActiveIdx]] = static_cast<int32_t>(ActiveIdx);
+		MarkActiveInstanceDirty(ActiveIdx);
+	}
+
+	ActiveInstanceKHRs.pop_back();
+	ActiveSlots.pop_back();
+	SlotToActive[InSlot] = -1;
+}
+
+void UHAccelerationStructure::MarkActiveInstanceDirty(const uint32_t InActiveIdx)
+{
+	if (!bIsActiveIndexDirty[InActiveIdx])
+	{
+		bIsActiveIndexDirty[InActiveIdx] = true;
+		DirtyActiveIndices.push_back(InActiveIdx);
+	}
+}
+
+// upload dirty instances, the nearby dirty ranges are coalesced into a single copy
+void UHAccelerationStructure::UploadDirtyInstances()
+{
+	if (DirtyActiveIndices.size() == 0)
+	{
+		return;
+	}
+
+	for (const uint32_t Idx : DirtyActiveIndices)
+	{
+		bIsActiveIndexDirty[Idx] = false;
+	}
+
+	MergeDirtyRanges(DirtyActiveIndices, GetActiveInstanceCount(), UploadRanges);
+	for (const UHTopASUploadRange& Range : UploadRanges)
+	{
+		ASInstanceBuffer->UploadData(&ActiveInstanceKHRs[Range.Begin], Range.Begin, (Range.End - Range.Begin) * sizeof(VkAccelerationStructureInstanceKHR));
+	}
+
+	DirtyActiveIndices.clear();
+}
+
+void UHAccelerationStructure::MergeDirtyRanges(std::vector<uint32_t>& InOutDirtyIndices, const uint32_t InActiveCount, std::vector<UHTopASUploadRange>& OutRanges)
+{
+	OutRanges.clear();
+	std::sort(InOutDirtyIndices.begin(), InOutDirtyIndices.end());
+
+	for (const uint32_t Idx : InOutDirtyIndices)
+	{
+		// it could be compacted out after marked dirty
+		if (Idx >= InActiveCount)
 		{
-			InstanceKHRs[Idx].flags |= VK_GEOMETRY_INSTANCE_FORCE_NO_OPAQUE_BIT_KHR;
+			continue;
 		}
 
-		// set material index * 2 as SBT index, as each material has a default hitgroup and another minimal hitgroup
-		InstanceKHRs[Idx].instanceShaderBindingTableRecordOffset = Mat->GetBufferDataIndex() * 2;
+		if (OutRanges.size() > 0 && Idx <= OutRanges.back().End + GTopASUploadMergeGap)
+		{
+			OutRanges.back().End = Idx + 1;
+			continue;
+		}
 
-		// set material index as custom index also
-		InstanceKHRs[Idx].instanceCustomIndex = Mat->GetBufferDataIndex();
+		OutRanges.push_back({ Idx, Idx + 1 });
 	}
+}
+
+void UHAccelerationStructure::BuildTopAS(VkCommandBuffer InBuffer, bool bIsUpdate)
+{
+	const uint32_t ActiveCount = GetActiveInstanceCount();
 
-	// upload all data in one call
-	ASInstanceBuffer->UploadAllData(InstanceKHRs.data());
+	// primitive count is used as instance count in Vulkan spec if it's VK_GEOMETRY_TYPE_INSTANCES_KHR
+	GeometryInfoCache.mode = bIsUpdate ? VK_BUILD_ACCELERATION_STRUCTURE_MODE_UPDATE_KHR : VK_BUILD_ACCELERATION_STRUCTURE_MODE_BUILD_KHR;
+	GeometryInfoCache.srcAccelerationStructure = bIsUpdate ? AccelerationStructure : VK_NULL_HANDLE;
+	GeometryInfoCache.dstAccelerationStructure = AccelerationStructure;
+	RangeInfoCache = VkAccelerationStructureBuildRangeInfoKHR{};
+	RangeInfoCache.primitiveCount = ActiveCount;
 
-	// update it 
 	const VkAccelerationStructureBuildRangeInfoKHR* RangeInfos[1] = { &RangeInfoCache };
 	GVkCmdBuildAccelerationStructuresKHR(InBuffer, 1, &GeometryInfoCache, RangeInfos);
+	BuildTracker.OnBuilt(ActiveCount, bIsUpdate);
 }
 
 void UHAccelerationStructure::Release()
@@ -342,18 +770,12 @@ void UHAccelerationStructure::Release()
 	}
 }
 
-// release scratch buffer only, this can be cleared after initialization
-void UHAccelerationStructure::ReleaseScratch()
+VkAccelerationStructureKHR UHAccelerationStructure::GetAS() const
 {
-	if (GfxCache->IsRayTracingEnabled())
-	{
-		UH_SAFE_RELEASE(ScratchBuffer);
-		// release temp AS instance buffer as well
-		UH_SAFE_RELEASE(ASInstanceBuffer);
-	}
+	return AccelerationStructure;
 }
 
-VkAccelerationStructureKHR UHAccelerationStructure::GetAS() const
+uint32_t UHAccelerationStructure::GetActiveInstanceCount() const
 {
-	return AccelerationStructure;
+	return static_cast<uint32_t>(ActiveInstanceKHRs.size());
 }
\ No newline at end of file
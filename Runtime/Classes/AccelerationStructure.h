@@ -2,11 +2,78 @@
 #include "../Engine/RenderResource.h"
 #include "../Classes/Utility.h"
 #include "../Classes/Types.h"
+#include "../Classes/Math.h"
 #include "../../UnheardEngine.h"
 #include "RenderBuffer.h"
 
 class UHMesh;
+class UHGraphic;
 class UHMeshRendererComponent;
+class UHMaterial;
+
+// TLAS inputs of a renderer captured by GT for a frame slot
+// RT builds the TLAS from these instead of the live renderer, which GT could be updating at the same time
+struct UHTopASInstanceState
+{
+	UHTopASInstanceState();
+	void Capture(const UHMeshRendererComponent* InRenderer);
+
+	UHMatrix4x4 WorldMatrix;
+	UHMaterial* Material;
+	uint32_t TransformVersion;
+	float SquareDistanceToMainCam;
+	// enabled and visible in editor
+	bool bIsEnabled;
+};
+
+// transform versions of TLAS instance slots, each TLAS owns one
+// a TLAS is only updated in its own frame slot, so a transform change is tracked per TLAS instead of a one-frame flag
+class UHTopASTransformTracker
+{
+public:
+	void Resize(const uint32_t InCount);
+
+	// true if the captured transform is newer than the one last built into this TLAS
+	bool IsChanged(const uint32_t InSlot, const UHTopASInstanceState& InState) const;
+
+	// mark the captured transform as built
+	void Consume(const uint32_t InSlot, const UHTopASInstanceState& InState);
+
+private:
+	std::vector<uint32_t> BuiltVersions;
+};
+
+// rebuild or refit decision of a TLAS, it doesn't touch the device so it can be validated on CPU
+class UHTopASBuildTracker
+{
+public:
+	UHTopASBuildTracker();
+
+	// an active instance is moved since last build
+	void MarkChanged();
+
+	// nothing waits for upload and the instance count is the same as the last build, the AS is still valid
+	bool IsUpToDate(const size_t InDirtyCount, const uint32_t InActiveCount) const;
+
+	// instance count must be the same as the last build for updating
+	// also rebuild it after too many updates or moved instances, as the refitted AS degrades over time
+	bool NeedRebuild(const uint32_t InActiveCount) const;
+
+	// reset or accumulate the counters after building
+	void OnBuilt(const uint32_t InActiveCount, const bool bIsUpdate);
+
+private:
+	uint32_t BuiltInstanceCount;
+	uint32_t UpdateCountSinceBuild;
+	uint32_t ChangedCountSinceBuild;
+};
+
+// a range of active instances uploaded with a single copy, [Begin, End)
+struct UHTopASUploadRange
+{
+	uint32_t Begin;
+	uint32_t End;
+};
 
 // a class for managing acceleration structure
 class UHAccelerationStructure : public UHRenderResource
@@ -15,32 +82,75 @@ public:
 	UHAccelerationStructure();
 
 	// either call bottomAS or TopAS, only one instance is stored
-	void CreaetBottomAS(UHMesh* InMesh, VkCommandBuffer InBuffer);
+	// bottom AS is only created and prepared here, the actual build is done by BuildBottomASBatch
+	void CreaetBottomAS(UHMesh* InMesh);
+
+	// build all pending bottom AS in batches with a pooled scratch buffer, then compact them
+	static void BuildBottomASBatch(UHGraphic* InGfx, const std::vector<UHAccelerationStructure*>& InBottomASs);
 
-	// Create top level AS, return number of instance built
+	// Create top level AS, return number of instance slots
 	uint32_t CreateTopAS(const std::vector<UHMeshRendererComponent*>& InRenderers, VkCommandBuffer InBuffer);
-	void UpdateTopAS(VkCommandBuffer InBuffer, const int32_t CurrentFrameRT, const float RTCullingDistance);
+
+	// update top AS, only the changed instances are rewritten and uploaded
+	// culled instances are compacted out, and it's rebuilt automatically when the update quality degrades
+	// the states are indexed by renderer buffer index, which is captured by GT for this frame slot
+	void UpdateTopAS(VkCommandBuffer InBuffer, const std::vector<UHTopASInstanceState>& InStates, const float RTCullingDistance);
 
 	void Release();
-	void ReleaseScratch();
 
 	VkAccelerationStructureKHR GetAS() const;
+	uint32_t GetActiveInstanceCount() const;
+
+	// sort the dirty active indices and coalesce the nearby ones into upload ranges
+	// indices compacted out after marked dirty (>= InActiveCount) are skipped
+	static void MergeDirtyRanges(std::vector<uint32_t>& InOutDirtyIndices, const uint32_t InActiveCount, std::vector<UHTopASUploadRange>& OutRanges);
 
 private:
 	VkDeviceAddress GetDeviceAddress(VkBuffer InBuffer);
 	VkDeviceAddress GetDeviceAddress(VkAccelerationStructureKHR InAS);
 
+	bool IsInstanceVisible(const UHTopASInstanceState& InState, const float RTCullingDistance) const;
+	void RefreshInstanceTransform(const uint32_t InSlot, const UHTopASInstanceState& InState);
+	bool RefreshInstanceMaterial(const uint32_t InSlot, const UHTopASInstanceState& InState);
+	void ActivateInstance(const uint32_t InSlot);
+	void DeactivateInstance(const uint32_t InSlot);
+	void MarkActiveInstanceDirty(const uint32_t InActiveIdx);
+	void UploadDirtyInstances();
+	void BuildTopAS(VkCommandBuffer InBuffer, bool bIsUpdate);
+
 	UniquePtr<UHRenderBuffer<uint8_t>> ScratchBuffer;
 	UniquePtr<UHRenderBuffer<VkAccelerationStructureInstanceKHR>> ASInstanceBuffer;
 	UniquePtr<UHRenderBuffer<uint8_t>> AccelerationStructureBuffer;
 	VkAccelerationStructureKHR AccelerationStructure;
 
-	// instance KHRs and renderer cache, both should the same length
+	// persistent instance slots indexed by renderer buffer index, both should the same length
 	std::vector<VkAccelerationStructureInstanceKHR> InstanceKHRs;
 	std::vector<UHMeshRendererComponent*> RendererCache;
+	std::vector<UHMaterial*> MaterialCache;
+	UHTopASTransformTracker TransformTracker;
+
+	// compacted list of the visible instances, this is what actually uploaded and built
+	// ActiveSlots stores the slot of each active instance, SlotToActive stores the opposite (-1 if it's culled)
+	std::vector<VkAccelerationStructureInstanceKHR> ActiveInstanceKHRs;
+	std::vector<uint32_t> ActiveSlots;
+	std::vector<int32_t> SlotToActive;
+
+	// dirty active indices waiting for upload
+	std::vector<uint32_t> DirtyActiveIndices;
+	std::vector<bool> bIsActiveIndexDirty;
+	std::vector<UHTopASUploadRange> UploadRanges;
 
 	// cache the info too
 	VkAccelerationStructureGeometryKHR GeometryKHRCache;
 	VkAccelerationStructureBuildGeometryInfoKHR GeometryInfoCache;
 	VkAccelerationStructureBuildRangeInfoKHR RangeInfoCache;
-};
\ No newline at end of file
+
+	// bottom AS states, used for batch build and compaction report
+	UHMesh* MeshCache;
+	VkDeviceSize BuildScratchSize;
+	VkDeviceSize AccelerationStructureSize;
+	bool bIsBuilt;
+
+	// build states, used for deciding update or rebuild
+	UHTopASBuildTracker BuildTracker;
+};
@@ -0,0 +1,154 @@
+#include "AccelerationStructureTest.h"
+
+#if WITH_TESTS
+#include "TestSuite.h"
+#include "AccelerationStructure.h"
+#include "Mesh.h"
+#include "../Components/MeshRenderer.h"
+
+static const UHTestSuite GTestSuite("AccelerationStructureTest");
+
+bool UHAccelerationStructureTest::Run()
+{
+	bool bPassed = true;
+	bPassed &= TestSingleFrameMove();
+	bPassed &= TestDirtyRanges();
+	bPassed &= TestRebuildDecision();
+
+	return GTestSuite.Report(bPassed);
+}
+
+bool UHAccelerationStructureTest::TestSingleFrameMove()
+{
+	const char* TestName = "SingleFrameMove";
+	UHMesh Mesh;
+	UHMeshRendererComponent Renderer(&Mesh, nullptr);
+
+	// each frame slot has its own TLAS and GT captured states, same as the renderer
+	UHTopASInstanceState States[GMaxFrameInFlight];
+	UHTopASTransformTracker Trackers[GMaxFrameInFlight];
+
+	// the TLAS are created with the initial transform
+	Renderer.Update();
+	for (int32_t Idx = 0; Idx < GMaxFrameInFlight; Idx++)
+	{
+		States[Idx].Capture(&Renderer);
+		Trackers[Idx].Resize(1);
+		Trackers[Idx].Consume(0, States[Idx]);
+	}
+
+	// move it in a single frame, then keep it still, scene only updates the renderer while it's dirty
+	bool bPassed = true;
+	Renderer.SetPosition(UHVector3(1.0f, 2.0f, 3.0f));
+	for (int32_t Frame = 0; Frame < GMaxFrameInFlight * 2; Frame++)
+	{
+		if (Renderer.IsWorldDirty())
+		{
+			Renderer.Update();
+		}
+
+		const int32_t FrameSlot = Frame % GMaxFrameInFlight;
+		States[FrameSlot].Capture(&Renderer);
+
+		const bool bIsChanged = Trackers[FrameSlot].IsChanged(0, States[FrameSlot]);
+		if (Frame < GMaxFrameInFlight)
+		{
+			bPassed &= GTestSuite.Check(bIsChanged, TestName, "the move reaches the TLAS of every frame slot");
+			bPassed &= GTestSuite.Check(States[FrameSlot].WorldMatrix == Renderer.GetWorldMatrix(), TestName, "the captured world matrix is the moved one");
+		}
+		else
+		{
+			bPassed &= GTestSuite.Check(!bIsChanged, TestName, "a consumed move isn't seen again");
+		}
+
+		if (bIsChanged)
+		{
+			Trackers[FrameSlot].Consume(0, States[FrameSlot]);
+		}
+	}
+
+	return bPassed;
+}
+
+bool UHAccelerationStructureTest::TestDirtyRanges()
+{
+	const char* TestName = "DirtyRanges";
+	bool bPassed = true;
+	std::vector<UHTopASUploadRange> Ranges;
+
+	// unsorted input, nearby indices are merged, far ones are split, compacted out ones are skipped
+	std::vector<uint32_t> Dirty = { 501, 2, 0, 700, 5, 500, 1 };
+	UHAccelerationStructure::MergeDirtyRanges(Dirty, 600, Ranges);
+	bPassed &= GTestSuite.Check(Ranges.size() == 2, TestName, "nearby dirty indices are coalesced into two ranges");
+	if (Ranges.size() == 2)
+	{
+		bPassed &= GTestSuite.Check(Ranges[0].Begin == 0 && Ranges[0].End == 6, TestName, "the first range covers the gap between 2 and 5");
+		bPassed &= GTestSuite.Check(Ranges[1].Begin == 500 && Ranges[1].End == 502, TestName, "the second range covers 500 and 501");
+	}
+
+	// every dirty index must be covered by exactly one range
+	for (const uint32_t Idx : Dirty)
+	{
+		uint32_t NumCovered = 0;
+		for (const UHTopASUploadRange& Range : Ranges)
+		{
+			NumCovered += (Idx >= Range.Begin && Idx < Range.End) ? 1 : 0;
+		}
+		bPassed &= GTestSuite.Check(NumCovered == (Idx < 600 ? 1U : 0U), TestName, "each active dirty index is uploaded once");
+	}
+
+	// everything compacted out, nothing to upload
+	Dirty = { 10, 11 };
+	UHAccelerationStructure::MergeDirtyRanges(Dirty, 10, Ranges);
+	bPassed &= GTestSuite.Check(Ranges.size() == 0, TestName, "indices beyond the active count are skipped");
+
+	Dirty.clear();
+	UHAccelerationStructure::MergeDirtyRanges(Dirty, 10, Ranges);
+	bPassed &= GTestSuite.Check(Ranges.size() == 0, TestName, "no dirty index gives no range");
+
+	return bPassed;
+}
+
+bool UHAccelerationStructureTest::TestRebuildDecision()
+{
+	const char* TestName = "RebuildDecision";
+	bool bPassed = true;
+
+	UHTopASBuildTracker Tracker;
+	bPassed &= GTestSuite.Check(Tracker.NeedRebuild(10), TestName, "the first build is a full build");
+	Tracker.OnBuilt(10, false);
+
+	bPassed &= GTestSuite.Check(Tracker.IsUpToDate(0, 10), TestName, "no dirty instance and same count keeps the AS");
+	bPassed &= GTestSuite.Check(!Tracker.IsUpToDate(1, 10), TestName, "a dirty instance needs a build");
+	bPassed &= GTestSuite.Check(!Tracker.IsUpToDate(0, 9), TestName, "a culled instance needs a build");
+	bPassed &= GTestSuite.Check(!Tracker.NeedRebuild(10), TestName, "same instance count refits");
+	bPassed &= GTestSuite.Check(Tracker.NeedRebuild(9) && Tracker.NeedRebuild(11), TestName, "a different instance count rebuilds");
+
+	// half of the instances moving is still refitted, more than that rebuilds
+	for (int32_t Idx = 0; Idx < 5; Idx++)
+	{
+		Tracker.MarkChanged();
+	}
+	bPassed &= GTestSuite.Check(!Tracker.NeedRebuild(10), TestName, "moving half of the instances refits");
+	Tracker.MarkChanged();
+	bPassed &= GTestSuite.Check(Tracker.NeedRebuild(10), TestName, "moving more than half of the instances rebuilds");
+
+	// a rebuild resets the counters
+	Tracker.OnBuilt(10, false);
+	bPassed &= GTestSuite.Check(!Tracker.NeedRebuild(10), TestName, "a rebuild resets the moved count");
+
+	// refits are bounded, it must rebuild eventually and then refit again
+	uint32_t NumUpdates = 0;
+	while (!Tracker.NeedRebuild(10) && NumUpdates < 1000)
+	{
+		Tracker.OnBuilt(10, true);
+		NumUpdates++;
+	}
+	bPassed &= GTestSuite.Check(NumUpdates > 0 && NumUpdates < 1000, TestName, "too many refits trigger a rebuild");
+	Tracker.OnBuilt(10, false);
+	bPassed &= GTestSuite.Check(!Tracker.NeedRebuild(10), TestName, "a rebuild resets the update count");
+
+	return bPassed;
+}
+
+#endif
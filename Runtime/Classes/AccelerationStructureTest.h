@@ -0,0 +1,18 @@
+#pragma once
+#if WITH_TESTS
+
+// CPU checks of top level AS instance tracking, no Vulkan device is needed
+// covers transform changes reaching the TLAS of every frame slot, dirty upload ranges and the rebuild decision
+// run with -validatetopas on the Linux target built with tests, or through ctest
+class UHAccelerationStructureTest
+{
+public:
+	// returns false if any check fails, the failures are printed
+	static bool Run();
+
+private:
+	static bool TestSingleFrameMove();
+	static bool TestDirtyRanges();
+	static bool TestRebuildDecision();
+};
+#endif
@@ -42,6 +42,10 @@ static std::string GMaterialCacheExtension = ".uhmaterialcache";
 static std::string GSceneAssetPath = "Assets/Scenes/";
 static std::string GSceneAssetExtension = ".uhscene";
 
+// cook paths
+static std::string GCookDatabasePath = "AssetCaches/CookDatabase.uhcookdb";
+static std::string GDerivedDataCachePath = "AssetCaches/DerivedData/";
+
 namespace UHAssetPath
 {
 	inline std::string GetShaderOriginSubpath(std::filesystem::path InSource)
@@ -0,0 +1,733 @@
+#include "CubemapBaker.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include "../../UnheardEngine.h"
+#include "DerivedDataCache.h"
+#include "Thread.h"
+
+#if defined(_M_X64) || defined(__SSE2__)
+#include <xmmintrin.h>
+#define UH_CUBEMAP_BAKER_SSE 1
+#else
+#define UH_CUBEMAP_BAKER_SSE 0
+#endif
+
+// sample count per prefiltered texel, the source mip is chosen by the sample pdf so this can stay low
+static const uint32_t GPrefilterSampleCount = 64;
+
+// the SH9 projection reads the first mip that isn't larger than this
+static const uint32_t GSH9ProjectionSize = 64;
+
+// bump when the baking output changes
+static constexpr uint32_t GCubemapDerivedDataVersion = 1;
+
+// float RGBA faces of a cube mip
+struct UHCubeMip
+{
+	uint32_t Size;
+	std::vector<float> Faces[6];
+};
+
+// prefilter sample in tangent space, with its weight and source mip
+struct UHPrefilterSample
+{
+	float L[3];
+	float Weight;
+	float Lod;
+};
+
+// OutAcc += InColor * InWeight for RGBA
+static inline void AddScaled(float* OutAcc, const float* InColor, float InWeight)
+{
+#if UH_CUBEMAP_BAKER_SSE
+	_mm_storeu_ps(OutAcc, _mm_add_ps(_mm_loadu_ps(OutAcc), _mm_mul_ps(_mm_loadu_ps(InColor), _mm_set1_ps(InWeight))));
+#else
+	for (int32_t Cdx = 0; Cdx < 4; Cdx++)
+	{
+		OutAcc[Cdx] += InColor[Cdx] * InWeight;
+	}
+#endif
+}
+
+static inline void Scale(float* OutColor, float InScale)
+{
+#if UH_CUBEMAP_BAKER_SSE
+	_mm_storeu_ps(OutColor, _mm_mul_ps(_mm_loadu_ps(OutColor), _mm_set1_ps(InScale)));
+#else
+	for (int32_t Cdx = 0; Cdx < 4; Cdx++)
+	{
+		OutColor[Cdx] *= InScale;
+	}
+#endif
+}
+
+static float HalfToFloat(uint16_t InHalf)
+{
+	const uint32_t Sign = static_cast<uint32_t>(InHalf & 0x8000) << 16;
+	const uint32_t Exponent = (InHalf >> 10) & 0x1f;
+	const uint32_t Mantissa = InHalf & 0x3ff;
+
+	if (Exponent == 0)
+	{
+		// denormal, mantissa * 2^-24
+		const float Value = static_cast<float>(Mantissa) * 5.9604645e-8f;
+		return Sign ? -Value : Value;
+	}
+
+	uint32_t Bits = Sign | (Mantissa << 13);
+	Bits |= (Exponent == 31) ? 0x7f800000 : ((Exponent + 112) << 23);
+
+	float Value;
+	std::memcpy(&Value, &Bits, sizeof(Value));
+	return Value;
+}
+
+static uint16_t FloatToHalf(float InValue)
+{
+	uint32_t Bits;
+	std::memcpy(&Bits, &InValue, sizeof(Bits));
+
+	const uint16_t Sign = static_cast<uint16_t>((Bits >> 16) & 0x8000);
+	Bits &= 0x7fffffff;
+
+	if (Bits > 0x7f800000)
+	{
+		return Sign | 0x7e00;
+	}
+
+	// clamp to the max half instead of inf, HDR skies can be very bright
+	if (Bits >= 0x477ff000)
+	{
+		return Sign | 0x7bff;
+	}
+
+	if (Bits < 0x38800000)
+	{
+		// denormal or zero
+		const uint32_t Shift = 126 - (Bits >> 23);
+		if (Shift > 24)
+		{
+			return Sign;
+		}
+
+		const uint32_t Mantissa = (Bits & 0x7fffff) | 0x800000;
+		return Sign | static_cast<uint16_t>((Mantissa + (1u << (Shift - 1))) >> Shift);
+	}
+
+	// rebias the exponent and round to nearest even
+	return Sign | static_cast<uint16_t>((Bits - 0x38000000 + 0xfff + ((Bits >> 13) & 1)) >> 13);
+}
+
+static const float* GetSRGBToLinearTable()
+{
+	static const std::vector<float> Table = []()
+	{
+		std::vector<float> Result(256);
+		for (int32_t Idx = 0; Idx < 256; Idx++)
+		{
+			const float C = Idx / 255.0f;
+			Result[Idx] = (C <= 0.04045f) ? C / 12.92f : std::pow((C + 0.055f) / 1.055f, 2.4f);
+		}
+		return Result;
+	}();
+
+	return Table.data();
+}
+
+static void Decode565(uint16_t InColor, float* OutColor)
+{
+	OutColor[0] = ((InColor >> 11) & 0x1f) / 31.0f;
+	OutColor[1] = ((InColor >> 5) & 0x3f) / 63.0f;
+	OutColor[2] = (InColor & 0x1f) / 31.0f;
+	OutColor[3] = 1.0f;
+}
+
+// decode the color part of a BC1/BC3 block, alpha isn't needed for lighting
+static void DecodeBCColorBlock(const uint8_t* InBlock, bool bFourColorOnly, float OutTexels[16][4])
+{
+	uint16_t C0;
+	uint16_t C1;
+	uint32_t Indices;
+	std::memcpy(&C0, InBlock, sizeof(C0));
+	std::memcpy(&C1, InBlock + 2, sizeof(C1));
+	std::memcpy(&Indices, InBlock + 4, sizeof(Indices));
+
+	float Palette[4][4];
+	Decode565(C0, Palette[0]);
+	Decode565(C1, Palette[1]);
+	for (int32_t Cdx = 0; Cdx < 3; Cdx++)
+	{
+		if (bFourColorOnly || C0 > C1)
+		{
+			Palette[2][Cdx] = (2.0f * Palette[0][Cdx] + Palette[1][Cdx]) / 3.0f;
+			Palette[3][Cdx] = (Palette[0][Cdx] + 2.0f * Palette[1][Cdx]) / 3.0f;
+		}
+		else
+		{
+			Palette[2][Cdx] = 0.5f * (Palette[0][Cdx] + Palette[1][Cdx]);
+			Palette[3][Cdx] = 0.0f;
+		}
+	}
+	Palette[2][3] = 1.0f;
+	Palette[3][3] = 1.0f;
+
+	for (int32_t Idx = 0; Idx < 16; Idx++)
+	{
+		std::memcpy(OutTexels[Idx], Palette[(Indices >> (Idx * 2)) & 3], sizeof(float) * 4);
+	}
+}
+
+// decode mip 0 of a slice to linear float RGBA
+static bool DecodeSlice(const std::vector<uint8_t>& InData, UHTextureFormat InFormat, uint32_t InSize, std::vector<float>& OutTexels)
+{
+	const UHTextureFormatData FormatData = GTextureFormatData[UH_ENUM_VALUE(InFormat)];
+	const size_t Mip0Size = static_cast<size_t>(InSize) * InSize * FormatData.ByteSize / FormatData.BlockSize;
+	if (InData.size() < Mip0Size)
+	{
+		return false;
+	}
+
+	OutTexels.resize(static_cast<size_t>(InSize) * InSize * 4);
+	const float* SRGBTable = GetSRGBToLinearTable();
+
+	switch (InFormat)
+	{
+	case UHTextureFormat::UH_FORMAT_RGBA8_UNORM:
+	case UHTextureFormat::UH_FORMAT_RGBA8_SRGB:
+	case UHTextureFormat::UH_FORMAT_BGRA8_UNORM:
+	case UHTextureFormat::UH_FORMAT_BGRA8_SRGB:
+	{
+		const bool bIsSRGB = (InFormat == UHTextureFormat::UH_FORMAT_RGBA8_SRGB || InFormat == UHTextureFormat::UH_FORMAT_BGRA8_SRGB);
+		const bool bIsBGRA = (InFormat == UHTextureFormat::UH_FORMAT_BGRA8_UNORM || InFormat == UHTextureFormat::UH_FORMAT_BGRA8_SRGB);
+		for (size_t Idx = 0; Idx < static_cast<size_t>(InSize) * InSize; Idx++)
+		{
+			const uint8_t* Src = &InData[Idx * 4];
+			float* Dst = &OutTexels[Idx * 4];
+			for (int32_t Cdx = 0; Cdx < 3; Cdx++)
+			{
+				const uint8_t Value = Src[bIsBGRA ? 2 - Cdx : Cdx];
+				Dst[Cdx] = bIsSRGB ? SRGBTable[Value] : Value / 255.0f;
+			}
+			Dst[3] = Src[3] / 255.0f;
+		}
+		return true;
+	}
+
+	case UHTextureFormat::UH_FORMAT_RGBA16F:
+	{
+		const uint16_t* Src = reinterpret_cast<const uint16_t*>(InData.data());
+		for (size_t Idx = 0; Idx < OutTexels.size(); Idx++)
+		{
+			OutTexels[Idx] = HalfToFloat(Src[Idx]);
+		}
+		return true;
+	}
+
+	case UHTextureFormat::UH_FORMAT_BC1_UNORM:
+	case UHTextureFormat::UH_FORMAT_BC1_SRGB:
+	case UHTextureFormat::UH_FORMAT_BC3_UNORM:
+	case UHTextureFormat::UH_FORMAT_BC3_SRGB:
+	{
+		const bool bIsBC3 = (InFormat == UHTextureFormat::UH_FORMAT_BC3_UNORM || InFormat == UHTextureFormat::UH_FORMAT_BC3_SRGB);
+		const bool bIsSRGB = (InFormat == UHTextureFormat::UH_FORMAT_BC1_SRGB || InFormat == UHTextureFormat::UH_FORMAT_BC3_SRGB);
+		const uint32_t BlockCount = (std::max)(InSize / 4, 1u);
+
+		for (uint32_t By = 0; By < BlockCount; By++)
+		{
+			for (uint32_t Bx = 0; Bx < BlockCount; Bx++)
+			{
+				// BC3 stores the alpha block before the color block
+				const uint8_t* Block = &InData[(By * BlockCount + Bx) * FormatData.ByteSize];
+				float Texels[16][4];
+				DecodeBCColorBlock(bIsBC3 ? Block + 8 : Block, bIsBC3, Texels);
+
+				for (uint32_t Ty = 0; Ty < 4 && By * 4 + Ty < InSize; Ty++)
+				{
+					for (uint32_t Tx = 0; Tx < 4 && Bx * 4 + Tx < InSize; Tx++)
+					{
+						float* Dst = &OutTexels[((By * 4 + Ty) * InSize + Bx * 4 + Tx) * 4];
+						std::memcpy(Dst, Texels[Ty * 4 + Tx], sizeof(float) * 4);
+						if (bIsSRGB)
+						{
+							for (int32_t Cdx = 0; Cdx < 3; Cdx++)
+							{
+								Dst[Cdx] = SRGBTable[static_cast<uint8_t>(Dst[Cdx] * 255.0f + 0.5f)];
+							}
+						}
+					}
+				}
+			}
+		}
+		return true;
+	}
+
+	default:
+		break;
+	}
+
+	return false;
+}
+
+// texel center of a face to direction, follows the Vulkan cube face selection
+static void FaceTexelToDirection(int32_t InFace, float S, float T, float* OutDir)
+{
+	switch (InFace)
+	{
+	case 0: OutDir[0] = 1.0f; OutDir[1] = -T; OutDir[2] = -S; break;
+	case 1: OutDir[0] = -1.0f; OutDir[1] = -T; OutDir[2] = S; break;
+	case 2: OutDir[0] = S; OutDir[1] = 1.0f; OutDir[2] = T; break;
+	case 3: OutDir[0] = S; OutDir[1] = -1.0f; OutDir[2] = -T; break;
+	case 4: OutDir[0] = S; OutDir[1] = -T; OutDir[2] = 1.0f; break;
+	default: OutDir[0] = -S; OutDir[1] = -T; OutDir[2] = -1.0f; break;
+	}
+
+	const float InvLength = 1.0f / std::sqrt(OutDir[0] * OutDir[0] + OutDir[1] * OutDir[1] + OutDir[2] * OutDir[2]);
+	OutDir[0] *= InvLength;
+	OutDir[1] *= InvLength;
+	OutDir[2] *= InvLength;
+}
+
+static void DirectionToFaceUV(const float* InDir, int32_t& OutFace, float& OutU, float& OutV)
+{
+	const float Ax = std::abs(InDir[0]);
+	const float Ay = std::abs(InDir[1]);
+	const float Az = std::abs(InDir[2]);
+	float Ma;
+	float Sc;
+	float Tc;
+
+	if (Ax >= Ay && Ax >= Az)
+	{
+		OutFace = InDir[0] > 0.0f ? 0 : 1;
+		Ma = Ax;
+		Sc = InDir[0] > 0.0f ? -InDir[2] : InDir[2];
+		Tc = -InDir[1];
+	}
+	else if (Ay >= Az)
+	{
+		OutFace = InDir[1] > 0.0f ? 2 : 3;
+		Ma = Ay;
+		Sc = InDir[0];
+		Tc = InDir[1] > 0.0f ? InDir[2] : -InDir[2];
+	}
+	else
+	{
+		OutFace = InDir[2] > 0.0f ? 4 : 5;
+		Ma = Az;
+		Sc = InDir[2] > 0.0f ? InDir[0] : -InDir[0];
+		Tc = -InDir[1];
+	}
+
+	OutU = 0.5f * (Sc / Ma + 1.0f);
+	OutV = 0.5f * (Tc / Ma + 1.0f);
+}
+
+// bilinear sample within a face, edges are clamped
+static void SampleBilinear(const UHCubeMip& InMip, const float* InDir, float InWeight, float* OutAcc)
+{
+	int32_t Face;
+	float U;
+	float V;
+	DirectionToFaceUV(InDir, Face, U, V);
+
+	const int32_t Size = static_cast<int32_t>(InMip.Size);
+	const float X = std::clamp(U * Size - 0.5f, 0.0f, static_cast<float>(Size - 1));
+	const float Y = std::clamp(V * Size - 0.5f, 0.0f, static_cast<float>(Size - 1));
+	const int32_t X0 = static_cast<int32_t>(X);
+	const int32_t Y0 = static_cast<int32_t>(Y);
+	const int32_t X1 = (std::min)(X0 + 1, Size - 1);
+	const int32_t Y1 = (std::min)(Y0 + 1, Size - 1);
+	const float Fx = X - X0;
+	const float Fy = Y - Y0;
+
+	const float* Texels = InMip.Faces[Face].data();
+	AddScaled(OutAcc, &Texels[(Y0 * Size + X0) * 4], InWeight * (1.0f - Fx) * (1.0f - Fy));
+	AddScaled(OutAcc, &Texels[(Y0 * Size + X1) * 4], InWeight * Fx * (1.0f - Fy));
+	AddScaled(OutAcc, &Texels[(Y1 * Size + X0) * 4], InWeight * (1.0f - Fx) * Fy);
+	AddScaled(OutAcc, &Texels[(Y1 * Size + X1) * 4], InWeight * Fx * Fy);
+}
+
+static void SampleTrilinear(const std::vector<UHCubeMip>& InMips, const float* InDir, float InLod, float InWeight, float* OutAcc)
+{
+	const uint32_t Mip0 = static_cast<uint32_t>(InLod);
+	const uint32_t Mip1 = (std::min)(Mip0 + 1, static_cast<uint32_t>(InMips.size()) - 1);
+	const float Frac = InLod - Mip0;
+
+	SampleBilinear(InMips[Mip0], InDir, InWeight * (1.0f - Frac), OutAcc);
+	if (Frac > 0.0f && Mip1 != Mip0)
+	{
+		SampleBilinear(InMips[Mip1], InDir, InWeight * Frac, OutAcc);
+	}
+}
+
+// build the source mip chain with a 2x2 box filter
+static void BuildSourceMips(std::vector<UHCubeMip>& InOutMips)
+{
+	while (InOutMips.back().Size > 1)
+	{
+		const UHCubeMip& Src = InOutMips.back();
+		UHCubeMip Dst;
+		Dst.Size = Src.Size / 2;
+
+		for (int32_t Face = 0; Face < 6; Face++)
+		{
+			Dst.Faces[Face].assign(static_cast<size_t>(Dst.Size) * Dst.Size * 4, 0.0f);
+			for (uint32_t Y = 0; Y < Dst.Size; Y++)
+			{
+				for (uint32_t X = 0; X < Dst.Size; X++)
+				{
+					float* Out = &Dst.Faces[Face][(Y * Dst.Size + X) * 4];
+					const float* In = Src.Faces[Face].data();
+					AddScaled(Out, &In[((Y * 2) * Src.Size + X * 2) * 4], 0.25f);
+					AddScaled(Out, &In[((Y * 2) * Src.Size + X * 2 + 1) * 4], 0.25f);
+					AddScaled(Out, &In[((Y * 2 + 1) * Src.Size + X * 2) * 4], 0.25f);
+					AddScaled(Out, &In[((Y * 2 + 1) * Src.Size + X * 2 + 1) * 4], 0.25f);
+				}
+			}
+		}
+
+		InOutMips.push_back(UHMOVE(Dst));
+	}
+}
+
+// the SH basis and packing must match SHBasis3() and GenerateSHParameterCS() in shaders
+static void SHBasis3(const float* InDir, float* OutBasis)
+{
+	const float X = InDir[0];
+	const float Y = InDir[1];
+	const float Z = InDir[2];
+
+	OutBasis[0] = 0.282095f;
+	OutBasis[1] = -0.488603f * Y;
+	OutBasis[2] = 0.488603f * Z;
+	OutBasis[3] = -0.488603f * X;
+	OutBasis[4] = 1.092548f * X * Y;
+	OutBasis[5] = -1.092548f * Y * Z;
+	OutBasis[6] = 0.315392f * (3.0f * Z * Z - 1.0f);
+	OutBasis[7] = -1.092548f * X * Z;
+	OutBasis[8] = 0.546274f * (X * X - Y * Y);
+}
+
+static UHSphericalHarmonicData ProjectSH9(const UHCubeMip& InMip)
+{
+	// each face is projected separately, the coefficients hold RGB in the first 3 lanes
+	float FaceSH[6][9][4] = {};
+	float FaceWeights[6] = {};
+
+	UHParallelFor(6, [&](uint32_t Face)
+		{
+			const float InvSize = 1.0f / InMip.Size;
+			for (uint32_t Y = 0; Y < InMip.Size; Y++)
+			{
+				for (uint32_t X = 0; X < InMip.Size; X++)
+				{
+					const float S = (2.0f * X + 1.0f) * InvSize - 1.0f;
+					const float T = (2.0f * Y + 1.0f) * InvSize - 1.0f;
+
+					// solid angle of the texel
+					const float Tmp = 1.0f + S * S + T * T;
+					const float SolidAngle = 4.0f * InvSize * InvSize / (Tmp * std::sqrt(Tmp));
+
+					float Dir[3];
+					float Basis[9];
+					FaceTexelToDirection(Face, S, T, Dir);
+					SHBasis3(Dir, Basis);
+
+					const float* Color = &InMip.Faces[Face][(Y * InMip.Size + X) * 4];
+					for (int32_t Kdx = 0; Kdx < 9; Kdx++)
+					{
+						AddScaled(FaceSH[Face][Kdx], Color, Basis[Kdx] * SolidAngle);
+					}
+					FaceWeights[Face] += SolidAngle;
+				}
+			}
+		});
+
+	float SH[9][4] = {};
+	float TotalWeight = 0.0f;
+	for (int32_t Face = 0; Face < 6; Face++)
+	{
+		for (int32_t Kdx = 0; Kdx < 9; Kdx++)
+		{
+			AddScaled(SH[Kdx], FaceSH[Face][Kdx], 1.0f);
+		}
+		TotalWeight += FaceWeights[Face];
+	}
+
+	// normalize the texel solid angles to the full sphere
+	for (int32_t Kdx = 0; Kdx < 9; Kdx++)
+	{
+		Scale(SH[Kdx], 4.0f * G_PI / TotalWeight);
+	}
+
+	const float SqrtPI = std::sqrt(G_PI);
+	const float FC0 = 1.0f / (2.0f * SqrtPI);
+	const float FC1 = std::sqrt(3.0f) / (3.0f * SqrtPI);
+	const float FC2 = std::sqrt(15.0f) / (8.0f * SqrtPI);
+	const float FC3 = std::sqrt(5.0f) / (16.0f * SqrtPI);
+	const float FC4 = 0.5f * FC2;
+
+	UHSphericalHarmonicData Result{};
+	UHVector4* A[3] = { &Result.cAr, &Result.cAg, &Result.cAb };
+	UHVector4* B[3] = { &Result.cBr, &Result.cBg, &Result.cBb };
+	for (int32_t Cdx = 0; Cdx < 3; Cdx++)
+	{
+		A[Cdx]->x = -FC1 * SH[3][Cdx];
+		A[Cdx]->y = -FC1 * SH[1][Cdx];
+		A[Cdx]->z = FC1 * SH[2][Cdx];
+		A[Cdx]->w = FC0 * SH[0][Cdx] - FC3 * SH[6][Cdx];
+
+		B[Cdx]->x = FC2 * SH[4][Cdx];
+		B[Cdx]->y = -FC2 * SH[5][Cdx];
+		B[Cdx]->z = 3.0f * FC3 * SH[6][Cdx];
+		B[Cdx]->w = -FC2 * SH[7][Cdx];
+	}
+
+	Result.cC.x = FC4 * SH[8][0];
+	Result.cC.y = FC4 * SH[8][1];
+	Result.cC.z = FC4 * SH[8][2];
+	Result.cC.w = 1.0f;
+
+	return Result;
+}
+
+// GGX importance samples with N = V = R, the source mip of each sample is chosen by its pdf
+static std::vector<UHPrefilterSample> BuildPrefilterSamples(float InRoughness, uint32_t InSourceSize, uint32_t InSourceMipCount)
+{
+	std::vector<UHPrefilterSample> Samples;
+	const float Alpha = (std::max)(InRoughness * InRoughness, 1e-4f);
+	const float AlphaSq = Alpha * Alpha;
+	const float TexelSolidAngle = 4.0f * G_PI / (6.0f * InSourceSize * InSourceSize);
+
+	for (uint32_t Idx = 0; Idx < GPrefilterSampleCount; Idx++)
+	{
+		// hammersley point
+		uint32_t Bits = Idx;
+		Bits = (Bits << 16) | (Bits >> 16);
+		Bits = ((Bits & 0x55555555u) << 1) | ((Bits & 0xAAAAAAAAu) >> 1);
+		Bits = ((Bits & 0x33333333u) << 2) | ((Bits & 0xCCCCCCCCu) >> 2);
+		Bits = ((Bits & 0x0F0F0F0Fu) << 4) | ((Bits & 0xF0F0F0F0u) >> 4);
+		Bits = ((Bits & 0x00FF00FFu) << 8) | ((Bits & 0xFF00FF00u) >> 8);
+		const float E1 = static_cast<float>(Idx) / GPrefilterSampleCount;
+		const float E2 = Bits * 2.3283064365386963e-10f;
+
+		const float Phi = 2.0f * G_PI * E1;
+		const float CosTheta = std::sqrt((1.0f - E2) / (1.0f + (AlphaSq - 1.0f) * E2));
+		const float SinTheta = std::sqrt(1.0f - CosTheta * CosTheta);
+		const float H[3] = { SinTheta * std::cos(Phi), SinTheta * std::sin(Phi), CosTheta };
+
+		// reflect N around H, N is (0,0,1) in tangent space
+		UHPrefilterSample Sample;
+		Sample.L[0] = 2.0f * CosTheta * H[0];
+		Sample.L[1] = 2.0f * CosTheta * H[1];
+		Sample.L[2] = 2.0f * CosTheta * H[2] - 1.0f;
+		Sample.Weight = Sample.L[2];
+		if (Sample.Weight <= 0.0f)
+		{
+			continue;
+		}
+
+		// pdf = D * NdotH / (4 * VdotH) = D / 4 when N = V
+		const float Denom = (AlphaSq - 1.0f) * CosTheta * CosTheta + 1.0f;
+		const float D = AlphaSq / (G_PI * Denom * Denom);
+		const float SampleSolidAngle = 1.0f / (GPrefilterSampleCount * D * 0.25f + 1e-6f);
+		Sample.Lod = std::clamp(0.5f * std::log2(SampleSolidAngle / TexelSolidAngle) + 1.0f, 0.0f, static_cast<float>(InSourceMipCount - 1));
+
+		Samples.push_back(Sample);
+	}
+
+	return Samples;
+}
+
+static void PrefilterMip(const std::vector<UHCubeMip>& InSourceMips, uint32_t InMip, uint32_t InMipCount, std::vector<float>* OutFaces)
+{
+	const uint32_t Size = (std::max)(InSourceMips[0].Size >> InMip, 1u);
+	const float Roughness = 1.0f - std::sqrt(1.0f - static_cast<float>(InMip) / InMipCount);
+	const std::vector<UHPrefilterSample> Samples = BuildPrefilterSamples(Roughness, InSourceMips[0].Size, static_cast<uint32_t>(InSourceMips.size()));
+
+	for (int32_t Face = 0; Face < 6; Face++)
+	{
+		OutFaces[Face].assign(static_cast<size_t>(Size) * Size * 4, 0.0f);
+	}
+
+	// a row of a face per task
+	UHParallelFor(6 * Size, [&](uint32_t Task)
+		{
+			const int32_t Face = Task / Size;
+			const uint32_t Y = Task % Size;
+			const float InvSize = 1.0f / Size;
+
+			for (uint32_t X = 0; X < Size; X++)
+			{
+				float N[3];
+				FaceTexelToDirection(Face, (2.0f * X + 1.0f) * InvSize - 1.0f, (2.0f * Y + 1.0f) * InvSize - 1.0f, N);
+
+				// tangent basis around N
+				const float Up[3] = { std::abs(N[2]) < 0.999f ? 0.0f : 1.0f, 0.0f, std::abs(N[2]) < 0.999f ? 1.0f : 0.0f };
+				float Tx[3] = { Up[1] * N[2] - Up[2] * N[1], Up[2] * N[0] - Up[0] * N[2], Up[0] * N[1] - Up[1] * N[0] };
+				const float InvLength = 1.0f / std::sqrt(Tx[0] * Tx[0] + Tx[1] * Tx[1] + Tx[2] * Tx[2]);
+				Tx[0] *= InvLength;
+				Tx[1] *= InvLength;
+				Tx[2] *= InvLength;
+				const float Ty[3] = { N[1] * Tx[2] - N[2] * Tx[1], N[2] * Tx[0] - N[0] * Tx[2], N[0] * Tx[1] - N[1] * Tx[0] };
+
+				float Color[4] = {};
+				float TotalWeight = 0.0f;
+				for (const UHPrefilterSample& Sample : Samples)
+				{
+					const float L[3] = { Tx[0] * Sample.L[0] + Ty[0] * Sample.L[1] + N[0] * Sample.L[2]
+						, Tx[1] * Sample.L[0] + Ty[1] * Sample.L[1] + N[1] * Sample.L[2]
+						, Tx[2] * Sample.L[0] + Ty[2] * Sample.L[1] + N[2] * Sample.L[2] };
+
+					SampleTrilinear(InSourceMips, L, Sample.Lod, Sample.Weight, Color);
+					TotalWeight += Sample.Weight;
+				}
+
+				if (TotalWeight > 0.0f)
+				{
+					Scale(Color, 1.0f / TotalWeight);
+				}
+				std::memcpy(&OutFaces[Face][(Y * Size + X) * 4], Color, sizeof(Color));
+			}
+		});
+}
+
+static void AppendHalfMip(const std::vector<float>& InTexels, std::vector<uint8_t>& OutData)
+{
+	const size_t Offset = OutData.size();
+	OutData.resize(Offset + InTexels.size() * sizeof(uint16_t));
+
+	uint16_t* Dst = reinterpret_cast<uint16_t*>(OutData.data() + Offset);
+	for (size_t Idx = 0; Idx < InTexels.size(); Idx++)
+	{
+		Dst[Idx] = FloatToHalf(InTexels[Idx]);
+	}
+}
+
+namespace UHCubemapBaker
+{
+	uint32_t GetVersion()
+	{
+		return GCubemapDerivedDataVersion;
+	}
+
+	bool CanDecodeFormat(UHTextureFormat InFormat)
+	{
+		switch (InFormat)
+		{
+		case UHTextureFormat::UH_FORMAT_RGBA8_UNORM:
+		case UHTextureFormat::UH_FORMAT_RGBA8_SRGB:
+		case UHTextureFormat::UH_FORMAT_BGRA8_UNORM:
+		case UHTextureFormat::UH_FORMAT_BGRA8_SRGB:
+		case UHTextureFormat::UH_FORMAT_RGBA16F:
+		case UHTextureFormat::UH_FORMAT_BC1_UNORM:
+		case UHTextureFormat::UH_FORMAT_BC1_SRGB:
+		case UHTextureFormat::UH_FORMAT_BC3_UNORM:
+		case UHTextureFormat::UH_FORMAT_BC3_SRGB:
+			return true;
+		default:
+			break;
+		}
+
+		return false;
+	}
+
+	bool Bake(const std::vector<uint8_t>* InSlices, UHTextureFormat InFormat, uint32_t InSize, uint32_t InMipCount, UHCubemapBakedData& OutData)
+	{
+		if (!CanDecodeFormat(InFormat) || InSize == 0 || InMipCount == 0)
+		{
+			UHE_LOG("Cubemap baking is skipped, the format can't be decoded on CPU.\n");
+			return false;
+		}
+
+		// the bake is keyed by the slice data and the baking parameters
+		std::string DerivedDataKey;
+		if (GDerivedDataCache.IsEnabled())
+		{
+			UHContentHasher Hasher;
+			for (int32_t Face = 0; Face < 6; Face++)
+			{
+				Hasher.UpdateVector(InSlices[Face]);
+			}
+			Hasher.UpdateValue(InFormat);
+			Hasher.UpdateValue(InSize);
+			Hasher.UpdateValue(InMipCount);
+			Hasher.UpdateValue(GPrefilterSampleCount);
+			Hasher.UpdateValue(GSH9ProjectionSize);
+			DerivedDataKey = UHDerivedDataCache::MakeKey("CubeLighting", GCubemapDerivedDataVersion, Hasher.GetHash());
+
+			std::vector<uint8_t> DerivedData;
+			size_t Offset = 0;
+			bool bValid = GDerivedDataCache.Get(DerivedDataKey, DerivedData)
+				&& UHDerivedDataCache::ReadValue(DerivedData, Offset, OutData.SH9);
+			for (int32_t Face = 0; Face < 6 && bValid; Face++)
+			{
+				bValid = UHDerivedDataCache::ReadVector(DerivedData, Offset, OutData.Slices[Face]);
+			}
+
+			if (bValid)
+			{
+				return true;
+			}
+		}
+
+		std::vector<UHCubeMip> SourceMips(1);
+		SourceMips[0].Size = InSize;
+
+		std::atomic<bool> bDecoded = true;
+		UHParallelFor(6, [&](uint32_t Face)
+			{
+				if (!DecodeSlice(InSlices[Face], InFormat, InSize, SourceMips[0].Faces[Face]))
+				{
+					bDecoded = false;
+				}
+			});
+
+		if (!bDecoded)
+		{
+			UHE_LOG("Cubemap baking failed, the slice data is incomplete.\n");
+			return false;
+		}
+		BuildSourceMips(SourceMips);
+
+		// SH9 from a small mip, it's low frequency anyway
+		uint32_t SHMip = 0;
+		while (SourceMips[SHMip].Size > GSH9ProjectionSize && SHMip + 1 < SourceMips.size())
+		{
+			SHMip++;
+		}
+		OutData.SH9 = ProjectSH9(SourceMips[SHMip]);
+
+		// mip 0 keeps the source, the rest are prefiltered
+		for (int32_t Face = 0; Face < 6; Face++)
+		{
+			OutData.Slices[Face].clear();
+			AppendHalfMip(SourceMips[0].Faces[Face], OutData.Slices[Face]);
+		}
+
+		for (uint32_t Mip = 1; Mip < InMipCount; Mip++)
+		{
+			std::vector<float> Faces[6];
+			PrefilterMip(SourceMips, Mip, InMipCount, Faces);
+			for (int32_t Face = 0; Face < 6; Face++)
+			{
+				AppendHalfMip(Faces[Face], OutData.Slices[Face]);
+			}
+		}
+
+		if (GDerivedDataCache.IsEnabled())
+		{
+			std::vector<uint8_t> DerivedData;
+			UHDerivedDataCache::WriteValue(DerivedData, OutData.SH9);
+			for (int32_t Face = 0; Face < 6; Face++)
+			{
+				UHDerivedDataCache::WriteVector(DerivedData, OutData.Slices[Face]);
+			}
+			GDerivedDataCache.Put(DerivedDataKey, DerivedData);
+		}
+
+		return true;
+	}
+}
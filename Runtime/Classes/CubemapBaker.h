@@ -0,0 +1,31 @@
+#pragma once
+#include <vector>
+#include "TextureFormat.h"
+#include "../Renderer/RenderingTypes.h"
+
+// CPU baked sky lighting of a cube, the slices are RGBA16F mip chains
+// mip 0 is the decoded source and the rest are GGX prefiltered for the roughness of each mip
+struct UHCubemapBakedData
+{
+	UHCubemapBakedData()
+		: SH9{}
+	{
+	}
+
+	UHSphericalHarmonicData SH9;
+	std::vector<uint8_t> Slices[6];
+};
+
+// offline cubemap baker, it doesn't need a GPU so asset cooks can use it too
+namespace UHCubemapBaker
+{
+	// return true if the slice format can be decoded on CPU
+	bool CanDecodeFormat(UHTextureFormat InFormat);
+
+	// decode mip 0 of six square slices, project it to SH9 and prefilter the mips
+	// the work is spread over all hardware threads
+	bool Bake(const std::vector<uint8_t>* InSlices, UHTextureFormat InFormat, uint32_t InSize, uint32_t InMipCount, UHCubemapBakedData& OutData);
+
+	// changes when the baking output changes, the cooker rebakes the cubes with it
+	uint32_t GetVersion();
+}
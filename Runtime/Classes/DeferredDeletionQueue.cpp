@@ -0,0 +1,78 @@
+#include "DeferredDeletionQueue.h"
+
+// retire value of the entries that haven't been assigned yet, it's never reached by the timeline
+static const uint64_t GUnassignedRetireValue = ~0ULL;
+
+UHDeferredDeletionQueue::UHDeferredDeletionQueue()
+{
+
+}
+
+void UHDeferredDeletionQueue::Enqueue(std::function<void()> InReleaseFunc)
+{
+	std::lock_guard<std::mutex> Lock(QueueLock);
+	UHDeferredRelease NewRelease;
+	NewRelease.RetireValue = GUnassignedRetireValue;
+	NewRelease.ReleaseFunc = std::move(InReleaseFunc);
+	PendingReleases.push_back(std::move(NewRelease));
+}
+
+void UHDeferredDeletionQueue::AssignRetireValue(uint64_t InRetireValue)
+{
+	std::lock_guard<std::mutex> Lock(QueueLock);
+	for (UHDeferredRelease& Release : PendingReleases)
+	{
+		if (Release.RetireValue == GUnassignedRetireValue)
+		{
+			Release.RetireValue = InRetireValue;
+		}
+	}
+}
+
+void UHDeferredDeletionQueue::Process(uint64_t InCompletedValue)
+{
+	// collect the retired entries first, release functions are called outside of the lock
+	std::vector<UHDeferredRelease> RetiredReleases;
+	{
+		std::lock_guard<std::mutex> Lock(QueueLock);
+		for (size_t Idx = 0; Idx < PendingReleases.size(); )
+		{
+			if (PendingReleases[Idx].RetireValue <= InCompletedValue)
+			{
+				RetiredReleases.push_back(std::move(PendingReleases[Idx]));
+				PendingReleases[Idx] = std::move(PendingReleases.back());
+				PendingReleases.pop_back();
+			}
+			else
+			{
+				Idx++;
+			}
+		}
+	}
+
+	for (UHDeferredRelease& Release : RetiredReleases)
+	{
+		Release.ReleaseFunc();
+	}
+}
+
+void UHDeferredDeletionQueue::Flush()
+{
+	std::vector<UHDeferredRelease> RetiredReleases;
+	{
+		std::lock_guard<std::mutex> Lock(QueueLock);
+		RetiredReleases = std::move(PendingReleases);
+		PendingReleases.clear();
+	}
+
+	for (UHDeferredRelease& Release : RetiredReleases)
+	{
+		Release.ReleaseFunc();
+	}
+}
+
+size_t UHDeferredDeletionQueue::GetPendingCount() const
+{
+	std::lock_guard<std::mutex> Lock(QueueLock);
+	return PendingReleases.size();
+}
\ No newline at end of file
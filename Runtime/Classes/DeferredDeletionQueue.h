@@ -0,0 +1,37 @@
+#pragma once
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+// UH deferred deletion queue
+// resources that could be referenced by in-flight frames are released once the frame timeline reaches the retire value
+// entries are enqueued without a value and get the value of the next frame submission, as the frame might not be fully recorded yet
+class UHDeferredDeletionQueue
+{
+public:
+	UHDeferredDeletionQueue();
+
+	void Enqueue(std::function<void()> InReleaseFunc);
+
+	// assign the retire value to the entries waiting for a frame submission
+	void AssignRetireValue(uint64_t InRetireValue);
+
+	// release the entries which are done on GPU
+	void Process(uint64_t InCompletedValue);
+
+	// release everything, GPU must be idle when calling this
+	void Flush();
+
+	size_t GetPendingCount() const;
+
+private:
+	struct UHDeferredRelease
+	{
+		uint64_t RetireValue = ~0ULL;
+		std::function<void()> ReleaseFunc;
+	};
+
+	std::vector<UHDeferredRelease> PendingReleases;
+	mutable std::mutex QueueLock;
+};
\ No newline at end of file
@@ -0,0 +1,454 @@
+#include "DerivedDataCache.h"
+#include "../../UnheardEngine.h"
+#include "AssetPath.h"
+#include "Settings.h"
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <random>
+#include <thread>
+
+#if _WIN32
+#include <process.h>
+#elif __linux__
+#include <unistd.h>
+#endif
+
+static constexpr uint64_t GFnvOffsetBasis = 14695981039346656037ull;
+static constexpr uint64_t GFnvPrime = 1099511628211ull;
+
+// entry header, the payload hash catches truncated or corrupted files in a shared store
+static constexpr uint32_t GDerivedDataMagic = 0x43444455;
+static const std::string GDerivedDataExtension = ".uhddc";
+
+struct UHDerivedDataHeader
+{
+	uint32_t Magic;
+	uint32_t Padding;
+	uint64_t PayloadSize;
+	uint64_t PayloadHash;
+};
+
+// temp file suffix unique across processes and threads, thread ids alone can repeat between the machines sharing a store
+static std::string MakeTempSuffix()
+{
+#if _WIN32
+	const int64_t ProcessId = _getpid();
+#else
+	const int64_t ProcessId = getpid();
+#endif
+
+	thread_local std::mt19937_64 Random(std::random_device{}());
+	char RandomString[17];
+	snprintf(RandomString, sizeof(RandomString), "%016llx", static_cast<unsigned long long>(Random()));
+
+	return ".tmp" + std::to_string(ProcessId) + "_" + std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id())) + "_" + RandomString;
+}
+
+UHContentHasher::UHContentHasher()
+	: Hash(GFnvOffsetBasis)
+{
+
+}
+
+void UHContentHasher::Update(const void* InData, size_t InSize)
+{
+	const uint8_t* Bytes = reinterpret_cast<const uint8_t*>(InData);
+	const size_t NumWords = InSize / sizeof(uint64_t);
+	for (size_t Idx = 0; Idx < NumWords; Idx++)
+	{
+		uint64_t Word;
+		UHMEMCOPY(&Word, Bytes + Idx * sizeof(uint64_t), sizeof(uint64_t));
+		Hash = (Hash ^ Word) * GFnvPrime;
+		Hash ^= Hash >> 29;
+	}
+
+	for (size_t Idx = NumWords * sizeof(uint64_t); Idx < InSize; Idx++)
+	{
+		Hash = (Hash ^ Bytes[Idx]) * GFnvPrime;
+	}
+}
+
+void UHContentHasher::Update(const std::string& InString)
+{
+	// length first so concatenated strings don't collide, e.g. "ab"+"c" and "a"+"bc"
+	UpdateValue(InString.size());
+	Update(InString.data(), InString.size());
+}
+
+bool UHContentHasher::UpdateFile(const std::filesystem::path& InPath)
+{
+	std::ifstream FileIn(InPath, std::ios::in | std::ios::binary);
+	if (!FileIn.is_open())
+	{
+		return false;
+	}
+
+	std::vector<char> Buffer(65536);
+	while (FileIn)
+	{
+		FileIn.read(Buffer.data(), Buffer.size());
+		Update(Buffer.data(), static_cast<size_t>(FileIn.gcount()));
+	}
+
+	return true;
+}
+
+uint64_t UHContentHasher::GetHash() const
+{
+	return Hash;
+}
+
+UHFileDerivedDataBackend::UHFileDerivedDataBackend(const std::filesystem::path& InRootPath, uint64_t InMaxBytes, bool bInReadOnly)
+	: RootPath(InRootPath)
+	, MaxBytes(InMaxBytes)
+	, bReadOnly(bInReadOnly)
+	, TotalBytes(0)
+{
+	std::error_code Error;
+	if (!bReadOnly)
+	{
+		std::filesystem::create_directories(RootPath, Error);
+	}
+
+	// the size is only tracked when there is a limit
+	if (MaxBytes > 0 && std::filesystem::exists(RootPath, Error))
+	{
+		uint64_t Bytes = 0;
+		for (std::filesystem::recursive_directory_iterator Idx(RootPath, Error), End; Idx != End; Idx.increment(Error))
+		{
+			if (Idx->is_regular_file(Error))
+			{
+				Bytes += Idx->file_size(Error);
+			}
+		}
+		TotalBytes = Bytes;
+		Trim();
+	}
+}
+
+std::string UHFileDerivedDataBackend::GetName() const
+{
+	return RootPath.generic_string();
+}
+
+std::filesystem::path UHFileDerivedDataBackend::GetEntryPath(const std::string& InKey) const
+{
+	// keys end with the hash, spread the entries over 256 sub folders with its last two digits
+	return RootPath / InKey.substr(InKey.size() - 2) / (InKey + GDerivedDataExtension);
+}
+
+bool UHFileDerivedDataBackend::Get(const std::string& InKey, std::vector<uint8_t>& OutData)
+{
+	const std::filesystem::path EntryPath = GetEntryPath(InKey);
+	std::ifstream FileIn(EntryPath, std::ios::in | std::ios::binary);
+	if (!FileIn.is_open())
+	{
+		return false;
+	}
+
+	std::error_code Error;
+	const uint64_t FileSize = std::filesystem::file_size(EntryPath, Error);
+
+	UHDerivedDataHeader Header{};
+	FileIn.read(reinterpret_cast<char*>(&Header), sizeof(Header));
+
+	// the size is checked before allocating, a corrupted header shouldn't request a huge buffer
+	bool bValid = FileIn && !Error && Header.Magic == GDerivedDataMagic && FileSize >= sizeof(Header)
+		&& Header.PayloadSize == FileSize - sizeof(Header);
+	if (bValid)
+	{
+		OutData.resize(Header.PayloadSize);
+		FileIn.read(reinterpret_cast<char*>(OutData.data()), Header.PayloadSize);
+		bValid = static_cast<uint64_t>(FileIn.gcount()) == Header.PayloadSize;
+	}
+	FileIn.close();
+
+	if (bValid)
+	{
+		UHContentHasher Hasher;
+		Hasher.Update(OutData.data(), OutData.size());
+		bValid = Hasher.GetHash() == Header.PayloadHash;
+	}
+
+	if (!bValid)
+	{
+		UHE_LOG("Derived data " + EntryPath.generic_string() + " is corrupted, it's ignored.\n");
+		OutData.clear();
+		if (!bReadOnly)
+		{
+			std::filesystem::remove(EntryPath, Error);
+		}
+		return false;
+	}
+
+	// mark as recently used
+	if (!bReadOnly)
+	{
+		std::filesystem::last_write_time(EntryPath, std::filesystem::file_time_type::clock::now(), Error);
+	}
+
+	return true;
+}
+
+bool UHFileDerivedDataBackend::Put(const std::string& InKey, const std::vector<uint8_t>& InData)
+{
+	if (bReadOnly)
+	{
+		return false;
+	}
+
+	const std::filesystem::path EntryPath = GetEntryPath(InKey);
+	std::error_code Error;
+	if (std::filesystem::exists(EntryPath, Error))
+	{
+		// content addressed, an existing entry is already the same data
+		return true;
+	}
+	std::filesystem::create_directories(EntryPath.parent_path(), Error);
+
+	// unique temp name, another process or thread can put the same key at the same time
+	std::filesystem::path TempPath = EntryPath;
+	TempPath += MakeTempSuffix();
+
+	UHContentHasher Hasher;
+	Hasher.Update(InData.data(), InData.size());
+
+	UHDerivedDataHeader Header{};
+	Header.Magic = GDerivedDataMagic;
+	Header.PayloadSize = InData.size();
+	Header.PayloadHash = Hasher.GetHash();
+
+	std::ofstream FileOut(TempPath, std::ios::out | std::ios::binary);
+	if (!FileOut.is_open())
+	{
+		return false;
+	}
+
+	FileOut.write(reinterpret_cast<const char*>(&Header), sizeof(Header));
+	FileOut.write(reinterpret_cast<const char*>(InData.data()), InData.size());
+	FileOut.close();
+
+	if (!FileOut)
+	{
+		std::filesystem::remove(TempPath, Error);
+		return false;
+	}
+
+	std::filesystem::rename(TempPath, EntryPath, Error);
+	if (Error)
+	{
+		std::filesystem::remove(TempPath, Error);
+		return false;
+	}
+
+	if (MaxBytes > 0 && (TotalBytes += sizeof(Header) + InData.size()) > MaxBytes)
+	{
+		Trim();
+	}
+
+	return true;
+}
+
+void UHFileDerivedDataBackend::Trim()
+{
+	// only one thread trims, the others keep going
+	std::unique_lock<std::mutex> Lock(TrimLock, std::try_to_lock);
+	if (!Lock.owns_lock() || MaxBytes == 0 || bReadOnly)
+	{
+		return;
+	}
+
+	struct UHEntryInfo
+	{
+		std::filesystem::path Path;
+		std::filesystem::file_time_type Time;
+		uint64_t Size;
+	};
+
+	std::vector<UHEntryInfo> Entries;
+	uint64_t Bytes = 0;
+	std::error_code Error;
+	for (std::filesystem::recursive_directory_iterator Idx(RootPath, Error), End; Idx != End; Idx.increment(Error))
+	{
+		if (Idx->is_regular_file(Error) && Idx->path().extension() == GDerivedDataExtension)
+		{
+			UHEntryInfo Entry;
+			Entry.Path = Idx->path();
+			Entry.Time = Idx->last_write_time(Error);
+			Entry.Size = Idx->file_size(Error);
+			Bytes += Entry.Size;
+			Entries.push_back(Entry);
+		}
+	}
+
+	if (Bytes <= MaxBytes)
+	{
+		TotalBytes = Bytes;
+		return;
+	}
+
+	// evict the least recently used entries until it's under 90% of the limit, so it doesn't trim again right after
+	std::sort(Entries.begin(), Entries.end(), [](const UHEntryInfo& A, const UHEntryInfo& B)
+		{
+			return A.Time < B.Time;
+		});
+
+	const uint64_t TargetBytes = MaxBytes / 10 * 9;
+	size_t NumEvicted = 0;
+	for (const UHEntryInfo& Entry : Entries)
+	{
+		if (Bytes <= TargetBytes)
+		{
+			break;
+		}
+
+		if (std::filesystem::remove(Entry.Path, Error))
+		{
+			Bytes -= Entry.Size;
+			NumEvicted++;
+		}
+	}
+
+	TotalBytes = Bytes;
+	UHE_LOG("Derived data cache trimmed, " + std::to_string(NumEvicted) + " entries evicted.\n");
+}
+
+UHDerivedDataCache::UHDerivedDataCache()
+	: LocalStore(nullptr)
+	, RemoteStore(nullptr)
+	, NumLocalHits(0)
+	, NumRemoteHits(0)
+	, NumMisses(0)
+{
+
+}
+
+void UHDerivedDataCache::Initialize(const UHEngineSettings& InSettings)
+{
+	Release();
+	if (!InSettings.bEnableDerivedDataCache)
+	{
+		return;
+	}
+
+	const uint64_t MaxBytes = static_cast<uint64_t>(InSettings.DerivedDataCacheSizeMB * 1024.0f * 1024.0f);
+	LocalStore = MakeUnique<UHFileDerivedDataBackend>(GDerivedDataCachePath, MaxBytes, false);
+
+	// the shared store is owned by whoever hosts it, it's never trimmed from here
+	if (!InSettings.DerivedDataRemotePath.empty())
+	{
+		if (std::filesystem::exists(InSettings.DerivedDataRemotePath))
+		{
+			RemoteStore = MakeUnique<UHFileDerivedDataBackend>(InSettings.DerivedDataRemotePath, 0, InSettings.bDerivedDataRemoteReadOnly);
+		}
+		else
+		{
+			UHE_LOG("Remote derived data path " + InSettings.DerivedDataRemotePath + " isn't available, only the local cache is used.\n");
+		}
+	}
+}
+
+void UHDerivedDataCache::Release()
+{
+	if (LocalStore != nullptr && NumLocalHits + NumRemoteHits + NumMisses > 0)
+	{
+		UHE_LOG("Derived data cache: " + std::to_string(NumLocalHits) + " local hits, " + std::to_string(NumRemoteHits) + " remote hits, "
+			+ std::to_string(NumMisses) + " misses.\n");
+	}
+
+	LocalStore.reset();
+	RemoteStore.reset();
+	NumLocalHits = 0;
+	NumRemoteHits = 0;
+	NumMisses = 0;
+}
+
+bool UHDerivedDataCache::IsEnabled() const
+{
+	return LocalStore != nullptr;
+}
+
+std::string UHDerivedDataCache::MakeKey(const std::string& InType, uint32_t InVersion, uint64_t InHash)
+{
+	char HashString[17];
+	snprintf(HashString, sizeof(HashString), "%016llx", static_cast<unsigned long long>(InHash));
+	return InType + "_v" + std::to_string(InVersion) + "_" + HashString;
+}
+
+bool UHDerivedDataCache::Get(const std::string& InKey, std::vector<uint8_t>& OutData)
+{
+	if (!IsEnabled())
+	{
+		return false;
+	}
+
+	if (LocalStore->Get(InKey, OutData))
+	{
+		NumLocalHits++;
+		return true;
+	}
+
+	if (RemoteStore != nullptr && RemoteStore->Get(InKey, OutData))
+	{
+		NumRemoteHits++;
+		LocalStore->Put(InKey, OutData);
+		return true;
+	}
+
+	NumMisses++;
+	return false;
+}
+
+void UHDerivedDataCache::Put(const std::string& InKey, const std::vector<uint8_t>& InData)
+{
+	if (!IsEnabled())
+	{
+		return;
+	}
+
+	LocalStore->Put(InKey, InData);
+	if (RemoteStore != nullptr)
+	{
+		RemoteStore->Put(InKey, InData);
+	}
+}
+
+bool UHDerivedDataCache::GetFile(const std::string& InKey, const std::filesystem::path& InOutputPath)
+{
+	std::vector<uint8_t> Data;
+	if (!Get(InKey, Data))
+	{
+		return false;
+	}
+
+	std::error_code Error;
+	std::filesystem::create_directories(InOutputPath.parent_path(), Error);
+
+	std::ofstream FileOut(InOutputPath, std::ios::out | std::ios::binary);
+	FileOut.write(reinterpret_cast<const char*>(Data.data()), Data.size());
+	FileOut.close();
+
+	return static_cast<bool>(FileOut);
+}
+
+void UHDerivedDataCache::PutFile(const std::string& InKey, const std::filesystem::path& InPath)
+{
+	if (!IsEnabled())
+	{
+		return;
+	}
+
+	std::ifstream FileIn(InPath, std::ios::in | std::ios::binary | std::ios::ate);
+	if (!FileIn.is_open())
+	{
+		return;
+	}
+
+	std::vector<uint8_t> Data(static_cast<size_t>(FileIn.tellg()));
+	FileIn.seekg(0);
+	FileIn.read(reinterpret_cast<char*>(Data.data()), Data.size());
+	FileIn.close();
+
+	Put(InKey, Data);
+}
@@ -0,0 +1,168 @@
+#pragma once
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <memory>
+#include <filesystem>
+#include <atomic>
+#include <mutex>
+#include <type_traits>
+#include "../CoreGlobals.h"
+
+struct UHEngineSettings;
+
+// 64-bit FNV-1a content hash streamed over the inputs of derived data
+// bulk data is consumed a word at a time for throughput, the shift mixes the high bits back down
+class UHContentHasher
+{
+public:
+	UHContentHasher();
+
+	void Update(const void* InData, size_t InSize);
+	void Update(const std::string& InString);
+	bool UpdateFile(const std::filesystem::path& InPath);
+	uint64_t GetHash() const;
+
+	template <typename T>
+	void UpdateValue(const T& InValue)
+	{
+		static_assert(std::is_trivially_copyable_v<T>, "Only trivially copyable values can be hashed as bytes.");
+		Update(&InValue, sizeof(T));
+	}
+
+	template <typename T>
+	void UpdateVector(const std::vector<T>& InVector)
+	{
+		static_assert(std::is_trivially_copyable_v<T>, "Only trivially copyable values can be hashed as bytes.");
+		UpdateValue(InVector.size());
+		Update(InVector.data(), InVector.size() * sizeof(T));
+	}
+
+private:
+	uint64_t Hash;
+};
+
+// a store of derived data, entries are addressed by content so they never go stale and can be shared between machines
+class UHDerivedDataBackend
+{
+public:
+	virtual ~UHDerivedDataBackend() {}
+
+	virtual std::string GetName() const = 0;
+	virtual bool Get(const std::string& InKey, std::vector<uint8_t>& OutData) = 0;
+	virtual bool Put(const std::string& InKey, const std::vector<uint8_t>& InData) = 0;
+};
+
+// directory backend, it's the local store and a shared folder can stand in for a remote store
+// entries are written to a temp file and renamed, so a reader never sees a partial entry
+// a hit touches the file time, trimming the oldest files evicts the least recently used entries
+class UHFileDerivedDataBackend : public UHDerivedDataBackend
+{
+public:
+	// 0 max bytes means no limit
+	UHFileDerivedDataBackend(const std::filesystem::path& InRootPath, uint64_t InMaxBytes, bool bInReadOnly);
+
+	virtual std::string GetName() const override;
+	virtual bool Get(const std::string& InKey, std::vector<uint8_t>& OutData) override;
+	virtual bool Put(const std::string& InKey, const std::vector<uint8_t>& InData) override;
+
+	void Trim();
+
+private:
+	std::filesystem::path GetEntryPath(const std::string& InKey) const;
+
+	std::filesystem::path RootPath;
+	uint64_t MaxBytes;
+	bool bReadOnly;
+	std::atomic<uint64_t> TotalBytes;
+	std::mutex TrimLock;
+};
+
+// derived data cache, compressed texture mips, SPIR-V, meshlets and baked cube lighting are stored here
+// the key is built from the data type, the tool version and the content hash of every input (source and settings)
+// a local miss falls back to the remote store and fills the local store, puts go to both
+class UHDerivedDataCache
+{
+public:
+	UHDerivedDataCache();
+
+	void Initialize(const UHEngineSettings& InSettings);
+	void Release();
+	bool IsEnabled() const;
+
+	// bump the version when the output of a type changes, the old entries are simply never hit again
+	static std::string MakeKey(const std::string& InType, uint32_t InVersion, uint64_t InHash);
+
+	// thread-safe
+	bool Get(const std::string& InKey, std::vector<uint8_t>& OutData);
+	void Put(const std::string& InKey, const std::vector<uint8_t>& InData);
+
+	// whole file entries, e.g. shader binaries
+	bool GetFile(const std::string& InKey, const std::filesystem::path& InOutputPath);
+	void PutFile(const std::string& InKey, const std::filesystem::path& InPath);
+
+	// payload helpers
+	template <typename T>
+	static void WriteValue(std::vector<uint8_t>& OutData, const T& InValue)
+	{
+		static_assert(std::is_trivially_copyable_v<T>, "Only trivially copyable values can be stored as bytes.");
+		const size_t Offset = OutData.size();
+		OutData.resize(Offset + sizeof(T));
+		UHMEMCOPY(OutData.data() + Offset, &InValue, sizeof(T));
+	}
+
+	template <typename T>
+	static bool ReadValue(const std::vector<uint8_t>& InData, size_t& InOutOffset, T& OutValue)
+	{
+		static_assert(std::is_trivially_copyable_v<T>, "Only trivially copyable values can be stored as bytes.");
+		if (InOutOffset + sizeof(T) > InData.size())
+		{
+			return false;
+		}
+
+		UHMEMCOPY(&OutValue, InData.data() + InOutOffset, sizeof(T));
+		InOutOffset += sizeof(T);
+		return true;
+	}
+
+	template <typename T>
+	static void WriteVector(std::vector<uint8_t>& OutData, const std::vector<T>& InVector)
+	{
+		WriteValue(OutData, static_cast<uint64_t>(InVector.size()));
+		const size_t Offset = OutData.size();
+		OutData.resize(Offset + InVector.size() * sizeof(T));
+		if (InVector.size() > 0)
+		{
+			UHMEMCOPY(OutData.data() + Offset, InVector.data(), InVector.size() * sizeof(T));
+		}
+	}
+
+	template <typename T>
+	static bool ReadVector(const std::vector<uint8_t>& InData, size_t& InOutOffset, std::vector<T>& OutVector)
+	{
+		uint64_t Count = 0;
+		if (!ReadValue(InData, InOutOffset, Count) || Count > (InData.size() - InOutOffset) / sizeof(T))
+		{
+			return false;
+		}
+
+		OutVector.resize(Count);
+		if (Count > 0)
+		{
+			UHMEMCOPY(OutVector.data(), InData.data() + InOutOffset, Count * sizeof(T));
+		}
+		InOutOffset += Count * sizeof(T);
+		return true;
+	}
+
+private:
+	UniquePtr<UHFileDerivedDataBackend> LocalStore;
+	UniquePtr<UHFileDerivedDataBackend> RemoteStore;
+
+	std::atomic<uint32_t> NumLocalHits;
+	std::atomic<uint32_t> NumRemoteHits;
+	std::atomic<uint32_t> NumMisses;
+};
+
+inline UHDerivedDataCache GDerivedDataCache;
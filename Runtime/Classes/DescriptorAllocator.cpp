@@ -0,0 +1,350 @@
+#include "DescriptorAllocator.h"
+#include "../Engine/Graphic.h"
+#include "../Renderer/RenderingTypes.h"
+#include "../CoreGlobals.h"
+
+UHDescriptorAllocator::UHDescriptorAllocator()
+	: CurrentPageIndex(UHINDEXNONE)
+{
+	CurrentFramePageIndex.fill(UHINDEXNONE);
+}
+
+void UHDescriptorAllocator::Release()
+{
+	std::lock_guard<std::mutex> Lock(AllocatorLock);
+	for (VkDescriptorPool& Page : Pages)
+	{
+		SafeDestroyDescriptorPool(LogicalDevice, Page);
+	}
+
+	Pages.clear();
+	CurrentPageIndex = UHINDEXNONE;
+
+	for (uint32_t Idx = 0; Idx < GMaxFrameInFlight; Idx++)
+	{
+		for (VkDescriptorPool& Page : FramePages[Idx])
+		{
+			SafeDestroyDescriptorPool(LogicalDevice, Page);
+		}
+		FramePages[Idx].clear();
+	}
+	CurrentFramePageIndex.fill(UHINDEXNONE);
+
+	LayoutPoolSizes.clear();
+	RetiredSets.clear();
+	FreeSets.clear();
+	SetPages.clear();
+}
+
+bool UHDescriptorAllocator::Allocate(VkDescriptorSetLayout InLayout, const std::vector<VkDescriptorSetLayoutBinding>& InBindings
+	, uint32_t InCount, VkDescriptorSet* OutSets)
+{
+	if (InLayout == nullptr || InCount == 0)
+	{
+		return false;
+	}
+
+	std::lock_guard<std::mutex> Lock(AllocatorLock);
+	CachePoolSizes(InLayout, InBindings);
+
+	// reuse sets from the free list first, they're recycled by ResetFrame
+	uint32_t NumAllocated = 0;
+	std::vector<VkDescriptorSet>& Free = FreeSets[InLayout];
+	while (!Free.empty() && NumAllocated < InCount)
+	{
+		OutSets[NumAllocated++] = Free.back();
+		Free.pop_back();
+	}
+
+	if (NumAllocated == InCount)
+	{
+		return true;
+	}
+
+	const uint32_t NumToAllocate = InCount - NumAllocated;
+	VkDescriptorSet* SetsToAllocate = OutSets + NumAllocated;
+
+	// huge layouts like bindless tables get a dedicated page
+	const std::vector<VkDescriptorPoolSize> DefaultSizes = GetDefaultPoolSizes();
+	std::vector<VkDescriptorPoolSize> RequiredSizes = LayoutPoolSizes[InLayout];
+	bool bNeedDedicatedPage = false;
+	for (VkDescriptorPoolSize& RequiredSize : RequiredSizes)
+	{
+		RequiredSize.descriptorCount *= NumToAllocate;
+
+		bool bFitsDefaultPage = false;
+		for (const VkDescriptorPoolSize& DefaultSize : DefaultSizes)
+		{
+			if (DefaultSize.type == RequiredSize.type && DefaultSize.descriptorCount >= RequiredSize.descriptorCount * 4)
+			{
+				bFitsDefaultPage = true;
+				break;
+			}
+		}
+		bNeedDedicatedPage |= !bFitsDefaultPage;
+	}
+
+	if (bNeedDedicatedPage)
+	{
+		VkDescriptorPool NewPage = nullptr;
+		if (!CreatePage(RequiredSizes, NumToAllocate, VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT
+			, "DescriptorPage" + std::to_string(Pages.size()), NewPage))
+		{
+			return false;
+		}
+		Pages.push_back(NewPage);
+		return AllocateFromPersistentPage(NewPage, InLayout, NumToAllocate, SetsToAllocate);
+	}
+
+	// try the current page, and open a new page if it's full
+	if (CurrentPageIndex != UHINDEXNONE && AllocateFromPersistentPage(Pages[CurrentPageIndex], InLayout, NumToAllocate, SetsToAllocate))
+	{
+		return true;
+	}
+
+	VkDescriptorPool NewPage = nullptr;
+	if (!CreatePage(DefaultSizes, SetsPerPage, VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT
+		, "DescriptorPage" + std::to_string(Pages.size()), NewPage))
+	{
+		return false;
+	}
+	Pages.push_back(NewPage);
+	CurrentPageIndex = static_cast<int32_t>(Pages.size()) - 1;
+
+	return AllocateFromPersistentPage(Pages[CurrentPageIndex], InLayout, NumToAllocate, SetsToAllocate);
+}
+
+void UHDescriptorAllocator::Free(VkDescriptorSetLayout InLayout, uint32_t InCount, VkDescriptorSet* InSets)
+{
+	if (InLayout == nullptr)
+	{
+		return;
+	}
+
+	std::lock_guard<std::mutex> Lock(AllocatorLock);
+	for (uint32_t Idx = 0; Idx < InCount; Idx++)
+	{
+		if (InSets[Idx] != nullptr)
+		{
+			UHRetiredSet RetiredSet;
+			RetiredSet.Set = InSets[Idx];
+			RetiredSet.RetiredFrame = GFrameNumber;
+			RetiredSets[InLayout].push_back(RetiredSet);
+			InSets[Idx] = nullptr;
+		}
+	}
+}
+
+VkDescriptorSet UHDescriptorAllocator::AllocateFrameSet(VkDescriptorSetLayout InLayout, int32_t InFrameIdx)
+{
+	if (InLayout == nullptr)
+	{
+		return nullptr;
+	}
+
+	std::lock_guard<std::mutex> Lock(AllocatorLock);
+	std::vector<VkDescriptorPool>& Frame = FramePages[InFrameIdx];
+	int32_t& PageIndex = CurrentFramePageIndex[InFrameIdx];
+
+	// walk through the pages that are already created for the frame before opening a new one
+	VkDescriptorSet OutSet = nullptr;
+	while (PageIndex != UHINDEXNONE && PageIndex < static_cast<int32_t>(Frame.size()))
+	{
+		if (AllocateFromPage(Frame[PageIndex], InLayout, 1, &OutSet))
+		{
+			return OutSet;
+		}
+		PageIndex++;
+	}
+
+	VkDescriptorPool NewPage = nullptr;
+	if (!CreatePage(GetDefaultPoolSizes(), SetsPerPage, 0
+		, "DescriptorFramePage" + std::to_string(InFrameIdx) + "_" + std::to_string(Frame.size()), NewPage))
+	{
+		return nullptr;
+	}
+	Frame.push_back(NewPage);
+	PageIndex = static_cast<int32_t>(Frame.size()) - 1;
+
+	if (!AllocateFromPage(NewPage, InLayout, 1, &OutSet))
+	{
+		UHE_LOG("Failed to allocate frame descriptor set!\n");
+		return nullptr;
+	}
+
+	return OutSet;
+}
+
+void UHDescriptorAllocator::ResetFrame(int32_t InFrameIdx)
+{
+	std::lock_guard<std::mutex> Lock(AllocatorLock);
+
+	// the GPU frame is done, the frame sets can be reset as a whole and the pages are kept for the next time
+	for (VkDescriptorPool Page : FramePages[InFrameIdx])
+	{
+		vkResetDescriptorPool(LogicalDevice, Page, 0);
+	}
+	CurrentFramePageIndex[InFrameIdx] = FramePages[InFrameIdx].empty() ? UHINDEXNONE : 0;
+
+	// move the sets that no frames in flight could be using to the free list
+	for (auto& Retired : RetiredSets)
+	{
+		std::vector<UHRetiredSet>& Sets = Retired.second;
+		for (size_t Idx = 0; Idx < Sets.size(); )
+		{
+			if (GFrameNumber > Sets[Idx].RetiredFrame + GMaxFrameInFlight)
+			{
+				FreeSets[Retired.first].push_back(Sets[Idx].Set);
+				Sets[Idx] = Sets.back();
+				Sets.pop_back();
+			}
+			else
+			{
+				Idx++;
+			}
+		}
+	}
+}
+
+void UHDescriptorAllocator::ClearLayoutCache()
+{
+	// a new layout could get the handle of a destroyed one, forget the free sets of destroyed layouts
+	// the pages aren't reset, as sets of other layouts could still be alive, return the cached sets to their pages instead
+	// layouts are only destroyed when the GPU is idle, so the retired sets can be freed as well
+	std::lock_guard<std::mutex> Lock(AllocatorLock);
+	std::unordered_map<VkDescriptorPool, std::vector<VkDescriptorSet>> SetsToFree;
+	for (const auto& Free : FreeSets)
+	{
+		for (VkDescriptorSet Set : Free.second)
+		{
+			SetsToFree[SetPages[Set]].push_back(Set);
+		}
+	}
+
+	for (const auto& Retired : RetiredSets)
+	{
+		for (const UHRetiredSet& Set : Retired.second)
+		{
+			SetsToFree[SetPages[Set.Set]].push_back(Set.Set);
+		}
+	}
+
+	for (const auto& PageSets : SetsToFree)
+	{
+		vkFreeDescriptorSets(LogicalDevice, PageSets.first, static_cast<uint32_t>(PageSets.second.size()), PageSets.second.data());
+		for (VkDescriptorSet Set : PageSets.second)
+		{
+			SetPages.erase(Set);
+		}
+	}
+
+	LayoutPoolSizes.clear();
+	RetiredSets.clear();
+	FreeSets.clear();
+}
+
+uint32_t UHDescriptorAllocator::GetPageCount() const
+{
+	return static_cast<uint32_t>(Pages.size());
+}
+
+uint32_t UHDescriptorAllocator::GetFramePageCount(int32_t InFrameIdx) const
+{
+	return static_cast<uint32_t>(FramePages[InFrameIdx].size());
+}
+
+bool UHDescriptorAllocator::CreatePage(const std::vector<VkDescriptorPoolSize>& InPoolSizes, uint32_t InMaxSets, VkDescriptorPoolCreateFlags InFlags
+	, const std::string& InName, VkDescriptorPool& OutPage)
+{
+	VkDescriptorPoolCreateInfo PoolInfo{};
+	PoolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+	PoolInfo.flags = InFlags;
+	PoolInfo.poolSizeCount = static_cast<uint32_t>(InPoolSizes.size());
+	PoolInfo.pPoolSizes = InPoolSizes.data();
+	PoolInfo.maxSets = InMaxSets;
+
+	if (vkCreateDescriptorPool(LogicalDevice, &PoolInfo, nullptr, &OutPage) != VK_SUCCESS)
+	{
+		UHE_LOG("Failed to create descriptor page!\n");
+		return false;
+	}
+
+#if WITH_EDITOR
+	GfxCache->SetDebugUtilsObjectName(VK_OBJECT_TYPE_DESCRIPTOR_POOL, (uint64_t)OutPage, InName);
+#endif
+
+	return true;
+}
+
+void UHDescriptorAllocator::CachePoolSizes(VkDescriptorSetLayout InLayout, const std::vector<VkDescriptorSetLayoutBinding>& InBindings)
+{
+	// the layout is cached by shader type, so the bindings of the first allocation are the bindings of the layout
+	if (LayoutPoolSizes.find(InLayout) != LayoutPoolSizes.end())
+	{
+		return;
+	}
+
+	std::vector<VkDescriptorPoolSize>& PoolSizes = LayoutPoolSizes[InLayout];
+	for (const VkDescriptorSetLayoutBinding& Binding : InBindings)
+	{
+		if (Binding.descriptorCount == 0)
+		{
+			continue;
+		}
+
+		VkDescriptorPoolSize PoolSize{};
+		PoolSize.type = Binding.descriptorType;
+		PoolSize.descriptorCount = Binding.descriptorCount;
+		PoolSizes.push_back(PoolSize);
+	}
+}
+
+bool UHDescriptorAllocator::AllocateFromPage(VkDescriptorPool InPool, VkDescriptorSetLayout InLayout, uint32_t InCount, VkDescriptorSet* OutSets)
+{
+	std::vector<VkDescriptorSetLayout> SetLayouts(InCount, InLayout);
+	VkDescriptorSetAllocateInfo AllocInfo{};
+	AllocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+	AllocInfo.descriptorPool = InPool;
+	AllocInfo.descriptorSetCount = InCount;
+	AllocInfo.pSetLayouts = SetLayouts.data();
+
+	// out of pool memory or fragmented pool is expected when a page is full, caller will open a new page
+	return vkAllocateDescriptorSets(LogicalDevice, &AllocInfo, OutSets) == VK_SUCCESS;
+}
+
+bool UHDescriptorAllocator::AllocateFromPersistentPage(VkDescriptorPool InPool, VkDescriptorSetLayout InLayout, uint32_t InCount, VkDescriptorSet* OutSets)
+{
+	if (!AllocateFromPage(InPool, InLayout, InCount, OutSets))
+	{
+		return false;
+	}
+
+	// remember the page of the sets, so they can be returned to it when their layout is destroyed
+	for (uint32_t Idx = 0; Idx < InCount; Idx++)
+	{
+		SetPages[OutSets[Idx]] = InPool;
+	}
+
+	return true;
+}
+
+std::vector<VkDescriptorPoolSize> UHDescriptorAllocator::GetDefaultPoolSizes() const
+{
+	// the ratio roughly follows the bindings used by shaders in the engine
+	std::vector<VkDescriptorPoolSize> PoolSizes =
+	{
+		{ VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, SetsPerPage * 4 }
+		, { VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, SetsPerPage }
+		, { VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, SetsPerPage * 4 }
+		, { VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, SetsPerPage * 8 }
+		, { VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, SetsPerPage * 2 }
+		, { VK_DESCRIPTOR_TYPE_SAMPLER, SetsPerPage * 4 }
+	};
+
+	if (GfxCache->IsRayTracingEnabled())
+	{
+		PoolSizes.push_back({ VK_DESCRIPTOR_TYPE_ACCELERATION_STRUCTURE_KHR, SetsPerPage });
+	}
+
+	return PoolSizes;
+}
@@ -0,0 +1,70 @@
+#pragma once
+#include "../../UnheardEngine.h"
+#include "../Engine/RenderResource.h"
+#include "../Renderer/RenderingTypes.h"
+#include <unordered_map>
+#include <array>
+#include <mutex>
+
+// UH descriptor allocator, a shared paged allocator for descriptor sets
+// sets are allocated from large pages instead of creating a pool per shader
+// released sets are kept in a free list of their layout and reused once the frames in flight that might use them are done
+// sets that only live for a frame are allocated from the pages of the frame, which are reset as a whole when the frame comes around
+class UHDescriptorAllocator : public UHRenderResource
+{
+public:
+	static constexpr uint32_t SetsPerPage = 256;
+
+	UHDescriptorAllocator();
+	void Release();
+
+	// allocate sets with the layout, bindings are used for sizing the page when the layout is seen at the first time
+	bool Allocate(VkDescriptorSetLayout InLayout, const std::vector<VkDescriptorSetLayoutBinding>& InBindings
+		, uint32_t InCount, VkDescriptorSet* OutSets);
+
+	// return sets to the free list, they're reused after GMaxFrameInFlight frames
+	void Free(VkDescriptorSetLayout InLayout, uint32_t InCount, VkDescriptorSet* InSets);
+
+	// allocate a set that is only valid for the frame, no need to free it
+	// frame sets always come from default sized pages, so huge layouts like bindless tables aren't supported
+	VkDescriptorSet AllocateFrameSet(VkDescriptorSetLayout InLayout, int32_t InFrameIdx);
+
+	// called by render thread after the GPU frame is done, resets the frame pages and recycles the retired sets
+	void ResetFrame(int32_t InFrameIdx);
+
+	// called when descriptor set layouts are destroyed, the free and retired sets are returned to their pages
+	void ClearLayoutCache();
+
+	uint32_t GetPageCount() const;
+	uint32_t GetFramePageCount(int32_t InFrameIdx) const;
+
+private:
+	struct UHRetiredSet
+	{
+		VkDescriptorSet Set = nullptr;
+		uint32_t RetiredFrame = 0;
+	};
+
+	bool CreatePage(const std::vector<VkDescriptorPoolSize>& InPoolSizes, uint32_t InMaxSets, VkDescriptorPoolCreateFlags InFlags
+		, const std::string& InName, VkDescriptorPool& OutPage);
+	void CachePoolSizes(VkDescriptorSetLayout InLayout, const std::vector<VkDescriptorSetLayoutBinding>& InBindings);
+	bool AllocateFromPage(VkDescriptorPool InPool, VkDescriptorSetLayout InLayout, uint32_t InCount, VkDescriptorSet* OutSets);
+	bool AllocateFromPersistentPage(VkDescriptorPool InPool, VkDescriptorSetLayout InLayout, uint32_t InCount, VkDescriptorSet* OutSets);
+	std::vector<VkDescriptorPoolSize> GetDefaultPoolSizes() const;
+
+	std::vector<VkDescriptorPool> Pages;
+	int32_t CurrentPageIndex;
+
+	// pages of the frame sets, the current page index goes back to 0 after reset
+	std::array<std::vector<VkDescriptorPool>, GMaxFrameInFlight> FramePages;
+	std::array<int32_t, GMaxFrameInFlight> CurrentFramePageIndex;
+
+	// descriptor counts per layout, sets waiting for the GPU and the free list per layout
+	std::unordered_map<VkDescriptorSetLayout, std::vector<VkDescriptorPoolSize>> LayoutPoolSizes;
+	std::unordered_map<VkDescriptorSetLayout, std::vector<UHRetiredSet>> RetiredSets;
+	std::unordered_map<VkDescriptorSetLayout, std::vector<VkDescriptorSet>> FreeSets;
+
+	// the page of each persistent set, frame sets aren't tracked as their pages are reset as a whole
+	std::unordered_map<VkDescriptorSet, VkDescriptorPool> SetPages;
+	std::mutex AllocatorLock;
+};
@@ -6,6 +6,7 @@
 UHGPUMemory::UHGPUMemory()
 	: MemoryBudgetByte(0)
 	, BufferMemory(nullptr)
+    , MemoryTypeIndex(0)
     , CurrentOffset(0)
 {
 
@@ -19,6 +20,7 @@ void UHGPUMemory::Release()
 void UHGPUMemory::AllocateMemory(uint64_t InBudget, uint32_t MemTypeIndex)
 {
     MemoryBudgetByte = InBudget;
+    MemoryTypeIndex = MemTypeIndex;
     const VkPhysicalDeviceMemoryProperties& DeviceMemoryProperties = GfxCache->GetDeviceMemProps();
     if (MemoryBudgetByte > DeviceMemoryProperties.memoryHeaps[MemTypeIndex].size && DeviceMemoryProperties.memoryHeaps[MemTypeIndex].size != 0)
     {
@@ -107,4 +109,9 @@ uint64_t UHGPUMemory::BindMemory(uint64_t InSize, uint64_t InAlignment, VkImage
 VkDeviceMemory UHGPUMemory::GetMemory() const
 {
     return BufferMemory;
+}
+
+uint32_t UHGPUMemory::GetMemoryTypeIndex() const
+{
+    return MemoryTypeIndex;
 }
\ No newline at end of file
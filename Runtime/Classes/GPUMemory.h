@@ -18,10 +18,12 @@ public:
 	uint64_t BindMemory(uint64_t InSize, uint64_t InAlignment, VkBuffer InBuffer);
 	uint64_t BindMemory(uint64_t InSize, uint64_t InAlignment, VkImage InImage, uint64_t ReboundOffset = ~0);
 	VkDeviceMemory GetMemory() const;
+	uint32_t GetMemoryTypeIndex() const;
 
 private:
 	uint64_t MemoryBudgetByte;
 	VkDeviceMemory BufferMemory;
+	uint32_t MemoryTypeIndex;
 
 	// start from 0, if an object is bound, this will increase
 	uint64_t CurrentOffset;
@@ -13,6 +13,8 @@ std::string GetQueryTypeName(VkQueryType InType)
 		return "OcclusionQuery";
 	case VK_QUERY_TYPE_TIMESTAMP:
 		return "TimestampQuery";
+	case VK_QUERY_TYPE_ACCELERATION_STRUCTURE_COMPACTED_SIZE_KHR:
+		return "ASCompactedSizeQuery";
 	};
 
 	return "";
@@ -24,9 +26,7 @@ UHGPUQuery::UHGPUQuery()
 	: QueryCount(0)
 	, State(UHGPUQueryState::Idle)
 	, QueryPool(nullptr)
-#if WITH_EDITOR
 	, PreviousValidTimeStamp(0)
-#endif
 {
 
 }
@@ -64,7 +64,6 @@ void UHGPUQuery::CreateQueryPool(uint32_t InQueryCount, VkQueryType QueryType)
 
 void UHGPUQuery::BeginTimeStamp(VkCommandBuffer InBuffer)
 {
-#if WITH_EDITOR
 	if (!GEnableGPUTiming)
 	{
 		return;
@@ -75,12 +74,10 @@ void UHGPUQuery::BeginTimeStamp(VkCommandBuffer InBuffer)
 		vkResetQueryPool(LogicalDevice, QueryPool, 0, QueryCount);
 		vkCmdWriteTimestamp(InBuffer, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, QueryPool, 0);
 	}
-#endif
 }
 
 void UHGPUQuery::EndTimeStamp(VkCommandBuffer InBuffer)
 {
-#if WITH_EDITOR
 	if (!GEnableGPUTiming)
 	{
 		return;
@@ -91,12 +88,10 @@ void UHGPUQuery::EndTimeStamp(VkCommandBuffer InBuffer)
 		vkCmdWriteTimestamp(InBuffer, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, QueryPool, 1);
 		State = UHGPUQueryState::Requested;
 	}
-#endif
 }
 
 void UHGPUQuery::ResolveTimeStamp(VkCommandBuffer InBuffer)
 {
-#if WITH_EDITOR
 	if (!GEnableGPUTiming)
 	{
 		return;
@@ -117,7 +112,6 @@ void UHGPUQuery::ResolveTimeStamp(VkCommandBuffer InBuffer)
 			PreviousValidTimeStamp = Duration;
 		}
 	}
-#endif
 }
 
 VkQueryPool UHGPUQuery::GetQueryPool() const
@@ -140,39 +134,38 @@ std::string UHGPUQuery::GetDebugName() const
 {
 	return Name;
 }
+#endif
 
 float UHGPUQuery::GetLastTimeStamp() const
 {
 	return PreviousValidTimeStamp;
 }
-#endif
 
 UHGPUTimeQueryScope::UHGPUTimeQueryScope(VkCommandBuffer InCmd, UHGPUQuery* InQuery, std::string InName)
+	: GPUTimeQuery(InQuery)
+	, Cmd(InCmd)
 {
-#if WITH_EDITOR
-	Cmd = InCmd;
-	GPUTimeQuery = InQuery;
-
+	// non-editor builds only create the queries needed at runtime, the others are null
 	if (GPUTimeQuery)
 	{
 		GPUTimeQuery->BeginTimeStamp(Cmd);
+
+	#if WITH_EDITOR
 		GPUTimeQuery->SetDebugName(InName);
 
 		// add to registered list for profiling display
 		std::unique_lock<std::mutex> Lock(GGPUTimeScopeLock);
 		RegisteredGPUTime.push_back(GPUTimeQuery);
+	#endif
 	}
-#endif
 }
 
 UHGPUTimeQueryScope::~UHGPUTimeQueryScope()
 {
-#if WITH_EDITOR
 	if (GPUTimeQuery)
 	{
 		GPUTimeQuery->EndTimeStamp(Cmd);
 	}
-#endif
 }
 
 #if WITH_EDITOR
@@ -24,20 +24,22 @@ public:
 	VkQueryPool GetQueryPool() const;
 	uint32_t GetQueryCount() const;
 
+	// the last resolved duration in ms, 0 until the first resolve
+	float GetLastTimeStamp() const;
+
 #if WITH_EDITOR
 	void SetDebugName(const std::string& InName);
 	std::string GetDebugName() const;
-	float GetLastTimeStamp() const;
 #endif
 
 private:
 	uint32_t QueryCount;
 	UHGPUQueryState State;
 	VkQueryPool QueryPool;
+	float PreviousValidTimeStamp;
 
 #if WITH_EDITOR
 	std::string DebugName;
-	float PreviousValidTimeStamp;
 #endif
 };
 
@@ -52,11 +54,13 @@ public:
 #if WITH_EDITOR
 	static const std::vector<UHGPUQuery*>& GetResiteredGPUTime();
 	static void ClearRegisteredGPUTime();
+#endif
 
 private:
 	UHGPUQuery* GPUTimeQuery;
 	VkCommandBuffer Cmd;
 
+#if WITH_EDITOR
 	// editor only registered game time, which will be displayed in profile
 	static std::vector<UHGPUQuery*> RegisteredGPUTime;
 #endif
@@ -384,6 +384,11 @@ UniquePtr<UHGraphNode> AllocateNewGraphNode(UHGraphNodeType InType)
 	return UHMOVE(NewNode);
 }
 
+void UHMaterialNode::SetMaterialCache(UHMaterial* InMat)
+{
+	MaterialCache = InMat;
+}
+
 void UHMaterialNode::SetMaterialCompileData(UHMaterialCompileData InData)
 {
 	CompileData = InData;
@@ -45,6 +45,7 @@ public:
 	void InsertRoughnessCode(std::string& Code) const;
 	void InsertEmissiveCode(std::string& Code) const;
 	 
+	void SetMaterialCache(UHMaterial* InMat);
 	void SetMaterialCompileData(UHMaterialCompileData InData);
 	void CollectTextureIndex(std::string& Code, size_t& OutSize);
 	void CollectTextureNames(std::vector<std::string>& Names);
@@ -41,7 +41,8 @@ void UHGraphicState::Release()
 	SafeDestroyPipeline(LogicalDevice, RTPipeline);
 }
 
-VkPipelineVertexInputStateCreateInfo GetVertexInputInfo(VkVertexInputBindingDescription& OutBindingDesc, VkVertexInputAttributeDescription& OutAttributeDesc)
+VkPipelineVertexInputStateCreateInfo GetVertexInputInfo(VkVertexInputBindingDescription& OutBindingDesc, VkVertexInputAttributeDescription& OutAttributeDesc
+	, bool bCompressedPosition)
 {
 	VkPipelineVertexInputStateCreateInfo VertexInputInfo{};
 	OutBindingDesc = VkVertexInputBindingDescription{};
@@ -50,13 +51,14 @@ VkPipelineVertexInputStateCreateInfo GetVertexInputInfo(VkVertexInputBindingDesc
 	// in UHE, it uses only position in Input Assembly stage
 	// for other attribute such as UV, Normal, Tangent are stored in another buffer, and access via SV
 	OutBindingDesc.binding = 0;
-	OutBindingDesc.stride = sizeof(UHVector3);
+	// compressed position is snorm16 x4, the decode range is merged into world matrix
+	OutBindingDesc.stride = bCompressedPosition ? sizeof(uint16_t) * 4 : sizeof(UHVector3);
 	OutBindingDesc.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
 
 	OutAttributeDesc = VkVertexInputAttributeDescription{};
 	OutAttributeDesc.binding = 0;
 	OutAttributeDesc.location = 0;
-	OutAttributeDesc.format = VK_FORMAT_R32G32B32_SFLOAT;
+	OutAttributeDesc.format = bCompressedPosition ? VK_FORMAT_R16G16B16A16_SNORM : VK_FORMAT_R32G32B32_SFLOAT;
 	OutAttributeDesc.offset = 0;
 
 	VertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
@@ -253,7 +255,8 @@ bool UHGraphicState::CreateState(UHRenderPassInfo InInfo)
 	// for now, use default lit layout, and prevent value gets cleared
 	VkVertexInputBindingDescription VertexInputBindingDescription;
 	VkVertexInputAttributeDescription AttributeDescription;
-	VkPipelineVertexInputStateCreateInfo VertexInputInfo = GetVertexInputInfo(VertexInputBindingDescription, AttributeDescription);
+	VkPipelineVertexInputStateCreateInfo VertexInputInfo = GetVertexInputInfo(VertexInputBindingDescription, AttributeDescription
+		, GfxCache->IsVertexCompressionEnabled());
 
 	/*** Input assembly, always use triangle list in UH engine ***/
 	VkPipelineInputAssemblyStateCreateInfo InputAssembly{};
@@ -22,28 +22,20 @@ UHMaterial::UHMaterial()
 	, MaterialUsages(UHMaterialUsage{})
 	, MaterialBufferSize(0)
 	, MaterialRTDataCPU(UHRTMaterialData())
+	, ParameterVersion(0)
+	, ParentMaterial(nullptr)
+	, HitGroupIndex(UHINDEXNONE)
 #if WITH_EDITOR
 	, MaterialProps(UHMaterialProperty())
 	, bIsMaterialNodeDirty(false)
 #endif
 {
+	SetObjectClassId(ClassId);
 	MaterialNode = MakeUnique<UHMaterialNode>(this);
 	DefaultMaterialNodePos.x = 544;
 	DefaultMaterialNodePos.y = 208;
 }
 
-UHMaterial::~UHMaterial()
-{
-	for (uint32_t Idx = 0; Idx < GMaxFrameInFlight; Idx++)
-	{
-		UH_SAFE_RELEASE(MaterialConstantsGPU[Idx]);
-		MaterialConstantsGPU[Idx].reset();
-
-		UH_SAFE_RELEASE(MaterialRTDataGPU[Idx]);
-		MaterialRTDataGPU[Idx].reset();
-	}
-}
-
 bool UHMaterial::Import(std::filesystem::path InMatPath)
 {
 	std::ifstream FileIn(InMatPath, std::ios::in | std::ios::binary);
@@ -73,20 +65,43 @@ bool UHMaterial::Import(std::filesystem::path InMatPath)
 	FileIn.read(reinterpret_cast<char*>(&CutoffValue), sizeof(CutoffValue));
 	FileIn.read(reinterpret_cast<char*>(&MaxReflectionBounce), sizeof(MaxReflectionBounce));
 
-	// material graph data
-	UHUtilities::ReadStringVectorData(FileIn, RegisteredTextureNames);
-	ImportGraphData(FileIn);
-
-	// fix up RegisteredTextureNames path
-	for (std::string& TexName : RegisteredTextureNames)
+	if (Version >= UH_ENUM_VALUE(UHMaterialVersion::AddMaterialInstance))
 	{
-		TexName = UHUtilities::StringReplace(TexName, "\\", GPathSeparator);
+		UHUtilities::ReadStringData(FileIn, ParentSourcePath);
 	}
 
-	// material constant data
-	if (Version >= UH_ENUM_VALUE(UHMaterialVersion::GoingBindless))
+	if (ParentSourcePath.empty())
 	{
-		FileIn.read(reinterpret_cast<char*>(&MaterialBufferSize), sizeof(MaterialBufferSize));
+		// material graph data
+		UHUtilities::ReadStringVectorData(FileIn, RegisteredTextureNames);
+		ImportGraphData(FileIn);
+
+		// fix up RegisteredTextureNames path
+		for (std::string& TexName : RegisteredTextureNames)
+		{
+			TexName = UHUtilities::StringReplace(TexName, "\\", GPathSeparator);
+		}
+
+		// material constant data
+		if (Version >= UH_ENUM_VALUE(UHMaterialVersion::GoingBindless))
+		{
+			FileIn.read(reinterpret_cast<char*>(&MaterialBufferSize), sizeof(MaterialBufferSize));
+		}
+	}
+	else
+	{
+		// material instance only stores the overrides, the graph is cloned when the parent is set
+		uint64_t NumOverrides;
+		FileIn.read(reinterpret_cast<char*>(&NumOverrides), sizeof(NumOverrides));
+		Overrides.resize(NumOverrides);
+
+		for (UHMaterialOverride& Override : Overrides)
+		{
+			FileIn.read(reinterpret_cast<char*>(&Override.NodeIndex), sizeof(Override.NodeIndex));
+			FileIn.read(reinterpret_cast<char*>(&Override.NodeType), sizeof(Override.NodeType));
+			FileIn >> Override.Value;
+			UHUtilities::ReadStringData(FileIn, Override.TexturePathName);
+		}
 	}
 
 	FileIn.close();
@@ -196,8 +211,7 @@ void UHMaterial::PostImport()
 	}
 #endif
 
-	AllocateMaterialBuffer();
-	AllocateRTMaterialBuffer();
+	MaterialConstantsCPU.resize(MaterialBufferSize);
 	UpdateMaterialUsage();
 }
 
@@ -216,46 +230,22 @@ void UHMaterial::SetRegisteredTextureIndexes(std::vector<int32_t> InData)
 	RegisteredTextureIndexes = InData;
 }
 
-void UHMaterial::AllocateMaterialBuffer()
-{
-	MaterialConstantsCPU.resize(MaterialBufferSize);
-
-	for (uint32_t Idx = 0; Idx < GMaxFrameInFlight; Idx++)
-	{
-		UH_SAFE_RELEASE(MaterialConstantsGPU[Idx]);
-		MaterialConstantsGPU[Idx].reset();
-
-		// the buffer size will be aligned to 256, check how many element it actually needs
-		size_t ElementCount = (MaterialBufferSize + 256) / 256;
-		MaterialConstantsGPU[Idx] = GfxCache->RequestRenderBuffer<uint8_t>(ElementCount, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT
-			, Name + "_Constant");
-	}
-}
-
-void UHMaterial::AllocateRTMaterialBuffer()
-{
-	// allocate RT matrial buffer
-	for (int32_t Idx = 0; Idx < GMaxFrameInFlight; Idx++)
-	{
-		UH_SAFE_RELEASE(MaterialRTDataGPU[Idx]);
-		MaterialRTDataGPU[Idx].reset();
-
-		MaterialRTDataGPU[Idx] = GfxCache->RequestRenderBuffer<UHRTMaterialData>(1, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT
-			, Name + "_RTConstant");
-	}
-}
-
-void UHMaterial::UploadMaterialData(int32_t CurrFrame)
+void UHMaterial::UpdateMaterialData()
 {
 	if (MaterialBufferSize == 0)
 	{
 		return;
 	}
 
-	// update usages before uploading
+	// update usages before filling
 	UpdateMaterialUsage();
 
-	// upload data one by one, this must be following the definitions in GetCBufferDefineCode()
+	// keep the previous blocks for checking whether the content is changed
+	const std::vector<uint8_t> PrevConstants = MaterialConstantsCPU;
+	const UHRTMaterialData PrevRTData = MaterialRTDataCPU;
+	MaterialConstantsCPU.resize(MaterialBufferSize);
+
+	// fill data one by one, this must be following the definitions in GetCBufferDefineCode()
 	size_t BufferAddress = 0;
 	size_t Stride = sizeof(float);
 
@@ -289,9 +279,8 @@ void UHMaterial::UploadMaterialData(int32_t CurrFrame)
 	UHMEMCOPY(MaterialConstantsCPU.data() + BufferAddress, &MaxReflectionBounce, Stride);
 	BufferAddress += Stride;
 
-	// upload material data, the BufferAddress should reach the end of material buffer at this point
+	// the BufferAddress should reach the end of material buffer at this point
 	assert(MaterialBufferSize == BufferAddress);
-	MaterialConstantsGPU[CurrFrame]->UploadAllData(MaterialConstantsCPU.data(), MaterialBufferSize);
 
 	if (GfxCache->IsRayTracingEnabled())
 	{
@@ -327,9 +316,12 @@ void UHMaterial::UploadMaterialData(int32_t CurrFrame)
 		// copy material parameters
 		MaterialNode->CopyRTMaterialParameter(MaterialRTDataCPU, DstIndex);
 		assert(DstIndex < GMaxRTMaterialDataSlot);
+	}
 
-		// finally, upload to GPU buffer
-		MaterialRTDataGPU[CurrFrame]->UploadAllData(&MaterialRTDataCPU);
+	// bump the version only when the content is changed, so the arena can skip the upload
+	if (PrevConstants != MaterialConstantsCPU || memcmp(&PrevRTData, &MaterialRTDataCPU, sizeof(UHRTMaterialData)) != 0)
+	{
+		ParameterVersion++;
 	}
 }
 
@@ -392,6 +384,135 @@ bool UHMaterial::IsDifferentBlendGroup(UHMaterial* InA, UHMaterial* InB)
 		!= (UH_ENUM_VALUE(InB->GetBlendMode()) / UH_ENUM_VALUE(UHBlendMode::TranditionalAlpha));
 }
 
+bool UHMaterial::SetParentMaterial(UHMaterial* InParent)
+{
+	if (InParent == nullptr || InParent == this || InParent->IsMaterialInstance())
+	{
+		UHE_LOG("Material instance " + Name + " needs a non-instance parent material.\n");
+		return false;
+	}
+
+	ParentMaterial = InParent;
+	ParentSourcePath = InParent->GetSourcePath();
+	if (!CloneParentGraph())
+	{
+		ParentMaterial = nullptr;
+		return false;
+	}
+
+	ApplyOverrides();
+	if (!UHUtilities::FindByElement(InParent->MaterialInstances, this))
+	{
+		InParent->MaterialInstances.push_back(this);
+	}
+
+	return true;
+}
+
+bool UHMaterial::IsMaterialInstance() const
+{
+	return !ParentSourcePath.empty();
+}
+
+UHMaterial* UHMaterial::GetParentMaterial() const
+{
+	return ParentMaterial;
+}
+
+UHMaterial* UHMaterial::GetShaderMaterial()
+{
+	return (ParentMaterial != nullptr) ? ParentMaterial : this;
+}
+
+std::string UHMaterial::GetParentSourcePath() const
+{
+	return ParentSourcePath;
+}
+
+const std::vector<UHMaterial*>& UHMaterial::GetMaterialInstances() const
+{
+	return MaterialInstances;
+}
+
+void UHMaterial::SetHitGroupIndex(int32_t InIndex)
+{
+	HitGroupIndex = InIndex;
+}
+
+int32_t UHMaterial::GetHitGroupIndex() const
+{
+	return HitGroupIndex;
+}
+
+bool UHMaterial::CloneParentGraph()
+{
+	// clone the graph from parent asset, so the node order matches the shaders compiled by parent
+	// there is no in-memory copy for graph nodes, and the asset is the one that shaders are compiled from
+	UHMaterial ParentCopy;
+	if (!ParentCopy.Import(ParentMaterial->GetPath()))
+	{
+		UHE_LOG("Failed to clone parent graph for material instance " + Name + "!\n");
+		return false;
+	}
+
+	MaterialNode = UHMOVE(ParentCopy.MaterialNode);
+	MaterialNode->SetMaterialCache(this);
+	EditNodes = UHMOVE(ParentCopy.EditNodes);
+	EditGUIRelativePos = ParentCopy.EditGUIRelativePos;
+	DefaultMaterialNodePos = ParentCopy.DefaultMaterialNodePos;
+
+	// states are compiled into the parent's graphic states, they must follow the parent
+	CullMode = ParentMaterial->CullMode;
+	BlendMode = ParentMaterial->BlendMode;
+	MaterialBufferSize = ParentMaterial->MaterialBufferSize;
+	MaterialConstantsCPU.resize(MaterialBufferSize);
+
+	return true;
+}
+
+void UHMaterial::ApplyOverrides()
+{
+	for (const UHMaterialOverride& Override : Overrides)
+	{
+		if (Override.NodeIndex < 0 || Override.NodeIndex >= static_cast<int32_t>(EditNodes.size())
+			|| EditNodes[Override.NodeIndex]->GetType() != Override.NodeType)
+		{
+			UHE_LOG("Material instance " + Name + " has an override that doesn't match the parent graph, skipped.\n");
+			continue;
+		}
+
+		UHGraphNode* Node = EditNodes[Override.NodeIndex].get();
+		switch (Override.NodeType)
+		{
+		case UHGraphNodeType::FloatNode:
+			static_cast<UHFloatNode*>(Node)->SetValue(Override.Value.x);
+			break;
+		case UHGraphNodeType::Float2Node:
+			static_cast<UHFloat2Node*>(Node)->SetValue(UHVector2(Override.Value.x, Override.Value.y));
+			break;
+		case UHGraphNodeType::Float3Node:
+			static_cast<UHFloat3Node*>(Node)->SetValue(UHVector3(Override.Value.x, Override.Value.y, Override.Value.z));
+			break;
+		case UHGraphNodeType::Float4Node:
+			static_cast<UHFloat4Node*>(Node)->SetValue(Override.Value);
+			break;
+		case UHGraphNodeType::Texture2DNode:
+			// an empty texture removes the sampling code from graph, which can't be shared with parent
+			if (!Override.TexturePathName.empty())
+			{
+				static_cast<UHTexture2DNode*>(Node)->SetSelectedTexturePathName(Override.TexturePathName);
+			}
+			break;
+		default:
+			break;
+		}
+	}
+
+	// texture names are mapped to texture indexes by asset manager after this
+	MaterialNode->CollectTextureNames(RegisteredTextureNames);
+	UpdateMaterialUsage();
+}
+
 UHMaterialCompileFlag UHMaterial::GetCompileFlag() const
 {
 	return CompileFlag;
@@ -411,14 +532,24 @@ const std::vector<std::string>& UHMaterial::GetRegisteredTextureNames()
 	return RegisteredTextureNames;
 }
 
-const std::array<UniquePtr<UHRenderBuffer<uint8_t>>, GMaxFrameInFlight>& UHMaterial::GetMaterialConst()
+const std::vector<uint8_t>& UHMaterial::GetMaterialConstantsCPU() const
+{
+	return MaterialConstantsCPU;
+}
+
+const UHRTMaterialData& UHMaterial::GetRTMaterialDataCPU() const
 {
-	return MaterialConstantsGPU;
+	return MaterialRTDataCPU;
 }
 
-UHRenderBuffer<UHRTMaterialData>* UHMaterial::GetRTMaterialDataGPU(int32_t CurrFrame) const
+uint64_t UHMaterial::GetMaterialBufferSize() const
 {
-	return MaterialRTDataGPU[CurrFrame].get();
+	return MaterialBufferSize;
+}
+
+uint32_t UHMaterial::GetParameterVersion() const
+{
+	return ParameterVersion;
 }
 
 bool UHMaterial::operator==(const UHMaterial& InMat)
@@ -462,8 +593,8 @@ void UHMaterial::SetMaterialBufferSize(size_t InSize)
 	MaterialBufferSize = InSize;
 	if (MaterialConstantsCPU.size() != MaterialBufferSize)
 	{
-		// reallocate the material buffer if size changed
-		AllocateMaterialBuffer();
+		// resize the material block if size changed, the arena layout will be rebuilt by renderer
+		MaterialConstantsCPU.resize(MaterialBufferSize);
 	}
 }
 
@@ -497,23 +628,153 @@ void UHMaterial::Export(const std::filesystem::path InPath)
 	FileOut.write(reinterpret_cast<const char*>(&BlendMode), sizeof(BlendMode));
 	FileOut.write(reinterpret_cast<const char*>(&CutoffValue), sizeof(CutoffValue));
 	FileOut.write(reinterpret_cast<const char*>(&MaxReflectionBounce), sizeof(MaxReflectionBounce));
+	UHUtilities::WriteStringData(FileOut, ParentSourcePath);
 
-	// material graph data
-	MaterialNode->CollectTextureNames(RegisteredTextureNames);
-	UHUtilities::WriteStringVectorData(FileOut, RegisteredTextureNames);
-	ExportGraphData(FileOut);
+	if (ParentSourcePath.empty())
+	{
+		// material graph data
+		MaterialNode->CollectTextureNames(RegisteredTextureNames);
+		UHUtilities::WriteStringVectorData(FileOut, RegisteredTextureNames);
+		ExportGraphData(FileOut);
 
-	// new version, going bindless
-	if (Version >= UH_ENUM_VALUE(UHMaterialVersion::GoingBindless))
+		// new version, going bindless
+		if (Version >= UH_ENUM_VALUE(UHMaterialVersion::GoingBindless))
+		{
+			// ensure the MaterialBufferSize is up-to-date before saving
+			GetCBufferDefineCode(MaterialBufferSize);
+			FileOut.write(reinterpret_cast<const char*>(&MaterialBufferSize), sizeof(MaterialBufferSize));
+		}
+	}
+	else
 	{
-		// ensure the MaterialBufferSize is up-to-date before saving
-		GetCBufferDefineCode(MaterialBufferSize);
-		FileOut.write(reinterpret_cast<const char*>(&MaterialBufferSize), sizeof(MaterialBufferSize));
+		// material instance only saves the differences from parent, refresh them if the graph is cloned
+		if (EditNodes.size() > 0)
+		{
+			CollectOverrides();
+		}
+
+		uint64_t NumOverrides = Overrides.size();
+		FileOut.write(reinterpret_cast<const char*>(&NumOverrides), sizeof(NumOverrides));
+
+		for (const UHMaterialOverride& Override : Overrides)
+		{
+			FileOut.write(reinterpret_cast<const char*>(&Override.NodeIndex), sizeof(Override.NodeIndex));
+			FileOut.write(reinterpret_cast<const char*>(&Override.NodeType), sizeof(Override.NodeType));
+			FileOut << Override.Value;
+			UHUtilities::WriteStringData(FileOut, Override.TexturePathName);
+		}
 	}
 
 	FileOut.close();
 }
 
+void UHMaterial::ExportInstance(const std::string InSourcePath)
+{
+	// export a new instance asset based on this material, instance of an instance is flattened to the same parent
+	UHMaterial Instance;
+	Instance.SourcePath = InSourcePath;
+	Instance.Name = std::filesystem::path(InSourcePath).filename().generic_string();
+	Instance.CullMode = CullMode;
+	Instance.BlendMode = BlendMode;
+	Instance.CutoffValue = CutoffValue;
+	Instance.MaxReflectionBounce = MaxReflectionBounce;
+
+	if (IsMaterialInstance())
+	{
+		if (EditNodes.size() > 0)
+		{
+			CollectOverrides();
+		}
+		Instance.ParentSourcePath = ParentSourcePath;
+		Instance.Overrides = Overrides;
+	}
+	else
+	{
+		Instance.ParentSourcePath = SourcePath;
+	}
+
+	Instance.Export();
+}
+
+bool UHMaterial::RebuildFromParent()
+{
+	// parent graph is changed and saved, clone it again and reapply the overrides
+	if (!IsMaterialInstance() || ParentMaterial == nullptr)
+	{
+		return false;
+	}
+
+	if (!CloneParentGraph())
+	{
+		return false;
+	}
+
+	ApplyOverrides();
+	return true;
+}
+
+void UHMaterial::CollectOverrides()
+{
+	if (ParentMaterial == nullptr)
+	{
+		return;
+	}
+
+	Overrides.clear();
+	const std::vector<UniquePtr<UHGraphNode>>& ParentNodes = ParentMaterial->GetEditNodes();
+	const size_t NumNodes = std::min(EditNodes.size(), ParentNodes.size());
+
+	for (size_t Idx = 0; Idx < NumNodes; Idx++)
+	{
+		UHGraphNode* Node = EditNodes[Idx].get();
+		const UHGraphNode* ParentNode = ParentNodes[Idx].get();
+		if (Node->GetType() != ParentNode->GetType())
+		{
+			continue;
+		}
+
+		UHMaterialOverride Override;
+		Override.NodeIndex = static_cast<int32_t>(Idx);
+		Override.NodeType = Node->GetType();
+
+		// parameter nodes compare the values, texture nodes compare the selected texture
+		bool bIsOverridden = !Node->IsEqual(ParentNode);
+		switch (Node->GetType())
+		{
+		case UHGraphNodeType::FloatNode:
+			Override.Value.x = static_cast<UHFloatNode*>(Node)->GetValue();
+			break;
+		case UHGraphNodeType::Float2Node:
+		{
+			const UHVector2 Val = static_cast<UHFloat2Node*>(Node)->GetValue();
+			Override.Value = UHVector4(Val.x, Val.y, 0.0f, 0.0f);
+			break;
+		}
+		case UHGraphNodeType::Float3Node:
+		{
+			const UHVector3 Val = static_cast<UHFloat3Node*>(Node)->GetValue();
+			Override.Value = UHVector4(Val.x, Val.y, Val.z, 0.0f);
+			break;
+		}
+		case UHGraphNodeType::Float4Node:
+			Override.Value = static_cast<UHFloat4Node*>(Node)->GetValue();
+			break;
+		case UHGraphNodeType::Texture2DNode:
+			Override.TexturePathName = static_cast<UHTexture2DNode*>(Node)->GetSelectedTexturePathName();
+			bIsOverridden = Override.TexturePathName != static_cast<const UHTexture2DNode*>(ParentNode)->GetSelectedTexturePathName();
+			break;
+		default:
+			bIsOverridden = false;
+			break;
+		}
+
+		if (bIsOverridden)
+		{
+			Overrides.push_back(Override);
+		}
+	}
+}
+
 void UHMaterial::ExportGraphData(std::ofstream& FileOut)
 {
 	// export graph data, format as follow
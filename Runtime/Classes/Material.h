@@ -14,6 +14,7 @@ enum class UHMaterialVersion : uint32_t
 	GoingBindless,
 	AddRoughnessTexture,
 	AddReflectionBounce,
+	AddMaterialInstance,
 	MaterialVersionMax
 };
 
@@ -70,13 +71,28 @@ struct UHRTMaterialData
 	uint32_t Data[GMaxRTMaterialDataSlot];
 };
 
+// parameter or texture override of a material instance, the node is looked up by index in parent's edit nodes
+struct UHMaterialOverride
+{
+	UHMaterialOverride()
+		: NodeIndex(UHINDEXNONE)
+		, NodeType(UHGraphNodeType::UnknownNode)
+		, Value(UHVector4())
+	{
+	}
+
+	int32_t NodeIndex;
+	UHGraphNodeType NodeType;
+	UHVector4 Value;
+	std::string TexturePathName;
+};
+
 // UH Engine's material class, each instance is unique
 class UHMaterial : public UHRenderResource, public UHRenderState
 {
 public:
 	STATIC_CLASS_ID(35123443)
 	UHMaterial();
-	~UHMaterial();
 
 	bool Import(std::filesystem::path InMatPath);
 	void ImportGraphData(std::ifstream& FileIn);
@@ -85,9 +101,10 @@ public:
 	void SetName(std::string InName);
 	void SetCompileFlag(UHMaterialCompileFlag InFlag);
 	void SetRegisteredTextureIndexes(std::vector<int32_t> InData);
-	void AllocateMaterialBuffer();
-	void AllocateRTMaterialBuffer();
-	void UploadMaterialData(int32_t CurrFrame);
+
+	// fill the parameter blocks on CPU, the version is increased when the content changed
+	// the GPU copy lives in the material arena of the renderer
+	void UpdateMaterialData();
 	void UpdateMaterialUsage();
 
 	std::string GetName() const;
@@ -102,9 +119,24 @@ public:
 
 	static bool IsDifferentBlendGroup(UHMaterial* InA, UHMaterial* InB);
 
+	// material instance functions, an instance clones the graph of its parent and overrides parameters and textures only
+	// so it can share the compiled shaders, graphic states and hit groups of the parent
+	bool SetParentMaterial(UHMaterial* InParent);
+	bool IsMaterialInstance() const;
+	UHMaterial* GetParentMaterial() const;
+	UHMaterial* GetShaderMaterial();
+	std::string GetParentSourcePath() const;
+	const std::vector<UHMaterial*>& GetMaterialInstances() const;
+
+	// hit group slot in the RT pipeline, instances share the slot with their parent
+	void SetHitGroupIndex(int32_t InIndex);
+	int32_t GetHitGroupIndex() const;
+
 	const std::vector<std::string>& GetRegisteredTextureNames();
-	const std::array<UniquePtr<UHRenderBuffer<uint8_t>>, GMaxFrameInFlight>& GetMaterialConst();
-	UHRenderBuffer<UHRTMaterialData>* GetRTMaterialDataGPU(int32_t CurrFrame) const;
+	const std::vector<uint8_t>& GetMaterialConstantsCPU() const;
+	const UHRTMaterialData& GetRTMaterialDataCPU() const;
+	uint64_t GetMaterialBufferSize() const;
+	uint32_t GetParameterVersion() const;
 
 	bool operator==(const UHMaterial& InMat);
 
@@ -116,6 +148,8 @@ public:
 	void SetTexFileName(UHMaterialInputs TexType, std::string InName);
 	void SetMaterialBufferSize(size_t InSize);
 	void Export(const std::filesystem::path InPath = "");
+	void ExportInstance(const std::string InSourcePath);
+	bool RebuildFromParent();
 	void ExportGraphData(std::ofstream& FileOut);
 	std::string GetCBufferDefineCode(size_t& OutSize);
 	std::string GetMaterialInputCode(UHMaterialCompileData InData);
@@ -137,6 +171,11 @@ public:
 #endif
 
 private:
+	bool CloneParentGraph();
+	void ApplyOverrides();
+#if WITH_EDITOR
+	void CollectOverrides();
+#endif
 
 	std::vector<std::string> RegisteredTextureNames;
 	std::vector<int32_t> RegisteredTextureIndexes;
@@ -161,13 +200,18 @@ private:
 	UHPoint DefaultMaterialNodePos;
 	std::filesystem::path MaterialPath;
 
-	// material constant buffer, the size will be following the result of graph
+	// material constant block, the size will be following the result of graph
 	uint64_t MaterialBufferSize;
 	std::vector<uint8_t> MaterialConstantsCPU;
-	std::array<UniquePtr<UHRenderBuffer<uint8_t>>, GMaxFrameInFlight> MaterialConstantsGPU;
-
 	UHRTMaterialData MaterialRTDataCPU;
-	UniquePtr<UHRenderBuffer<UHRTMaterialData>> MaterialRTDataGPU[GMaxFrameInFlight];
+	uint32_t ParameterVersion;
+
+	// material instance data
+	std::string ParentSourcePath;
+	UHMaterial* ParentMaterial;
+	std::vector<UHMaterial*> MaterialInstances;
+	std::vector<UHMaterialOverride> Overrides;
+	int32_t HitGroupIndex;
 
 #if WITH_EDITOR
 	UHMaterialProperty MaterialProps;
@@ -1,9 +1,182 @@
 #include "Mesh.h"
 #include <fstream>
+#include <glm/gtc/packing.hpp>
 #include "Utility.h"
 #include "../Classes/AssetPath.h"
 #include "../Engine/Graphic.h"
 #include "../CoreGlobals.h"
+#include "DerivedDataCache.h"
+
+// bump when the meshlet building changes
+static constexpr uint32_t GMeshletDerivedDataVersion = 1;
+
+// vertex compression helpers, the decode side must sync with UHMeshShaderCommon.hlsli
+static uint32_t PackSnorm16(float InValue)
+{
+	const float V = std::clamp(InValue, -1.0f, 1.0f);
+	return static_cast<uint32_t>(static_cast<uint16_t>(static_cast<int16_t>(std::round(V * 32767.0f))));
+}
+
+static float UnpackSnorm16(uint32_t InValue)
+{
+	return std::max(static_cast<float>(static_cast<int16_t>(InValue & 0xffff)) / 32767.0f, -1.0f);
+}
+
+static UHVector2 EncodeOctahedral(UHVector3 InDir)
+{
+	const float L1 = std::abs(InDir.x) + std::abs(InDir.y) + std::abs(InDir.z);
+	if (L1 <= 0.0f)
+	{
+		return UHVector2(0.0f, 0.0f);
+	}
+
+	UHVector2 E(InDir.x / L1, InDir.y / L1);
+	if (InDir.z < 0.0f)
+	{
+		// fold the lower hemisphere
+		E = UHVector2((1.0f - std::abs(E.y)) * (E.x >= 0.0f ? 1.0f : -1.0f)
+			, (1.0f - std::abs(E.x)) * (E.y >= 0.0f ? 1.0f : -1.0f));
+	}
+
+	return E;
+}
+
+static UHVector3 DecodeOctahedral(UHVector2 InE)
+{
+	UHVector3 N(InE.x, InE.y, 1.0f - std::abs(InE.x) - std::abs(InE.y));
+	const float T = std::clamp(-N.z, 0.0f, 1.0f);
+	N.x += (N.x >= 0.0f) ? -T : T;
+	N.y += (N.y >= 0.0f) ? -T : T;
+
+	return glm::normalize(N);
+}
+
+// normal: octahedral unorm16 x2
+static uint32_t PackNormal(UHVector3 InNormal)
+{
+	const UHVector2 E = EncodeOctahedral(InNormal) * 0.5f + 0.5f;
+	const uint32_t X = static_cast<uint32_t>(std::round(std::clamp(E.x, 0.0f, 1.0f) * 65535.0f));
+	const uint32_t Y = static_cast<uint32_t>(std::round(std::clamp(E.y, 0.0f, 1.0f) * 65535.0f));
+	return X | (Y << 16);
+}
+
+static UHVector3 UnpackNormal(uint32_t InValue)
+{
+	const UHVector2 E(static_cast<float>(InValue & 0xffff) / 65535.0f, static_cast<float>(InValue >> 16) / 65535.0f);
+	return DecodeOctahedral(E * 2.0f - 1.0f);
+}
+
+// tangent: octahedral unorm15 x2 + sign bit at the highest bit
+static uint32_t PackTangent(UHVector4 InTangent)
+{
+	const UHVector2 E = EncodeOctahedral(UHVector3(InTangent)) * 0.5f + 0.5f;
+	const uint32_t X = static_cast<uint32_t>(std::round(std::clamp(E.x, 0.0f, 1.0f) * 32767.0f));
+	const uint32_t Y = static_cast<uint32_t>(std::round(std::clamp(E.y, 0.0f, 1.0f) * 32767.0f));
+	const uint32_t Sign = (InTangent.w < 0.0f) ? 1u : 0u;
+	return X | (Y << 15) | (Sign << 31);
+}
+
+static UHVector4 UnpackTangent(uint32_t InValue)
+{
+	const UHVector2 E(static_cast<float>(InValue & 0x7fff) / 32767.0f, static_cast<float>((InValue >> 15) & 0x7fff) / 32767.0f);
+	return UHVector4(DecodeOctahedral(E * 2.0f - 1.0f), (InValue >> 31) ? -1.0f : 1.0f);
+}
+
+// positions are quantized relative to the bound center with a uniform scale, so the decode is a similarity transform
+// and can be merged into world matrix without affecting normal transform
+static void GetPositionDecodeRange(const std::vector<UHVector3>& InPositions, UHVector3& OutOffset, float& OutScale)
+{
+	OutOffset = UHVector3(0.0f, 0.0f, 0.0f);
+	OutScale = 1.0f;
+	if (InPositions.size() == 0)
+	{
+		return;
+	}
+
+	UHVector3 MinPoint = InPositions[0];
+	UHVector3 MaxPoint = InPositions[0];
+	for (const UHVector3& P : InPositions)
+	{
+		MinPoint = UHMathHelpers::MinVector(P, MinPoint);
+		MaxPoint = UHMathHelpers::MaxVector(P, MaxPoint);
+	}
+
+	const UHVector3 Extent = (MaxPoint - MinPoint) * 0.5f;
+	OutOffset = (MinPoint + MaxPoint) * 0.5f;
+	OutScale = std::max(Extent.x, std::max(Extent.y, Extent.z));
+	if (!(OutScale > 0.0f) || !std::isfinite(OutScale))
+	{
+		OutScale = 1.0f;
+	}
+}
+
+// calculate bounding sphere and backface cone of a meshlet, positions should be in the vertex stream space
+// the cone culling follows the meshoptimizer convention: cull if dot(Center - Camera, Axis) >= Cutoff * length(Center - Camera) + Radius
+static void CalculateMeshletBounds(UHMeshlet& OutMeshlet, const std::vector<uint32_t>& InVertices, const std::vector<uint32_t>& InPrimitives
+	, const std::vector<UHVector3>& InPositions, const float InWindingSign, const float InRadiusPadding)
+{
+	UHVector3 MinPoint = InPositions[InVertices[OutMeshlet.VertexOffset]];
+	UHVector3 MaxPoint = MinPoint;
+	for (uint32_t Idx = 0; Idx < OutMeshlet.VertexCount; Idx++)
+	{
+		const UHVector3& P = InPositions[InVertices[OutMeshlet.VertexOffset + Idx]];
+		MinPoint = UHMathHelpers::MinVector(P, MinPoint);
+		MaxPoint = UHMathHelpers::MaxVector(P, MaxPoint);
+	}
+
+	OutMeshlet.BoundCenter = (MinPoint + MaxPoint) * 0.5f;
+	OutMeshlet.BoundRadius = 0.0f;
+	for (uint32_t Idx = 0; Idx < OutMeshlet.VertexCount; Idx++)
+	{
+		const UHVector3& P = InPositions[InVertices[OutMeshlet.VertexOffset + Idx]];
+		OutMeshlet.BoundRadius = std::max(OutMeshlet.BoundRadius, glm::length(P - OutMeshlet.BoundCenter));
+	}
+	OutMeshlet.BoundRadius += InRadiusPadding;
+
+	// cone axis is the average of triangle normals, degenerate triangles are skipped as they're never rasterized
+	std::vector<UHVector3> TriangleNormals;
+	TriangleNormals.reserve(OutMeshlet.PrimitiveCount);
+	UHVector3 AxisSum(0.0f, 0.0f, 0.0f);
+	for (uint32_t Idx = 0; Idx < OutMeshlet.PrimitiveCount; Idx++)
+	{
+		const uint32_t Packed = InPrimitives[OutMeshlet.PrimitiveOffset + Idx];
+		const UHVector3& P0 = InPositions[InVertices[OutMeshlet.VertexOffset + (Packed & 0xff)]];
+		const UHVector3& P1 = InPositions[InVertices[OutMeshlet.VertexOffset + ((Packed >> 8) & 0xff)]];
+		const UHVector3& P2 = InPositions[InVertices[OutMeshlet.VertexOffset + ((Packed >> 16) & 0xff)]];
+
+		UHVector3 Normal = glm::cross(P1 - P0, P2 - P0) * InWindingSign;
+		const float Length = glm::length(Normal);
+		if (Length < 1e-12f)
+		{
+			continue;
+		}
+
+		Normal /= Length;
+		TriangleNormals.push_back(Normal);
+		AxisSum += Normal;
+	}
+
+	OutMeshlet.ConeAxis = UHVector3(0.0f, 0.0f, 1.0f);
+	OutMeshlet.ConeCutoff = 1.0f;
+	if (TriangleNormals.size() == 0 || glm::length(AxisSum) < 1e-6f)
+	{
+		return;
+	}
+
+	const UHVector3 Axis = glm::normalize(AxisSum);
+	float MinDot = 1.0f;
+	for (const UHVector3& Normal : TriangleNormals)
+	{
+		MinDot = std::min(MinDot, glm::dot(Axis, Normal));
+	}
+
+	// the cone is useless when normals spread close to the hemisphere
+	if (MinDot > 0.1f)
+	{
+		OutMeshlet.ConeAxis = Axis;
+		OutMeshlet.ConeCutoff = std::sqrt(1.0f - MinDot * MinDot);
+	}
+}
 
 UHMesh::UHMesh()
 	: UHMesh("")
@@ -30,6 +203,9 @@ UHMesh::UHMesh(std::string InName)
 	, bIndexBuffer32Bit(false)
 	, MeshBound(UHBoundingBox())
 	, bHasInitialized(false)
+	, bVertexCompressed(false)
+	, PositionDecodeOffset(UHVector3(0, 0, 0))
+	, PositionDecodeScale(1.0f)
 	, NumMeshlets(0)
 {
 	Name = InName;
@@ -62,10 +238,25 @@ void UHMesh::CreateGPUBuffers(UHGraphic* InGfx)
 
 	UHGPUMemory* SharedMemory = InGfx->GetMeshSharedMemory();
 
-	PositionBuffer = InGfx->RequestRenderBuffer<UHVector3>(VertexCount, VBFlags, Name + "_Position", SharedMemory);
-	UV0Buffer = InGfx->RequestRenderBuffer<UHVector2>(VertexCount, VBFlags, Name + "_UV0", SharedMemory);
-	NormalBuffer = InGfx->RequestRenderBuffer<UHVector3>(VertexCount, VBFlags, Name + "_Normal", SharedMemory);
-	TangentBuffer = InGfx->RequestRenderBuffer<UHVector4>(VertexCount, VBFlags, Name + "_Tangent", SharedMemory);
+	// pack vertex streams, compressed layout is 20 bytes per vertex instead of 48 bytes
+	bVertexCompressed = InGfx->IsVertexCompressionEnabled();
+	PositionDecodeOffset = UHVector3(0, 0, 0);
+	PositionDecodeScale = 1.0f;
+	if (bVertexCompressed)
+	{
+		GetPositionDecodeRange(PositionData, PositionDecodeOffset, PositionDecodeScale);
+	}
+
+	std::vector<uint32_t> PackedPositions;
+	std::vector<uint32_t> PackedUV0s;
+	std::vector<uint32_t> PackedNormals;
+	std::vector<uint32_t> PackedTangents;
+	PackVertexStreams(PackedPositions, PackedUV0s, PackedNormals, PackedTangents);
+
+	PositionBuffer = InGfx->RequestRenderBuffer<uint32_t>(PackedPositions.size(), VBFlags, Name + "_Position", SharedMemory);
+	UV0Buffer = InGfx->RequestRenderBuffer<uint32_t>(PackedUV0s.size(), VBFlags, Name + "_UV0", SharedMemory);
+	NormalBuffer = InGfx->RequestRenderBuffer<uint32_t>(PackedNormals.size(), VBFlags, Name + "_Normal", SharedMemory);
+	TangentBuffer = InGfx->RequestRenderBuffer<uint32_t>(PackedTangents.size(), VBFlags, Name + "_Tangent", SharedMemory);
 
 	// consider 32 or 16 bit index buffer
 	if (bIndexBuffer32Bit)
@@ -98,19 +289,20 @@ void UHMesh::CreateGPUBuffers(UHGraphic* InGfx)
 		return;
 	}
 
-	// upload vb/ib data
-	PositionBuffer->UploadAllDataShared(PositionData.data(), SharedMemory);
-	UV0Buffer->UploadAllDataShared(UV0Data.data(), SharedMemory);
-	NormalBuffer->UploadAllDataShared(NormalData.data(), SharedMemory);
-	TangentBuffer->UploadAllDataShared(TangentData.data(), SharedMemory);
+	// upload vb/ib data via staging ring, the caller should flush the ring before using the buffers
+	UHStagingRing* StagingRing = InGfx->GetStagingRing();
+	StagingRing->UploadBuffer(PositionBuffer.get(), PackedPositions.data());
+	StagingRing->UploadBuffer(UV0Buffer.get(), PackedUV0s.data());
+	StagingRing->UploadBuffer(NormalBuffer.get(), PackedNormals.data());
+	StagingRing->UploadBuffer(TangentBuffer.get(), PackedTangents.data());
 
 	if (bIndexBuffer32Bit)
 	{
-		IndexBuffer->UploadAllDataShared(IndicesData.data(), SharedMemory);
+		StagingRing->UploadBuffer(IndexBuffer.get(), IndicesData.data());
 	}
 	else
 	{
-		IndexBuffer16->UploadAllDataShared(IndicesData16.data(), SharedMemory);
+		StagingRing->UploadBuffer(IndexBuffer16.get(), IndicesData16.data());
 	}
 
 	// create meshlet if MS supported
@@ -122,15 +314,15 @@ void UHMesh::CreateGPUBuffers(UHGraphic* InGfx)
 	bHasInitialized = true;
 }
 
-// create bottom level AS for the mesh
-void UHMesh::CreateBottomLevelAS(UHGraphic* InGfx, VkCommandBuffer InBuffer)
+// create bottom level AS for the mesh, the build is deferred to UHAccelerationStructure::BuildBottomASBatch
+void UHMesh::CreateBottomLevelAS(UHGraphic* InGfx)
 {
 	if (BottomLevelAS == nullptr)
 	{
 		// ensure mesh data is already created
 		CreateGPUBuffers(InGfx);
 		BottomLevelAS = InGfx->RequestAccelerationStructure();
-		BottomLevelAS->CreaetBottomAS(this, InBuffer);
+		BottomLevelAS->CreaetBottomAS(this);
 	}
 }
 
@@ -175,6 +367,9 @@ void UHMesh::Release()
 	UH_SAFE_RELEASE(MeshletBuffer);
 	MeshletBuffer.reset();
 
+	UH_SAFE_RELEASE(MeshletDataBuffer);
+	MeshletDataBuffer.reset();
+
 	// in case re-init is needed.
 	bHasInitialized = false;
 }
@@ -247,6 +442,29 @@ bool UHMesh::IsIndexBufer32Bit() const
 	return bIndexBuffer32Bit;
 }
 
+bool UHMesh::IsVertexCompressed() const
+{
+	return bVertexCompressed;
+}
+
+uint32_t UHMesh::GetPositionStride() const
+{
+	// snorm16 x4 or float3
+	return bVertexCompressed ? sizeof(uint32_t) * 2 : sizeof(UHVector3);
+}
+
+UHMatrix4x4 UHMesh::GetPositionDecodeMatrix() const
+{
+	if (!bVertexCompressed)
+	{
+		return UHMathHelpers::Identity4x4();
+	}
+
+	const UHMatrix4x4 Decode = UHMathHelpers::UHMatrixTranslation(PositionDecodeOffset)
+		* UHMathHelpers::UHMatrixScaling(UHVector3(PositionDecodeScale, PositionDecodeScale, PositionDecodeScale));
+	return UHMathHelpers::UHMatrixTranspose(Decode);
+}
+
 std::string UHMesh::GetImportedMaterialName() const
 {
 	return ImportedMaterialName;
@@ -277,22 +495,22 @@ UHBoundingBox UHMesh::GetMeshBound() const
 	return MeshBound;
 }
 
-UHRenderBuffer<UHVector3>* UHMesh::GetPositionBuffer() const
+UHRenderBuffer<uint32_t>* UHMesh::GetPositionBuffer() const
 {
 	return PositionBuffer.get();
 }
 
-UHRenderBuffer<UHVector2>* UHMesh::GetUV0Buffer() const
+UHRenderBuffer<uint32_t>* UHMesh::GetUV0Buffer() const
 {
 	return UV0Buffer.get();
 }
 
-UHRenderBuffer<UHVector3>* UHMesh::GetNormalBuffer() const
+UHRenderBuffer<uint32_t>* UHMesh::GetNormalBuffer() const
 {
 	return NormalBuffer.get();
 }
 
-UHRenderBuffer<UHVector4>* UHMesh::GetTangentBuffer() const
+UHRenderBuffer<uint32_t>* UHMesh::GetTangentBuffer() const
 {
 	return TangentBuffer.get();
 }
@@ -302,6 +520,11 @@ UHRenderBuffer<UHMeshlet>* UHMesh::GetMeshletBuffer() const
 	return MeshletBuffer.get();
 }
 
+UHRenderBuffer<uint32_t>* UHMesh::GetMeshletDataBuffer() const
+{
+	return MeshletDataBuffer.get();
+}
+
 UHRenderBuffer<uint32_t>* UHMesh::GetIndexBuffer() const
 {
 	return IndexBuffer.get();
@@ -340,6 +563,52 @@ void UHMesh::RecalculateMeshBound()
 	MeshBound = UHBoundingBox(MeshCenter, MeshExtent);
 }
 
+// measure the error of compressed vertex layout against the source data
+UHVertexCompressionError UHMesh::CalculateCompressionError() const
+{
+	UHVertexCompressionError Error;
+
+	UHVector3 DecodeOffset;
+	float DecodeScale;
+	GetPositionDecodeRange(PositionData, DecodeOffset, DecodeScale);
+
+	for (size_t Idx = 0; Idx < PositionData.size(); Idx++)
+	{
+		const UHVector3& P = PositionData[Idx];
+		const UHVector3 Q = (P - DecodeOffset) / DecodeScale;
+		const UHVector3 Decoded = UHVector3(UnpackSnorm16(PackSnorm16(Q.x)), UnpackSnorm16(PackSnorm16(Q.y)), UnpackSnorm16(PackSnorm16(Q.z)))
+			* DecodeScale + DecodeOffset;
+		Error.MaxPositionError = std::max(Error.MaxPositionError, glm::length(Decoded - P));
+	}
+
+	for (const UHVector2& UV : UV0Data)
+	{
+		const UHVector2 Decoded = glm::unpackHalf2x16(glm::packHalf2x16(UV));
+		Error.MaxUV0Error = std::max(Error.MaxUV0Error, std::max(std::abs(Decoded.x - UV.x), std::abs(Decoded.y - UV.y)));
+	}
+
+	for (const UHVector3& N : NormalData)
+	{
+		if (glm::length(N) > 0.0f)
+		{
+			const float CosAngle = std::clamp(glm::dot(glm::normalize(N), UnpackNormal(PackNormal(N))), -1.0f, 1.0f);
+			Error.MaxNormalError = std::max(Error.MaxNormalError, glm::degrees(std::acos(CosAngle)));
+		}
+	}
+
+	for (const UHVector4& T : TangentData)
+	{
+		const UHVector3 Dir = UHVector3(T);
+		if (glm::length(Dir) > 0.0f)
+		{
+			const float CosAngle = std::clamp(glm::dot(glm::normalize(Dir), UHVector3(UnpackTangent(PackTangent(T)))), -1.0f, 1.0f);
+			Error.MaxTangentError = std::max(Error.MaxTangentError, glm::degrees(std::acos(CosAngle)));
+		}
+	}
+
+	return Error;
+}
+
 // function for importing UHAsset
 bool UHMesh::Import(std::filesystem::path InUHMeshPath)
 {
@@ -483,6 +752,16 @@ void UHMesh::Export(std::filesystem::path OutputFolder, bool bOverwrite)
 	VertexCount = static_cast<uint32_t>(PositionData.size());
 	IndiceCount = static_cast<uint32_t>(IndicesData.size());
 }
+
+void UHMesh::ReportCompressionError() const
+{
+	const UHVertexCompressionError Error = CalculateCompressionError();
+	const UHVector3 Extent = MeshBound.Extents;
+
+	UHE_LOG("Vertex compression error of " + Name + ": position " + std::to_string(Error.MaxPositionError)
+		+ " (bound extent " + std::to_string(std::max(Extent.x, std::max(Extent.y, Extent.z))) + "), UV0 " + std::to_string(Error.MaxUV0Error)
+		+ ", normal " + std::to_string(Error.MaxNormalError) + " deg, tangent " + std::to_string(Error.MaxTangentError) + " deg.\n");
+}
 #endif
 
 bool UHMesh::operator==(const UHMesh& InMesh)
@@ -524,31 +803,180 @@ void UHMesh::CheckAndConvertToIndices16()
 	}
 }
 
+void UHMesh::PackVertexStreams(std::vector<uint32_t>& OutPositions, std::vector<uint32_t>& OutUV0s
+	, std::vector<uint32_t>& OutNormals, std::vector<uint32_t>& OutTangents) const
+{
+	if (!bVertexCompressed)
+	{
+		// full float layout, simply copy the data as words
+		OutPositions.resize(VertexCount * 3);
+		OutUV0s.resize(VertexCount * 2);
+		OutNormals.resize(VertexCount * 3);
+		OutTangents.resize(VertexCount * 4);
+
+		memcpy(OutPositions.data(), PositionData.data(), VertexCount * sizeof(UHVector3));
+		memcpy(OutUV0s.data(), UV0Data.data(), VertexCount * sizeof(UHVector2));
+		memcpy(OutNormals.data(), NormalData.data(), VertexCount * sizeof(UHVector3));
+		memcpy(OutTangents.data(), TangentData.data(), VertexCount * sizeof(UHVector4));
+		return;
+	}
+
+	// compressed layout
+	// position: snorm16 x4 relative to the decode range, the 4th component is unused
+	// UV0: half2, normal: octahedral unorm16 x2, tangent: octahedral unorm15 x2 + sign bit
+	OutPositions.resize(VertexCount * 2);
+	OutUV0s.resize(VertexCount);
+	OutNormals.resize(VertexCount);
+	OutTangents.resize(VertexCount);
+
+	for (uint32_t Idx = 0; Idx < VertexCount; Idx++)
+	{
+		const UHVector3 Q = (PositionData[Idx] - PositionDecodeOffset) / PositionDecodeScale;
+		OutPositions[Idx * 2] = PackSnorm16(Q.x) | (PackSnorm16(Q.y) << 16);
+		OutPositions[Idx * 2 + 1] = PackSnorm16(Q.z);
+
+		OutUV0s[Idx] = glm::packHalf2x16(UV0Data[Idx]);
+		OutNormals[Idx] = PackNormal(NormalData[Idx]);
+		OutTangents[Idx] = PackTangent(TangentData[Idx]);
+	}
+}
+
 void UHMesh::CreateMeshlets(UHGraphic* InGfx)
 {
-	// calculate number of meshlets by indices count and round up
-	NumMeshlets = UHMathHelpers::RoundUpDivide(IndiceCount, MaxVertexPerMeshlet);
+	// split triangles in order, each meshlet holds up to MaxPrimitivePerMeshlet triangles
+	// and the unique vertices referenced by them, so the local triangle indices always fit in 8 bits
+	static_assert(MaxVertexPerMeshlet <= 256, "Meshlet local indices are packed as 8-bit.");
+
+	const uint32_t PrimitiveCount = IndiceCount / 3;
+	NumMeshlets = UHMathHelpers::RoundUpDivide(PrimitiveCount, MaxPrimitivePerMeshlet);
+
+	// meshlets only depend on the geometry, so they're kept in the derived data cache instead of being rebuilt at every load
+	std::vector<uint32_t> MeshletVertices;
+	std::string DerivedDataKey;
+	if (GDerivedDataCache.IsEnabled())
+	{
+		UHContentHasher Hasher;
+		Hasher.UpdateVector(IndicesData);
+		Hasher.UpdateVector(PositionData);
+		Hasher.UpdateVector(NormalData);
+		Hasher.UpdateValue(bVertexCompressed);
+		Hasher.UpdateValue(PositionDecodeOffset);
+		Hasher.UpdateValue(PositionDecodeScale);
+		Hasher.UpdateValue(MaxVertexPerMeshlet);
+		Hasher.UpdateValue(MaxPrimitivePerMeshlet);
+		DerivedDataKey = UHDerivedDataCache::MakeKey("Meshlet", GMeshletDerivedDataVersion, Hasher.GetHash());
+
+		std::vector<uint8_t> DerivedData;
+		size_t Offset = 0;
+		if (GDerivedDataCache.Get(DerivedDataKey, DerivedData)
+			&& UHDerivedDataCache::ReadVector(DerivedData, Offset, MeshletsData)
+			&& UHDerivedDataCache::ReadVector(DerivedData, Offset, MeshletVertices)
+			&& MeshletsData.size() == NumMeshlets)
+		{
+			UploadMeshlets(InGfx, MeshletVertices);
+			return;
+		}
+	}
+
+	MeshletsData.clear();
+	MeshletsData.resize(NumMeshlets);
+	MeshletVertices.clear();
+
+	std::vector<uint32_t> MeshletPrimitives;
+	MeshletVertices.reserve(IndiceCount);
+	MeshletPrimitives.reserve(PrimitiveCount);
 
-	int32_t LocalIndiceCount = IndiceCount;
 	for (uint32_t Idx = 0; Idx < NumMeshlets; Idx++)
 	{
-		UHMeshlet Meshlet{};
+		UHMeshlet& Meshlet = MeshletsData[Idx];
+		Meshlet.VertexOffset = static_cast<uint32_t>(MeshletVertices.size());
+		Meshlet.PrimitiveOffset = static_cast<uint32_t>(MeshletPrimitives.size());
 
-		// set vertex count as max indice count
-		// in the mesh shader, it will map to the corresponding vertex data
-		Meshlet.VertexCount = std::min(MaxVertexPerMeshlet, (uint32_t)LocalIndiceCount);
-		Meshlet.VertexOffset = Idx > 0 ? MeshletsData[Idx - 1].VertexCount + MeshletsData[Idx - 1].VertexOffset : 0;
-		Meshlet.PrimitiveCount = Meshlet.VertexCount / 3;
+		const uint32_t FirstPrim = Idx * MaxPrimitivePerMeshlet;
+		const uint32_t LastPrim = std::min(FirstPrim + MaxPrimitivePerMeshlet, PrimitiveCount);
+		for (uint32_t PrimIdx = FirstPrim; PrimIdx < LastPrim; PrimIdx++)
+		{
+			uint32_t PackedPrim = 0;
+			for (uint32_t CornerIdx = 0; CornerIdx < 3; CornerIdx++)
+			{
+				// find or add the vertex in this meshlet
+				const uint32_t VertexIndex = IndicesData[PrimIdx * 3 + CornerIdx];
+				uint32_t LocalIndex = 0;
+				while (LocalIndex < Meshlet.VertexCount && MeshletVertices[Meshlet.VertexOffset + LocalIndex] != VertexIndex)
+				{
+					LocalIndex++;
+				}
+
+				if (LocalIndex == Meshlet.VertexCount)
+				{
+					MeshletVertices.push_back(VertexIndex);
+					Meshlet.VertexCount++;
+				}
+
+				PackedPrim |= LocalIndex << (CornerIdx * 8);
+			}
+
+			MeshletPrimitives.push_back(PackedPrim);
+			Meshlet.PrimitiveCount++;
+		}
+	}
 
-		MeshletsData.push_back(Meshlet);
+	// bounds are calculated in the vertex stream space, so they share the same world matrix as vertices
+	std::vector<UHVector3> StreamPositions(PositionData.size());
+	for (size_t Idx = 0; Idx < PositionData.size(); Idx++)
+	{
+		StreamPositions[Idx] = (PositionData[Idx] - PositionDecodeOffset) / PositionDecodeScale;
+	}
 
-		LocalIndiceCount -= Meshlet.VertexCount;
-		if (LocalIndiceCount <= 0)
+	// find out the winding that matches the authored normals, the vote is mesh-wide since the rasterizer culls by winding
+	float WindingSign = 1.0f;
+	if (NormalData.size() == PositionData.size())
+	{
+		int32_t WindingVote = 0;
+		for (uint32_t PrimIdx = 0; PrimIdx < PrimitiveCount; PrimIdx++)
 		{
-			break;
+			const uint32_t I0 = IndicesData[PrimIdx * 3];
+			const uint32_t I1 = IndicesData[PrimIdx * 3 + 1];
+			const uint32_t I2 = IndicesData[PrimIdx * 3 + 2];
+			const UHVector3 FaceNormal = glm::cross(PositionData[I1] - PositionData[I0], PositionData[I2] - PositionData[I0]);
+			WindingVote += (glm::dot(FaceNormal, NormalData[I0] + NormalData[I1] + NormalData[I2]) >= 0.0f) ? 1 : -1;
 		}
+		WindingSign = (WindingVote >= 0) ? 1.0f : -1.0f;
 	}
 
-	MeshletBuffer = InGfx->RequestRenderBuffer<UHMeshlet>(MeshletsData.size(), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, Name + "_Meshlet");
-	MeshletBuffer->UploadAllData(MeshletsData.data());
+	// pad the radius with the quantization error if vertex compression is used
+	const float RadiusPadding = bVertexCompressed ? 1.0f / 32767.0f : 0.0f;
+	for (UHMeshlet& Meshlet : MeshletsData)
+	{
+		CalculateMeshletBounds(Meshlet, MeshletVertices, MeshletPrimitives, StreamPositions, WindingSign, RadiusPadding);
+	}
+
+	// primitives are stored after vertices in the same buffer
+	const uint32_t PrimitiveBase = static_cast<uint32_t>(MeshletVertices.size());
+	for (UHMeshlet& Meshlet : MeshletsData)
+	{
+		Meshlet.PrimitiveOffset += PrimitiveBase;
+	}
+	MeshletVertices.insert(MeshletVertices.end(), MeshletPrimitives.begin(), MeshletPrimitives.end());
+
+	if (GDerivedDataCache.IsEnabled())
+	{
+		std::vector<uint8_t> DerivedData;
+		UHDerivedDataCache::WriteVector(DerivedData, MeshletsData);
+		UHDerivedDataCache::WriteVector(DerivedData, MeshletVertices);
+		GDerivedDataCache.Put(DerivedDataKey, DerivedData);
+	}
+
+	UploadMeshlets(InGfx, MeshletVertices);
+}
+
+void UHMesh::UploadMeshlets(UHGraphic* InGfx, const std::vector<uint32_t>& InMeshletData)
+{
+	MeshletBuffer = InGfx->RequestRenderBuffer<UHMeshlet>(MeshletsData.size(), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, Name + "_Meshlet"
+		, InGfx->GetMeshSharedMemory());
+	InGfx->GetStagingRing()->UploadBuffer(MeshletBuffer.get(), MeshletsData.data());
+
+	MeshletDataBuffer = InGfx->RequestRenderBuffer<uint32_t>(InMeshletData.size(), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, Name + "_MeshletData"
+		, InGfx->GetMeshSharedMemory());
+	InGfx->GetStagingRing()->UploadBuffer(MeshletDataBuffer.get(), InMeshletData.data());
 }
\ No newline at end of file
@@ -17,7 +17,9 @@ enum class UHMeshVersion : uint32_t
 
 class UHGraphic;
 
-// Meshlet structure, for now it simply stores the vert/prim count and offset
+// Meshlet structure, it stores the vert/prim count and offset in the meshlet data buffer
+// the meshlet data buffer holds unique vertex indices of meshlets first, then the local triangles packed as 3x8-bit
+// bounding sphere and backface cone are used for culling in amplification shader, they're in the vertex stream space
 struct UHMeshlet
 {
 public:
@@ -25,6 +27,11 @@ public:
 		: VertexCount(0)
 		, VertexOffset(0)
 		, PrimitiveCount(0)
+		, PrimitiveOffset(0)
+		, BoundCenter(UHVector3(0, 0, 0))
+		, BoundRadius(0.0f)
+		, ConeAxis(UHVector3(0, 0, 1))
+		, ConeCutoff(1.0f)
 	{
 
 	}
@@ -32,6 +39,30 @@ public:
 	uint32_t VertexCount;
 	uint32_t VertexOffset;
 	uint32_t PrimitiveCount;
+	uint32_t PrimitiveOffset;
+	UHVector3 BoundCenter;
+	float BoundRadius;
+	UHVector3 ConeAxis;
+	// sine of the cone spread angle, 1 means the cone can't be used for culling
+	float ConeCutoff;
+};
+
+// max errors introduced by vertex compression, position error is in mesh space unit and normal/tangent error is in degree
+struct UHVertexCompressionError
+{
+	UHVertexCompressionError()
+		: MaxPositionError(0.0f)
+		, MaxUV0Error(0.0f)
+		, MaxNormalError(0.0f)
+		, MaxTangentError(0.0f)
+	{
+
+	}
+
+	float MaxPositionError;
+	float MaxUV0Error;
+	float MaxNormalError;
+	float MaxTangentError;
 };
 
 // Mesh class of unheard engine
@@ -41,7 +72,7 @@ public:
 	UHMesh();
 	UHMesh(std::string InName);
 	void CreateGPUBuffers(UHGraphic* InGfx);
-	void CreateBottomLevelAS(UHGraphic* InGfx, VkCommandBuffer InBuffer);
+	void CreateBottomLevelAS(UHGraphic* InGfx);
 	void ReleaseCPUMeshData();
 	void Release();
 
@@ -60,6 +91,12 @@ public:
 	uint32_t GetIndicesCount() const;
 	uint32_t GetMeshletCount() const;
 	bool IsIndexBufer32Bit() const;
+	bool IsVertexCompressed() const;
+	uint32_t GetPositionStride() const;
+
+	// matrix that converts stored positions back to mesh space, identity when vertex isn't compressed
+	// it's in the same convention as world matrix, so Decode * World is the final object to world transform
+	UHMatrix4x4 GetPositionDecodeMatrix() const;
 
 	std::string GetImportedMaterialName() const;
 	UHVector3 GetImportedTranslation() const;
@@ -68,11 +105,13 @@ public:
 	UHVector3 GetMeshCenter() const;
 	UHBoundingBox GetMeshBound() const;
 
-	UHRenderBuffer<UHVector3>* GetPositionBuffer() const;
-	UHRenderBuffer<UHVector2>* GetUV0Buffer() const;
-	UHRenderBuffer<UHVector3>* GetNormalBuffer() const;
-	UHRenderBuffer<UHVector4>* GetTangentBuffer() const;
+	// vertex streams are stored as 32-bit words, the layout depends on IsVertexCompressed()
+	UHRenderBuffer<uint32_t>* GetPositionBuffer() const;
+	UHRenderBuffer<uint32_t>* GetUV0Buffer() const;
+	UHRenderBuffer<uint32_t>* GetNormalBuffer() const;
+	UHRenderBuffer<uint32_t>* GetTangentBuffer() const;
 	UHRenderBuffer<UHMeshlet>* GetMeshletBuffer() const;
+	UHRenderBuffer<uint32_t>* GetMeshletDataBuffer() const;
 
 	UHRenderBuffer<uint32_t>* GetIndexBuffer() const;
 	UHRenderBuffer<uint16_t>* GetIndexBuffer16() const;
@@ -81,12 +120,14 @@ public:
 
 	void RecalculateMeshBound();
 	bool Import(std::filesystem::path InUHMeshPath);
+	UHVertexCompressionError CalculateCompressionError() const;
 
 #if WITH_EDITOR
 	void SetImportedTransform(UHVector3 InTranslation, UHVector3 InRotation, UHVector3 InScale);
 	void SetImportedMaterialName(std::string InName);
 	void SetSourcePath(const std::string InPath);
 	void Export(std::filesystem::path OutputFolder, bool bOverwrite = true);
+	void ReportCompressionError() const;
 #endif
 
 	bool operator==(const UHMesh& InMesh);
@@ -98,7 +139,10 @@ public:
 
 private:
 	void CheckAndConvertToIndices16();
+	void PackVertexStreams(std::vector<uint32_t>& OutPositions, std::vector<uint32_t>& OutUV0s
+		, std::vector<uint32_t>& OutNormals, std::vector<uint32_t>& OutTangents) const;
 	void CreateMeshlets(UHGraphic* InGfx);
+	void UploadMeshlets(UHGraphic* InGfx, const std::vector<uint32_t>& InMeshletData);
 
 	std::string ImportedMaterialName;
 	UHVector3 ImportedTranslation;
@@ -121,11 +165,16 @@ private:
 	bool bIndexBuffer32Bit;
 	bool bHasInitialized;
 
+	// vertex compression, positions are stored as snorm16 relative to decode offset and uniform decode scale
+	bool bVertexCompressed;
+	UHVector3 PositionDecodeOffset;
+	float PositionDecodeScale;
+
 	// GPU VB/IB buffer
-	UniquePtr<UHRenderBuffer<UHVector3>> PositionBuffer;
-	UniquePtr<UHRenderBuffer<UHVector2>> UV0Buffer;
-	UniquePtr<UHRenderBuffer<UHVector3>> NormalBuffer;
-	UniquePtr<UHRenderBuffer<UHVector4>> TangentBuffer;
+	UniquePtr<UHRenderBuffer<uint32_t>> PositionBuffer;
+	UniquePtr<UHRenderBuffer<uint32_t>> UV0Buffer;
+	UniquePtr<UHRenderBuffer<uint32_t>> NormalBuffer;
+	UniquePtr<UHRenderBuffer<uint32_t>> TangentBuffer;
 
 	UniquePtr<UHRenderBuffer<uint32_t>> IndexBuffer;
 	UniquePtr<UHRenderBuffer<uint16_t>> IndexBuffer16;
@@ -137,4 +186,5 @@ private:
 	uint32_t NumMeshlets;
 	std::vector<UHMeshlet> MeshletsData;
 	UniquePtr<UHRenderBuffer<UHMeshlet>> MeshletBuffer;
+	UniquePtr<UHRenderBuffer<uint32_t>> MeshletDataBuffer;
 };
\ No newline at end of file
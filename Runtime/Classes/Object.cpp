@@ -4,24 +4,15 @@
 #include "../../UnheardEngine.h"
 
 UHObject::UHObject()
+	: Handle(UHOBJECTHANDLENONE)
+	, ClassDenseIndex(UHINDEXNONE)
 {
-	static uint32_t UniqueID = 0;
-	RuntimeId = UniqueID++;
+	RuntimeId = GObjectRegistry.AllocateId();
+	Handle = GObjectRegistry.Register(this);
+	assert(Handle != UHOBJECTHANDLENONE);
 
-	assert(GObjectTable.find(GetId()) == GObjectTable.end());
-	GObjectTable[GetId()] = this;
 	Name = ENGINE_NAME_NONE;
-
-#if _WIN32
-	UUID TempGuid;
-	UuidCreate(&TempGuid);
-	UHMEMCOPY(RuntimeGuid.data(), &TempGuid, sizeof(TempGuid));
-#elif __linux__
-	uuid_t TempGuid;
-	uuid_generate(TempGuid);
-	UHMEMCOPY(RuntimeGuid.data(), TempGuid, sizeof(TempGuid));
-#endif
-	
+	RuntimeGuid = UHMintGuid();
 	Version = 0;
 	ObjectClassIdInternal = 0;
 }
@@ -42,25 +33,18 @@ void UHObject::OnLoad(std::ifstream& InStream)
 
 UHObject::~UHObject()
 {
-	assert(("Dangling happened, please check the callstack and correct the problematic UObject\n", GObjectTable.find(GetId()) != GObjectTable.end()));
-	GObjectTable.erase(GetId());
+	assert(("Dangling happened, please check the callstack and correct the problematic UObject\n", GObjectRegistry.Find(Handle) == this));
+	GObjectRegistry.Unregister(this);
 }
 
 void UHObject::AddReferenceObject(UHObject* InObj)
 {
-	if (!UHUtilities::FindByElement(GObjectReferences[GetId()], InObj->GetId()))
-	{
-		GObjectReferences[GetId()].push_back(InObj->GetId());
-	}
+	GObjectRegistry.AddReference(this, InObj);
 }
 
 void UHObject::RemoveReferenceObject(UHObject* InObj)
 {
-	const int32_t RemoveIdx = UHUtilities::FindIndex(GObjectReferences[GetId()], InObj->GetId());
-	if (RemoveIdx != UHINDEXNONE)
-	{
-		UHUtilities::RemoveByIndex(GObjectReferences[GetId()], RemoveIdx);
-	}
+	GObjectRegistry.RemoveReference(this, InObj);
 }
 
 void UHObject::SetName(std::string InName)
@@ -70,29 +54,8 @@ void UHObject::SetName(std::string InName)
 
 std::vector<UHObject*> UHObject::GetReferenceObjects() const
 {
-	std::vector<UHObject*> References;
-
-	// if the object has any references
-	uint32_t ObjId = GetId();
-	if (GObjectReferences.find(ObjId) != GObjectReferences.end())
-	{
-		for (int32_t Idx = static_cast<int32_t>(GObjectReferences[ObjId].size()) - 1; Idx >= 0; Idx--)
-		{
-			uint32_t TargetId = GObjectReferences[ObjId][Idx];
-
-			// collect references if target is still existed
-			if (GObjectTable.find(TargetId) != GObjectTable.end())
-			{
-				References.push_back(GObjectTable[TargetId]);
-			}
-			else
-			{
-				UHUtilities::RemoveByIndex(GObjectReferences[ObjId], Idx);
-			}
-		}
-	}
-
-	return References;
+	// collect references if targets are still existed
+	return GObjectRegistry.GetReferences(this);
 }
 
 uint32_t UHObject::GetId() const
@@ -100,6 +63,18 @@ uint32_t UHObject::GetId() const
 	return RuntimeId;
 }
 
+UHObjectHandle UHObject::GetHandle() const
+{
+	return Handle;
+}
+
+void UHObject::SetObjectClassId(uint32_t InClassId)
+{
+	GObjectRegistry.RemoveFromClass(this, ObjectClassIdInternal);
+	ObjectClassIdInternal = InClassId;
+	GObjectRegistry.AddToClass(this, InClassId);
+}
+
 UHGUID UHObject::GetRuntimeGuid() const
 {
 	return RuntimeGuid;
@@ -4,14 +4,7 @@
 #include <unordered_map>
 #include <string>
 #include <array>
-
-// platform-based UUID
-using UHGUID = std::array<std::uint8_t, 16>;
-#if _WIN32
-#include <Rpc.h>
-#elif __linux__
-#include <uuid/uuid.h>
-#endif
+#include "ObjectRegistry.h"
 
 // UH base object define
 class UHAssetManager;
@@ -30,6 +23,7 @@ public:
 
 	std::vector<UHObject*> GetReferenceObjects() const;
 	uint32_t GetId() const;
+	UHObjectHandle GetHandle() const;
 	UHGUID GetRuntimeGuid() const;
 	std::string GetName() const;
 	uint32_t GetObjectClassId() const;
@@ -37,6 +31,9 @@ public:
 	bool operator==(const UHObject& InObj);
 
 protected:
+	// final classes set their class id with this, which also adds the object to the dense array of the class
+	void SetObjectClassId(uint32_t InClassId);
+
 	// runtime GUID, this will always be generated when an object is created
 	UHGUID RuntimeGuid;
 	std::string Name;
@@ -47,28 +44,44 @@ protected:
 
 	// runtime id used for general purpose
 	uint32_t RuntimeId;
-};
 
-// global table for managing object references
-inline std::unordered_map<uint32_t, UHObject*> GObjectTable;
-inline std::unordered_map<uint32_t, std::vector<uint32_t>> GObjectReferences;
+private:
+	friend class UHObjectRegistry;
+	UHObjectHandle Handle;
+	int32_t ClassDenseIndex;
+};
 
-// safe get object from the table
+// safe get object from the registry
 template <typename T>
 inline T* SafeGetObjectFromTable(uint32_t Id)
 {
-	if (GObjectTable.find(Id) == GObjectTable.end())
+	return static_cast<T*>(GObjectRegistry.FindById(Id));
+}
+
+template <typename T>
+inline T* SafeGetObjectFromHandle(UHObjectHandle InHandle)
+{
+	return static_cast<T*>(GObjectRegistry.Find(InHandle));
+}
+
+// typed iteration over the dense array of a final class
+template <typename T>
+inline std::vector<T*> GetObjectsOfClass()
+{
+	std::vector<T*> OutObjects;
+	for (UHObject* Obj : GObjectRegistry.GetObjectsOfClass(T::ClassId))
 	{
-		return nullptr;
+		OutObjects.push_back(static_cast<T*>(Obj));
 	}
 
-	return static_cast<T*>(GObjectTable[Id]);
+	return OutObjects;
 }
 
 template <typename T>
 inline T* CastObject(UHObject* InObj)
 {
-	if (InObj->GetObjectClassId() == T::ClassId)
+	// null input is allowed, e.g. an asset lookup that fails outside the editor
+	if (InObj != nullptr && InObj->GetObjectClassId() == T::ClassId)
 	{
 		return static_cast<T*>(InObj);
 	}
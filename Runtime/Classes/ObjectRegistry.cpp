@@ -0,0 +1,347 @@
+#include "ObjectRegistry.h"
+#include "Object.h"
+#include <random>
+#include <thread>
+#include "../../UnheardEngine.h"
+
+UHGUID UHMintGuid()
+{
+	// seed once per thread instead of asking the OS for every object
+	static thread_local std::mt19937_64 Generator = []()
+	{
+		std::random_device Device;
+		std::seed_seq Seed{ Device(), Device(), Device(), Device(), Device(), Device(), Device(), Device() };
+		return std::mt19937_64(Seed);
+	}();
+
+	const uint64_t Value[2] = { Generator(), Generator() };
+	UHGUID Guid;
+	UHMEMCOPY(Guid.data(), Value, sizeof(Value));
+
+	// version 4 and RFC 4122 variant
+	Guid[6] = (Guid[6] & 0x0f) | 0x40;
+	Guid[8] = (Guid[8] & 0x3f) | 0x80;
+
+	return Guid;
+}
+
+UHObjectRegistry::UHObjectRegistry()
+	: NextId(0)
+	, NextShard(0)
+	, ObjectCount(0)
+	, IdPages{}
+{
+
+}
+
+UHObjectRegistry::~UHObjectRegistry()
+{
+	for (UHObjectShard& Shard : Shards)
+	{
+		for (std::atomic<UHObjectSlot*>& Page : Shard.Pages)
+		{
+			delete[] Page.load();
+		}
+	}
+
+	for (std::atomic<std::atomic<UHObjectHandle>*>& Page : IdPages)
+	{
+		delete[] Page.load();
+	}
+}
+
+uint32_t UHObjectRegistry::AllocateId()
+{
+	return NextId.fetch_add(1, std::memory_order_relaxed);
+}
+
+UHObjectHandle UHObjectRegistry::Register(UHObject* InObj)
+{
+	const uint32_t ShardIdx = GetThreadShard();
+	UHObjectShard& Shard = Shards[ShardIdx];
+
+	uint32_t LocalIndex = 0;
+	UHObjectSlot* Slot = nullptr;
+	{
+		std::lock_guard<std::mutex> Lock(Shard.SlotLock);
+		if (Shard.FreeSlots.size() > 0)
+		{
+			LocalIndex = Shard.FreeSlots.back();
+			Shard.FreeSlots.pop_back();
+		}
+		else
+		{
+			LocalIndex = Shard.NumSlots;
+			const uint32_t PageIdx = LocalIndex / SlotsPerPage;
+			if (PageIdx >= MaxPagesPerShard)
+			{
+				UHE_LOG("Object registry is full!\n");
+				return UHOBJECTHANDLENONE;
+			}
+
+			if (Shard.Pages[PageIdx].load(std::memory_order_relaxed) == nullptr)
+			{
+				Shard.Pages[PageIdx].store(new UHObjectSlot[SlotsPerPage], std::memory_order_release);
+			}
+			Shard.NumSlots++;
+		}
+
+		Slot = &Shard.Pages[LocalIndex / SlotsPerPage].load(std::memory_order_relaxed)[LocalIndex % SlotsPerPage];
+		Slot->Object.store(InObj, std::memory_order_release);
+	}
+
+	const uint32_t SlotIndex = (LocalIndex << ShardBits) | ShardIdx;
+	const UHObjectHandle Handle = (static_cast<UHObjectHandle>(Slot->Generation.load(std::memory_order_relaxed)) << 32) | SlotIndex;
+
+	if (std::atomic<UHObjectHandle>* IdEntry = GetIdEntry(InObj->GetId(), true))
+	{
+		IdEntry->store(Handle, std::memory_order_release);
+	}
+	ObjectCount.fetch_add(1, std::memory_order_relaxed);
+
+	return Handle;
+}
+
+void UHObjectRegistry::Unregister(UHObject* InObj)
+{
+	if (InObj->Handle == UHOBJECTHANDLENONE)
+	{
+		return;
+	}
+
+	RemoveFromClass(InObj, InObj->GetObjectClassId());
+
+	if (std::atomic<UHObjectHandle>* IdEntry = GetIdEntry(InObj->GetId(), false))
+	{
+		IdEntry->store(UHOBJECTHANDLENONE, std::memory_order_release);
+	}
+
+	const uint32_t SlotIndex = static_cast<uint32_t>(InObj->Handle);
+	UHObjectShard& Shard = Shards[SlotIndex & (NumShards - 1)];
+	{
+		std::lock_guard<std::mutex> Lock(Shard.SlotLock);
+		UHObjectSlot* Slot = GetSlot(SlotIndex);
+		Slot->Object.store(nullptr, std::memory_order_release);
+
+		// bump the generation so the old handles are rejected, 0 is skipped to keep handles non-zero
+		uint32_t Generation = Slot->Generation.load(std::memory_order_relaxed) + 1;
+		Slot->Generation.store(Generation == 0 ? 1 : Generation, std::memory_order_release);
+		Shard.FreeSlots.push_back(SlotIndex >> ShardBits);
+	}
+
+	// the references owned by this object
+	UHObjectShard& RefShard = Shards[InObj->GetId() & (NumShards - 1)];
+	{
+		std::lock_guard<std::mutex> Lock(RefShard.ReferenceLock);
+		RefShard.References.erase(InObj->GetId());
+	}
+
+	InObj->Handle = UHOBJECTHANDLENONE;
+	ObjectCount.fetch_sub(1, std::memory_order_relaxed);
+}
+
+UHObject* UHObjectRegistry::Find(UHObjectHandle InHandle) const
+{
+	if (InHandle == UHOBJECTHANDLENONE)
+	{
+		return nullptr;
+	}
+
+	const UHObjectSlot* Slot = GetSlot(static_cast<uint32_t>(InHandle));
+	if (Slot == nullptr)
+	{
+		return nullptr;
+	}
+
+	// check the generation after reading the object too, in case the slot is reused in between
+	const uint32_t Generation = static_cast<uint32_t>(InHandle >> 32);
+	if (Slot->Generation.load(std::memory_order_acquire) != Generation)
+	{
+		return nullptr;
+	}
+
+	UHObject* Obj = Slot->Object.load(std::memory_order_acquire);
+	if (Slot->Generation.load(std::memory_order_acquire) != Generation)
+	{
+		return nullptr;
+	}
+
+	return Obj;
+}
+
+UHObject* UHObjectRegistry::FindById(uint32_t InId) const
+{
+	const std::atomic<UHObjectHandle>* IdEntry = GetIdEntry(InId, false);
+	if (IdEntry == nullptr)
+	{
+		return nullptr;
+	}
+
+	return Find(IdEntry->load(std::memory_order_acquire));
+}
+
+uint32_t UHObjectRegistry::GetObjectCount() const
+{
+	return ObjectCount.load(std::memory_order_relaxed);
+}
+
+void UHObjectRegistry::AddToClass(UHObject* InObj, uint32_t InClassId)
+{
+	std::lock_guard<std::mutex> Lock(ClassLock);
+	std::vector<UHObject*>& Objects = ClassObjects[InClassId];
+	InObj->ClassDenseIndex = static_cast<int32_t>(Objects.size());
+	Objects.push_back(InObj);
+}
+
+void UHObjectRegistry::RemoveFromClass(UHObject* InObj, uint32_t InClassId)
+{
+	if (InObj->ClassDenseIndex == UHINDEXNONE)
+	{
+		return;
+	}
+
+	std::lock_guard<std::mutex> Lock(ClassLock);
+	std::vector<UHObject*>& Objects = ClassObjects[InClassId];
+
+	// swap with the last one and fix its index
+	UHObject* Last = Objects.back();
+	Objects[InObj->ClassDenseIndex] = Last;
+	Last->ClassDenseIndex = InObj->ClassDenseIndex;
+	Objects.pop_back();
+	InObj->ClassDenseIndex = UHINDEXNONE;
+}
+
+std::vector<UHObject*> UHObjectRegistry::GetObjectsOfClass(uint32_t InClassId) const
+{
+	std::lock_guard<std::mutex> Lock(ClassLock);
+	const auto Iter = ClassObjects.find(InClassId);
+	if (Iter == ClassObjects.end())
+	{
+		return std::vector<UHObject*>();
+	}
+
+	return Iter->second;
+}
+
+void UHObjectRegistry::AddReference(const UHObject* InOwner, const UHObject* InTarget)
+{
+	UHObjectShard& Shard = Shards[InOwner->GetId() & (NumShards - 1)];
+	std::lock_guard<std::mutex> Lock(Shard.ReferenceLock);
+
+	UHReferenceList& List = Shard.References[InOwner->GetId()];
+	if (List.TargetIndices.find(InTarget->GetId()) == List.TargetIndices.end())
+	{
+		List.TargetIndices[InTarget->GetId()] = static_cast<uint32_t>(List.Targets.size());
+		List.Targets.push_back({ InTarget->GetId(), InTarget->GetHandle() });
+	}
+}
+
+void UHObjectRegistry::RemoveReference(const UHObject* InOwner, const UHObject* InTarget)
+{
+	UHObjectShard& Shard = Shards[InOwner->GetId() & (NumShards - 1)];
+	std::lock_guard<std::mutex> Lock(Shard.ReferenceLock);
+
+	const auto ListIter = Shard.References.find(InOwner->GetId());
+	if (ListIter == Shard.References.end())
+	{
+		return;
+	}
+
+	UHReferenceList& List = ListIter->second;
+	const auto IndexIter = List.TargetIndices.find(InTarget->GetId());
+	if (IndexIter == List.TargetIndices.end())
+	{
+		return;
+	}
+
+	// swap with the last target and fix its index
+	const uint32_t RemoveIdx = IndexIter->second;
+	List.TargetIndices.erase(IndexIter);
+	if (RemoveIdx + 1 < List.Targets.size())
+	{
+		List.Targets[RemoveIdx] = List.Targets.back();
+		List.TargetIndices[List.Targets[RemoveIdx].first] = RemoveIdx;
+	}
+	List.Targets.pop_back();
+}
+
+std::vector<UHObject*> UHObjectRegistry::GetReferences(const UHObject* InOwner)
+{
+	std::vector<UHObject*> References;
+
+	UHObjectShard& Shard = Shards[InOwner->GetId() & (NumShards - 1)];
+	std::lock_guard<std::mutex> Lock(Shard.ReferenceLock);
+
+	const auto ListIter = Shard.References.find(InOwner->GetId());
+	if (ListIter == Shard.References.end())
+	{
+		return References;
+	}
+
+	// collect the references in reverse order and prune dead targets on the fly
+	UHReferenceList& List = ListIter->second;
+	bool bHasDeadTarget = false;
+	for (int32_t Idx = static_cast<int32_t>(List.Targets.size()) - 1; Idx >= 0; Idx--)
+	{
+		if (UHObject* Target = Find(List.Targets[Idx].second))
+		{
+			References.push_back(Target);
+		}
+		else
+		{
+			bHasDeadTarget = true;
+		}
+	}
+
+	if (bHasDeadTarget)
+	{
+		// rebuild the list with alive targets only, keep the original order
+		List.Targets.clear();
+		List.TargetIndices.clear();
+		for (int32_t Idx = static_cast<int32_t>(References.size()) - 1; Idx >= 0; Idx--)
+		{
+			List.TargetIndices[References[Idx]->GetId()] = static_cast<uint32_t>(List.Targets.size());
+			List.Targets.push_back({ References[Idx]->GetId(), References[Idx]->GetHandle() });
+		}
+	}
+
+	return References;
+}
+
+UHObjectRegistry::UHObjectSlot* UHObjectRegistry::GetSlot(uint32_t InSlotIndex) const
+{
+	const uint32_t LocalIndex = InSlotIndex >> ShardBits;
+	const uint32_t PageIdx = LocalIndex / SlotsPerPage;
+	if (PageIdx >= MaxPagesPerShard)
+	{
+		return nullptr;
+	}
+
+	UHObjectSlot* Page = Shards[InSlotIndex & (NumShards - 1)].Pages[PageIdx].load(std::memory_order_acquire);
+	return Page ? &Page[LocalIndex % SlotsPerPage] : nullptr;
+}
+
+std::atomic<UHObjectHandle>* UHObjectRegistry::GetIdEntry(uint32_t InId, bool bCreate) const
+{
+	const uint32_t PageIdx = InId >> IdPageBits;
+	std::atomic<UHObjectHandle>* Page = IdPages[PageIdx].load(std::memory_order_acquire);
+	if (Page == nullptr && bCreate)
+	{
+		std::lock_guard<std::mutex> Lock(IdPageLock);
+		Page = IdPages[PageIdx].load(std::memory_order_relaxed);
+		if (Page == nullptr)
+		{
+			Page = new std::atomic<UHObjectHandle>[IdsPerPage]();
+			IdPages[PageIdx].store(Page, std::memory_order_release);
+		}
+	}
+
+	return Page ? &Page[InId & (IdsPerPage - 1)] : nullptr;
+}
+
+uint32_t UHObjectRegistry::GetThreadShard()
+{
+	// threads are spread over the shards round-robin at their first object creation
+	static thread_local uint32_t ThreadShard = NextShard.fetch_add(1, std::memory_order_relaxed) & (NumShards - 1);
+	return ThreadShard;
+}
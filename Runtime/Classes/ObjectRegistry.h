@@ -0,0 +1,100 @@
+#pragma once
+#include <cstdint>
+#include <array>
+#include <atomic>
+#include <mutex>
+#include <vector>
+#include <unordered_map>
+
+class UHObject;
+using UHGUID = std::array<std::uint8_t, 16>;
+
+// generational object handle, generation in the high 32 bits and slot index in the low 32 bits
+// a handle goes stale once its object is destroyed, even if the slot is reused by another object
+using UHObjectHandle = uint64_t;
+inline constexpr UHObjectHandle UHOBJECTHANDLENONE = 0;
+
+// mint a random version 4 GUID from a per-thread generator, it's seeded once per thread from the OS entropy
+UHGUID UHMintGuid();
+
+// UH object registry, objects can be created and destroyed from any thread
+// slots are sharded by the creating thread and each shard has its own lock for add/remove
+// lookups are lock-free, slot pages are never moved or freed until shutdown and generations reject stale handles
+// objects are also kept in per-class dense arrays for typed iteration
+class UHObjectRegistry
+{
+public:
+	UHObjectRegistry();
+	~UHObjectRegistry();
+
+	// runtime ids are never reused, they're still used as keys of various caches
+	uint32_t AllocateId();
+	UHObjectHandle Register(UHObject* InObj);
+	void Unregister(UHObject* InObj);
+
+	UHObject* Find(UHObjectHandle InHandle) const;
+	UHObject* FindById(uint32_t InId) const;
+	uint32_t GetObjectCount() const;
+
+	// typed iteration, the class id is set by the constructor of final classes
+	void AddToClass(UHObject* InObj, uint32_t InClassId);
+	void RemoveFromClass(UHObject* InObj, uint32_t InClassId);
+	std::vector<UHObject*> GetObjectsOfClass(uint32_t InClassId) const;
+
+	// object references, O(1) add/remove and dead targets are pruned when they're collected
+	void AddReference(const UHObject* InOwner, const UHObject* InTarget);
+	void RemoveReference(const UHObject* InOwner, const UHObject* InTarget);
+	std::vector<UHObject*> GetReferences(const UHObject* InOwner);
+
+private:
+	static constexpr uint32_t ShardBits = 4;
+	static constexpr uint32_t NumShards = 1u << ShardBits;
+	static constexpr uint32_t SlotsPerPage = 1024;
+	static constexpr uint32_t MaxPagesPerShard = 1024;
+	static constexpr uint32_t IdPageBits = 16;
+	static constexpr uint32_t IdsPerPage = 1u << IdPageBits;
+	static constexpr uint32_t MaxIdPages = 1u << (32 - IdPageBits);
+
+	struct UHObjectSlot
+	{
+		std::atomic<UHObject*> Object{ nullptr };
+		std::atomic<uint32_t> Generation{ 1 };
+	};
+
+	// target ids and handles with their index in the list, removal swaps with the last one
+	struct UHReferenceList
+	{
+		std::vector<std::pair<uint32_t, UHObjectHandle>> Targets;
+		std::unordered_map<uint32_t, uint32_t> TargetIndices;
+	};
+
+	struct UHObjectShard
+	{
+		std::mutex SlotLock;
+		std::array<std::atomic<UHObjectSlot*>, MaxPagesPerShard> Pages{};
+		uint32_t NumSlots = 0;
+		std::vector<uint32_t> FreeSlots;
+
+		// references are sharded by the owner id
+		std::mutex ReferenceLock;
+		std::unordered_map<uint32_t, UHReferenceList> References;
+	};
+
+	UHObjectSlot* GetSlot(uint32_t InSlotIndex) const;
+	std::atomic<UHObjectHandle>* GetIdEntry(uint32_t InId, bool bCreate) const;
+	uint32_t GetThreadShard();
+
+	std::array<UHObjectShard, NumShards> Shards;
+	std::atomic<uint32_t> NextId;
+	std::atomic<uint32_t> NextShard;
+	std::atomic<uint32_t> ObjectCount;
+
+	// id to handle table, ids are never reused so the table is append-only
+	mutable std::array<std::atomic<std::atomic<UHObjectHandle>*>, MaxIdPages> IdPages;
+	mutable std::mutex IdPageLock;
+
+	std::unordered_map<uint32_t, std::vector<UHObject*>> ClassObjects;
+	mutable std::mutex ClassLock;
+};
+
+inline UHObjectRegistry GObjectRegistry;
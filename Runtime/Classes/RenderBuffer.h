@@ -116,6 +116,7 @@ public:
         return true;
 	}
 
+    // create a static buffer in shared device memory, the data is filled by UHStagingRing instead of mapping
     bool CreateBuffer(uint64_t InElementCount, VkBufferUsageFlags InUsage, UHGPUMemory* SharedMemory)
     {
         // skip creaetion if it's empty
@@ -132,9 +133,19 @@ public:
         VkBufferCreateInfo bufferInfo{};
         bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
         bufferInfo.size = BufferSize;
-        bufferInfo.usage = InUsage;
+        bufferInfo.usage = InUsage | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
         bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
 
+        // share between graphics, transfer and async compute queue if they're different families
+        // this saves the queue ownership transfer, static buffers are written once anyway
+        const std::vector<uint32_t>& QueueFamilies = GetStagingQueueFamilies();
+        if (QueueFamilies.size() > 1)
+        {
+            bufferInfo.sharingMode = VK_SHARING_MODE_CONCURRENT;
+            bufferInfo.queueFamilyIndexCount = static_cast<uint32_t>(QueueFamilies.size());
+            bufferInfo.pQueueFamilyIndices = QueueFamilies.data();
+        }
+
         if (vkCreateBuffer(LogicalDevice, &bufferInfo, nullptr, &BufferSource) != VK_SUCCESS)
         {
             UHE_LOG("Failed to create buffer!\n");
@@ -155,10 +166,11 @@ public:
 
         if (bExceedSharedMemory)
         {
+            // fallback to the same memory type as the shared memory, so it's still device local
             VkMemoryAllocateInfo AllocInfo{};
             AllocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
             AllocInfo.allocationSize = MemRequirements.size;
-            AllocInfo.memoryTypeIndex = GetHostMemoryTypeIndex();
+            AllocInfo.memoryTypeIndex = SharedMemory->GetMemoryTypeIndex();
 
             VkMemoryAllocateFlagsInfo MemFlagInfo{};
             MemFlagInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_FLAGS_INFO;
@@ -219,25 +231,6 @@ public:
 		vkUnmapMemory(LogicalDevice, BufferMemory);
 	}
 
-    // upload all data, but it's copying to shared memory
-    void UploadAllDataShared(void* SrcData, UHGPUMemory* InMemory)
-    {
-        if (OffsetInSharedMemory == ~0)
-        {
-            // shared memory didn't allocate an address for this buffer (might be used up)
-            // fallback to regular upload
-            if (BufferMemory != nullptr)
-            {
-                UploadAllData(SrcData);
-            }
-            return;
-        }
-
-        vkMapMemory(LogicalDevice, InMemory->GetMemory(), OffsetInSharedMemory, BufferSize, 0, reinterpret_cast<void**>(&DstData));
-        UHMEMCOPY(&DstData[0], SrcData, BufferSize);
-        vkUnmapMemory(LogicalDevice, InMemory->GetMemory());
-    }
-
     // upload data with individual offset, similar to upload all but copy a buffer stride instead
     void UploadData(void* SrcData, int64_t DstOffset, size_t InCopySize = 0)
     {
@@ -295,6 +288,21 @@ public:
         return OutputData;
     }
 
+    // readback to an existing vector, so frequent readbacks can reuse the allocation
+    void ReadbackData(std::vector<T>& OutData)
+    {
+        OutData.resize(BufferSize / BufferStride);
+        if (bIsUploadBuffer)
+        {
+            UHMEMCOPY(OutData.data(), &DstData[0], BufferSize);
+            return;
+        }
+
+        vkMapMemory(LogicalDevice, BufferMemory, 0, BufferSize, 0, reinterpret_cast<void**>(&DstData));
+        UHMEMCOPY(OutData.data(), &DstData[0], BufferSize);
+        vkUnmapMemory(LogicalDevice, BufferMemory);
+    }
+
 private:
 	VkBuffer BufferSource;
 	VkDeviceMemory BufferMemory;
@@ -109,8 +109,13 @@ std::vector<uint8_t> UHRenderTexture::ReadbackTextureData()
 }
 #endif
 
-// create image based on format and extent info
-bool UHRenderTexture::CreateRT()
+bool UHRenderTexture::IsSharedAcrossQueues() const
+{
+	return RenderTextureSettings.bIsSharedAcrossQueues && !GetComputeQueueFamilies().empty();
+}
+
+// texture info based on format and extent info
+UHTextureInfo UHRenderTexture::GetRTInfo()
 {
 	TextureSettings.bUseMipmap = RenderTextureSettings.bUseMipmap;
 
@@ -122,6 +127,7 @@ bool UHRenderTexture::CreateRT()
 
 	UHTextureInfo Info(VK_IMAGE_TYPE_2D, VK_IMAGE_VIEW_TYPE_2D, ImageFormat, ImageExtent, Usage, true);
 	Info.Type = RenderTextureSettings.bIsVolume ? VK_IMAGE_TYPE_3D : Info.Type;
+	Info.bIsSharedAcrossQueues = IsSharedAcrossQueues();
 
 	// texture array setup
 	if (NumSlices > 1)
@@ -129,6 +135,20 @@ bool UHRenderTexture::CreateRT()
 		Info.ViewType = RenderTextureSettings.bIsVolume ? VK_IMAGE_VIEW_TYPE_3D : VK_IMAGE_VIEW_TYPE_2D_ARRAY;
 	}
 
-	// UHE doesn't use shared memory for RTs at the momment, since they could resize
-	return Create(Info, nullptr);
+	return Info;
+}
+
+// create image based on format and extent info
+bool UHRenderTexture::CreateRT()
+{
+	UHTextureInfo Info = GetRTInfo();
+
+	// RTs are allocated individually since they could resize, unless a shared memory is given for aliasing
+	Info.ReboundOffset = RenderTextureSettings.MemoryOffset;
+	return Create(Info, RenderTextureSettings.SharedMemory);
+}
+
+VkMemoryRequirements UHRenderTexture::GetRTMemoryRequirements()
+{
+	return GetMemoryRequirements(GetRTInfo());
 }
\ No newline at end of file
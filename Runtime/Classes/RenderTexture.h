@@ -10,7 +10,10 @@ struct UHRenderTextureSettings
 		, bUseMipmap(false)
 		, NumSlices(1)
 		, bIsVolume(false)
+		, bIsSharedAcrossQueues(false)
 		, OverrideTexture(nullptr)
+		, SharedMemory(nullptr)
+		, MemoryOffset(~0)
 	{
 	}
 
@@ -18,7 +21,14 @@ struct UHRenderTextureSettings
 	bool bUseMipmap;
 	uint32_t NumSlices;
 	bool bIsVolume;
+
+	// use concurrent sharing between graphic and async compute queue
+	bool bIsSharedAcrossQueues;
 	VkImage OverrideTexture;
+
+	// place the RT at the given offset of a shared memory, e.g. transient RTs aliased by render graph
+	UHGPUMemory* SharedMemory;
+	uint64_t MemoryOffset;
 };
 
 class UHGraphic;
@@ -34,9 +44,13 @@ public:
 	virtual std::vector<uint8_t> ReadbackTextureData() override;
 #endif
 
+	bool IsSharedAcrossQueues() const;
+
 private:
 	// create RT
 	bool CreateRT();
+	UHTextureInfo GetRTInfo();
+	VkMemoryRequirements GetRTMemoryRequirements();
 
 	UHRenderTextureSettings RenderTextureSettings;
 
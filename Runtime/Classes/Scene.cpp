@@ -4,6 +4,7 @@
 #include "../Engine/Config.h"
 #include "Runtime/Platform/PlatformInput.h"
 #include "../Engine/GameTimer.h"
+#include "../Engine/TraceProfiler.h"
 #include "../Engine/Engine.h"
 #include "../Components/GameScript.h"
 
@@ -135,7 +136,7 @@ void UHScene::Release()
 
 void UHScene::Update()
 {
-	UHGameTimerScope Scope("SceneUpdate", false);
+	UH_TRACE_SCOPE("SceneUpdate");
 	UpdateCamera();
 
 	// collect dirty transform components and update them
@@ -481,6 +482,22 @@ const UHBoundingBox& UHScene::GetSceneBound() const
 	return SceneBound;
 }
 
+// set temporal stuffs, jitter is in the pixels of internal resolution and upscaler always needs it
+// the upscaler toggle and ratio can change at runtime, engine also calls this when the render resolution changes
+void UHScene::SyncCameraRenderResolution()
+{
+	if (MainCamera == nullptr)
+	{
+		return;
+	}
+
+	int32_t InternalWidth = 0;
+	int32_t InternalHeight = 0;
+	ConfigCache->GetInternalResolution(InternalWidth, InternalHeight);
+	MainCamera->SetResolution(InternalWidth, InternalHeight);
+	MainCamera->SetUseJitter(ConfigCache->RenderingSetting().bTemporalAA || ConfigCache->RenderingSetting().bEnableTemporalUpscale);
+}
+
 void UHScene::UpdateCamera()
 {
 	if (MainCamera == nullptr)
@@ -488,9 +505,7 @@ void UHScene::UpdateCamera()
 		return;
 	}
 
-	// set temporal stuffs
-	MainCamera->SetResolution(ConfigCache->RenderingSetting().RenderWidth, ConfigCache->RenderingSetting().RenderHeight);
-	MainCamera->SetUseJitter(ConfigCache->RenderingSetting().bTemporalAA);
+	SyncCameraRenderResolution();
 
 	// set aspect ratio of default camera
 	MainCamera->SetAspect(ConfigCache->RenderingSetting().RenderWidth / static_cast<float>(ConfigCache->RenderingSetting().RenderHeight));
@@ -63,6 +63,7 @@ public:
 	const UHBoundingBox& GetSceneBound() const;
 
 	void AddMeshRenderer(UHMeshRendererComponent* InRenderer);
+	void SyncCameraRenderResolution();
 private:
 	void AddDirectionalLight(UHDirectionalLightComponent* InLight);
 	void AddPointLight(UHPointLightComponent* InLight);
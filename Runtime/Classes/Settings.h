@@ -38,6 +38,13 @@ public:
 		, FPSLimit(0.0f)
 		, MeshBufferMemoryBudgetMB(512.0f)
 		, ImageMemoryBudgetMB(1024.0f)
+		, StagingRingSizeMB(64.0f)
+		, bEnableCPUTrace(false)
+		, CPUTraceCaptureFrames(300)
+		, bEnableDerivedDataCache(true)
+		, DerivedDataCacheSizeMB(4096.0f)
+		, DerivedDataRemotePath("")
+		, bDerivedDataRemoteReadOnly(false)
 	{
 
 	}
@@ -53,6 +60,15 @@ public:
 	float FPSLimit;
 	float MeshBufferMemoryBudgetMB;
 	float ImageMemoryBudgetMB;
+	float StagingRingSizeMB;
+	bool bEnableCPUTrace;
+	int32_t CPUTraceCaptureFrames;
+
+	// derived data cache, the remote path can be a shared folder
+	bool bEnableDerivedDataCache;
+	float DerivedDataCacheSizeMB;
+	std::string DerivedDataRemotePath;
+	bool bDerivedDataRemoteReadOnly;
 };
 
 enum class UHRTShadowQuality : uint32_t
@@ -75,11 +91,15 @@ public:
 		: RenderWidth(1920)
 		, RenderHeight(1080)
 		, bTemporalAA(true)
+		, bEnableTemporalUpscale(false)
+		, TemporalUpscaleRatio(0.67f)
 		, bEnableRayTracing(true)
 		, bEnableGPULabeling(false)
 		, bEnableLayerValidation(false)
 		, bEnableGPUTiming(false)
 		, bEnableDepthPrePass(true)
+		, bEnableVertexCompression(false)
+		, bEnableVisibilityBuffer(false)
 		, ParallelSubmitters(8)
 		, RTCullingRadius(100.0f)
 		, RTShadowQuality(UH_ENUM_VALUE(UHRTShadowQuality::RTShadow_Half))
@@ -89,6 +109,8 @@ public:
 		, RTReflectionSmoothCutoff(0.5f)
 		, FinalReflectionStrength(0.25f)
 		, bEnableAsyncCompute(true)
+		, bAsyncRTShadow(true)
+		, bAsyncRTIndirectLight(true)
 		, bEnableHDR(false)
 		, bEnableHardwareOcclusion(true)
 		, OcclusionTriangleThreshold(500)
@@ -100,6 +122,9 @@ public:
 		, PCSSMaxPenumbra(10.0f)
 		, PCSSBlockerDistScale(0.02f)
 		, bDenoiseRayTracing(true)
+		, bEnableRTAdaptiveRays(true)
+		, RTRayBudgetMS(4.0f)
+		, bEnableRTResultCache(true)
 		, SelectedGpuName("")
 		, bEnableRTShadow(true)
 		, bEnableRTReflection(true)
@@ -117,11 +142,18 @@ public:
 	int32_t RenderWidth;
 	int32_t RenderHeight;
 	bool bTemporalAA;
+
+	// scene is rendered at RenderWidth/Height * ratio and reconstructed to RenderWidth/Height, it replaces TAA
+	bool bEnableTemporalUpscale;
+	float TemporalUpscaleRatio;
+
 	bool bEnableRayTracing;
 	bool bEnableGPULabeling;
 	bool bEnableLayerValidation;
 	bool bEnableGPUTiming;
 	bool bEnableDepthPrePass;
+	bool bEnableVertexCompression;
+	bool bEnableVisibilityBuffer;
 	int32_t ParallelSubmitters;
 
 	// common gamma settings
@@ -131,6 +163,14 @@ public:
 	float RTCullingRadius;
 	bool bDenoiseRayTracing;
 
+	// RT shadow, RT reflection and RT indirect light trace rays per screen tile at variable rate
+	// the rate thresholds are adjusted every frame to keep their GPU time within the budget
+	bool bEnableRTAdaptiveRays;
+	float RTRayBudgetMS;
+
+	// RT shadow and RT reflection keep the results of last frame for the unchanged tiles of a static view
+	bool bEnableRTResultCache;
+
 	// RT direct light
 	int32_t RTShadowQuality;
 	float RTShadowTMax;
@@ -152,7 +192,10 @@ public:
 	float MinSkyConeAngle;
 	float IndirectRayAngle;
 
+	// async compute, RT passes can be moved to async compute queue individually
 	bool bEnableAsyncCompute;
+	bool bAsyncRTShadow;
+	bool bAsyncRTIndirectLight;
 	bool bEnableHardwareOcclusion;
 	int32_t OcclusionTriangleThreshold;
 
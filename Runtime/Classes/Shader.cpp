@@ -2,6 +2,14 @@
 #include "../../Runtime/Engine/Graphic.h"
 #include "AssetPath.h"
 
+#if WITH_EDITOR || WITH_COOKER
+#include "DerivedDataCache.h"
+#include <algorithm>
+
+// bump when the compile options change
+static constexpr uint32_t GShaderDerivedDataVersion = 1;
+#endif
+
 UHShader::UHShader(std::string InShaderName, std::filesystem::path InSource, std::string InEntryName, std::string InProfileName
 	, std::vector<std::string> InMacro)
 	: UHShader(InShaderName, InSource, InEntryName, InProfileName, "", InMacro)
@@ -108,4 +116,84 @@ bool UHShader::operator==(const UHShader& InShader)
 		&& InShader.ProfileName == ProfileName
 		&& InShader.SourcePath == SourcePath
 		&& InShader.bIsMaterialShader == bIsMaterialShader;
-}
\ No newline at end of file
+}
+#if WITH_EDITOR || WITH_COOKER
+uint64_t UHShader::HashShaderIncludes()
+{
+	std::vector<std::filesystem::path> Includes;
+	if (std::filesystem::exists(GRawShaderPath))
+	{
+		for (std::filesystem::recursive_directory_iterator Idx(GRawShaderPath), End; Idx != End; Idx++)
+		{
+			if (!std::filesystem::is_directory(Idx->path()) && UHAssetPath::IsTheSameExtension(Idx->path(), ".hlsli"))
+			{
+				Includes.push_back(Idx->path());
+			}
+		}
+	}
+
+	// directory iteration order isn't specified
+	std::sort(Includes.begin(), Includes.end());
+
+	UHContentHasher Hasher;
+	for (const std::filesystem::path& Include : Includes)
+	{
+		Hasher.Update(Include.generic_string());
+		Hasher.UpdateFile(Include);
+	}
+
+	return Hasher.GetHash();
+}
+
+uint64_t UHShader::HashShaderCompiler(const std::filesystem::path& InCompilerPath)
+{
+	UHContentHasher Hasher;
+	if (!Hasher.UpdateFile(InCompilerPath))
+	{
+		// not found, the key still changes with the compiler path
+		Hasher.Update(InCompilerPath.generic_string());
+		return Hasher.GetHash();
+	}
+
+	// dxc is a thin front end, the compiler itself is the dxcompiler library
+	// Windows keeps it next to the exe, the Linux SDK keeps it under lib
+	const std::filesystem::path CompilerFolder = InCompilerPath.parent_path();
+	const std::filesystem::path Libraries[] = { CompilerFolder / "dxcompiler.dll"
+		, CompilerFolder / "libdxcompiler.so"
+		, CompilerFolder.parent_path() / "lib" / "libdxcompiler.so" };
+
+	for (const std::filesystem::path& Library : Libraries)
+	{
+		Hasher.UpdateFile(Library);
+	}
+
+	return Hasher.GetHash();
+}
+
+bool UHShader::HashCompileInputs(const std::filesystem::path& InSourcePath, const std::string& InEntryName, const std::string& InProfileName
+	, const std::vector<std::string>& InDefines, uint64_t InIncludeHash, uint64_t InCompilerHash, uint64_t& OutHash)
+{
+	UHContentHasher Hasher;
+	Hasher.UpdateValue(InIncludeHash);
+	Hasher.UpdateValue(InCompilerHash);
+	if (!Hasher.UpdateFile(InSourcePath))
+	{
+		return false;
+	}
+
+	Hasher.Update(InEntryName);
+	Hasher.Update(InProfileName);
+	for (const std::string& Define : InDefines)
+	{
+		Hasher.Update(Define);
+	}
+
+	OutHash = Hasher.GetHash();
+	return true;
+}
+
+std::string UHShader::MakeDerivedDataKey(uint64_t InHash)
+{
+	return UHDerivedDataCache::MakeKey("SPIRV", GShaderDerivedDataVersion, InHash);
+}
+#endif
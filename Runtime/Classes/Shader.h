@@ -27,6 +27,17 @@ public:
 
 	bool operator==(const UHShader& InShader);
 
+#if WITH_EDITOR || WITH_COOKER
+	// content hash of the compile inputs, it keys the SPIR-V in the derived data cache
+	// every include under the shader folder is hashed as a whole, a change in any of them invalidates all shaders
+	static uint64_t HashShaderIncludes();
+	// a compiler update can change the output of the same inputs, so the compiler binaries are hashed too
+	static uint64_t HashShaderCompiler(const std::filesystem::path& InCompilerPath);
+	static bool HashCompileInputs(const std::filesystem::path& InSourcePath, const std::string& InEntryName, const std::string& InProfileName
+		, const std::vector<std::string>& InDefines, uint64_t InIncludeHash, uint64_t InCompilerHash, uint64_t& OutHash);
+	static std::string MakeDerivedDataKey(uint64_t InHash);
+#endif
+
 private:
 	bool Create(VkShaderModuleCreateInfo InCreateInfo);
 
@@ -0,0 +1,337 @@
+#include "StagingRing.h"
+#include "../Engine/Graphic.h"
+
+UHStagingRing::UHStagingRing()
+	: RingBuffer(nullptr)
+	, RingMemory(nullptr)
+	, MappedData(nullptr)
+	, RingSize(0)
+	, RingHead(0)
+	, RingTail(0)
+	, Queue(nullptr)
+	, CommandPool(nullptr)
+	, TimelineSemaphore(nullptr)
+	, CurrentBatch(0)
+	, SubmittedValue(0)
+	, bIsRecording(false)
+{
+
+}
+
+void UHStagingRing::Release()
+{
+	if (RingMemory != nullptr && MappedData != nullptr)
+	{
+		vkUnmapMemory(LogicalDevice, RingMemory);
+		MappedData = nullptr;
+	}
+
+	SafeDestroyCommandPool(LogicalDevice, CommandPool);
+	SafeDestroyBuffer(LogicalDevice, RingBuffer);
+	SafeFreeMemory(LogicalDevice, RingMemory);
+	SafeDestroySemaphore(LogicalDevice, TimelineSemaphore);
+}
+
+bool UHStagingRing::CreateStagingRing(uint64_t InRingSize, VkQueue InQueue, uint32_t InQueueFamilyIndex)
+{
+	RingSize = InRingSize;
+	Queue = InQueue;
+
+	// ring buffer, it's only accessed by the transfer queue
+	VkBufferCreateInfo BufferInfo{};
+	BufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+	BufferInfo.size = RingSize;
+	BufferInfo.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+	BufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+	if (vkCreateBuffer(LogicalDevice, &BufferInfo, nullptr, &RingBuffer) != VK_SUCCESS)
+	{
+		UHE_LOG("Failed to create staging ring buffer!\n");
+		return false;
+	}
+
+	VkMemoryRequirements MemRequirements;
+	vkGetBufferMemoryRequirements(LogicalDevice, RingBuffer, &MemRequirements);
+
+	VkMemoryAllocateInfo AllocInfo{};
+	AllocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+	AllocInfo.allocationSize = MemRequirements.size;
+	AllocInfo.memoryTypeIndex = GetHostMemoryTypeIndex();
+
+	if (vkAllocateMemory(LogicalDevice, &AllocInfo, nullptr, &RingMemory) != VK_SUCCESS
+		|| vkBindBufferMemory(LogicalDevice, RingBuffer, RingMemory, 0) != VK_SUCCESS)
+	{
+		UHE_LOG("Failed to allocate staging ring memory!\n");
+		return false;
+	}
+
+	// the ring is mapped until destruction, host coherent memory doesn't need flush
+	if (vkMapMemory(LogicalDevice, RingMemory, 0, RingSize, 0, reinterpret_cast<void**>(&MappedData)) != VK_SUCCESS)
+	{
+		UHE_LOG("Failed to map staging ring memory!\n");
+		return false;
+	}
+
+	// command buffers for transfer queue
+	VkCommandPoolCreateInfo PoolInfo{};
+	PoolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+	PoolInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT | VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+	PoolInfo.queueFamilyIndex = InQueueFamilyIndex;
+
+	if (vkCreateCommandPool(LogicalDevice, &PoolInfo, nullptr, &CommandPool) != VK_SUCCESS)
+	{
+		UHE_LOG("Failed to create staging command pool!\n");
+		return false;
+	}
+
+	std::array<VkCommandBuffer, MaxBatchCount> CmdBuffers{};
+	VkCommandBufferAllocateInfo CmdAllocInfo{};
+	CmdAllocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+	CmdAllocInfo.commandPool = CommandPool;
+	CmdAllocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+	CmdAllocInfo.commandBufferCount = MaxBatchCount;
+
+	if (vkAllocateCommandBuffers(LogicalDevice, &CmdAllocInfo, CmdBuffers.data()) != VK_SUCCESS)
+	{
+		UHE_LOG("Failed to allocate staging command buffers!\n");
+		return false;
+	}
+
+	for (uint32_t Idx = 0; Idx < MaxBatchCount; Idx++)
+	{
+		Batches[Idx].CmdBuffer = CmdBuffers[Idx];
+	}
+
+	// timeline semaphore for completion tracking
+	VkSemaphoreTypeCreateInfo TypeInfo{};
+	TypeInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO;
+	TypeInfo.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE;
+	TypeInfo.initialValue = 0;
+
+	VkSemaphoreCreateInfo SemaphoreInfo{};
+	SemaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+	SemaphoreInfo.pNext = &TypeInfo;
+
+	if (vkCreateSemaphore(LogicalDevice, &SemaphoreInfo, nullptr, &TimelineSemaphore) != VK_SUCCESS)
+	{
+		UHE_LOG("Failed to create staging timeline semaphore!\n");
+		return false;
+	}
+
+#if WITH_EDITOR
+	GfxCache->SetDebugUtilsObjectName(VK_OBJECT_TYPE_BUFFER, (uint64_t)RingBuffer, "StagingRingBuffer");
+	GfxCache->SetDebugUtilsObjectName(VK_OBJECT_TYPE_COMMAND_POOL, (uint64_t)CommandPool, "StagingCommandPool");
+	GfxCache->SetDebugUtilsObjectName(VK_OBJECT_TYPE_SEMAPHORE, (uint64_t)TimelineSemaphore, "StagingTimelineSemaphore");
+#endif
+
+	return true;
+}
+
+bool UHStagingRing::UploadBuffer(VkBuffer InDstBuffer, uint64_t InDstOffset, const void* InSrcData, uint64_t InSize)
+{
+	if (InDstBuffer == nullptr || InSrcData == nullptr || InSize == 0 || MappedData == nullptr)
+	{
+		return false;
+	}
+
+	std::lock_guard<std::mutex> Lock(RingLock);
+	const uint8_t* SrcData = reinterpret_cast<const uint8_t*>(InSrcData);
+
+	// split the upload if it's larger than the ring
+	while (InSize > 0)
+	{
+		const uint64_t ChunkSize = (std::min)(InSize, RingSize);
+		const uint64_t RingOffset = Allocate(ChunkSize);
+
+		// allocation might submit the current batch when the ring is full, begin a new one in that case
+		if (!bIsRecording)
+		{
+			BeginBatch();
+		}
+
+		UHMEMCOPY(MappedData + RingOffset, SrcData, ChunkSize);
+
+		VkBufferCopy CopyRegion{};
+		CopyRegion.srcOffset = RingOffset;
+		CopyRegion.dstOffset = InDstOffset;
+		CopyRegion.size = ChunkSize;
+		vkCmdCopyBuffer(Batches[CurrentBatch].CmdBuffer, RingBuffer, InDstBuffer, 1, &CopyRegion);
+
+		SrcData += ChunkSize;
+		InDstOffset += ChunkSize;
+		InSize -= ChunkSize;
+	}
+
+	return true;
+}
+
+uint64_t UHStagingRing::Flush()
+{
+	std::lock_guard<std::mutex> Lock(RingLock);
+	if (bIsRecording)
+	{
+		SubmitBatch();
+	}
+
+	return SubmittedValue;
+}
+
+void UHStagingRing::Wait(uint64_t InValue)
+{
+	if (InValue == 0 || TimelineSemaphore == nullptr)
+	{
+		return;
+	}
+
+	VkSemaphoreWaitInfo WaitInfo{};
+	WaitInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO;
+	WaitInfo.semaphoreCount = 1;
+	WaitInfo.pSemaphores = &TimelineSemaphore;
+	WaitInfo.pValues = &InValue;
+
+	if (vkWaitSemaphores(LogicalDevice, &WaitInfo, UINT64_MAX) != VK_SUCCESS)
+	{
+		UHE_LOG("Failed to wait staging timeline semaphore!\n");
+	}
+}
+
+void UHStagingRing::FlushAndWait()
+{
+	Wait(Flush());
+}
+
+VkSemaphore UHStagingRing::GetTimelineSemaphore() const
+{
+	return TimelineSemaphore;
+}
+
+uint64_t UHStagingRing::GetCompletedValue() const
+{
+	uint64_t CompletedValue = 0;
+	if (TimelineSemaphore != nullptr)
+	{
+		vkGetSemaphoreCounterValue(LogicalDevice, TimelineSemaphore, &CompletedValue);
+	}
+
+	return CompletedValue;
+}
+
+uint64_t UHStagingRing::Allocate(uint64_t InSize)
+{
+	uint64_t Offset = 0;
+	while (true)
+	{
+		// keep 16 bytes alignment, and don't wrap an allocation around the end of ring
+		Offset = (RingHead + 15) & ~15ULL;
+		const uint64_t PhysicalOffset = Offset % RingSize;
+		if (PhysicalOffset + InSize > RingSize)
+		{
+			Offset += RingSize - PhysicalOffset;
+		}
+
+		if (Offset + InSize - RingTail <= RingSize)
+		{
+			break;
+		}
+
+		// ring is full, submit what's recorded and wait for the oldest batch
+		if (bIsRecording)
+		{
+			SubmitBatch();
+		}
+		WaitOldestBatch();
+	}
+
+	RingHead = Offset + InSize;
+	return Offset % RingSize;
+}
+
+void UHStagingRing::BeginBatch()
+{
+	// the batch slot might still be in flight, wait for it before reusing the command buffer
+	UHStagingBatch& Batch = Batches[CurrentBatch];
+	if (Batch.TimelineValue != 0)
+	{
+		Wait(Batch.TimelineValue);
+		RetireBatches();
+	}
+
+	vkResetCommandBuffer(Batch.CmdBuffer, 0);
+
+	VkCommandBufferBeginInfo BeginInfo{};
+	BeginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+	BeginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+	vkBeginCommandBuffer(Batch.CmdBuffer, &BeginInfo);
+
+	bIsRecording = true;
+}
+
+void UHStagingRing::SubmitBatch()
+{
+	UHStagingBatch& Batch = Batches[CurrentBatch];
+	vkEndCommandBuffer(Batch.CmdBuffer);
+
+	const uint64_t SignalValue = SubmittedValue + 1;
+
+	VkTimelineSemaphoreSubmitInfo TimelineInfo{};
+	TimelineInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+	TimelineInfo.signalSemaphoreValueCount = 1;
+	TimelineInfo.pSignalSemaphoreValues = &SignalValue;
+
+	VkSubmitInfo SubmitInfo{};
+	SubmitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+	SubmitInfo.pNext = &TimelineInfo;
+	SubmitInfo.commandBufferCount = 1;
+	SubmitInfo.pCommandBuffers = &Batch.CmdBuffer;
+	SubmitInfo.signalSemaphoreCount = 1;
+	SubmitInfo.pSignalSemaphores = &TimelineSemaphore;
+
+	if (vkQueueSubmit(Queue, 1, &SubmitInfo, nullptr) != VK_SUCCESS)
+	{
+		UHE_LOG("Failed to submit staging copies!\n");
+	}
+
+	SubmittedValue = SignalValue;
+	Batch.TimelineValue = SignalValue;
+	Batch.RingEnd = RingHead;
+
+	CurrentBatch = (CurrentBatch + 1) % MaxBatchCount;
+	bIsRecording = false;
+}
+
+void UHStagingRing::RetireBatches()
+{
+	// batches are submitted in order, so the tail can simply move to the end of the latest completed batch
+	const uint64_t CompletedValue = GetCompletedValue();
+	for (UHStagingBatch& Batch : Batches)
+	{
+		if (Batch.TimelineValue != 0 && Batch.TimelineValue <= CompletedValue)
+		{
+			RingTail = (std::max)(RingTail, Batch.RingEnd);
+			Batch.TimelineValue = 0;
+		}
+	}
+}
+
+void UHStagingRing::WaitOldestBatch()
+{
+	uint64_t OldestValue = UINT64_MAX;
+	for (const UHStagingBatch& Batch : Batches)
+	{
+		if (Batch.TimelineValue != 0)
+		{
+			OldestValue = (std::min)(OldestValue, Batch.TimelineValue);
+		}
+	}
+
+	if (OldestValue == UINT64_MAX)
+	{
+		// nothing in flight and nothing recorded, the whole ring is free
+		RingHead = 0;
+		RingTail = 0;
+		return;
+	}
+
+	Wait(OldestValue);
+	RetireBatches();
+}
@@ -0,0 +1,77 @@
+#pragma once
+#include "../../UnheardEngine.h"
+#include "../Engine/RenderResource.h"
+#include "RenderBuffer.h"
+#include <array>
+#include <mutex>
+
+// UH staging ring for uploading static buffers to device local memory
+// the data is copied to a persistently mapped host ring and the copies are recorded on the transfer queue
+// every submitted batch signals a timeline semaphore value, the ring space of a batch is reclaimed once its value is reached
+class UHStagingRing : public UHRenderResource
+{
+public:
+	static constexpr uint32_t MaxBatchCount = 4;
+
+	UHStagingRing();
+	void Release();
+	bool CreateStagingRing(uint64_t InRingSize, VkQueue InQueue, uint32_t InQueueFamilyIndex);
+
+	// copy data to the ring and record the copy to destination, source data can be released after this call
+	bool UploadBuffer(VkBuffer InDstBuffer, uint64_t InDstOffset, const void* InSrcData, uint64_t InSize);
+
+	template<typename T>
+	bool UploadBuffer(UHRenderBuffer<T>* InDstBuffer, const void* InSrcData)
+	{
+		if (InDstBuffer == nullptr || InDstBuffer->GetBuffer() == nullptr)
+		{
+			return false;
+		}
+
+		return UploadBuffer(InDstBuffer->GetBuffer(), 0, InSrcData, static_cast<uint64_t>(InDstBuffer->GetBufferSize()));
+	}
+
+	// submit the recorded copies and return the timeline value to wait
+	uint64_t Flush();
+
+	// CPU wait until the timeline value is reached
+	void Wait(uint64_t InValue);
+	void FlushAndWait();
+
+	VkSemaphore GetTimelineSemaphore() const;
+	uint64_t GetCompletedValue() const;
+
+private:
+	struct UHStagingBatch
+	{
+		VkCommandBuffer CmdBuffer = nullptr;
+
+		// 0 means the batch isn't in flight
+		uint64_t TimelineValue = 0;
+		uint64_t RingEnd = 0;
+	};
+
+	uint64_t Allocate(uint64_t InSize);
+	void BeginBatch();
+	void SubmitBatch();
+	void RetireBatches();
+	void WaitOldestBatch();
+
+	VkBuffer RingBuffer;
+	VkDeviceMemory RingMemory;
+	uint8_t* MappedData;
+	uint64_t RingSize;
+
+	// virtual offsets that keep increasing, the physical offset is modulo of the ring size
+	uint64_t RingHead;
+	uint64_t RingTail;
+
+	VkQueue Queue;
+	VkCommandPool CommandPool;
+	VkSemaphore TimelineSemaphore;
+	std::array<UHStagingBatch, MaxBatchCount> Batches;
+	uint32_t CurrentBatch;
+	uint64_t SubmittedValue;
+	bool bIsRecording;
+	std::mutex RingLock;
+};
@@ -0,0 +1,36 @@
+#pragma once
+#if WITH_TESTS
+#include <cstdio>
+
+// reporting shared by the CPU checks, only built into the test target
+class UHTestSuite
+{
+public:
+	UHTestSuite(const char* InName)
+		: Name(InName)
+	{
+
+	}
+
+	// prints the failed check and keeps running, so one run reports all failures
+	bool Check(bool bCondition, const char* InTest, const char* InDesc) const
+	{
+		if (!bCondition)
+		{
+			std::printf("[%s] %s failed: %s\n", Name, InTest, InDesc);
+		}
+
+		return bCondition;
+	}
+
+	// prints the summary of a run and passes the result through
+	bool Report(bool bPassed) const
+	{
+		std::printf("[%s] %s\n", Name, bPassed ? "all checks passed" : "some checks failed");
+		return bPassed;
+	}
+
+private:
+	const char* Name;
+};
+#endif
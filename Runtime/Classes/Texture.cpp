@@ -37,7 +37,7 @@ UHTexture::UHTexture(std::string InName, VkExtent2D InExtent, UHTextureFormat In
 	Name = InName;
 }
 
-#if WITH_EDITOR
+#if WITH_EDITOR || WITH_COOKER
 void UHTexture::SetTextureSettings(UHTextureSettings InSetting)
 {
 	TextureSettings = InSetting;
@@ -108,11 +108,90 @@ void UHTexture::SetImageLayout(VkImageLayout InLayout, uint32_t InMipIndex)
 	ImageLayouts[InMipIndex] = InLayout;
 }
 
+uint32_t UHTexture::CalculateMipMapCount() const
+{
+	return TextureSettings.bUseMipmap ? static_cast<uint32_t>(std::floor(std::log2((std::min)(ImageExtent.width, ImageExtent.height)))) + 1 : 1;
+}
+
+// image create info from texture info, shared by image creation and memory requirement query
+VkImageCreateInfo UHTexture::GetImageCreateInfo(const UHTextureInfo& InInfo) const
+{
+	VkImageCreateInfo CreateInfo{};
+	CreateInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+	CreateInfo.imageType = InInfo.Type;
+	CreateInfo.format = GetVulkanFormat(ImageFormat);
+	CreateInfo.extent = VkExtent3D{ ImageExtent.width, ImageExtent.height, static_cast<uint32_t>(1) };
+	CreateInfo.mipLevels = MipMapCount;
+	CreateInfo.arrayLayers = 1;
+	CreateInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+	CreateInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+
+	// cubemap or texture array setup
+	if (InInfo.ViewType == VK_IMAGE_VIEW_TYPE_CUBE)
+	{
+		CreateInfo.arrayLayers = 6;
+		CreateInfo.flags |= VK_IMAGE_CREATE_CUBE_COMPATIBLE_BIT;
+	}
+	else if (InInfo.ViewType == VK_IMAGE_VIEW_TYPE_2D_ARRAY)
+	{
+		CreateInfo.arrayLayers = NumSlices;
+	}
+	else if (InInfo.ViewType == VK_IMAGE_VIEW_TYPE_3D)
+	{
+		CreateInfo.extent.depth = NumSlices;
+	}
+
+	// setup necessary bits
+	CreateInfo.usage = InInfo.Usage;
+	CreateInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+	// textures accessed by both graphic and async compute queue don't need ownership transfer
+	const std::vector<uint32_t>& ComputeFamilies = GetComputeQueueFamilies();
+	if (InInfo.bIsSharedAcrossQueues && ComputeFamilies.size() > 1)
+	{
+		CreateInfo.sharingMode = VK_SHARING_MODE_CONCURRENT;
+		CreateInfo.queueFamilyIndexCount = static_cast<uint32_t>(ComputeFamilies.size());
+		CreateInfo.pQueueFamilyIndices = ComputeFamilies.data();
+	}
+	CreateInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+	// adjust create info if this is a depth texture
+	if (IsDepthFormat())
+	{
+		CreateInfo.usage |= VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT;
+	}
+	else if (InInfo.bIsRT)
+	{
+		CreateInfo.usage |= VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
+	}
+
+	return CreateInfo;
+}
+
+// query the memory requirements without creating an image, this is useful for placing textures in a shared memory in advance
+VkMemoryRequirements UHTexture::GetMemoryRequirements(const UHTextureInfo& InInfo)
+{
+	ImageFormat = InInfo.Format;
+	ImageExtent = InInfo.Extent;
+	MipMapCount = CalculateMipMapCount();
+
+	VkImageCreateInfo CreateInfo = GetImageCreateInfo(InInfo);
+	VkDeviceImageMemoryRequirements ImageMemoryReqs{};
+	ImageMemoryReqs.sType = VK_STRUCTURE_TYPE_DEVICE_IMAGE_MEMORY_REQUIREMENTS;
+	ImageMemoryReqs.pCreateInfo = &CreateInfo;
+
+	VkMemoryRequirements2 MemoryReqs2{};
+	MemoryReqs2.sType = VK_STRUCTURE_TYPE_MEMORY_REQUIREMENTS_2;
+	vkGetDeviceImageMemoryRequirements(LogicalDevice, &ImageMemoryReqs, &MemoryReqs2);
+
+	return MemoryReqs2.memoryRequirements;
+}
+
 bool UHTexture::Create(UHTextureInfo InInfo, UHGPUMemory* InSharedMemory)
 {
 	ImageFormat = InInfo.Format;
 	ImageExtent = InInfo.Extent;
-	MipMapCount = TextureSettings.bUseMipmap ? static_cast<uint32_t>(std::floor(std::log2((std::min)(ImageExtent.width, ImageExtent.height)))) + 1 : 1;
+	MipMapCount = CalculateMipMapCount();
 
 	// init image layout
 	ImageLayouts.resize(MipMapCount);
@@ -121,45 +200,7 @@ bool UHTexture::Create(UHTextureInfo InInfo, UHGPUMemory* InSharedMemory)
 	// only create if the source is null, otherwise create image view only
 	if (ImageSource == nullptr)
 	{
-		VkImageCreateInfo CreateInfo{};
-		CreateInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
-		CreateInfo.imageType = InInfo.Type;
-		CreateInfo.format = GetVulkanFormat(ImageFormat);
-		CreateInfo.extent = VkExtent3D{ ImageExtent.width, ImageExtent.height, static_cast<uint32_t>(1) };
-		CreateInfo.mipLevels = MipMapCount;
-		CreateInfo.arrayLayers = 1;
-		CreateInfo.samples = VK_SAMPLE_COUNT_1_BIT;
-		CreateInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
-
-		// cubemap or texture array setup
-		if (InInfo.ViewType == VK_IMAGE_VIEW_TYPE_CUBE)
-		{
-			CreateInfo.arrayLayers = 6;
-			CreateInfo.flags |= VK_IMAGE_CREATE_CUBE_COMPATIBLE_BIT;
-		}
-		else if (InInfo.ViewType == VK_IMAGE_VIEW_TYPE_2D_ARRAY)
-		{
-			CreateInfo.arrayLayers = NumSlices;
-		}
-		else if (InInfo.ViewType == VK_IMAGE_VIEW_TYPE_3D)
-		{
-			CreateInfo.extent.depth = NumSlices;
-		}
-
-		// setup necessary bits
-		CreateInfo.usage = InInfo.Usage;
-		CreateInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
-		CreateInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-
-		// adjust create info if this is a depth texture
-		if (IsDepthFormat())
-		{
-			CreateInfo.usage |= VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT;
-		}
-		else if (InInfo.bIsRT)
-		{
-			CreateInfo.usage |= VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
-		}
+		VkImageCreateInfo CreateInfo = GetImageCreateInfo(InInfo);
 
 		if (vkCreateImage(LogicalDevice, &CreateInfo, nullptr, &ImageSource) != VK_SUCCESS)
 		{
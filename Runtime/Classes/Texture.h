@@ -10,6 +10,7 @@ enum class UHTextureVersion : uint32_t
 {
 	InitialTexture = 0,
 	OutputImageFormat,
+	BakedCubeLighting,
 	TextureVersionMax
 };
 
@@ -45,6 +46,7 @@ struct UHTextureInfo
 		, Usage(InUsage)
 		, bIsRT(bInIsRT)
 		, bIsShadowRT(false)
+		, bIsSharedAcrossQueues(false)
 		, ReboundOffset(~0)
 	{
 
@@ -57,6 +59,7 @@ struct UHTextureInfo
 	VkImageUsageFlags Usage;
 	bool bIsRT;
 	bool bIsShadowRT;
+	bool bIsSharedAcrossQueues;
 	uint64_t ReboundOffset;
 };
 
@@ -101,7 +104,7 @@ public:
 	virtual void UploadToGPU(UHGraphic* InGfx, UHRenderBuilder& InRenderBuilder) {}
 	virtual void GenerateMipMaps(UHGraphic* InGfx, UHRenderBuilder& InRenderBuilder) {}
 
-#if WITH_EDITOR
+#if WITH_EDITOR || WITH_COOKER
 	virtual std::vector<uint8_t> ReadbackTextureData() { return std::vector<uint8_t>(); }
 	void SetTextureSettings(UHTextureSettings InSetting);
 	void SetSourcePath(std::string InPath);
@@ -159,6 +162,9 @@ public:
 
 protected:
 	bool Create(UHTextureInfo InInfo, UHGPUMemory* InSharedMemory);
+	VkImageCreateInfo GetImageCreateInfo(const UHTextureInfo& InInfo) const;
+	VkMemoryRequirements GetMemoryRequirements(const UHTextureInfo& InInfo);
+	uint32_t CalculateMipMapCount() const;
 	std::string SourcePath;
 	std::string RawSourcePath;
 
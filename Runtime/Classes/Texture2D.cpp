@@ -6,6 +6,14 @@
 #include "../Renderer/RenderBuilder.h"
 #include "TextureCompressor.h"
 
+#if WITH_EDITOR || WITH_COOKER
+#include "DerivedDataCache.h"
+#include "Shader.h"
+
+// bump when mip generation or block compression output changes
+static constexpr uint32_t GTextureDerivedDataVersion = 1;
+#endif
+
 UHTexture2D::UHTexture2D()
 	: UHTexture2D("", "", VkExtent2D(), UHTextureFormat::UH_FORMAT_RGBA8_SRGB, UHTextureSettings())
 {
@@ -85,7 +93,7 @@ bool UHTexture2D::Import(std::filesystem::path InTexturePath)
 	return true;
 }
 
-#if WITH_EDITOR
+#if WITH_EDITOR || WITH_COOKER
 void UHTexture2D::Recreate(bool bNeedGeneratMipmap, const std::vector<uint8_t>& RawData)
 {
 	GfxCache->WaitGPU();
@@ -101,6 +109,47 @@ void UHTexture2D::Recreate(bool bNeedGeneratMipmap, const std::vector<uint8_t>&
 	// 3. Compress if requested
 	TextureSettings.bIsCompressed = false;
 	ImageFormat = UHTextureFormat::UH_FORMAT_NONE;
+
+	// mips and compression are the expensive part, the derived data is keyed by the raw data and everything affecting them
+	const bool bUseDerivedData = GDerivedDataCache.IsEnabled()
+		&& (bNeedGeneratMipmap || TextureSettings.CompressionSetting != UHTextureCompressionSettings::CompressionNone);
+	std::string DerivedDataKey;
+	if (bUseDerivedData)
+	{
+		UHContentHasher Hasher;
+		Hasher.UpdateVector(RawData);
+		Hasher.UpdateValue(ImageExtent.width);
+		Hasher.UpdateValue(ImageExtent.height);
+		Hasher.UpdateValue(TextureSettings.bIsLinear);
+		Hasher.UpdateValue(TextureSettings.bIsNormal);
+		Hasher.UpdateValue(TextureSettings.CompressionSetting);
+		Hasher.UpdateValue(TextureSettings.bIsHDR);
+		Hasher.UpdateValue(TextureSettings.bUseMipmap);
+		Hasher.UpdateValue(bNeedGeneratMipmap);
+		Hasher.UpdateValue(GetCompressorHash());
+		DerivedDataKey = UHDerivedDataCache::MakeKey("Texture2D", GTextureDerivedDataVersion, Hasher.GetHash());
+
+		std::vector<uint8_t> DerivedData;
+		size_t Offset = 0;
+		bool bIsCompressed = false;
+		if (GDerivedDataCache.Get(DerivedDataKey, DerivedData)
+			&& UHDerivedDataCache::ReadValue(DerivedData, Offset, bIsCompressed)
+			&& UHDerivedDataCache::ReadVector(DerivedData, Offset, TextureData))
+		{
+			// the stored data already includes all mips
+			TextureSettings.bIsCompressed = bIsCompressed;
+			CreateTexture(bSharedMemory);
+
+			VkCommandBuffer UploadCmd = GfxCache->BeginOneTimeCmd();
+			UHRenderBuilder UploadBuilder(GfxCache, UploadCmd);
+			UploadToGPU(GfxCache, UploadBuilder);
+			GfxCache->EndOneTimeCmd(UploadCmd);
+
+			bIsMipMapGenerated = true;
+			return;
+		}
+	}
+
 	CreateTexture(bSharedMemory);
 
 	// upload the 1st slice and generate mip map
@@ -190,6 +239,30 @@ void UHTexture2D::Recreate(bool bNeedGeneratMipmap, const std::vector<uint8_t>&
 	{
 		bIsMipMapGenerated = true;
 	}
+
+	if (bUseDerivedData)
+	{
+		std::vector<uint8_t> DerivedData;
+		UHDerivedDataCache::WriteValue(DerivedData, TextureSettings.bIsCompressed);
+		UHDerivedDataCache::WriteVector(DerivedData, TextureData);
+		GDerivedDataCache.Put(DerivedDataKey, DerivedData);
+	}
+}
+
+uint64_t UHTexture2D::GetCompressorHash()
+{
+	// the shader sources don't change while running, hash them once
+	static const uint64_t CompressorHash = []()
+		{
+			UHContentHasher Hasher;
+			Hasher.UpdateValue(GTextureDerivedDataVersion);
+			Hasher.UpdateValue(UHShader::HashShaderIncludes());
+			Hasher.UpdateFile(GRawShaderPath + "BlockCompressionOldShader" + GRawShaderExtension);
+			Hasher.UpdateFile(GRawShaderPath + "BlockCompressionNewShader" + GRawShaderExtension);
+			return Hasher.GetHash();
+		}();
+
+	return CompressorHash;
 }
 
 std::vector<uint8_t> UHTexture2D::ReadbackTextureData()
@@ -209,7 +282,9 @@ std::vector<uint8_t> UHTexture2D::ReadbackTextureData()
 
 		ReadbackBuffer[MipIdx].SetGfxCache(GfxCache);
 		ReadbackBuffer[MipIdx].CreateBuffer(MipSize, VK_IMAGE_USAGE_TRANSFER_DST_BIT);
+#if WITH_EDITOR
 		GfxCache->SetDebugUtilsObjectName(VK_OBJECT_TYPE_BUFFER, (uint64_t)ReadbackBuffer[MipIdx].GetBuffer(), Name + "_StageBuffer");
+#endif
 
 		VkBufferImageCopy Region{};
 		Region.bufferOffset = 0;
@@ -19,10 +19,13 @@ public:
 	bool Import(std::filesystem::path InTexturePath);
 	void SetTextureData(std::vector<uint8_t> InData);
 
-#if WITH_EDITOR
+#if WITH_EDITOR || WITH_COOKER
 	void Recreate(bool bNeedGeneratMipmap, const std::vector<uint8_t>& RawData);
 	virtual std::vector<uint8_t> ReadbackTextureData() override;
 	void Export(std::filesystem::path InTexturePath, bool bOverwrite = true);
+
+	// hash of the mip and compression tools, i.e. the tool version and the block compression shader sources
+	static uint64_t GetCompressorHash();
 #endif
 	const std::vector<uint8_t>& GetTextureData() const;
 
@@ -1,6 +1,6 @@
 #include "TextureCompressor.h"
 
-#if WITH_EDITOR
+#if WITH_EDITOR || WITH_COOKER
 #include <assert.h>
 #include "Types.h"
 #include "Utility.h"
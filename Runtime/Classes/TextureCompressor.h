@@ -1,7 +1,7 @@
 #pragma once
 #include "../../UnheardEngine.h"
 
-#if WITH_EDITOR
+#if WITH_EDITOR || WITH_COOKER
 #include "../Engine/Graphic.h"
 
 namespace UHTextureCompressor
@@ -14,7 +14,7 @@ namespace UHTextureCompressor
 		UHColorBC1()
 			: Indices(0)
 		{
-			memset(Color, 0, sizeof(uint16_t) * ARRAYSIZE(Color));
+			memset(Color, 0, sizeof(uint16_t) * std::size(Color));
 		}
 
 		uint16_t Color[2];
@@ -28,7 +28,7 @@ namespace UHTextureCompressor
 			: Alpha0(0)
 			, Alpha1(0)
 		{
-			memset(AlphaIndices, 0, sizeof(uint8_t) * ARRAYSIZE(AlphaIndices));
+			memset(AlphaIndices, 0, sizeof(uint8_t) * std::size(AlphaIndices));
 		}
 
 		uint8_t Alpha0;
@@ -11,6 +11,9 @@ UHTextureCube::UHTextureCube()
 
 UHTextureCube::UHTextureCube(std::string InName, VkExtent2D InExtent, UHTextureFormat InFormat, UHTextureSettings InSettings)
 	: UHTexture(InName, InExtent, InFormat, InSettings)
+	, SourceFormat(InFormat)
+	, bHasBakedLighting(false)
+	, bUploadBakedLighting(false)
 	, bIsCubeBuilt(false)
 {
 	TextureType = UHTextureType::TextureCube;
@@ -27,6 +30,7 @@ void UHTextureCube::ReleaseCPUData()
 	for (int32_t Idx = 0; Idx < 6; Idx++)
 	{
 		SliceData[Idx].clear();
+		BakedLighting.Slices[Idx].clear();
 		for (UHRenderBuffer<uint8_t>& Buffer : RawStageBuffers[Idx])
 		{
 			Buffer.Release();
@@ -85,12 +89,54 @@ bool UHTextureCube::Import(std::filesystem::path InCubePath)
 
 	// read texture settings
 	FileIn >> TextureSettings;
+	SourceFormat = ImageFormat;
+
+	// read baked lighting
+	bHasBakedLighting = false;
+	if (Version >= UH_ENUM_VALUE(UHTextureVersion::BakedCubeLighting))
+	{
+		UHUtilities::ReadBoolData(FileIn, bHasBakedLighting);
+		if (bHasBakedLighting)
+		{
+			FileIn.read(reinterpret_cast<char*>(&BakedLighting.SH9), sizeof(BakedLighting.SH9));
+			for (int32_t Idx = 0; Idx < 6; Idx++)
+			{
+				UHUtilities::ReadVectorData(FileIn, BakedLighting.Slices[Idx]);
+			}
+		}
+	}
 
 	FileIn.close();
 
 	return true;
 }
 
+bool UHTextureCube::BakeLighting()
+{
+	return BakeLighting(SliceData, SourceFormat);
+}
+
+bool UHTextureCube::BakeLighting(const std::vector<uint8_t>* InSlices, UHTextureFormat InFormat)
+{
+	if (ImageExtent.width != ImageExtent.height)
+	{
+		return false;
+	}
+
+	bHasBakedLighting = UHCubemapBaker::Bake(InSlices, InFormat, ImageExtent.width, CalculateMipMapCount(), BakedLighting);
+	return bHasBakedLighting;
+}
+
+bool UHTextureCube::HasBakedLighting() const
+{
+	return bHasBakedLighting;
+}
+
+const UHSphericalHarmonicData& UHTextureCube::GetBakedSH9() const
+{
+	return BakedLighting.SH9;
+}
+
 #if WITH_EDITOR
 void UHTextureCube::SetSlices(std::vector<UHTexture2D*> InSlices)
 {
@@ -102,6 +148,10 @@ void UHTextureCube::Recreate(UHTextureFormat NewFormat)
 	GfxCache->WaitGPU();
 	Release();
 	ImageFormat = NewFormat;
+	SourceFormat = NewFormat;
+
+	// the slice data is going to change, the baked lighting is stale
+	bHasBakedLighting = false;
 
 	if (Slices.size() > 0)
 	{
@@ -115,6 +165,19 @@ void UHTextureCube::Recreate(UHTextureFormat NewFormat)
 	bIsCubeBuilt = false;
 }
 
+size_t UHTextureCube::GetDataSize() const
+{
+	size_t TotalSize = 0;
+	for (int32_t Idx = 0; Idx < 6; Idx++)
+	{
+		TotalSize += SliceData[Idx].size();
+	}
+
+	return TotalSize;
+}
+#endif
+
+#if WITH_EDITOR || WITH_COOKER
 void UHTextureCube::Export(std::filesystem::path InCubePath, bool bOverwrite)
 {
 	if (!bOverwrite && std::filesystem::exists(InCubePath.generic_string() + GCubemapAssetExtension))
@@ -135,7 +198,7 @@ void UHTextureCube::Export(std::filesystem::path InCubePath, bool bOverwrite)
 	// write image extent
 	FileOut.write(reinterpret_cast<const char*>(&ImageExtent.width), sizeof(ImageExtent.width));
 	FileOut.write(reinterpret_cast<const char*>(&ImageExtent.height), sizeof(ImageExtent.height));
-	FileOut.write(reinterpret_cast<const char*>(&ImageFormat), sizeof(ImageFormat));
+	FileOut.write(reinterpret_cast<const char*>(&SourceFormat), sizeof(SourceFormat));
 
 	// write texture data
 	for (int32_t Idx = 0; Idx < 6; Idx++)
@@ -146,20 +209,19 @@ void UHTextureCube::Export(std::filesystem::path InCubePath, bool bOverwrite)
 	// write texture settings
 	FileOut << TextureSettings;
 
-	FileOut.close();
-}
-
-size_t UHTextureCube::GetDataSize() const
-{
-	size_t TotalSize = 0;
-	for (int32_t Idx = 0; Idx < 6; Idx++)
+	// write baked lighting
+	UHUtilities::WriteBoolData(FileOut, bHasBakedLighting);
+	if (bHasBakedLighting)
 	{
-		TotalSize += SliceData[Idx].size();
+		FileOut.write(reinterpret_cast<const char*>(&BakedLighting.SH9), sizeof(BakedLighting.SH9));
+		for (int32_t Idx = 0; Idx < 6; Idx++)
+		{
+			UHUtilities::WriteVectorData(FileOut, BakedLighting.Slices[Idx]);
+		}
 	}
 
-	return TotalSize;
+	FileOut.close();
 }
-
 #endif
 
 // actually builds cubemap and upload to gpu
@@ -192,8 +254,9 @@ void UHTextureCube::Build(UHGraphic* InGfx, UHRenderBuilder& InRenderBuilder)
 
 			// cache slice data
 			SliceData[Idx] = Slices[Idx]->GetTextureData();
+			SourceFormat = ImageFormat;
 		}
-		else if (SliceData[Idx].size() > 0)
+		else if (GetUploadData(Idx).size() > 0)
 		{
 			// if slices are not there, upload from raw data directly, mipdata is also contained
 			UploadSlice(InGfx, InRenderBuilder, Idx, MipMapCount);
@@ -216,24 +279,25 @@ void UHTextureCube::UploadSlice(UHGraphic* InGfx, UHRenderBuilder& InRenderBuild
 	// copy data to staging buffer first
 	RawStageBuffers[SliceIndex].resize(MipMapCount);
 	const UHTextureFormatData TextureFormatData = GTextureFormatData[UH_ENUM_VALUE(ImageFormat)];
+	std::vector<uint8_t>& UploadData = GetUploadData(SliceIndex);
 	uint64_t MipStartIndex = 0;
 
 	for (uint32_t MipIdx = 0; MipIdx < MipMapCount; MipIdx++)
 	{
 		uint64_t MipSize = (ImageExtent.width >> MipIdx) * (ImageExtent.height >> MipIdx) * TextureFormatData.ByteSize / TextureFormatData.BlockSize;
-		if (TextureSettings.bIsCompressed)
+		if (TextureSettings.bIsCompressed && !bUploadBakedLighting)
 		{
 			MipSize = std::max(MipSize, static_cast<uint64_t>(TextureFormatData.ByteSize));
 		}
 
-		if (MipStartIndex >= SliceData[SliceIndex].size())
+		if (MipStartIndex >= UploadData.size())
 		{
 			continue;
 		}
 
 		RawStageBuffers[SliceIndex][MipIdx].SetGfxCache(InGfx);
 		RawStageBuffers[SliceIndex][MipIdx].CreateBuffer(MipSize, VK_IMAGE_USAGE_TRANSFER_SRC_BIT);
-		RawStageBuffers[SliceIndex][MipIdx].UploadAllData(SliceData[SliceIndex].data() + MipStartIndex);
+		RawStageBuffers[SliceIndex][MipIdx].UploadAllData(UploadData.data() + MipStartIndex);
 #if WITH_EDITOR
 		InGfx->SetDebugUtilsObjectName(VK_OBJECT_TYPE_BUFFER, (uint64_t)RawStageBuffers[SliceIndex][MipIdx].GetBuffer(), Name + "_StageBuffer");
 #endif
@@ -276,6 +340,7 @@ void UHTextureCube::UploadSlice(UHGraphic* InGfx, UHRenderBuilder& InRenderBuild
 bool UHTextureCube::CreateCube(std::vector<UHTexture2D*> InSlices)
 {
 	Slices = InSlices;
+	bUploadBakedLighting = false;
 
 	// texture also needs SRC/DST bits for copying/blit operation
 	// setup view type as Cube, the data is actually a 2D texture array
@@ -288,9 +353,18 @@ bool UHTextureCube::CreateCube(std::vector<UHTexture2D*> InSlices)
 
 bool UHTextureCube::CreateCube()
 {
+	// upload the baked mips if there are, they're RGBA16F regardless of the source format
+	bUploadBakedLighting = bHasBakedLighting && BakedLighting.Slices[0].size() > 0;
+	const UHTextureFormat CubeFormat = bUploadBakedLighting ? UHTextureFormat::UH_FORMAT_RGBA16F : SourceFormat;
+
 	UHTextureInfo Info(VK_IMAGE_TYPE_2D
-		, VK_IMAGE_VIEW_TYPE_CUBE, GetFormat(), GetExtent()
+		, VK_IMAGE_VIEW_TYPE_CUBE, CubeFormat, GetExtent()
 		, VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, false);
 
 	return Create(Info, GfxCache->GetImageSharedMemory());
+}
+
+std::vector<uint8_t>& UHTextureCube::GetUploadData(int32_t Slice)
+{
+	return bUploadBakedLighting ? BakedLighting.Slices[Slice] : SliceData[Slice];
 }
\ No newline at end of file
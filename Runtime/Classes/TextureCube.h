@@ -1,5 +1,6 @@
 #pragma once
 #include "Texture2D.h"
+#include "CubemapBaker.h"
 
 class UHGraphic;
 class UHRenderBuilder;
@@ -21,12 +22,21 @@ public:
 	bool IsBuilt() const;
 
 	bool Import(std::filesystem::path InCubePath);
+
+	// bake SH9 and the prefiltered mips on CPU, uses the slice data if the input isn't given
+	// the baked mips are uploaded instead of the slice data once the cube is created again
+	bool BakeLighting();
+	bool BakeLighting(const std::vector<uint8_t>* InSlices, UHTextureFormat InFormat);
+	bool HasBakedLighting() const;
+	const UHSphericalHarmonicData& GetBakedSH9() const;
 #if WITH_EDITOR
 	void SetSlices(std::vector<UHTexture2D*> InSlices);
 	void Recreate(UHTextureFormat NewFormat);
-	void Export(std::filesystem::path InCubePath, bool bOverwrite = true);
 	size_t GetDataSize() const;
 #endif
+#if WITH_EDITOR || WITH_COOKER
+	void Export(std::filesystem::path InCubePath, bool bOverwrite = true);
+#endif
 
 	void Build(UHGraphic* InGfx, UHRenderBuilder& InRenderBuilder);
 	void UploadSlice(UHGraphic* InGfx, UHRenderBuilder& InRenderBuilder, const int32_t SliceIndex, const uint32_t MipMapCount);
@@ -34,8 +44,14 @@ public:
 private:
 	bool CreateCube(std::vector<UHTexture2D*> InSlices);
 	bool CreateCube();
+	std::vector<uint8_t>& GetUploadData(int32_t Slice);
 
 	std::vector<uint8_t> SliceData[6];
+	// format of the slice data, the image is RGBA16F when the baked mips are uploaded
+	UHTextureFormat SourceFormat;
+	UHCubemapBakedData BakedLighting;
+	bool bHasBakedLighting;
+	bool bUploadBakedLighting;
 	std::vector<UHTexture2D*> Slices;
 	std::vector<UHRenderBuffer<uint8_t>> RawStageBuffers[6];
 	bool bIsCubeBuilt;
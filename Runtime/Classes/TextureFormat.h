@@ -40,6 +40,7 @@ enum class UHTextureFormat : uint32_t
 	UH_FORMAT_R8_UINT,
 	UH_FORMAT_R16_UINT,
 	UH_FORMAT_R32_UINT,
+	UH_FORMAT_RG32_UINT,
 
 	// add the format above
 	UH_FORMAT_MAX
@@ -102,6 +103,7 @@ inline const UHTextureFormatData GTextureFormatData[UH_ENUM_VALUE(UHTextureForma
 	{1,1,1,true},
 	{2,1,1,true},
 	{4,1,1,true},
+	{8,1,2,true},
 };
 
 extern VkFormat GetVulkanFormat(UHTextureFormat InUHFormat);
\ No newline at end of file
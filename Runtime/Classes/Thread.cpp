@@ -1,6 +1,8 @@
 #include "Thread.h"
 #include "../../UnheardEngine.h"
 #include <assert.h>
+#include <algorithm>
+#include <atomic>
 
 UHThread::UHThread()
 	: bIsThreadDoneTask(true)
@@ -122,4 +124,30 @@ void UHThread::DoTask(const int32_t ThreadIdx)
 std::thread::id UHThread::GetThreadID() const
 {
 	return ThreadId;
-}
\ No newline at end of file
+}
+
+void UHParallelFor(const uint32_t InCount, const std::function<void(uint32_t)>& InTask, const uint32_t InMaxThreads)
+{
+	std::atomic<uint32_t> NextIdx = 0;
+	auto Worker = [&]()
+	{
+		for (uint32_t Idx = NextIdx.fetch_add(1); Idx < InCount; Idx = NextIdx.fetch_add(1))
+		{
+			InTask(Idx);
+		}
+	};
+
+	const uint32_t NumCores = (std::max)(std::thread::hardware_concurrency(), 1u);
+	const uint32_t NumThreads = (std::min)(InMaxThreads > 0 ? InMaxThreads : NumCores, InCount);
+	std::vector<std::thread> Workers;
+	for (uint32_t Idx = 1; Idx < NumThreads; Idx++)
+	{
+		Workers.push_back(std::thread(Worker));
+	}
+
+	Worker();
+	for (std::thread& Thread : Workers)
+	{
+		Thread.join();
+	}
+}
@@ -2,6 +2,7 @@
 #include <thread>
 #include <mutex>
 #include <condition_variable>
+#include <functional>
 #include "AsyncTask.h"
 
 // UH thread wrapper
@@ -52,4 +53,8 @@ private:
 	bool bIsThreadTerminated;
 
 	UHAsyncTask* CurrentScheduledTask;
-};
\ No newline at end of file
+};
+
+// run InTask for the indices [0, InCount) on short-lived threads and wait for all of them, the calling thread works as well
+// InMaxThreads caps the thread count, 0 uses all hardware threads
+void UHParallelFor(const uint32_t InCount, const std::function<void(uint32_t)>& InTask, const uint32_t InMaxThreads = 0);
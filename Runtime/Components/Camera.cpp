@@ -29,7 +29,7 @@ UHCameraComponent::UHCameraComponent()
 #endif
 {
 	SetName("CameraComponent" + std::to_string(GetId()));
-	ObjectClassIdInternal = ClassId;
+	SetObjectClassId(ClassId);
 }
 
 void UHCameraComponent::Update()
@@ -33,30 +33,10 @@ protected:
 	bool bIsEnabled;
 };
 
+// get components of a final component class, this iterates the dense array of the class instead of all objects
 template <typename T>
 inline std::vector<T*> GetComponents()
 {
-	std::vector<T*> OutComponents;
-
-	if (!std::is_same<UHComponent, T>::value || !std::is_base_of<UHComponent, T>::value)
-	{
-		return OutComponents;
-	}
-
-	for (auto& ObjectPair : GObjectTable)
-	{
-		// check if the object ptr is safe, skip it if it's dangerling
-		if (GObjectTable.find(ObjectPair.second->GetId()) == GObjectTable.end())
-		{
-			continue;
-		}
-
-		UHObject* Obj = GObjectTable[ObjectPair.second->GetId()];
-		if (T* Comp = dynamic_cast<T*>(Obj))
-		{
-			OutComponents.push_back(Comp);
-		}
-	}
-
-	return OutComponents;
+	static_assert(std::is_base_of<UHComponent, T>::value, "GetComponents() only works with component classes!");
+	return GetObjectsOfClass<T>();
 }
\ No newline at end of file
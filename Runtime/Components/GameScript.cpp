@@ -10,5 +10,5 @@ UHGameScript::UHGameScript()
 	}
 
 	SetName("GameScriptComponent" + std::to_string(GetId()));
-	ObjectClassIdInternal = ClassId;
+	SetObjectClassId(ClassId);
 }
\ No newline at end of file
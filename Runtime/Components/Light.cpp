@@ -37,7 +37,7 @@ UHLightType UHLightBase::GetLightType() const
 UHDirectionalLightComponent::UHDirectionalLightComponent()
 {
 	SetName("DirectionalLightComponent" + std::to_string(GetId()));
-	ObjectClassIdInternal = ClassId;
+	SetObjectClassId(ClassId);
 	LightType = UHLightType::Directional;
 }
 
@@ -128,7 +128,7 @@ UHPointLightComponent::UHPointLightComponent()
 	: Radius(50.0f)
 {
 	SetName("PointLightComponent" + std::to_string(GetId()));
-	ObjectClassIdInternal = ClassId;
+	SetObjectClassId(ClassId);
 	LightType = UHLightType::Point;
 }
 
@@ -247,7 +247,7 @@ UHSpotLightComponent::UHSpotLightComponent()
 	, InnerAngle(90.0f * 0.9f)
 {
 	SetName("SpotLightComponent" + std::to_string(GetId()));
-	ObjectClassIdInternal = ClassId;
+	SetObjectClassId(ClassId);
 	LightType = UHLightType::Spot;
 }
 
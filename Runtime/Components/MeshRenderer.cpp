@@ -26,7 +26,7 @@ UHMeshRendererComponent::UHMeshRendererComponent(UHMesh* InMesh, UHMaterial* InM
 {
 	SetMaterial(MaterialCache);
 	SetName("MeshRendererComponent" + std::to_string(GetId()));
-	ObjectClassIdInternal = ClassId;
+	SetObjectClassId(ClassId);
 }
 
 void UHMeshRendererComponent::Update()
@@ -156,13 +156,22 @@ UHObjectConstants UHMeshRendererComponent::GetConstants() const
 {
 	// fill CB and return
 	UHObjectConstants CB{};
-	CB.GWorld = GetWorldMatrix();
-	CB.GWorldIT = GetWorldMatrixIT();
-	CB.GPrevWorld = GetPrevWorldMatrix();
-	CB.InstanceIndex = GetBufferDataIndex();
+	// merge the position decode of compressed mesh, it's a uniform scale + offset so normal transform isn't affected
+	const UHMatrix4x4 World = GetWorldMatrix();
+	const UHMatrix4x4 Decode = MeshCache->GetPositionDecodeMatrix();
+	CB.GWorld = UHMathHelpers::MatrixTo3x4(Decode * World);
+	CB.GPrevWorld = UHMathHelpers::MatrixTo3x4(Decode * GetPrevWorldMatrix());
 	CB.WorldPos = RendererBound.Center;
+	CB.InstanceIndex = GetBufferDataIndex();
 	CB.BoundExtent = RendererBound.Extents;
 
+	// negative scaling flips the winding, shader needs this to fix the reconstructed normal
+	CB.ObjectFlags = 0;
+	if (glm::determinant(glm::mat3(World)) < 0.0f)
+	{
+		CB.ObjectFlags |= UH_ENUM_VALUE_U(UHObjectFlagBits::ObjectMirrored);
+	}
+
 	return CB;
 }
 
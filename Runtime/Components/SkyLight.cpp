@@ -14,7 +14,7 @@ UHSkyLightComponent::UHSkyLightComponent()
 	, CubemapId(UHGUID())
 {
 	SetName("SkyLightLightComponent" + std::to_string(GetId()));
-	ObjectClassIdInternal = ClassId;
+	SetObjectClassId(ClassId);
 }
 
 void UHSkyLightComponent::OnSave(std::ofstream& OutStream)
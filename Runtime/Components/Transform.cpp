@@ -12,6 +12,7 @@ UHTransformComponent::UHTransformComponent()
 	, WorldMatrixIT(UHMathHelpers::Identity4x4())
 	, RotationMatrix(UHMathHelpers::Identity4x4())
 	, bTransformChanged(true)
+	, TransformVersion(0)
 	, bIsWorldDirty(true)
 	, bIsFirstFrame(true)
 {
@@ -35,6 +36,7 @@ void UHTransformComponent::Update()
 		W = UHMathHelpers::UHMatrixInverse(W);
 		WorldMatrixIT = UHMathHelpers::UHMatrixTranspose(W);
 
+		TransformVersion++;
 		bIsWorldDirty = false;
 	}
 	else if (bIsFirstFrame)
@@ -236,6 +238,11 @@ bool UHTransformComponent::IsTransformChanged() const
 	return bTransformChanged;
 }
 
+uint32_t UHTransformComponent::GetTransformVersion() const
+{
+	return TransformVersion;
+}
+
 #if WITH_EDITOR
 void UHTransformComponent::OnGenerateDetailView()
 {
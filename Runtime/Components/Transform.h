@@ -49,6 +49,7 @@ public:
 	// is transform changed
 	bool IsWorldDirty() const;
 	bool IsTransformChanged() const;
+	uint32_t GetTransformVersion() const;
 
 #if WITH_EDITOR
 	virtual void OnGenerateDetailView() override;
@@ -66,6 +67,10 @@ protected:
 
 	bool bTransformChanged;
 
+	// bumped whenever world matrix is rebuilt, unlike bTransformChanged it never goes back
+	// so consumers that don't see every update can still tell whether they're outdated
+	uint32_t TransformVersion;
+
 	// dirty flag
 	bool bIsWorldDirty;
 	bool bIsFirstFrame;
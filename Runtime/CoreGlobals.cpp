@@ -1,9 +1,9 @@
 #include "CoreGlobals.h"
 
 uint32_t GFrameNumber = 0;
+bool GEnableGPUTiming = true;
 
 #if WITH_EDITOR
-bool GEnableGPUTiming = true;
 bool GIsEditor = true;
 bool GIsShipping = false;
 #else
@@ -22,6 +22,12 @@ std::thread::id GRenderThreadID;
 std::vector<std::thread::id> GWorkerThreadIDs;
 thread_local std::thread::id GCurrentThreadID;
 
+// headless mode doesn't show the window, set from command line
+bool GIsHeadless = false;
+
+// offscreen mode doesn't create the window and swap chain at all, frames are rendered to offscreen images instead
+bool GIsOffscreen = false;
+
 float GEpsilon = std::numeric_limits<float>::epsilon();
 float GWorldMax = static_cast<float>(1 << 20);
 
@@ -10,9 +10,8 @@
 // header for global shared definitions, only define things here if necessary
 extern uint32_t GFrameNumber;
 
-#if WITH_EDITOR
+// editor can turn it off, the other builds only time the passes needed at runtime
 extern bool GEnableGPUTiming;
-#endif
 
 extern const uint32_t GMainThreadAffinity;
 extern const uint32_t GRenderThreadAffinity;
@@ -26,6 +25,8 @@ extern thread_local std::thread::id GCurrentThreadID;
 
 extern bool GIsEditor;
 extern bool GIsShipping;
+extern bool GIsHeadless;
+extern bool GIsOffscreen;
 
 extern bool IsInGameThread();
 extern bool IsInRenderThread();
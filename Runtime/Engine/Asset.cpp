@@ -186,6 +186,7 @@ void UHAssetManager::Release()
 	for (UHAssetMap& Map : AllAssetsMap)
 	{
 		Map.Asset = nullptr;
+		Map.AssetHandle = UHOBJECTHANDLENONE;
 	}
 
 	// container cleanup
@@ -493,7 +494,7 @@ UHObject* UHAssetManager::GetAsset(UHGUID InAssetUuid)
 			if (AssetMap.Asset != nullptr)
 			{
 				// safely get the object if it's created already
-				UHObject* Obj = SafeGetObjectFromTable<UHObject>(AssetMap.Asset->GetId());
+				UHObject* Obj = SafeGetObjectFromHandle<UHObject>(AssetMap.AssetHandle);
 				if (Obj && Obj->GetRuntimeGuid() == InAssetUuid)
 				{
 					return Obj;
@@ -504,6 +505,7 @@ UHObject* UHAssetManager::GetAsset(UHGUID InAssetUuid)
 				// load asset if not found and cache in the asset map
 				UHObject* Obj = ImportAsset(AssetMap.FilePath);
 				AssetMap.Asset = Obj;
+				AssetMap.AssetHandle = Obj ? Obj->GetHandle() : UHOBJECTHANDLENONE;
 				return Obj;
 			}
 		}
@@ -521,7 +523,7 @@ UHObject* UHAssetManager::GetAsset(std::string InPath)
 			if (AssetMap.Asset != nullptr)
 			{
 				// safely get the object if it's created already
-				UHObject* Obj = SafeGetObjectFromTable<UHObject>(AssetMap.Asset->GetId());
+				UHObject* Obj = SafeGetObjectFromHandle<UHObject>(AssetMap.AssetHandle);
 				if (Obj && Obj->GetRuntimeGuid() == AssetMap.AssetUUid)
 				{
 					return Obj;
@@ -532,6 +534,7 @@ UHObject* UHAssetManager::GetAsset(std::string InPath)
 				// load asset if not found and cache in the asset map
 				UHObject* Obj = ImportAsset(AssetMap.FilePath);
 				AssetMap.Asset = Obj;
+				AssetMap.AssetHandle = Obj ? Obj->GetHandle() : UHOBJECTHANDLENONE;
 				return Obj;
 			}
 		}
@@ -547,25 +550,70 @@ UHObject* UHAssetManager::AddImportedMaterial(std::filesystem::path InPath)
 
 	if (Mat)
 	{
-		// it's also important to update the texture references after material is imported
-		for (const std::string& TextureName : Mat->GetRegisteredTextureNames())
-		{
-			GetAsset(GTextureAssetFolder + TextureName + GTextureAssetExtension);
-		}
-		MapTextureIndex(Mat);
-
 		UHMaterialsCache.push_back(Mat);
 		if (GIsEditor)
 		{
 			AllAssetsMap.push_back(UHAssetMap(Mat, InPath.generic_string()));
 		}
 
+		// material instance needs the parent graph before collecting textures
+		// the parent might not be imported yet when importing all assets, resolve it later in that case
+		if (Mat->IsMaterialInstance() && !ResolveMaterialInstance(Mat))
+		{
+			PendingMaterialInstances.push_back(Mat);
+		}
+		else
+		{
+			LoadMaterialTextures(Mat);
+		}
+
 		Result = Mat;
 	}
 
 	return Result;
 }
 
+void UHAssetManager::LoadMaterialTextures(UHMaterial* InMat)
+{
+	// it's also important to update the texture references after material is imported
+	for (const std::string& TextureName : InMat->GetRegisteredTextureNames())
+	{
+		GetAsset(GTextureAssetFolder + TextureName + GTextureAssetExtension);
+	}
+	MapTextureIndex(InMat);
+}
+
+bool UHAssetManager::ResolveMaterialInstance(UHMaterial* InMat)
+{
+	UHMaterial* Parent = GetMaterial(InMat->GetParentSourcePath());
+	if (Parent == nullptr)
+	{
+		Parent = CastObject<UHMaterial>(GetAsset(GMaterialAssetPath + InMat->GetParentSourcePath() + GMaterialAssetExtension));
+	}
+
+	if (Parent == nullptr)
+	{
+		return false;
+	}
+
+	// an invalid parent is logged by material, the instance is still treated as resolved
+	InMat->SetParentMaterial(Parent);
+	return true;
+}
+
+void UHAssetManager::ResolvePendingMaterialInstances()
+{
+	for (UHMaterial* Mat : PendingMaterialInstances)
+	{
+		if (!ResolveMaterialInstance(Mat))
+		{
+			UHE_LOG("Parent material " + Mat->GetParentSourcePath() + " of " + Mat->GetName() + " is not found!\n");
+		}
+		LoadMaterialTextures(Mat);
+	}
+	PendingMaterialInstances.clear();
+}
+
 #if WITH_EDITOR
 void UHAssetManager::ImportAssets()
 {
@@ -587,6 +635,7 @@ void UHAssetManager::ImportAssets()
 		// load corresponding asset based on file type
 		ImportAsset(Idx->path());
 	}
+	ResolvePendingMaterialInstances();
 
 	// output asset map after import all
 	std::ofstream FileOut(GAssetPath + GAssetMapName, std::ios::out | std::ios::binary);
@@ -611,6 +660,25 @@ void UHAssetManager::AddTexture2D(UHTexture2D* InTexture2D)
 	}
 }
 
+UHMaterial* UHAssetManager::CreateMaterialInstance(UHMaterial* InMat)
+{
+	if (InMat == nullptr)
+	{
+		return nullptr;
+	}
+
+	// find an unused name next to the source material
+	std::string SourcePath;
+	int32_t InstanceNo = 0;
+	do
+	{
+		SourcePath = InMat->GetSourcePath() + "_Inst" + std::to_string(InstanceNo++);
+	} while (std::filesystem::exists(GMaterialAssetPath + SourcePath + GMaterialAssetExtension));
+
+	InMat->ExportInstance(SourcePath);
+	return CastObject<UHMaterial>(AddImportedMaterial(GMaterialAssetPath + SourcePath + GMaterialAssetExtension));
+}
+
 void UHAssetManager::AddImportedMesh(UniquePtr<UHMesh>& InMesh)
 {
 	UHMeshesCache.push_back(InMesh.get());
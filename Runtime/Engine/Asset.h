@@ -16,6 +16,7 @@ struct UHAssetMap
 	UHAssetMap() 
 		: Asset(nullptr)
 		, AssetUUid(UHGUID())
+		, AssetHandle(UHOBJECTHANDLENONE)
 	{
 	}
 
@@ -23,6 +24,7 @@ struct UHAssetMap
 		: AssetUUid(InObj->GetRuntimeGuid())
 		, FilePath(InPath)
 		, Asset(InObj)
+		, AssetHandle(InObj->GetHandle())
 	{
 
 	}
@@ -30,6 +32,7 @@ struct UHAssetMap
 	UHGUID AssetUUid;
 	std::string FilePath;
 	UHObject* Asset;
+	UHObjectHandle AssetHandle;
 };
 
 // asset manager class in UH
@@ -71,6 +74,9 @@ public:
 	void AddTexture2D(UHTexture2D* InTexture2D);
 	void AddImportedMesh(UniquePtr<UHMesh>& InMesh);
 
+	// create an instance asset of the material, it shares the shaders of the parent
+	UHMaterial* CreateMaterialInstance(UHMaterial* InMat);
+
 	static UHAssetManager* GetAssetMgrEditor();
 	static UHTexture2D* GetTexture2DByPathEditor(std::string InName);
 	static std::string FindTexturePathName(std::string InName);
@@ -85,6 +91,9 @@ private:
 	UHObject* ImportTexture(std::filesystem::path InPath);
 	UHObject* ImportCubemap(std::filesystem::path InPath);
 	UHObject* ImportMaterial(std::filesystem::path InPath);
+	void LoadMaterialTextures(UHMaterial* InMat);
+	bool ResolveMaterialInstance(UHMaterial* InMat);
+	void ResolvePendingMaterialInstances();
 
 	// loaded meshes
 	std::vector<UniquePtr<UHMesh>> UHMeshes;
@@ -106,6 +115,7 @@ private:
 
 	// loaded & cached UH materials
 	std::vector<UHMaterial*> UHMaterialsCache;
+	std::vector<UHMaterial*> PendingMaterialInstances;
 
 	// loaded textures
 	std::vector<UHTexture2D*> UHTexture2Ds;
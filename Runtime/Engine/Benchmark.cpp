@@ -0,0 +1,307 @@
+#include "Benchmark.h"
+#include "Engine.h"
+#include "TraceProfiler.h"
+#include "../../UnheardEngine.h"
+#include "../CoreGlobals.h"
+#include <algorithm>
+#include <fstream>
+#include <cmath>
+
+UHBenchmark::UHBenchmark(UHEngine* InEngine, const UHBenchmarkSettings& InSettings)
+	: Engine(InEngine)
+	, Settings(InSettings)
+	, FrameIndex(0)
+	, FrameBeginTime(UHClock::time_point())
+{
+
+}
+
+// command line: -benchmark <scene> [-frames N] [-warmup N] [-dt seconds] [-radius R] [-height H] [-loops L]
+// [-output path] [-gpu name] [-norender]
+bool UHBenchmark::ParseCommandLine(int32_t ArgC, char* ArgV[], UHBenchmarkSettings& OutSettings)
+{
+	for (int32_t Idx = 1; Idx < ArgC; Idx++)
+	{
+		const std::string Arg = ArgV[Idx];
+		const bool bHasValue = Idx + 1 < ArgC;
+
+		try
+		{
+			if (Arg == "-benchmark" && bHasValue)
+			{
+				OutSettings.bEnabled = true;
+				OutSettings.ScenePath = ArgV[++Idx];
+			}
+			else if (Arg == "-frames" && bHasValue)
+			{
+				OutSettings.NumFrames = std::stoi(ArgV[++Idx]);
+			}
+			else if (Arg == "-warmup" && bHasValue)
+			{
+				OutSettings.WarmupFrames = std::stoi(ArgV[++Idx]);
+			}
+			else if (Arg == "-dt" && bHasValue)
+			{
+				OutSettings.FixedDeltaTime = std::stof(ArgV[++Idx]);
+			}
+			else if (Arg == "-radius" && bHasValue)
+			{
+				OutSettings.CameraPathRadius = std::stof(ArgV[++Idx]);
+			}
+			else if (Arg == "-height" && bHasValue)
+			{
+				OutSettings.CameraPathHeight = std::stof(ArgV[++Idx]);
+			}
+			else if (Arg == "-loops" && bHasValue)
+			{
+				OutSettings.CameraPathLoops = std::stof(ArgV[++Idx]);
+			}
+			else if (Arg == "-output" && bHasValue)
+			{
+				OutSettings.OutputPath = ArgV[++Idx];
+			}
+			else if (Arg == "-gpu" && bHasValue)
+			{
+				OutSettings.GpuName = ArgV[++Idx];
+			}
+			else if (Arg == "-norender")
+			{
+				OutSettings.bNoRendering = true;
+			}
+			else
+			{
+				UHE_LOG("Unknown or incomplete argument: " + Arg + "\n");
+				return false;
+			}
+		}
+		catch (const std::exception&)
+		{
+			UHE_LOG("Invalid value for argument: " + Arg + "\n");
+			return false;
+		}
+	}
+
+	if (OutSettings.bEnabled && (OutSettings.NumFrames <= 0 || OutSettings.WarmupFrames < 0 || OutSettings.FixedDeltaTime <= 0.0f))
+	{
+		UHE_LOG("Benchmark needs positive frame count and delta time!\n");
+		return false;
+	}
+
+	return true;
+}
+
+// benchmark needs an uncapped and windowed setup, the overrides are not saved back to the config file
+void UHBenchmark::OverrideConfig(UHConfigManager* InConfig, const UHBenchmarkSettings& InSettings)
+{
+	InConfig->PresentationSetting().bVsync = false;
+	InConfig->PresentationSetting().bFullScreen = false;
+	InConfig->EngineSetting().FPSLimit = 0.0f;
+
+	if (!InSettings.GpuName.empty())
+	{
+		InConfig->RenderingSetting().SelectedGpuName = InSettings.GpuName;
+	}
+}
+
+bool UHBenchmark::Initialize()
+{
+	if (!std::filesystem::exists(Settings.ScenePath))
+	{
+		UHE_LOG("Benchmark scene " + Settings.ScenePath.generic_string() + " not found!\n");
+		return false;
+	}
+
+	Engine->OnLoadScene(Settings.ScenePath);
+	if (Engine->GetScene()->GetMainCamera() == nullptr)
+	{
+		UHE_LOG("Benchmark scene doesn't have a main camera!\n");
+		return false;
+	}
+
+	Engine->GetGameTimer()->SetFixedDeltaTime(Settings.FixedDeltaTime);
+	Engine->SetRenderingEnabled(!Settings.bNoRendering);
+
+	// phase timings come from the trace scopes
+	UHTraceProfiler::SetEnabled(true);
+	UHTraceProfiler::SetCollectFrameScopeTimes(true);
+
+	UHE_LOG("Benchmark started: " + Settings.ScenePath.generic_string() + ", " + std::to_string(Settings.NumFrames) + " frames.\n");
+	return true;
+}
+
+void UHBenchmark::BeginFrame()
+{
+	FrameBeginTime = UHClock::now();
+	UpdateCamera();
+}
+
+void UHBenchmark::EndFrame()
+{
+	const float FrameTimeMS = std::chrono::duration<float, std::milli>(UHClock::now() - FrameBeginTime).count();
+
+	if (FrameIndex >= Settings.WarmupFrames)
+	{
+		AddSample(Timings, TimingIndices, "FrameTime", FrameTimeMS);
+
+		// the same scope could run on multiple threads, e.g. culling, sum them as CPU time of this frame
+		std::unordered_map<std::string, float> FrameScopeTimes;
+		for (const auto& ScopeTime : UHTraceProfiler::GetFrameScopeTimes())
+		{
+			FrameScopeTimes[ScopeTime.first] += ScopeTime.second;
+		}
+
+		for (const auto& ScopeTime : UHTraceProfiler::GetFrameScopeTimes())
+		{
+			auto Iter = FrameScopeTimes.find(ScopeTime.first);
+			if (Iter != FrameScopeTimes.end())
+			{
+				AddSample(Timings, TimingIndices, Iter->first, Iter->second);
+				FrameScopeTimes.erase(Iter);
+			}
+		}
+
+		UHStatistics Stats;
+		Engine->CollectStatistics(Stats);
+		AddSample(Counters, CounterIndices, "RendererCount", static_cast<float>(Stats.RendererCount));
+		AddSample(Counters, CounterIndices, "DrawCallCount", static_cast<float>(Stats.DrawCallCount));
+		AddSample(Counters, CounterIndices, "OccludedCallCount", static_cast<float>(Stats.OccludedCallCount));
+		AddSample(Counters, CounterIndices, "PSOCount", static_cast<float>(Stats.PSOCount));
+		AddSample(Counters, CounterIndices, "ShaderCount", static_cast<float>(Stats.ShaderCount));
+		AddSample(Counters, CounterIndices, "RTCount", static_cast<float>(Stats.RTCount));
+		AddSample(Counters, CounterIndices, "SamplerCount", static_cast<float>(Stats.SamplerCount));
+		AddSample(Counters, CounterIndices, "TextureCount", static_cast<float>(Stats.TextureCount));
+		AddSample(Counters, CounterIndices, "TextureCubeCount", static_cast<float>(Stats.TextureCubeCount));
+		AddSample(Counters, CounterIndices, "MaterialCount", static_cast<float>(Stats.MateralCount));
+		AddSample(Counters, CounterIndices, "GeometryBandwidthMB", Stats.GeometryBandwidthMB);
+	}
+
+	FrameIndex++;
+}
+
+bool UHBenchmark::IsFinished() const
+{
+	return FrameIndex >= Settings.WarmupFrames + Settings.NumFrames;
+}
+
+// nearest-rank percentile of sorted samples
+static float GetPercentile(const std::vector<float>& InSortedSamples, float InPercent)
+{
+	if (InSortedSamples.size() == 0)
+	{
+		return 0.0f;
+	}
+
+	const size_t Rank = static_cast<size_t>(std::ceil(InPercent * 0.01f * static_cast<float>(InSortedSamples.size())));
+	return InSortedSamples[std::clamp<size_t>(Rank, 1, InSortedSamples.size()) - 1];
+}
+
+bool UHBenchmark::WriteResults() const
+{
+	std::filesystem::path JsonPath = Settings.OutputPath;
+	std::filesystem::path CsvPath = Settings.OutputPath;
+	JsonPath += ".json";
+	CsvPath += ".csv";
+
+	std::ofstream JsonOut(JsonPath, std::ios::out);
+	std::ofstream CsvOut(CsvPath, std::ios::out);
+	if (!JsonOut.is_open() || !CsvOut.is_open())
+	{
+		UHE_LOG("Failed to write benchmark results to " + Settings.OutputPath.generic_string() + "!\n");
+		return false;
+	}
+
+	const float Percents[] = { 50.0f, 90.0f, 95.0f, 99.0f };
+	JsonOut << "{\n";
+	JsonOut << "\t\"scene\": \"" << Settings.ScenePath.generic_string() << "\",\n";
+	JsonOut << "\t\"frames\": " << Settings.NumFrames << ",\n";
+	JsonOut << "\t\"warmup_frames\": " << Settings.WarmupFrames << ",\n";
+	JsonOut << "\t\"fixed_delta_time\": " << Settings.FixedDeltaTime << ",\n";
+	JsonOut << "\t\"rendering\": " << (Settings.bNoRendering ? "false" : "true") << ",\n";
+	CsvOut << "category,name,count,mean,min,p50,p90,p95,p99,max\n";
+
+	auto WriteSeries = [&](const std::string& InCategory, const std::vector<UHBenchmarkSeries>& InSeries, bool bIsLast)
+		{
+			JsonOut << "\t\"" << InCategory << "\": {\n";
+			for (size_t Idx = 0; Idx < InSeries.size(); Idx++)
+			{
+				std::vector<float> Sorted = InSeries[Idx].Samples;
+				std::sort(Sorted.begin(), Sorted.end());
+
+				double Sum = 0.0;
+				for (const float Sample : Sorted)
+				{
+					Sum += Sample;
+				}
+				const float Mean = Sorted.size() > 0 ? static_cast<float>(Sum / Sorted.size()) : 0.0f;
+				const float Min = Sorted.size() > 0 ? Sorted.front() : 0.0f;
+				const float Max = Sorted.size() > 0 ? Sorted.back() : 0.0f;
+
+				JsonOut << "\t\t\"" << InSeries[Idx].Name << "\": { \"count\": " << Sorted.size()
+					<< ", \"mean\": " << Mean << ", \"min\": " << Min;
+				CsvOut << InCategory << "," << InSeries[Idx].Name << "," << Sorted.size() << "," << Mean << "," << Min;
+
+				for (const float Percent : Percents)
+				{
+					const float Value = GetPercentile(Sorted, Percent);
+					JsonOut << ", \"p" << static_cast<int32_t>(Percent) << "\": " << Value;
+					CsvOut << "," << Value;
+				}
+
+				JsonOut << ", \"max\": " << Max << " }" << (Idx + 1 < InSeries.size() ? ",\n" : "\n");
+				CsvOut << "," << Max << "\n";
+			}
+			JsonOut << "\t}" << (bIsLast ? "\n" : ",\n");
+		};
+
+	WriteSeries("timings_ms", Timings, false);
+	WriteSeries("counters", Counters, true);
+	JsonOut << "}\n";
+
+	JsonOut.close();
+	CsvOut.close();
+
+	UHE_LOG("Benchmark results written to " + JsonPath.generic_string() + " and " + CsvPath.generic_string() + "\n");
+	return true;
+}
+
+void UHBenchmark::AddSample(std::vector<UHBenchmarkSeries>& InSeries, std::unordered_map<std::string, size_t>& InIndices
+	, const std::string& InName, float InValue)
+{
+	auto Iter = InIndices.find(InName);
+	if (Iter == InIndices.end())
+	{
+		InIndices[InName] = InSeries.size();
+		UHBenchmarkSeries NewSeries;
+		NewSeries.Name = InName;
+		NewSeries.Samples.reserve(Settings.NumFrames);
+		InSeries.push_back(UHMOVE(NewSeries));
+		Iter = InIndices.find(InName);
+	}
+
+	InSeries[Iter->second].Samples.push_back(InValue);
+}
+
+// deterministic camera path, orbits around the world origin and always looks at it
+void UHBenchmark::UpdateCamera()
+{
+	UHCameraComponent* Camera = Engine->GetScene()->GetMainCamera();
+	if (Camera == nullptr)
+	{
+		return;
+	}
+
+	const int32_t TotalFrames = Settings.WarmupFrames + Settings.NumFrames;
+	const float T = static_cast<float>(FrameIndex) / static_cast<float>(TotalFrames);
+	const float Angle = T * Settings.CameraPathLoops * 6.2831853f;
+
+	const UHVector3 Pos(std::cos(Angle) * Settings.CameraPathRadius, Settings.CameraPathHeight, std::sin(Angle) * Settings.CameraPathRadius);
+	const float Length = std::sqrt(Pos.x * Pos.x + Pos.y * Pos.y + Pos.z * Pos.z);
+	const UHVector3 Dir = Length > 0.0f ? UHVector3(-Pos.x / Length, -Pos.y / Length, -Pos.z / Length) : UHVector3(0, 0, 1);
+
+	// euler in degrees, x = pitch (positive looks down), y = yaw
+	const float Pitch = UHMathHelpers::ToDegrees(std::asin(-Dir.y));
+	const float Yaw = UHMathHelpers::ToDegrees(std::atan2(Dir.x, Dir.z));
+
+	Camera->SetPosition(Pos);
+	Camera->SetRotation(UHVector3(Pitch, Yaw, 0.0f));
+}
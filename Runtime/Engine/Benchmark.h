@@ -0,0 +1,89 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <filesystem>
+#include <unordered_map>
+#include "GameTimer.h"
+#include "Statistics.h"
+
+class UHEngine;
+class UHConfigManager;
+
+// benchmark settings, parsed from command line
+struct UHBenchmarkSettings
+{
+public:
+	UHBenchmarkSettings()
+		: bEnabled(false)
+		, NumFrames(600)
+		, WarmupFrames(60)
+		, FixedDeltaTime(1.0f / 60.0f)
+		, CameraPathRadius(15.0f)
+		, CameraPathHeight(3.0f)
+		, CameraPathLoops(1.0f)
+		, bNoRendering(false)
+		, OutputPath("BenchmarkResult")
+	{
+
+	}
+
+	bool bEnabled;
+	std::filesystem::path ScenePath;
+	int32_t NumFrames;
+	int32_t WarmupFrames;
+	float FixedDeltaTime;
+
+	// the camera orbits around the world origin
+	float CameraPathRadius;
+	float CameraPathHeight;
+	float CameraPathLoops;
+
+	// stub out rendering, only the update/culling/collection/upload are measured
+	bool bNoRendering;
+
+	// output without extension, .json and .csv will be written
+	std::filesystem::path OutputPath;
+
+	// override the selected GPU, e.g. "llvmpipe" for a software Vulkan device
+	std::string GpuName;
+};
+
+// headless benchmark harness
+// loads a scene, drives a deterministic camera path with fixed timestep for N frames
+// records per-phase CPU timings from trace scopes plus the statistics counters, then writes the percentiles to JSON/CSV
+class UHBenchmark
+{
+public:
+	UHBenchmark(UHEngine* InEngine, const UHBenchmarkSettings& InSettings);
+
+	static bool ParseCommandLine(int32_t ArgC, char* ArgV[], UHBenchmarkSettings& OutSettings);
+	static void OverrideConfig(UHConfigManager* InConfig, const UHBenchmarkSettings& InSettings);
+
+	bool Initialize();
+	void BeginFrame();
+	void EndFrame();
+	bool IsFinished() const;
+	bool WriteResults() const;
+
+private:
+	struct UHBenchmarkSeries
+	{
+		std::string Name;
+		std::vector<float> Samples;
+	};
+
+	void AddSample(std::vector<UHBenchmarkSeries>& InSeries, std::unordered_map<std::string, size_t>& InIndices
+		, const std::string& InName, float InValue);
+	void UpdateCamera();
+
+	UHEngine* Engine;
+	UHBenchmarkSettings Settings;
+	int32_t FrameIndex;
+	UHClock::time_point FrameBeginTime;
+
+	std::vector<UHBenchmarkSeries> Timings;
+	std::unordered_map<std::string, size_t> TimingIndices;
+	std::vector<UHBenchmarkSeries> Counters;
+	std::unordered_map<std::string, size_t> CounterIndices;
+};
@@ -42,10 +42,20 @@ void UHConfigManager::LoadConfig()
 		GET_UHE_SETTING(EngineSettings, FPSLimit);
 		GET_UHE_SETTING(EngineSettings, MeshBufferMemoryBudgetMB);
 		GET_UHE_SETTING(EngineSettings, ImageMemoryBudgetMB);
+		GET_UHE_SETTING(EngineSettings, StagingRingSizeMB);
+		GET_UHE_SETTING(EngineSettings, bEnableCPUTrace);
+		GET_UHE_SETTING(EngineSettings, CPUTraceCaptureFrames);
+		GET_UHE_SETTING(EngineSettings, bEnableDerivedDataCache);
+		GET_UHE_SETTING(EngineSettings, DerivedDataCacheSizeMB);
+		GET_UHE_SETTING(EngineSettings, DerivedDataRemotePath);
+		GET_UHE_SETTING(EngineSettings, bDerivedDataRemoteReadOnly);
 
 		// clamp a few parameters
 		EngineSettings.MeshBufferMemoryBudgetMB = std::clamp(EngineSettings.MeshBufferMemoryBudgetMB, 0.1f, std::numeric_limits<float>::max());
 		EngineSettings.ImageMemoryBudgetMB = std::clamp(EngineSettings.ImageMemoryBudgetMB, 256.0f, std::numeric_limits<float>::max());
+		EngineSettings.StagingRingSizeMB = std::clamp(EngineSettings.StagingRingSizeMB, 1.0f, 1024.0f);
+		EngineSettings.CPUTraceCaptureFrames = std::clamp(EngineSettings.CPUTraceCaptureFrames, 1, 10000);
+		EngineSettings.DerivedDataCacheSizeMB = std::max(EngineSettings.DerivedDataCacheSizeMB, 0.0f);
 	}
 
 	// rendering settings
@@ -53,11 +63,15 @@ void UHConfigManager::LoadConfig()
 		GET_UHE_SETTING(RenderingSettings, RenderWidth);
 		GET_UHE_SETTING(RenderingSettings, RenderHeight);
 		GET_UHE_SETTING(RenderingSettings, bTemporalAA);
+		GET_UHE_SETTING(RenderingSettings, bEnableTemporalUpscale);
+		GET_UHE_SETTING(RenderingSettings, TemporalUpscaleRatio);
 		GET_UHE_SETTING(RenderingSettings, bEnableRayTracing);
 		GET_UHE_SETTING(RenderingSettings, bEnableGPULabeling);
 		GET_UHE_SETTING(RenderingSettings, bEnableLayerValidation);
 		GET_UHE_SETTING(RenderingSettings, bEnableGPUTiming);
 		GET_UHE_SETTING(RenderingSettings, bEnableDepthPrePass);
+		GET_UHE_SETTING(RenderingSettings, bEnableVertexCompression);
+		GET_UHE_SETTING(RenderingSettings, bEnableVisibilityBuffer);
 		GET_UHE_SETTING(RenderingSettings, ParallelSubmitters);
 		GET_UHE_SETTING(RenderingSettings, RTCullingRadius);
 		GET_UHE_SETTING(RenderingSettings, RTShadowQuality);
@@ -67,7 +81,12 @@ void UHConfigManager::LoadConfig()
 		GET_UHE_SETTING(RenderingSettings, RTReflectionSmoothCutoff);
 		GET_UHE_SETTING(RenderingSettings, FinalReflectionStrength);
 		GET_UHE_SETTING(RenderingSettings, bDenoiseRayTracing);
+		GET_UHE_SETTING(RenderingSettings, bEnableRTAdaptiveRays);
+		GET_UHE_SETTING(RenderingSettings, RTRayBudgetMS);
+		GET_UHE_SETTING(RenderingSettings, bEnableRTResultCache);
 		GET_UHE_SETTING(RenderingSettings, bEnableAsyncCompute);
+		GET_UHE_SETTING(RenderingSettings, bAsyncRTShadow);
+		GET_UHE_SETTING(RenderingSettings, bAsyncRTIndirectLight);
 		GET_UHE_SETTING(RenderingSettings, bEnableHDR);
 		GET_UHE_SETTING(RenderingSettings, OcclusionTriangleThreshold);
 		GET_UHE_SETTING(RenderingSettings, HDRWhitePaperNits);
@@ -93,6 +112,8 @@ void UHConfigManager::LoadConfig()
 		RenderingSettings.RenderWidth = std::clamp(RenderingSettings.RenderWidth, 480, 16384);
 		RenderingSettings.RenderHeight = std::clamp(RenderingSettings.RenderHeight, 480, 16384);
 		RenderingSettings.ParallelSubmitters = std::clamp(RenderingSettings.ParallelSubmitters, 0, (int32_t)GMaxParallelSubmitters);
+		RenderingSettings.TemporalUpscaleRatio = std::clamp(RenderingSettings.TemporalUpscaleRatio, 0.5f, 1.0f);
+		RenderingSettings.RTRayBudgetMS = std::max(RenderingSettings.RTRayBudgetMS, 0.1f);
 
 		RenderingSettings.PCSSKernal = std::clamp(RenderingSettings.PCSSKernal, 1, 3);
 		RenderingSettings.PCSSMinPenumbra = std::max(RenderingSettings.PCSSMinPenumbra, 0.0f);
@@ -125,6 +146,13 @@ void UHConfigManager::ApplyConfig()
 		SET_UHE_SETTING(EngineSettings, FPSLimit);
 		SET_UHE_SETTING(EngineSettings, MeshBufferMemoryBudgetMB);
 		SET_UHE_SETTING(EngineSettings, ImageMemoryBudgetMB);
+		SET_UHE_SETTING(EngineSettings, StagingRingSizeMB);
+		SET_UHE_SETTING(EngineSettings, bEnableCPUTrace);
+		SET_UHE_SETTING(EngineSettings, CPUTraceCaptureFrames);
+		SET_UHE_SETTING(EngineSettings, bEnableDerivedDataCache);
+		SET_UHE_SETTING(EngineSettings, DerivedDataCacheSizeMB);
+		SET_UHE_SETTING(EngineSettings, DerivedDataRemotePath);
+		SET_UHE_SETTING(EngineSettings, bDerivedDataRemoteReadOnly);
 	}
 
 	// rendering settings
@@ -132,11 +160,15 @@ void UHConfigManager::ApplyConfig()
 		SET_UHE_SETTING(RenderingSettings, RenderWidth);
 		SET_UHE_SETTING(RenderingSettings, RenderHeight);
 		SET_UHE_SETTING(RenderingSettings, bTemporalAA);
+		SET_UHE_SETTING(RenderingSettings, bEnableTemporalUpscale);
+		SET_UHE_SETTING(RenderingSettings, TemporalUpscaleRatio);
 		SET_UHE_SETTING(RenderingSettings, bEnableRayTracing);
 		SET_UHE_SETTING(RenderingSettings, bEnableGPULabeling);
 		SET_UHE_SETTING(RenderingSettings, bEnableLayerValidation);
 		SET_UHE_SETTING(RenderingSettings, bEnableGPUTiming);
 		SET_UHE_SETTING(RenderingSettings, bEnableDepthPrePass);
+		SET_UHE_SETTING(RenderingSettings, bEnableVertexCompression);
+		SET_UHE_SETTING(RenderingSettings, bEnableVisibilityBuffer);
 		SET_UHE_SETTING(RenderingSettings, ParallelSubmitters);
 		SET_UHE_SETTING(RenderingSettings, RTCullingRadius);
 		SET_UHE_SETTING(RenderingSettings, RTShadowQuality);
@@ -146,7 +178,12 @@ void UHConfigManager::ApplyConfig()
 		SET_UHE_SETTING(RenderingSettings, RTReflectionSmoothCutoff);
 		SET_UHE_SETTING(RenderingSettings, FinalReflectionStrength);
 		SET_UHE_SETTING(RenderingSettings, bDenoiseRayTracing);
+		SET_UHE_SETTING(RenderingSettings, bEnableRTAdaptiveRays);
+		SET_UHE_SETTING(RenderingSettings, RTRayBudgetMS);
+		SET_UHE_SETTING(RenderingSettings, bEnableRTResultCache);
 		SET_UHE_SETTING(RenderingSettings, bEnableAsyncCompute);
+		SET_UHE_SETTING(RenderingSettings, bAsyncRTShadow);
+		SET_UHE_SETTING(RenderingSettings, bAsyncRTIndirectLight);
 		SET_UHE_SETTING(RenderingSettings, bEnableHDR);
 		SET_UHE_SETTING(RenderingSettings, OcclusionTriangleThreshold);
 		SET_UHE_SETTING(RenderingSettings, HDRWhitePaperNits);
@@ -216,6 +253,19 @@ void UHConfigManager::ApplyWindowStyle(UHClient* InClient)
 	InClient->SetWindowStyle(PresentationSettings.bFullScreen, PresentationSettings.WindowWidth, PresentationSettings.WindowHeight);
 }
 
+// scene rendering resolution, it's scaled down from render resolution when temporal upscaling is enabled
+void UHConfigManager::GetInternalResolution(int32_t& OutWidth, int32_t& OutHeight) const
+{
+	OutWidth = RenderingSettings.RenderWidth;
+	OutHeight = RenderingSettings.RenderHeight;
+
+	if (RenderingSettings.bEnableTemporalUpscale)
+	{
+		OutWidth = std::max(static_cast<int32_t>(OutWidth * RenderingSettings.TemporalUpscaleRatio), 1);
+		OutHeight = std::max(static_cast<int32_t>(OutHeight * RenderingSettings.TemporalUpscaleRatio), 1);
+	}
+}
+
 // toggle TAA
 void UHConfigManager::ToggleTAA()
 {
@@ -46,6 +46,8 @@ public:
 	// apply window style
 	void ApplyWindowStyle(UHClient* InClient);
 
+	void GetInternalResolution(int32_t& OutWidth, int32_t& OutHeight) const;
+
 	// toggle settings
 	void ToggleTAA();
 	void ToggleVsync();
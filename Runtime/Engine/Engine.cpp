@@ -3,6 +3,7 @@
 #include <string>
 #include "../CoreGlobals.h"
 #include "../Components/GameScript.h"
+#include "../Classes/DerivedDataCache.h"
 #include "Runtime/Platform/Client.h"
 
 #if WITH_EDITOR
@@ -13,6 +14,7 @@
 UHEngine::UHEngine()
 	: UHEClient(nullptr)
 	, bIsInitialized(false)
+	, bIsRenderingEnabled(true)
 	, EngineResizeReason(UHEngineResizeReason::NotResizing)
 	, FrameBeginTime(UHClock::time_point())
 	, FrameEndTime(UHClock::time_point())
@@ -66,6 +68,12 @@ bool UHEngine::InitEngine(UHClient* InClient)
 	GMainThreadID = std::this_thread::get_id();
 	GCurrentThreadID = GMainThreadID;
 
+	// cpu trace is a runtime flag, so it's available in shipping build as well
+	UHTraceProfiler::SetEnabled(UHEConfig->EngineSetting().bEnableCPUTrace);
+
+	// derived data is needed as soon as assets are imported
+	GDerivedDataCache.Initialize(UHEConfig->EngineSetting());
+
 	// init asset manager
 	UHEAsset = MakeUnique<UHAssetManager>();
 
@@ -138,7 +146,10 @@ bool UHEngine::InitEngine(UHClient* InClient)
 
 	// show window at the end of initialization
 	UHEConfig->ApplyPresentationSettings(UHEClient);
-	UHEConfig->ApplyWindowStyle(UHEClient);
+	if (!GIsHeadless)
+	{
+		UHEConfig->ApplyWindowStyle(UHEClient);
+	}
 
 	return true;
 }
@@ -148,6 +159,9 @@ void UHEngine::ReleaseEngine()
 	UH_SAFE_RELEASE(UHERenderer);
 	UHERenderer.reset();
 
+	UH_SAFE_RELEASE(UHECapture);
+	UHECapture.reset();
+
 	UH_SAFE_RELEASE(CurrentScene);
 
 	UHERawInput.reset();
@@ -163,6 +177,10 @@ void UHEngine::ReleaseEngine()
 
 	UH_SAFE_RELEASE(UHEGraphic);
 	UHEGraphic.reset();
+
+	// all threads are terminated at this point
+	GDerivedDataCache.Release();
+	UHTraceProfiler::Release();
 }
 
 bool UHEngine::IsEngineInitialized()
@@ -176,6 +194,7 @@ void UHEngine::Update()
 #if WITH_EDITOR
 	UHProfilerScope Profiler(&EngineUpdateProfile);
 #endif
+	UH_TRACE_SCOPE("EngineUpdate");
 
 	// timer tick
 	UHEGameTimer->Tick();
@@ -209,15 +228,18 @@ void UHEngine::Update()
 		SetResizeReason(UHEngineResizeReason::ToggleVsync);
 	}
 
-	// update scene
-	CurrentScene->Update();
-
-	// wait previous render task done before new updates for shipping build
-	if (GIsShipping)
+	// CPU trace capturing
+	if (UHERawInput->IsKeyHold(UH_ENUM_VALUE(UHSystemKey::Control)) && UHERawInput->IsKeyUp('p'))
 	{
-		UHERenderer->WaitPreviousRenderTask();
+		UHTraceProfiler::RequestCapture(UHEConfig->EngineSetting().CPUTraceCaptureFrames
+			, "CPUTrace_" + std::to_string(GFrameNumber) + ".json");
 	}
 
+	// update scene, render thread could still be recording the previous frame
+	// renderer inputs (visible lists, constants and TLAS instance states) are captured per frame slot by GT
+	// RT doesn't read the live components, GT syncs with render thread when handing over the frame
+	CurrentScene->Update();
+
 	if (EngineResizeReason != UHEngineResizeReason::NotResizing)
 	{
 		ResizeEngine();
@@ -253,13 +275,14 @@ void UHEngine::Update()
 // engine render loop
 void UHEngine::RenderLoop()
 {
-	if (EngineResizeReason == UHEngineResizeReason::NotResizing)
+	if (EngineResizeReason == UHEngineResizeReason::NotResizing && bIsRenderingEnabled)
 	{
 		UHERenderer->NotifyRenderThread();
 	}
 	
 	GFrameNumber++;
 	EngineResizeReason = UHEngineResizeReason::NotResizing;
+	UHTraceProfiler::EndFrame();
 }
 
 void UHEngine::ResizeEngine()
@@ -270,6 +293,12 @@ void UHEngine::ResizeEngine()
 	if (EngineResizeReason == UHEngineResizeReason::NewResolution)
 	{
 		UHERenderer->Resize();
+
+		// camera jitter must follow the new internal resolution and upscaler state
+		if (CurrentScene != nullptr)
+		{
+			CurrentScene->SyncCameraRenderResolution();
+		}
 	}
 
 	// sync the window size if it's window message
@@ -522,22 +551,65 @@ void UHEngine::EndProfile()
 	UHStatistics& Stats = UHEProfiler.GetStatistics();
 	Stats.EngineUpdateTime = EngineUpdateProfile.GetDiff() * 1000.0f;
 	Stats.RenderThreadTime = UHERenderer->GetRenderThreadTime();
+	Stats.FrameLatency = UHERenderer->GetFrameLatency();
+	Stats.FramesInFlight = UHERenderer->GetFramesInFlight();
 	Stats.TotalTime = UHEProfiler.GetDiff() * 1000.0f;
 
 	DisplayFPSTitle(Stats.TotalTime);
 
 	Stats.FPS = 1000.0f / AverageFrameTimeMS;
 	Stats.TotalTime = AverageFrameTimeMS;
-	Stats.RendererCount = CurrentScene ? static_cast<int32_t>(CurrentScene->GetAllRendererCount()) : 0;
-	Stats.DrawCallCount = UHERenderer->GetDrawCallCount();
-	Stats.OccludedCallCount = UHERenderer->GetOccludedCallCount();
-	Stats.PSOCount = static_cast<int32_t>(UHEGraphic->StatePools.size());
-	Stats.ShaderCount = static_cast<int32_t>(UHEGraphic->ShaderPools.size());
-	Stats.RTCount = static_cast<int32_t>(UHEGraphic->RTPools.size());
-	Stats.SamplerCount = static_cast<int32_t>(UHEGraphic->SamplerPools.size());
-	Stats.TextureCount = static_cast<int32_t>(UHEGraphic->Texture2DPools.size());
-	Stats.TextureCubeCount = static_cast<int32_t>(UHEGraphic->TextureCubePools.size());
-	Stats.MateralCount = static_cast<int32_t>(UHEGraphic->MaterialPools.size());
-}
-
-#endif
\ No newline at end of file
+	CollectStatistics(Stats);
+}
+
+#endif
+
+// collect the counters of statistics, time values are filled by profilers
+void UHEngine::CollectStatistics(UHStatistics& OutStats) const
+{
+	OutStats.RendererCount = CurrentScene ? static_cast<int32_t>(CurrentScene->GetAllRendererCount()) : 0;
+	OutStats.DrawCallCount = UHERenderer->GetDrawCallCount();
+	OutStats.OccludedCallCount = UHERenderer->GetOccludedCallCount();
+	OutStats.PSOCount = static_cast<int32_t>(UHEGraphic->StatePools.size());
+	OutStats.ShaderCount = static_cast<int32_t>(UHEGraphic->ShaderPools.size());
+	OutStats.RTCount = static_cast<int32_t>(UHEGraphic->RTPools.size());
+	OutStats.SamplerCount = static_cast<int32_t>(UHEGraphic->SamplerPools.size());
+	OutStats.TextureCount = static_cast<int32_t>(UHEGraphic->Texture2DPools.size());
+	OutStats.TextureCubeCount = static_cast<int32_t>(UHEGraphic->TextureCubePools.size());
+	OutStats.MateralCount = static_cast<int32_t>(UHEGraphic->MaterialPools.size());
+	OutStats.GeometryBandwidthMB = UHERenderer->GetGeometryBandwidthMB();
+}
+
+void UHEngine::SetRenderingEnabled(bool bInFlag)
+{
+	bIsRenderingEnabled = bInFlag;
+}
+
+bool UHEngine::InitOffscreenCapture(const UHOffscreenCaptureSettings& InSettings)
+{
+	if (!GIsOffscreen)
+	{
+		UHE_LOG("Frame capture is only available in offscreen mode!\n");
+		return false;
+	}
+
+	VkExtent2D Extent;
+	Extent.width = static_cast<uint32_t>(UHEConfig->RenderingSetting().RenderWidth);
+	Extent.height = static_cast<uint32_t>(UHEConfig->RenderingSetting().RenderHeight);
+
+	UHECapture = MakeUnique<UHOffscreenCapture>();
+	UHECapture->SetGfxCache(UHEGraphic.get());
+	if (!UHECapture->Initialize(InSettings, Extent))
+	{
+		UHECapture.reset();
+		return false;
+	}
+
+	UHERenderer->SetOffscreenCapture(UHECapture.get());
+	return true;
+}
+
+UHOffscreenCapture* UHEngine::GetOffscreenCapture() const
+{
+	return UHECapture.get();
+}
\ No newline at end of file
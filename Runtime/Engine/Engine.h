@@ -5,6 +5,8 @@
 #include "Graphic.h"
 #include "Runtime/Platform/PlatformInput.h"
 #include "GameTimer.h"
+#include "TraceProfiler.h"
+#include "Statistics.h"
 #include "Asset.h"
 #include "../Renderer/DeferredShadingRenderer.h"
 #include "../Classes/Scene.h"
@@ -80,6 +82,16 @@ public:
 	void OnSaveScene(std::filesystem::path OutputPath);
 	void OnLoadScene(std::filesystem::path InputPath);
 
+	// statistics counters, available in all builds
+	void CollectStatistics(UHStatistics& OutStats) const;
+
+	// rendering can be stubbed out, e.g. CPU-only benchmark, the update still runs as usual
+	void SetRenderingEnabled(bool bInFlag);
+
+	// offscreen mode only, read back the rendered frames at render resolution
+	bool InitOffscreenCapture(const UHOffscreenCaptureSettings& InSettings);
+	UHOffscreenCapture* GetOffscreenCapture() const;
+
 #if WITH_EDITOR
 	UHEditor* GetEditor() const;
 
@@ -113,6 +125,9 @@ private:
 	// renderer class
 	UniquePtr<UHDeferredShadingRenderer> UHERenderer;
 
+	// offscreen frame capture
+	UniquePtr<UHOffscreenCapture> UHECapture;
+
 #if WITH_EDITOR
 	// editor class
 	UniquePtr<UHEditor> UHEEditor;
@@ -127,6 +142,7 @@ private:
 
 	// a flag which tells if the engine is initialized
 	bool bIsInitialized;
+	bool bIsRenderingEnabled;
 
 	// resize reason
 	UHEngineResizeReason EngineResizeReason;
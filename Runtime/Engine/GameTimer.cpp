@@ -2,13 +2,10 @@
 #include "framework.h"
 #include "UnheardEngine.h"
 
-#if WITH_EDITOR
-std::mutex GTimeScopeLock;
-std::vector<std::pair<std::string, float>> UHGameTimerScope::RegisteredGameTime;
-#endif
-
 UHGameTimer::UHGameTimer()
 	: DeltaTime(0.0)
+	, FixedDeltaTime(0.0)
+	, FixedTotalTime(0.0)
 	, BaseTimePoint(UHClock::time_point())
 	, PausedTimePoint(UHClock::time_point())
 	, StopTimePoint(UHClock::time_point())
@@ -23,6 +20,11 @@ UHGameTimer::UHGameTimer()
 // time when the clock is stopped.
 float UHGameTimer::GetTotalTime() const
 {
+	if (FixedDeltaTime > 0.0)
+	{
+		return static_cast<float>(FixedTotalTime);
+	}
+
 	if (bStopped)
 	{
 		auto D0 = StopTimePoint - PausedTimePoint;
@@ -87,6 +89,14 @@ void UHGameTimer::Tick()
 
 	CurrentTimePoint = UHClock::now();
 
+	if (FixedDeltaTime > 0.0)
+	{
+		DeltaTime = FixedDeltaTime;
+		FixedTotalTime += FixedDeltaTime;
+		PreviousTimePoint = CurrentTimePoint;
+		return;
+	}
+
 	// Time difference between this frame and the previous.
 	DeltaTime = std::chrono::duration<double>(CurrentTimePoint - PreviousTimePoint).count();
 
@@ -108,6 +118,12 @@ void UHGameTimer::Tick()
 	}
 }
 
+void UHGameTimer::SetFixedDeltaTime(double InDeltaTime)
+{
+	FixedDeltaTime = (std::max)(InDeltaTime, 0.0);
+	FixedTotalTime = 0.0;
+}
+
 // UHGameTimerScope
 UHGameTimerScope::UHGameTimerScope(std::string InName, bool bPrintTimeAfterStop)
 {
@@ -129,22 +145,5 @@ UHGameTimerScope::~UHGameTimerScope()
 	{
 		UHE_LOG(Name + " takes " + std::to_string(TotalTime) + " ms.\n");
 	}
-
-	std::unique_lock<std::mutex> Lock(GTimeScopeLock);
-	RegisteredGameTime.push_back(std::make_pair(Name, TotalTime));
 #endif
-}
-
-#if WITH_EDITOR
-const std::vector<std::pair<std::string, float>>& UHGameTimerScope::GetResiteredGameTime()
-{
-	std::unique_lock<std::mutex> Lock(GTimeScopeLock);
-	return RegisteredGameTime;
-}
-
-void UHGameTimerScope::ClearRegisteredGameTime()
-{
-	std::unique_lock<std::mutex> Lock(GTimeScopeLock);
-	RegisteredGameTime.clear();
-}
-#endif
\ No newline at end of file
+}
\ No newline at end of file
@@ -22,8 +22,13 @@ public:
 	void Stop();  // Call when paused.
 	void Tick();  // Call every frame.
 
+	// fixed timestep for deterministic update, e.g. benchmark. 0 to use the real time
+	void SetFixedDeltaTime(double InDeltaTime);
+
 private:
 	double DeltaTime;
+	double FixedDeltaTime;
+	double FixedTotalTime;
 
 	UHClock::time_point BaseTimePoint;
 	UHClock::time_point PausedTimePoint;
@@ -34,7 +39,8 @@ private:
 	bool bStopped;
 };
 
-// simple scoped timer
+// simple scoped timer which prints the time after stop, editor only
+// use UH_TRACE_SCOPE in TraceProfiler.h for per-frame profiling
 class UHGameTimerScope : public UHGameTimer
 {
 public:
@@ -42,14 +48,8 @@ public:
 	~UHGameTimerScope();
 
 #if WITH_EDITOR
-	static const std::vector<std::pair<std::string, float>>& GetResiteredGameTime();
-	static void ClearRegisteredGameTime();
-
 private:
 	bool bPrintTimeAfterStop;
 	std::string Name;
-
-	// editor only registered game time, which will be displayed in profile
-	static std::vector<std::pair<std::string, float>> RegisteredGameTime;
 #endif
 };
\ No newline at end of file
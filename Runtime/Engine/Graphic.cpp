@@ -9,6 +9,7 @@
 
 UHGraphic::UHGraphic(UHAssetManager* InAssetManager, UHConfigManager* InConfig)
 	: GraphicsQueue(nullptr)
+	, TransferQueue(nullptr)
 	, CreationCommandPool(nullptr)
 	, LogicalDevice(nullptr)
 	, SwapChainRenderPass(nullptr)
@@ -24,15 +25,21 @@ UHGraphic::UHGraphic(UHAssetManager* InAssetManager, UHConfigManager* InConfig)
 	, ConfigInterface(InConfig)
 	, bEnableDepthPrePass(InConfig->RenderingSetting().bEnableDepthPrePass)
 	, bEnableRayTracing(InConfig->RenderingSetting().bEnableRayTracing)
+	, bEnableVertexCompression(InConfig->RenderingSetting().bEnableVertexCompression)
+	, bEnableVisibilityBuffer(false)
 	, bSupportHDR(false)
 	, bSupport24BitDepth(true)
 	, bSupportMeshShader(false)
 	, bSupportWaveOperation(false)
+	, bSupportTraceRaysIndirect(false)
 	, MeshBufferSharedMemory(nullptr)
 	, ImageSharedMemory(nullptr)
+	, StagingRing(nullptr)
+	, DescriptorAllocator(nullptr)
 	, GPUTimeStampPeriod(0.0f)
 	, HostMemoryTypeIndex(0)
 	, ShaderRecordSize(0)
+	, MinASScratchOffsetAlignment(1)
 #if WITH_EDITOR
 	, ImGuiDescriptorPool(nullptr)
 	, ImGuiPipeline(nullptr)
@@ -91,12 +98,32 @@ bool UHGraphic::InitGraphics(UHClient* InClient)
 	#endif
 	ClientCache = InClient;
 
+	if (GIsOffscreen)
+	{
+		// there is no window surface in offscreen mode, strip the surface and swap chain extensions
+		// so a device without presentation support (e.g. a software ICD on a render server) is still accepted
+		const std::vector<std::string> PresentExtensions = { "VK_KHR_surface"
+			, "VK_KHR_get_surface_capabilities2"
+			, "VK_EXT_swapchain_colorspace"
+			, "VK_KHR_win32_surface"
+			, "VK_KHR_xcb_surface"
+			, VK_KHR_SWAPCHAIN_EXTENSION_NAME
+			, "VK_EXT_full_screen_exclusive" };
+
+		auto IsPresentExtension = [&PresentExtensions](const char* InName)
+			{
+				return std::find(PresentExtensions.begin(), PresentExtensions.end(), InName) != PresentExtensions.end();
+			};
+		InstanceExtensions.erase(std::remove_if(InstanceExtensions.begin(), InstanceExtensions.end(), IsPresentExtension), InstanceExtensions.end());
+		DeviceExtensions.erase(std::remove_if(DeviceExtensions.begin(), DeviceExtensions.end(), IsPresentExtension), DeviceExtensions.end());
+	}
+
 	bool bInitSuccess = CreateInstance()
 		&& CreatePhysicalDevice()
-		&& CreateWindowSurface()
+		&& (GIsOffscreen || CreateWindowSurface())
 		&& CreateQueueFamily()
 		&& CreateLogicalDevice()
-		&& CreateSwapChain();
+		&& (GIsOffscreen ? CreateOffscreenTargets() : CreateSwapChain());
 
 	if (bInitSuccess)
 	{
@@ -112,7 +139,17 @@ bool UHGraphic::InitGraphics(UHClient* InClient)
 
 		// use the first heap for shared image memory anyway, it's rare to have multiple heaps from a single GPU
 		ImageSharedMemory->AllocateMemory(static_cast<uint64_t>(ConfigInterface->EngineSetting().ImageMemoryBudgetMB) * 1048576, DeviceMemoryTypeIndices[0]);
-		MeshBufferSharedMemory->AllocateMemory(static_cast<uint64_t>(ConfigInterface->EngineSetting().MeshBufferMemoryBudgetMB) * 1048576, HostMemoryTypeIndex);
+		MeshBufferSharedMemory->AllocateMemory(static_cast<uint64_t>(ConfigInterface->EngineSetting().MeshBufferMemoryBudgetMB) * 1048576, DeviceMemoryTypeIndices[0]);
+
+		// static buffers in mesh memory are filled by the staging ring, host visible memory is for dynamic data only
+		StagingRing = MakeUnique<UHStagingRing>();
+		StagingRing->SetGfxCache(this);
+		bInitSuccess = StagingRing->CreateStagingRing(static_cast<uint64_t>(ConfigInterface->EngineSetting().StagingRingSizeMB) * 1048576
+			, TransferQueue, QueueFamily.TransferFamily.value());
+
+		// descriptor sets of all shaders are allocated from shared pages
+		DescriptorAllocator = MakeUnique<UHDescriptorAllocator>();
+		DescriptorAllocator->SetGfxCache(this);
 
 		// reserve pools for faster allocation
 		ShaderPools.reserve(std::numeric_limits<int16_t>::max());
@@ -136,6 +173,7 @@ void UHGraphic::Release()
 
 	ClientCache = nullptr;
 	GraphicsQueue = nullptr;
+	TransferQueue = nullptr;
 
 	// release all shaders
 	ClearContainer(ShaderPools);
@@ -169,6 +207,10 @@ void UHGraphic::Release()
 	ImageSharedMemory.reset();
 	UH_SAFE_RELEASE(MeshBufferSharedMemory);
 	MeshBufferSharedMemory.reset();
+	UH_SAFE_RELEASE(StagingRing);
+	StagingRing.reset();
+	UH_SAFE_RELEASE(DescriptorAllocator);
+	DescriptorAllocator.reset();
 
 #if WITH_EDITOR
 	ImGui_ImplVulkan_Shutdown();
@@ -315,8 +357,11 @@ bool UHGraphic::CreateInstance()
 	GVkCreateAccelerationStructureKHR = (PFN_vkCreateAccelerationStructureKHR)vkGetInstanceProcAddr(VulkanInstance, "vkCreateAccelerationStructureKHR");
 	GVkCmdBuildAccelerationStructuresKHR = (PFN_vkCmdBuildAccelerationStructuresKHR)vkGetInstanceProcAddr(VulkanInstance, "vkCmdBuildAccelerationStructuresKHR");
 	GVkDestroyAccelerationStructureKHR = (PFN_vkDestroyAccelerationStructureKHR)vkGetInstanceProcAddr(VulkanInstance, "vkDestroyAccelerationStructureKHR");
+	GVkCmdWriteAccelerationStructuresPropertiesKHR = (PFN_vkCmdWriteAccelerationStructuresPropertiesKHR)vkGetInstanceProcAddr(VulkanInstance, "vkCmdWriteAccelerationStructuresPropertiesKHR");
+	GVkCmdCopyAccelerationStructureKHR = (PFN_vkCmdCopyAccelerationStructureKHR)vkGetInstanceProcAddr(VulkanInstance, "vkCmdCopyAccelerationStructureKHR");
 	GVkCreateRayTracingPipelinesKHR = (PFN_vkCreateRayTracingPipelinesKHR)vkGetInstanceProcAddr(VulkanInstance, "vkCreateRayTracingPipelinesKHR");
 	GVkCmdTraceRaysKHR = (PFN_vkCmdTraceRaysKHR)vkGetInstanceProcAddr(VulkanInstance, "vkCmdTraceRaysKHR");
+	GVkCmdTraceRaysIndirectKHR = (PFN_vkCmdTraceRaysIndirectKHR)vkGetInstanceProcAddr(VulkanInstance, "vkCmdTraceRaysIndirectKHR");
 	GVkGetRayTracingShaderGroupHandlesKHR = (PFN_vkGetRayTracingShaderGroupHandlesKHR)vkGetInstanceProcAddr(VulkanInstance, "vkGetRayTracingShaderGroupHandlesKHR");
 	GVkCmdPushDescriptorSetKHR = (PFN_vkCmdPushDescriptorSetKHR)vkGetInstanceProcAddr(VulkanInstance, "vkCmdPushDescriptorSetKHR");
 	GVkCmdBeginConditionalRenderingEXT = (PFN_vkCmdBeginConditionalRenderingEXT)vkGetInstanceProcAddr(VulkanInstance, "vkCmdBeginConditionalRenderingEXT");
@@ -459,14 +504,17 @@ bool UHGraphic::CreateQueueFamily()
 	// choose queue family, find both graphic queue and compute queue for now
 	for (uint32_t Idx = 0; Idx < QueueFamilyCount; Idx++)
 	{
-		// consider present support
-		VkBool32 PresentSupport = false;
-		vkGetPhysicalDeviceSurfaceSupportKHR(PhysicalDevice, Idx, MainSurface, &PresentSupport);
+		// consider present support, offscreen mode never presents
+		VkBool32 PresentSupport = GIsOffscreen;
+		bool SwapChainAdequate = GIsOffscreen;
+		if (!GIsOffscreen)
+		{
+			vkGetPhysicalDeviceSurfaceSupportKHR(PhysicalDevice, Idx, MainSurface, &PresentSupport);
 
-		// consider swap chain support
-		bool SwapChainAdequate = false;
-		UHSwapChainDetails SwapChainSupport = QuerySwapChainSupport(PhysicalDevice);
-		SwapChainAdequate = !SwapChainSupport.Formats2.empty() && !SwapChainSupport.PresentModes.empty();
+			// consider swap chain support
+			UHSwapChainDetails SwapChainSupport = QuerySwapChainSupport(PhysicalDevice);
+			SwapChainAdequate = !SwapChainSupport.Formats2.empty() && !SwapChainSupport.PresentModes.empty();
+		}
 
 		if (PresentSupport && SwapChainAdequate)
 		{
@@ -493,6 +541,45 @@ bool UHGraphic::CreateQueueFamily()
 		return false;
 	}
 
+	// find a dedicated transfer queue (DMA engine) for staging uploads, fallback to graphic queue if there isn't one
+	for (uint32_t Idx = 0; Idx < QueueFamilyCount; Idx++)
+	{
+		const VkQueueFlags Flags = QueueFamilies[Idx].queueFlags;
+		if ((Flags & VK_QUEUE_TRANSFER_BIT) && !(Flags & VK_QUEUE_GRAPHICS_BIT) && !(Flags & VK_QUEUE_COMPUTE_BIT))
+		{
+			QueueFamily.TransferFamily = Idx;
+			break;
+		}
+	}
+
+	if (!QueueFamily.TransferFamily.has_value())
+	{
+		QueueFamily.TransferFamily = QueueFamily.GraphicsFamily;
+	}
+
+	// static buffers are shared between graphic, transfer and async compute queue, RT passes on async compute read them as well
+	StagingQueueFamilies = { QueueFamily.GraphicsFamily.value() };
+	for (const uint32_t Family : { QueueFamily.TransferFamily.value(), QueueFamily.ComputesFamily.value() })
+	{
+		if (std::find(StagingQueueFamilies.begin(), StagingQueueFamilies.end(), Family) == StagingQueueFamilies.end())
+		{
+			StagingQueueFamilies.push_back(Family);
+		}
+	}
+
+	// a single family doesn't need concurrent sharing
+	if (StagingQueueFamilies.size() == 1)
+	{
+		StagingQueueFamilies.clear();
+	}
+
+	// textures read by both graphic and async compute queue can be shared instead of transferring ownership
+	ComputeQueueFamilies.clear();
+	if (QueueFamily.ComputesFamily.value() != QueueFamily.GraphicsFamily.value())
+	{
+		ComputeQueueFamilies = { QueueFamily.GraphicsFamily.value(), QueueFamily.ComputesFamily.value() };
+	}
+
 	return true;
 }
 
@@ -515,6 +602,17 @@ bool UHGraphic::CreateLogicalDevice()
 
 	std::vector<VkDeviceQueueCreateInfo> QueueCreateInfo = { GraphicQueueCreateInfo, ComputeQueueCreateInfo };
 
+	// transfer queue, only when there is a dedicated family
+	if (QueueFamily.TransferFamily.value() != QueueFamily.GraphicsFamily.value())
+	{
+		VkDeviceQueueCreateInfo TransferQueueCreateInfo{};
+		TransferQueueCreateInfo.sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
+		TransferQueueCreateInfo.queueFamilyIndex = QueueFamily.TransferFamily.value();
+		TransferQueueCreateInfo.queueCount = 1;
+		TransferQueueCreateInfo.pQueuePriorities = &QueuePriority;
+		QueueCreateInfo.push_back(TransferQueueCreateInfo);
+	}
+
 	// define features, enable what I need in UH
 	VkPhysicalDeviceFeatures DeviceFeatures{};
 	DeviceFeatures.samplerAnisotropy = true;
@@ -573,19 +671,41 @@ bool UHGraphic::CreateLogicalDevice()
 			bEnableRayTracing = false;
 		}
 
+		// RT passes trace the tiles listed by GPU classification, the ray count is read from an indirect buffer
+		bSupportTraceRaysIndirect = bEnableRayTracing && RTFeatures.rayTracingPipelineTraceRaysIndirect;
+
 		// check 24-bit depth format
 		VkFormatProperties FormatProps{};
 		vkGetPhysicalDeviceFormatProperties(PhysicalDevice, VK_FORMAT_X8_D24_UNORM_PACK32, &FormatProps);
 		bSupport24BitDepth = FormatProps.optimalTilingFeatures & VK_FORMAT_FEATURE_DEPTH_STENCIL_ATTACHMENT_BIT;
 
 		// mesh shader support, disable others usage for now
-		bSupportMeshShader = MeshShaderFeatures.meshShader;
+		// amplification shader is required for meshlet culling
+		bSupportMeshShader = MeshShaderFeatures.meshShader && MeshShaderFeatures.taskShader;
 		MeshShaderFeatures.multiviewMeshShader = false;
 		MeshShaderFeatures.primitiveFragmentShadingRateMeshShader = false;
 
+		// visibility buffer is built on the mesh shader data, and the IDs are output in depth prepass
+		// the triangle ID is read as SV_PrimitiveID in pixel shader, which needs geometry shader feature
+		if (ConfigInterface->RenderingSetting().bEnableVisibilityBuffer)
+		{
+			bEnableVisibilityBuffer = bSupportMeshShader && PhyFeatures.features.geometryShader;
+			if (bEnableVisibilityBuffer)
+			{
+				bEnableDepthPrePass = true;
+			}
+			else
+			{
+				UHE_LOG("Visibility buffer requires mesh shader and geometry shader support. System will render with base pass instead.\n");
+			}
+		}
+
 		// enable wave operation
 		Vk12Features.shaderSubgroupExtendedTypes = true;
 
+		// timeline semaphore for staging upload completion
+		Vk12Features.timelineSemaphore = true;
+
 		// enable v2 synchronization
 		VK13Features.synchronization2 = true;
 	}
@@ -599,6 +719,11 @@ bool UHGraphic::CreateLogicalDevice()
 	MeshPropsFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MESH_SHADER_PROPERTIES_EXT;
 	RTPropsFeatures.pNext = &MeshPropsFeatures;
 
+	// get acceleration structure props
+	VkPhysicalDeviceAccelerationStructurePropertiesKHR ASProps{};
+	ASProps.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_ACCELERATION_STRUCTURE_PROPERTIES_KHR;
+	MeshPropsFeatures.pNext = &ASProps;
+
 	// get wave operation props
 	VkPhysicalDeviceSubgroupProperties SubgroupProps{};
 	SubgroupProps.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SUBGROUP_PROPERTIES;
@@ -610,6 +735,7 @@ bool UHGraphic::CreateLogicalDevice()
 
 	vkGetPhysicalDeviceProperties2(PhysicalDevice, &Props2);
 	ShaderRecordSize = RTPropsFeatures.shaderGroupHandleSize;
+	MinASScratchOffsetAlignment = (std::max)(ASProps.minAccelerationStructureScratchOffsetAlignment, 1U);
 	GPUTimeStampPeriod = Props2.properties.limits.timestampPeriod;
 	bSupportWaveOperation = (SubgroupProps.supportedOperations & VK_SUBGROUP_FEATURE_ARITHMETIC_BIT) && (SubgroupProps.supportedStages & VK_SHADER_STAGE_COMPUTE_BIT);
 
@@ -653,6 +779,7 @@ bool UHGraphic::CreateLogicalDevice()
 
 	// finally, get both graphics and computes queue
 	vkGetDeviceQueue(LogicalDevice, QueueFamily.GraphicsFamily.value(), 0, &GraphicsQueue);
+	vkGetDeviceQueue(LogicalDevice, QueueFamily.TransferFamily.value(), 0, &TransferQueue);
 
 	if (!bSupportMeshShader)
 	{
@@ -821,6 +948,9 @@ void UHGraphic::ClearSwapChain()
 		SafeDestroyFrameBuffer(LogicalDevice, SwapChainFrameBuffer[Idx]);
 	}
 
+	// callers have waited GPU, views of swap chain images must be gone before the swap chain
+	DeletionQueue.Flush();
+
 	SafeDestroyRenderPass(LogicalDevice, SwapChainRenderPass);
 	SafeDestroySwapchain(LogicalDevice, SwapChain);
 	SwapChainRT.clear();
@@ -833,7 +963,7 @@ bool UHGraphic::ResizeSwapChain()
 	WaitGPU();
 	ClearSwapChain();
 
-	return CreateSwapChain();
+	return GIsOffscreen ? CreateOffscreenTargets() : CreateSwapChain();
 }
 
 void UHGraphic::ToggleFullScreen(bool InFullScreenState)
@@ -850,7 +980,40 @@ void UHGraphic::ToggleFullScreen(bool InFullScreenState)
 
 void UHGraphic::WaitGPU()
 {
+	WaitRenderThread();
 	SafeDeviceWaitIdle(LogicalDevice);
+	DeletionQueue.Flush();
+}
+
+void UHGraphic::SetRenderThreadWait(std::function<void()> InWaitFunc)
+{
+	RenderThreadWaitFunc = std::move(InWaitFunc);
+}
+
+void UHGraphic::WaitRenderThread()
+{
+	// render thread can't wait itself
+	if (RenderThreadWaitFunc && !IsInRenderThread())
+	{
+		RenderThreadWaitFunc();
+	}
+}
+
+void UHGraphic::RequestDeferredRelease(std::function<void()> InReleaseFunc)
+{
+	// the frame being recorded could still reference the resource, retire it after the whole frame is submitted
+	// a frame could signal the timeline several times (e.g. graph batches), so the value is assigned at the final signal
+	DeletionQueue.Enqueue(std::move(InReleaseFunc));
+}
+
+void UHGraphic::SetFrameSubmittedValue(uint64_t InValue)
+{
+	DeletionQueue.AssignRetireValue(InValue);
+}
+
+void UHGraphic::ProcessDeferredReleases(uint64_t InCompletedValue)
+{
+	DeletionQueue.Process(InCompletedValue);
 }
 
 // create render pass, imageless
@@ -1055,9 +1218,14 @@ void UHGraphic::RequestReleaseGPUQuery(UHGPUQuery* InQuery)
 		return;
 	}
 
-	QueryPools[Idx]->Release();
-	QueryPools[Idx].reset();
+	// in-flight frames could still write to the query, release it after they're done
+	UHGPUQuery* RetiredQuery = QueryPools[Idx].release();
 	UHUtilities::RemoveByIndex(QueryPools, Idx);
+	RequestDeferredRelease([RetiredQuery]()
+		{
+			RetiredQuery->Release();
+			delete RetiredQuery;
+		});
 }
 
 // request render texture, this also sets device info to it
@@ -1098,9 +1266,22 @@ void UHGraphic::RequestReleaseRT(UHRenderTexture* InRT)
 		return;
 	}
 
-	RTPools[Idx]->Release();
-	RTPools[Idx].reset();
+	// remove from the pool now so a new request won't get it, but release after in-flight frames are done
+	UHRenderTexture* RetiredRT = RTPools[Idx].release();
 	UHUtilities::RemoveByIndex(RTPools, Idx);
+	RequestDeferredRelease([RetiredRT]()
+		{
+			RetiredRT->Release();
+			delete RetiredRT;
+		});
+}
+
+VkMemoryRequirements UHGraphic::GetRenderTextureMemoryRequirements(std::string InName, VkExtent2D InExtent
+	, UHTextureFormat InFormat, UHRenderTextureSettings InRTSettings)
+{
+	UHRenderTexture TempRT(InName, InExtent, InFormat, InRTSettings);
+	TempRT.SetGfxCache(this);
+	return TempRT.GetRTMemoryRequirements();
 }
 
 UHTexture2D* UHGraphic::RequestTexture2D(UniquePtr<UHTexture2D>& LoadedTex, bool bUseSharedMemory)
@@ -1131,10 +1312,14 @@ void UHGraphic::RequestReleaseTexture2D(UHTexture2D* InTex)
 		return;
 	}
 
-	Texture2DPools[Idx]->ReleaseCPUTextureData();
-	Texture2DPools[Idx]->Release();
-	Texture2DPools[Idx].reset();
+	UHTexture2D* RetiredTex = Texture2DPools[Idx].release();
 	UHUtilities::RemoveByIndex(Texture2DPools, Idx);
+	RetiredTex->ReleaseCPUTextureData();
+	RequestDeferredRelease([RetiredTex]()
+		{
+			RetiredTex->Release();
+			delete RetiredTex;
+		});
 }
 
 bool AreTextureSliceConsistent(std::string InArrayName, std::vector<UHTexture2D*> InTextures)
@@ -1236,10 +1421,14 @@ void UHGraphic::RequestReleaseTextureCube(UHTextureCube* InCube)
 		return;
 	}
 
-	TextureCubePools[Idx]->ReleaseCPUData();
-	TextureCubePools[Idx]->Release();
-	TextureCubePools[Idx].reset();
+	UHTextureCube* RetiredCube = TextureCubePools[Idx].release();
 	UHUtilities::RemoveByIndex(TextureCubePools, Idx);
+	RetiredCube->ReleaseCPUData();
+	RequestDeferredRelease([RetiredCube]()
+		{
+			RetiredCube->Release();
+			delete RetiredCube;
+		});
 }
 
 // request material without any import
@@ -1360,6 +1549,8 @@ uint32_t UHGraphic::RequestMaterialShader(std::string InShaderName, std::filesys
 	size_t MacroHash = UHUtilities::ShaderDefinesToHash(InMacro);
 	std::string MacroHashName = (MacroHash != 0) ? "_" + std::to_string(MacroHash) : "";
 
+	// material instances share the shaders of parent, request with parent so it's found in the pool without compiling
+	InData.MaterialCache = InData.MaterialCache->GetShaderMaterial();
 	UHMaterial* InMat = InData.MaterialCache;
 	const std::string OriginSubpath = UHAssetPath::GetMaterialOriginSubpath(InData.MaterialCache->GetPath());
 	std::string OutName = UHAssetPath::FormatMaterialShaderOutputPath("", InData.MaterialCache->GetSourcePath(), InShaderName, MacroHashName);
@@ -1399,9 +1590,13 @@ void UHGraphic::RequestReleaseShader(uint32_t InShaderID)
 		int32_t Idx = UHUtilities::FindIndex(ShaderPools, *InShader);
 		if (Idx != UHINDEXNONE)
 		{
-			ShaderPools[Idx]->Release();
-			ShaderPools[Idx].reset();
+			UHShader* RetiredShader = ShaderPools[Idx].release();
 			UHUtilities::RemoveByIndex(ShaderPools, Idx);
+			RequestDeferredRelease([RetiredShader]()
+				{
+					RetiredShader->Release();
+					delete RetiredShader;
+				});
 		}
 	}
 }
@@ -1448,9 +1643,14 @@ void UHGraphic::RequestReleaseGraphicState(UHGraphicState* InState)
 		InState->DecreaseRefCount();
 		if (InState->GetRefCount() == 0)
 		{
-			StatePools[Idx]->Release();
-			StatePools[Idx].reset();
+			// pipelines could be bound by in-flight frames
+			UHGraphicState* RetiredState = StatePools[Idx].release();
 			UHUtilities::RemoveByIndex(StatePools, Idx);
+			RequestDeferredRelease([RetiredState]()
+				{
+					RetiredState->Release();
+					delete RetiredState;
+				});
 		}
 	}
 }
@@ -1597,11 +1797,26 @@ float UHGraphic::GetGPUTimeStampPeriod() const
 	return GPUTimeStampPeriod;
 }
 
+uint32_t UHGraphic::GetMinASScratchOffsetAlignment() const
+{
+	return MinASScratchOffsetAlignment;
+}
+
 bool UHGraphic::IsDepthPrePassEnabled() const
 {
 	return bEnableDepthPrePass;
 }
 
+bool UHGraphic::IsVertexCompressionEnabled() const
+{
+	return bEnableVertexCompression;
+}
+
+bool UHGraphic::IsVisibilityBufferEnabled() const
+{
+	return bEnableVisibilityBuffer;
+}
+
 bool UHGraphic::IsRayTracingEnabled() const
 {
 	return bEnableRayTracing;
@@ -1632,6 +1847,11 @@ bool UHGraphic::IsWaveOperationSupported() const
 	return bSupportWaveOperation;
 }
 
+bool UHGraphic::IsTraceRaysIndirectSupported() const
+{
+	return bSupportTraceRaysIndirect;
+}
+
 std::vector<UHSampler*> UHGraphic::GetSamplers() const
 {
 	std::vector<UHSampler*> Samplers(SamplerPools.size());
@@ -1653,6 +1873,26 @@ UHGPUMemory* UHGraphic::GetImageSharedMemory() const
 	return ImageSharedMemory.get();
 }
 
+UHStagingRing* UHGraphic::GetStagingRing() const
+{
+	return StagingRing.get();
+}
+
+UHDescriptorAllocator* UHGraphic::GetDescriptorAllocator() const
+{
+	return DescriptorAllocator.get();
+}
+
+const std::vector<uint32_t>& UHGraphic::GetStagingQueueFamilies() const
+{
+	return StagingQueueFamilies;
+}
+
+const std::vector<uint32_t>& UHGraphic::GetComputeQueueFamilies() const
+{
+	return ComputeQueueFamilies;
+}
+
 void UHGraphic::BeginCmdDebug(VkCommandBuffer InBuffer, std::string InName)
 {
 #if WITH_EDITOR
@@ -1716,7 +1956,9 @@ VkCommandBuffer UHGraphic::BeginOneTimeCmd()
 void UHGraphic::EndOneTimeCmd(VkCommandBuffer InBuffer)
 {
 	// end the one time cmd and submit it to GPU
+	// graphics queue is also used by render thread which is no longer synced every frame, wait it before submitting
 	vkEndCommandBuffer(InBuffer);
+	WaitRenderThread();
 
 	VkSubmitInfo SubmitInfo{};
 	SubmitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
@@ -1736,6 +1978,11 @@ VkQueue UHGraphic::GetGraphicsQueue() const
 	return GraphicsQueue;
 }
 
+VkQueue UHGraphic::GetTransferQueue() const
+{
+	return TransferQueue;
+}
+
 std::vector<uint32_t> UHGraphic::GetDeviceMemoryTypeIndices() const
 {
 	return DeviceMemoryTypeIndices;
@@ -2009,6 +2256,37 @@ bool UHGraphic::CreateSwapChain()
 	return true;
 }
 
+bool UHGraphic::CreateOffscreenTargets()
+{
+	// one target per frame in flight, they're sized as the render resolution and never presented
+	// the image index is simply the frame index, so there is no acquire to wait on
+	VkExtent2D Extent;
+	Extent.width = static_cast<uint32_t>(ConfigInterface->RenderingSetting().RenderWidth);
+	Extent.height = static_cast<uint32_t>(ConfigInterface->RenderingSetting().RenderHeight);
+
+	// RGBA8 so the frames can be read back without swizzling
+	UHTransitionInfo OffscreenTransition(VK_ATTACHMENT_LOAD_OP_DONT_CARE, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+	SwapChainRT.resize(GMaxFrameInFlight);
+	SwapChainFrameBuffer.resize(GMaxFrameInFlight);
+	for (uint32_t Idx = 0; Idx < GMaxFrameInFlight; Idx++)
+	{
+		SwapChainRT[Idx] = RequestRenderTexture("OffscreenTarget" + std::to_string(Idx), Extent, UHTextureFormat::UH_FORMAT_RGBA8_UNORM);
+		if (SwapChainRT[Idx] == nullptr)
+		{
+			UHE_LOG("Failed to create offscreen targets!\n");
+			return false;
+		}
+	}
+	SwapChainRenderPass = CreateRenderPass(SwapChainRT[0], OffscreenTransition).RenderPass;
+
+	for (uint32_t Idx = 0; Idx < GMaxFrameInFlight; Idx++)
+	{
+		SwapChainFrameBuffer[Idx] = CreateFrameBuffer(SwapChainRT[Idx], SwapChainRenderPass, Extent);
+	}
+
+	return true;
+}
+
 std::vector<uint32_t> UHGraphic::GetMemoryTypeIndices(VkMemoryPropertyFlags InFlags) const
 {
 	std::vector<uint32_t> OutTypes;
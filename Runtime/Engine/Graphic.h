@@ -3,6 +3,7 @@
 #include <memory>
 #include <vector>
 #include <optional>
+#include <atomic>
 #include "../../UnheardEngine.h"
 #include "../Classes/Settings.h"
 #include "../Classes/RenderTexture.h"
@@ -18,6 +19,9 @@
 #include "../CoreGlobals.h"
 #include "../Classes/AccelerationStructure.h"
 #include "../Classes/GPUMemory.h"
+#include "../Classes/StagingRing.h"
+#include "../Classes/DescriptorAllocator.h"
+#include "../Classes/DeferredDeletionQueue.h"
 
 // queue family structure
 struct UHQueueFamily
@@ -29,6 +33,9 @@ struct UHQueueFamily
 
 	// compute queue
 	std::optional<uint32_t> ComputesFamily;
+
+	// transfer queue, it's the graphic queue if there isn't a dedicated one
+	std::optional<uint32_t> TransferFamily;
 };
 
 // struct for swap chain data
@@ -119,9 +126,21 @@ public:
 	// toggle full screen
 	void ToggleFullScreen(bool InFullScreenState);
 
-	// generic wait gpu function
+	// generic wait gpu function, it also waits the render thread and flushes the deferred releases
 	void WaitGPU();
 
+	// render thread sync, set by the renderer as GT no longer waits render thread every frame
+	// objects that render thread could be recording with must not be changed before waiting it
+	void SetRenderThreadWait(std::function<void()> InWaitFunc);
+	void WaitRenderThread();
+
+	// deferred release, the function is called after GPU finished the frames that could reference the resource
+	void RequestDeferredRelease(std::function<void()> InReleaseFunc);
+
+	// frame timeline progress, set by the renderer with the value of the final signal of a frame
+	void SetFrameSubmittedValue(uint64_t InValue);
+	void ProcessDeferredReleases(uint64_t InCompletedValue);
+
 	// create render pass object, allow imageless and both multiple and single creation
 	UHRenderPassObject CreateRenderPass(UHTransitionInfo InTransitionInfo) const;
 	UHRenderPassObject CreateRenderPass(UHRenderTexture* InTex, UHTransitionInfo InTransitionInfo, UHRenderTexture* InDepth = nullptr) const;
@@ -141,6 +160,10 @@ public:
 		, UHRenderTextureSettings InRTSettings = UHRenderTextureSettings());
 	void RequestReleaseRT(UHRenderTexture* InRT);
 
+	// memory requirements of a render texture without creating it, used for placing RTs in a shared memory
+	VkMemoryRequirements GetRenderTextureMemoryRequirements(std::string InName, VkExtent2D InExtent, UHTextureFormat InFormat
+		, UHRenderTextureSettings InRTSettings = UHRenderTextureSettings());
+
 	// request a managed texture 2d/cube
 	UHTexture2D* RequestTexture2D(UniquePtr<UHTexture2D>& LoadedTex, bool bUseSharedMemory);
 	void RequestReleaseTexture2D(UHTexture2D* InTex);
@@ -242,13 +265,19 @@ public:
 	// get gpu time stamp period
 	float GetGPUTimeStampPeriod() const;
 
+	// get min scratch offset alignment of acceleration structure
+	uint32_t GetMinASScratchOffsetAlignment() const;
+
 	bool IsDepthPrePassEnabled() const;
+	bool IsVertexCompressionEnabled() const;
+	bool IsVisibilityBufferEnabled() const;
 	bool IsRayTracingEnabled() const;
 	bool IsDebugLayerEnabled() const;
 	bool IsHDRAvailable() const;
 	bool Is24BitDepthSupported() const;
 	bool IsMeshShaderSupported() const;
 	bool IsWaveOperationSupported() const;
+	bool IsTraceRaysIndirectSupported() const;
 
 	// get all samplers
 	std::vector<UHSampler*> GetSamplers() const;
@@ -257,6 +286,14 @@ public:
 	UHGPUMemory* GetMeshSharedMemory() const;
 	UHGPUMemory* GetImageSharedMemory() const;
 
+	// staging ring for static buffers in device local memory
+	UHStagingRing* GetStagingRing() const;
+
+	// shared descriptor set allocator
+	UHDescriptorAllocator* GetDescriptorAllocator() const;
+	const std::vector<uint32_t>& GetStagingQueueFamilies() const;
+	const std::vector<uint32_t>& GetComputeQueueFamilies() const;
+
 	// debug cmd functions
 	void BeginCmdDebug(VkCommandBuffer InBuffer, std::string InName);
 	void EndCmdDebug(VkCommandBuffer InBuffer);
@@ -265,6 +302,7 @@ public:
 	VkCommandBuffer BeginOneTimeCmd();
 	void EndOneTimeCmd(VkCommandBuffer InBuffer);
 	VkQueue GetGraphicsQueue() const;
+	VkQueue GetTransferQueue() const;
 
 	// get memory type indices, there might have multiple heaps fit the input
 	// so returning multiple index and let resource try
@@ -317,6 +355,9 @@ private:
 	// create swap chain
 	bool CreateSwapChain();
 
+	// create offscreen targets in place of swap chain images, for the windowless mode
+	bool CreateOffscreenTargets();
+
 	// get memory type indices (internal use)
 	std::vector<uint32_t> GetMemoryTypeIndices(VkMemoryPropertyFlags InFlags) const;
 
@@ -341,6 +382,9 @@ private:
 	// main graphic queue, similar to ID3D12CommandQueue
 	VkQueue GraphicsQueue;
 
+	// queue for staging uploads, could be the same as GraphicsQueue
+	VkQueue TransferQueue;
+
 	// queue family info
 	UHQueueFamily QueueFamily;
 
@@ -389,13 +433,17 @@ private:
 	UHAssetManager* AssetManagerInterface;
 	UHConfigManager* ConfigInterface;
 	uint32_t ShaderRecordSize;
+	uint32_t MinASScratchOffsetAlignment;
 	float GPUTimeStampPeriod;
 	bool bEnableDepthPrePass;
 	bool bEnableRayTracing;
+	bool bEnableVertexCompression;
+	bool bEnableVisibilityBuffer;
 	bool bSupportHDR;
 	bool bSupport24BitDepth;
 	bool bSupportMeshShader;
 	bool bSupportWaveOperation;
+	bool bSupportTraceRaysIndirect;
 	std::mutex Mutex;
 
 protected:
@@ -412,17 +460,25 @@ protected:
 	// shared GPU memory
 	UniquePtr<UHGPUMemory> MeshBufferSharedMemory;
 	UniquePtr<UHGPUMemory> ImageSharedMemory;
+	UniquePtr<UHStagingRing> StagingRing;
+	UniquePtr<UHDescriptorAllocator> DescriptorAllocator;
+	UHDeferredDeletionQueue DeletionQueue;
+	std::function<void()> RenderThreadWaitFunc;
+	std::vector<uint32_t> StagingQueueFamilies;
+	std::vector<uint32_t> ComputeQueueFamilies;
 	std::vector<uint32_t> DeviceMemoryTypeIndices;
 	uint32_t HostMemoryTypeIndex;
 
 	// available GPUs for editor use
 	std::vector<std::string> AvailableGpuNames;
 
+	// engine collects the pool statistics
+	friend UHEngine;
+
 #if WITH_EDITOR
 	uint32_t MinImageCount;
 
 	// give access for some classes in debug build
-	friend UHEngine;
 	friend UHPreviewScene;
 #endif
 };
\ No newline at end of file
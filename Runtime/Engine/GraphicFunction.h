@@ -17,8 +17,11 @@ inline PFN_vkGetAccelerationStructureBuildSizesKHR GVkGetAccelerationStructureBu
 inline PFN_vkCreateAccelerationStructureKHR GVkCreateAccelerationStructureKHR;
 inline PFN_vkCmdBuildAccelerationStructuresKHR GVkCmdBuildAccelerationStructuresKHR;
 inline PFN_vkDestroyAccelerationStructureKHR GVkDestroyAccelerationStructureKHR;
+inline PFN_vkCmdWriteAccelerationStructuresPropertiesKHR GVkCmdWriteAccelerationStructuresPropertiesKHR;
+inline PFN_vkCmdCopyAccelerationStructureKHR GVkCmdCopyAccelerationStructureKHR;
 inline PFN_vkCreateRayTracingPipelinesKHR GVkCreateRayTracingPipelinesKHR;
 inline PFN_vkCmdTraceRaysKHR GVkCmdTraceRaysKHR;
+inline PFN_vkCmdTraceRaysIndirectKHR GVkCmdTraceRaysIndirectKHR;
 inline PFN_vkGetRayTracingShaderGroupHandlesKHR GVkGetRayTracingShaderGroupHandlesKHR;
 inline PFN_vkCmdPushDescriptorSetKHR GVkCmdPushDescriptorSetKHR;
 inline PFN_vkCmdBeginConditionalRenderingEXT GVkCmdBeginConditionalRenderingEXT;
@@ -0,0 +1,228 @@
+#include "Headless.h"
+#include "Engine.h"
+#include "../../UnheardEngine.h"
+#include "../CoreGlobals.h"
+#include <cstdio>
+
+UHHeadless::UHHeadless(UHEngine* InEngine, const UHHeadlessSettings& InSettings)
+	: Engine(InEngine)
+	, Settings(InSettings)
+	, FrameIndex(0)
+	, StartTime(UHClock::time_point())
+	, LastReportTime(UHClock::time_point())
+	, LastReportFrame(0)
+{
+
+}
+
+// command line: -offscreen [-resolution WxH] [-scene path] [-captureframes N] [-capture raw|png|shm]
+// [-capturedir path] [-shmname name] [-readbackring N], -gpu is read but left for the benchmark parser
+bool UHHeadless::ParseCommandLine(int32_t ArgC, char* ArgV[], UHHeadlessSettings& OutSettings, std::vector<char*>& OutRemainingArgs)
+{
+	OutRemainingArgs.clear();
+	if (ArgC > 0)
+	{
+		OutRemainingArgs.push_back(ArgV[0]);
+	}
+
+	for (int32_t Idx = 1; Idx < ArgC; Idx++)
+	{
+		const std::string Arg = ArgV[Idx];
+		const bool bHasValue = Idx + 1 < ArgC;
+
+		try
+		{
+			if (Arg == "-offscreen")
+			{
+				OutSettings.bEnabled = true;
+			}
+			else if (Arg == "-resolution" && bHasValue)
+			{
+				const std::string Value = ArgV[++Idx];
+				const size_t Separator = Value.find('x');
+				if (Separator == std::string::npos)
+				{
+					UHE_LOG("Resolution must be WxH, e.g. 1920x1080\n");
+					return false;
+				}
+				OutSettings.Width = std::stoi(Value.substr(0, Separator));
+				OutSettings.Height = std::stoi(Value.substr(Separator + 1));
+			}
+			else if (Arg == "-scene" && bHasValue)
+			{
+				OutSettings.ScenePath = ArgV[++Idx];
+			}
+			else if (Arg == "-captureframes" && bHasValue)
+			{
+				OutSettings.NumFrames = std::stoi(ArgV[++Idx]);
+			}
+			else if (Arg == "-capture" && bHasValue)
+			{
+				const std::string Value = ArgV[++Idx];
+				if (Value == "raw")
+				{
+					OutSettings.Capture.Output = UHCaptureOutput::Raw;
+				}
+				else if (Value == "png")
+				{
+					OutSettings.Capture.Output = UHCaptureOutput::PNG;
+				}
+				else if (Value == "shm")
+				{
+					OutSettings.Capture.Output = UHCaptureOutput::SharedMemory;
+				}
+				else
+				{
+					UHE_LOG("Unknown capture output: " + Value + "\n");
+					return false;
+				}
+			}
+			else if (Arg == "-capturedir" && bHasValue)
+			{
+				OutSettings.Capture.OutputDir = ArgV[++Idx];
+			}
+			else if (Arg == "-shmname" && bHasValue)
+			{
+				OutSettings.Capture.SharedMemoryName = ArgV[++Idx];
+			}
+			else if (Arg == "-readbackring" && bHasValue)
+			{
+				OutSettings.Capture.RingSize = static_cast<uint32_t>(std::stoi(ArgV[++Idx]));
+			}
+			else
+			{
+				if (Arg == "-gpu" && bHasValue)
+				{
+					OutSettings.GpuName = ArgV[Idx + 1];
+				}
+				OutRemainingArgs.push_back(ArgV[Idx]);
+			}
+		}
+		catch (const std::exception&)
+		{
+			UHE_LOG("Invalid value for argument: " + Arg + "\n");
+			return false;
+		}
+	}
+
+	if (!OutSettings.bEnabled)
+	{
+		return true;
+	}
+
+	if (OutSettings.NumFrames < 0 || OutSettings.Capture.RingSize == 0)
+	{
+		UHE_LOG("Offscreen mode needs non-negative frame count and at least one readback buffer!\n");
+		return false;
+	}
+
+	if ((OutSettings.Width != 0 || OutSettings.Height != 0)
+		&& (OutSettings.Width < 480 || OutSettings.Height < 480 || OutSettings.Width > 16384 || OutSettings.Height > 16384))
+	{
+		UHE_LOG("Offscreen resolution must be within 480 and 16384!\n");
+		return false;
+	}
+
+	return true;
+}
+
+// the offscreen overrides are not saved back to the config file
+void UHHeadless::OverrideConfig(UHConfigManager* InConfig, const UHHeadlessSettings& InSettings)
+{
+	InConfig->PresentationSetting().bVsync = false;
+	InConfig->PresentationSetting().bFullScreen = false;
+	InConfig->EngineSetting().FPSLimit = 0.0f;
+
+	if (InSettings.Width > 0 && InSettings.Height > 0)
+	{
+		InConfig->RenderingSetting().RenderWidth = InSettings.Width;
+		InConfig->RenderingSetting().RenderHeight = InSettings.Height;
+	}
+
+	if (!InSettings.GpuName.empty())
+	{
+		InConfig->RenderingSetting().SelectedGpuName = InSettings.GpuName;
+	}
+}
+
+bool UHHeadless::Initialize()
+{
+	if (!Settings.ScenePath.empty())
+	{
+		if (!std::filesystem::exists(Settings.ScenePath))
+		{
+			UHE_LOG("Offscreen scene " + Settings.ScenePath.generic_string() + " not found!\n");
+			return false;
+		}
+		Engine->OnLoadScene(Settings.ScenePath);
+	}
+
+	if (Settings.Capture.Output != UHCaptureOutput::Off && !Engine->InitOffscreenCapture(Settings.Capture))
+	{
+		return false;
+	}
+
+	const UHRenderingSettings& RenderingSettings = Engine->GetConfigManager()->RenderingSetting();
+	UHE_LOG("Offscreen rendering started at " + std::to_string(RenderingSettings.RenderWidth) + "x" + std::to_string(RenderingSettings.RenderHeight)
+		+ (Settings.NumFrames > 0 ? ", " + std::to_string(Settings.NumFrames) + " frames.\n" : ", until interrupted.\n"));
+
+	StartTime = UHClock::now();
+	LastReportTime = StartTime;
+	LastReportFrame = 0;
+	return true;
+}
+
+void UHHeadless::EndFrame()
+{
+	FrameIndex++;
+
+	const UHClock::time_point Now = UHClock::now();
+	const float Elapsed = std::chrono::duration<float>(Now - LastReportTime).count();
+	if (Elapsed < ReportInterval)
+	{
+		return;
+	}
+
+	const UHRenderingSettings& RenderingSettings = Engine->GetConfigManager()->RenderingSetting();
+	const UHOffscreenCapture* Capture = Engine->GetOffscreenCapture();
+
+	char Report[256];
+	snprintf(Report, sizeof(Report), "Offscreen: %.1f fps at %dx%d, captured %llu, dropped %llu\n"
+		, static_cast<float>(FrameIndex - LastReportFrame) / Elapsed
+		, RenderingSettings.RenderWidth, RenderingSettings.RenderHeight
+		, static_cast<unsigned long long>(Capture ? Capture->GetCapturedCount() : 0)
+		, static_cast<unsigned long long>(Capture ? Capture->GetDroppedCount() : 0));
+	UHE_LOG(Report);
+
+	LastReportTime = Now;
+	LastReportFrame = FrameIndex;
+}
+
+bool UHHeadless::IsFinished() const
+{
+	return Settings.NumFrames > 0 && FrameIndex >= Settings.NumFrames;
+}
+
+void UHHeadless::Finish()
+{
+	// the last frames are still in flight, wait them before counting
+	Engine->GetSceneRenderer()->WaitPreviousRenderTask();
+	Engine->GetGfx()->WaitGPU();
+
+	UHOffscreenCapture* Capture = Engine->GetOffscreenCapture();
+	if (Capture != nullptr)
+	{
+		Capture->Flush();
+	}
+
+	const float Elapsed = std::chrono::duration<float>(UHClock::now() - StartTime).count();
+	const UHRenderingSettings& RenderingSettings = Engine->GetConfigManager()->RenderingSetting();
+
+	char Report[256];
+	snprintf(Report, sizeof(Report), "Offscreen finished: %d frames in %.2f s, %.1f fps at %dx%d, captured %llu, dropped %llu\n"
+		, FrameIndex, Elapsed, Elapsed > 0.0f ? static_cast<float>(FrameIndex) / Elapsed : 0.0f
+		, RenderingSettings.RenderWidth, RenderingSettings.RenderHeight
+		, static_cast<unsigned long long>(Capture ? Capture->GetCapturedCount() : 0)
+		, static_cast<unsigned long long>(Capture ? Capture->GetDroppedCount() : 0));
+	UHE_LOG(Report);
+}
@@ -0,0 +1,71 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <filesystem>
+#include "GameTimer.h"
+#include "../Renderer/OffscreenCapture.h"
+
+class UHEngine;
+class UHConfigManager;
+
+// offscreen settings, parsed from command line
+struct UHHeadlessSettings
+{
+public:
+	UHHeadlessSettings()
+		: bEnabled(false)
+		, Width(0)
+		, Height(0)
+		, NumFrames(0)
+	{
+
+	}
+
+	bool bEnabled;
+
+	// render resolution override, 0 keeps the config value
+	int32_t Width;
+	int32_t Height;
+
+	// 0 runs until SIGINT/SIGTERM
+	int32_t NumFrames;
+
+	// optional, an empty scene is rendered without it
+	std::filesystem::path ScenePath;
+
+	// shared with benchmark, e.g. "llvmpipe" for a software Vulkan device
+	std::string GpuName;
+
+	UHOffscreenCaptureSettings Capture;
+};
+
+// windowless rendering for render servers, e.g. thumbnails and video capture
+// frames are rendered to offscreen targets and optionally streamed out by UHOffscreenCapture
+// the throughput is reported periodically as frames per second at the render resolution
+class UHHeadless
+{
+public:
+	UHHeadless(UHEngine* InEngine, const UHHeadlessSettings& InSettings);
+
+	// offscreen arguments are consumed, the rest are left for the benchmark parser with ArgV[0] kept
+	static bool ParseCommandLine(int32_t ArgC, char* ArgV[], UHHeadlessSettings& OutSettings, std::vector<char*>& OutRemainingArgs);
+	static void OverrideConfig(UHConfigManager* InConfig, const UHHeadlessSettings& InSettings);
+
+	bool Initialize();
+	void EndFrame();
+	bool IsFinished() const;
+
+	// wait the in-flight frames are captured and print the summary
+	void Finish();
+
+private:
+	static constexpr float ReportInterval = 2.0f;
+
+	UHEngine* Engine;
+	UHHeadlessSettings Settings;
+	int32_t FrameIndex;
+	UHClock::time_point StartTime;
+	UHClock::time_point LastReportTime;
+	int32_t LastReportFrame;
+};
@@ -46,4 +46,14 @@ int32_t UHRenderResource::GetRefCount() const
 uint32_t UHRenderResource::GetHostMemoryTypeIndex() const
 {
 	return GfxCache->GetHostMemoryTypeIndex();
+}
+
+const std::vector<uint32_t>& UHRenderResource::GetStagingQueueFamilies() const
+{
+	return GfxCache->GetStagingQueueFamilies();
+}
+
+const std::vector<uint32_t>& UHRenderResource::GetComputeQueueFamilies() const
+{
+	return GfxCache->GetComputeQueueFamilies();
 }
\ No newline at end of file
@@ -1,6 +1,7 @@
 #pragma once
 #include "Runtime/Platform/PlatformVulkan.h"
 #include "../Classes/Object.h"
+#include <vector>
 
 class UHGraphic;
 
@@ -20,6 +21,8 @@ public:
 
 protected:
 	uint32_t GetHostMemoryTypeIndex() const;
+	const std::vector<uint32_t>& GetStagingQueueFamilies() const;
+	const std::vector<uint32_t>& GetComputeQueueFamilies() const;
 
 	UHGraphic* GfxCache;
 	VkDevice LogicalDevice;
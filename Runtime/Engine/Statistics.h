@@ -0,0 +1,50 @@
+#pragma once
+#include <cstdint>
+
+// engine statistics, filled by UHEngine::CollectStatistics()
+struct UHStatistics
+{
+public:
+	UHStatistics()
+		: EngineUpdateTime(0)
+		, RenderThreadTime(0)
+		, FrameLatency(0)
+		, FramesInFlight(0)
+		, TotalTime(0)
+		, FPS(0)
+		, RendererCount(0)
+		, DrawCallCount(0)
+		, OccludedCallCount(0)
+		, PSOCount(0)
+		, ShaderCount(0)
+		, RTCount(0)
+		, SamplerCount(0)
+		, TextureCount(0)
+		, TextureCubeCount(0)
+		, MateralCount(0)
+		, GeometryBandwidthMB(0)
+	{
+
+	}
+
+	float EngineUpdateTime;
+	float RenderThreadTime;
+	float FrameLatency;
+	uint32_t FramesInFlight;
+	float TotalTime;
+	float FPS;
+
+	int32_t RendererCount;
+	int32_t DrawCallCount;
+	int32_t OccludedCallCount;
+	int32_t PSOCount;
+	int32_t ShaderCount;
+	int32_t RTCount;
+	int32_t SamplerCount;
+	int32_t TextureCount;
+	int32_t TextureCubeCount;
+	int32_t MateralCount;
+
+	// estimated attachment traffic of depth/base pass or visibility buffer
+	float GeometryBandwidthMB;
+};
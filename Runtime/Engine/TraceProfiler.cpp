@@ -0,0 +1,353 @@
+#include "TraceProfiler.h"
+#include "../../UnheardEngine.h"
+#include "../CoreGlobals.h"
+#include "GameTimer.h"
+#include <fstream>
+#include <algorithm>
+#include <unordered_map>
+
+std::atomic<bool> UHTraceProfiler::bIsEnabled(false);
+std::atomic<UHTraceThreadBuffer*> UHTraceProfiler::ThreadBuffers[UHTraceProfiler::MaxThreads];
+std::atomic<uint32_t> UHTraceProfiler::NumThreadBuffers(0);
+
+thread_local UHTraceThreadBuffer* GTraceThreadBuffer = nullptr;
+const UHClock::time_point GTraceStartTime = UHClock::now();
+
+// capture states, only touched by game thread
+uint32_t GTraceCaptureFramesLeft = 0;
+bool GTraceCaptureRequested = false;
+std::string GTraceCapturePath;
+std::vector<UHTraceEvent> GTraceCapturedEvents;
+std::vector<uint32_t> GTraceCapturedSlots;
+std::vector<int64_t> GTraceCapturedFrames;
+
+// per-frame drain buffers, reused every frame
+bool GTraceCollectScopeTimes = false;
+std::vector<UHTraceEvent> GTraceFrameEvents;
+std::vector<uint32_t> GTraceFrameSlots;
+std::vector<std::pair<std::string, float>> GTraceFrameScopeTimes;
+
+UHTraceThreadBuffer::UHTraceThreadBuffer(std::thread::id InThreadID)
+	: Depth(0)
+	, WriteIndex(0)
+	, ReadIndex(0)
+	, DroppedCount(0)
+	, ThreadID(InThreadID)
+{
+
+}
+
+void UHTraceThreadBuffer::Push(const UHTraceEvent& InEvent)
+{
+	const uint64_t Idx = WriteIndex.load(std::memory_order_relaxed);
+	Events[Idx & CapacityMask] = InEvent;
+	WriteIndex.store(Idx + 1, std::memory_order_release);
+}
+
+void UHTraceThreadBuffer::Drain(std::vector<UHTraceEvent>& OutEvents)
+{
+	const uint64_t End = WriteIndex.load(std::memory_order_acquire);
+	uint64_t Begin = ReadIndex;
+	if (End - Begin > Capacity)
+	{
+		// producer is faster than consumer, the oldest events are overwritten
+		DroppedCount += End - Begin - Capacity;
+		Begin = End - Capacity;
+	}
+
+	const size_t OutStart = OutEvents.size();
+	for (uint64_t Idx = Begin; Idx < End; Idx++)
+	{
+		OutEvents.push_back(Events[Idx & CapacityMask]);
+	}
+
+	// the producer might wrap around while copying, drop the slots that could be overwritten
+	// including the slot which is being written now
+	std::atomic_thread_fence(std::memory_order_acquire);
+	const uint64_t NewEnd = WriteIndex.load(std::memory_order_relaxed) + 1;
+	if (NewEnd - Begin > Capacity)
+	{
+		const uint64_t NumOverwritten = (std::min)(NewEnd - Begin - Capacity, End - Begin);
+		OutEvents.erase(OutEvents.begin() + OutStart, OutEvents.begin() + OutStart + NumOverwritten);
+		DroppedCount += NumOverwritten;
+	}
+
+	ReadIndex = End;
+}
+
+void UHTraceThreadBuffer::Discard()
+{
+	ReadIndex = WriteIndex.load(std::memory_order_acquire);
+}
+
+std::thread::id UHTraceThreadBuffer::GetThreadID() const
+{
+	return ThreadID;
+}
+
+uint64_t UHTraceThreadBuffer::GetDroppedCount() const
+{
+	return DroppedCount;
+}
+
+void UHTraceProfiler::SetEnabled(bool bInFlag)
+{
+	// editor always needs the scope time for profile dialog
+	bIsEnabled.store(bInFlag || GIsEditor, std::memory_order_relaxed);
+}
+
+bool UHTraceProfiler::RequestCapture(uint32_t InNumFrames, std::string InOutputPath)
+{
+	if (!IsEnabled())
+	{
+		UHE_LOG("CPU trace is disabled, enable bEnableCPUTrace before capturing.\n");
+		return false;
+	}
+
+	if (IsCapturing() || InNumFrames == 0)
+	{
+		return false;
+	}
+
+	GTraceCaptureRequested = true;
+	GTraceCaptureFramesLeft = InNumFrames;
+	GTraceCapturePath = InOutputPath;
+	return true;
+}
+
+bool UHTraceProfiler::IsCapturing()
+{
+	return GTraceCaptureRequested || GTraceCaptureFramesLeft > 0;
+}
+
+void UHTraceProfiler::EndFrame()
+{
+	if (!IsEnabled())
+	{
+		return;
+	}
+
+	const uint32_t NumBuffers = (std::min)(NumThreadBuffers.load(std::memory_order_acquire), MaxThreads);
+
+	// a capture starts at the frame boundary, events before it are discarded
+	if (GTraceCaptureRequested)
+	{
+		for (uint32_t Idx = 0; Idx < NumBuffers; Idx++)
+		{
+			if (UHTraceThreadBuffer* Buffer = ThreadBuffers[Idx].load(std::memory_order_acquire))
+			{
+				Buffer->Discard();
+			}
+		}
+
+		GTraceCapturedEvents.clear();
+		GTraceCapturedSlots.clear();
+		GTraceCapturedFrames.clear();
+		GTraceCapturedFrames.push_back(GetTimeStamp());
+		GTraceCaptureRequested = false;
+		return;
+	}
+
+	// nothing needs the events in shipping build unless it's capturing, just skip them
+	const bool bNeedScopeTimes = GIsEditor || GTraceCollectScopeTimes;
+	if (!bNeedScopeTimes && GTraceCaptureFramesLeft == 0)
+	{
+		for (uint32_t Idx = 0; Idx < NumBuffers; Idx++)
+		{
+			if (UHTraceThreadBuffer* Buffer = ThreadBuffers[Idx].load(std::memory_order_acquire))
+			{
+				Buffer->Discard();
+			}
+		}
+		return;
+	}
+
+	GTraceFrameEvents.clear();
+	GTraceFrameSlots.clear();
+	for (uint32_t Idx = 0; Idx < NumBuffers; Idx++)
+	{
+		UHTraceThreadBuffer* Buffer = ThreadBuffers[Idx].load(std::memory_order_acquire);
+		if (Buffer == nullptr)
+		{
+			continue;
+		}
+
+		Buffer->Drain(GTraceFrameEvents);
+		GTraceFrameSlots.resize(GTraceFrameEvents.size(), Idx);
+	}
+
+	if (bNeedScopeTimes)
+	{
+		BuildFrameScopeTimes(GTraceFrameEvents, GTraceFrameSlots);
+	}
+
+	if (GTraceCaptureFramesLeft > 0)
+	{
+		GTraceCapturedEvents.insert(GTraceCapturedEvents.end(), GTraceFrameEvents.begin(), GTraceFrameEvents.end());
+		GTraceCapturedSlots.insert(GTraceCapturedSlots.end(), GTraceFrameSlots.begin(), GTraceFrameSlots.end());
+		GTraceCapturedFrames.push_back(GetTimeStamp());
+
+		if (--GTraceCaptureFramesLeft == 0)
+		{
+			WriteCapture();
+			GTraceCapturedEvents.clear();
+			GTraceCapturedSlots.clear();
+			GTraceCapturedFrames.clear();
+		}
+	}
+}
+
+void UHTraceProfiler::Release()
+{
+	for (uint32_t Idx = 0; Idx < MaxThreads; Idx++)
+	{
+		delete ThreadBuffers[Idx].exchange(nullptr);
+	}
+	NumThreadBuffers.store(0);
+	GTraceThreadBuffer = nullptr;
+}
+
+const std::vector<std::pair<std::string, float>>& UHTraceProfiler::GetFrameScopeTimes()
+{
+	return GTraceFrameScopeTimes;
+}
+
+void UHTraceProfiler::SetCollectFrameScopeTimes(bool bInFlag)
+{
+	GTraceCollectScopeTimes = bInFlag;
+}
+
+UHTraceThreadBuffer* UHTraceProfiler::GetThreadBuffer()
+{
+	if (GTraceThreadBuffer)
+	{
+		return GTraceThreadBuffer;
+	}
+
+	// first scope of this thread, reserve a slot lock-free
+	// the count never goes past MaxThreads, so the threads without a slot don't keep growing it
+	uint32_t Slot = NumThreadBuffers.load(std::memory_order_acquire);
+	do
+	{
+		if (Slot >= MaxThreads)
+		{
+			return nullptr;
+		}
+	} while (!NumThreadBuffers.compare_exchange_weak(Slot, Slot + 1, std::memory_order_acq_rel, std::memory_order_acquire));
+
+	GTraceThreadBuffer = new UHTraceThreadBuffer(std::this_thread::get_id());
+	ThreadBuffers[Slot].store(GTraceThreadBuffer, std::memory_order_release);
+	return GTraceThreadBuffer;
+}
+
+int64_t UHTraceProfiler::GetTimeStamp()
+{
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(UHClock::now() - GTraceStartTime).count();
+}
+
+void UHTraceProfiler::BuildFrameScopeTimes(const std::vector<UHTraceEvent>& InEvents, const std::vector<uint32_t>& InThreadSlots)
+{
+	// merge the same scope called multiple times in a thread, and sort by begin time
+	std::unordered_map<uint64_t, size_t> ScopeIndices;
+	std::vector<UHTraceEvent> Scopes;
+	for (size_t Idx = 0; Idx < InEvents.size(); Idx++)
+	{
+		const uint64_t Key = (static_cast<uint64_t>(InThreadSlots[Idx]) << 32) | InEvents[Idx].NameId;
+		auto Iter = ScopeIndices.find(Key);
+		if (Iter == ScopeIndices.end())
+		{
+			ScopeIndices[Key] = Scopes.size();
+			Scopes.push_back(InEvents[Idx]);
+		}
+		else
+		{
+			UHTraceEvent& Scope = Scopes[Iter->second];
+			Scope.EndTime += InEvents[Idx].EndTime - InEvents[Idx].BeginTime;
+		}
+	}
+
+	std::sort(Scopes.begin(), Scopes.end(), [](const UHTraceEvent& A, const UHTraceEvent& B)
+		{
+			return A.BeginTime < B.BeginTime;
+		});
+
+	GTraceFrameScopeTimes.clear();
+	for (const UHTraceEvent& Scope : Scopes)
+	{
+		GTraceFrameScopeTimes.push_back(std::make_pair(std::string(Scope.Name)
+			, static_cast<float>(Scope.EndTime - Scope.BeginTime) / 1000000.0f));
+	}
+}
+
+bool UHTraceProfiler::WriteCapture()
+{
+	std::ofstream FileOut(GTraceCapturePath, std::ios::out);
+	if (!FileOut.is_open())
+	{
+		UHE_LOG("Failed to write CPU trace to " + GTraceCapturePath + "!\n");
+		return false;
+	}
+
+	// chrome trace event format, timestamps are in microseconds
+	FileOut << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+	FileOut << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":0,\"args\":{\"name\":\"" << ENGINE_NAME << "\"}}";
+
+	const uint32_t NumBuffers = (std::min)(NumThreadBuffers.load(std::memory_order_acquire), MaxThreads);
+	uint64_t NumDropped = 0;
+	for (uint32_t Idx = 0; Idx < NumBuffers; Idx++)
+	{
+		if (UHTraceThreadBuffer* Buffer = ThreadBuffers[Idx].load(std::memory_order_acquire))
+		{
+			FileOut << ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":" << Idx
+				<< ",\"args\":{\"name\":\"" << GetThreadName(Buffer->GetThreadID(), Idx) << "\"}}";
+			FileOut << ",\n{\"name\":\"thread_sort_index\",\"ph\":\"M\",\"pid\":0,\"tid\":" << Idx
+				<< ",\"args\":{\"sort_index\":" << Idx << "}}";
+			NumDropped += Buffer->GetDroppedCount();
+		}
+	}
+
+	for (size_t Idx = 1; Idx < GTraceCapturedFrames.size(); Idx++)
+	{
+		FileOut << ",\n{\"name\":\"Frame " << Idx << "\",\"ph\":\"i\",\"s\":\"g\",\"pid\":0,\"tid\":0,\"ts\":"
+			<< static_cast<double>(GTraceCapturedFrames[Idx]) / 1000.0 << "}";
+	}
+
+	for (size_t Idx = 0; Idx < GTraceCapturedEvents.size(); Idx++)
+	{
+		const UHTraceEvent& Event = GTraceCapturedEvents[Idx];
+		FileOut << ",\n{\"name\":\"" << Event.Name << "\",\"ph\":\"X\",\"pid\":0,\"tid\":" << GTraceCapturedSlots[Idx]
+			<< ",\"ts\":" << static_cast<double>(Event.BeginTime) / 1000.0
+			<< ",\"dur\":" << static_cast<double>(Event.EndTime - Event.BeginTime) / 1000.0
+			<< ",\"args\":{\"depth\":" << Event.Depth << "}}";
+	}
+
+	FileOut << "\n]}\n";
+	FileOut.close();
+
+	UHE_LOG("CPU trace of " + std::to_string(GTraceCapturedFrames.size() - 1) + " frames written to " + GTraceCapturePath
+		+ ", " + std::to_string(GTraceCapturedEvents.size()) + " events, " + std::to_string(NumDropped) + " dropped.\n");
+	return true;
+}
+
+std::string UHTraceProfiler::GetThreadName(std::thread::id InThreadID, uint32_t InSlot)
+{
+	if (InThreadID == GMainThreadID)
+	{
+		return "Game Thread";
+	}
+
+	if (InThreadID == GRenderThreadID)
+	{
+		return "Render Thread";
+	}
+
+	for (size_t Idx = 0; Idx < GWorkerThreadIDs.size(); Idx++)
+	{
+		if (InThreadID == GWorkerThreadIDs[Idx])
+		{
+			return "Worker Thread " + std::to_string(Idx);
+		}
+	}
+
+	return "Thread " + std::to_string(InSlot);
+}
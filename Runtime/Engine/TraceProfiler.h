@@ -0,0 +1,150 @@
+#pragma once
+#include <cstdint>
+#include <atomic>
+#include <string>
+#include <vector>
+#include <utility>
+#include <thread>
+#include <type_traits>
+
+// lock-free hierarchical CPU trace profiler
+// each thread records scopes into its own ring buffer without allocation or locking
+// the game thread drains the ring buffers once per frame, either for the editor profile or for a Chrome trace capture
+// the captured json can be opened in chrome://tracing or ui.perfetto.dev
+
+// compile-time FNV-1a hash for scope names, used as name id
+constexpr uint32_t UHTraceNameId(const char* InName)
+{
+	uint32_t Hash = 2166136261u;
+	while (*InName != '\0')
+	{
+		Hash ^= static_cast<uint8_t>(*InName++);
+		Hash *= 16777619u;
+	}
+	return Hash;
+}
+
+// a finished scope, begin/end time are nanoseconds since profiler start
+struct UHTraceEvent
+{
+	int64_t BeginTime;
+	int64_t EndTime;
+	const char* Name;
+	uint32_t NameId;
+	uint32_t Depth;
+};
+
+// single producer (owner thread) single consumer (game thread) ring buffer
+class UHTraceThreadBuffer
+{
+public:
+	static constexpr uint64_t Capacity = 8192;
+	static constexpr uint64_t CapacityMask = Capacity - 1;
+	static_assert((Capacity & CapacityMask) == 0, "Trace buffer capacity must be power of 2!");
+
+	UHTraceThreadBuffer(std::thread::id InThreadID);
+
+	// producer side, only called by the owner thread
+	void Push(const UHTraceEvent& InEvent);
+
+	// consumer side, only called by the game thread
+	void Drain(std::vector<UHTraceEvent>& OutEvents);
+	void Discard();
+
+	std::thread::id GetThreadID() const;
+	uint64_t GetDroppedCount() const;
+
+	// nested level of the owner thread
+	uint32_t Depth;
+
+private:
+	std::atomic<uint64_t> WriteIndex;
+	uint64_t ReadIndex;
+	uint64_t DroppedCount;
+	std::thread::id ThreadID;
+	UHTraceEvent Events[Capacity];
+};
+
+class UHTraceProfiler
+{
+public:
+	static constexpr uint32_t MaxThreads = 64;
+
+	// runtime flag, scopes are no-op when disabled
+	static void SetEnabled(bool bInFlag);
+	static bool IsEnabled()
+	{
+		return bIsEnabled.load(std::memory_order_relaxed);
+	}
+
+	// request a capture of N frames, the output will be written when the last frame is drained
+	static bool RequestCapture(uint32_t InNumFrames, std::string InOutputPath);
+	static bool IsCapturing();
+
+	// frame boundary, called by game thread once per frame
+	static void EndFrame();
+
+	// release thread buffers, call after all threads are terminated
+	static void Release();
+
+	// per-frame scope time summary (name, ms) of the last drained frame, used by profile dialog
+	// it's always collected in editor, other builds need to turn it on, e.g. benchmark
+	static const std::vector<std::pair<std::string, float>>& GetFrameScopeTimes();
+	static void SetCollectFrameScopeTimes(bool bInFlag);
+
+	// get buffer of the calling thread, it's created at the first call
+	static UHTraceThreadBuffer* GetThreadBuffer();
+	static int64_t GetTimeStamp();
+
+private:
+	static void BuildFrameScopeTimes(const std::vector<UHTraceEvent>& InEvents, const std::vector<uint32_t>& InThreadSlots);
+	static bool WriteCapture();
+	static std::string GetThreadName(std::thread::id InThreadID, uint32_t InSlot);
+
+	static std::atomic<bool> bIsEnabled;
+	static std::atomic<UHTraceThreadBuffer*> ThreadBuffers[MaxThreads];
+	static std::atomic<uint32_t> NumThreadBuffers;
+};
+
+// scope object for UH_TRACE_SCOPE, doesn't allocate anything
+class UHTraceScope
+{
+public:
+	UHTraceScope(const char* InName, uint32_t InNameId)
+		: Buffer(nullptr)
+		, Name(InName)
+		, NameId(InNameId)
+		, BeginTime(0)
+	{
+		if (UHTraceProfiler::IsEnabled())
+		{
+			Buffer = UHTraceProfiler::GetThreadBuffer();
+			if (Buffer)
+			{
+				Buffer->Depth++;
+				BeginTime = UHTraceProfiler::GetTimeStamp();
+			}
+		}
+	}
+
+	~UHTraceScope()
+	{
+		if (Buffer)
+		{
+			Buffer->Depth--;
+			Buffer->Push(UHTraceEvent{ BeginTime, UHTraceProfiler::GetTimeStamp(), Name, NameId, Buffer->Depth });
+		}
+	}
+
+private:
+	UHTraceThreadBuffer* Buffer;
+	const char* Name;
+	uint32_t NameId;
+	int64_t BeginTime;
+};
+
+#define UH_TRACE_CONCAT_INNER(x,y) x##y
+#define UH_TRACE_CONCAT(x,y) UH_TRACE_CONCAT_INNER(x,y)
+
+// trace the current scope, the name must be a string literal
+#define UH_TRACE_SCOPE(x) UHTraceScope UH_TRACE_CONCAT(TraceScope, __LINE__)(x, std::integral_constant<uint32_t, UHTraceNameId(x)>::value)
@@ -22,6 +22,8 @@ public:
 		: NativeInstance(nullptr)
 		, NativeWindow(nullptr)
 		, bIsQuit(false)
+		, OffscreenWidth(0)
+		, OffscreenHeight(0)
 	{
 
 	}
@@ -61,4 +63,8 @@ private:
 	void* NativeInstance;
 	void* NativeWindow;
 	bool bIsQuit;
+
+	// size of a windowless client, it's simply stored
+	int32_t OffscreenWidth;
+	int32_t OffscreenHeight;
 };
\ No newline at end of file
@@ -1,16 +1,34 @@
 #include "Client.h"
 
 #if __linux__
+#include <csignal>
 
+// set by the signal handlers of offscreen platform
+extern volatile std::sig_atomic_t GQuitSignaled;
+
+// the client has no window in offscreen mode, window functions are no-op then
 void UHClient::SetWindowSize(const int32_t Width, const int32_t Height)
 {
 	GLFWwindow* Window = (GLFWwindow*)NativeWindow;
+	if (Window == nullptr)
+	{
+		OffscreenWidth = Width;
+		OffscreenHeight = Height;
+		return;
+	}
 	glfwSetWindowSize(Window, Width, Height);
 }
 
 void UHClient::GetWindowSize(int32_t& OutWidth, int32_t& OutHeight) const
 {
 	GLFWwindow* Window = (GLFWwindow*)NativeWindow;
+	if (Window == nullptr)
+	{
+		OutWidth = OffscreenWidth;
+		OutHeight = OffscreenHeight;
+		return;
+	}
+
 	int TempWidth, TempHeight;
 	glfwGetWindowSize(Window, &TempWidth, &TempHeight);
 	OutWidth = TempWidth;
@@ -20,6 +38,11 @@ void UHClient::GetWindowSize(int32_t& OutWidth, int32_t& OutHeight) const
 void UHClient::SetWindowStyle(const bool bIsFullscreen, const int32_t Width, const int32_t Height)
 {
 	GLFWwindow* Window = (GLFWwindow*)NativeWindow;
+	if (Window == nullptr)
+	{
+		return;
+	}
+
 	GLFWmonitor* Monitor = glfwGetPrimaryMonitor();
 	int32_t MonitorX, MonitorY;
 	glfwGetMonitorPos(Monitor, &MonitorX, &MonitorY);
@@ -64,13 +87,16 @@ void UHClient::SetWindowStyle(const bool bIsFullscreen, const int32_t Width, con
 void UHClient::SetWindowCaption(const std::string InCaption)
 {
 	GLFWwindow* Window = (GLFWwindow*)NativeWindow;
-	glfwSetWindowTitle(Window, InCaption.c_str());
+	if (Window != nullptr)
+	{
+		glfwSetWindowTitle(Window, InCaption.c_str());
+	}
 }
 
 bool UHClient::IsWindowMinimized()
 {
 	GLFWwindow* Window = (GLFWwindow*)NativeWindow;
-	return glfwGetWindowAttrib(Window, GLFW_ICONIFIED);
+	return Window != nullptr && glfwGetWindowAttrib(Window, GLFW_ICONIFIED);
 }
 
 bool UHClient::IsQuit()
@@ -80,6 +106,13 @@ bool UHClient::IsQuit()
 
 void UHClient::ProcessEvents()
 {
+	if (NativeWindow == nullptr)
+	{
+		// no window events, quit on SIGINT/SIGTERM instead
+		bIsQuit = GQuitSignaled != 0;
+		return;
+	}
+
 	// process all events at once
 	glfwPollEvents();
 
@@ -89,6 +122,12 @@ void UHClient::ProcessEvents()
 
 int32_t UHClient::GetDisplayFrequency() const
 {
+	if (NativeWindow == nullptr)
+	{
+		// no display attached, assume the common refresh rate
+		return 60;
+	}
+
 	GLFWmonitor* Monitor = glfwGetPrimaryMonitor();
 	const GLFWvidmode* Mode = glfwGetVideoMode(Monitor);
 
@@ -89,6 +89,11 @@ bool UHPlatformInput::InitInput()
 
 	// set input mode for better movement and register input callbacks
 	GLFWwindow* Window = (GLFWwindow*)ClientCache->GetNativeWindow();
+	if (Window == nullptr)
+	{
+		// offscreen client, there is no window to receive inputs
+		return false;
+	}
 
 	// select the smoothest mouse input as possible
 	if (glfwRawMouseMotionSupported())
@@ -115,7 +120,10 @@ void UHPlatformInput::GetMousePosition(double& X, double& Y) const
 	double MousePosY = 0;
 
 	GLFWwindow* Window = (GLFWwindow*)ClientCache->GetNativeWindow();
-	glfwGetCursorPos(Window, &MousePosX, &MousePosY);
+	if (Window != nullptr)
+	{
+		glfwGetCursorPos(Window, &MousePosX, &MousePosY);
+	}
 
 	X = MousePosX;
 	Y = MousePosY;
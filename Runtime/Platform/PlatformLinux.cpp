@@ -4,7 +4,14 @@
 #ifdef __linux__
 
 #include "Runtime/Application.h"
+#include <csignal>
 UHApplication* GAppCache = nullptr;
+volatile std::sig_atomic_t GQuitSignaled = 0;
+
+void QuitSignalHandler(int32_t InSignal)
+{
+	GQuitSignaled = 1;
+}
 
 void ResizeCallback(GLFWwindow* Window, int32_t Width, int32_t Height)
 {
@@ -20,6 +27,18 @@ void ResizeCallback(GLFWwindow* Window, int32_t Width, int32_t Height)
 bool UHPlatform::Initialize(UHApplication* InApp)
 {
 	GAppCache = InApp;
+
+	if (GIsOffscreen)
+	{
+		// windowless client for render servers, there is no display connection at all
+		// the loop is stopped by SIGINT/SIGTERM instead of closing a window
+		std::signal(SIGINT, QuitSignalHandler);
+		std::signal(SIGTERM, QuitSignalHandler);
+
+		Client = MakeUnique<UHClient>();
+		return true;
+	}
+
 	glfwInit();
 
 	// setup hints
@@ -41,6 +60,11 @@ bool UHPlatform::Initialize(UHApplication* InApp)
 
 void UHPlatform::Shutdown()
 {
+	if (GIsOffscreen)
+	{
+		return;
+	}
+
 	GLFWwindow* Window = (GLFWwindow*)Client->GetNativeWindow();
 	glfwDestroyWindow(Window);
 	glfwTerminate();
@@ -20,13 +20,17 @@ private:
 // implementation of RenderBasePass(), this pass is a deferred rendering with GBuffers and depth buffer
 void UHDeferredShadingRenderer::RenderBasePass(UHRenderBuilder& RenderBuilder)
 {
-	UHGameTimerScope Scope("RenderBasePass", false);
+	UH_TRACE_SCOPE("RenderBasePass");
 	if (CurrentScene == nullptr)
 	{
 		return;
 	}
 
-	UHGPUTimeQueryScope TimeScope(RenderBuilder.GetCmdList(), GPUTimeQueries[UH_ENUM_VALUE(UHRenderPassTypes::BasePass)], "BasePass");
+	// visibility buffer mode resolves materials instead of drawing geometry, time it separately for comparison
+	const bool bVisibilityBuffer = GraphicInterface->IsMeshShaderSupported() && GraphicInterface->IsVisibilityBufferEnabled();
+	const UHRenderPassTypes PassType = bVisibilityBuffer ? UHRenderPassTypes::MaterialResolvePass : UHRenderPassTypes::BasePass;
+	UHGPUTimeQueryScope TimeScope(RenderBuilder.GetCmdList(), GPUTimeQueries[UH_ENUM_VALUE(PassType)]
+		, bVisibilityBuffer ? "MaterialResolvePass" : "BasePass");
 
 	// setup clear value
 	std::vector<VkClearValue> ClearValues;
@@ -52,30 +56,35 @@ void UHDeferredShadingRenderer::RenderBasePass(UHRenderBuilder& RenderBuilder)
 		RenderBuilder.SetViewport(RenderResolution);
 		RenderBuilder.SetScissor(RenderResolution);
 
+		if (bVisibilityBuffer)
+		{
+			RenderBuilder.BeginRenderPass(BasePassObj, RenderResolution, ClearValues);
+			RenderMaterialResolve(RenderBuilder);
+		}
 		// do mesh shader version if it's supported.
-		if (GraphicInterface->IsMeshShaderSupported())
+		else if (GraphicInterface->IsMeshShaderSupported())
 		{
 			RenderBuilder.BeginRenderPass(BasePassObj, RenderResolution, ClearValues);
 			// bindless table, they should only be bound once
-			if (BaseMeshShaders.size() > 0 && SortedMeshShaderGroupIndex.size() > 0)
+			if (BaseMeshShaders.size() > 0 && SortedMeshShaderGroupIndex[CurrentFrameRT].size() > 0)
 			{
 				std::vector<VkDescriptorSet> BindlessTableSets = { TextureTable->GetDescriptorSet(CurrentFrameRT)
 					, SamplerTable->GetDescriptorSet(CurrentFrameRT)
 					, MeshletTable->GetDescriptorSet(CurrentFrameRT)
 					, PositionTable->GetDescriptorSet(CurrentFrameRT)
 					, UV0Table->GetDescriptorSet(CurrentFrameRT)
-					, IndicesTable->GetDescriptorSet(CurrentFrameRT)
+					, MeshletDataTable->GetDescriptorSet(CurrentFrameRT)
 					, NormalTable->GetDescriptorSet(CurrentFrameRT)
 					, TangentTable->GetDescriptorSet(CurrentFrameRT)
 				};
-				RenderBuilder.BindDescriptorSet(BaseMeshShaders[SortedMeshShaderGroupIndex[0]]->GetPipelineLayout(), BindlessTableSets, GTextureTableSpace);
+				RenderBuilder.BindDescriptorSet(BaseMeshShaders[SortedMeshShaderGroupIndex[CurrentFrameRT][0]]->GetPipelineLayout(), BindlessTableSets, GTextureTableSpace);
 			}
 
-			for (size_t Idx = 0; Idx < SortedMeshShaderGroupIndex.size(); Idx++)
+			for (size_t Idx = 0; Idx < SortedMeshShaderGroupIndex[CurrentFrameRT].size(); Idx++)
 			{
-				const int32_t GroupIndex = SortedMeshShaderGroupIndex[Idx];
-				const uint32_t VisibleMeshlets = static_cast<uint32_t>(VisibleMeshShaderData[GroupIndex].size());
-				if (VisibleMeshlets == 0)
+				const int32_t GroupIndex = SortedMeshShaderGroupIndex[CurrentFrameRT][Idx];
+				const uint32_t VisibleInstances = static_cast<uint32_t>(VisibleMeshShaderData[CurrentFrameRT][GroupIndex].size());
+				if (VisibleInstances == 0)
 				{
 					continue;
 				}
@@ -86,9 +95,15 @@ void UHDeferredShadingRenderer::RenderBasePass(UHRenderBuilder& RenderBuilder)
 
 				RenderBuilder.BindGraphicState(BaseMS->GetState());
 				RenderBuilder.BindDescriptorSet(BaseMS->GetPipelineLayout(), BaseMS->GetDescriptorSet(CurrentFrameRT));
+				RenderBuilder.BindMaterialArena(BaseMS, CurrentFrameRT);
 
-				// Dispatch meshlets
-				RenderBuilder.DispatchMesh(VisibleMeshlets, 1, 1);
+				// Dispatch meshlets, amplification shader expands instances to meshlets and culls them
+				UHMeshShaderConstants Constants;
+				Constants.InstanceCount = VisibleInstances;
+				Constants.MeshletCount = GetMeshShaderMeshletCount(VisibleMeshShaderData[CurrentFrameRT][GroupIndex]);
+				Constants.bEnableHiZ = bIsHiZValid ? 1 : 0;
+				RenderBuilder.PushConstant(BaseMS->GetPipelineLayout(), VK_SHADER_STAGE_TASK_BIT_EXT, sizeof(UHMeshShaderConstants), &Constants);
+				RenderBuilder.DispatchMesh(UHMathHelpers::RoundUpDivide(Constants.MeshletCount, GAmplificationGroupSize), 1, 1);
 
 				GraphicInterface->EndCmdDebug(RenderBuilder.GetCmdList());
 			}
@@ -98,13 +113,11 @@ void UHDeferredShadingRenderer::RenderBasePass(UHRenderBuilder& RenderBuilder)
 			// begin render pass
 			RenderBuilder.BeginRenderPass(BasePassObj, RenderResolution, ClearValues, VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);
 
-#if WITH_EDITOR
 			for (int32_t I = 0; I < NumParallelRenderSubmitters; I++)
 			{
 				ThreadDrawCalls[I] = 0;
 				ThreadOccludedCalls[I] = 0;
 			}
-#endif
 
 			// wake all worker threads
 			static std::vector<UHBasePassAsyncTask> Tasks(NumParallelRenderSubmitters);
@@ -120,13 +133,11 @@ void UHDeferredShadingRenderer::RenderBasePass(UHRenderBuilder& RenderBuilder)
 				WorkerThreads[I]->WaitTask();
 			}
 
-#if WITH_EDITOR
 			for (int32_t I = 0; I < NumParallelRenderSubmitters; I++)
 			{
 				RenderBuilder.DrawCalls += ThreadDrawCalls[I];
 				RenderBuilder.OccludedCalls += ThreadOccludedCalls[I];
 			}
-#endif
 
 			// execute all recorded batches
 			RenderBuilder.ExecuteBundles(BaseParallelSubmitter);
@@ -142,11 +153,62 @@ void UHDeferredShadingRenderer::RenderBasePass(UHRenderBuilder& RenderBuilder)
 	GraphicInterface->EndCmdDebug(RenderBuilder.GetCmdList());
 }
 
+// material resolve of visibility buffer, each material draws the screen tiles classified for it
+// attributes are reconstructed from the triangle id, so every pixel is shaded exactly once
+void UHDeferredShadingRenderer::RenderMaterialResolve(UHRenderBuilder& RenderBuilder)
+{
+	// bindless table, they should only be bound once
+	for (size_t Idx = 0; Idx < SortedMeshShaderGroupIndex[CurrentFrameRT].size(); Idx++)
+	{
+		const UHVisibilityResolveShader* ResolveShader = VisibilityResolveShaders[SortedMeshShaderGroupIndex[CurrentFrameRT][Idx]].get();
+		if (ResolveShader != nullptr)
+		{
+			std::vector<VkDescriptorSet> BindlessTableSets = { TextureTable->GetDescriptorSet(CurrentFrameRT)
+				, SamplerTable->GetDescriptorSet(CurrentFrameRT)
+				, MeshletTable->GetDescriptorSet(CurrentFrameRT)
+				, PositionTable->GetDescriptorSet(CurrentFrameRT)
+				, UV0Table->GetDescriptorSet(CurrentFrameRT)
+				, MeshletDataTable->GetDescriptorSet(CurrentFrameRT)
+				, NormalTable->GetDescriptorSet(CurrentFrameRT)
+				, TangentTable->GetDescriptorSet(CurrentFrameRT)
+			};
+			RenderBuilder.BindDescriptorSet(ResolveShader->GetPipelineLayout(), BindlessTableSets, GTextureTableSpace);
+			break;
+		}
+	}
+
+	for (size_t Idx = 0; Idx < SortedMeshShaderGroupIndex[CurrentFrameRT].size(); Idx++)
+	{
+		const int32_t GroupIndex = SortedMeshShaderGroupIndex[CurrentFrameRT][Idx];
+		const UHVisibilityResolveShader* ResolveShader = VisibilityResolveShaders[GroupIndex].get();
+		if (VisibleMeshShaderData[CurrentFrameRT][GroupIndex].size() == 0 || ResolveShader == nullptr
+			|| static_cast<size_t>(GroupIndex) >= GVisibilityDrawArgs->GetElementCount())
+		{
+			continue;
+		}
+
+		GraphicInterface->BeginCmdDebug(RenderBuilder.GetCmdList(), "Resolving material " + ResolveShader->GetMaterialCache()->GetName());
+
+		RenderBuilder.BindGraphicState(ResolveShader->GetState());
+		RenderBuilder.BindDescriptorSet(ResolveShader->GetPipelineLayout(), ResolveShader->GetDescriptorSet(CurrentFrameRT));
+		RenderBuilder.BindMaterialArena(ResolveShader, CurrentFrameRT);
+
+		// the vertex count is filled by classification, tiles without this material are never drawn
+		UHVisibilityResolveConstants Constants;
+		Constants.MaterialIndex = static_cast<uint32_t>(GroupIndex);
+		RenderBuilder.PushConstant(ResolveShader->GetPipelineLayout(), VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT
+			, sizeof(UHVisibilityResolveConstants), &Constants);
+		RenderBuilder.DrawIndirect(GVisibilityDrawArgs->GetBuffer(), GroupIndex * sizeof(VkDrawIndirectCommand));
+
+		GraphicInterface->EndCmdDebug(RenderBuilder.GetCmdList());
+	}
+}
+
 // base pass task, called by worker thread
 void UHDeferredShadingRenderer::BasePassTask(int32_t ThreadIdx)
 {
 	// simply separate buffer recording into N threads
-	const int32_t MaxCount = static_cast<int32_t>(OpaquesToRender.size());
+	const int32_t MaxCount = static_cast<int32_t>(OpaquesToRender[CurrentFrameRT].size());
 	const int32_t RendererCount = (MaxCount + NumParallelRenderSubmitters) / NumParallelRenderSubmitters;
 	const int32_t StartIdx = std::min(RendererCount * ThreadIdx, MaxCount);
 	const int32_t EndIdx = (ThreadIdx == NumParallelRenderSubmitters - 1) ? MaxCount : std::min(StartIdx + RendererCount, MaxCount);
@@ -180,7 +242,7 @@ void UHDeferredShadingRenderer::BasePassTask(int32_t ThreadIdx)
 	const uint32_t PrevFrame = (CurrentFrameRT - 1) % GMaxFrameInFlight;
 	for (int32_t I = StartIdx; I < EndIdx; I++)
 	{
-		const UHMeshRendererComponent* Renderer = OpaquesToRender[I];
+		const UHMeshRendererComponent* Renderer = OpaquesToRender[CurrentFrameRT][I];
 		const UHMaterial* Mat = Renderer->GetMaterial();
 		const int32_t RendererIdx = Renderer->GetBufferDataIndex();
 		UHMesh* Mesh = Renderer->GetMesh();
@@ -203,8 +265,9 @@ void UHDeferredShadingRenderer::BasePassTask(int32_t ThreadIdx)
 		RenderBuilder.BindVertexBuffer(Mesh->GetPositionBuffer()->GetBuffer());
 		RenderBuilder.BindIndexBuffer(Mesh);
 		RenderBuilder.BindDescriptorSet(BaseShader->GetPipelineLayout(), BaseShader->GetDescriptorSet(CurrentFrameRT));
+		RenderBuilder.BindMaterialArena(BaseShader, CurrentFrameRT);
 
-		RenderBuilder.DrawIndexed(Mesh->GetIndicesCount());
+		RenderBuilder.DrawIndexed(Mesh->GetIndicesCount(), RendererIdx);
 
 		if (bOcclusionTest)
 		{
@@ -216,8 +279,6 @@ void UHDeferredShadingRenderer::BasePassTask(int32_t ThreadIdx)
 
 	RenderBuilder.EndCommandBuffer();
 
-#if WITH_EDITOR
 	ThreadDrawCalls[ThreadIdx] += RenderBuilder.DrawCalls;
 	ThreadOccludedCalls[ThreadIdx] += RenderBuilder.OccludedCalls;
-#endif
 }
\ No newline at end of file
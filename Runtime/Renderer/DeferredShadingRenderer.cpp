@@ -35,6 +35,11 @@ bool UHDeferredShadingRenderer::IsNeedReset()
 	return bIsNeedResetGT;
 }
 
+void UHDeferredShadingRenderer::SetOffscreenCapture(UHOffscreenCapture* InCapture)
+{
+	OffscreenCapture = InCapture;
+}
+
 // function for resize buffers, called when rendering resolution changes
 void UHDeferredShadingRenderer::Resize()
 {
@@ -42,6 +47,7 @@ void UHDeferredShadingRenderer::Resize()
 
 	ReleaseRenderPassObjects();
 	RelaseRenderingBuffers();
+	UpdateRenderResolution();
 	CreateRenderingBuffers();
 	CreateRenderPasses();
 	CreateRenderFrameBuffers();
@@ -77,18 +83,38 @@ void UHDeferredShadingRenderer::Update()
 		return;
 	}
 
+	// the GPU frame used this slot last time must be done before uploading to it again
+	// this is the only GT wait for GPU, so GT can advance while GPU is still working on the other slot
+	{
+		UH_TRACE_SCOPE("WaitFrameSlot");
+		SceneRenderQueue.WaitFrame(CurrentFrameGT);
+	}
+
+#if WITH_EDITOR
+	// the frame that used this slot is done, measure its latency from GT begin to GPU completion
+	const UHClock::time_point FrameBeginTime = UHClock::now();
+	if (FrameBeginTimes[CurrentFrameGT] != UHClock::time_point())
+	{
+		FrameLatency = std::chrono::duration<float, std::milli>(FrameBeginTime - FrameBeginTimes[CurrentFrameGT]).count();
+	}
+	FrameBeginTimes[CurrentFrameGT] = FrameBeginTime;
+#endif
+
 	FrustumCulling();
 
 	// kick off UploadDataAsyncTask and collect visible renderer/meshshader instance in parallel
+	// the first GT worker is used, RT could be using the submitter workers at the same time
+	UHThread* UploadWorker = WorkerThreads[NumParallelRenderSubmitters].get();
 	static UHUploadDataAsyncTask UploadDataAsyncTask;
 	UploadDataAsyncTask.Init(this);
-	WorkerThreads[0]->ScheduleTask(&UploadDataAsyncTask);
-	WorkerThreads[0]->WakeThread();
+	UploadWorker->ScheduleTask(&UploadDataAsyncTask);
+	UploadWorker->WakeThread();
 
 	CollectVisibleRenderer();
 	CollectMeshShaderInstance();
+	CollectTopASInstances();
 
-	WorkerThreads[0]->WaitTask();
+	UploadWorker->WaitTask();
 }
 
 void UHDeferredShadingRenderer::NotifyRenderThread()
@@ -100,12 +126,24 @@ void UHDeferredShadingRenderer::NotifyRenderThread()
 		return;
 	}
 
+	// GT has collected and uploaded this frame into the slot of CurrentFrameGT while RT was recording the previous frame
+	// RT takes one frame at a time, so the previous frame must be recorded before handing over this one
+	{
+		UH_TRACE_SCOPE("WaitRenderThread");
+		RenderThread->WaitTask();
+	}
+
 	const UHRenderingSettings& RenderingSettings = ConfigInterface->RenderingSetting();
 
 	// sync value before wake up RT thread
 	CurrentFrameRT = CurrentFrameGT;
+#if WITH_EDITOR
+	CopyEditorDrawData();
+#endif
 	RTParams.bIsSwapChainReset = bIsSwapChainResetGT;
 	RTParams.bEnableAsyncCompute = RenderingSettings.bEnableAsyncCompute;
+	RTParams.bAsyncRTShadow = RenderingSettings.bAsyncRTShadow;
+	RTParams.bAsyncRTIndirectLight = RenderingSettings.bAsyncRTIndirectLight;
 	RTParams.bEnableRendering = CurrentScene->GetMainCamera() && CurrentScene->GetMainCamera()->IsEnabled();
 	RTParams.bEnableSkyLight = CurrentScene->GetSkyLight() && CurrentScene->GetSkyLight()->IsEnabled();
 	RTParams.bNeedRefraction = bHasRefractionMaterialGT;
@@ -119,6 +157,17 @@ void UHDeferredShadingRenderer::NotifyRenderThread()
 	RTParams.bEnableRTReflection = RenderingSettings.bEnableRTReflection;
 	RTParams.bEnableRTIndirectLighting = RenderingSettings.bEnableRTIndirectLighting;
 
+	// adaptive RT rays
+	UpdateRTRayBudget();
+	RTParams.bEnableRTAdaptiveRays = RenderingSettings.bEnableRTAdaptiveRays;
+	RTParams.RTReflectionSmoothCutoff = RenderingSettings.RTReflectionSmoothCutoff;
+	RTParams.RTRayPressure = RTRayPressure;
+
+	// RT result cache, it relies on the history depth
+	RTParams.bEnableRTResultCache = RenderingSettings.bEnableRTResultCache && GHistoryDepth != nullptr;
+	RTParams.bResetRTCache = bResetRTCacheGT || bNeedGenerateSH9;
+	RTParams.RTCacheInvalidationCount = static_cast<uint32_t>(RTCacheInvalidationsCPU.size());
+
 	RTParams.bEnableOcclusionQuery = RenderingSettings.bEnableHardwareOcclusion;
 	RTParams.OcclusionThreshold = RenderingSettings.OcclusionTriangleThreshold;
 	RTParams.bEnableDepthPrepass = GraphicInterface->IsDepthPrePassEnabled();
@@ -130,25 +179,53 @@ void UHDeferredShadingRenderer::NotifyRenderThread()
 
 	// reset states
 	bNeedGenerateSH9 = false;
+	bResetRTCacheGT = false;
 
-	// wake render thread
+	// wake render thread, GT doesn't wait it here and moves on to the next frame slot
 	RenderThread->WakeThread();
+	CurrentFrameGT = (CurrentFrameGT + 1) % GMaxFrameInFlight;
+}
 
-	// only wait RT in editor, shipped build will wait in somewhere else by calling WaitPreviousRenderTask()
-	if (GIsEditor)
+void UHDeferredShadingRenderer::WaitPreviousRenderTask()
+{
+	// wait render thread done, used before changing objects that RT could be recording with
+	if (RenderThread != nullptr)
 	{
 		RenderThread->WaitTask();
 	}
+}
 
-	// advance frame after rendering is done
-	CurrentFrameGT = (CurrentFrameGT + 1) % GMaxFrameInFlight;
+#if WITH_EDITOR
+void UHDeferredShadingRenderer::CopyEditorDrawData()
+{
+	// the slot was used two frames ago, RT is done with it after the wait in NotifyRenderThread
+	ClearEditorDrawData(CurrentFrameRT);
+
+	const ImDrawData* SrcData = ImGui::GetDrawData();
+	if (SrcData == nullptr || !SrcData->Valid)
+	{
+		return;
+	}
+
+	// copy the header and clone the draw lists, the lists in context are rebuilt in the next GT frame
+	ImDrawData& DstData = EditorDrawData[CurrentFrameRT];
+	DstData = *SrcData;
+	for (int32_t Idx = 0; Idx < SrcData->CmdListsCount; Idx++)
+	{
+		DstData.CmdLists[Idx] = SrcData->CmdLists[Idx]->CloneOutput();
+	}
 }
 
-void UHDeferredShadingRenderer::WaitPreviousRenderTask()
+void UHDeferredShadingRenderer::ClearEditorDrawData(uint32_t InFrameIdx)
 {
-	// wait render thread done
-	RenderThread->WaitTask();
+	ImDrawData& DrawData = EditorDrawData[InFrameIdx];
+	for (int32_t Idx = 0; Idx < DrawData.CmdLists.Size; Idx++)
+	{
+		IM_DELETE(DrawData.CmdLists[Idx]);
+	}
+	DrawData.Clear();
 }
+#endif
 
 #if WITH_EDITOR
 enum class UHDebugViewMode : uint32_t
@@ -250,6 +327,18 @@ float UHDeferredShadingRenderer::GetRenderThreadTime() const
 	return RenderThreadTime;
 }
 
+float UHDeferredShadingRenderer::GetFrameLatency() const
+{
+	return FrameLatency;
+}
+
+uint32_t UHDeferredShadingRenderer::GetFramesInFlight() const
+{
+	return FramesInFlight;
+}
+
+#endif
+
 int32_t UHDeferredShadingRenderer::GetDrawCallCount() const
 {
 	return DrawCalls;
@@ -260,11 +349,46 @@ int32_t UHDeferredShadingRenderer::GetOccludedCallCount() const
 	return OccludedCalls;
 }
 
-#endif
+// estimated attachment traffic of the geometry passes per frame, it's for comparing base pass and visibility buffer
+// compression and caches are not considered
+float UHDeferredShadingRenderer::GetGeometryBandwidthMB() const
+{
+	if (GSceneDepth == nullptr)
+	{
+		return 0.0f;
+	}
+
+	const float PixelCount = static_cast<float>(RenderResolution.width) * static_cast<float>(RenderResolution.height);
+	const float DepthBytes = static_cast<float>(GTextureFormatData[UH_ENUM_VALUE(GSceneDepth->GetFormat())].ByteSize);
+
+	float GBufferBytes = 0.0f;
+	for (const UHRenderTexture* GBuffer : GSceneBuffers)
+	{
+		if (GBuffer != nullptr)
+		{
+			GBufferBytes += static_cast<float>(GTextureFormatData[UH_ENUM_VALUE(GBuffer->GetFormat())].ByteSize);
+		}
+	}
+
+	float BytesPerPixel = 0.0f;
+	if (GraphicInterface->IsVisibilityBufferEnabled() && GSceneVisibility != nullptr)
+	{
+		// depth and id are written once, the id is read by both classification and resolve, GBuffer is written once
+		const float VisibilityBytes = static_cast<float>(GTextureFormatData[UH_ENUM_VALUE(GSceneVisibility->GetFormat())].ByteSize);
+		BytesPerPixel = DepthBytes + VisibilityBytes * 3.0f + GBufferBytes;
+	}
+	else
+	{
+		// base pass tests depth again if prepass is on
+		BytesPerPixel = DepthBytes * (RTParams.bEnableDepthPrepass ? 2.0f : 1.0f) + GBufferBytes;
+	}
+
+	return PixelCount * BytesPerPixel / (1024.0f * 1024.0f);
+}
 
 void UHDeferredShadingRenderer::UploadDataBuffers()
 {
-	UHGameTimerScope Scope("UploadDataBuffers", false);
+	UH_TRACE_SCOPE("UploadDataBuffers");
 
 	UHCameraComponent* CurrentCamera = CurrentScene->GetMainCamera();
 	if (!CurrentCamera)
@@ -300,13 +424,18 @@ void UHDeferredShadingRenderer::UploadDataBuffers()
 	SystemConstantsCPU.NumDirLights = static_cast<uint32_t>(CurrentScene->GetDirLightCount());
 	SystemConstantsCPU.NumPointLights = static_cast<uint32_t>(CurrentScene->GetPointLightCount());
 	SystemConstantsCPU.NumSpotLights = static_cast<uint32_t>(CurrentScene->GetSpotLightCount());
-	SystemConstantsCPU.MaxPointLightPerTile = MaxPointLightPerTile;
-	SystemConstantsCPU.MaxSpotLightPerTile = MaxSpotLightPerTile;
-
-	uint32_t Dummy;
-	GetLightCullingTileCount(SystemConstantsCPU.LightTileCountX, Dummy);
 
-	if (RenderingSettings.bTemporalAA)
+	// light cluster grid follows the camera projection, the froxels are only rebuilt when it changes
+	LightCluster.UpdateGrid(CurrentCamera->GetProjectionMatrixNonJittered(), CurrentCamera->GetNearPlane(), CurrentCamera->GetCullingDistance());
+	SystemConstantsCPU.LightClusterCountX = LightCluster.GetClusterCountX();
+	SystemConstantsCPU.LightClusterCountY = LightCluster.GetClusterCountY();
+	SystemConstantsCPU.LightClusterCountZ = LightCluster.GetClusterCountZ();
+	SystemConstantsCPU.LightClusterSliceScale = LightCluster.GetSliceScale();
+	SystemConstantsCPU.LightClusterSliceBias = LightCluster.GetSliceBias();
+	SystemConstantsCPU.LightClusterTileSize = UHLightCluster::TileSize;
+
+	// upscaler reconstructs from jittered samples, so it always needs the jitter
+	if (RenderingSettings.bTemporalAA || bEnableTemporalUpscale)
 	{
 		UHVector4 Offset = CurrentCamera->GetJitterOffset();
 		SystemConstantsCPU.JitterOffsetX = Offset.x;
@@ -343,6 +472,7 @@ void UHDeferredShadingRenderer::UploadDataBuffers()
 	FeatureData |= (GraphicInterface->IsHDRAvailable()) ? UH_ENUM_VALUE_U(UHSystemRenderFeatureBits::FeatureHDR) : 0;
 	FeatureData |= RenderingSettings.bDenoiseRayTracing ? UH_ENUM_VALUE_U(UHSystemRenderFeatureBits::FeatureUseSmoothNormalForRaytracing) : 0;
 	FeatureData |= (bSupportRayTracing && RenderingSettings.bEnableRTIndirectLighting) ? UH_ENUM_VALUE_U(UHSystemRenderFeatureBits::FeatureRTIndirectLight) : 0;
+	FeatureData |= (GraphicInterface->IsVertexCompressionEnabled()) ? UH_ENUM_VALUE_U(UHSystemRenderFeatureBits::FeatureVertexCompression) : 0;
 	SystemConstantsCPU.SystemRenderFeature = FeatureData;
 
 	SystemConstantsCPU.DirectionalShadowRayTMax = RenderingSettings.RTShadowTMax;
@@ -392,12 +522,12 @@ void UHDeferredShadingRenderer::UploadDataBuffers()
 			const int32_t RendererIdx = Renderer->GetBufferDataIndex();
 
 			UHObjectConstants Constant = Renderer->GetConstants();
-			ObjectConstantsCPU[RendererIdx] = Renderer->GetConstants();
+			ObjectConstantsCPU[RendererIdx] = Constant;
 
 			// setup occlusion data if necessary
 			if (RenderingSettings.bEnableHardwareOcclusion)
 			{
-				Constant.GWorld = Renderer->GetWorldBoundMatrix();
+				Constant.GWorld = UHMathHelpers::MatrixTo3x4(CubeMesh->GetPositionDecodeMatrix() * Renderer->GetWorldBoundMatrix());
 				OcclusionConstantsCPU[RendererIdx] = Constant;
 			}
 
@@ -407,11 +537,12 @@ void UHDeferredShadingRenderer::UploadDataBuffers()
 
 			Renderer->SetRenderDirty(false, CurrentFrameGT);
 
-			// copy material data only when it's dirty
+			// copy material data only when it's dirty, the arena skips the upload if the parameter version is unchanged
 			UHMaterial* Mat = Renderer->GetMaterial();
 			if (Mat->IsRenderDirty(CurrentFrameGT))
 			{
-				Mat->UploadMaterialData(CurrentFrameGT);
+				Mat->UpdateMaterialData();
+				GMaterialArena.Upload(Mat, CurrentFrameGT);
 				Mat->SetRenderDirty(false, CurrentFrameGT);
 			}
 		}
@@ -469,6 +600,9 @@ void UHDeferredShadingRenderer::UploadDataBuffers()
 		GSpotLightBuffer[CurrentFrameGT]->UploadAllData(SpotLightConstantsCPU.data());
 	}
 
+	// build light clusters after the light data is ready
+	UploadLightClusters(CurrentCamera);
+
 	// upload SH9 data, for now use the 4th mip slice in it
 	if (bNeedGenerateSH9)
 	{
@@ -510,6 +644,9 @@ void UHDeferredShadingRenderer::UploadDataBuffers()
 
 			RTSoftShadowShader->GetConstants(CurrentFrameGT)->UploadData(&SoftShadowConsts, 0);
 		}
+
+		// invalidation boxes of the RT result cache
+		CollectRTCacheInvalidations();
 	}
 }
 
@@ -520,7 +657,7 @@ uint32_t UHDeferredShadingRenderer::GetCurrentFrameIndex() const
 
 void UHDeferredShadingRenderer::FrustumCulling()
 {
-	UHGameTimerScope Scope("FrustumCulling", false);
+	UH_TRACE_SCOPE("FrustumCulling");
 
 	const UHCameraComponent* CurrentCamera = CurrentScene->GetMainCamera();
 	if (!CurrentCamera)
@@ -537,14 +674,16 @@ void UHDeferredShadingRenderer::FrustumCulling()
 	class UHFrustumCullingAsyncTask : public UHAsyncTask
 	{
 	public:
-		void Init(UHScene* InScene, const int32_t InNumWorkerThreads)
+		void Init(UHScene* InScene, const int32_t InNumWorkerThreads, const int32_t InFirstWorkerIdx)
 		{
 			CurrentScene = InScene;
 			NumWorkerThreads = InNumWorkerThreads;
+			FirstWorkerIdx = InFirstWorkerIdx;
 		}
 
-		virtual void DoTask(const int32_t ThreadIdx) override
+		virtual void DoTask(const int32_t WorkerIdx) override
 		{
+			const int32_t ThreadIdx = WorkerIdx - FirstWorkerIdx;
 			const UHCameraComponent* CurrentCamera = CurrentScene->GetMainCamera();
 			const UHBoundingFrustum& CameraFrustum = CurrentCamera->GetBoundingFrustum();
 			const std::vector<UHMeshRendererComponent*>& Renderers = CurrentScene->GetAllRenderers();
@@ -574,18 +713,20 @@ void UHDeferredShadingRenderer::FrustumCulling()
 	private:
 		UHScene* CurrentScene = nullptr;
 		int32_t NumWorkerThreads = 0;
+		int32_t FirstWorkerIdx = 0;
 	};
 	static std::vector<UHFrustumCullingAsyncTask> Tasks(NumParallelWorkers);
 
-	// init and wake frustum culling task, 1 thread is preserved for the upload data buffer work.
-	for (int32_t I = 1; I < NumParallelWorkers; I++)
+	// init and wake frustum culling task on GT workers, the first GT worker is preserved for the upload data buffer work.
+	const int32_t FirstCullingWorker = NumParallelRenderSubmitters + 1;
+	for (int32_t I = FirstCullingWorker; I < NumParallelWorkers; I++)
 	{
-		Tasks[I].Init(CurrentScene, NumParallelWorkers - 1);
+		Tasks[I].Init(CurrentScene, NumParallelWorkers - FirstCullingWorker, FirstCullingWorker);
 		WorkerThreads[I]->ScheduleTask(&Tasks[I]);
 		WorkerThreads[I]->WakeThread();
 	}
 
-	for (int32_t I = 1; I < NumParallelWorkers; I++)
+	for (int32_t I = FirstCullingWorker; I < NumParallelWorkers; I++)
 	{
 		WorkerThreads[I]->WaitTask();
 	}
@@ -593,7 +734,7 @@ void UHDeferredShadingRenderer::FrustumCulling()
 
 void UHDeferredShadingRenderer::CollectVisibleRenderer()
 {
-	UHGameTimerScope Scope("CollectVisibleRenderer", false);
+	UH_TRACE_SCOPE("CollectVisibleRenderer");
 
 	const UHCameraComponent* CurrentCamera = CurrentScene->GetMainCamera();
 	if (!CurrentCamera)
@@ -607,10 +748,10 @@ void UHDeferredShadingRenderer::CollectVisibleRenderer()
 	}
 
 	// recommend to reserve capacity during initialization
-	OpaquesToRender.clear();
-	MotionOpaquesToRender.clear();
-	TranslucentsToRender.clear();
-	OcclusionRenderers.clear();
+	OpaquesToRender[CurrentFrameGT].clear();
+	MotionOpaquesToRender[CurrentFrameGT].clear();
+	TranslucentsToRender[CurrentFrameGT].clear();
+	OcclusionRenderers[CurrentFrameGT].clear();
 
 	// reset counting counter
 	for (int32_t Idx = 0; Idx < MaxCountingElement; Idx++)
@@ -646,17 +787,17 @@ void UHDeferredShadingRenderer::CollectVisibleRenderer()
 
 			if (Mat->IsOpaque())
 			{
-				OpaquesToRender.push_back(Renderer);
+				OpaquesToRender[CurrentFrameGT].push_back(Renderer);
 				if (Renderer->IsMotionDirty(CurrentFrameGT) && !GraphicInterface->IsMeshShaderSupported())
 				{
-					MotionOpaquesToRender.push_back(Renderer);
+					MotionOpaquesToRender[CurrentFrameGT].push_back(Renderer);
 					Renderer->SetMotionDirty(false, CurrentFrameGT);
 				}
 			}
 
 			if (bOcclusionTest)
 			{
-				OcclusionRenderers.push_back(Renderer);
+				OcclusionRenderers[CurrentFrameGT].push_back(Renderer);
 			}
 		}
 	}
@@ -670,7 +811,7 @@ void UHDeferredShadingRenderer::CollectVisibleRenderer()
 			const UHMaterial* Mat = CountingRenderers[CountIdx][Idx]->GetMaterial();
 			if (!Mat->IsOpaque())
 			{
-				TranslucentsToRender.push_back(Renderer);
+				TranslucentsToRender[CurrentFrameGT].push_back(Renderer);
 				if (Mat->GetMaterialUsages().bUseRefraction)
 				{
 					bHasRefractionMaterialGT = true;
@@ -680,9 +821,51 @@ void UHDeferredShadingRenderer::CollectVisibleRenderer()
 	}
 }
 
+void UHDeferredShadingRenderer::CollectTopASInstances()
+{
+	UH_TRACE_SCOPE("CollectTopASInstances");
+	if (!ConfigInterface->RenderingSetting().bEnableRayTracing || !GraphicInterface->IsRayTracingEnabled() || RTInstanceCount == 0)
+	{
+		return;
+	}
+
+	// RT reads these instead of the renderers, as GT could be updating the renderers while RT is building the previous frame
+	const std::vector<UHMeshRendererComponent*>& Renderers = CurrentScene->GetAllRenderers();
+	std::vector<UHTopASInstanceState>& States = TopASInstanceStates[CurrentFrameGT];
+	States.resize(Renderers.size());
+
+	for (const UHMeshRendererComponent* Renderer : Renderers)
+	{
+		States[Renderer->GetBufferDataIndex()].Capture(Renderer);
+	}
+}
+
+static uint32_t GetMeshShaderFlags(const UHMeshRendererComponent* InRenderer, bool bOcclusionTest)
+{
+	uint32_t Flags = 0;
+	if (bOcclusionTest && !InRenderer->IsCameraInsideThisRenderer())
+	{
+		Flags |= UH_ENUM_VALUE(UHMeshShaderFlagBits::OcclusionTest);
+	}
+
+	// meshlet cones are built for front faces, they're only valid when back faces are culled
+	if (InRenderer->GetMaterial()->GetCullMode() == UHCullMode::CullBack)
+	{
+		Flags |= UH_ENUM_VALUE(UHMeshShaderFlagBits::ConeCulling);
+	}
+
+	return Flags;
+}
+
+uint32_t UHDeferredShadingRenderer::GetMeshShaderMeshletCount(const std::vector<UHMeshShaderData>& InData)
+{
+	// meshlet offsets are prefix-summed, so the total is simply the end of the last record
+	return (InData.size() > 0) ? InData.back().MeshletOffset + InData.back().MeshletCount : 0;
+}
+
 void UHDeferredShadingRenderer::CollectMeshShaderInstance()
 {
-	UHGameTimerScope Scope("CollectMeshShaderInstance", false);
+	UH_TRACE_SCOPE("CollectMeshShaderInstance");
 
 	const UHCameraComponent* CurrentCamera = CurrentScene->GetMainCamera();
 	if (!CurrentCamera || !GraphicInterface->IsMeshShaderSupported())
@@ -696,17 +879,17 @@ void UHDeferredShadingRenderer::CollectMeshShaderInstance()
 	}
 
 	// reset all counters & clear sorted visiable mesh shader group index
-	SortedMeshShaderGroupIndex.clear();
+	SortedMeshShaderGroupIndex[CurrentFrameGT].clear();
 	for (size_t Idx = 0; Idx < CurrentScene->GetMaterialCount(); Idx++)
 	{
 		MeshShaderInstancesCounter[Idx] = 0;
-		VisibleMeshShaderData[Idx].clear();
-		MotionOpaqueMeshShaderData[Idx].clear();
-		MotionTranslucentMeshShaderData[Idx].clear();
+		VisibleMeshShaderData[CurrentFrameGT][Idx].clear();
+		MotionOpaqueMeshShaderData[CurrentFrameGT][Idx].clear();
+		MotionTranslucentMeshShaderData[CurrentFrameGT][Idx].clear();
 	}
 
 	// collect visible mesh shader instances for opaque objects
-	for (UHMeshRendererComponent* Renderer : OpaquesToRender)
+	for (UHMeshRendererComponent* Renderer : OpaquesToRender[CurrentFrameGT])
 	{
 		const UHMesh* Mesh = Renderer->GetMesh();
 		const bool bOcclusionTest = RTParams.bEnableOcclusionQuery 
@@ -720,37 +903,31 @@ void UHDeferredShadingRenderer::CollectMeshShaderInstance()
 		// but the group isn't sorted, so add the material data index to the list when first instance is occurred.
 		if (NewIndex == 0)
 		{
-			SortedMeshShaderGroupIndex.push_back(MatDataIndex);
+			SortedMeshShaderGroupIndex[CurrentFrameGT].push_back(MatDataIndex);
 		}
 
+		// one record per instance, meshlets are expanded and culled in amplification shader
 		UHMeshShaderData Data;
 		Data.RendererIndex = Renderer->GetBufferDataIndex();
-		Data.bDoOcclusionTest = bOcclusionTest && !Renderer->IsCameraInsideThisRenderer() ? 1 : 0;
-		bool bClearMotionDirty = false;
-
-		for (uint32_t MeshletIdx = 0; MeshletIdx < Mesh->GetMeshletCount(); MeshletIdx++)
-		{
-			Data.MeshletIndex = MeshletIdx;
-			VisibleMeshShaderData[MatDataIndex].push_back(Data);
+		Data.MeshletCount = Mesh->GetMeshletCount();
+		Data.Flags = GetMeshShaderFlags(Renderer, bOcclusionTest);
 
-			// push to motion mesh shader data list if it's motion dirty
-			if (Renderer->IsMotionDirty(CurrentFrameGT))
-			{
-				MotionOpaqueMeshShaderData[MatDataIndex].push_back(Data);
-				bClearMotionDirty = true;
-			}
-		}
+		Data.MeshletOffset = GetMeshShaderMeshletCount(VisibleMeshShaderData[CurrentFrameGT][MatDataIndex]);
+		VisibleMeshShaderData[CurrentFrameGT][MatDataIndex].push_back(Data);
 
-		if (bClearMotionDirty)
+		// push to motion mesh shader data list if it's motion dirty
+		if (Renderer->IsMotionDirty(CurrentFrameGT))
 		{
+			Data.MeshletOffset = GetMeshShaderMeshletCount(MotionOpaqueMeshShaderData[CurrentFrameGT][MatDataIndex]);
+			MotionOpaqueMeshShaderData[CurrentFrameGT][MatDataIndex].push_back(Data);
 			Renderer->SetMotionDirty(false, CurrentFrameGT);
 		}
 	}
 
 	// collect visible mesh shader instances for translucent objects, only for motion
-	for (int32_t Idx = (int32_t)TranslucentsToRender.size() - 1; Idx >= 0; Idx--)
+	for (int32_t Idx = (int32_t)TranslucentsToRender[CurrentFrameGT].size() - 1; Idx >= 0; Idx--)
 	{
-		UHMeshRendererComponent* Renderer = TranslucentsToRender[Idx];
+		UHMeshRendererComponent* Renderer = TranslucentsToRender[CurrentFrameGT][Idx];
 		const UHMesh* Mesh = Renderer->GetMesh();
 		const bool bOcclusionTest = RTParams.bEnableOcclusionQuery 
 			&& ((int32_t)Mesh->GetIndicesCount() / 3) >= RTParams.OcclusionThreshold;
@@ -760,49 +937,55 @@ void UHDeferredShadingRenderer::CollectMeshShaderInstance()
 
 		if (NewIndex == 0)
 		{
-			SortedMeshShaderGroupIndex.push_back(MatDataIndex);
+			SortedMeshShaderGroupIndex[CurrentFrameGT].push_back(MatDataIndex);
 		}
 
 		UHMeshShaderData Data;
 		Data.RendererIndex = Renderer->GetBufferDataIndex();
-		Data.bDoOcclusionTest = bOcclusionTest && !Renderer->IsCameraInsideThisRenderer() ? 1 : 0;
+		Data.MeshletCount = Mesh->GetMeshletCount();
+		Data.Flags = GetMeshShaderFlags(Renderer, bOcclusionTest);
 
 		// translucent always output motion for now
-		for (uint32_t MeshletIdx = 0; MeshletIdx < Mesh->GetMeshletCount(); MeshletIdx++)
-		{
-			Data.MeshletIndex = MeshletIdx;
-			MotionTranslucentMeshShaderData[MatDataIndex].push_back(Data);
-		}
+		Data.MeshletOffset = GetMeshShaderMeshletCount(MotionTranslucentMeshShaderData[CurrentFrameGT][MatDataIndex]);
+		MotionTranslucentMeshShaderData[CurrentFrameGT][MatDataIndex].push_back(Data);
 	}
 
 	// mesh shader group size shouldn't be bigger than total material count
-	assert(SortedMeshShaderGroupIndex.size() <= CurrentScene->GetMaterialCount());
+	assert(SortedMeshShaderGroupIndex[CurrentFrameGT].size() <= CurrentScene->GetMaterialCount());
 
 	for (size_t Idx = 0; Idx < CurrentScene->GetMaterialCount(); Idx++)
 	{
-		if (VisibleMeshShaderData[Idx].size() > 0)
+		if (VisibleMeshShaderData[CurrentFrameGT][Idx].size() > 0)
 		{
-			GMeshShaderData[CurrentFrameGT][Idx]->UploadData(VisibleMeshShaderData[Idx].data(), 0, VisibleMeshShaderData[Idx].size() * sizeof(UHMeshShaderData));
+			GMeshShaderData[CurrentFrameGT][Idx]->UploadData(VisibleMeshShaderData[CurrentFrameGT][Idx].data(), 0, VisibleMeshShaderData[CurrentFrameGT][Idx].size() * sizeof(UHMeshShaderData));
 		}
 
-		if (MotionOpaqueMeshShaderData[Idx].size() > 0)
+		if (MotionOpaqueMeshShaderData[CurrentFrameGT][Idx].size() > 0)
 		{
-			GMotionOpaqueShaderData[CurrentFrameGT][Idx]->UploadData(MotionOpaqueMeshShaderData[Idx].data(), 0, MotionOpaqueMeshShaderData[Idx].size() * sizeof(UHMeshShaderData));
+			GMotionOpaqueShaderData[CurrentFrameGT][Idx]->UploadData(MotionOpaqueMeshShaderData[CurrentFrameGT][Idx].data(), 0, MotionOpaqueMeshShaderData[CurrentFrameGT][Idx].size() * sizeof(UHMeshShaderData));
 		}
 
-		if (MotionTranslucentMeshShaderData[Idx].size() > 0)
+		if (MotionTranslucentMeshShaderData[CurrentFrameGT][Idx].size() > 0)
 		{
-			GMotionTranslucentShaderData[CurrentFrameGT][Idx]->UploadData(MotionTranslucentMeshShaderData[Idx].data(), 0
-				, MotionTranslucentMeshShaderData[Idx].size() * sizeof(UHMeshShaderData));
+			GMotionTranslucentShaderData[CurrentFrameGT][Idx]->UploadData(MotionTranslucentMeshShaderData[CurrentFrameGT][Idx].data(), 0
+				, MotionTranslucentMeshShaderData[CurrentFrameGT][Idx].size() * sizeof(UHMeshShaderData));
 		}
 	}
 }
 
-void UHDeferredShadingRenderer::GetLightCullingTileCount(uint32_t& TileCountX, uint32_t& TileCountY)
+void UHDeferredShadingRenderer::UploadLightClusters(const UHCameraComponent* InCamera)
 {
-	// safely round up the tile counts, doing culling at half resolution
-	TileCountX = ((RenderResolution.width >> 1) + LightCullingTileSize) / LightCullingTileSize;
-	TileCountY = ((RenderResolution.height >> 1) + LightCullingTileSize) / LightCullingTileSize;
+	UH_TRACE_SCOPE("UploadLightClusters");
+
+	// the lists are always uploaded, consumers read the offset table even there is no light
+	const UHMatrix4x4 View = InCamera->GetViewMatrix();
+	LightCluster.AssignPointLights(PointLightConstantsCPU, View);
+	LightCluster.AssignSpotLights(SpotLightConstantsCPU, View);
+
+	GPointLightListBuffer[CurrentFrameGT]->UploadAllData(const_cast<uint32_t*>(LightCluster.GetPointLightList().data())
+		, LightCluster.GetPointLightListSize() * sizeof(uint32_t));
+	GSpotLightListBuffer[CurrentFrameGT]->UploadAllData(const_cast<uint32_t*>(LightCluster.GetSpotLightList().data())
+		, LightCluster.GetSpotLightListSize() * sizeof(uint32_t));
 }
 
 UHTextureCube* UHDeferredShadingRenderer::GetCurrentSkyCube() const
@@ -825,13 +1008,392 @@ UHTextureCube* UHDeferredShadingRenderer::GetCurrentSkyCube() const
 	return CurrSkyCube;
 }
 
+void UHDeferredShadingRenderer::BuildSceneRenderGraph(bool bIsPresentedPreviously)
+{
+	UH_TRACE_SCOPE("BuildSceneRenderGraph");
+	SceneRenderGraph.Reset();
+	SceneRenderGraph.SetQueueFamilies(GraphicInterface->GetQueueFamily().GraphicsFamily.value(), GraphicInterface->GetQueueFamily().ComputesFamily.value());
+
+	// textures are imported with their current layout, most passes transition their own intermediates
+	// so only the resources shared between passes are declared with explicit layouts
+	auto ImportTexture = [this](std::string InName, UHRenderTexture* InTexture, bool bIsOutput)
+		{
+			const VkImageLayout CurrentLayout = (InTexture != nullptr) ? InTexture->GetImageLayout() : VK_IMAGE_LAYOUT_UNDEFINED;
+			const UHRenderGraphResource Resource = SceneRenderGraph.ImportTexture(InName, InTexture, CurrentLayout, bIsOutput);
+			if (InTexture != nullptr && InTexture->IsSharedAcrossQueues())
+			{
+				SceneRenderGraph.SetSharedAcrossQueues(Resource);
+			}
+			return Resource;
+		};
+
+	// scene result and history buffers are consumed after the graph
+	const UHRenderGraphResource SceneResult = ImportTexture("SceneResult", GSceneResult, true);
+	const UHRenderGraphResource PostProcessRT = ImportTexture("PostProcessRT", GPostProcessRT, true);
+	const UHRenderGraphResource PreviousSceneResult = ImportTexture("PreviousSceneResult", GPreviousSceneResult, true);
+	const UHRenderGraphResource UpscaledSceneResult = ImportTexture("UpscaledSceneResult", GUpscaledSceneResult, true);
+	const UHRenderGraphResource HistoryDepth = ImportTexture("HistoryDepth", GHistoryDepth, true);
+	const UHRenderGraphResource HistoryNormal = ImportTexture("HistoryNormal", GHistoryNormal, true);
+	const UHRenderGraphResource SceneDepth = ImportTexture("SceneDepth", GSceneDepth, false);
+	const UHRenderGraphResource OpaqueSceneResult = ImportTexture("OpaqueSceneResult", GOpaqueSceneResult, false);
+	const UHRenderGraphResource MotionVector = ImportTexture("MotionVector", GMotionVectorRT, false);
+	const UHRenderGraphResource SceneVisibility = ImportTexture("SceneVisibility", GSceneVisibility, false);
+	// Hi-Z is consumed by the next frame
+	const UHRenderGraphResource HiZ = ImportTexture("HiZBuffer", GHiZBuffer, true);
+	const UHRenderGraphResource RTShadow = ImportTexture("RTSoftShadow", GRTSoftShadow, false);
+	const UHRenderGraphResource SmoothSceneNormal = ImportTexture("SmoothSceneNormal", GSmoothSceneNormal, false);
+	const UHRenderGraphResource RTReflection = ImportTexture("RTReflectionResult", GRTReflectionResult, false);
+	const UHRenderGraphResource RTIndirectLight = ImportTexture("RTIndirectDiffuse", GRTIndirectDiffuse, false);
+
+	// the resources touched by RT shadow and RT indirect light are declared, so the graph can schedule them on async compute queue
+	const UHRenderGraphResource GBufferA = ImportTexture("GBufferA", GSceneDiffuse, false);
+	const UHRenderGraphResource GBufferB = ImportTexture("GBufferB", GSceneNormal, false);
+	const UHRenderGraphResource GBufferC = ImportTexture("GBufferC", GSceneMaterial, false);
+	const UHRenderGraphResource SceneMip = ImportTexture("SceneMip", GSceneMip, false);
+	const UHRenderGraphResource SceneData = ImportTexture("SceneData", GSceneData, false);
+	const UHRenderGraphResource RTShadowData = ImportTexture("RTShadowData", GRTShadowData, false);
+	const UHRenderGraphResource RTReceiveLightBits = ImportTexture("RTReceiveLightBits", GRTReceiveLightBits, false);
+	const UHRenderGraphResource RTIndirectOcclusion = ImportTexture("RTIndirectOcclusion", GRTIndirectOcclusion, false);
+	const UHRenderGraphResource RTIndirectDiffuseHistory = ImportTexture("RTIndirectDiffuseHistory", GRTIndirectDiffuseHistory, true);
+	const UHRenderGraphResource RTIndirectOcclusionHistory = ImportTexture("RTIndirectOcclusionHistory", GRTIndirectOcclusionHistory, true);
+	const UHRenderGraphResource RTIndirectTileRate = ImportTexture("RTIndirectTileRate", GRTIndirectTileRate, false);
+
+	const bool bNeedRTShadow = RTParams.bEnableRayTracing && RTParams.bEnableRTShadow;
+	const bool bNeedRTReflection = RTParams.bEnableRayTracing && RTParams.bEnableRTReflection;
+	const bool bNeedRTIndirectLight = RTParams.bEnableRayTracing && RTParams.bEnableRTIndirectLighting;
+
+	if (bIsPresentedPreviously)
+	{
+		SceneRenderGraph.AddPass("ResolveOcclusionResult", [this](UHRenderBuilder& RenderBuilder) { ResolveOcclusionResult(RenderBuilder); }, true);
+	}
+
+	const bool bNeedVisibilityBuffer = GraphicInterface->IsVisibilityBufferEnabled() && GSceneVisibility != nullptr;
+
+	int32_t Pass = SceneRenderGraph.AddPass("DepthPrePass", [this](UHRenderBuilder& RenderBuilder) { RenderDepthPrePass(RenderBuilder); });
+	SceneRenderGraph.Write(Pass, SceneDepth, GRenderGraphAnyLayout);
+	if (bNeedVisibilityBuffer)
+	{
+		SceneRenderGraph.Write(Pass, SceneVisibility, GRenderGraphAnyLayout, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+
+		// the draw args and tile lists aren't graph resources, the pass guards them with its own barriers
+		Pass = SceneRenderGraph.AddPass("VisibilityClassifyPass", [this](UHRenderBuilder& RenderBuilder) { DispatchVisibilityClassify(RenderBuilder); }, true);
+		SceneRenderGraph.Read(Pass, SceneVisibility, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+	}
+
+	Pass = SceneRenderGraph.AddPass("BasePass", [this](UHRenderBuilder& RenderBuilder) { RenderBasePass(RenderBuilder); });
+	if (bNeedVisibilityBuffer)
+	{
+		SceneRenderGraph.Read(Pass, SceneVisibility, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+	}
+	SceneRenderGraph.Write(Pass, SceneResult, GRenderGraphAnyLayout, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL);
+	SceneRenderGraph.Write(Pass, SceneDepth, GRenderGraphAnyLayout);
+	SceneRenderGraph.Write(Pass, GBufferA, GRenderGraphAnyLayout, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+	SceneRenderGraph.Write(Pass, GBufferB, GRenderGraphAnyLayout, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+	SceneRenderGraph.Write(Pass, GBufferC, GRenderGraphAnyLayout, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+	SceneRenderGraph.Write(Pass, SceneMip, GRenderGraphAnyLayout);
+	SceneRenderGraph.Write(Pass, SceneData, GRenderGraphAnyLayout);
+
+	Pass = SceneRenderGraph.AddPass("OcclusionPass", [this](UHRenderBuilder& RenderBuilder) { RenderOcclusionPass(RenderBuilder); }, true);
+	SceneRenderGraph.Read(Pass, SceneDepth, GRenderGraphAnyLayout);
+
+	Pass = SceneRenderGraph.AddPass("MotionPass", [this](UHRenderBuilder& RenderBuilder) { RenderMotionPass(RenderBuilder); });
+	SceneRenderGraph.Read(Pass, SceneDepth, GRenderGraphAnyLayout, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+	SceneRenderGraph.Write(Pass, MotionVector, GRenderGraphAnyLayout, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+	SceneRenderGraph.Write(Pass, SceneMip, GRenderGraphAnyLayout, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+	SceneRenderGraph.Write(Pass, SceneData, GRenderGraphAnyLayout, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+
+	// Hi-Z for the amplification shader culling in the next frame, it transitions its own mips
+	if (GraphicInterface->IsMeshShaderSupported())
+	{
+		Pass = SceneRenderGraph.AddPass("HiZPass", [this](UHRenderBuilder& RenderBuilder) { GenerateHiZPass(RenderBuilder); });
+		SceneRenderGraph.Read(Pass, SceneDepth, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+		SceneRenderGraph.Write(Pass, HiZ, GRenderGraphAnyLayout);
+	}
+
+	// AS build, light collection and SH9 write buffers only, they're treated as side effects
+	if (RTParams.bEnableAsyncCompute)
+	{
+		SceneRenderGraph.AddPass("AsyncComputeBarriers", [this](UHRenderBuilder& RenderBuilder)
+			{
+				// transition structured buffer used in async compute queue to SRV
+				if (RTParams.bNeedGenerateSH9)
+				{
+					VkPipelineStageFlags SH9Stages = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_RAY_TRACING_SHADER_BIT_KHR;
+					RenderBuilder.ResourceBarrier(GSH9Data->GetBuffer(), GSH9Data->GetBufferSize()
+						, VK_ACCESS_SHADER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT
+						, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, SH9Stages);
+				}
+
+				if (CurrentScene->GetPointLightCount() > 0 || CurrentScene->GetSpotLightCount() > 0)
+				{
+					RenderBuilder.ResourceBarrier(GInstanceLightsBuffer[CurrentFrameRT]->GetBuffer(), GInstanceLightsBuffer[CurrentFrameRT]->GetBufferSize()
+						, VK_ACCESS_SHADER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT
+						, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_RAY_TRACING_SHADER_BIT_KHR);
+				}
+			}, true);
+	}
+	else
+	{
+		SceneRenderGraph.AddPass("BuildTopLevelAS", [this](UHRenderBuilder& RenderBuilder) { BuildTopLevelAS(RenderBuilder); }, true);
+		SceneRenderGraph.AddPass("CollectLightPass", [this](UHRenderBuilder& RenderBuilder) { CollectLightPass(RenderBuilder); }, true);
+		SceneRenderGraph.AddPass("GenerateSH9Pass", [this](UHRenderBuilder& RenderBuilder) { GenerateSH9Pass(RenderBuilder); }, true);
+		SceneRenderGraph.AddPass("RaySkyLightPass", [this](UHRenderBuilder& RenderBuilder) { DispatchRaySkyLightPass(RenderBuilder); }, true);
+	}
+
+	// RT passes are kept only when the lighting passes consume their results
+	// RT shadow and RT indirect light only read GBuffers, so they can overlap the graphic passes on async compute queue
+	const bool bAsyncRTShadow = RTParams.bEnableAsyncCompute && RTParams.bAsyncRTShadow;
+	const bool bAsyncRTIndirectLight = RTParams.bEnableAsyncCompute && RTParams.bAsyncRTIndirectLight;
+
+	Pass = SceneRenderGraph.AddPass("RayShadowPass", [this](UHRenderBuilder& RenderBuilder) { DispatchRayShadowPass(RenderBuilder); });
+	SceneRenderGraph.Write(Pass, RTShadow, GRenderGraphAnyLayout);
+	if (bNeedRTShadow)
+	{
+		SceneRenderGraph.Write(Pass, RTShadowData, GRenderGraphAnyLayout);
+		SceneRenderGraph.Write(Pass, RTReceiveLightBits, GRenderGraphAnyLayout);
+		SceneRenderGraph.Read(Pass, GBufferA, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+		SceneRenderGraph.Read(Pass, GBufferB, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+		SceneRenderGraph.Read(Pass, GBufferC, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+		SceneRenderGraph.Read(Pass, SceneMip, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+		SceneRenderGraph.Read(Pass, SceneDepth, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+		if (RTParams.bEnableRTResultCache)
+		{
+			SceneRenderGraph.Read(Pass, MotionVector, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+			SceneRenderGraph.Read(Pass, HistoryDepth, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+		}
+	}
+	SceneRenderGraph.SetPassQueue(Pass, bAsyncRTShadow ? UHRenderGraphQueue::AsyncCompute : UHRenderGraphQueue::Graphics);
+
+	Pass = SceneRenderGraph.AddPass("SmoothSceneNormalPass", [this](UHRenderBuilder& RenderBuilder) { DispatchSmoothSceneNormalPass(RenderBuilder); });
+	SceneRenderGraph.Write(Pass, SmoothSceneNormal, GRenderGraphAnyLayout);
+
+	Pass = SceneRenderGraph.AddPass("RayReflectionPass", [this](UHRenderBuilder& RenderBuilder) { DispatchRayReflectionPass(RenderBuilder); });
+	SceneRenderGraph.Write(Pass, RTReflection, GRenderGraphAnyLayout);
+	if (bNeedRTReflection)
+	{
+		SceneRenderGraph.Read(Pass, SmoothSceneNormal, GRenderGraphAnyLayout);
+		if (RTParams.bEnableRTResultCache)
+		{
+			SceneRenderGraph.Read(Pass, MotionVector, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+			SceneRenderGraph.Read(Pass, HistoryDepth, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+		}
+	}
+
+	// sky data is written by the async prologue or the inline sky light pass, it's synchronized outside of the graph
+	const UHRenderGraphQueue RTIndirectLightQueue = bAsyncRTIndirectLight ? UHRenderGraphQueue::AsyncCompute : UHRenderGraphQueue::Graphics;
+	Pass = SceneRenderGraph.AddPass("RayIndirectLightPass", [this](UHRenderBuilder& RenderBuilder) { DispatchRayIndirectLightPass(RenderBuilder); });
+	SceneRenderGraph.Write(Pass, RTIndirectLight, GRenderGraphAnyLayout);
+	if (bNeedRTIndirectLight)
+	{
+		SceneRenderGraph.Read(Pass, SmoothSceneNormal, GRenderGraphAnyLayout);
+		SceneRenderGraph.Write(Pass, RTIndirectOcclusion, GRenderGraphAnyLayout);
+		SceneRenderGraph.Write(Pass, RTIndirectTileRate, VK_IMAGE_LAYOUT_GENERAL);
+		SceneRenderGraph.Read(Pass, GBufferA, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+		SceneRenderGraph.Read(Pass, GBufferB, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+		SceneRenderGraph.Read(Pass, GBufferC, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+		SceneRenderGraph.Read(Pass, SceneMip, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+		SceneRenderGraph.Read(Pass, SceneData, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+		SceneRenderGraph.Read(Pass, SceneDepth, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+	}
+	SceneRenderGraph.SetPassQueue(Pass, RTIndirectLightQueue);
+
+	// diffuse and occlusion are denoised in their own passes, each copies its own history
+	// the bilateral filter temps are transients, so the graph aliases them and issues the aliasing barriers on either queue
+	if (bNeedRTIndirectLight)
+	{
+		auto CreateFilterTemp = [this](UHRenderTexture* InTexture, const VkMemoryRequirements& InMemReqs)
+			{
+				const UHRenderGraphResource Resource = SceneRenderGraph.CreateTransientTexture(InTexture->GetName(), InMemReqs.size, InMemReqs.alignment);
+				SceneRenderGraph.SetTransientTexture(Resource, InTexture);
+				return Resource;
+			};
+
+		auto AddDenoisePass = [&, this](std::string InName, UHRenderGraphResource InTarget, UHRenderGraphResource InHistory
+			, UHRenderGraphResource InTemp0, UHRenderGraphResource InTemp1, UHRenderGraphPassFunc InFunc)
+			{
+				const int32_t DenoisePass = SceneRenderGraph.AddPass(InName, UHMOVE(InFunc));
+				SceneRenderGraph.Write(DenoisePass, InTarget, GRenderGraphAnyLayout);
+				SceneRenderGraph.Write(DenoisePass, InHistory, GRenderGraphAnyLayout);
+				SceneRenderGraph.Write(DenoisePass, InTemp0, VK_IMAGE_LAYOUT_GENERAL);
+				SceneRenderGraph.Write(DenoisePass, InTemp1, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+				SceneRenderGraph.Read(DenoisePass, RTIndirectTileRate, VK_IMAGE_LAYOUT_GENERAL);
+				SceneRenderGraph.Read(DenoisePass, GBufferB, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+				SceneRenderGraph.Read(DenoisePass, SceneDepth, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+				SceneRenderGraph.Read(DenoisePass, MotionVector, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+				if (RTParams.bNeedDepthNormalHistory)
+				{
+					SceneRenderGraph.Read(DenoisePass, HistoryDepth, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+					SceneRenderGraph.Read(DenoisePass, HistoryNormal, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+				}
+				SceneRenderGraph.SetPassQueue(DenoisePass, RTIndirectLightQueue);
+			};
+
+		AddDenoisePass("RayIndirectDiffuseDenoisePass", RTIndirectLight, RTIndirectDiffuseHistory
+			, CreateFilterTemp(RTIndirectDiffuseBFConsts.FilterTempRT0, RTFilterTempMemReqs[0])
+			, CreateFilterTemp(RTIndirectDiffuseBFConsts.FilterTempRT1, RTFilterTempMemReqs[1])
+			, [this](UHRenderBuilder& RenderBuilder)
+			{
+				DispatchRayIndirectDenoisePass(RenderBuilder, "Indirect Diffuse", RTDiffuseReprojectionShader.get()
+					, GRTIndirectDiffuse, GRTIndirectDiffuseHistory, 0.2f, RTIndirectDiffuseBFConsts);
+			});
+
+		AddDenoisePass("RayIndirectOcclusionDenoisePass", RTIndirectOcclusion, RTIndirectOcclusionHistory
+			, CreateFilterTemp(RTIndirectOcclusionBFConsts.FilterTempRT0, RTFilterTempMemReqs[2])
+			, CreateFilterTemp(RTIndirectOcclusionBFConsts.FilterTempRT1, RTFilterTempMemReqs[3])
+			, [this](UHRenderBuilder& RenderBuilder)
+			{
+				DispatchRayIndirectDenoisePass(RenderBuilder, "Indirect Occlusion", RTSkyReprojectionShader.get()
+					, GRTIndirectOcclusion, GRTIndirectOcclusionHistory, 0.5f, RTIndirectOcclusionBFConsts);
+			});
+	}
+
+	// light and reflection passes write scene result as storage image
+	Pass = SceneRenderGraph.AddPass("LightPass", [this](UHRenderBuilder& RenderBuilder) { DispatchLightPass(RenderBuilder); });
+	SceneRenderGraph.Write(Pass, SceneResult, VK_IMAGE_LAYOUT_GENERAL);
+	SceneRenderGraph.Read(Pass, SceneDepth, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+	if (bNeedRTShadow)
+	{
+		SceneRenderGraph.Read(Pass, RTShadow, GRenderGraphAnyLayout);
+		SceneRenderGraph.Read(Pass, RTReceiveLightBits, GRenderGraphAnyLayout);
+	}
+	if (bNeedRTIndirectLight)
+	{
+		SceneRenderGraph.Read(Pass, RTIndirectLight, GRenderGraphAnyLayout);
+		SceneRenderGraph.Read(Pass, RTIndirectOcclusion, GRenderGraphAnyLayout);
+	}
+
+	// opaque scene capture for refraction, the blit source layout is kept until reflection pass
+	Pass = SceneRenderGraph.AddPass("PreReflectionPass", [this](UHRenderBuilder& RenderBuilder) { PreReflectionPass(RenderBuilder); });
+	if (RTParams.bNeedRefraction)
+	{
+		SceneRenderGraph.Read(Pass, SceneResult, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL);
+		SceneRenderGraph.Write(Pass, OpaqueSceneResult, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+	}
+
+	Pass = SceneRenderGraph.AddPass("ReflectionPass", [this](UHRenderBuilder& RenderBuilder) { DispatchReflectionPass(RenderBuilder); });
+	SceneRenderGraph.Write(Pass, SceneResult, VK_IMAGE_LAYOUT_GENERAL);
+	if (bNeedRTReflection)
+	{
+		SceneRenderGraph.Read(Pass, RTReflection, GRenderGraphAnyLayout);
+	}
+
+	Pass = SceneRenderGraph.AddPass("SkyPass", [this](UHRenderBuilder& RenderBuilder) { RenderSkyPass(RenderBuilder); });
+	SceneRenderGraph.Write(Pass, SceneResult, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL);
+	SceneRenderGraph.Read(Pass, SceneDepth, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL);
+
+	Pass = SceneRenderGraph.AddPass("TranslucentPass", [this](UHRenderBuilder& RenderBuilder) { RenderTranslucentPass(RenderBuilder); });
+	SceneRenderGraph.Write(Pass, SceneResult, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL);
+	SceneRenderGraph.Read(Pass, SceneDepth, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL);
+	SceneRenderGraph.Read(Pass, OpaqueSceneResult, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+
+	// post processing ping-pongs between scene result and post process RT, and copies the history
+	// with upscaling, scene result is only read and the upscaled result takes its place
+	Pass = SceneRenderGraph.AddPass("PostProcessing", [this](UHRenderBuilder& RenderBuilder) { RenderPostProcessing(RenderBuilder); });
+	SceneRenderGraph.Write(Pass, SceneResult, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL);
+	SceneRenderGraph.Read(Pass, SceneDepth, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+	SceneRenderGraph.Read(Pass, MotionVector, GRenderGraphAnyLayout);
+	SceneRenderGraph.Write(Pass, PostProcessRT, GRenderGraphAnyLayout);
+	if (bEnableTemporalUpscale)
+	{
+		SceneRenderGraph.Write(Pass, UpscaledSceneResult, GRenderGraphAnyLayout);
+	}
+	SceneRenderGraph.Write(Pass, PreviousSceneResult, GRenderGraphAnyLayout);
+	SceneRenderGraph.Write(Pass, HistoryDepth, GRenderGraphAnyLayout);
+	SceneRenderGraph.Write(Pass, HistoryNormal, GRenderGraphAnyLayout);
+}
+
 bool UHDeferredShadingRenderer::NeedDepthNormalHistory() const
 {
-	return GIsEditor || 
-		(ConfigInterface
-		&& ConfigInterface->RenderingSetting().bEnableRayTracing
-		&& ConfigInterface->RenderingSetting().bEnableRTIndirectLighting
-		&& GraphicInterface->IsRayTracingEnabled());
+	if (GIsEditor)
+	{
+		return true;
+	}
+
+	if (!ConfigInterface || !ConfigInterface->RenderingSetting().bEnableRayTracing || !GraphicInterface->IsRayTracingEnabled())
+	{
+		return false;
+	}
+
+	// RT indirect light reprojects its history, RT result cache compares the depth with the history
+	const UHRenderingSettings& RenderingSettings = ConfigInterface->RenderingSetting();
+	return RenderingSettings.bEnableRTIndirectLighting
+		|| (RenderingSettings.bEnableRTResultCache && (RenderingSettings.bEnableRTShadow || RenderingSettings.bEnableRTReflection));
+}
+
+void UHDeferredShadingRenderer::ExecuteSceneRenderGraph(UHRenderBuilder& SceneRenderBuilder, uint64_t InAsyncPrologueValue
+	, std::vector<VkSemaphore>& OutWaitSemaphores, std::vector<VkPipelineStageFlags>& OutWaitStages, std::vector<uint64_t>& OutWaitValues)
+{
+	const int32_t BatchCount = static_cast<int32_t>(SceneRenderGraph.GetBatchCount());
+	if (BatchCount <= 1)
+	{
+		SceneRenderGraph.Execute(SceneRenderBuilder);
+		return;
+	}
+
+	UH_TRACE_SCOPE("ExecuteSceneRenderGraph");
+	std::vector<uint64_t> BatchValues(BatchCount, 0);
+	std::vector<VkSemaphore> WaitSemaphores;
+	std::vector<VkPipelineStageFlags> WaitStages;
+	std::vector<uint64_t> WaitValues;
+
+	for (int32_t BatchIdx = 0; BatchIdx < BatchCount; BatchIdx++)
+	{
+		const UHRenderGraphBatch& Batch = SceneRenderGraph.GetBatch(BatchIdx);
+		const bool bIsAsync = (Batch.Queue == UHRenderGraphQueue::AsyncCompute);
+		UHQueueSubmitter& Submitter = bIsAsync ? AsyncComputeQueue : SceneRenderQueue;
+		const UHQueueSubmitter& OtherSubmitter = bIsAsync ? SceneRenderQueue : AsyncComputeQueue;
+
+		// wait the timeline of the other queue, graphic batches also wait the async prologue for TLAS and light data
+		uint64_t WaitValue = (Batch.WaitBatch != UHINDEXNONE) ? BatchValues[Batch.WaitBatch] : 0;
+		VkPipelineStageFlags WaitStage = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+		if (!bIsAsync && WaitValue == 0 && InAsyncPrologueValue > 0)
+		{
+			WaitValue = InAsyncPrologueValue;
+			WaitStage = VK_PIPELINE_STAGE_ACCELERATION_STRUCTURE_BUILD_BIT_KHR | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+		}
+
+		WaitSemaphores.clear();
+		WaitStages.clear();
+		WaitValues.clear();
+		if (WaitValue > 0)
+		{
+			WaitSemaphores.push_back(OtherSubmitter.TimelineSemaphore);
+			WaitStages.push_back(WaitStage);
+			WaitValues.push_back(WaitValue);
+		}
+
+		// the last batch goes with the frame submission
+		if (BatchIdx == BatchCount - 1)
+		{
+			SceneRenderGraph.ExecuteBatch(BatchIdx, SceneRenderBuilder);
+			OutWaitSemaphores.insert(OutWaitSemaphores.end(), WaitSemaphores.begin(), WaitSemaphores.end());
+			OutWaitStages.insert(OutWaitStages.end(), WaitStages.begin(), WaitStages.end());
+			OutWaitValues.insert(OutWaitValues.end(), WaitValues.begin(), WaitValues.end());
+			break;
+		}
+
+		UHRenderBuilder BatchBuilder(GraphicInterface, Submitter.GetBatchCommandBuffer(CurrentFrameRT, BatchIdx), bIsAsync);
+		BatchBuilder.BeginCommandBuffer();
+		GraphicInterface->BeginCmdDebug(BatchBuilder.GetCmdList(), bIsAsync ? "Async Compute Batch" : "Graphic Batch");
+
+		// the async prologue was submitted earlier on the same queue, make its results visible
+		if (bIsAsync)
+		{
+			BatchBuilder.GlobalBarrier(VK_ACCESS_2_MEMORY_WRITE_BIT, VK_ACCESS_2_MEMORY_READ_BIT | VK_ACCESS_2_MEMORY_WRITE_BIT
+				, VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT);
+		}
+
+		SceneRenderGraph.ExecuteBatch(BatchIdx, BatchBuilder);
+		GraphicInterface->EndCmdDebug(BatchBuilder.GetCmdList());
+		BatchBuilder.EndCommandBuffer();
+
+		BatchValues[BatchIdx] = Submitter.SignalBatch();
+		BatchBuilder.ExecuteCmd(Submitter.Queue, nullptr, WaitSemaphores, WaitStages, nullptr
+			, Submitter.TimelineSemaphore, BatchValues[BatchIdx], WaitValues);
+
+		SceneRenderBuilder.DrawCalls += BatchBuilder.DrawCalls;
+		SceneRenderBuilder.OccludedCalls += BatchBuilder.OccludedCalls;
+	}
 }
 
 void UHDeferredShadingRenderer::RenderThreadLoop()
@@ -868,6 +1430,7 @@ void UHDeferredShadingRenderer::RenderThreadLoop()
 #if WITH_EDITOR
 			UHProfilerScope Profiler(&RenderThreadProfile);
 #endif
+			UH_TRACE_SCOPE("RenderThreadFrame");
 
 			// collect worker bundle for this frame
 			if (RTParams.bEnableRendering)
@@ -880,6 +1443,7 @@ void UHDeferredShadingRenderer::RenderThreadLoop()
 				TranslucentParallelSubmitter.CollectCurrentFrameRTBundle(CurrentFrameRT);
 			}
 
+			uint64_t AsyncPrologueValue = 0;
 			if (RTParams.bEnableAsyncCompute)
 			{
 				// ****************************** start async compute queue
@@ -903,137 +1467,116 @@ void UHDeferredShadingRenderer::RenderThreadLoop()
 
 				GraphicInterface->EndCmdDebug(AsyncComputeBuilder.GetCmdList());
 				AsyncComputeBuilder.EndCommandBuffer();
-				AsyncComputeBuilder.ExecuteCmd(AsyncComputeQueue.Queue, AsyncComputeQueue.Fences[CurrentFrameRT], nullptr, AsyncComputeQueue.FinishedSemaphores[CurrentFrameRT]);
+
+				// the prologue also signals the timeline, so graph batches on graphic queue can wait it as well
+				AsyncPrologueValue = AsyncComputeQueue.SignalBatch();
+				AsyncComputeBuilder.ExecuteCmd(AsyncComputeQueue.Queue, AsyncComputeQueue.Fences[CurrentFrameRT], {}, {}
+					, AsyncComputeQueue.FinishedSemaphores[CurrentFrameRT], AsyncComputeQueue.TimelineSemaphore, AsyncPrologueValue);
 				// ****************************** end async compute queue
 			}
 
 			// ****************************** start scene rendering
-			// similar to D3D12 fence wait/reset
-			SceneRenderBuilder.WaitFence(SceneRenderQueue.Fences[CurrentFrameRT]);
-			SceneRenderBuilder.ResetFence(SceneRenderQueue.Fences[CurrentFrameRT]);
+			// wait the GPU frame that used this command buffer, GT has usually waited it already
+			{
+				UH_TRACE_SCOPE("WaitFrameTimeline");
+				SceneRenderQueue.WaitFrame(CurrentFrameRT);
+			}
+
+			// release resources that were retired before the completed frames
+			GraphicInterface->ProcessDeferredReleases(SceneRenderQueue.GetCompletedValue());
+
+			// the descriptor sets of this frame slot are no longer in use on GPU
+			GraphicInterface->GetDescriptorAllocator()->ResetFrame(CurrentFrameRT);
 
 			// begin command buffer, it will reset command buffer inline
 			SceneRenderBuilder.BeginCommandBuffer();
 			GraphicInterface->BeginCmdDebug(SceneRenderBuilder.GetCmdList(), "Drawing UHDeferredShadingRenderer");
 
+			// wait the previous async queue is done (that means async compute queue always advanced one frame more than graphic)
+			// also needs to wait the swap chain is ready
+			std::vector<VkSemaphore> WaitSemaphore;
+			std::vector<VkPipelineStageFlags> WaitStages;
+			std::vector<uint64_t> WaitValues;
+
 			if (RTParams.bEnableRendering)
 			{
-				// first-chance resource barriers and resets
-				if (!bIsPresentedPreviously || RTParams.bIsSwapChainReset)
-				{
-					SceneRenderBuilder.ResourceBarrier(GOpaqueSceneResult, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
-				}
-
-				// transition history depth/normal to shader read
-				if (RTParams.bNeedDepthNormalHistory)
+				// scene passes are recorded through render graph, barriers between passes are derived from the declared uses
+				// passes scheduled on async compute queue split the graph into batches submitted before the frame
+				BuildSceneRenderGraph(bIsPresentedPreviously);
+				if (SceneRenderGraph.Compile())
 				{
-					SceneRenderBuilder.PushResourceBarrier(UHImageBarrier(GHistoryDepth, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL));
-					SceneRenderBuilder.PushResourceBarrier(UHImageBarrier(GHistoryNormal, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL));
-					SceneRenderBuilder.FlushResourceBarrier();
+					ExecuteSceneRenderGraph(SceneRenderBuilder, AsyncPrologueValue, WaitSemaphore, WaitStages, WaitValues);
 				}
-
-				if (bIsPresentedPreviously)
-				{
-					ResolveOcclusionResult(SceneRenderBuilder);
-				}
-				RenderDepthPrePass(SceneRenderBuilder);
-				RenderBasePass(SceneRenderBuilder);
-				RenderOcclusionPass(SceneRenderBuilder);
-				RenderMotionPass(SceneRenderBuilder);
-
-				if (RTParams.bEnableAsyncCompute)
-				{
-					// transition structured buffer used in async compute queue to SRV
-					if (RTParams.bNeedGenerateSH9)
-					{
-						VkPipelineStageFlags SH9Stages = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_RAY_TRACING_SHADER_BIT_KHR;
-						SceneRenderBuilder.ResourceBarrier(GSH9Data->GetBuffer(), GSH9Data->GetBufferSize()
-							, VK_ACCESS_SHADER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT
-							, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, SH9Stages);
-					}
-
-					if (CurrentScene->GetPointLightCount() > 0 || CurrentScene->GetSpotLightCount() > 0)
-					{
-						SceneRenderBuilder.ResourceBarrier(GInstanceLightsBuffer[CurrentFrameRT]->GetBuffer(), GInstanceLightsBuffer[CurrentFrameRT]->GetBufferSize()
-							, VK_ACCESS_SHADER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT
-							, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_RAY_TRACING_SHADER_BIT_KHR);
-					}
-				}
-				else
-				{
-					BuildTopLevelAS(SceneRenderBuilder);
-					CollectLightPass(SceneRenderBuilder);
-					GenerateSH9Pass(SceneRenderBuilder);
-					DispatchRaySkyLightPass(SceneRenderBuilder);
-				}
-
-				DispatchLightCulling(SceneRenderBuilder);
-				DispatchRayShadowPass(SceneRenderBuilder);
-				DispatchSmoothSceneNormalPass(SceneRenderBuilder);
-				DispatchRayReflectionPass(SceneRenderBuilder);
-				DispatchRayIndirectLightPass(SceneRenderBuilder);
-
-				SceneRenderBuilder.ResourceBarrier(GSceneResult, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, VK_IMAGE_LAYOUT_GENERAL);
-				DispatchLightPass(SceneRenderBuilder);
-				
-				PreReflectionPass(SceneRenderBuilder);
-				DispatchReflectionPass(SceneRenderBuilder);
-
-				SceneRenderBuilder.ResourceBarrier(GSceneResult, VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL);
-				SceneRenderBuilder.ResourceBarrier(GSceneDepth, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL);
-				RenderSkyPass(SceneRenderBuilder);
-				RenderTranslucentPass(SceneRenderBuilder);
-
-				SceneRenderBuilder.ResourceBarrier(GSceneDepth, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
-				RenderPostProcessing(SceneRenderBuilder);
 			}
 
 			// blit scene to swap chain
 			PresentIndex = RenderSceneToSwapChain(SceneRenderBuilder);
 
-		#if WITH_EDITOR
-			// get GPU times
+			// get GPU times, non-editor builds only have the queries used at runtime
 			for (int32_t Idx = 0; Idx < UH_ENUM_VALUE(UHRenderPassTypes::UHRenderPassMax); Idx++)
 			{
-				GPUTimeQueries[Idx]->ResolveTimeStamp(SceneRenderBuilder.GetCmdList());
+				if (GPUTimeQueries[Idx] != nullptr)
+				{
+					GPUTimeQueries[Idx]->ResolveTimeStamp(SceneRenderBuilder.GetCmdList());
+				}
 			}
-		#endif
 
 			GraphicInterface->EndCmdDebug(SceneRenderBuilder.GetCmdList());
 			SceneRenderBuilder.EndCommandBuffer();
 
-			// wait the previous async queue is done (that means async compute queue always advanced one frame more than graphic)
-			// also needs to wait the swap chain is ready
-			std::vector<VkSemaphore> WaitSemaphore;
-			std::vector<VkPipelineStageFlags> WaitStages;
-
 			if (RTParams.bEnableAsyncCompute)
 			{
 				WaitSemaphore.push_back(AsyncComputeQueue.FinishedSemaphores[CurrentFrameRT]);
 				WaitStages.push_back(VK_PIPELINE_STAGE_ACCELERATION_STRUCTURE_BUILD_BIT_KHR | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
 			}
-			WaitSemaphore.push_back(SceneRenderQueue.WaitingSemaphores[CurrentFrameRT]);
-			WaitStages.push_back(VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT);
 
-			SceneRenderBuilder.ExecuteCmd(SceneRenderQueue.Queue, SceneRenderQueue.Fences[CurrentFrameRT], WaitSemaphore, WaitStages, SceneRenderQueue.FinishedSemaphores[CurrentFrameRT]);
+			// offscreen targets aren't acquired or presented, so there are no binary semaphores for them
+			if (!GIsOffscreen)
+			{
+				WaitSemaphore.push_back(SceneRenderQueue.WaitingSemaphores[CurrentFrameRT]);
+				WaitStages.push_back(VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT);
+			}
+
+			// binary semaphores ignore the wait values
+			WaitValues.resize(WaitSemaphore.size(), 0);
+
+			// signal the timeline value of this frame, the slot is reused after GPU reaches the value
+			const uint64_t FrameValue = SceneRenderQueue.SignalFrame(CurrentFrameRT);
+			SceneRenderBuilder.ExecuteCmd(SceneRenderQueue.Queue, nullptr, WaitSemaphore, WaitStages
+				, GIsOffscreen ? nullptr : SceneRenderQueue.FinishedSemaphores[CurrentFrameRT]
+				, SceneRenderQueue.TimelineSemaphore, FrameValue, WaitValues);
+			GraphicInterface->SetFrameSubmittedValue(FrameValue);
+
+			// the readback recorded in this frame is written by capture thread once the timeline reaches the value
+			if (OffscreenCapture != nullptr)
+			{
+				OffscreenCapture->OnFrameSubmitted(SceneRenderQueue.TimelineSemaphore, FrameValue);
+			}
 			// ****************************** end scene rendering
 		}
 
 	#if WITH_EDITOR
 		// profile ends before Present() call, since it contains vsync time
 		RenderThreadTime = RenderThreadProfile.GetDiff() * 1000.0f;
+		// graph batches signal the timeline as well, so count the frame values instead
+		{
+			const uint64_t CompletedValue = SceneRenderQueue.GetCompletedValue();
+			FramesInFlight = 0;
+			for (uint32_t Idx = 0; Idx < GMaxFrameInFlight; Idx++)
+			{
+				FramesInFlight += (SceneRenderQueue.FrameValues[Idx] > CompletedValue) ? 1 : 0;
+			}
+		}
+	#endif
 		DrawCalls = SceneRenderBuilder.DrawCalls;
 		OccludedCalls = SceneRenderBuilder.OccludedCalls;
-	#endif
 
-		// wait until the previous presentation is done, to prevent glitches on some hardwares
-		if (bIsPresentedPreviously && !RTParams.bIsSwapChainReset)
+		// present
+		if (!GIsOffscreen)
 		{
-			SceneRenderBuilder.WaitFence(SceneRenderQueue.Fences[(CurrentFrameRT - 1) % GMaxFrameInFlight]);
+			UH_TRACE_SCOPE("Present");
+			bIsResetNeededShared = !SceneRenderBuilder.Present(GraphicInterface->GetSwapChain(), SceneRenderQueue.Queue, SceneRenderQueue.FinishedSemaphores[CurrentFrameRT], PresentIndex);
 		}
-
-		// present
-		bIsResetNeededShared = !SceneRenderBuilder.Present(GraphicInterface->GetSwapChain(), SceneRenderQueue.Queue, SceneRenderQueue.FinishedSemaphores[CurrentFrameRT], PresentIndex);
 		bIsPresentedPreviously = true;
 
 		// tell main thread to continue
@@ -11,24 +11,28 @@
 #include "../Classes/GPUQuery.h"
 #include "../Classes/Thread.h"
 #include "../Engine/GameTimer.h"
+#include "../Engine/TraceProfiler.h"
 #include "RenderingTypes.h"
 #include "RendererShared.h"
 #include "RenderBuilder.h"
 #include "ParallelSubmitter.h"
 #include "QueueSubmitter.h"
+#include "LightCluster.h"
+#include "RenderGraph.h"
+#include "OffscreenCapture.h"
 #include <memory>
 #include <unordered_map>
 
 // shader includes
 #include "ShaderClass/DepthPassShader.h"
 #include "ShaderClass/BasePassShader.h"
-#include "ShaderClass/LightCullingShader.h"
 #include "ShaderClass/LightPassShader.h"
 #include "ShaderClass/SkyPassShader.h"
 #include "ShaderClass/MotionPassShader.h"
 #include "ShaderClass/TranslucentPassShader.h"
 #include "ShaderClass/PostProcessing/ToneMappingShader.h"
 #include "ShaderClass/PostProcessing/TemporalAAShader.h"
+#include "ShaderClass/PostProcessing/TemporalUpscaleShader.h"
 #include "ShaderClass/PostProcessing/GaussianFilterShader.h"
 #include "ShaderClass/RayTracing/RTDefaultHitGroupShader.h"
 #include "ShaderClass/RayTracing/RTShadowShader.h"
@@ -41,6 +45,8 @@
 #include "ShaderClass/RayTracing/RTReflectionMipmap.h"
 #include "ShaderClass/RayTracing/RTMeshInstanceTable.h"
 #include "ShaderClass/OcclusionPassShader.h"
+#include "ShaderClass/HiZShader.h"
+#include "ShaderClass/VisibilityShader.h"
 #include "ShaderClass/RayTracing/CollectLightShader.h"
 #include "ShaderClass/RayTracing/RTSmoothNormalShader.h"
 #include "ShaderClass/PostProcessing/UpsampleShader.h"
@@ -49,6 +55,7 @@
 #include "ShaderClass/RayTracing/RTSoftShadowShader.h"
 #include "ShaderClass/RayTracing/RTMinimalHitGroupShader.h"
 #include "ShaderClass/RayTracing/RTSkyLightShader.h"
+#include "ShaderClass/RayTracing/RTTileClassifyShader.h"
 #include "ShaderClass/PostProcessing/BilateralFilterShader.h"
 
 #if WITH_EDITOR
@@ -64,6 +71,8 @@ struct UHRenderThreadParameters
 {
 	UHRenderThreadParameters()
 		: bEnableAsyncCompute(false)
+		, bAsyncRTShadow(false)
+		, bAsyncRTIndirectLight(false)
 		, bIsSwapChainReset(false)
 		, bEnableRendering(false)
 		, bEnableSkyLight(false)
@@ -81,6 +90,12 @@ struct UHRenderThreadParameters
 		, bEnableRTShadow(false)
 		, bEnableRTReflection(false)
 		, bEnableRTIndirectLighting(false)
+		, bEnableRTAdaptiveRays(false)
+		, RTReflectionSmoothCutoff(0)
+		, RTRayPressure(0)
+		, bEnableRTResultCache(false)
+		, bResetRTCache(false)
+		, RTCacheInvalidationCount(0)
 		, FrameNumber(0)
 		, bNeedDepthNormalHistory(false)
 	{
@@ -88,6 +103,8 @@ struct UHRenderThreadParameters
 	}
 
 	bool bEnableAsyncCompute;
+	bool bAsyncRTShadow;
+	bool bAsyncRTIndirectLight;
 	bool bIsSwapChainReset;
 	bool bEnableRendering;
 	bool bEnableSkyLight;
@@ -105,6 +122,12 @@ struct UHRenderThreadParameters
 	bool bEnableRTShadow;
 	bool bEnableRTReflection;
 	bool bEnableRTIndirectLighting;
+	bool bEnableRTAdaptiveRays;
+	float RTReflectionSmoothCutoff;
+	float RTRayPressure;
+	bool bEnableRTResultCache;
+	bool bResetRTCache;
+	uint32_t RTCacheInvalidationCount;
 	uint32_t FrameNumber;
 	bool bNeedDepthNormalHistory;
 };
@@ -122,6 +145,9 @@ public:
 	void SetSwapChainReset(bool bInFlag);
 	bool IsNeedReset();
 
+	// offscreen mode only, the frames are read back to the capture after blitting to the offscreen target
+	void SetOffscreenCapture(UHOffscreenCapture* InCapture);
+
 	void Resize();
 	void Reset();
 	void Update();
@@ -143,8 +169,8 @@ public:
 	void SetEditorDelta(uint32_t InWidthDelta, uint32_t InHeightDelta);
 
 	float GetRenderThreadTime() const;
-	int32_t GetDrawCallCount() const;
-	int32_t GetOccludedCallCount() const;
+	float GetFrameLatency() const;
+	uint32_t GetFramesInFlight() const;
 
 	static UHDeferredShadingRenderer* GetRendererEditorOnly();
 	void RefreshMaterialShaders(UHMaterial* InMat, bool bNeedReassignRendererGroup, bool bDelayRTShaderCreation);
@@ -155,6 +181,10 @@ public:
 
 	void ToggleDepthPrepass();
 #endif
+	int32_t GetDrawCallCount() const;
+	int32_t GetOccludedCallCount() const;
+	float GetGeometryBandwidthMB() const;
+
 	void RecreateMeshTables();
 	void RecreateMaterialShaders(UHMeshRendererComponent* InMeshRenderer, UHMaterial* InMat);
 	void RecreateMeshShaders(UHMaterial* InMat);
@@ -222,12 +252,18 @@ private:
 	// release shaders
 	void ReleaseShaders();
 
+	// read render and output resolution from config, they only differ when temporal upscaling is enabled
+	void UpdateRenderResolution();
+
 	// create rendering buffers that will be used
 	void CreateRenderingBuffers();
 
 	// destroy rendering buffers
 	void RelaseRenderingBuffers();
 
+	// visibility buffer draw args and tile lists, they're sized by material count and tile count
+	void ResizeVisibilityBuffers();
+
 	// create render passes
 	void CreateRenderPasses();
 	void CreateRenderFrameBuffers();
@@ -253,27 +289,56 @@ private:
 	// collect mesh shader instance
 	void CollectMeshShaderInstance();
 
-	// get light culling tile count
-	void GetLightCullingTileCount(uint32_t& TileCountX, uint32_t& TileCountY);
+	// capture the TLAS inputs of renderers for this frame slot
+	void CollectTopASInstances();
+	static uint32_t GetMeshShaderMeshletCount(const std::vector<UHMeshShaderData>& InData);
+
+	// assign point/spot lights to clusters and upload the light lists
+	void UploadLightClusters(const UHCameraComponent* InCamera);
 
 	// get current skycube
 	UHTextureCube* GetCurrentSkyCube() const;
 
 	bool NeedDepthNormalHistory() const;
 
+	// declare scene passes and their resource uses, the graph derives barriers and culls unused passes
+	void BuildSceneRenderGraph(bool bIsPresentedPreviously);
+
+	// submit the graph batches except the last one, which is recorded in scene builder and submitted with the frame
+	// the waits needed by the last batch are appended to the outputs
+	void ExecuteSceneRenderGraph(UHRenderBuilder& SceneRenderBuilder, uint64_t InAsyncPrologueValue
+		, std::vector<VkSemaphore>& OutWaitSemaphores, std::vector<VkPipelineStageFlags>& OutWaitStages, std::vector<uint64_t>& OutWaitValues);
+
+	// create bilateral filter temps in transient memory, the temps of different filters are aliased
+	void CreateFilterTempRTs(UHRenderTextureSettings InRTSettings);
+
+	// adaptive RT tiles, the ray pressure is updated on game thread from the GPU time of RT passes
+	void UpdateRTRayBudget();
+	UHRTTileClassifyConstants GetRTTileClassifyConstants(UHRTTileClassifyType InType, VkExtent2D InTraceExtent, uint32_t InPixelStride) const;
+	void DispatchRTTileClassify(UHRenderBuilder& RenderBuilder, UHRTTileClassifyShader* InShader, UHRenderBuffer<uint32_t>* InRayArgs
+		, const UHRTTileClassifyConstants& InConsts);
+	void TraceRTTiles(UHRenderBuilder& RenderBuilder, UHShaderClass* InShader, UHRenderBuffer<uint32_t>* InRayArgs, uint32_t InTileCount);
+
+	// RT shadow and reflection result cache, the invalidation boxes are collected from dirty components on game thread
+	void CollectRTCacheInvalidations();
+
 
 	/************************************************ rendering functions ************************************************/
 	void BuildTopLevelAS(UHRenderBuilder& RenderBuilder);
 	void CollectLightPass(UHRenderBuilder& RenderBuilder);
 	void ResolveOcclusionResult(UHRenderBuilder& RenderBuilder);
 	void RenderDepthPrePass(UHRenderBuilder& RenderBuilder);
+	void DispatchVisibilityClassify(UHRenderBuilder& RenderBuilder);
+	void RenderMaterialResolve(UHRenderBuilder& RenderBuilder);
 	void RenderOcclusionPass(UHRenderBuilder& RenderBuilder);
+	void GenerateHiZPass(UHRenderBuilder& RenderBuilder);
 	void RenderBasePass(UHRenderBuilder& RenderBuilder);
-	void DispatchLightCulling(UHRenderBuilder& RenderBuilder);
 	void DispatchRayShadowPass(UHRenderBuilder& RenderBuilder);
 	void DispatchSmoothSceneNormalPass(UHRenderBuilder& RenderBuilder);
 	void DispatchRaySkyLightPass(UHRenderBuilder& RenderBuilder);
 	void DispatchRayIndirectLightPass(UHRenderBuilder& RenderBuilder);
+	void DispatchRayIndirectDenoisePass(UHRenderBuilder& RenderBuilder, const std::string& InName, UHRTIndirectReprojectionShader* InShader
+		, UHRenderTexture* InTarget, UHRenderTexture* InHistory, float InAlphaMax, const UHBilateralFilterConstants& InBFConsts);
 	void DispatchRayReflectionPass(UHRenderBuilder& RenderBuilder);
 	void DispatchLightPass(UHRenderBuilder& RenderBuilder);
 	void PreReflectionPass(UHRenderBuilder& RenderBuilder);
@@ -284,6 +349,7 @@ private:
 	void RenderTranslucentPass(UHRenderBuilder& RenderBuilder);
 	void RenderEffect(UHShaderClass* InShader, UHRenderBuilder& RenderBuilder, int32_t& PostProcessIdx, std::string InName);
 	void Dispatch2DEffect(UHShaderClass* InShader, UHRenderBuilder& RenderBuilder, int32_t& PostProcessIdx, std::string InName);
+	void DispatchTemporalUpscale(UHRenderBuilder& RenderBuilder);
 	void RenderPostProcessing(UHRenderBuilder& RenderBuilder);
 	void CopyDepthNormalHistory(UHRenderBuilder& RenderBuilder);
 
@@ -293,6 +359,10 @@ private:
 
 #if WITH_EDITOR
 	void RenderComponentBounds(UHRenderBuilder& RenderBuilder, const int32_t PostProcessIdx);
+
+	// ImGui rebuilds its draw lists every GT frame, render thread draws a copy of the frame
+	void CopyEditorDrawData();
+	void ClearEditorDrawData(uint32_t InFrameIdx);
 #endif
 
 	/************************************************ variables ************************************************/
@@ -300,12 +370,19 @@ private:
 	UHAssetManager* AssetManagerInterface;
 	UHConfigManager* ConfigInterface;
 	UHGameTimer* TimerInterface;
+
+	// scene passes run at render resolution, post processing after upscaling runs at output resolution
 	VkExtent2D RenderResolution;
+	VkExtent2D OutputResolution;
+	bool bEnableTemporalUpscale;
 
 	// queue submitter
 	UHQueueSubmitter AsyncComputeQueue;
 	UHQueueSubmitter SceneRenderQueue;
 
+	// frame capture of offscreen mode, owned by engine
+	UHOffscreenCapture* OffscreenCapture;
+
 	// parallel submitters
 	UHParallelSubmitter DepthParallelSubmitter;
 	UHParallelSubmitter OcclusionParallelSubmitter;
@@ -314,6 +391,9 @@ private:
 	UHParallelSubmitter MotionTranslucentParallelSubmitter;
 	UHParallelSubmitter TranslucentParallelSubmitter;
 
+	// scene render graph, it's rebuilt every frame by render thread
+	UHRenderGraph SceneRenderGraph;
+
 	// current frame count
 	uint32_t CurrentFrameGT;
 	uint32_t CurrentFrameRT;
@@ -324,7 +404,10 @@ private:
 	std::vector<UniquePtr<UHThread>> WorkerThreads;
 
 	// Number of parallel render submitters, this is usually lower than NumWorkerThreads
+	// worker threads [0, NumParallelRenderSubmitters) are used by RT, the rest are used by GT
+	// so GT culling and uploading can run while RT is still submitting the previous frame
 	int32_t NumParallelRenderSubmitters;
+	int32_t NumGameWorkers;
 
 	bool bIsResetNeededShared;
 	bool bIsSwapChainResetGT;
@@ -349,6 +432,13 @@ private:
 	std::vector<UHPointLightConstants> PointLightConstantsCPU;
 	std::vector<UHSpotLightConstants> SpotLightConstantsCPU;
 
+	// RT result cache invalidations, the last uploaded bound of each component is kept so the old area is invalidated too
+	std::vector<UHRTCacheInvalidation> RTCacheInvalidationsCPU;
+	std::unordered_map<const UHTransformComponent*, UHBoundingBox> RTCacheBoundsGT;
+	// the RT settings that change the cached results, the cache is reset when any of them changes
+	UHVector4 RTCacheSettingsGT;
+	bool bResetRTCacheGT;
+
 	// shared samplers
 	int32_t DefaultSamplerIndex;
 	int32_t LinearClampSamplerIndex;
@@ -372,11 +462,9 @@ private:
 	std::unordered_map<int32_t, UniquePtr<UHBasePassShader>> BasePassShaders;
 	UHRenderPassObject BasePassObj;
 
-	// -------------------------------------------- Light and Light Culling Pass -------------------------------------------- //
-	const uint32_t LightCullingTileSize;
-	const uint32_t MaxPointLightPerTile;
-	const uint32_t MaxSpotLightPerTile;
-	UniquePtr<UHLightCullingShader> LightCullingShader;
+	// -------------------------------------------- Light Pass -------------------------------------------- //
+	// clustered light lists are built on CPU and shared by opaque and translucent lighting
+	UHLightCluster LightCluster;
 	UniquePtr<UHLightPassShader> LightPassShader;
 	UniquePtr<UHReflectionPassShader> ReflectionPassShader;
 	UniquePtr<UHRTReflectionMipmap> RTReflectionMipmapShader;
@@ -412,6 +500,7 @@ private:
 
 	UniquePtr<UHToneMappingShader> ToneMapShader;
 	UniquePtr<UHTemporalAAShader> TemporalAAShader;
+	UniquePtr<UHTemporalUpscaleShader> TemporalUpscaleShader;
 	UniquePtr<UHGaussianFilterShader> GaussianFilterHShader;
 	UniquePtr<UHGaussianFilterShader> GaussianFilterVShader;
 	UniquePtr<UHUpsampleShader> UpsampleNearest2x2Shader;
@@ -426,6 +515,12 @@ private:
 	// renderer instances
 	std::vector<UHRendererInstance> RendererInstances;
 
+	// draw call counters
+	int32_t DrawCalls;
+	int32_t OccludedCalls;
+	std::vector<int32_t> ThreadDrawCalls;
+	std::vector<int32_t> ThreadOccludedCalls;
+
 #if WITH_EDITOR
 	// debug view shader
 	UniquePtr<UHDebugViewShader> DebugViewShader;
@@ -436,10 +531,12 @@ private:
 
 	// profiles
 	float RenderThreadTime;
-	int32_t DrawCalls;
-	int32_t OccludedCalls;
-	std::vector<int32_t> ThreadDrawCalls;
-	std::vector<int32_t> ThreadOccludedCalls;
+	float FrameLatency;
+	uint32_t FramesInFlight;
+	std::array<UHClock::time_point, GMaxFrameInFlight> FrameBeginTimes;
+
+	// copied ImGui draw data of each frame slot, the draw lists are owned by the renderer
+	std::array<ImDrawData, GMaxFrameInFlight> EditorDrawData;
 
 	// GUI
 	uint32_t EditorWidthDelta;
@@ -469,18 +566,37 @@ private:
 	UniquePtr<UHRTSoftShadowShader> RTSoftShadowShader;
 	UniquePtr<UHRTIndirectReprojectionShader> RTSkyReprojectionShader;
 	UniquePtr<UHRTIndirectReprojectionShader> RTDiffuseReprojectionShader;
+	UniquePtr<UHRTTileClassifyShader> RTReflectionTileClassifyShader;
+	UniquePtr<UHRTTileClassifyShader> RTIndirectTileClassifyShader;
+	UniquePtr<UHRTTileClassifyShader> RTShadowTileClassifyShader;
 
 	uint32_t RTInstanceCount;
+	// TLAS inputs indexed by renderer buffer index, GT captures into CurrentFrameGT while RT builds the TLAS of CurrentFrameRT
+	std::vector<UHTopASInstanceState> TopASInstanceStates[GMaxFrameInFlight];
 	VkExtent2D RTShadowExtent;
 	VkExtent2D RTIndirectLightExtent;
+	uint32_t RTReflectionMaxTiles;
+	uint32_t RTIndirectMaxTiles;
+	uint32_t RTShadowMaxTiles;
+	// 0: traced at full rate, 1: traced at the lowest rate, it's only touched by game thread
+	float RTRayPressure;
+	// the frames since the indirect light history is valid, the tiles aren't skipped until the history is built
+	uint32_t RTIndirectHistoryFrames;
+	// whether the outputs of last frame are complete, the cache is only reused after a full trace with the same settings
+	bool bIsRTShadowCacheValid;
+	uint32_t RTReflectionCacheStride;
 	UHBilateralFilterConstants RTIndirectDiffuseBFConsts;
 	UHBilateralFilterConstants RTIndirectOcclusionBFConsts;
+	UniquePtr<UHGPUMemory> RTTransientMemory;
+	// memory requirements of diffuse temp 0/1 and occlusion temp 0/1, the scene graph declares the temps as transients with them
+	std::array<VkMemoryRequirements, 4> RTFilterTempMemReqs;
 
 	// -------------------------------------------- Culling & sorting related -------------------------------------------- //
-	std::vector<UHMeshRendererComponent*> OpaquesToRender;
-	std::vector<UHMeshRendererComponent*> MotionOpaquesToRender;
-	std::vector<UHMeshRendererComponent*> TranslucentsToRender;
-	std::vector<UHMeshRendererComponent*> OcclusionRenderers;
+	// visible lists are double buffered, GT collects into CurrentFrameGT while RT renders CurrentFrameRT
+	std::vector<UHMeshRendererComponent*> OpaquesToRender[GMaxFrameInFlight];
+	std::vector<UHMeshRendererComponent*> MotionOpaquesToRender[GMaxFrameInFlight];
+	std::vector<UHMeshRendererComponent*> TranslucentsToRender[GMaxFrameInFlight];
+	std::vector<UHMeshRendererComponent*> OcclusionRenderers[GMaxFrameInFlight];
 
 	// max element setting for counting sort, higher number = better result for GPU time but longer CPU time
 	// lower = better CPU time but longer GPU time, need to trade off between these.
@@ -491,6 +607,10 @@ private:
 	std::vector<UniquePtr<UHOcclusionPassShader>> OcclusionPassShaders;
 	UHRenderPassObject OcclusionPassObj;
 
+	// Hi-Z built from the previous frame depth, used by amplification shader
+	UniquePtr<UHHiZShader> HiZShader;
+	bool bIsHiZValid;
+
 	// -------------------------------------------- Mesh shader related -------------------------------------------- //
 	UniquePtr<UHMeshTable> PositionTable;
 	UniquePtr<UHMeshTable> UV0Table;
@@ -498,20 +618,25 @@ private:
 	UniquePtr<UHMeshTable> TangentTable;
 	UniquePtr<UHMeshTable> IndicesTable;
 	UniquePtr<UHMeshTable> MeshletTable;
+	UniquePtr<UHMeshTable> MeshletDataTable;
 
 	uint32_t MeshInstanceCount;
 	std::vector<UHMesh*> MeshInUse;
 
-	// access following data with material's buffer data index
+	// access following data with material's buffer data index, double buffered as the visible lists
 	std::vector<int32_t> MeshShaderInstancesCounter;
-	std::vector<int32_t> SortedMeshShaderGroupIndex;
-	std::vector<std::vector<UHMeshShaderData>> VisibleMeshShaderData;
+	std::vector<int32_t> SortedMeshShaderGroupIndex[GMaxFrameInFlight];
+	std::vector<std::vector<UHMeshShaderData>> VisibleMeshShaderData[GMaxFrameInFlight];
 
 	// motion mesh shader needs another mesh shader data list, as not all visible meshes need to output vector every frame
-	std::vector<std::vector<UHMeshShaderData>> MotionOpaqueMeshShaderData;
-	std::vector<std::vector<UHMeshShaderData>> MotionTranslucentMeshShaderData;
+	std::vector<std::vector<UHMeshShaderData>> MotionOpaqueMeshShaderData[GMaxFrameInFlight];
+	std::vector<std::vector<UHMeshShaderData>> MotionTranslucentMeshShaderData[GMaxFrameInFlight];
 
 	std::vector<UniquePtr<UHDepthMeshShader>> DepthMeshShaders;
 	std::vector<UniquePtr<UHBaseMeshShader>> BaseMeshShaders;
 	std::vector<UniquePtr<UHMotionMeshShader>> MotionMeshShaders;
+
+	// visibility buffer, the base pass is replaced by tile classification + per-material resolve
+	UniquePtr<UHVisibilityClassifyShader> VisibilityClassifyShader;
+	std::vector<UniquePtr<UHVisibilityResolveShader>> VisibilityResolveShaders;
 };
\ No newline at end of file
@@ -19,7 +19,7 @@ private:
 
 void UHDeferredShadingRenderer::RenderDepthPrePass(UHRenderBuilder& RenderBuilder)
 {
-	UHGameTimerScope Scope("RenderDepthPrePass", false);
+	UH_TRACE_SCOPE("RenderDepthPrePass");
 	UHGPUTimeQueryScope TimeScope(RenderBuilder.GetCmdList(), GPUTimeQueries[UH_ENUM_VALUE(UHRenderPassTypes::DepthPrePass)], "DepthPass");
 	if (CurrentScene == nullptr || !RTParams.bEnableDepthPrepass)
 	{
@@ -38,26 +38,36 @@ void UHDeferredShadingRenderer::RenderDepthPrePass(UHRenderBuilder& RenderBuilde
 		// do mesh shader version if it's supported.
 		if (GraphicInterface->IsMeshShaderSupported())
 		{
-			RenderBuilder.BeginRenderPass(DepthPassObj, RenderResolution, DepthClearValue);
+			if (GraphicInterface->IsVisibilityBufferEnabled())
+			{
+				// clear visibility with 0 as empty pixels
+				VkClearValue VisibilityClearValue{};
+				std::vector<VkClearValue> ClearValues = { VisibilityClearValue, DepthClearValue };
+				RenderBuilder.BeginRenderPass(DepthPassObj, RenderResolution, ClearValues);
+			}
+			else
+			{
+				RenderBuilder.BeginRenderPass(DepthPassObj, RenderResolution, DepthClearValue);
+			}
 
 			// bindless table, they should only be bound once
-			if (DepthMeshShaders.size() > 0 && SortedMeshShaderGroupIndex.size() > 0)
+			if (DepthMeshShaders.size() > 0 && SortedMeshShaderGroupIndex[CurrentFrameRT].size() > 0)
 			{
 				std::vector<VkDescriptorSet> BindlessTableSets = { TextureTable->GetDescriptorSet(CurrentFrameRT)
 					, SamplerTable->GetDescriptorSet(CurrentFrameRT)
 					, MeshletTable->GetDescriptorSet(CurrentFrameRT) 
 					, PositionTable->GetDescriptorSet(CurrentFrameRT)
 					, UV0Table->GetDescriptorSet(CurrentFrameRT)
-					, IndicesTable->GetDescriptorSet(CurrentFrameRT)
+					, MeshletDataTable->GetDescriptorSet(CurrentFrameRT)
 				};
-				RenderBuilder.BindDescriptorSet(DepthMeshShaders[SortedMeshShaderGroupIndex[0]]->GetPipelineLayout(), BindlessTableSets, GTextureTableSpace);
+				RenderBuilder.BindDescriptorSet(DepthMeshShaders[SortedMeshShaderGroupIndex[CurrentFrameRT][0]]->GetPipelineLayout(), BindlessTableSets, GTextureTableSpace);
 			}
 
-			for (size_t Idx = 0; Idx < SortedMeshShaderGroupIndex.size(); Idx++)
+			for (size_t Idx = 0; Idx < SortedMeshShaderGroupIndex[CurrentFrameRT].size(); Idx++)
 			{
-				const int32_t GroupIndex = SortedMeshShaderGroupIndex[Idx];
-				const uint32_t VisibleMeshlets = static_cast<uint32_t>(VisibleMeshShaderData[GroupIndex].size());
-				if (VisibleMeshlets == 0)
+				const int32_t GroupIndex = SortedMeshShaderGroupIndex[CurrentFrameRT][Idx];
+				const uint32_t VisibleInstances = static_cast<uint32_t>(VisibleMeshShaderData[CurrentFrameRT][GroupIndex].size());
+				if (VisibleInstances == 0)
 				{
 					continue;
 				}
@@ -68,9 +78,15 @@ void UHDeferredShadingRenderer::RenderDepthPrePass(UHRenderBuilder& RenderBuilde
 
 				RenderBuilder.BindGraphicState(DepthMS->GetState());
 				RenderBuilder.BindDescriptorSet(DepthMS->GetPipelineLayout(), DepthMS->GetDescriptorSet(CurrentFrameRT));
+				RenderBuilder.BindMaterialArena(DepthMS, CurrentFrameRT);
 
-				// Dispatch meshlets
-				RenderBuilder.DispatchMesh(VisibleMeshlets, 1, 1);
+				// Dispatch meshlets, amplification shader expands instances to meshlets and culls them
+				UHMeshShaderConstants Constants;
+				Constants.InstanceCount = VisibleInstances;
+				Constants.MeshletCount = GetMeshShaderMeshletCount(VisibleMeshShaderData[CurrentFrameRT][GroupIndex]);
+				Constants.bEnableHiZ = bIsHiZValid ? 1 : 0;
+				RenderBuilder.PushConstant(DepthMS->GetPipelineLayout(), VK_SHADER_STAGE_TASK_BIT_EXT, sizeof(UHMeshShaderConstants), &Constants);
+				RenderBuilder.DispatchMesh(UHMathHelpers::RoundUpDivide(Constants.MeshletCount, GAmplificationGroupSize), 1, 1);
 
 				GraphicInterface->EndCmdDebug(RenderBuilder.GetCmdList());
 			}
@@ -80,12 +96,10 @@ void UHDeferredShadingRenderer::RenderDepthPrePass(UHRenderBuilder& RenderBuilde
 			// begin render pass
 			RenderBuilder.BeginRenderPass(DepthPassObj, RenderResolution, DepthClearValue, VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);
 
-#if WITH_EDITOR
 			for (int32_t I = 0; I < NumParallelRenderSubmitters; I++)
 			{
 				ThreadDrawCalls[I] = 0;
 			}
-#endif
 
 			// init and wake all tasks
 			static std::vector<UHDepthPassAsyncTask> Tasks(NumParallelRenderSubmitters);
@@ -101,18 +115,53 @@ void UHDeferredShadingRenderer::RenderDepthPrePass(UHRenderBuilder& RenderBuilde
 				WorkerThreads[I]->WaitTask();
 			}
 
-#if WITH_EDITOR
 			for (int32_t I = 0; I < NumParallelRenderSubmitters; I++)
 			{
 				RenderBuilder.DrawCalls += ThreadDrawCalls[I];
 			}
-#endif
 
 			// execute all recorded batches
 			RenderBuilder.ExecuteBundles(DepthParallelSubmitter);
 		}
 
 		RenderBuilder.EndRenderPass();
+
+		// visibility buffer is read by classification and material resolve
+		if (GraphicInterface->IsVisibilityBufferEnabled())
+		{
+			RenderBuilder.ResourceBarrier(GSceneVisibility, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+		}
+	}
+	GraphicInterface->EndCmdDebug(RenderBuilder.GetCmdList());
+}
+
+// classify the materials of visibility buffer in screen tiles, output the tile lists and indirect args of material resolve
+void UHDeferredShadingRenderer::DispatchVisibilityClassify(UHRenderBuilder& RenderBuilder)
+{
+	UH_TRACE_SCOPE("DispatchVisibilityClassify");
+	UHGPUTimeQueryScope TimeScope(RenderBuilder.GetCmdList(), GPUTimeQueries[UH_ENUM_VALUE(UHRenderPassTypes::VisibilityClassifyPass)], "VisibilityClassifyPass");
+	if (CurrentScene == nullptr || VisibilityClassifyShader == nullptr)
+	{
+		return;
+	}
+
+	GraphicInterface->BeginCmdDebug(RenderBuilder.GetCmdList(), "Classifying Visibility Buffer");
+	{
+		// wait the material resolve of previous frame, then reset the draw args
+		RenderBuilder.GlobalBarrier(VK_ACCESS_2_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_2_SHADER_READ_BIT, VK_ACCESS_2_TRANSFER_WRITE_BIT | VK_ACCESS_2_SHADER_WRITE_BIT
+			, VK_PIPELINE_STAGE_2_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_2_VERTEX_SHADER_BIT, VK_PIPELINE_STAGE_2_TRANSFER_BIT | VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT);
+		RenderBuilder.ClearUAVBuffer(GVisibilityDrawArgs->GetBuffer(), 0);
+		RenderBuilder.GlobalBarrier(VK_ACCESS_2_TRANSFER_WRITE_BIT, VK_ACCESS_2_SHADER_READ_BIT | VK_ACCESS_2_SHADER_WRITE_BIT
+			, VK_PIPELINE_STAGE_2_TRANSFER_BIT, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT);
+
+		RenderBuilder.BindComputeState(VisibilityClassifyShader->GetComputeState());
+		RenderBuilder.BindDescriptorSetCompute(VisibilityClassifyShader->GetPipelineLayout(), VisibilityClassifyShader->GetDescriptorSet(CurrentFrameRT));
+		RenderBuilder.Dispatch(UHMathHelpers::RoundUpDivide(RenderResolution.width, GThreadGroup2D_X)
+			, UHMathHelpers::RoundUpDivide(RenderResolution.height, GThreadGroup2D_Y), 1);
+
+		// args and tile lists are consumed by the resolve draws
+		RenderBuilder.GlobalBarrier(VK_ACCESS_2_SHADER_WRITE_BIT, VK_ACCESS_2_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_2_SHADER_READ_BIT
+			, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_2_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_2_VERTEX_SHADER_BIT);
 	}
 	GraphicInterface->EndCmdDebug(RenderBuilder.GetCmdList());
 }
@@ -121,7 +170,7 @@ void UHDeferredShadingRenderer::RenderDepthPrePass(UHRenderBuilder& RenderBuilde
 void UHDeferredShadingRenderer::DepthPassTask(int32_t ThreadIdx)
 {
 	// simply separate buffer recording into N threads
-	const int32_t MaxCount = static_cast<int32_t>(OpaquesToRender.size());
+	const int32_t MaxCount = static_cast<int32_t>(OpaquesToRender[CurrentFrameRT].size());
 	const int32_t RendererCount = (MaxCount + NumParallelRenderSubmitters) / NumParallelRenderSubmitters;
 	const int32_t StartIdx = std::min(RendererCount * ThreadIdx, MaxCount);
 	const int32_t EndIdx = (ThreadIdx == NumParallelRenderSubmitters - 1) ? MaxCount : std::min(StartIdx + RendererCount, MaxCount);
@@ -153,7 +202,7 @@ void UHDeferredShadingRenderer::DepthPassTask(int32_t ThreadIdx)
 
 	for (int32_t I = StartIdx; I < EndIdx; I++)
 	{
-		const UHMeshRendererComponent* Renderer = OpaquesToRender[I];
+		const UHMeshRendererComponent* Renderer = OpaquesToRender[CurrentFrameRT][I];
 		const UHMaterial* Mat = Renderer->GetMaterial();
 		UHMesh* Mesh = Renderer->GetMesh();
 		int32_t RendererIdx = Renderer->GetBufferDataIndex();
@@ -168,16 +217,15 @@ void UHDeferredShadingRenderer::DepthPassTask(int32_t ThreadIdx)
 		RenderBuilder.BindVertexBuffer(Mesh->GetPositionBuffer()->GetBuffer());
 		RenderBuilder.BindIndexBuffer(Mesh);
 		RenderBuilder.BindDescriptorSet(DepthShader->GetPipelineLayout(), DepthShader->GetDescriptorSet(CurrentFrameRT));
+		RenderBuilder.BindMaterialArena(DepthShader, CurrentFrameRT);
 
 		// draw call
-		RenderBuilder.DrawIndexed(Mesh->GetIndicesCount());
+		RenderBuilder.DrawIndexed(Mesh->GetIndicesCount(), RendererIdx);
 
 		GraphicInterface->EndCmdDebug(RenderBuilder.GetCmdList());
 	}
 
 	RenderBuilder.EndCommandBuffer();
 
-#if WITH_EDITOR
 	ThreadDrawCalls[ThreadIdx] += RenderBuilder.DrawCalls;
-#endif
 }
\ No newline at end of file
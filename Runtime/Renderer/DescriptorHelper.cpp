@@ -1,5 +1,27 @@
 #include "DescriptorHelper.h"
 
+// pending writes of a thread, the info arrays are copied since the caller's infos are on stack
+// pointers are resolved when flushing as the vectors could grow
+struct UHDescriptorWriteBatch
+{
+	std::vector<VkWriteDescriptorSet> Writes;
+	std::vector<size_t> InfoOffsets;
+	std::vector<VkDescriptorImageInfo> ImageInfos;
+	std::vector<VkDescriptorBufferInfo> BufferInfos;
+	std::vector<VkWriteDescriptorSetAccelerationStructureKHR> ASWrites;
+	std::vector<VkAccelerationStructureKHR> ASes;
+	int32_t Depth = 0;
+};
+static thread_local UHDescriptorWriteBatch GDescriptorWriteBatch;
+
+static bool IsImageDescriptor(VkDescriptorType InType)
+{
+	return InType == VK_DESCRIPTOR_TYPE_SAMPLER
+		|| InType == VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE
+		|| InType == VK_DESCRIPTOR_TYPE_STORAGE_IMAGE
+		|| InType == VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+}
+
 UHDescriptorHelper::UHDescriptorHelper(VkDevice InDevice, VkDescriptorSet InSet)
 	: LogicalDevice(InDevice)
 	, DescriptorSetToWrite(InSet)
@@ -13,6 +35,88 @@ UHDescriptorHelper::~UHDescriptorHelper()
 	DescriptorSetToWrite = nullptr;
 }
 
+void UHDescriptorHelper::BeginBatch()
+{
+	GDescriptorWriteBatch.Depth++;
+}
+
+void UHDescriptorHelper::FlushBatch(VkDevice InDevice)
+{
+	UHDescriptorWriteBatch& Batch = GDescriptorWriteBatch;
+	Batch.Depth--;
+
+	// only the outermost scope flushes
+	if (Batch.Depth > 0 || Batch.Writes.size() == 0)
+	{
+		return;
+	}
+
+	for (size_t Idx = 0; Idx < Batch.Writes.size(); Idx++)
+	{
+		VkWriteDescriptorSet& Write = Batch.Writes[Idx];
+		const size_t Offset = Batch.InfoOffsets[Idx];
+
+		if (Write.descriptorType == VK_DESCRIPTOR_TYPE_ACCELERATION_STRUCTURE_KHR)
+		{
+			Batch.ASWrites[Offset].pAccelerationStructures = &Batch.ASes[Offset];
+			Write.pNext = &Batch.ASWrites[Offset];
+		}
+		else if (IsImageDescriptor(Write.descriptorType))
+		{
+			Write.pImageInfo = &Batch.ImageInfos[Offset];
+		}
+		else
+		{
+			Write.pBufferInfo = &Batch.BufferInfos[Offset];
+		}
+	}
+
+	vkUpdateDescriptorSets(InDevice, static_cast<uint32_t>(Batch.Writes.size()), Batch.Writes.data(), 0, nullptr);
+
+	Batch.Writes.clear();
+	Batch.InfoOffsets.clear();
+	Batch.ImageInfos.clear();
+	Batch.BufferInfos.clear();
+	Batch.ASWrites.clear();
+	Batch.ASes.clear();
+}
+
+void UHDescriptorHelper::UpdateDescriptorSet(const VkWriteDescriptorSet& InWrite)
+{
+	UHDescriptorWriteBatch& Batch = GDescriptorWriteBatch;
+	if (Batch.Depth == 0)
+	{
+		vkUpdateDescriptorSets(LogicalDevice, 1, &InWrite, 0, nullptr);
+		return;
+	}
+
+	VkWriteDescriptorSet Write = InWrite;
+	if (Write.descriptorType == VK_DESCRIPTOR_TYPE_ACCELERATION_STRUCTURE_KHR)
+	{
+		// only single TLAS is written at once
+		const VkWriteDescriptorSetAccelerationStructureKHR* ASWrite = reinterpret_cast<const VkWriteDescriptorSetAccelerationStructureKHR*>(InWrite.pNext);
+		Batch.InfoOffsets.push_back(Batch.ASWrites.size());
+		Batch.ASWrites.push_back(*ASWrite);
+		Batch.ASes.push_back(ASWrite->pAccelerationStructures[0]);
+	}
+	else if (IsImageDescriptor(Write.descriptorType))
+	{
+		Batch.InfoOffsets.push_back(Batch.ImageInfos.size());
+		Batch.ImageInfos.insert(Batch.ImageInfos.end(), InWrite.pImageInfo, InWrite.pImageInfo + InWrite.descriptorCount);
+	}
+	else
+	{
+		Batch.InfoOffsets.push_back(Batch.BufferInfos.size());
+		Batch.BufferInfos.insert(Batch.BufferInfos.end(), InWrite.pBufferInfo, InWrite.pBufferInfo + InWrite.descriptorCount);
+	}
+
+	// pointers are resolved in FlushBatch()
+	Write.pNext = nullptr;
+	Write.pImageInfo = nullptr;
+	Write.pBufferInfo = nullptr;
+	Batch.Writes.push_back(Write);
+}
+
 void UHDescriptorHelper::WriteImage(const UHTexture* InTexture, const uint32_t InDstBinding
 	, const bool bIsReadWrite, const int32_t MipIdx, const int32_t LayerIdx, const bool bUavAsSrv)
 {
@@ -40,7 +144,7 @@ void UHDescriptorHelper::WriteImage(const UHTexture* InTexture, const uint32_t I
 	DescriptorWrite.descriptorCount = 1;
 	DescriptorWrite.pImageInfo = &NewInfo;
 
-	vkUpdateDescriptorSets(LogicalDevice, 1, &DescriptorWrite, 0, nullptr);
+	UpdateDescriptorSet(DescriptorWrite);
 }
 
 // write multiple image at once for descriptor array
@@ -64,7 +168,7 @@ void UHDescriptorHelper::WriteImage(const std::vector<UHTexture*>& InTextures, c
 	DescriptorWrite.descriptorCount = static_cast<uint32_t>(NewInfos.size());
 	DescriptorWrite.pImageInfo = NewInfos.data();
 
-	vkUpdateDescriptorSets(LogicalDevice, 1, &DescriptorWrite, 0, nullptr);
+	UpdateDescriptorSet(DescriptorWrite);
 }
 
 void UHDescriptorHelper::WriteSampler(const UHSampler* InSampler, const uint32_t InDstBinding)
@@ -80,7 +184,7 @@ void UHDescriptorHelper::WriteSampler(const UHSampler* InSampler, const uint32_t
 	DescriptorWrite.descriptorCount = 1;
 	DescriptorWrite.pImageInfo = &NewInfo;
 
-	vkUpdateDescriptorSets(LogicalDevice, 1, &DescriptorWrite, 0, nullptr);
+	UpdateDescriptorSet(DescriptorWrite);
 }
 
 // multiple sampler write
@@ -103,7 +207,7 @@ void UHDescriptorHelper::WriteSampler(const std::vector<UHSampler*>& InSamplers,
 	DescriptorWrite.descriptorCount = static_cast<uint32_t>(NewInfos.size());
 	DescriptorWrite.pImageInfo = NewInfos.data();
 
-	vkUpdateDescriptorSets(LogicalDevice, 1, &DescriptorWrite, 0, nullptr);
+	UpdateDescriptorSet(DescriptorWrite);
 }
 
 void UHDescriptorHelper::WriteTLAS(const UHAccelerationStructure* InAS, const uint32_t InDstBinding)
@@ -124,5 +228,16 @@ void UHDescriptorHelper::WriteTLAS(const UHAccelerationStructure* InAS, const ui
 	DesciptorWriterAS.pAccelerationStructures = AS;
 	DescriptorWrite.pNext = &DesciptorWriterAS;
 
-	vkUpdateDescriptorSets(LogicalDevice, 1, &DescriptorWrite, 0, nullptr);
+	UpdateDescriptorSet(DescriptorWrite);
+}
+
+UHDescriptorBatchScope::UHDescriptorBatchScope(VkDevice InDevice)
+	: LogicalDevice(InDevice)
+{
+	UHDescriptorHelper::BeginBatch();
+}
+
+UHDescriptorBatchScope::~UHDescriptorBatchScope()
+{
+	UHDescriptorHelper::FlushBatch(LogicalDevice);
 }
\ No newline at end of file
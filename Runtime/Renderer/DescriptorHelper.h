@@ -6,21 +6,28 @@
 #include "../Classes/Sampler.h"
 #include "../Classes/AccelerationStructure.h"
 
+// writes are updated immediately by default
+// writes within UHDescriptorBatchScope are accumulated and flushed with a single vkUpdateDescriptorSets call
 class UHDescriptorHelper
 {
 public:
 	UHDescriptorHelper(VkDevice InDevice, VkDescriptorSet InSet);
 	~UHDescriptorHelper();
 
+	// batch functions, the batch is per thread and can be nested
+	static void BeginBatch();
+	static void FlushBatch(VkDevice InDevice);
+
 	// write constant buffer once
 	template<typename T>
 	void WriteConstantBuffer(const UHRenderBuffer<T>* InBuffer
 		, const uint32_t InDstBinding
-		, const uint64_t InOffset = 0)
+		, const uint64_t InOffset = 0
+		, const uint64_t InElementCount = 1)
 	{
 		VkDescriptorBufferInfo NewInfo{};
 		NewInfo.buffer = InBuffer->GetBuffer();
-		NewInfo.range = InBuffer->GetBufferStride();
+		NewInfo.range = InElementCount * InBuffer->GetBufferStride();
 		NewInfo.offset = InOffset * InBuffer->GetBufferStride();
 		
 		VkWriteDescriptorSet DescriptorWrite{};
@@ -31,7 +38,29 @@ public:
 		DescriptorWrite.descriptorCount = 1;
 		DescriptorWrite.pBufferInfo = &NewInfo;
 
-		vkUpdateDescriptorSets(LogicalDevice, 1, &DescriptorWrite, 0, nullptr);
+		UpdateDescriptorSet(DescriptorWrite);
+	}
+
+	// write dynamic constant buffer once, the offset is given when binding the set
+	template<typename T>
+	void WriteDynamicConstantBuffer(const UHRenderBuffer<T>* InBuffer
+		, const uint32_t InDstBinding
+		, const uint64_t InElementCount)
+	{
+		VkDescriptorBufferInfo NewInfo{};
+		NewInfo.buffer = InBuffer->GetBuffer();
+		NewInfo.range = InElementCount * InBuffer->GetBufferStride();
+		NewInfo.offset = 0;
+
+		VkWriteDescriptorSet DescriptorWrite{};
+		DescriptorWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+		DescriptorWrite.dstSet = DescriptorSetToWrite;
+		DescriptorWrite.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+		DescriptorWrite.dstBinding = InDstBinding;
+		DescriptorWrite.descriptorCount = 1;
+		DescriptorWrite.pBufferInfo = &NewInfo;
+
+		UpdateDescriptorSet(DescriptorWrite);
 	}
 
 	// write storage buffer once
@@ -62,7 +91,7 @@ public:
 		DescriptorWrite.descriptorCount = 1;
 		DescriptorWrite.pBufferInfo = &NewInfo;
 
-		vkUpdateDescriptorSets(LogicalDevice, 1, &DescriptorWrite, 0, nullptr);
+		UpdateDescriptorSet(DescriptorWrite);
 	}
 
 	// write multiple storage buffer, this will always bind full range and 0 offset for individual buffer
@@ -98,7 +127,7 @@ public:
 		DescriptorWrite.descriptorCount = static_cast<uint32_t>(NewInfos.size());
 		DescriptorWrite.pBufferInfo = NewInfos.data();
 
-		vkUpdateDescriptorSets(LogicalDevice, 1, &DescriptorWrite, 0, nullptr);
+		UpdateDescriptorSet(DescriptorWrite);
 	}
 
 	// write multiple storage buffer, but this uses VkDescriptorBufferInfo as input directly
@@ -112,7 +141,7 @@ public:
 		DescriptorWrite.descriptorCount = static_cast<uint32_t>(InBufferInfos.size());
 		DescriptorWrite.pBufferInfo = InBufferInfos.data();
 
-		vkUpdateDescriptorSets(LogicalDevice, 1, &DescriptorWrite, 0, nullptr);
+		UpdateDescriptorSet(DescriptorWrite);
 	}
 
 	// write image/sampler once
@@ -124,6 +153,19 @@ public:
 	void WriteTLAS(const UHAccelerationStructure* InAS, const uint32_t InDstBinding);
 
 private:
+	// update immediately or push to the batch
+	void UpdateDescriptorSet(const VkWriteDescriptorSet& InWrite);
+
 	VkDevice LogicalDevice;
 	VkDescriptorSet DescriptorSetToWrite;
-};
\ No newline at end of file
+};
+// scope for batching descriptor writes in this thread
+class UHDescriptorBatchScope
+{
+public:
+	UHDescriptorBatchScope(VkDevice InDevice);
+	~UHDescriptorBatchScope();
+
+private:
+	VkDevice LogicalDevice;
+};
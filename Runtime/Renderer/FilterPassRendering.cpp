@@ -1,5 +1,22 @@
 #include "DeferredShadingRenderer.h"
 
+// copy when there is no scaling and format conversion, it's cheaper and it's the only option on async compute queue
+static void CopyOrBlit(UHRenderBuilder& RenderBuilder, UHRenderTexture* Src, UHRenderTexture* Dst, VkExtent2D InExtent)
+{
+	const bool bCanCopy = Src->GetFormat() == Dst->GetFormat()
+		&& Src->GetExtent().width == InExtent.width && Src->GetExtent().height == InExtent.height
+		&& Dst->GetExtent().width == InExtent.width && Dst->GetExtent().height == InExtent.height;
+
+	if (bCanCopy)
+	{
+		RenderBuilder.CopyTexture(Src, Dst);
+	}
+	else
+	{
+		RenderBuilder.Blit(Src, Dst, InExtent, InExtent);
+	}
+}
+
 // Use a fixed kernal for now, the weights are pre-calculated based on the following lines:
 // Sigma2 = 2.0f * Sigma * Sigma;
 // BlurRadius = ceil(2.0f * sigma);
@@ -124,7 +141,7 @@ void UHDeferredShadingRenderer::DispatchBilateralFilter(UHRenderBuilder& RenderB
 		return;
 	}
 
-	// get temp buffers
+	// get temp buffers, they could be aliased with the temps of other filters and the render graph issues the aliasing barriers
 	UHRenderTexture* FilterTempRT0 = Constants.FilterTempRT0;
 	UHRenderTexture* FilterTempRT1 = Constants.FilterTempRT1;
 
@@ -134,7 +151,7 @@ void UHDeferredShadingRenderer::DispatchBilateralFilter(UHRenderBuilder& RenderB
 	RenderBuilder.PushResourceBarrier(UHImageBarrier(Input, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL));
 	RenderBuilder.PushResourceBarrier(UHImageBarrier(FilterTempRT1, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL));
 	RenderBuilder.FlushResourceBarrier();
-	RenderBuilder.Blit(Input, FilterTempRT1, FilterResolution, FilterResolution);
+	CopyOrBlit(RenderBuilder, Input, FilterTempRT1, FilterResolution);
 
 	// update constants
 	const VkPushConstantRange& CosntRange = BilateralFilterHShader->GetPushConstantRange();
@@ -178,7 +195,7 @@ void UHDeferredShadingRenderer::DispatchBilateralFilter(UHRenderBuilder& RenderB
 	RenderBuilder.PushResourceBarrier(UHImageBarrier(FilterTempRT1, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL));
 	RenderBuilder.PushResourceBarrier(UHImageBarrier(Output, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL));
 	RenderBuilder.FlushResourceBarrier();
-	RenderBuilder.Blit(FilterTempRT1, Output, FilterResolution, FilterResolution);
+	CopyOrBlit(RenderBuilder, FilterTempRT1, Output, FilterResolution);
 
 	GraphicInterface->EndCmdDebug(RenderBuilder.GetCmdList());
 }
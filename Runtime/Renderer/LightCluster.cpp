@@ -0,0 +1,522 @@
+#include "LightCluster.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include "../Engine/TraceProfiler.h"
+
+#if defined(_M_X64) || defined(__SSE2__)
+#include <xmmintrin.h>
+#define UH_LIGHT_CLUSTER_SSE 1
+#else
+#define UH_LIGHT_CLUSTER_SSE 0
+#endif
+
+// depth of the last slice, it's practically unbounded but still finite so the froxel math won't produce NaN
+static const float GLightClusterMaxDepth = 1e30f;
+
+// scalar tests, these are used for the remaining froxels that can't fill a SSE register
+static bool SphereIntersectsFroxel(float Cx, float Cy, float Cz, float RadiusSq
+	, float MinX, float MinY, float MinZ, float MaxX, float MaxY, float MaxZ)
+{
+	const float Dx = std::max(std::max(MinX - Cx, Cx - MaxX), 0.0f);
+	const float Dy = std::max(std::max(MinY - Cy, Cy - MaxY), 0.0f);
+	const float Dz = std::max(std::max(MinZ - Cz, Cz - MaxZ), 0.0f);
+	return Dx * Dx + Dy * Dy + Dz * Dz <= RadiusSq;
+}
+
+// cone vs froxel bounding sphere, see "Cull that cone!" by Bart Wronski
+static bool ConeIntersectsSphere(const UHVector3& InOrigin, const UHVector3& InDir, float InRange, float InCos, float InSin
+	, float Sx, float Sy, float Sz, float SphereRadius)
+{
+	const float Vx = Sx - InOrigin.x;
+	const float Vy = Sy - InOrigin.y;
+	const float Vz = Sz - InOrigin.z;
+	const float VLenSq = Vx * Vx + Vy * Vy + Vz * Vz;
+	const float V1Len = Vx * InDir.x + Vy * InDir.y + Vz * InDir.z;
+	const float DistClosest = InCos * std::sqrt(std::max(VLenSq - V1Len * V1Len, 0.0f)) - V1Len * InSin;
+
+	const bool bAngleCull = DistClosest > SphereRadius;
+	const bool bFrontCull = V1Len > SphereRadius + InRange;
+	const bool bBackCull = V1Len < -SphereRadius;
+	return !(bAngleCull || bFrontCull || bBackCull);
+}
+
+UHLightCluster::UHLightCluster()
+	: Width(0)
+	, Height(0)
+	, ClusterCountX(0)
+	, ClusterCountY(0)
+	, ClusterCount(0)
+	, ProjScaleX(0.0f)
+	, ProjScaleY(0.0f)
+	, NearPlane(0.0f)
+	, FarPlane(0.0f)
+	, SliceScale(0.0f)
+	, SliceBias(0.0f)
+	, bIsGridDirty(true)
+{
+
+}
+
+void UHLightCluster::SetResolution(uint32_t InWidth, uint32_t InHeight)
+{
+	if (Width == InWidth && Height == InHeight)
+	{
+		return;
+	}
+
+	Width = std::max(InWidth, 1u);
+	Height = std::max(InHeight, 1u);
+	ClusterCountX = (Width + TileSize - 1) / TileSize;
+	ClusterCountY = (Height + TileSize - 1) / TileSize;
+	ClusterCount = ClusterCountX * ClusterCountY * NumSlices;
+
+	FroxelMinX.resize(ClusterCount);
+	FroxelMinY.resize(ClusterCount);
+	FroxelMinZ.resize(ClusterCount);
+	FroxelMaxX.resize(ClusterCount);
+	FroxelMaxY.resize(ClusterCount);
+	FroxelMaxZ.resize(ClusterCount);
+	FroxelCenterX.resize(ClusterCount);
+	FroxelCenterY.resize(ClusterCount);
+	FroxelCenterZ.resize(ClusterCount);
+	FroxelRadius.resize(ClusterCount);
+
+	for (UHClusterLightList* List : { &PointLightList, &SpotLightList })
+	{
+		List->Counts.resize(ClusterCount);
+		List->Indices.resize(ClusterCount * MaxLightsPerCluster);
+		List->Packed.resize(GetListBufferElementCount());
+		ResetList(*List);
+		PackList(*List);
+	}
+
+	bIsGridDirty = true;
+}
+
+void UHLightCluster::UpdateGrid(const UHMatrix4x4& InProjection, float InNearPlane, float InFarPlane)
+{
+	// the projection is 0-1 depth perspective, [0][0] and [1][1] are the view to NDC scales
+	const float NewScaleX = InProjection[0][0];
+	const float NewScaleY = InProjection[1][1];
+	const float NewNear = std::max(InNearPlane, 0.01f);
+	const float NewFar = std::max(InFarPlane, NewNear * 2.0f);
+
+	if (!bIsGridDirty && NewScaleX == ProjScaleX && NewScaleY == ProjScaleY && NewNear == NearPlane && NewFar == FarPlane)
+	{
+		return;
+	}
+
+	ProjScaleX = NewScaleX;
+	ProjScaleY = NewScaleY;
+	NearPlane = NewNear;
+	FarPlane = NewFar;
+	bIsGridDirty = false;
+
+	// slice = log(depth) * scale + bias, so depth range of slice K is [Near * (Far/Near)^(K/N), Near * (Far/Near)^((K+1)/N)]
+	const float LogRatio = std::log(FarPlane / NearPlane);
+	SliceScale = static_cast<float>(NumSlices) / LogRatio;
+	SliceBias = -static_cast<float>(NumSlices) * std::log(NearPlane) / LogRatio;
+
+	for (uint32_t Z = 0; Z < NumSlices; Z++)
+	{
+		const float SliceNear = NearPlane * std::pow(FarPlane / NearPlane, static_cast<float>(Z) / NumSlices);
+		const float SliceFar = (Z == NumSlices - 1) ? GLightClusterMaxDepth
+			: NearPlane * std::pow(FarPlane / NearPlane, static_cast<float>(Z + 1) / NumSlices);
+
+		for (uint32_t Y = 0; Y < ClusterCountY; Y++)
+		{
+			const float NdcY0 = static_cast<float>(Y * TileSize) / Height * 2.0f - 1.0f;
+			const float NdcY1 = static_cast<float>(std::min((Y + 1) * TileSize, Height)) / Height * 2.0f - 1.0f;
+
+			for (uint32_t X = 0; X < ClusterCountX; X++)
+			{
+				const float NdcX0 = static_cast<float>(X * TileSize) / Width * 2.0f - 1.0f;
+				const float NdcX1 = static_cast<float>(std::min((X + 1) * TileSize, Width)) / Width * 2.0f - 1.0f;
+				const uint32_t Idx = X + Y * ClusterCountX + Z * ClusterCountX * ClusterCountY;
+
+				// view pos = NDC * depth / scale, the extremes are at the near or far corners
+				FroxelMinX[Idx] = std::min(NdcX0 * SliceNear, NdcX0 * SliceFar) / ProjScaleX;
+				FroxelMaxX[Idx] = std::max(NdcX1 * SliceNear, NdcX1 * SliceFar) / ProjScaleX;
+				FroxelMinY[Idx] = std::min(NdcY0 * SliceNear, NdcY0 * SliceFar) / ProjScaleY;
+				FroxelMaxY[Idx] = std::max(NdcY1 * SliceNear, NdcY1 * SliceFar) / ProjScaleY;
+				FroxelMinZ[Idx] = SliceNear;
+				FroxelMaxZ[Idx] = SliceFar;
+
+				const float ExtentX = (FroxelMaxX[Idx] - FroxelMinX[Idx]) * 0.5f;
+				const float ExtentY = (FroxelMaxY[Idx] - FroxelMinY[Idx]) * 0.5f;
+				const float ExtentZ = (SliceFar - SliceNear) * 0.5f;
+				FroxelCenterX[Idx] = FroxelMinX[Idx] + ExtentX;
+				FroxelCenterY[Idx] = FroxelMinY[Idx] + ExtentY;
+				FroxelCenterZ[Idx] = SliceNear + ExtentZ;
+				FroxelRadius[Idx] = std::sqrt(ExtentX * ExtentX + ExtentY * ExtentY + ExtentZ * ExtentZ);
+			}
+		}
+	}
+}
+
+void UHLightCluster::AssignPointLights(const std::vector<UHPointLightConstants>& InLights, const UHMatrix4x4& InView)
+{
+	UH_TRACE_SCOPE("AssignPointLights");
+	ResetList(PointLightList);
+
+	for (size_t Ldx = 0; Ldx < InLights.size(); Ldx++)
+	{
+		const UHPointLightConstants& Light = InLights[Ldx];
+		if (Light.IsEnabled == 0 || Light.Radius <= 0.0f)
+		{
+			continue;
+		}
+
+		// to view space, the view matrix is right-handed so flip z to get the depth
+		const UHVector4 ViewPos = InView * UHVector4(Light.Position, 1.0f);
+		const UHVector3 Center(ViewPos.x, ViewPos.y, -ViewPos.z);
+		const float RadiusSq = Light.Radius * Light.Radius;
+		const uint32_t LightIdx = static_cast<uint32_t>(Ldx);
+
+		uint32_t MinCluster[3];
+		uint32_t MaxCluster[3];
+		if (!GetClusterRange(Center, Light.Radius, MinCluster, MaxCluster))
+		{
+			continue;
+		}
+
+#if UH_LIGHT_CLUSTER_SSE
+		const __m128 Cx = _mm_set1_ps(Center.x);
+		const __m128 Cy = _mm_set1_ps(Center.y);
+		const __m128 Cz = _mm_set1_ps(Center.z);
+		const __m128 R2 = _mm_set1_ps(RadiusSq);
+		const __m128 Zero = _mm_setzero_ps();
+#endif
+
+		for (uint32_t Z = MinCluster[2]; Z <= MaxCluster[2]; Z++)
+		{
+			for (uint32_t Y = MinCluster[1]; Y <= MaxCluster[1]; Y++)
+			{
+				const uint32_t RowStart = Y * ClusterCountX + Z * ClusterCountX * ClusterCountY;
+				uint32_t X = MinCluster[0];
+
+#if UH_LIGHT_CLUSTER_SSE
+				// sphere vs AABB for 4 froxels at a time
+				for (; X + 3 <= MaxCluster[0]; X += 4)
+				{
+					const uint32_t Idx = RowStart + X;
+					const __m128 Dx = _mm_max_ps(_mm_max_ps(_mm_sub_ps(_mm_loadu_ps(&FroxelMinX[Idx]), Cx), _mm_sub_ps(Cx, _mm_loadu_ps(&FroxelMaxX[Idx]))), Zero);
+					const __m128 Dy = _mm_max_ps(_mm_max_ps(_mm_sub_ps(_mm_loadu_ps(&FroxelMinY[Idx]), Cy), _mm_sub_ps(Cy, _mm_loadu_ps(&FroxelMaxY[Idx]))), Zero);
+					const __m128 Dz = _mm_max_ps(_mm_max_ps(_mm_sub_ps(_mm_loadu_ps(&FroxelMinZ[Idx]), Cz), _mm_sub_ps(Cz, _mm_loadu_ps(&FroxelMaxZ[Idx]))), Zero);
+					const __m128 DistSq = _mm_add_ps(_mm_add_ps(_mm_mul_ps(Dx, Dx), _mm_mul_ps(Dy, Dy)), _mm_mul_ps(Dz, Dz));
+
+					const int32_t Mask = _mm_movemask_ps(_mm_cmple_ps(DistSq, R2));
+					for (uint32_t Bit = 0; Mask != 0 && Bit < 4; Bit++)
+					{
+						if (Mask & (1 << Bit))
+						{
+							AddLight(PointLightList, Idx + Bit, LightIdx);
+						}
+					}
+				}
+#endif
+
+				for (; X <= MaxCluster[0]; X++)
+				{
+					const uint32_t Idx = RowStart + X;
+					if (SphereIntersectsFroxel(Center.x, Center.y, Center.z, RadiusSq
+						, FroxelMinX[Idx], FroxelMinY[Idx], FroxelMinZ[Idx], FroxelMaxX[Idx], FroxelMaxY[Idx], FroxelMaxZ[Idx]))
+					{
+						AddLight(PointLightList, Idx, LightIdx);
+					}
+				}
+			}
+		}
+	}
+
+	PackList(PointLightList);
+}
+
+void UHLightCluster::AssignSpotLights(const std::vector<UHSpotLightConstants>& InLights, const UHMatrix4x4& InView)
+{
+	UH_TRACE_SCOPE("AssignSpotLights");
+	ResetList(SpotLightList);
+
+	for (size_t Ldx = 0; Ldx < InLights.size(); Ldx++)
+	{
+		const UHSpotLightConstants& Light = InLights[Ldx];
+		if (Light.IsEnabled == 0 || Light.Radius <= 0.0f)
+		{
+			continue;
+		}
+
+		const UHVector4 ViewPos = InView * UHVector4(Light.Position, 1.0f);
+		const UHVector4 ViewDir = InView * UHVector4(Light.Dir, 0.0f);
+		const UHVector3 Origin(ViewPos.x, ViewPos.y, -ViewPos.z);
+		const UHVector3 Dir = UHMathHelpers::UHVector3Normalize(UHVector3(ViewDir.x, ViewDir.y, -ViewDir.z));
+
+		// angle is the half cone angle
+		const float HalfAngle = std::min(Light.Angle, G_PI * 0.5f);
+		const float CosAngle = std::cos(HalfAngle);
+		const float SinAngle = std::sin(HalfAngle);
+
+		// bounding sphere of the cone, used for the cluster range and a coarse AABB test
+		UHVector3 BoundCenter;
+		float BoundRadius;
+		if (HalfAngle > G_PI * 0.25f)
+		{
+			BoundCenter = Origin + Dir * (Light.Radius * CosAngle);
+			BoundRadius = Light.Radius * SinAngle;
+		}
+		else
+		{
+			BoundRadius = Light.Radius / (2.0f * CosAngle * CosAngle);
+			BoundCenter = Origin + Dir * BoundRadius;
+		}
+		const float BoundRadiusSq = BoundRadius * BoundRadius;
+		const uint32_t LightIdx = static_cast<uint32_t>(Ldx);
+
+		uint32_t MinCluster[3];
+		uint32_t MaxCluster[3];
+		if (!GetClusterRange(BoundCenter, BoundRadius, MinCluster, MaxCluster))
+		{
+			continue;
+		}
+
+#if UH_LIGHT_CLUSTER_SSE
+		const __m128 Cx = _mm_set1_ps(BoundCenter.x);
+		const __m128 Cy = _mm_set1_ps(BoundCenter.y);
+		const __m128 Cz = _mm_set1_ps(BoundCenter.z);
+		const __m128 R2 = _mm_set1_ps(BoundRadiusSq);
+		const __m128 Ox = _mm_set1_ps(Origin.x);
+		const __m128 Oy = _mm_set1_ps(Origin.y);
+		const __m128 Oz = _mm_set1_ps(Origin.z);
+		const __m128 Dx = _mm_set1_ps(Dir.x);
+		const __m128 Dy = _mm_set1_ps(Dir.y);
+		const __m128 Dz = _mm_set1_ps(Dir.z);
+		const __m128 CosA = _mm_set1_ps(CosAngle);
+		const __m128 SinA = _mm_set1_ps(SinAngle);
+		const __m128 Range = _mm_set1_ps(Light.Radius);
+		const __m128 Zero = _mm_setzero_ps();
+#endif
+
+		for (uint32_t Z = MinCluster[2]; Z <= MaxCluster[2]; Z++)
+		{
+			// the last slice is unbounded, its bounding sphere is useless for the cone test
+			const bool bTestCone = (Z != NumSlices - 1);
+
+			for (uint32_t Y = MinCluster[1]; Y <= MaxCluster[1]; Y++)
+			{
+				const uint32_t RowStart = Y * ClusterCountX + Z * ClusterCountX * ClusterCountY;
+				uint32_t X = MinCluster[0];
+
+#if UH_LIGHT_CLUSTER_SSE
+				for (; X + 3 <= MaxCluster[0]; X += 4)
+				{
+					const uint32_t Idx = RowStart + X;
+
+					// coarse cone bound vs AABB
+					const __m128 Ex = _mm_max_ps(_mm_max_ps(_mm_sub_ps(_mm_loadu_ps(&FroxelMinX[Idx]), Cx), _mm_sub_ps(Cx, _mm_loadu_ps(&FroxelMaxX[Idx]))), Zero);
+					const __m128 Ey = _mm_max_ps(_mm_max_ps(_mm_sub_ps(_mm_loadu_ps(&FroxelMinY[Idx]), Cy), _mm_sub_ps(Cy, _mm_loadu_ps(&FroxelMaxY[Idx]))), Zero);
+					const __m128 Ez = _mm_max_ps(_mm_max_ps(_mm_sub_ps(_mm_loadu_ps(&FroxelMinZ[Idx]), Cz), _mm_sub_ps(Cz, _mm_loadu_ps(&FroxelMaxZ[Idx]))), Zero);
+					const __m128 DistSq = _mm_add_ps(_mm_add_ps(_mm_mul_ps(Ex, Ex), _mm_mul_ps(Ey, Ey)), _mm_mul_ps(Ez, Ez));
+					__m128 Result = _mm_cmple_ps(DistSq, R2);
+
+					if (bTestCone)
+					{
+						// cone vs froxel bounding sphere
+						const __m128 SphereRadius = _mm_loadu_ps(&FroxelRadius[Idx]);
+						const __m128 Vx = _mm_sub_ps(_mm_loadu_ps(&FroxelCenterX[Idx]), Ox);
+						const __m128 Vy = _mm_sub_ps(_mm_loadu_ps(&FroxelCenterY[Idx]), Oy);
+						const __m128 Vz = _mm_sub_ps(_mm_loadu_ps(&FroxelCenterZ[Idx]), Oz);
+						const __m128 VLenSq = _mm_add_ps(_mm_add_ps(_mm_mul_ps(Vx, Vx), _mm_mul_ps(Vy, Vy)), _mm_mul_ps(Vz, Vz));
+						const __m128 V1Len = _mm_add_ps(_mm_add_ps(_mm_mul_ps(Vx, Dx), _mm_mul_ps(Vy, Dy)), _mm_mul_ps(Vz, Dz));
+						const __m128 Perp = _mm_sqrt_ps(_mm_max_ps(_mm_sub_ps(VLenSq, _mm_mul_ps(V1Len, V1Len)), Zero));
+						const __m128 DistClosest = _mm_sub_ps(_mm_mul_ps(CosA, Perp), _mm_mul_ps(V1Len, SinA));
+
+						const __m128 AngleKeep = _mm_cmple_ps(DistClosest, SphereRadius);
+						const __m128 FrontKeep = _mm_cmple_ps(V1Len, _mm_add_ps(SphereRadius, Range));
+						const __m128 BackKeep = _mm_cmpge_ps(V1Len, _mm_sub_ps(Zero, SphereRadius));
+						Result = _mm_and_ps(Result, _mm_and_ps(AngleKeep, _mm_and_ps(FrontKeep, BackKeep)));
+					}
+
+					const int32_t Mask = _mm_movemask_ps(Result);
+					for (uint32_t Bit = 0; Mask != 0 && Bit < 4; Bit++)
+					{
+						if (Mask & (1 << Bit))
+						{
+							AddLight(SpotLightList, Idx + Bit, LightIdx);
+						}
+					}
+				}
+#endif
+
+				for (; X <= MaxCluster[0]; X++)
+				{
+					const uint32_t Idx = RowStart + X;
+					if (!SphereIntersectsFroxel(BoundCenter.x, BoundCenter.y, BoundCenter.z, BoundRadiusSq
+						, FroxelMinX[Idx], FroxelMinY[Idx], FroxelMinZ[Idx], FroxelMaxX[Idx], FroxelMaxY[Idx], FroxelMaxZ[Idx]))
+					{
+						continue;
+					}
+
+					if (bTestCone && !ConeIntersectsSphere(Origin, Dir, Light.Radius, CosAngle, SinAngle
+						, FroxelCenterX[Idx], FroxelCenterY[Idx], FroxelCenterZ[Idx], FroxelRadius[Idx]))
+					{
+						continue;
+					}
+
+					AddLight(SpotLightList, Idx, LightIdx);
+				}
+			}
+		}
+	}
+
+	PackList(SpotLightList);
+}
+
+const std::vector<uint32_t>& UHLightCluster::GetPointLightList() const
+{
+	return PointLightList.Packed;
+}
+
+const std::vector<uint32_t>& UHLightCluster::GetSpotLightList() const
+{
+	return SpotLightList.Packed;
+}
+
+size_t UHLightCluster::GetPointLightListSize() const
+{
+	return PointLightList.PackedSize;
+}
+
+size_t UHLightCluster::GetSpotLightListSize() const
+{
+	return SpotLightList.PackedSize;
+}
+
+uint32_t UHLightCluster::GetListBufferElementCount() const
+{
+	// offsets + shared empty entry + (count + indices) for each cluster
+	return ClusterCount + 1 + ClusterCount * (MaxLightsPerCluster + 1);
+}
+
+uint32_t UHLightCluster::GetClusterCountX() const
+{
+	return ClusterCountX;
+}
+
+uint32_t UHLightCluster::GetClusterCountY() const
+{
+	return ClusterCountY;
+}
+
+uint32_t UHLightCluster::GetClusterCountZ() const
+{
+	return NumSlices;
+}
+
+float UHLightCluster::GetSliceScale() const
+{
+	return SliceScale;
+}
+
+float UHLightCluster::GetSliceBias() const
+{
+	return SliceBias;
+}
+
+bool UHLightCluster::GetClusterRange(const UHVector3& InCenter, float InRadius, uint32_t OutMin[3], uint32_t OutMax[3]) const
+{
+	// behind the camera
+	const float MaxDepth = InCenter.z + InRadius;
+	if (MaxDepth <= NearPlane || ClusterCount == 0)
+	{
+		return false;
+	}
+	const float MinDepth = std::max(InCenter.z - InRadius, NearPlane);
+
+	// project the view space AABB of the sphere, x/depth and y/depth reach the extremes at the corners
+	float MinNdcX = std::numeric_limits<float>::max();
+	float MaxNdcX = -std::numeric_limits<float>::max();
+	float MinNdcY = std::numeric_limits<float>::max();
+	float MaxNdcY = -std::numeric_limits<float>::max();
+	for (const float Depth : { MinDepth, MaxDepth })
+	{
+		for (const float Sign : { -1.0f, 1.0f })
+		{
+			const float NdcX = (InCenter.x + Sign * InRadius) * ProjScaleX / Depth;
+			const float NdcY = (InCenter.y + Sign * InRadius) * ProjScaleY / Depth;
+			MinNdcX = std::min(MinNdcX, NdcX);
+			MaxNdcX = std::max(MaxNdcX, NdcX);
+			MinNdcY = std::min(MinNdcY, NdcY);
+			MaxNdcY = std::max(MaxNdcY, NdcY);
+		}
+	}
+
+	if (MaxNdcX < -1.0f || MinNdcX > 1.0f || MaxNdcY < -1.0f || MinNdcY > 1.0f)
+	{
+		return false;
+	}
+
+	// NDC to tile, clamp to the screen
+	const float PixelToTileX = static_cast<float>(Width) / TileSize;
+	const float PixelToTileY = static_cast<float>(Height) / TileSize;
+	OutMin[0] = static_cast<uint32_t>(std::max(MinNdcX * 0.5f + 0.5f, 0.0f) * PixelToTileX);
+	OutMax[0] = std::min(static_cast<uint32_t>(std::min(MaxNdcX * 0.5f + 0.5f, 1.0f) * PixelToTileX), ClusterCountX - 1);
+	OutMin[1] = static_cast<uint32_t>(std::max(MinNdcY * 0.5f + 0.5f, 0.0f) * PixelToTileY);
+	OutMax[1] = std::min(static_cast<uint32_t>(std::min(MaxNdcY * 0.5f + 0.5f, 1.0f) * PixelToTileY), ClusterCountY - 1);
+	OutMin[0] = std::min(OutMin[0], OutMax[0]);
+	OutMin[1] = std::min(OutMin[1], OutMax[1]);
+
+	OutMin[2] = GetSlice(MinDepth);
+	OutMax[2] = GetSlice(MaxDepth);
+
+	return true;
+}
+
+uint32_t UHLightCluster::GetSlice(float InViewDepth) const
+{
+	// must match GetClusterIndex() in UHLightCommon.hlsli
+	const float Slice = std::log(std::max(InViewDepth, NearPlane)) * SliceScale + SliceBias;
+	return std::min(static_cast<uint32_t>(std::max(Slice, 0.0f)), NumSlices - 1);
+}
+
+void UHLightCluster::ResetList(UHClusterLightList& InList)
+{
+	std::fill(InList.Counts.begin(), InList.Counts.end(), 0);
+}
+
+void UHLightCluster::AddLight(UHClusterLightList& InList, uint32_t InClusterIdx, uint32_t InLightIdx)
+{
+	// lights exceed the limit are dropped, same as the tile-based culling before
+	uint32_t& Count = InList.Counts[InClusterIdx];
+	if (Count < MaxLightsPerCluster)
+	{
+		InList.Indices[InClusterIdx * MaxLightsPerCluster + Count] = InLightIdx;
+		Count++;
+	}
+}
+
+void UHLightCluster::PackList(UHClusterLightList& InList)
+{
+	UH_TRACE_SCOPE("PackLightClusterList");
+
+	// offsets are in bytes for ByteAddressBuffer, empty clusters point to the shared zero count entry
+	const uint32_t EmptyEntry = ClusterCount;
+	InList.Packed[EmptyEntry] = 0;
+
+	uint32_t Cursor = ClusterCount + 1;
+	for (uint32_t Cdx = 0; Cdx < ClusterCount; Cdx++)
+	{
+		const uint32_t Count = InList.Counts[Cdx];
+		if (Count == 0)
+		{
+			InList.Packed[Cdx] = EmptyEntry * 4;
+			continue;
+		}
+
+		InList.Packed[Cdx] = Cursor * 4;
+		InList.Packed[Cursor++] = Count;
+		std::copy_n(InList.Indices.begin() + Cdx * MaxLightsPerCluster, Count, InList.Packed.begin() + Cursor);
+		Cursor += Count;
+	}
+
+	InList.PackedSize = Cursor;
+}
@@ -0,0 +1,85 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "RenderingTypes.h"
+
+// CPU clustered light assignment
+// the view frustum is split into screen tiles and logarithmic depth slices (froxels)
+// point/spot lights are tested against the froxels 4 at a time, and the result is compacted into per-cluster index lists
+// the list layout is [ClusterCount byte offsets][LightCount, LightIndices...]..., empty clusters share the same zero count entry
+class UHLightCluster
+{
+public:
+	static constexpr uint32_t TileSize = 64;
+	static constexpr uint32_t NumSlices = 24;
+	static constexpr uint32_t MaxLightsPerCluster = 32;
+
+	UHLightCluster();
+
+	// set render resolution, this decides the cluster count and the list buffer size
+	void SetResolution(uint32_t InWidth, uint32_t InHeight);
+
+	// rebuild froxel bounds only when the projection changes, the last slice is unbounded
+	void UpdateGrid(const UHMatrix4x4& InProjection, float InNearPlane, float InFarPlane);
+
+	// assign lights with view-space tests, the index in the input array is stored
+	void AssignPointLights(const std::vector<UHPointLightConstants>& InLights, const UHMatrix4x4& InView);
+	void AssignSpotLights(const std::vector<UHSpotLightConstants>& InLights, const UHMatrix4x4& InView);
+
+	const std::vector<uint32_t>& GetPointLightList() const;
+	const std::vector<uint32_t>& GetSpotLightList() const;
+	size_t GetPointLightListSize() const;
+	size_t GetSpotLightListSize() const;
+
+	// element count needed for the list buffer in worst case
+	uint32_t GetListBufferElementCount() const;
+	uint32_t GetClusterCountX() const;
+	uint32_t GetClusterCountY() const;
+	uint32_t GetClusterCountZ() const;
+	float GetSliceScale() const;
+	float GetSliceBias() const;
+
+private:
+	struct UHClusterLightList
+	{
+		std::vector<uint32_t> Counts;
+		std::vector<uint32_t> Indices;
+		std::vector<uint32_t> Packed;
+		size_t PackedSize = 0;
+	};
+
+	// inclusive froxel range touched by a view space sphere, returns false if it's off-screen
+	bool GetClusterRange(const UHVector3& InCenter, float InRadius, uint32_t OutMin[3], uint32_t OutMax[3]) const;
+	uint32_t GetSlice(float InViewDepth) const;
+	void ResetList(UHClusterLightList& InList);
+	void AddLight(UHClusterLightList& InList, uint32_t InClusterIdx, uint32_t InLightIdx);
+	void PackList(UHClusterLightList& InList);
+
+	uint32_t Width;
+	uint32_t Height;
+	uint32_t ClusterCountX;
+	uint32_t ClusterCountY;
+	uint32_t ClusterCount;
+	float ProjScaleX;
+	float ProjScaleY;
+	float NearPlane;
+	float FarPlane;
+	float SliceScale;
+	float SliceBias;
+	bool bIsGridDirty;
+
+	// froxel bounds in SoA, view space with x right, y down and z as depth
+	std::vector<float> FroxelMinX;
+	std::vector<float> FroxelMinY;
+	std::vector<float> FroxelMinZ;
+	std::vector<float> FroxelMaxX;
+	std::vector<float> FroxelMaxY;
+	std::vector<float> FroxelMaxZ;
+	std::vector<float> FroxelCenterX;
+	std::vector<float> FroxelCenterY;
+	std::vector<float> FroxelCenterZ;
+	std::vector<float> FroxelRadius;
+
+	UHClusterLightList PointLightList;
+	UHClusterLightList SpotLightList;
+};
@@ -1,40 +1,8 @@
 #include "DeferredShadingRenderer.h"
 
-void UHDeferredShadingRenderer::DispatchLightCulling(UHRenderBuilder& RenderBuilder)
-{
-	UHGameTimerScope Scope("DispatchLightCulling", false);
-	UHGPUTimeQueryScope TimeScope(RenderBuilder.GetCmdList(), GPUTimeQueries[UH_ENUM_VALUE(UHRenderPassTypes::LightCulling)], "LightCulling");
-	if (CurrentScene == nullptr || (CurrentScene->GetPointLightCount() == 0 && CurrentScene->GetSpotLightCount() == 0))
-	{
-		return;
-	}
-
-	GraphicInterface->BeginCmdDebug(RenderBuilder.GetCmdList(), "Dispatch Light Culling");
-	{
-		// clear the point light/spot light list buffer
-		RenderBuilder.ClearUAVBuffer(GPointLightListBuffer->GetBuffer(), 0);
-		RenderBuilder.ClearUAVBuffer(GPointLightListTransBuffer->GetBuffer(), 0);
-		RenderBuilder.ClearUAVBuffer(GSpotLightListBuffer->GetBuffer(), 0);
-		RenderBuilder.ClearUAVBuffer(GSpotLightListTransBuffer->GetBuffer(), 0);
-
-		// bind state
-		UHComputeState* State = LightCullingShader->GetComputeState();
-		RenderBuilder.BindComputeState(State);
-
-		// bind sets
-		RenderBuilder.BindDescriptorSetCompute(LightCullingShader->GetPipelineLayout(), LightCullingShader->GetDescriptorSet(CurrentFrameRT));
-
-		// dispatch light culling
-		uint32_t TileCountX, TileCountY;
-		GetLightCullingTileCount(TileCountX, TileCountY);
-		RenderBuilder.Dispatch(TileCountX, TileCountY, 1);
-	}
-	GraphicInterface->EndCmdDebug(RenderBuilder.GetCmdList());
-}
-
 void UHDeferredShadingRenderer::DispatchLightPass(UHRenderBuilder& RenderBuilder)
 {
-	UHGameTimerScope Scope("DispatchLightPass", false);
+	UH_TRACE_SCOPE("DispatchLightPass");
 	UHGPUTimeQueryScope TimeScope(RenderBuilder.GetCmdList(), GPUTimeQueries[UH_ENUM_VALUE(UHRenderPassTypes::LightPass)], "LightPass");
 	if (CurrentScene == nullptr || (CurrentScene->GetDirLightCount() == 0 && CurrentScene->GetPointLightCount() && CurrentScene->GetSpotLightCount()))
 	{
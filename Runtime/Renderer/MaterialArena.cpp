@@ -0,0 +1,258 @@
+#include "MaterialArena.h"
+#include "../Engine/Graphic.h"
+#include "DescriptorHelper.h"
+#include <algorithm>
+
+static uint32_t GetMaterialBlockCount(const UHMaterial* InMat)
+{
+	// always reserve at least a block, so every material has a valid range to bind
+	const uint64_t Size = InMat ? InMat->GetMaterialBufferSize() : 0;
+	return std::max(static_cast<uint32_t>((Size + UHMaterialArena::BlockSize - 1) / UHMaterialArena::BlockSize), 1U);
+}
+
+UHMaterialArena::UHMaterialArena()
+	: TotalBlockCount(0)
+	, MaxBlockCount(0)
+	, GfxCache(nullptr)
+	, SetLayout(nullptr)
+{
+	DescriptorSets.fill(nullptr);
+}
+
+void UHMaterialArena::Release()
+{
+	for (int32_t Idx = 0; Idx < GMaxFrameInFlight; Idx++)
+	{
+		UH_SAFE_RELEASE(ConstantArena[Idx]);
+		ConstantArena[Idx].reset();
+
+		UH_SAFE_RELEASE(RTArena[Idx]);
+		RTArena[Idx].reset();
+	}
+
+	Slots.clear();
+	TotalBlockCount = 0;
+	MaxBlockCount = 0;
+
+	if (GfxCache != nullptr)
+	{
+		if (UHDescriptorAllocator* Allocator = GfxCache->GetDescriptorAllocator())
+		{
+			Allocator->Free(SetLayout, GMaxFrameInFlight, DescriptorSets.data());
+		}
+		SafeDestroyDescriptorSetLayout(GfxCache->GetLogicalDevice(), SetLayout);
+	}
+	DescriptorSets.fill(nullptr);
+}
+
+bool UHMaterialArena::Build(UHGraphic* InGfx, const std::vector<UHMaterial*>& InMaterials)
+{
+	// calculate the layout first, materials are placed by buffer data index
+	GfxCache = InGfx;
+	std::vector<UHMaterialSlot> NewSlots(InMaterials.size());
+	uint32_t NewBlockCount = 0;
+	uint32_t NewMaxBlockCount = 1;
+	for (const UHMaterial* Mat : InMaterials)
+	{
+		const int32_t MatIdx = Mat->GetBufferDataIndex();
+		if (MatIdx < 0 || MatIdx >= static_cast<int32_t>(NewSlots.size()))
+		{
+			continue;
+		}
+
+		NewSlots[MatIdx].BlockOffset = NewBlockCount;
+		NewSlots[MatIdx].BlockCount = GetMaterialBlockCount(Mat);
+		NewBlockCount += NewSlots[MatIdx].BlockCount;
+		NewMaxBlockCount = std::max(NewMaxBlockCount, NewSlots[MatIdx].BlockCount);
+	}
+	NewBlockCount = std::max(NewBlockCount, 1U);
+
+	bool bLayoutChanged = (NewSlots.size() != Slots.size() || NewBlockCount != TotalBlockCount || ConstantArena[0] == nullptr);
+	for (size_t Idx = 0; Idx < NewSlots.size() && !bLayoutChanged; Idx++)
+	{
+		bLayoutChanged = NewSlots[Idx].BlockOffset != Slots[Idx].BlockOffset || NewSlots[Idx].BlockCount != Slots[Idx].BlockCount;
+	}
+
+	if (!bLayoutChanged)
+	{
+		return false;
+	}
+
+	// layout changed, recreate arena buffers and upload all materials
+	// old buffers could still be used by in-flight frames, release them after the frames are done
+	for (int32_t Idx = 0; Idx < GMaxFrameInFlight; Idx++)
+	{
+		UHRenderBuffer<uint8_t>* OldConstantArena = ConstantArena[Idx].release();
+		UHRenderBuffer<UHRTMaterialData>* OldRTArena = RTArena[Idx].release();
+		InGfx->RequestDeferredRelease([OldConstantArena, OldRTArena]()
+			{
+				UH_SAFE_RELEASE(OldConstantArena);
+				UH_SAFE_RELEASE(OldRTArena);
+				delete OldConstantArena;
+				delete OldRTArena;
+			});
+	}
+	Slots = std::move(NewSlots);
+	TotalBlockCount = NewBlockCount;
+	MaxBlockCount = NewMaxBlockCount;
+
+	const size_t RTMaterialCount = std::max(InMaterials.size(), static_cast<size_t>(1));
+	for (int32_t Idx = 0; Idx < GMaxFrameInFlight; Idx++)
+	{
+		// UNIFORM usage pads the uint8_t stride to 256, so one element is one block
+		// the dynamic range is the largest block count, pad the tail so the range of the last material stays in the buffer
+		ConstantArena[Idx] = InGfx->RequestRenderBuffer<uint8_t>(TotalBlockCount + MaxBlockCount - 1, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, "MaterialArena");
+
+		if (InGfx->IsRayTracingEnabled())
+		{
+			RTArena[Idx] = InGfx->RequestRenderBuffer<UHRTMaterialData>(RTMaterialCount, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, "RTMaterialArena");
+		}
+	}
+
+	for (const UHMaterial* Mat : InMaterials)
+	{
+		const int32_t MatIdx = Mat->GetBufferDataIndex();
+		if (MatIdx < 0 || MatIdx >= static_cast<int32_t>(Slots.size()))
+		{
+			continue;
+		}
+
+		for (int32_t Idx = 0; Idx < GMaxFrameInFlight; Idx++)
+		{
+			UploadSlot(Mat, Slots[MatIdx], Idx);
+		}
+	}
+
+	CreateDescriptor();
+	return true;
+}
+
+void UHMaterialArena::Upload(const UHMaterial* InMat, int32_t InFrameIdx)
+{
+	const int32_t MatIdx = InMat->GetBufferDataIndex();
+	if (MatIdx < 0 || MatIdx >= static_cast<int32_t>(Slots.size()) || ConstantArena[InFrameIdx] == nullptr)
+	{
+		return;
+	}
+
+	UHMaterialSlot& Slot = Slots[MatIdx];
+	if (Slot.UploadedVersion[InFrameIdx] == InMat->GetParameterVersion())
+	{
+		return;
+	}
+
+	// the block is grown but the layout isn't rebuilt yet, wait for the next build
+	if (GetMaterialBlockCount(InMat) > Slot.BlockCount)
+	{
+		return;
+	}
+
+	UploadSlot(InMat, Slot, InFrameIdx);
+}
+
+void UHMaterialArena::UploadSlot(const UHMaterial* InMat, UHMaterialSlot& InSlot, int32_t InFrameIdx)
+{
+	// only the range of this material is written
+	const std::vector<uint8_t>& Constants = InMat->GetMaterialConstantsCPU();
+	if (Constants.size() > 0)
+	{
+		ConstantArena[InFrameIdx]->UploadData(const_cast<uint8_t*>(Constants.data()), InSlot.BlockOffset, Constants.size());
+	}
+
+	if (RTArena[InFrameIdx] != nullptr)
+	{
+		RTArena[InFrameIdx]->UploadData(const_cast<UHRTMaterialData*>(&InMat->GetRTMaterialDataCPU()), InMat->GetBufferDataIndex()
+			, sizeof(UHRTMaterialData));
+	}
+
+	InSlot.UploadedVersion[InFrameIdx] = InMat->GetParameterVersion();
+}
+
+void UHMaterialArena::CreateDescriptor()
+{
+	VkDevice LogicalDevice = GfxCache->GetLogicalDevice();
+	VkDescriptorSetLayoutBinding Binding{};
+	Binding.binding = 0;
+	Binding.descriptorCount = 1;
+	Binding.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+	Binding.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+
+	// the layout never changes, create it once
+	if (SetLayout == nullptr)
+	{
+		VkDescriptorSetLayoutCreateInfo LayoutInfo{};
+		LayoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+		LayoutInfo.bindingCount = 1;
+		LayoutInfo.pBindings = &Binding;
+
+		if (vkCreateDescriptorSetLayout(LogicalDevice, &LayoutInfo, nullptr, &SetLayout) != VK_SUCCESS)
+		{
+			UHE_LOG("Failed to create material arena set layout!\n");
+			return;
+		}
+
+#if WITH_EDITOR
+		GfxCache->SetDebugUtilsObjectName(VK_OBJECT_TYPE_DESCRIPTOR_SET_LAYOUT, (uint64_t)SetLayout, "MaterialArena_DescriptorSetLayout");
+#endif
+	}
+
+	// in-flight frames could still use the old sets, the allocator only reuses them after the frames are done
+	UHDescriptorAllocator* Allocator = GfxCache->GetDescriptorAllocator();
+	Allocator->Free(SetLayout, GMaxFrameInFlight, DescriptorSets.data());
+	if (!Allocator->Allocate(SetLayout, { Binding }, GMaxFrameInFlight, DescriptorSets.data()))
+	{
+		UHE_LOG("Failed to allocate material arena sets!\n");
+		return;
+	}
+
+	for (int32_t Idx = 0; Idx < GMaxFrameInFlight; Idx++)
+	{
+		UHDescriptorHelper Helper(LogicalDevice, DescriptorSets[Idx]);
+		Helper.WriteDynamicConstantBuffer(ConstantArena[Idx].get(), 0, MaxBlockCount);
+	}
+}
+
+UHRenderBuffer<uint8_t>* UHMaterialArena::GetConstantArena(int32_t InFrameIdx) const
+{
+	return ConstantArena[InFrameIdx].get();
+}
+
+UHRenderBuffer<UHRTMaterialData>* UHMaterialArena::GetRTArena(int32_t InFrameIdx) const
+{
+	return RTArena[InFrameIdx].get();
+}
+
+uint32_t UHMaterialArena::GetBlockOffset(int32_t InMatIdx) const
+{
+	if (InMatIdx < 0 || InMatIdx >= static_cast<int32_t>(Slots.size()))
+	{
+		return 0;
+	}
+
+	return Slots[InMatIdx].BlockOffset;
+}
+
+uint32_t UHMaterialArena::GetBlockCount(int32_t InMatIdx) const
+{
+	if (InMatIdx < 0 || InMatIdx >= static_cast<int32_t>(Slots.size()))
+	{
+		return 1;
+	}
+
+	return Slots[InMatIdx].BlockCount;
+}
+
+VkDescriptorSetLayout UHMaterialArena::GetDescriptorSetLayout() const
+{
+	return SetLayout;
+}
+
+VkDescriptorSet UHMaterialArena::GetDescriptorSet(int32_t InFrameIdx) const
+{
+	return DescriptorSets[InFrameIdx];
+}
+
+uint32_t UHMaterialArena::GetDynamicOffset(int32_t InMatIdx) const
+{
+	return GetBlockOffset(InMatIdx) * BlockSize;
+}
@@ -0,0 +1,63 @@
+#pragma once
+#include <array>
+#include <vector>
+#include "RenderingTypes.h"
+#include "../Classes/RenderBuffer.h"
+#include "../Classes/Material.h"
+
+class UHGraphic;
+
+// UH material arena, all material parameter blocks are packed into one buffer per frame
+// each material owns a 256-byte aligned range indexed by its buffer data index
+// ranges are versioned, only the materials whose parameters are changed will be uploaded
+// all material shaders share one set layout and one set per frame, the block of a material is selected by the dynamic offset
+class UHMaterialArena
+{
+public:
+	static constexpr uint32_t BlockSize = 256;
+
+	UHMaterialArena();
+	void Release();
+
+	// rebuild arena layout from materials, returns true if the buffers are recreated
+	// the arena set is rewritten here, but the RT arena still needs rebinding by the caller
+	bool Build(UHGraphic* InGfx, const std::vector<UHMaterial*>& InMaterials);
+
+	// upload material blocks to the arena of the frame if its version is out of date
+	void Upload(const UHMaterial* InMat, int32_t InFrameIdx);
+
+	UHRenderBuffer<uint8_t>* GetConstantArena(int32_t InFrameIdx) const;
+	UHRenderBuffer<UHRTMaterialData>* GetRTArena(int32_t InFrameIdx) const;
+
+	// offset and count are in blocks, which is also the element of constant arena
+	uint32_t GetBlockOffset(int32_t InMatIdx) const;
+	uint32_t GetBlockCount(int32_t InMatIdx) const;
+
+	// the set has a single dynamic constant buffer at binding 0, visible in pixel shader
+	VkDescriptorSetLayout GetDescriptorSetLayout() const;
+	VkDescriptorSet GetDescriptorSet(int32_t InFrameIdx) const;
+
+	// byte offset of the material block, used as the dynamic offset when binding the set
+	uint32_t GetDynamicOffset(int32_t InMatIdx) const;
+
+private:
+	struct UHMaterialSlot
+	{
+		uint32_t BlockOffset = 0;
+		uint32_t BlockCount = 0;
+		std::array<uint32_t, GMaxFrameInFlight> UploadedVersion = {};
+	};
+
+	void UploadSlot(const UHMaterial* InMat, UHMaterialSlot& InSlot, int32_t InFrameIdx);
+	void CreateDescriptor();
+
+	std::vector<UHMaterialSlot> Slots;
+	std::array<UniquePtr<UHRenderBuffer<uint8_t>>, GMaxFrameInFlight> ConstantArena;
+	std::array<UniquePtr<UHRenderBuffer<UHRTMaterialData>>, GMaxFrameInFlight> RTArena;
+	uint32_t TotalBlockCount;
+	uint32_t MaxBlockCount;
+
+	UHGraphic* GfxCache;
+	VkDescriptorSetLayout SetLayout;
+	std::array<VkDescriptorSet, GMaxFrameInFlight> DescriptorSets;
+};
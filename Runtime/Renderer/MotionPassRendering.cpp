@@ -28,7 +28,7 @@ private:
 
 void UHDeferredShadingRenderer::RenderMotionPass(UHRenderBuilder& RenderBuilder)
 {
-	UHGameTimerScope Scope("RenderMotionPass", false);
+	UH_TRACE_SCOPE("RenderMotionPass");
 	if (CurrentScene == nullptr)
 	{
 		return;
@@ -76,26 +76,26 @@ void UHDeferredShadingRenderer::RenderMotionPass(UHRenderBuilder& RenderBuilder)
 				RenderBuilder.BeginRenderPass(MotionOpaquePassObj, RenderResolution);
 
 				// bindless table, they should only be bound once
-				if (MotionMeshShaders.size() > 0 && SortedMeshShaderGroupIndex.size() > 0)
+				if (MotionMeshShaders.size() > 0 && SortedMeshShaderGroupIndex[CurrentFrameRT].size() > 0)
 				{
 					std::vector<VkDescriptorSet> BindlessTableSets = { TextureTable->GetDescriptorSet(CurrentFrameRT)
 						, SamplerTable->GetDescriptorSet(CurrentFrameRT)
 						, MeshletTable->GetDescriptorSet(CurrentFrameRT)
 						, PositionTable->GetDescriptorSet(CurrentFrameRT)
 						, UV0Table->GetDescriptorSet(CurrentFrameRT)
-						, IndicesTable->GetDescriptorSet(CurrentFrameRT)
+						, MeshletDataTable->GetDescriptorSet(CurrentFrameRT)
 						, NormalTable->GetDescriptorSet(CurrentFrameRT)
 						, TangentTable->GetDescriptorSet(CurrentFrameRT)
 					};
-					RenderBuilder.BindDescriptorSet(MotionMeshShaders[SortedMeshShaderGroupIndex[0]]->GetPipelineLayout(), BindlessTableSets, GTextureTableSpace);
+					RenderBuilder.BindDescriptorSet(MotionMeshShaders[SortedMeshShaderGroupIndex[CurrentFrameRT][0]]->GetPipelineLayout(), BindlessTableSets, GTextureTableSpace);
 				}
 
 				// dispatch mesh based on the MotionObjectMeshShaderData
-				for (size_t Idx = 0; Idx < SortedMeshShaderGroupIndex.size(); Idx++)
+				for (size_t Idx = 0; Idx < SortedMeshShaderGroupIndex[CurrentFrameRT].size(); Idx++)
 				{
-					const int32_t GroupIndex = SortedMeshShaderGroupIndex[Idx];
-					const uint32_t VisibleMeshlets = static_cast<uint32_t>(MotionOpaqueMeshShaderData[GroupIndex].size());
-					if (VisibleMeshlets == 0)
+					const int32_t GroupIndex = SortedMeshShaderGroupIndex[CurrentFrameRT][Idx];
+					const uint32_t VisibleInstances = static_cast<uint32_t>(MotionOpaqueMeshShaderData[CurrentFrameRT][GroupIndex].size());
+					if (VisibleInstances == 0)
 					{
 						continue;
 					}
@@ -110,9 +110,15 @@ void UHDeferredShadingRenderer::RenderMotionPass(UHRenderBuilder& RenderBuilder)
 
 					RenderBuilder.BindGraphicState(MotionMS->GetState());
 					RenderBuilder.BindDescriptorSet(MotionMS->GetPipelineLayout(), MotionMS->GetDescriptorSet(CurrentFrameRT));
+					RenderBuilder.BindMaterialArena(MotionMS, CurrentFrameRT);
 
-					// Dispatch meshlets
-					RenderBuilder.DispatchMesh(VisibleMeshlets, 1, 1);
+					// Dispatch meshlets, amplification shader expands instances to meshlets and culls them
+					UHMeshShaderConstants Constants;
+					Constants.InstanceCount = VisibleInstances;
+					Constants.MeshletCount = GetMeshShaderMeshletCount(MotionOpaqueMeshShaderData[CurrentFrameRT][GroupIndex]);
+					Constants.bEnableHiZ = bIsHiZValid ? 1 : 0;
+					RenderBuilder.PushConstant(MotionMS->GetPipelineLayout(), VK_SHADER_STAGE_TASK_BIT_EXT, sizeof(UHMeshShaderConstants), &Constants);
+					RenderBuilder.DispatchMesh(UHMathHelpers::RoundUpDivide(Constants.MeshletCount, GAmplificationGroupSize), 1, 1);
 
 					GraphicInterface->EndCmdDebug(RenderBuilder.GetCmdList());
 				}
@@ -122,12 +128,10 @@ void UHDeferredShadingRenderer::RenderMotionPass(UHRenderBuilder& RenderBuilder)
 				// begin for secondary cmd
 				RenderBuilder.BeginRenderPass(MotionOpaquePassObj, RenderResolution, VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);
 
-#if WITH_EDITOR
 				for (int32_t I = 0; I < NumParallelRenderSubmitters; I++)
 				{
 					ThreadDrawCalls[I] = 0;
 				}
-#endif
 
 				// init and wake all tasks
 				for (int32_t I = 0; I < NumParallelRenderSubmitters; I++)
@@ -142,12 +146,10 @@ void UHDeferredShadingRenderer::RenderMotionPass(UHRenderBuilder& RenderBuilder)
 					WorkerThreads[I]->WaitTask();
 				}
 
-#if WITH_EDITOR
 				for (int32_t I = 0; I < NumParallelRenderSubmitters; I++)
 				{
 					RenderBuilder.DrawCalls += ThreadDrawCalls[I];
 				}
-#endif
 
 				// execute all recorded batches
 				RenderBuilder.ExecuteBundles(MotionOpaqueParallelSubmitter);
@@ -166,26 +168,26 @@ void UHDeferredShadingRenderer::RenderMotionPass(UHRenderBuilder& RenderBuilder)
 				RenderBuilder.BeginRenderPass(MotionTranslucentPassObj, RenderResolution);
 
 				// bindless table, they should only be bound once
-				if (MotionMeshShaders.size() > 0 && SortedMeshShaderGroupIndex.size() > 0)
+				if (MotionMeshShaders.size() > 0 && SortedMeshShaderGroupIndex[CurrentFrameRT].size() > 0)
 				{
 					std::vector<VkDescriptorSet> BindlessTableSets = { TextureTable->GetDescriptorSet(CurrentFrameRT)
 						, SamplerTable->GetDescriptorSet(CurrentFrameRT)
 						, MeshletTable->GetDescriptorSet(CurrentFrameRT)
 						, PositionTable->GetDescriptorSet(CurrentFrameRT)
 						, UV0Table->GetDescriptorSet(CurrentFrameRT)
-						, IndicesTable->GetDescriptorSet(CurrentFrameRT)
+						, MeshletDataTable->GetDescriptorSet(CurrentFrameRT)
 						, NormalTable->GetDescriptorSet(CurrentFrameRT)
 						, TangentTable->GetDescriptorSet(CurrentFrameRT)
 					};
-					RenderBuilder.BindDescriptorSet(MotionMeshShaders[SortedMeshShaderGroupIndex[0]]->GetPipelineLayout(), BindlessTableSets, GTextureTableSpace);
+					RenderBuilder.BindDescriptorSet(MotionMeshShaders[SortedMeshShaderGroupIndex[CurrentFrameRT][0]]->GetPipelineLayout(), BindlessTableSets, GTextureTableSpace);
 				}
 
 				// dispatch mesh based on the MotionObjectMeshShaderData
-				for (size_t Idx = 0; Idx < SortedMeshShaderGroupIndex.size(); Idx++)
+				for (size_t Idx = 0; Idx < SortedMeshShaderGroupIndex[CurrentFrameRT].size(); Idx++)
 				{
-					const int32_t GroupIndex = SortedMeshShaderGroupIndex[Idx];
-					const uint32_t VisibleMeshlets = static_cast<uint32_t>(MotionTranslucentMeshShaderData[GroupIndex].size());
-					if (VisibleMeshlets == 0)
+					const int32_t GroupIndex = SortedMeshShaderGroupIndex[CurrentFrameRT][Idx];
+					const uint32_t VisibleInstances = static_cast<uint32_t>(MotionTranslucentMeshShaderData[CurrentFrameRT][GroupIndex].size());
+					if (VisibleInstances == 0)
 					{
 						continue;
 					}
@@ -200,9 +202,15 @@ void UHDeferredShadingRenderer::RenderMotionPass(UHRenderBuilder& RenderBuilder)
 
 					RenderBuilder.BindGraphicState(MotionMS->GetState());
 					RenderBuilder.BindDescriptorSet(MotionMS->GetPipelineLayout(), MotionMS->GetDescriptorSet(CurrentFrameRT));
+					RenderBuilder.BindMaterialArena(MotionMS, CurrentFrameRT);
 
-					// Dispatch meshlets
-					RenderBuilder.DispatchMesh(VisibleMeshlets, 1, 1);
+					// Dispatch meshlets, amplification shader expands instances to meshlets and culls them
+					UHMeshShaderConstants Constants;
+					Constants.InstanceCount = VisibleInstances;
+					Constants.MeshletCount = GetMeshShaderMeshletCount(MotionTranslucentMeshShaderData[CurrentFrameRT][GroupIndex]);
+					Constants.bEnableHiZ = bIsHiZValid ? 1 : 0;
+					RenderBuilder.PushConstant(MotionMS->GetPipelineLayout(), VK_SHADER_STAGE_TASK_BIT_EXT, sizeof(UHMeshShaderConstants), &Constants);
+					RenderBuilder.DispatchMesh(UHMathHelpers::RoundUpDivide(Constants.MeshletCount, GAmplificationGroupSize), 1, 1);
 
 					GraphicInterface->EndCmdDebug(RenderBuilder.GetCmdList());
 				}
@@ -212,12 +220,10 @@ void UHDeferredShadingRenderer::RenderMotionPass(UHRenderBuilder& RenderBuilder)
 
 				RenderBuilder.BeginRenderPass(MotionTranslucentPassObj, RenderResolution, VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);
 
-#if WITH_EDITOR
 				for (int32_t I = 0; I < NumParallelRenderSubmitters; I++)
 				{
 					ThreadDrawCalls[I] = 0;
 				}
-#endif
 
 				// wake all worker threads
 				for (int32_t I = 0; I < NumParallelRenderSubmitters; I++)
@@ -232,12 +238,10 @@ void UHDeferredShadingRenderer::RenderMotionPass(UHRenderBuilder& RenderBuilder)
 					WorkerThreads[I]->WaitTask();
 				}
 
-#if WITH_EDITOR
 				for (int32_t I = 0; I < NumParallelRenderSubmitters; I++)
 				{
 					RenderBuilder.DrawCalls += ThreadDrawCalls[I];
 				}
-#endif
 
 				// execute all recorded batches
 				RenderBuilder.ExecuteBundles(MotionTranslucentParallelSubmitter);
@@ -261,7 +265,7 @@ void UHDeferredShadingRenderer::RenderMotionPass(UHRenderBuilder& RenderBuilder)
 void UHDeferredShadingRenderer::MotionOpaqueTask(int32_t ThreadIdx)
 {
 	// simply separate buffer recording into N threads
-	const int32_t MaxCount = static_cast<int32_t>(MotionOpaquesToRender.size());
+	const int32_t MaxCount = static_cast<int32_t>(MotionOpaquesToRender[CurrentFrameRT].size());
 	const int32_t RendererCount = (MaxCount + NumParallelRenderSubmitters) / NumParallelRenderSubmitters;
 	const int32_t StartIdx = std::min(RendererCount * ThreadIdx, MaxCount);
 	const int32_t EndIdx = (ThreadIdx == NumParallelRenderSubmitters - 1) ? MaxCount : std::min(StartIdx + RendererCount, MaxCount);
@@ -294,7 +298,7 @@ void UHDeferredShadingRenderer::MotionOpaqueTask(int32_t ThreadIdx)
 	const uint32_t PrevFrame = (CurrentFrameRT - 1) % GMaxFrameInFlight;
 	for (int32_t I = StartIdx; I < EndIdx; I++)
 	{
-		UHMeshRendererComponent* Renderer = MotionOpaquesToRender[I];
+		UHMeshRendererComponent* Renderer = MotionOpaquesToRender[CurrentFrameRT][I];
 		const UHMaterial* Mat = Renderer->GetMaterial();
 
 		UHMesh* Mesh = Renderer->GetMesh();
@@ -318,9 +322,10 @@ void UHDeferredShadingRenderer::MotionOpaqueTask(int32_t ThreadIdx)
 		RenderBuilder.BindVertexBuffer(Mesh->GetPositionBuffer()->GetBuffer());
 		RenderBuilder.BindIndexBuffer(Mesh);
 		RenderBuilder.BindDescriptorSet(MotionShader->GetPipelineLayout(), MotionShader->GetDescriptorSet(CurrentFrameRT));
+		RenderBuilder.BindMaterialArena(MotionShader, CurrentFrameRT);
 
 		// draw call
-		RenderBuilder.DrawIndexed(Mesh->GetIndicesCount());
+		RenderBuilder.DrawIndexed(Mesh->GetIndicesCount(), RendererIdx);
 		if (bOcclusionTest)
 		{
 			RenderBuilder.EndPredication();
@@ -331,15 +336,13 @@ void UHDeferredShadingRenderer::MotionOpaqueTask(int32_t ThreadIdx)
 
 	RenderBuilder.EndCommandBuffer();
 
-#if WITH_EDITOR
 	ThreadDrawCalls[ThreadIdx] += RenderBuilder.DrawCalls;
-#endif
 }
 
 void UHDeferredShadingRenderer::MotionTranslucentTask(int32_t ThreadIdx)
 {
 	// simply separate buffer recording into N threads
-	const int32_t MaxCount = static_cast<int32_t>(TranslucentsToRender.size());
+	const int32_t MaxCount = static_cast<int32_t>(TranslucentsToRender[CurrentFrameRT].size());
 	const int32_t RendererCount = (MaxCount + NumParallelRenderSubmitters) / NumParallelRenderSubmitters;
 
 	// to collect batch reversely
@@ -377,7 +380,7 @@ void UHDeferredShadingRenderer::MotionTranslucentTask(int32_t ThreadIdx)
 	const uint32_t PrevFrame = (CurrentFrameRT - 1) % GMaxFrameInFlight;
 	for (int32_t I = EndIdx - 1; I >= StartIdx; I--)
 	{
-		UHMeshRendererComponent* Renderer = TranslucentsToRender[I];
+		UHMeshRendererComponent* Renderer = TranslucentsToRender[CurrentFrameRT][I];
 		const UHMaterial* Mat = Renderer->GetMaterial();
 
 		UHMesh* Mesh = Renderer->GetMesh();
@@ -401,9 +404,10 @@ void UHDeferredShadingRenderer::MotionTranslucentTask(int32_t ThreadIdx)
 		RenderBuilder.BindVertexBuffer(Mesh->GetPositionBuffer()->GetBuffer());
 		RenderBuilder.BindIndexBuffer(Mesh);
 		RenderBuilder.BindDescriptorSet(MotionShader->GetPipelineLayout(), MotionShader->GetDescriptorSet(CurrentFrameRT));
+		RenderBuilder.BindMaterialArena(MotionShader, CurrentFrameRT);
 
 		// draw call
-		RenderBuilder.DrawIndexed(Mesh->GetIndicesCount());
+		RenderBuilder.DrawIndexed(Mesh->GetIndicesCount(), RendererIdx);
 		if (bOcclusionTest)
 		{
 			RenderBuilder.EndPredication();
@@ -414,7 +418,5 @@ void UHDeferredShadingRenderer::MotionTranslucentTask(int32_t ThreadIdx)
 
 	RenderBuilder.EndCommandBuffer();
 
-#if WITH_EDITOR
 	ThreadDrawCalls[ThreadIdx] += RenderBuilder.DrawCalls;
-#endif
 }
\ No newline at end of file
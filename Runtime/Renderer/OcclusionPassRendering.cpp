@@ -19,7 +19,7 @@ private:
 
 void UHDeferredShadingRenderer::ResolveOcclusionResult(UHRenderBuilder& RenderBuilder)
 {
-	UHGameTimerScope Scope("ResolveOcclusionResult", false);
+	UH_TRACE_SCOPE("ResolveOcclusionResult");
 	UHGPUTimeQueryScope TimeScope(RenderBuilder.GetCmdList(), GPUTimeQueries[UH_ENUM_VALUE(UHRenderPassTypes::OcclusionResolve)], "ResolveOcclusionResult");
 
 	// Resolve the previous frame result to the buffer. 
@@ -44,7 +44,7 @@ void UHDeferredShadingRenderer::ResolveOcclusionResult(UHRenderBuilder& RenderBu
 
 void UHDeferredShadingRenderer::RenderOcclusionPass(UHRenderBuilder& RenderBuilder)
 {
-	UHGameTimerScope Scope("RenderOcclusionPass", false);
+	UH_TRACE_SCOPE("RenderOcclusionPass");
 	UHGPUTimeQueryScope TimeScope(RenderBuilder.GetCmdList(), GPUTimeQueries[UH_ENUM_VALUE(UHRenderPassTypes::OcclusionPass)], "OcclusionPass");
 	if (CurrentScene == nullptr || !RTParams.bEnableOcclusionQuery)
 	{
@@ -57,12 +57,10 @@ void UHDeferredShadingRenderer::RenderOcclusionPass(UHRenderBuilder& RenderBuild
 		RenderBuilder.ResetGPUQuery(OcclusionQuery[CurrentFrameRT]);
 		RenderBuilder.BeginRenderPass(OcclusionPassObj, RenderResolution, VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);
 
-#if WITH_EDITOR
 		for (int32_t I = 0; I < NumParallelRenderSubmitters; I++)
 		{
 			ThreadOccludedCalls[I] = 0;
 		}
-#endif
 
 		// init and wake all tasks
 		static std::vector<UHOcclusionPassAsyncTask> Tasks(NumParallelRenderSubmitters);
@@ -78,12 +76,10 @@ void UHDeferredShadingRenderer::RenderOcclusionPass(UHRenderBuilder& RenderBuild
 			WorkerThreads[I]->WaitTask();
 		}
 
-#if WITH_EDITOR
 		for (int32_t I = 0; I < NumParallelRenderSubmitters; I++)
 		{
 			RenderBuilder.OccludedCalls += ThreadOccludedCalls[I];
 		}
-#endif
 
 		// execute all recorded batches
 		RenderBuilder.ExecuteBundles(OcclusionParallelSubmitter);
@@ -95,7 +91,7 @@ void UHDeferredShadingRenderer::RenderOcclusionPass(UHRenderBuilder& RenderBuild
 void UHDeferredShadingRenderer::OcclusionPassTask(int32_t ThreadIdx)
 {
 	// simply separate buffer recording into N threads
-	const int32_t MaxCount = static_cast<int32_t>(OcclusionRenderers.size());
+	const int32_t MaxCount = static_cast<int32_t>(OcclusionRenderers[CurrentFrameRT].size());
 	const int32_t RendererCount = (MaxCount + NumParallelRenderSubmitters) / NumParallelRenderSubmitters;
 	const int32_t StartIdx = std::min(RendererCount * ThreadIdx, MaxCount);
 	const int32_t EndIdx = (ThreadIdx == NumParallelRenderSubmitters - 1) ? MaxCount : std::min(StartIdx + RendererCount, MaxCount);
@@ -120,7 +116,7 @@ void UHDeferredShadingRenderer::OcclusionPassTask(int32_t ThreadIdx)
 
 	for (int32_t I = StartIdx; I < EndIdx; I++)
 	{
-		const UHMeshRendererComponent* Renderer = OcclusionRenderers[I];
+		const UHMeshRendererComponent* Renderer = OcclusionRenderers[CurrentFrameRT][I];
 		const int32_t RendererIdx = Renderer->GetBufferDataIndex();
 		const UHOcclusionPassShader* OcclusionShader = OcclusionPassShaders[RendererIdx].get();
 
@@ -135,7 +131,7 @@ void UHDeferredShadingRenderer::OcclusionPassTask(int32_t ThreadIdx)
 		RenderBuilder.BindDescriptorSet(OcclusionShader->GetPipelineLayout(), OcclusionShader->GetDescriptorSet(CurrentFrameRT));
 
 		// draw call
-		RenderBuilder.DrawIndexed(CubeMesh->GetIndicesCount());
+		RenderBuilder.DrawIndexed(CubeMesh->GetIndicesCount(), RendererIdx);
 		RenderBuilder.EndOcclusionQuery(OcclusionQuery[CurrentFrameRT], RendererIdx);
 
 		GraphicInterface->EndCmdDebug(RenderBuilder.GetCmdList());
@@ -143,7 +139,61 @@ void UHDeferredShadingRenderer::OcclusionPassTask(int32_t ThreadIdx)
 
 	RenderBuilder.EndCommandBuffer();
 
-#if WITH_EDITOR
 	ThreadOccludedCalls[ThreadIdx] += RenderBuilder.DrawCalls;
-#endif
-}
\ No newline at end of file
+}
+void UHDeferredShadingRenderer::GenerateHiZPass(UHRenderBuilder& RenderBuilder)
+{
+	UH_TRACE_SCOPE("GenerateHiZPass");
+	UHGPUTimeQueryScope TimeScope(RenderBuilder.GetCmdList(), GPUTimeQueries[UH_ENUM_VALUE(UHRenderPassTypes::HiZPass)], "HiZPass");
+	if (CurrentScene == nullptr || GHiZBuffer == nullptr)
+	{
+		return;
+	}
+
+	GraphicInterface->BeginCmdDebug(RenderBuilder.GetCmdList(), "Generate Hi-Z");
+	{
+		RenderBuilder.BindComputeState(HiZShader->GetComputeState());
+		const uint32_t MipCount = GHiZBuffer->GetMipMapCount();
+		const VkExtent2D HiZExtent = GHiZBuffer->GetExtent();
+		const VkPipelineStageFlags ReadStages = VK_PIPELINE_STAGE_TASK_SHADER_BIT_EXT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+
+		// the previous content is discarded, but it must wait the amplification shader reads
+		RenderBuilder.ResourceBarrier(GHiZBuffer, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_GENERAL
+			, ReadStages, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, MipCount);
+
+		VkExtent2D InputExtent = RenderResolution;
+		for (uint32_t Mdx = 0; Mdx < MipCount; Mdx++)
+		{
+			VkExtent2D MipExtent;
+			MipExtent.width = std::max(HiZExtent.width >> Mdx, 1u);
+			MipExtent.height = std::max(HiZExtent.height >> Mdx, 1u);
+
+			UHHiZConstants Constant;
+			Constant.InputWidth = InputExtent.width;
+			Constant.InputHeight = InputExtent.height;
+			Constant.OutputWidth = MipExtent.width;
+			Constant.OutputHeight = MipExtent.height;
+			Constant.bFromSceneDepth = (Mdx == 0) ? 1 : 0;
+
+			// wait the previous mip to be written
+			if (Mdx > 0)
+			{
+				RenderBuilder.ResourceBarrier(GHiZBuffer, VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_LAYOUT_GENERAL
+					, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, Mdx - 1, 1);
+			}
+
+			// push constant and descriptor in fly
+			RenderBuilder.PushConstant(HiZShader->GetPipelineLayout(), VK_SHADER_STAGE_COMPUTE_BIT, sizeof(UHHiZConstants), &Constant);
+			HiZShader->BindTextures(RenderBuilder, GSceneDepth, GHiZBuffer, Mdx);
+			RenderBuilder.Dispatch(UHMathHelpers::RoundUpDivide(MipExtent.width, GThreadGroup2D_X), UHMathHelpers::RoundUpDivide(MipExtent.height, GThreadGroup2D_Y), 1);
+
+			InputExtent = MipExtent;
+		}
+
+		// Hi-Z is read by amplification shader in the next frame
+		RenderBuilder.ResourceBarrier(GHiZBuffer, VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL
+			, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, ReadStages, 0, MipCount);
+		bIsHiZValid = true;
+	}
+	GraphicInterface->EndCmdDebug(RenderBuilder.GetCmdList());
+}
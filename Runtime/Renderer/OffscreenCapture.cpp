@@ -0,0 +1,452 @@
+#include "OffscreenCapture.h"
+#include "RenderBuilder.h"
+#include "../Engine/Graphic.h"
+#include <array>
+#include <fstream>
+#include <cstdio>
+
+#if __linux__
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+// crc32 of png chunks, table built on first use
+static uint32_t UpdateCrc32(uint32_t InCrc, const uint8_t* InData, size_t InSize)
+{
+	static const std::array<uint32_t, 256> CrcTable = []()
+		{
+			std::array<uint32_t, 256> Table{};
+			for (uint32_t Idx = 0; Idx < 256; Idx++)
+			{
+				uint32_t Value = Idx;
+				for (int32_t Jdx = 0; Jdx < 8; Jdx++)
+				{
+					Value = (Value & 1) ? 0xEDB88320u ^ (Value >> 1) : Value >> 1;
+				}
+				Table[Idx] = Value;
+			}
+			return Table;
+		}();
+
+	uint32_t Crc = ~InCrc;
+	for (size_t Idx = 0; Idx < InSize; Idx++)
+	{
+		Crc = CrcTable[(Crc ^ InData[Idx]) & 0xFF] ^ (Crc >> 8);
+	}
+	return ~Crc;
+}
+
+static uint32_t Adler32(const uint8_t* InData, size_t InSize)
+{
+	// 5552 is the max byte count before the sums need the modulo
+	uint32_t A = 1;
+	uint32_t B = 0;
+	while (InSize > 0)
+	{
+		const size_t BlockSize = std::min<size_t>(InSize, 5552);
+		for (size_t Idx = 0; Idx < BlockSize; Idx++)
+		{
+			A += InData[Idx];
+			B += A;
+		}
+		A %= 65521;
+		B %= 65521;
+		InData += BlockSize;
+		InSize -= BlockSize;
+	}
+	return (B << 16) | A;
+}
+
+static void PushBigEndian(std::vector<uint8_t>& OutData, uint32_t InValue)
+{
+	OutData.push_back(static_cast<uint8_t>(InValue >> 24));
+	OutData.push_back(static_cast<uint8_t>(InValue >> 16));
+	OutData.push_back(static_cast<uint8_t>(InValue >> 8));
+	OutData.push_back(static_cast<uint8_t>(InValue));
+}
+
+static void WritePNGChunk(std::ofstream& FileOut, const char* InType, const uint8_t* InData, uint32_t InSize)
+{
+	std::vector<uint8_t> Header;
+	PushBigEndian(Header, InSize);
+	Header.insert(Header.end(), InType, InType + 4);
+	FileOut.write(reinterpret_cast<const char*>(Header.data()), Header.size());
+	FileOut.write(reinterpret_cast<const char*>(InData), InSize);
+
+	uint32_t Crc = UpdateCrc32(0, reinterpret_cast<const uint8_t*>(InType), 4);
+	Crc = UpdateCrc32(Crc, InData, InSize);
+
+	std::vector<uint8_t> CrcData;
+	PushBigEndian(CrcData, Crc);
+	FileOut.write(reinterpret_cast<const char*>(CrcData.data()), CrcData.size());
+}
+
+UHOffscreenCapture::UHOffscreenCapture()
+	: Extent(VkExtent2D{})
+	, RecordedSlot(UHINDEXNONE)
+	, FrameCounter(0)
+	, bIsWriting(false)
+	, bIsTerminating(false)
+	, CapturedCount(0)
+	, DroppedCount(0)
+	, SharedFrame(nullptr)
+	, SharedMemorySize(0)
+{
+
+}
+
+UHOffscreenCapture::~UHOffscreenCapture()
+{
+	Release();
+}
+
+bool UHOffscreenCapture::Initialize(const UHOffscreenCaptureSettings& InSettings, VkExtent2D InExtent)
+{
+	Settings = InSettings;
+	Extent = InExtent;
+
+	if (Settings.Output == UHCaptureOutput::Raw || Settings.Output == UHCaptureOutput::PNG)
+	{
+		std::error_code ErrorCode;
+		std::filesystem::create_directories(Settings.OutputDir, ErrorCode);
+		if (!std::filesystem::exists(Settings.OutputDir))
+		{
+			UHE_LOG("Failed to create capture directory " + Settings.OutputDir.generic_string() + "!\n");
+			return false;
+		}
+	}
+	else if (Settings.Output == UHCaptureOutput::SharedMemory && !CreateSharedMemory())
+	{
+		return false;
+	}
+
+	// the readback buffers are host-visible, the writer maps them after the frame is done
+	const uint64_t FrameSize = static_cast<uint64_t>(Extent.width) * Extent.height * 4;
+	Settings.RingSize = std::max(Settings.RingSize, 1u);
+	ReadbackBuffers = std::vector<UHRenderBuffer<uint8_t>>(Settings.RingSize);
+	for (uint32_t Idx = 0; Idx < Settings.RingSize; Idx++)
+	{
+		ReadbackBuffers[Idx].SetGfxCache(GfxCache);
+		if (!ReadbackBuffers[Idx].CreateBuffer(FrameSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT))
+		{
+			UHE_LOG("Failed to create capture readback buffers!\n");
+			return false;
+		}
+#if WITH_EDITOR
+		GfxCache->SetDebugUtilsObjectName(VK_OBJECT_TYPE_BUFFER, (uint64_t)ReadbackBuffers[Idx].GetBuffer()
+			, "CaptureReadback" + std::to_string(Idx));
+#endif
+		FreeSlots.push_back(Idx);
+	}
+
+	bIsTerminating = false;
+	WriterThread = std::thread(&UHOffscreenCapture::WriterLoop, this);
+	return true;
+}
+
+void UHOffscreenCapture::Release()
+{
+	if (WriterThread.joinable())
+	{
+		Flush();
+		{
+			std::unique_lock<std::mutex> Lock(QueueLock);
+			bIsTerminating = true;
+		}
+		QueueNotify.notify_one();
+		WriterThread.join();
+	}
+
+	for (UHRenderBuffer<uint8_t>& Buffer : ReadbackBuffers)
+	{
+		Buffer.Release();
+	}
+	ReadbackBuffers.clear();
+	FreeSlots.clear();
+	PendingFrames.clear();
+	RecordedSlot = UHINDEXNONE;
+
+	ReleaseSharedMemory();
+}
+
+bool UHOffscreenCapture::RecordReadback(UHRenderBuilder& RenderBuilder, UHRenderTexture* InTarget)
+{
+	// dropped frames still count, so the gaps are visible in file names
+	FrameCounter++;
+	RecordedSlot = UHINDEXNONE;
+
+	const VkExtent2D TargetExtent = InTarget->GetExtent();
+	if (TargetExtent.width != Extent.width || TargetExtent.height != Extent.height)
+	{
+		// the readback buffers are sized at initialization, don't capture after resizing
+		DroppedCount++;
+		return false;
+	}
+
+	{
+		std::unique_lock<std::mutex> Lock(QueueLock);
+		if (FreeSlots.empty())
+		{
+			// the writer hasn't caught up, drop this frame instead of stalling the render thread
+			DroppedCount++;
+			return false;
+		}
+
+		RecordedSlot = static_cast<int32_t>(FreeSlots.back());
+		FreeSlots.pop_back();
+	}
+
+	VkBufferImageCopy Region{};
+	Region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+	Region.imageSubresource.mipLevel = 0;
+	Region.imageSubresource.baseArrayLayer = 0;
+	Region.imageSubresource.layerCount = 1;
+	Region.imageOffset = { 0, 0, 0 };
+	Region.imageExtent = { Extent.width, Extent.height, 1 };
+
+	UHRenderBuffer<uint8_t>& Buffer = ReadbackBuffers[RecordedSlot];
+	RenderBuilder.ResourceBarrier(InTarget, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL);
+	vkCmdCopyImageToBuffer(RenderBuilder.GetCmdList(), InTarget->GetImage(), VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, Buffer.GetBuffer(), 1, &Region);
+
+	// make the copy visible to host reads after the timeline wait
+	RenderBuilder.ResourceBarrier(Buffer.GetBuffer(), Buffer.GetBufferSize(), VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_HOST_READ_BIT
+		, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_HOST_BIT);
+
+	return true;
+}
+
+void UHOffscreenCapture::OnFrameSubmitted(VkSemaphore InTimeline, uint64_t InValue)
+{
+	if (RecordedSlot == UHINDEXNONE)
+	{
+		return;
+	}
+
+	{
+		std::unique_lock<std::mutex> Lock(QueueLock);
+		UHPendingFrame Frame;
+		Frame.SlotIdx = static_cast<uint32_t>(RecordedSlot);
+		Frame.Timeline = InTimeline;
+		Frame.TimelineValue = InValue;
+		Frame.FrameIndex = FrameCounter - 1;
+		PendingFrames.push_back(Frame);
+	}
+	RecordedSlot = UHINDEXNONE;
+	QueueNotify.notify_one();
+}
+
+void UHOffscreenCapture::Flush()
+{
+	std::unique_lock<std::mutex> Lock(QueueLock);
+	FlushNotify.wait(Lock, [this]() { return PendingFrames.empty() && !bIsWriting; });
+}
+
+uint64_t UHOffscreenCapture::GetCapturedCount() const
+{
+	return CapturedCount.load();
+}
+
+uint64_t UHOffscreenCapture::GetDroppedCount() const
+{
+	return DroppedCount.load();
+}
+
+void UHOffscreenCapture::WriterLoop()
+{
+	while (true)
+	{
+		UHPendingFrame Frame;
+		{
+			std::unique_lock<std::mutex> Lock(QueueLock);
+			QueueNotify.wait(Lock, [this]() { return !PendingFrames.empty() || bIsTerminating; });
+			if (PendingFrames.empty())
+			{
+				break;
+			}
+
+			Frame = PendingFrames.front();
+			PendingFrames.pop_front();
+			bIsWriting = true;
+		}
+
+		// wait the GPU frame on this thread, so the render thread never blocks on readbacks
+		VkSemaphoreWaitInfo WaitInfo{};
+		WaitInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO;
+		WaitInfo.semaphoreCount = 1;
+		WaitInfo.pSemaphores = &Frame.Timeline;
+		WaitInfo.pValues = &Frame.TimelineValue;
+		vkWaitSemaphores(LogicalDevice, &WaitInfo, UINT64_MAX);
+
+		// copy out and give the slot back before encoding, the encoding doesn't hold a readback buffer
+		ReadbackBuffers[Frame.SlotIdx].ReadbackData(PixelData);
+		{
+			std::unique_lock<std::mutex> Lock(QueueLock);
+			FreeSlots.push_back(Frame.SlotIdx);
+		}
+
+		WriteFrame(Frame.FrameIndex);
+		CapturedCount++;
+
+		{
+			std::unique_lock<std::mutex> Lock(QueueLock);
+			bIsWriting = false;
+		}
+		FlushNotify.notify_all();
+	}
+}
+
+void UHOffscreenCapture::WriteFrame(uint64_t InFrameIndex)
+{
+	char FileName[64];
+	switch (Settings.Output)
+	{
+	case UHCaptureOutput::Raw:
+	{
+		// tightly packed RGBA8 rows, the size is reported in the log
+		snprintf(FileName, sizeof(FileName), "Frame_%06llu.rgba", static_cast<unsigned long long>(InFrameIndex));
+		std::ofstream FileOut(Settings.OutputDir / FileName, std::ios::out | std::ios::binary);
+		if (!FileOut.is_open())
+		{
+			UHE_LOG("Failed to write capture " + std::string(FileName) + "!\n");
+			return;
+		}
+		FileOut.write(reinterpret_cast<const char*>(PixelData.data()), PixelData.size());
+		break;
+	}
+
+	case UHCaptureOutput::PNG:
+		snprintf(FileName, sizeof(FileName), "Frame_%06llu.png", static_cast<unsigned long long>(InFrameIndex));
+		if (!WritePNG(Settings.OutputDir / FileName))
+		{
+			UHE_LOG("Failed to write capture " + std::string(FileName) + "!\n");
+		}
+		break;
+
+	case UHCaptureOutput::SharedMemory:
+		if (SharedFrame != nullptr)
+		{
+			// seqlock write, odd sequence while the pixels are updated
+			SharedFrame->Sequence.fetch_add(1, std::memory_order_acq_rel);
+			UHMEMCOPY(reinterpret_cast<uint8_t*>(SharedFrame) + SharedFrame->PixelOffset, PixelData.data(), PixelData.size());
+			SharedFrame->FrameIndex = InFrameIndex;
+			SharedFrame->Sequence.fetch_add(1, std::memory_order_release);
+		}
+		break;
+
+	default:
+		break;
+	}
+}
+
+// minimal png encoder, the image data is stored without compression
+// the encoding is bound by the disk write rather than deflate, which suits a capture stream
+bool UHOffscreenCapture::WritePNG(const std::filesystem::path& InPath)
+{
+	std::ofstream FileOut(InPath, std::ios::out | std::ios::binary);
+	if (!FileOut.is_open())
+	{
+		return false;
+	}
+
+	const uint8_t Signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+	FileOut.write(reinterpret_cast<const char*>(Signature), 8);
+
+	// 8-bit RGBA, no interlace
+	std::vector<uint8_t> Header;
+	PushBigEndian(Header, Extent.width);
+	PushBigEndian(Header, Extent.height);
+	Header.insert(Header.end(), { 8, 6, 0, 0, 0 });
+	WritePNGChunk(FileOut, "IHDR", Header.data(), static_cast<uint32_t>(Header.size()));
+
+	// scanlines with filter type 0, followed by zlib stream of stored deflate blocks
+	const size_t RowSize = static_cast<size_t>(Extent.width) * 4;
+	const size_t ScanlineSize = (RowSize + 1) * Extent.height;
+	const size_t MaxBlockSize = 65535;
+	const size_t NumBlocks = std::max<size_t>((ScanlineSize + MaxBlockSize - 1) / MaxBlockSize, 1);
+
+	std::vector<uint8_t> Scanlines(ScanlineSize);
+	for (uint32_t Y = 0; Y < Extent.height; Y++)
+	{
+		Scanlines[Y * (RowSize + 1)] = 0;
+		UHMEMCOPY(&Scanlines[Y * (RowSize + 1) + 1], &PixelData[Y * RowSize], RowSize);
+	}
+
+	EncodeData.clear();
+	EncodeData.reserve(2 + ScanlineSize + NumBlocks * 5 + 4);
+	EncodeData.push_back(0x78);
+	EncodeData.push_back(0x01);
+	for (size_t Offset = 0; Offset < ScanlineSize; Offset += MaxBlockSize)
+	{
+		const size_t BlockSize = std::min(MaxBlockSize, ScanlineSize - Offset);
+		const bool bIsFinal = Offset + BlockSize >= ScanlineSize;
+		EncodeData.push_back(bIsFinal ? 1 : 0);
+		EncodeData.push_back(static_cast<uint8_t>(BlockSize));
+		EncodeData.push_back(static_cast<uint8_t>(BlockSize >> 8));
+		EncodeData.push_back(static_cast<uint8_t>(~BlockSize));
+		EncodeData.push_back(static_cast<uint8_t>(~BlockSize >> 8));
+		EncodeData.insert(EncodeData.end(), Scanlines.begin() + Offset, Scanlines.begin() + Offset + BlockSize);
+	}
+	PushBigEndian(EncodeData, Adler32(Scanlines.data(), Scanlines.size()));
+
+	WritePNGChunk(FileOut, "IDAT", EncodeData.data(), static_cast<uint32_t>(EncodeData.size()));
+	WritePNGChunk(FileOut, "IEND", nullptr, 0);
+
+	return FileOut.good();
+}
+
+bool UHOffscreenCapture::CreateSharedMemory()
+{
+#if __linux__
+	const uint32_t PixelOffset = 64;
+	SharedMemorySize = PixelOffset + static_cast<size_t>(Extent.width) * Extent.height * 4;
+
+	const int32_t FileHandle = shm_open(Settings.SharedMemoryName.c_str(), O_CREAT | O_RDWR, 0600);
+	if (FileHandle < 0)
+	{
+		UHE_LOG("Failed to open shared memory " + Settings.SharedMemoryName + "!\n");
+		return false;
+	}
+
+	if (ftruncate(FileHandle, static_cast<off_t>(SharedMemorySize)) != 0)
+	{
+		UHE_LOG("Failed to resize shared memory " + Settings.SharedMemoryName + "!\n");
+		close(FileHandle);
+		return false;
+	}
+
+	void* Mapped = mmap(nullptr, SharedMemorySize, PROT_READ | PROT_WRITE, MAP_SHARED, FileHandle, 0);
+	close(FileHandle);
+	if (Mapped == MAP_FAILED)
+	{
+		UHE_LOG("Failed to map shared memory " + Settings.SharedMemoryName + "!\n");
+		return false;
+	}
+
+	SharedFrame = new (Mapped) UHSharedFrameHeader();
+	SharedFrame->Width = Extent.width;
+	SharedFrame->Height = Extent.height;
+	SharedFrame->PixelOffset = PixelOffset;
+	SharedFrame->Sequence.store(0);
+	SharedFrame->FrameIndex = 0;
+	SharedFrame->Magic = UHSharedFrameHeader::FrameMagic;
+
+	UHE_LOG("Capture feed opened at shared memory " + Settings.SharedMemoryName + "\n");
+	return true;
+#else
+	UHE_LOG("Shared memory capture isn't supported on this platform!\n");
+	return false;
+#endif
+}
+
+void UHOffscreenCapture::ReleaseSharedMemory()
+{
+#if __linux__
+	if (SharedFrame != nullptr)
+	{
+		munmap(SharedFrame, SharedMemorySize);
+		shm_unlink(Settings.SharedMemoryName.c_str());
+		SharedFrame = nullptr;
+	}
+#endif
+}
@@ -0,0 +1,122 @@
+#pragma once
+#include "../../UnheardEngine.h"
+#include "../Engine/RenderResource.h"
+#include "../Classes/RenderBuffer.h"
+#include <atomic>
+#include <deque>
+#include <filesystem>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+
+class UHRenderBuilder;
+class UHRenderTexture;
+
+// where the captured frames go
+enum class UHCaptureOutput
+{
+	Off,
+	Raw,
+	PNG,
+	SharedMemory
+};
+
+struct UHOffscreenCaptureSettings
+{
+	UHOffscreenCaptureSettings()
+		: Output(UHCaptureOutput::Off)
+		, OutputDir("Captures")
+		, SharedMemoryName("/UHEFrames")
+		, RingSize(3)
+	{
+
+	}
+
+	UHCaptureOutput Output;
+	std::filesystem::path OutputDir;
+	std::string SharedMemoryName;
+
+	// number of host-visible readback buffers, frames are dropped when all of them are still in use
+	uint32_t RingSize;
+};
+
+// header of the shared memory feed, the RGBA8 pixels follow at PixelOffset
+// the sequence is odd while the writer is updating the pixels, readers retry if it's odd or changed after copying
+struct UHSharedFrameHeader
+{
+	static constexpr uint32_t FrameMagic = 0x52464855;
+
+	uint32_t Magic;
+	uint32_t Width;
+	uint32_t Height;
+	uint32_t PixelOffset;
+	std::atomic<uint64_t> Sequence;
+	uint64_t FrameIndex;
+};
+
+// offscreen frame capture, used by the windowless mode
+// the render thread records the copy of the offscreen target into a ring of host-visible buffers and never waits for them
+// a writer thread waits the frame timeline value, then streams the pixels to raw/PNG files or the shared memory feed
+class UHOffscreenCapture : public UHRenderResource
+{
+public:
+	UHOffscreenCapture();
+	~UHOffscreenCapture();
+
+	bool Initialize(const UHOffscreenCaptureSettings& InSettings, VkExtent2D InExtent);
+	void Release();
+
+	// render thread, record the readback of an offscreen target which is in TRANSFER_DST layout
+	// return false if the ring is full and the frame is dropped
+	bool RecordReadback(UHRenderBuilder& RenderBuilder, UHRenderTexture* InTarget);
+
+	// render thread, the recorded readback is done once the timeline reaches the value
+	void OnFrameSubmitted(VkSemaphore InTimeline, uint64_t InValue);
+
+	// wait until all submitted frames are written, must be called before the timeline semaphore is destroyed
+	void Flush();
+
+	uint64_t GetCapturedCount() const;
+	uint64_t GetDroppedCount() const;
+
+private:
+	struct UHPendingFrame
+	{
+		uint32_t SlotIdx;
+		VkSemaphore Timeline;
+		uint64_t TimelineValue;
+		uint64_t FrameIndex;
+	};
+
+	void WriterLoop();
+	void WriteFrame(uint64_t InFrameIndex);
+	bool WritePNG(const std::filesystem::path& InPath);
+	bool CreateSharedMemory();
+	void ReleaseSharedMemory();
+
+	UHOffscreenCaptureSettings Settings;
+	VkExtent2D Extent;
+
+	std::vector<UHRenderBuffer<uint8_t>> ReadbackBuffers;
+	std::vector<uint32_t> FreeSlots;
+	std::deque<UHPendingFrame> PendingFrames;
+	int32_t RecordedSlot;
+	uint64_t FrameCounter;
+
+	std::thread WriterThread;
+	std::mutex QueueLock;
+	std::condition_variable QueueNotify;
+	std::condition_variable FlushNotify;
+	bool bIsWriting;
+	bool bIsTerminating;
+
+	std::atomic<uint64_t> CapturedCount;
+	std::atomic<uint64_t> DroppedCount;
+
+	// writer thread only
+	std::vector<uint8_t> PixelData;
+	std::vector<uint8_t> EncodeData;
+
+	UHSharedFrameHeader* SharedFrame;
+	size_t SharedMemorySize;
+};
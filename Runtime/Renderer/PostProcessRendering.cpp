@@ -5,10 +5,10 @@ void UHDeferredShadingRenderer::RenderEffect(UHShaderClass* InShader, UHRenderBu
 	GraphicInterface->BeginCmdDebug(RenderBuilder.GetCmdList(), "Render " + InName);
 
 	RenderBuilder.ResourceBarrier(PostProcessResults[1 - PostProcessIdx], VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
-	RenderBuilder.BeginRenderPass(PostProcessPassObj[PostProcessIdx], RenderResolution);
+	RenderBuilder.BeginRenderPass(PostProcessPassObj[PostProcessIdx], OutputResolution);
 
-	RenderBuilder.SetViewport(RenderResolution);
-	RenderBuilder.SetScissor(RenderResolution);
+	RenderBuilder.SetViewport(OutputResolution);
+	RenderBuilder.SetScissor(OutputResolution);
 
 	// bind state
 	UHGraphicState* State = InShader->GetState();
@@ -54,6 +54,39 @@ void UHDeferredShadingRenderer::Dispatch2DEffect(UHShaderClass* InShader, UHRend
 	PostProcessIdx = 1 - PostProcessIdx;
 }
 
+// temporal upscaler, it reconstructs scene result to post process RT at output resolution
+void UHDeferredShadingRenderer::DispatchTemporalUpscale(UHRenderBuilder& RenderBuilder)
+{
+	GraphicInterface->BeginCmdDebug(RenderBuilder.GetCmdList(), "Dispatch Temporal Upscale");
+
+	RenderBuilder.PushResourceBarrier(UHImageBarrier(GSceneResult, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL));
+	RenderBuilder.PushResourceBarrier(UHImageBarrier(GPreviousSceneResult, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL));
+	RenderBuilder.PushResourceBarrier(UHImageBarrier(GSceneMixedDepth, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL));
+	RenderBuilder.PushResourceBarrier(UHImageBarrier(GPostProcessRT, VK_IMAGE_LAYOUT_GENERAL));
+	RenderBuilder.FlushResourceBarrier();
+
+	RenderBuilder.BindComputeState(TemporalUpscaleShader->GetComputeState());
+	RenderBuilder.BindDescriptorSetCompute(TemporalUpscaleShader->GetPipelineLayout(), TemporalUpscaleShader->GetDescriptorSet(CurrentFrameRT));
+
+	// the history is garbage after reset, the upscaler simply outputs the reconstructed result
+	UHTemporalUpscaleConstants Consts;
+	Consts.OutputResolutionX = OutputResolution.width;
+	Consts.OutputResolutionY = OutputResolution.height;
+	Consts.InvOutputResolutionX = 1.0f / static_cast<float>(OutputResolution.width);
+	Consts.InvOutputResolutionY = 1.0f / static_cast<float>(OutputResolution.height);
+	Consts.bResetHistory = bIsTemporalReset ? 1 : 0;
+	RenderBuilder.PushConstant(TemporalUpscaleShader->GetPipelineLayout(), VK_SHADER_STAGE_COMPUTE_BIT, sizeof(UHTemporalUpscaleConstants), &Consts);
+
+	RenderBuilder.Dispatch(UHMathHelpers::RoundUpDivide(OutputResolution.width, GThreadGroup2D_X)
+		, UHMathHelpers::RoundUpDivide(OutputResolution.height, GThreadGroup2D_Y), 1);
+
+	RenderBuilder.PushResourceBarrier(UHImageBarrier(GSceneResult, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL));
+	RenderBuilder.PushResourceBarrier(UHImageBarrier(GPostProcessRT, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL));
+	RenderBuilder.FlushResourceBarrier();
+
+	GraphicInterface->EndCmdDebug(RenderBuilder.GetCmdList());
+}
+
 void UHDeferredShadingRenderer::CopyDepthNormalHistory(UHRenderBuilder& RenderBuilder)
 {
 	if (!RTParams.bNeedDepthNormalHistory)
@@ -83,17 +116,32 @@ void UHDeferredShadingRenderer::CopyDepthNormalHistory(UHRenderBuilder& RenderBu
 
 void UHDeferredShadingRenderer::RenderPostProcessing(UHRenderBuilder& RenderBuilder)
 {
-	UHGameTimerScope Scope("RenderPostProcessing", false);
+	UH_TRACE_SCOPE("RenderPostProcessing");
 	GraphicInterface->BeginCmdDebug(RenderBuilder.GetCmdList(), "Postprocessing Passes");
 	// post process RT starts from undefined, transition it first
 	RenderBuilder.ResourceBarrier(GPostProcessRT, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL);
 	PostProcessResults[0] = GPostProcessRT;
 	PostProcessResults[1] = GSceneResult;
+	if (bEnableTemporalUpscale)
+	{
+		RenderBuilder.ResourceBarrier(GUpscaledSceneResult, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL);
+		PostProcessResults[1] = GUpscaledSceneResult;
+	}
 
 	// this index will toggle between 0 and 1 during the post processing
 	int32_t CurrentPostProcessRTIndex = 0;
-	
+
+	// -------------------------- Temporal Upscale --------------------------//
+	if (bEnableTemporalUpscale)
+	{
+		// it always runs even when resetting, otherwise nothing is at output resolution
+		UHGPUTimeQueryScope TimeScope(RenderBuilder.GetCmdList(), GPUTimeQueries[UH_ENUM_VALUE(UHRenderPassTypes::TemporalUpscalePass)], "TemporalUpscalePass");
+		DispatchTemporalUpscale(RenderBuilder);
+		CurrentPostProcessRTIndex = 1;
+		bIsTemporalReset = false;
+	}
 	// -------------------------- Temporal AA --------------------------//
+	else
 	{
 		UHGPUTimeQueryScope TimeScope(RenderBuilder.GetCmdList(), GPUTimeQueries[UH_ENUM_VALUE(UHRenderPassTypes::TemporalAAPass)], "TemporalAAPass");
 		if (RTParams.bEnableTAA)
@@ -155,14 +203,24 @@ void UHDeferredShadingRenderer::RenderPostProcessing(UHRenderBuilder& RenderBuil
 
 uint32_t UHDeferredShadingRenderer::RenderSceneToSwapChain(UHRenderBuilder& RenderBuilder)
 {
-	UHGameTimerScope Scope("RenderSceneToSwapChain", false);
+	UH_TRACE_SCOPE("RenderSceneToSwapChain");
 	UHGPUTimeQueryScope TimeScope(RenderBuilder.GetCmdList(), GPUTimeQueries[UH_ENUM_VALUE(UHRenderPassTypes::PresentToSwapChain)], "PresentToSwapChain");
 	GraphicInterface->BeginCmdDebug(RenderBuilder.GetCmdList(), "Scene to SwapChain Pass");
 
 	uint32_t ImageIndex;
 	{
 		VkRenderPass SwapChainRenderPass = GraphicInterface->GetSwapChainRenderPass();
-		VkFramebuffer SwapChainBuffer = RenderBuilder.GetCurrentSwapChainBuffer(SceneRenderQueue.WaitingSemaphores[CurrentFrameRT], ImageIndex);
+		// offscreen targets are simply indexed by the frame, there is nothing to acquire
+		VkFramebuffer SwapChainBuffer = nullptr;
+		if (GIsOffscreen)
+		{
+			ImageIndex = CurrentFrameRT;
+			SwapChainBuffer = GraphicInterface->GetSwapChainBuffer(ImageIndex);
+		}
+		else
+		{
+			SwapChainBuffer = RenderBuilder.GetCurrentSwapChainBuffer(SceneRenderQueue.WaitingSemaphores[CurrentFrameRT], ImageIndex);
+		}
 		UHRenderTexture* SwapChainRT = GraphicInterface->GetSwapChainRT(ImageIndex);
 		VkExtent2D SwapChainExtent = GraphicInterface->GetSwapChainExtent();
 
@@ -185,14 +243,14 @@ uint32_t UHDeferredShadingRenderer::RenderSceneToSwapChain(UHRenderBuilder& Rend
 			VkExtent2D ConstraintedOffset;
 			VkExtent2D ConstraintedExtent;
 			ConstraintedExtent.width = SwapChainExtent.width;
-			ConstraintedExtent.height = SwapChainExtent.width * RenderResolution.height / RenderResolution.width;
+			ConstraintedExtent.height = SwapChainExtent.width * OutputResolution.height / OutputResolution.width;
 			ConstraintedOffset.width = 0;
 			ConstraintedOffset.height = (SwapChainExtent.height - ConstraintedExtent.height) / 2;
 
 			if (ConstraintedExtent.height > SwapChainExtent.height)
 			{
 				ConstraintedExtent.height = SwapChainExtent.height;
-				ConstraintedExtent.width = SwapChainExtent.height * RenderResolution.width / RenderResolution.height;
+				ConstraintedExtent.width = SwapChainExtent.height * OutputResolution.width / OutputResolution.height;
 				ConstraintedOffset.height = 0;
 				ConstraintedOffset.width = (SwapChainExtent.width - ConstraintedExtent.width) / 2;
 			}
@@ -214,12 +272,23 @@ uint32_t UHDeferredShadingRenderer::RenderSceneToSwapChain(UHRenderBuilder& Rend
 		Obj.RenderPass = SwapChainRenderPass;
 		Obj.FrameBuffer = SwapChainBuffer;
 		RenderBuilder.BeginRenderPass(Obj, SwapChainExtent);
-		ImGui_ImplVulkan_RenderDrawData(ImGui::GetDrawData(), RenderBuilder.GetCmdList(), GraphicInterface->GetImGuiPipeline());
+		ImGui_ImplVulkan_RenderDrawData(&EditorDrawData[CurrentFrameRT], RenderBuilder.GetCmdList(), GraphicInterface->GetImGuiPipeline());
 		RenderBuilder.EndRenderPass();
 #endif
 
-		// end blit and transition swapchain to PRESENT_SRC_KHR
-		RenderBuilder.ResourceBarrier(SwapChainRT, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_PRESENT_SRC_KHR);
+		if (GIsOffscreen)
+		{
+			// offscreen target is never presented, read it back if it's captured
+			if (OffscreenCapture != nullptr)
+			{
+				OffscreenCapture->RecordReadback(RenderBuilder, SwapChainRT);
+			}
+		}
+		else
+		{
+			// end blit and transition swapchain to PRESENT_SRC_KHR
+			RenderBuilder.ResourceBarrier(SwapChainRT, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_PRESENT_SRC_KHR);
+		}
 	}
 
 	GraphicInterface->EndCmdDebug(RenderBuilder.GetCmdList());
@@ -251,10 +320,10 @@ void UHDeferredShadingRenderer::RenderComponentBounds(UHRenderBuilder& RenderBui
 	DebugBoundShader->GetDebugBoundData(CurrentFrameRT)->UploadAllData(&BoundConstant);
 
 	GraphicInterface->BeginCmdDebug(RenderBuilder.GetCmdList(), "Draw Component Bounds");
-	RenderBuilder.BeginRenderPass(PostProcessPassObj[PostProcessIdx], RenderResolution);
+	RenderBuilder.BeginRenderPass(PostProcessPassObj[PostProcessIdx], OutputResolution);
 
-	RenderBuilder.SetViewport(RenderResolution);
-	RenderBuilder.SetScissor(RenderResolution);
+	RenderBuilder.SetViewport(OutputResolution);
+	RenderBuilder.SetScissor(OutputResolution);
 
 	// bind state
 	UHGraphicState* State = DebugBoundShader->GetState();
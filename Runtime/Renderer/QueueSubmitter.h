@@ -1,5 +1,6 @@
 #pragma once
 #include "../Engine/Graphic.h"
+#include <atomic>
 
 // the queue submission stuffs
 struct UHQueueSubmitter
@@ -7,6 +8,8 @@ struct UHQueueSubmitter
 public:
 	UHQueueSubmitter()
 		: CommandPool(nullptr)
+		, TimelineSemaphore(nullptr)
+		, SubmittedValue(0)
 		, LogicalDevice(nullptr)
 		, Queue(nullptr)
 	{
@@ -16,6 +19,7 @@ public:
 			WaitingSemaphores[Idx] = nullptr;
 			FinishedSemaphores[Idx] = nullptr;
 			Fences[Idx] = nullptr;
+			FrameValues[Idx] = 0;
 		}
 	}
 
@@ -92,6 +96,32 @@ public:
 #endif
 		}
 
+		// timeline semaphore for frame pipelining, every submitted frame signals an increasing value
+		VkSemaphoreTypeCreateInfo TypeInfo{};
+		TypeInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO;
+		TypeInfo.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE;
+		TypeInfo.initialValue = 0;
+
+		VkSemaphoreCreateInfo TimelineInfo{};
+		TimelineInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+		TimelineInfo.pNext = &TypeInfo;
+
+		if (vkCreateSemaphore(LogicalDevice, &TimelineInfo, nullptr, &TimelineSemaphore) != VK_SUCCESS)
+		{
+			UHE_LOG("Failed to create timeline semaphore!\n");
+			return false;
+		}
+
+#if WITH_EDITOR
+		InGfx->SetDebugUtilsObjectName(VK_OBJECT_TYPE_SEMAPHORE, (uint64_t)TimelineSemaphore
+			, InName + "_TimelineSemaphore");
+#endif
+		SubmittedValue = 0;
+		for (uint32_t Idx = 0; Idx < GMaxFrameInFlight; Idx++)
+		{
+			FrameValues[Idx] = 0;
+		}
+
 		// at last, get the queue
 		vkGetDeviceQueue(LogicalDevice, QueueFamilyIndex, QueueIndex, &Queue);
 
@@ -107,7 +137,74 @@ public:
 			SafeDestroyFence(LogicalDevice, Fences[Idx]);
 		}
 
+		SafeDestroySemaphore(LogicalDevice, TimelineSemaphore);
 		SafeDestroyCommandPool(LogicalDevice, CommandPool);
+
+		// batch command buffers are freed along with the pool
+		for (uint32_t Idx = 0; Idx < GMaxFrameInFlight; Idx++)
+		{
+			BatchCommandBuffers[Idx].clear();
+		}
+	}
+
+	// command buffers for render graph batches, they're allocated on demand and reused with the frame slot
+	VkCommandBuffer GetBatchCommandBuffer(const uint32_t FrameIdx, const uint32_t BatchIdx)
+	{
+		std::vector<VkCommandBuffer>& Buffers = BatchCommandBuffers[FrameIdx];
+		while (Buffers.size() <= BatchIdx)
+		{
+			VkCommandBufferAllocateInfo AllocInfo{};
+			AllocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+			AllocInfo.commandPool = CommandPool;
+			AllocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+			AllocInfo.commandBufferCount = 1;
+
+			VkCommandBuffer NewBuffer = nullptr;
+			if (vkAllocateCommandBuffers(LogicalDevice, &AllocInfo, &NewBuffer) != VK_SUCCESS)
+			{
+				UHE_LOG("Failed to allocate batch command buffer!\n");
+				return nullptr;
+			}
+			Buffers.push_back(NewBuffer);
+		}
+
+		return Buffers[BatchIdx];
+	}
+
+	// assign the timeline value for a batch submitted in the middle of a frame
+	uint64_t SignalBatch()
+	{
+		return ++SubmittedValue;
+	}
+
+	// assign the timeline value for the frame to submit
+	uint64_t SignalFrame(const uint32_t FrameIdx)
+	{
+		FrameValues[FrameIdx] = ++SubmittedValue;
+		return FrameValues[FrameIdx];
+	}
+
+	// CPU wait until GPU finished the frame which used this frame slot last time
+	void WaitFrame(const uint32_t FrameIdx) const
+	{
+		if (FrameValues[FrameIdx] == 0)
+		{
+			return;
+		}
+
+		VkSemaphoreWaitInfo WaitInfo{};
+		WaitInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO;
+		WaitInfo.semaphoreCount = 1;
+		WaitInfo.pSemaphores = &TimelineSemaphore;
+		WaitInfo.pValues = &FrameValues[FrameIdx];
+		vkWaitSemaphores(LogicalDevice, &WaitInfo, UINT64_MAX);
+	}
+
+	uint64_t GetCompletedValue() const
+	{
+		uint64_t Value = 0;
+		vkGetSemaphoreCounterValue(LogicalDevice, TimelineSemaphore, &Value);
+		return Value;
 	}
 
 	// similar to D3D12 command list allocator
@@ -115,6 +212,7 @@ public:
 
 	// similar to D3D12 command list
 	std::array<VkCommandBuffer, GMaxFrameInFlight> CommandBuffers;
+	std::array<std::vector<VkCommandBuffer>, GMaxFrameInFlight> BatchCommandBuffers;
 
 	// similar to D3D12 Fence (GPU Fence)
 	std::array<VkSemaphore, GMaxFrameInFlight> WaitingSemaphores;
@@ -123,6 +221,11 @@ public:
 	// similar to D3D12 Fence
 	std::array<VkFence, GMaxFrameInFlight> Fences;
 
+	// timeline values, the frame values are written by render thread and read by game thread after syncing with it
+	VkSemaphore TimelineSemaphore;
+	std::atomic<uint64_t> SubmittedValue;
+	std::array<uint64_t, GMaxFrameInFlight> FrameValues;
+
 	VkDevice LogicalDevice;
 	VkQueue Queue;
 };
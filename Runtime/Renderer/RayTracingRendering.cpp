@@ -1,5 +1,30 @@
 #include "DeferredShadingRenderer.h"
 
+static uint32_t GetRTTileCount(const VkExtent2D& InExtent)
+{
+	return UHMathHelpers::RoundUpDivide(InExtent.width, UHRTTileClassifyShader::TileSize)
+		* UHMathHelpers::RoundUpDivide(InExtent.height, UHRTTileClassifyShader::TileSize);
+}
+
+static UHBoundingBox GetLightRangeBound(const UHVector3& InPosition, float InRadius)
+{
+	return UHBoundingBox(InPosition, UHVector3(InRadius, InRadius, InRadius));
+}
+
+static bool IsBoundOverlapped(const UHBoundingBox& InA, const UHBoundingBox& InB)
+{
+	return UHMathHelpers::UHVector3InBound(InA.Center - InB.Center, InA.Extents + InB.Extents);
+}
+
+static void AddRTCacheInvalidation(std::vector<UHRTCacheInvalidation>& OutInvalidations, const UHBoundingBox& InBound, uint32_t InFlags)
+{
+	UHRTCacheInvalidation Invalidation;
+	Invalidation.Center = InBound.Center;
+	Invalidation.Extents = InBound.Extents;
+	Invalidation.Flags = InFlags;
+	OutInvalidations.push_back(Invalidation);
+}
+
 void UHDeferredShadingRenderer::ReleaseRayTracingBuffers()
 {
 	if (!GraphicInterface->IsRayTracingEnabled())
@@ -21,8 +46,84 @@ void UHDeferredShadingRenderer::ReleaseRayTracingBuffers()
 	UH_SAFE_RELEASE_TEX(GRTSkyData);
 	UH_SAFE_RELEASE_TEX(GRTSkyDiscoverAngle);
 
+	UH_SAFE_RELEASE(GRTReflectionTileList);
+	UH_SAFE_RELEASE(GRTReflectionRayArgs);
+	UH_SAFE_RELEASE(GRTIndirectTileList);
+	UH_SAFE_RELEASE(GRTIndirectRayArgs);
+	UH_SAFE_RELEASE_TEX(GRTIndirectTileRate);
+	UH_SAFE_RELEASE(GRTShadowTileList);
+	UH_SAFE_RELEASE(GRTShadowRayArgs);
+
 	RTIndirectDiffuseBFConsts.Release(GraphicInterface);
 	RTIndirectOcclusionBFConsts.Release(GraphicInterface);
+	UH_SAFE_RELEASE(RTTransientMemory);
+	RTTransientMemory.reset();
+}
+
+void UHDeferredShadingRenderer::CreateFilterTempRTs(UHRenderTextureSettings InRTSettings)
+{
+	struct UHFilterTempDesc
+	{
+		std::string Name;
+		UHTextureFormat Format;
+		UHRenderTexture** Output;
+	};
+
+	// RTAO temps keep the format of the occlusion so the filter can copy instead of blit on async compute queue
+	// they're aliased with the larger diffuse temps, so the wider format costs no extra memory
+	const UHFilterTempDesc Descs[] =
+	{
+		{ "RTDiffuse_FilterTempRT0", GRTIndirectDiffuse->GetFormat(), &RTIndirectDiffuseBFConsts.FilterTempRT0 },
+		{ "RTDiffuse_FilterTempRT1", GRTIndirectDiffuse->GetFormat(), &RTIndirectDiffuseBFConsts.FilterTempRT1 },
+		{ "RTAO_FilterTempRT0", GRTIndirectOcclusion->GetFormat(), &RTIndirectOcclusionBFConsts.FilterTempRT0 },
+		{ "RTAO_FilterTempRT1", GRTIndirectOcclusion->GetFormat(), &RTIndirectOcclusionBFConsts.FilterTempRT1 },
+	};
+	const int32_t NumTemps = static_cast<int32_t>(std::size(Descs));
+
+	// describe the two filter passes to a render graph, the temps only live within their own filter
+	// so the graph can alias the RTAO temps into the memory of diffuse temps
+	const uint32_t MemoryTypeIndex = GraphicInterface->GetDeviceMemoryTypeIndices()[0];
+	bool bCanAlias = true;
+
+	UHRenderGraph TransientGraph;
+	UHRenderGraphResource Resources[std::size(Descs)];
+	for (int32_t Idx = 0; Idx < NumTemps; Idx++)
+	{
+		const VkMemoryRequirements MemReqs = GraphicInterface->GetRenderTextureMemoryRequirements(Descs[Idx].Name, RTIndirectLightExtent
+			, Descs[Idx].Format, InRTSettings);
+		bCanAlias &= (MemReqs.memoryTypeBits & (1u << MemoryTypeIndex)) != 0;
+		Resources[Idx] = TransientGraph.CreateTransientTexture(Descs[Idx].Name, MemReqs.size, MemReqs.alignment);
+		RTFilterTempMemReqs[Idx] = MemReqs;
+	}
+
+	const int32_t DiffuseFilterPass = TransientGraph.AddPass("IndirectDiffuseFilter", nullptr, true);
+	TransientGraph.Write(DiffuseFilterPass, Resources[0], VK_IMAGE_LAYOUT_GENERAL);
+	TransientGraph.Write(DiffuseFilterPass, Resources[1], VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+
+	const int32_t OcclusionFilterPass = TransientGraph.AddPass("IndirectOcclusionFilter", nullptr, true);
+	TransientGraph.Write(OcclusionFilterPass, Resources[2], VK_IMAGE_LAYOUT_GENERAL);
+	TransientGraph.Write(OcclusionFilterPass, Resources[3], VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+
+	bCanAlias &= TransientGraph.Compile();
+	if (bCanAlias)
+	{
+		RTTransientMemory = MakeUnique<UHGPUMemory>();
+		RTTransientMemory->SetGfxCache(GraphicInterface);
+		RTTransientMemory->AllocateMemory(TransientGraph.GetTransientHeapSize(), MemoryTypeIndex);
+	}
+
+	// fallback to individual allocations if the transient memory isn't available
+	for (int32_t Idx = 0; Idx < NumTemps; Idx++)
+	{
+		UHRenderTextureSettings TempRTSettings = InRTSettings;
+		if (RTTransientMemory != nullptr && RTTransientMemory->GetMemory() != nullptr)
+		{
+			TempRTSettings.SharedMemory = RTTransientMemory.get();
+			TempRTSettings.MemoryOffset = TransientGraph.GetTransientOffset(Resources[Idx]);
+		}
+
+		*Descs[Idx].Output = GraphicInterface->RequestRenderTexture(Descs[Idx].Name, RTIndirectLightExtent, Descs[Idx].Format, TempRTSettings);
+	}
 }
 
 void UHDeferredShadingRenderer::ResizeRayTracingBuffers(bool bUpdateDescriptor)
@@ -58,8 +159,10 @@ void UHDeferredShadingRenderer::ResizeRayTracingBuffers(bool bUpdateDescriptor)
 		GRTReflectionResult = GraphicInterface->RequestRenderTexture("RTReflectionResult", RenderResolution, UHTextureFormat::UH_FORMAT_RGBA16F, RenderTextureSetting);
 		RenderTextureSetting.bUseMipmap = false;
 
-		// refined normal at half size
+		// refined normal at half size, it's read by both RT reflection and RT indirect light which could run on async compute queue
+		RenderTextureSetting.bIsSharedAcrossQueues = ConfigInterface->RenderingSetting().bEnableAsyncCompute;
 		GSmoothSceneNormal = GraphicInterface->RequestRenderTexture("SmoothSceneNormal", HalfRes, UHTextureFormat::UH_FORMAT_RGBA16F, RenderTextureSetting);
+		RenderTextureSetting.bIsSharedAcrossQueues = false;
 
 		// indirect light at half size
 		RTIndirectLightExtent = HalfRes;
@@ -95,16 +198,6 @@ void UHDeferredShadingRenderer::ResizeRayTracingBuffers(bool bUpdateDescriptor)
 		RTIndirectDiffuseBFConsts.SigmaC = 2.0f;
 		RTIndirectDiffuseBFConsts.IterationCount = 2;
 
-		RTIndirectDiffuseBFConsts.FilterTempRT0 = GraphicInterface->RequestRenderTexture("RTDiffuse_FilterTempRT0"
-			, RTIndirectLightExtent
-			, GRTIndirectDiffuse->GetFormat()
-			, RenderTextureSetting);
-
-		RTIndirectDiffuseBFConsts.FilterTempRT1 = GraphicInterface->RequestRenderTexture("RTDiffuse_FilterTempRT1"
-			, RTIndirectLightExtent
-			, GRTIndirectDiffuse->GetFormat()
-			, RenderTextureSetting);
-
 		// initialize UHBilateralFilterConstants for filtering RTAO result
 		RTIndirectOcclusionBFConsts.FilterResolution[0] = RTIndirectLightExtent.width;
 		RTIndirectOcclusionBFConsts.FilterResolution[1] = RTIndirectLightExtent.height;
@@ -116,16 +209,30 @@ void UHDeferredShadingRenderer::ResizeRayTracingBuffers(bool bUpdateDescriptor)
 		RTIndirectOcclusionBFConsts.SigmaC = 0.0f;
 		RTIndirectOcclusionBFConsts.IterationCount = 1;
 
-		// for BF pass only R channel is needed
-		RTIndirectOcclusionBFConsts.FilterTempRT0 = GraphicInterface->RequestRenderTexture("RTAO_FilterTempRT0"
-			, RTIndirectLightExtent
-			, UHTextureFormat::UH_FORMAT_R16F
-			, RenderTextureSetting);
-
-		RTIndirectOcclusionBFConsts.FilterTempRT1 = GraphicInterface->RequestRenderTexture("RTAO_FilterTempRT1"
-			, RTIndirectLightExtent
-			, UHTextureFormat::UH_FORMAT_R16F
-			, RenderTextureSetting);
+		// bilateral filter temps
+		CreateFilterTempRTs(RenderTextureSetting);
+
+		// adaptive tile lists, the full rate tiles are at the front and the quarter rate tiles are at the back
+		// reflection tiles are counted at render resolution, so the quality can be changed without resizing
+		RTReflectionMaxTiles = GetRTTileCount(RenderResolution);
+		RTIndirectMaxTiles = GetRTTileCount(RTIndirectLightExtent);
+		RTShadowMaxTiles = GetRTTileCount(RTShadowExtent);
+		const VkBufferUsageFlags RayArgsUsage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT;
+
+		GRTReflectionTileList = GraphicInterface->RequestRenderBuffer<uint32_t>(2 * RTReflectionMaxTiles, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, "RTReflectionTileList");
+		GRTReflectionRayArgs = GraphicInterface->RequestRenderBuffer<uint32_t>(UHRTTileClassifyShader::RayArgsCount, RayArgsUsage, "RTReflectionRayArgs");
+		GRTIndirectTileList = GraphicInterface->RequestRenderBuffer<uint32_t>(2 * RTIndirectMaxTiles, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, "RTIndirectTileList");
+		GRTIndirectRayArgs = GraphicInterface->RequestRenderBuffer<uint32_t>(UHRTTileClassifyShader::RayArgsCount, RayArgsUsage, "RTIndirectRayArgs");
+		GRTShadowTileList = GraphicInterface->RequestRenderBuffer<uint32_t>(2 * RTShadowMaxTiles, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, "RTShadowTileList");
+		GRTShadowRayArgs = GraphicInterface->RequestRenderBuffer<uint32_t>(UHRTTileClassifyShader::RayArgsCount, RayArgsUsage, "RTShadowRayArgs");
+
+		VkExtent2D TileExtent;
+		TileExtent.width = UHMathHelpers::RoundUpDivide(RTIndirectLightExtent.width, UHRTTileClassifyShader::TileSize);
+		TileExtent.height = UHMathHelpers::RoundUpDivide(RTIndirectLightExtent.height, UHRTTileClassifyShader::TileSize);
+		GRTIndirectTileRate = GraphicInterface->RequestRenderTexture("RTIndirectTileRate", TileExtent, UHTextureFormat::UH_FORMAT_R8_UINT, RenderTextureSetting);
+		RTIndirectHistoryFrames = 0;
+		bIsRTShadowCacheValid = false;
+		RTReflectionCacheStride = 0;
 
 		// sky visibility data, stored in volume based on the scene bound
 		if (CurrentScene != nullptr)
@@ -166,7 +273,7 @@ void UHDeferredShadingRenderer::ResizeRayTracingBuffers(bool bUpdateDescriptor)
 
 void UHDeferredShadingRenderer::BuildTopLevelAS(UHRenderBuilder& RenderBuilder)
 {
-	UHGameTimerScope Scope("BuildTopLevelAS", false);
+	UH_TRACE_SCOPE("BuildTopLevelAS");
 	UHGPUTimeQueryScope TimeScope(RenderBuilder.GetCmdList(), GPUTimeQueries[UH_ENUM_VALUE(UHRenderPassTypes::UpdateTopLevelAS)], "UpdateTopLevelAS");
 	if (!RTParams.bEnableRayTracing || RTInstanceCount == 0)
 	{
@@ -178,14 +285,15 @@ void UHDeferredShadingRenderer::BuildTopLevelAS(UHRenderBuilder& RenderBuilder)
 	// https://microsoft.github.io/DirectX-Specs/d3d/Raytracing.html#general-tips-for-building-acceleration-structures
 	// From Microsoft tips: Rebuild top-level acceleration structure every frame
 	// but I still choose to update AS instead of rebuilding, FPS is higher with updating
-	GTopLevelAS[CurrentFrameRT]->UpdateTopAS(RenderBuilder.GetCmdList(), CurrentFrameRT, RTParams.RTCullingDistance);
+	// only changed instances are uploaded, and it's rebuilt when instance count changes or the update quality degrades
+	GTopLevelAS[CurrentFrameRT]->UpdateTopAS(RenderBuilder.GetCmdList(), TopASInstanceStates[CurrentFrameRT], RTParams.RTCullingDistance);
 
 	GraphicInterface->EndCmdDebug(RenderBuilder.GetCmdList());
 }
 
 void UHDeferredShadingRenderer::CollectLightPass(UHRenderBuilder& RenderBuilder)
 {
-	UHGameTimerScope Scope("CollectLightPass", false);
+	UH_TRACE_SCOPE("CollectLightPass");
 	UHGPUTimeQueryScope TimeScope(RenderBuilder.GetCmdList(), GPUTimeQueries[UH_ENUM_VALUE(UHRenderPassTypes::CollectLightPass)], "CollectLightPass");
 	if (!RTParams.bEnableRayTracing || RTInstanceCount == 0)
 	{
@@ -236,6 +344,7 @@ void UHDeferredShadingRenderer::DispatchRayShadowPass(UHRenderBuilder& RenderBui
 {
 	if (!RTParams.bEnableRayTracing || RTInstanceCount == 0 || !RTParams.bEnableRTShadow)
 	{
+		bIsRTShadowCacheValid = false;
 		return;
 	}
 
@@ -243,7 +352,7 @@ void UHDeferredShadingRenderer::DispatchRayShadowPass(UHRenderBuilder& RenderBui
 
 	GraphicInterface->BeginCmdDebug(RenderBuilder.GetCmdList(), "Dispatch Ray Shadow");
 	{
-		UHGameTimerScope Scope("DispatchRayShadowPass", false);
+		UH_TRACE_SCOPE("DispatchRayShadowPass");
 		UHGPUTimeQueryScope TimeScope(RenderBuilder.GetCmdList(), GPUTimeQueries[UH_ENUM_VALUE(UHRenderPassTypes::RayTracingShadow)], "RayTracingShadow");
 
 		// transition output buffer to VK_IMAGE_LAYOUT_GENERAL
@@ -251,6 +360,12 @@ void UHDeferredShadingRenderer::DispatchRayShadowPass(UHRenderBuilder& RenderBui
 		RenderBuilder.PushResourceBarrier(UHImageBarrier(GRTReceiveLightBits, VK_IMAGE_LAYOUT_GENERAL));
 		RenderBuilder.FlushResourceBarrier();
 
+		// classify the tiles, the tiles with valid cached results keep the output of last frame
+		UHRTTileClassifyConstants TileConsts = GetRTTileClassifyConstants(UHRTTileClassifyType::Shadow, ShadowResultExtent
+			, RenderResolution.width / ShadowResultExtent.width);
+		TileConsts.bCacheValid = (RTParams.bEnableRTResultCache && !RTParams.bResetRTCache && bIsRTShadowCacheValid) ? 1 : 0;
+		DispatchRTTileClassify(RenderBuilder, RTShadowTileClassifyShader.get(), GRTShadowRayArgs.get(), TileConsts);
+
 		// bind descriptors and RT states
 		// [0] is to bind the shader descriptor, and prevent touching other elements. Not a typo!
 		RTDescriptorSets[CurrentFrameRT][0] = RTShadowShader->GetDescriptorSet(CurrentFrameRT);
@@ -258,13 +373,14 @@ void UHDeferredShadingRenderer::DispatchRayShadowPass(UHRenderBuilder& RenderBui
 		RenderBuilder.BindRTState(RTShadowShader->GetRTState());
 
 		// trace!
-		RenderBuilder.TraceRay(ShadowResultExtent, RTShadowShader->GetRayGenTable(), RTShadowShader->GetMissTable(), RTShadowShader->GetHitGroupTable());
+		TraceRTTiles(RenderBuilder, RTShadowShader.get(), GRTShadowRayArgs.get(), RTShadowMaxTiles);
+		bIsRTShadowCacheValid = RTParams.bEnableRTResultCache;
 	}
 	GraphicInterface->EndCmdDebug(RenderBuilder.GetCmdList());
 
 	GraphicInterface->BeginCmdDebug(RenderBuilder.GetCmdList(), "Dispatch RT Soft Shadow");
 	{
-		UHGameTimerScope Scope("DispatchRTSoftShadow", false);
+		UH_TRACE_SCOPE("DispatchRTSoftShadow");
 		UHGPUTimeQueryScope TimeScope(RenderBuilder.GetCmdList(), GPUTimeQueries[UH_ENUM_VALUE(UHRenderPassTypes::SoftShadowPass)], "RTSoftShadowPass");
 
 		// soft shadow pass after ray tracing
@@ -288,7 +404,7 @@ void UHDeferredShadingRenderer::DispatchRayShadowPass(UHRenderBuilder& RenderBui
 
 void UHDeferredShadingRenderer::DispatchSmoothSceneNormalPass(UHRenderBuilder& RenderBuilder)
 {
-	UHGameTimerScope Scope("SmoothSceneNormalPass", false);
+	UH_TRACE_SCOPE("SmoothSceneNormalPass");
 	UHGPUTimeQueryScope TimeScope(RenderBuilder.GetCmdList(), GPUTimeQueries[UH_ENUM_VALUE(UHRenderPassTypes::SmoothSceneNormalPass)], "SmoothSceneNormalPass");
 
 	if (!RTParams.bEnableRayTracing || !RTParams.bEnableRTDenoise)
@@ -321,7 +437,7 @@ void UHDeferredShadingRenderer::DispatchSmoothSceneNormalPass(UHRenderBuilder& R
 
 void UHDeferredShadingRenderer::DispatchRaySkyLightPass(UHRenderBuilder& RenderBuilder)
 {
-	UHGameTimerScope Scope("RaySkyLightPass", false);
+	UH_TRACE_SCOPE("RaySkyLightPass");
 	UHGPUTimeQueryScope TimeScope(RenderBuilder.GetCmdList(), GPUTimeQueries[UH_ENUM_VALUE(UHRenderPassTypes::RayTracingSkyLight)], "RayTracingSkyLight");
 
 	GraphicInterface->BeginCmdDebug(RenderBuilder.GetCmdList(), "Dispatch Ray Sky Light");
@@ -348,98 +464,335 @@ void UHDeferredShadingRenderer::DispatchRaySkyLightPass(UHRenderBuilder& RenderB
 	GraphicInterface->EndCmdDebug(RenderBuilder.GetCmdList());
 }
 
+// the ray pressure goes up when RT shadow, RT reflection and RT indirect light exceed the budget, and goes down otherwise
+void UHDeferredShadingRenderer::UpdateRTRayBudget()
+{
+	const UHRenderingSettings& RenderingSettings = ConfigInterface->RenderingSetting();
+	if (!GEnableGPUTiming || !RenderingSettings.bEnableRTAdaptiveRays)
+	{
+		return;
+	}
+
+	float RTTime = 0.0f;
+	if (RenderingSettings.bEnableRTShadow)
+	{
+		RTTime += GPUTimeQueries[UH_ENUM_VALUE(UHRenderPassTypes::RayTracingShadow)]->GetLastTimeStamp();
+	}
+
+	if (RenderingSettings.bEnableRTReflection)
+	{
+		RTTime += GPUTimeQueries[UH_ENUM_VALUE(UHRenderPassTypes::RayTracingReflection)]->GetLastTimeStamp();
+	}
+
+	if (RenderingSettings.bEnableRTIndirectLighting)
+	{
+		RTTime += GPUTimeQueries[UH_ENUM_VALUE(UHRenderPassTypes::RayTracingIndirectLight)]->GetLastTimeStamp();
+	}
+
+	if (RTTime <= 0.0f)
+	{
+		return;
+	}
+
+	// move slowly, so the rates don't oscillate between frames
+	const float Budget = RenderingSettings.RTRayBudgetMS;
+	const float BudgetError = std::clamp((RTTime - Budget) / Budget, -1.0f, 1.0f);
+	RTRayPressure = std::clamp(RTRayPressure + BudgetError * 0.05f, 0.0f, 1.0f);
+}
+
+UHRTTileClassifyConstants UHDeferredShadingRenderer::GetRTTileClassifyConstants(UHRTTileClassifyType InType, VkExtent2D InTraceExtent, uint32_t InPixelStride) const
+{
+	UHRTTileClassifyConstants Consts{};
+	Consts.TraceResolution[0] = InTraceExtent.width;
+	Consts.TraceResolution[1] = InTraceExtent.height;
+	Consts.PixelStride = InPixelStride;
+	Consts.MaxTileCount = RTIndirectMaxTiles;
+	if (InType == UHRTTileClassifyType::Reflection)
+	{
+		Consts.MaxTileCount = RTReflectionMaxTiles;
+	}
+	else if (InType == UHRTTileClassifyType::Shadow)
+	{
+		Consts.MaxTileCount = RTShadowMaxTiles;
+	}
+	Consts.DepthEdgeThreshold = 0.1f;
+	Consts.CacheInvalidationCount = RTParams.RTCacheInvalidationCount;
+
+	// without adaptive rays, only the tiles that have nothing to trace are skipped
+	if (!RTParams.bEnableRTAdaptiveRays)
+	{
+		return Consts;
+	}
+
+	// rough reflections are lowered first and then the smoother ones, stable indirect light is refreshed less often as the pressure rises
+	const float Pressure = RTParams.RTRayPressure;
+	Consts.QuarterRateSmoothness = RTParams.RTReflectionSmoothCutoff + (1.0f - RTParams.RTReflectionSmoothCutoff) * Pressure * 0.6f;
+	Consts.StableMotionThreshold = 0.002f * Pressure;
+	Consts.RefreshInterval = (Pressure < 0.25f) ? 0 : 1 + static_cast<uint32_t>(std::round((Pressure - 0.25f) / 0.75f * 3.0f));
+
+	// shadow quads are visible without a temporal filter, they're lowered only after the other passes
+	Consts.bShadowQuarterRate = (InType == UHRTTileClassifyType::Shadow && Pressure >= 0.5f) ? 1 : 0;
+
+	return Consts;
+}
+
+// classify the tiles of a RT pass, the tile list and trace args are consumed by the following trace
+void UHDeferredShadingRenderer::DispatchRTTileClassify(UHRenderBuilder& RenderBuilder, UHRTTileClassifyShader* InShader, UHRenderBuffer<uint32_t>* InRayArgs
+	, const UHRTTileClassifyConstants& InConsts)
+{
+	// wait the previous trace and denoiser, then reset the trace args
+	RenderBuilder.GlobalBarrier(VK_ACCESS_2_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_2_SHADER_READ_BIT, VK_ACCESS_2_TRANSFER_WRITE_BIT | VK_ACCESS_2_SHADER_WRITE_BIT
+		, VK_PIPELINE_STAGE_2_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_2_RAY_TRACING_SHADER_BIT_KHR | VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT
+		, VK_PIPELINE_STAGE_2_TRANSFER_BIT | VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT);
+	RenderBuilder.ClearUAVBuffer(InRayArgs->GetBuffer(), 0);
+	RenderBuilder.GlobalBarrier(VK_ACCESS_2_TRANSFER_WRITE_BIT, VK_ACCESS_2_SHADER_READ_BIT | VK_ACCESS_2_SHADER_WRITE_BIT
+		, VK_PIPELINE_STAGE_2_TRANSFER_BIT, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT);
+
+	RenderBuilder.BindComputeState(InShader->GetComputeState());
+	RenderBuilder.BindDescriptorSetCompute(InShader->GetPipelineLayout(), InShader->GetDescriptorSet(CurrentFrameRT));
+	RenderBuilder.PushConstant(InShader->GetPipelineLayout(), VK_SHADER_STAGE_COMPUTE_BIT, InShader->GetPushConstantRange().size, &InConsts);
+	RenderBuilder.Dispatch(UHMathHelpers::RoundUpDivide(InConsts.TraceResolution[0], UHRTTileClassifyShader::TileSize)
+		, UHMathHelpers::RoundUpDivide(InConsts.TraceResolution[1], UHRTTileClassifyShader::TileSize), 1);
+
+	// args and tile lists are consumed by the trace, tile rates are consumed by the denoiser
+	RenderBuilder.GlobalBarrier(VK_ACCESS_2_SHADER_WRITE_BIT, VK_ACCESS_2_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_2_SHADER_READ_BIT
+		, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT
+		, VK_PIPELINE_STAGE_2_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_2_RAY_TRACING_SHADER_BIT_KHR | VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT);
+}
+
+// trace the full and quarter rate tiles
+void UHDeferredShadingRenderer::TraceRTTiles(UHRenderBuilder& RenderBuilder, UHShaderClass* InShader, UHRenderBuffer<uint32_t>* InRayArgs, uint32_t InTileCount)
+{
+	if (GraphicInterface->IsTraceRaysIndirectSupported())
+	{
+		RenderBuilder.TraceRayIndirect(InRayArgs->GetBuffer(), 0, InShader->GetRayGenTable(), InShader->GetMissTable(), InShader->GetHitGroupTable());
+		RenderBuilder.TraceRayIndirect(InRayArgs->GetBuffer(), UHRTTileClassifyShader::RayArgsStride
+			, InShader->GetRayGenTable(), InShader->GetMissTable(), InShader->GetHitGroupTable());
+	}
+	else
+	{
+		// trace all tiles in the worst case, the ray generation returns for the rays beyond the listed tiles
+		VkExtent2D TileExtent;
+		TileExtent.width = UHRTTileClassifyShader::TileSize * UHRTTileClassifyShader::TileSize;
+		TileExtent.height = InTileCount;
+		RenderBuilder.TraceRay(TileExtent, InShader->GetRayGenTable(), InShader->GetMissTable(), InShader->GetHitGroupTable());
+
+		TileExtent.width /= 4;
+		RenderBuilder.TraceRay(TileExtent, InShader->GetRayGenTable(), InShader->GetMissTable(), InShader->GetHitGroupTable());
+	}
+}
+
+// collect the world boxes that invalidate the cached RT shadow and reflection results, this runs on game thread
+// both the previous and the current bounds of dirty renderers and lights are added, and so is the range of the lights around dirty renderers
+// the cache is reset instead when the boxes can't describe the change, e.g. a directional light or a RT setting is changed
+void UHDeferredShadingRenderer::CollectRTCacheInvalidations()
+{
+	RTCacheInvalidationsCPU.clear();
+
+	const UHRenderingSettings& RenderingSettings = ConfigInterface->RenderingSetting();
+	if (!RenderingSettings.bEnableRTResultCache || GRTCacheInvalidationBuffer[CurrentFrameGT] == nullptr)
+	{
+		// bounds aren't tracked without the cache, they're recorded again when it's enabled
+		RTCacheBoundsGT.clear();
+		return;
+	}
+
+	const std::vector<UHPointLightComponent*>& PointLights = CurrentScene->GetPointLights();
+	const std::vector<UHSpotLightComponent*>& SpotLights = CurrentScene->GetSpotLights();
+
+	// the changes before the bounds are recorded are unknown
+	if (RTCacheBoundsGT.empty())
+	{
+		bResetRTCacheGT = true;
+		for (const UHMeshRendererComponent* Renderer : CurrentScene->GetAllRenderers())
+		{
+			RTCacheBoundsGT[Renderer] = Renderer->GetRendererBound();
+		}
+
+		for (const UHPointLightComponent* Light : PointLights)
+		{
+			RTCacheBoundsGT[Light] = GetLightRangeBound(Light->GetPosition(), Light->GetRadius());
+		}
+
+		for (const UHSpotLightComponent* Light : SpotLights)
+		{
+			RTCacheBoundsGT[Light] = GetLightRangeBound(Light->GetPosition(), Light->GetRadius());
+		}
+	}
+
+	// directional lights reach every pixel, and the settings change every result
+	const UHVector4 RTCacheSettings(RenderingSettings.RTShadowTMax, RenderingSettings.RTReflectionTMax
+		, RenderingSettings.RTReflectionSmoothCutoff, RenderingSettings.RTCullingRadius);
+	if (CurrentScene->GetDirtyDirLights().size() > 0 || RTCacheSettings != RTCacheSettingsGT)
+	{
+		bResetRTCacheGT = true;
+	}
+	RTCacheSettingsGT = RTCacheSettings;
+
+	auto AddComponentBound = [this](const UHTransformComponent* InComponent, const UHBoundingBox& InBound, uint32_t InFlags)
+		{
+			const auto It = RTCacheBoundsGT.find(InComponent);
+			if (It != RTCacheBoundsGT.end())
+			{
+				AddRTCacheInvalidation(RTCacheInvalidationsCPU, It->second, InFlags);
+			}
+			AddRTCacheInvalidation(RTCacheInvalidationsCPU, InBound, InFlags);
+			RTCacheBoundsGT[InComponent] = InBound;
+		};
+
+	// renderer boxes are also tested against the directional shadow rays on GPU
+	for (const UHMeshRendererComponent* Renderer : CurrentScene->GetDirtyRenderers())
+	{
+		AddComponentBound(Renderer, Renderer->GetRendererBound(), UH_ENUM_VALUE(UHRTCacheInvalidationBits::InvalidateRenderer));
+	}
+	const size_t RendererBoundCount = RTCacheInvalidationsCPU.size();
+
+	for (const UHPointLightComponent* Light : CurrentScene->GetDirtyPointLights())
+	{
+		AddComponentBound(Light, GetLightRangeBound(Light->GetPosition(), Light->GetRadius()), 0);
+	}
+
+	for (const UHSpotLightComponent* Light : CurrentScene->GetDirtySpotLights())
+	{
+		AddComponentBound(Light, GetLightRangeBound(Light->GetPosition(), Light->GetRadius()), 0);
+	}
+
+	// a renderer moving within the range of a light can change the shadow and lighting anywhere in the range
+	auto AddTouchedLight = [this, RendererBoundCount](const UHBoundingBox& InLightBound)
+		{
+			for (size_t Idx = 0; Idx < RendererBoundCount; Idx++)
+			{
+				const UHBoundingBox RendererBound(RTCacheInvalidationsCPU[Idx].Center, RTCacheInvalidationsCPU[Idx].Extents);
+				if (IsBoundOverlapped(RendererBound, InLightBound))
+				{
+					AddRTCacheInvalidation(RTCacheInvalidationsCPU, InLightBound, 0);
+					return;
+				}
+			}
+		};
+
+	if (RendererBoundCount > 0)
+	{
+		for (const UHPointLightComponent* Light : PointLights)
+		{
+			if (Light->IsEnabled())
+			{
+				AddTouchedLight(GetLightRangeBound(Light->GetPosition(), Light->GetRadius()));
+			}
+		}
+
+		for (const UHSpotLightComponent* Light : SpotLights)
+		{
+			if (Light->IsEnabled())
+			{
+				AddTouchedLight(GetLightRangeBound(Light->GetPosition(), Light->GetRadius()));
+			}
+		}
+	}
+
+	// too many changes in a frame, simply trace everything
+	if (bResetRTCacheGT || RTCacheInvalidationsCPU.size() > UHRTTileClassifyShader::MaxCacheInvalidations)
+	{
+		bResetRTCacheGT = true;
+		RTCacheInvalidationsCPU.clear();
+		return;
+	}
+
+	if (RTCacheInvalidationsCPU.size() > 0)
+	{
+		GRTCacheInvalidationBuffer[CurrentFrameGT]->UploadAllData(RTCacheInvalidationsCPU.data()
+			, RTCacheInvalidationsCPU.size() * sizeof(UHRTCacheInvalidation));
+	}
+}
+
 void UHDeferredShadingRenderer::DispatchRayIndirectLightPass(UHRenderBuilder& RenderBuilder)
 {
-	UHGameTimerScope Scope("RayIndirectLightPass", false);
+	UH_TRACE_SCOPE("RayIndirectLightPass");
 	UHGPUTimeQueryScope TimeScope(RenderBuilder.GetCmdList(), GPUTimeQueries[UH_ENUM_VALUE(UHRenderPassTypes::RayTracingIndirectLight)], "RayTracingIndirectLight");
 
 	GraphicInterface->BeginCmdDebug(RenderBuilder.GetCmdList(), "Dispatch Ray Indirect Light");
 
 	if (RTParams.bEnableRayTracing && RTInstanceCount > 0 && RTParams.bEnableRTIndirectLighting)
 	{
-		// transition resource to UAV ready
+		// transition resource to UAV ready, the histories are transitioned by the denoise passes
 		RenderBuilder.PushResourceBarrier(UHImageBarrier(GRTIndirectDiffuse, VK_IMAGE_LAYOUT_GENERAL));
-		RenderBuilder.PushResourceBarrier(UHImageBarrier(GRTIndirectDiffuseHistory, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL));
 		RenderBuilder.PushResourceBarrier(UHImageBarrier(GRTIndirectOcclusion, VK_IMAGE_LAYOUT_GENERAL));
-		RenderBuilder.PushResourceBarrier(UHImageBarrier(GRTIndirectOcclusionHistory, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL));
 		RenderBuilder.PushResourceBarrier(UHImageBarrier(GRTSkyData, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL));
+		RenderBuilder.PushResourceBarrier(UHImageBarrier(GRTIndirectTileRate, VK_IMAGE_LAYOUT_GENERAL));
 		RenderBuilder.FlushResourceBarrier();
 
+		// classify the tiles, the stable tiles are traced at lower rate and the denoiser reuses the history for the skipped tiles
+		// nothing is skipped until the history is built
+		UHRTTileClassifyConstants TileConsts = GetRTTileClassifyConstants(UHRTTileClassifyType::IndirectLight, RTIndirectLightExtent
+			, RenderResolution.width / RTIndirectLightExtent.width);
+		if (RTIndirectHistoryFrames < 2)
+		{
+			TileConsts.RefreshInterval = 0;
+			RTIndirectHistoryFrames++;
+		}
+		DispatchRTTileClassify(RenderBuilder, RTIndirectTileClassifyShader.get(), GRTIndirectRayArgs.get(), TileConsts);
+
 		// [0] is to bind the shader descriptor
 		RTDescriptorSets[CurrentFrameRT][0] = RTIndirectLightShader->GetDescriptorSet(CurrentFrameRT);
 		RenderBuilder.BindRTDescriptorSet(RTIndirectLightShader->GetPipelineLayout(), RTDescriptorSets[CurrentFrameRT]);
 		RenderBuilder.BindRTState(RTIndirectLightShader->GetRTState());
 
 		// trace the ray!
-		RenderBuilder.TraceRay(GRTIndirectDiffuse->GetExtent()
-			, RTIndirectLightShader->GetRayGenTable()
-			, RTIndirectLightShader->GetMissTable()
-			, RTIndirectLightShader->GetHitGroupTable());
+		TraceRTTiles(RenderBuilder, RTIndirectLightShader.get(), GRTIndirectRayArgs.get(), GetRTTileCount(RTIndirectLightExtent));
+	}
+	else
+	{
+		// the history isn't updated without the pass
+		RTIndirectHistoryFrames = 0;
+	}
 
-		// filtering for the indirect diffuse
-		{
-			// temporal accumulation
-			RenderBuilder.BindComputeState(RTDiffuseReprojectionShader->GetComputeState());
-			RTDiffuseReprojectionShader->BindParameters(RenderBuilder, GRTIndirectDiffuseHistory, GRTIndirectDiffuse, CurrentFrameRT);
-
-			// setup parameter
-			UHRTIndirectReprojectionConstants Consts;
-			Consts.Resolution[0] = RTIndirectLightExtent.width;
-			Consts.Resolution[1] = RTIndirectLightExtent.height;
-			Consts.AlphaMin = 0.05f;
-			Consts.AlphaMax = 0.2f;
-			RenderBuilder.PushConstant(RTDiffuseReprojectionShader->GetPipelineLayout(), VK_SHADER_STAGE_COMPUTE_BIT
-				, RTDiffuseReprojectionShader->GetPushConstantRange().size, &Consts);
-
-			// trigger a UAV barrier transition (RayGen -> Compute) and dispatch
-			RenderBuilder.ResourceBarrier(GRTIndirectDiffuse, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_GENERAL);
-			RenderBuilder.Dispatch(UHMathHelpers::RoundUpDivide(RTIndirectLightExtent.width, GThreadGroup2D_X)
-				, UHMathHelpers::RoundUpDivide(RTIndirectLightExtent.height, GThreadGroup2D_Y)
-				, 1);
+	GraphicInterface->EndCmdDebug(RenderBuilder.GetCmdList());
+}
 
-			// bilateral filtering for RT indirect diffuse
-			DispatchBilateralFilter(RenderBuilder, "Indirect Diffuse Bilateral Filter", GRTIndirectDiffuse, GRTIndirectDiffuse, RTIndirectDiffuseBFConsts);
-		}
+void UHDeferredShadingRenderer::DispatchRayIndirectDenoisePass(UHRenderBuilder& RenderBuilder, const std::string& InName, UHRTIndirectReprojectionShader* InShader
+	, UHRenderTexture* InTarget, UHRenderTexture* InHistory, float InAlphaMax, const UHBilateralFilterConstants& InBFConsts)
+{
+	if (!RTParams.bEnableRayTracing || RTInstanceCount == 0 || !RTParams.bEnableRTIndirectLighting)
+	{
+		return;
+	}
 
-		// filtering for the sky occlusion
-		{
-			// temporal accumulation
-			RenderBuilder.BindComputeState(RTSkyReprojectionShader->GetComputeState());
-			RTSkyReprojectionShader->BindParameters(RenderBuilder, GRTIndirectOcclusionHistory, GRTIndirectOcclusion, CurrentFrameRT);
-
-			// setup parameter
-			UHRTIndirectReprojectionConstants Consts;
-			Consts.Resolution[0] = RTIndirectLightExtent.width;
-			Consts.Resolution[1] = RTIndirectLightExtent.height;
-			Consts.AlphaMin = 0.05f;
-			Consts.AlphaMax = 0.5f;
-			RenderBuilder.PushConstant(RTSkyReprojectionShader->GetPipelineLayout(), VK_SHADER_STAGE_COMPUTE_BIT
-				, RTSkyReprojectionShader->GetPushConstantRange().size, &Consts);
-
-			// trigger a UAV barrier transition (RayGen -> Compute) and dispatch
-			RenderBuilder.ResourceBarrier(GRTIndirectOcclusion, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_GENERAL);
-			RenderBuilder.Dispatch(UHMathHelpers::RoundUpDivide(RTIndirectLightExtent.width, GThreadGroup2D_X)
-				, UHMathHelpers::RoundUpDivide(RTIndirectLightExtent.height, GThreadGroup2D_Y)
-				, 1);
+	UH_TRACE_SCOPE("RayIndirectDenoisePass");
+	GraphicInterface->BeginCmdDebug(RenderBuilder.GetCmdList(), InName + " Denoise");
 
-			// bilateral filtering for RT indirect occlusion
-			DispatchBilateralFilter(RenderBuilder, "Indirect Occlusion Bilateral Filter", GRTIndirectOcclusion, GRTIndirectOcclusion, RTIndirectOcclusionBFConsts);
-		}
+	RenderBuilder.PushResourceBarrier(UHImageBarrier(InTarget, VK_IMAGE_LAYOUT_GENERAL));
+	RenderBuilder.PushResourceBarrier(UHImageBarrier(InHistory, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL));
+	RenderBuilder.FlushResourceBarrier();
 
-		RenderBuilder.PushResourceBarrier(UHImageBarrier(GRTIndirectDiffuse, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL));
-		RenderBuilder.PushResourceBarrier(UHImageBarrier(GRTIndirectDiffuseHistory, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL));
-		RenderBuilder.PushResourceBarrier(UHImageBarrier(GRTIndirectOcclusion, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL));
-		RenderBuilder.PushResourceBarrier(UHImageBarrier(GRTIndirectOcclusionHistory, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL));
-		RenderBuilder.FlushResourceBarrier();
+	// temporal accumulation
+	RenderBuilder.BindComputeState(InShader->GetComputeState());
+	InShader->BindParameters(RenderBuilder, InHistory, InTarget, CurrentFrameRT);
 
-		// copy indirect occlusion history
-		RenderBuilder.CopyTexture(GRTIndirectDiffuse, GRTIndirectDiffuseHistory);
-		RenderBuilder.CopyTexture(GRTIndirectOcclusion, GRTIndirectOcclusionHistory);
+	// setup parameter
+	UHRTIndirectReprojectionConstants Consts;
+	Consts.Resolution[0] = RTIndirectLightExtent.width;
+	Consts.Resolution[1] = RTIndirectLightExtent.height;
+	Consts.AlphaMin = 0.05f;
+	Consts.AlphaMax = InAlphaMax;
+	RenderBuilder.PushConstant(InShader->GetPipelineLayout(), VK_SHADER_STAGE_COMPUTE_BIT, InShader->GetPushConstantRange().size, &Consts);
 
-		RenderBuilder.PushResourceBarrier(UHImageBarrier(GRTIndirectDiffuse, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL));
-		RenderBuilder.PushResourceBarrier(UHImageBarrier(GRTIndirectOcclusion, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL));
-		RenderBuilder.FlushResourceBarrier();
-	}
+	// trigger a UAV barrier transition (RayGen -> Compute) and dispatch
+	RenderBuilder.ResourceBarrier(InTarget, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_GENERAL);
+	RenderBuilder.Dispatch(UHMathHelpers::RoundUpDivide(RTIndirectLightExtent.width, GThreadGroup2D_X)
+		, UHMathHelpers::RoundUpDivide(RTIndirectLightExtent.height, GThreadGroup2D_Y)
+		, 1);
+
+	// bilateral filtering, the temps are transients of the scene graph
+	DispatchBilateralFilter(RenderBuilder, InName + " Bilateral Filter", InTarget, InTarget, InBFConsts);
+
+	// copy history
+	RenderBuilder.PushResourceBarrier(UHImageBarrier(InTarget, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL));
+	RenderBuilder.PushResourceBarrier(UHImageBarrier(InHistory, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL));
+	RenderBuilder.FlushResourceBarrier();
+	RenderBuilder.CopyTexture(InTarget, InHistory);
+
+	RenderBuilder.PushResourceBarrier(UHImageBarrier(InTarget, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL));
+	RenderBuilder.FlushResourceBarrier();
 
 	GraphicInterface->EndCmdDebug(RenderBuilder.GetCmdList());
 }
@@ -448,18 +801,41 @@ void UHDeferredShadingRenderer::DispatchRayReflectionPass(UHRenderBuilder& Rende
 {
 	if (!RTParams.bEnableRayTracing || RTInstanceCount == 0 || !RTParams.bEnableRTReflection)
 	{
+		RTReflectionCacheStride = 0;
 		return;
 	}
 
 	GraphicInterface->BeginCmdDebug(RenderBuilder.GetCmdList(), "Dispatch Ray Reflection");
 	{
-		UHGameTimerScope Scope("DispatchRayReflectionPass", false);
+		UH_TRACE_SCOPE("DispatchRayReflectionPass");
 		UHGPUTimeQueryScope TimeScope(RenderBuilder.GetCmdList(), GPUTimeQueries[UH_ENUM_VALUE(UHRenderPassTypes::RayTracingReflection)], "RayTracingReflection");
 
-		// clear and transition output buffer to VK_IMAGE_LAYOUT_GENERAL
-		RenderBuilder.ResourceBarrier(GRTReflectionResult, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
-		RenderBuilder.ClearRenderTexture(GRTReflectionResult, GTransparentClearColor);
-		RenderBuilder.ResourceBarrier(GRTReflectionResult, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_GENERAL);
+		const bool bHalfQuality = (RTParams.RTReflectionQuality == UH_ENUM_VALUE(UHRTReflectionQuality::RTReflection_Half));
+		const uint32_t PixelStride = bHalfQuality ? 2 : 1;
+		VkExtent2D TraceExtent = RenderResolution;
+		TraceExtent.width /= PixelStride;
+		TraceExtent.height /= PixelStride;
+
+		// the cached results are reused only if last frame was traced with the same stride, otherwise clear the output
+		const bool bCacheValid = RTParams.bEnableRTResultCache && !RTParams.bResetRTCache && RTReflectionCacheStride == PixelStride;
+		if (bCacheValid)
+		{
+			RenderBuilder.PushResourceBarrier(UHImageBarrier(GRTReflectionResult, VK_IMAGE_LAYOUT_GENERAL));
+			RenderBuilder.FlushResourceBarrier();
+		}
+		else
+		{
+			// clear and transition output buffer to VK_IMAGE_LAYOUT_GENERAL
+			RenderBuilder.ResourceBarrier(GRTReflectionResult, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+			RenderBuilder.ClearRenderTexture(GRTReflectionResult, GTransparentClearColor);
+			RenderBuilder.ResourceBarrier(GRTReflectionResult, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_GENERAL);
+		}
+
+		// classify the tiles, the tiles without smooth pixels are skipped and the rough tiles are traced at quarter rate
+		// the tiles with valid cached results keep the output of last frame
+		UHRTTileClassifyConstants TileConsts = GetRTTileClassifyConstants(UHRTTileClassifyType::Reflection, TraceExtent, PixelStride);
+		TileConsts.bCacheValid = bCacheValid ? 1 : 0;
+		DispatchRTTileClassify(RenderBuilder, RTReflectionTileClassifyShader.get(), GRTReflectionRayArgs.get(), TileConsts);
 
 		// bind descriptors and RT states
 		// [0] is to bind the shader descriptor, and prevent touching other elements. Not a typo!
@@ -473,13 +849,10 @@ void UHDeferredShadingRenderer::DispatchRayReflectionPass(UHRenderBuilder& Rende
 		Consts.OutputResolutionX = RenderResolution.width;
 		Consts.OutputResolutionY = RenderResolution.height;
 
-		if (RTParams.RTReflectionQuality == UH_ENUM_VALUE(UHRTReflectionQuality::RTReflection_Half))
+		TraceRTTiles(RenderBuilder, RTReflectionShader.get(), GRTReflectionRayArgs.get(), GetRTTileCount(TraceExtent));
+		RTReflectionCacheStride = RTParams.bEnableRTResultCache ? PixelStride : 0;
+		if (bHalfQuality)
 		{
-			VkExtent2D HalfRes = RenderResolution;
-			HalfRes.width >>= 1;
-			HalfRes.height >>= 1;
-			RenderBuilder.TraceRay(HalfRes, RTReflectionShader->GetRayGenTable(), RTReflectionShader->GetMissTable(), RTReflectionShader->GetHitGroupTable());
-
 			// ipsample after the half res tracing
 			RenderBuilder.BindComputeState(UpsampleNearest2x2Shader->GetComputeState());
 			UpsampleNearest2x2Shader->BindParameters(RenderBuilder, CurrentFrameRT, GRTReflectionResult, Consts);
@@ -490,17 +863,13 @@ void UHDeferredShadingRenderer::DispatchRayReflectionPass(UHRenderBuilder& Rende
 				, UHMathHelpers::RoundUpDivide(RenderResolution.height, GThreadGroup2D_Y)
 				, 1);
 		}
-		else
-		{
-			RenderBuilder.TraceRay(RenderResolution, RTReflectionShader->GetRayGenTable(), RTReflectionShader->GetMissTable(), RTReflectionShader->GetHitGroupTable());
-		}
 	}
 	GraphicInterface->EndCmdDebug(RenderBuilder.GetCmdList());
 
 	// generate mips with custom shader and blur the mips [2, Max]
 	GraphicInterface->BeginCmdDebug(RenderBuilder.GetCmdList(), "Dispatch Reflection Blur");
 	{
-		UHGameTimerScope Scope("DispatchReflectionBlur", false);
+		UH_TRACE_SCOPE("DispatchReflectionBlur");
 		UHGPUTimeQueryScope TimeScope(RenderBuilder.GetCmdList(), GPUTimeQueries[UH_ENUM_VALUE(UHRenderPassTypes::ReflectionBlurPass)], "ReflectionBlurPass");
 
 		RenderBuilder.BindComputeState(RTReflectionMipmapShader->GetComputeState());
@@ -2,7 +2,7 @@
 
 void UHDeferredShadingRenderer::PreReflectionPass(UHRenderBuilder& RenderBuilder)
 {
-	UHGameTimerScope Scope("PreReflectionPass", false);
+	UH_TRACE_SCOPE("PreReflectionPass");
 	if (CurrentScene == nullptr)
 	{
 		return;
@@ -23,7 +23,7 @@ void UHDeferredShadingRenderer::PreReflectionPass(UHRenderBuilder& RenderBuilder
 
 void UHDeferredShadingRenderer::DispatchReflectionPass(UHRenderBuilder& RenderBuilder)
 {
-	UHGameTimerScope Scope("DispatchReflectionPass", false);
+	UH_TRACE_SCOPE("DispatchReflectionPass");
 	// pass to draw reflection, this pass will mainly apply reflection to opaque scene
 	if (CurrentScene == nullptr)
 	{
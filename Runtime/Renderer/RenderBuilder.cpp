@@ -1,4 +1,5 @@
 #include "RenderBuilder.h"
+#include "RendererShared.h"
 
 UHRenderBuilder::UHRenderBuilder(UHGraphic* InGraphic, VkCommandBuffer InCommandBuffer, bool bIsComputeBuilder)
 	: Gfx(InGraphic)
@@ -11,10 +12,8 @@ UHRenderBuilder::UHRenderBuilder(UHGraphic* InGraphic, VkCommandBuffer InCommand
 	, PrevComputeState(nullptr)
 	, PrevVertexBuffer(nullptr)
 	, PrevIndexBufferSource(nullptr)
-#if WITH_EDITOR
 	, DrawCalls(0)
 	, OccludedCalls(0)
-#endif
 	, bNeedSetViewport(false)
 	, bNeedSetScissorRect(false)
 {
@@ -174,7 +173,10 @@ void UHRenderBuilder::ExecuteCmd(VkQueue InQueue, VkFence InFence, VkSemaphore I
 void UHRenderBuilder::ExecuteCmd(VkQueue InQueue, VkFence InFence
 	, const std::vector<VkSemaphore>& InWaitSemaphores
 	, const std::vector<VkPipelineStageFlags>& InWaitStageFlags
-	, VkSemaphore InFinishSemaphore)
+	, VkSemaphore InFinishSemaphore
+	, VkSemaphore InTimelineSemaphore
+	, uint64_t InTimelineValue
+	, const std::vector<uint64_t>& InWaitValues)
 {
 	// summit to queue
 	VkSubmitInfo SubmitInfo{};
@@ -191,11 +193,40 @@ void UHRenderBuilder::ExecuteCmd(VkQueue InQueue, VkFence InFence
 	SubmitInfo.commandBufferCount = 1;
 	SubmitInfo.pCommandBuffers = &CmdList;
 
-	// the signal after finish
+	// the signal after finish, the binary semaphore ignores the value
+	std::vector<VkSemaphore> SignalSemaphores;
+	std::vector<uint64_t> SignalValues;
 	if (InFinishSemaphore != nullptr)
 	{
-		SubmitInfo.signalSemaphoreCount = 1;
-		SubmitInfo.pSignalSemaphores = &InFinishSemaphore;
+		SignalSemaphores.push_back(InFinishSemaphore);
+		SignalValues.push_back(0);
+	}
+
+	// also signal the timeline value if there is one
+	VkTimelineSemaphoreSubmitInfo TimelineInfo{};
+	TimelineInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+	if (InTimelineSemaphore != nullptr)
+	{
+		SignalSemaphores.push_back(InTimelineSemaphore);
+		SignalValues.push_back(InTimelineValue);
+
+		TimelineInfo.signalSemaphoreValueCount = static_cast<uint32_t>(SignalValues.size());
+		TimelineInfo.pSignalSemaphoreValues = SignalValues.data();
+		SubmitInfo.pNext = &TimelineInfo;
+	}
+
+	// wait values for timeline semaphores, one per wait semaphore and 0 for binary ones
+	if (InWaitValues.size() > 0 && InWaitValues.size() == InWaitSemaphores.size())
+	{
+		TimelineInfo.waitSemaphoreValueCount = static_cast<uint32_t>(InWaitValues.size());
+		TimelineInfo.pWaitSemaphoreValues = InWaitValues.data();
+		SubmitInfo.pNext = &TimelineInfo;
+	}
+
+	if (SignalSemaphores.size() > 0)
+	{
+		SubmitInfo.signalSemaphoreCount = static_cast<uint32_t>(SignalSemaphores.size());
+		SubmitInfo.pSignalSemaphores = SignalSemaphores.data();
 	}
 
 	// similar to D3D12CommandQueue::Execute()
@@ -350,17 +381,21 @@ void UHRenderBuilder::DrawVertex(uint32_t VertexCount)
 {
 	vkCmdDraw(CmdList, VertexCount, 1, 0, 0);
 
-#if WITH_EDITOR
 	DrawCalls++;
-#endif
+}
+
+void UHRenderBuilder::DrawIndirect(VkBuffer InArgsBuffer, VkDeviceSize InOffset)
+{
+	vkCmdDrawIndirect(CmdList, InArgsBuffer, InOffset, 1, sizeof(VkDrawIndirectCommand));
+
+	DrawCalls++;
 }
 
 // draw indexed
-void UHRenderBuilder::DrawIndexed(uint32_t IndicesCount, bool bOcclusionTest)
+void UHRenderBuilder::DrawIndexed(uint32_t IndicesCount, uint32_t FirstInstance, bool bOcclusionTest)
 {
-	vkCmdDrawIndexed(CmdList, IndicesCount, 1, 0, 0, 0);
+	vkCmdDrawIndexed(CmdList, IndicesCount, 1, 0, 0, FirstInstance);
 
-#if WITH_EDITOR
 	if (bOcclusionTest)
 	{
 		OccludedCalls++;
@@ -369,7 +404,6 @@ void UHRenderBuilder::DrawIndexed(uint32_t IndicesCount, bool bOcclusionTest)
 	{
 		DrawCalls++;
 	}
-#endif
 }
 
 void UHRenderBuilder::BindDescriptorSet(VkPipelineLayout InLayout, VkDescriptorSet InSet)
@@ -387,6 +421,20 @@ void UHRenderBuilder::BindDescriptorSetCompute(VkPipelineLayout InLayout, VkDesc
 	vkCmdBindDescriptorSets(CmdList, VK_PIPELINE_BIND_POINT_COMPUTE, InLayout, 0, 1, &InSet, 0, nullptr);
 }
 
+void UHRenderBuilder::BindMaterialArena(const UHShaderClass* InShader, int32_t InFrameIdx)
+{
+	const UHMaterial* Mat = InShader->GetMaterialCache();
+	VkDescriptorSet ArenaSet = GMaterialArena.GetDescriptorSet(InFrameIdx);
+	if (Mat == nullptr || ArenaSet == nullptr || InShader->GetMaterialArenaSet() == UHINDEXNONE)
+	{
+		return;
+	}
+
+	const uint32_t DynamicOffset = GMaterialArena.GetDynamicOffset(Mat->GetBufferDataIndex());
+	vkCmdBindDescriptorSets(CmdList, VK_PIPELINE_BIND_POINT_GRAPHICS, InShader->GetPipelineLayout()
+		, static_cast<uint32_t>(InShader->GetMaterialArenaSet()), 1, &ArenaSet, 1, &DynamicOffset);
+}
+
 void UHRenderBuilder::BindRTDescriptorSet(VkPipelineLayout InLayout, const std::vector<VkDescriptorSet>& InSets)
 {
 	vkCmdBindDescriptorSets(CmdList, VK_PIPELINE_BIND_POINT_RAY_TRACING_KHR, InLayout, 0, static_cast<uint32_t>(InSets.size()), InSets.data(), 0, nullptr);
@@ -485,6 +533,30 @@ void UHRenderBuilder::ResourceBarrier(std::vector<UHTexture*> InTextures, VkImag
 		static_cast<uint32_t>(Barriers.size()), Barriers.data());
 }
 
+// ResourceBarrier: Single texture with a mip range and explicit stages
+void UHRenderBuilder::ResourceBarrier(UHTexture* InTexture, VkImageLayout OldLayout, VkImageLayout NewLayout, VkPipelineStageFlags SrcStage, VkPipelineStageFlags DstStage
+	, uint32_t BaseMipLevel, uint32_t MipCount)
+{
+	if (InTexture == nullptr || MipCount == 0)
+	{
+		return;
+	}
+
+	std::vector<VkImageMemoryBarrier> Barriers(MipCount);
+	for (uint32_t Mdx = 0; Mdx < MipCount; Mdx++)
+	{
+		Barriers[Mdx] = SetupBarrier(InTexture, OldLayout, NewLayout, BaseMipLevel + Mdx, 0);
+	}
+
+	vkCmdPipelineBarrier(
+		CmdList,
+		SrcStage, DstStage,
+		0,
+		0, nullptr,
+		0, nullptr,
+		static_cast<uint32_t>(Barriers.size()), Barriers.data());
+}
+
 void UHRenderBuilder::ResourceBarrier(VkBuffer InBuffer, const uint64_t BufferSize
 	, VkAccessFlagBits SrcAccess, VkAccessFlagBits DstAccess, VkPipelineStageFlags SrcStage, VkPipelineStageFlags DstStage)
 {
@@ -575,6 +647,119 @@ void UHRenderBuilder::FlushResourceBarrier()
 	ImageBarriers.clear();
 }
 
+void UHRenderBuilder::QueueOwnershipBarrier(UHTexture* InTexture, uint32_t SrcQueueFamily, uint32_t DstQueueFamily, bool bIsRelease)
+{
+	if (InTexture == nullptr || SrcQueueFamily == DstQueueFamily)
+	{
+		return;
+	}
+
+	// transfer every mip with its own layout, the content of undefined mips doesn't need to be kept
+	const VkImageViewCreateInfo ImageViewInfo = InTexture->GetImageViewInfo();
+	std::vector<VkImageMemoryBarrier2> Barriers;
+	for (uint32_t Mdx = 0; Mdx < InTexture->GetMipMapCount(); Mdx++)
+	{
+		const VkImageLayout Layout = InTexture->GetImageLayout(Mdx);
+		if (Layout == VK_IMAGE_LAYOUT_UNDEFINED)
+		{
+			continue;
+		}
+
+		// release only makes the writes available, and acquire makes them visible
+		VkImageMemoryBarrier2 Barrier{};
+		Barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2;
+		Barrier.oldLayout = Layout;
+		Barrier.newLayout = Layout;
+		Barrier.srcStageMask = (bIsRelease) ? VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT : VK_PIPELINE_STAGE_2_NONE;
+		Barrier.srcAccessMask = (bIsRelease) ? VK_ACCESS_2_MEMORY_WRITE_BIT : VK_ACCESS_2_NONE;
+		Barrier.dstStageMask = (bIsRelease) ? VK_PIPELINE_STAGE_2_NONE : VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT;
+		Barrier.dstAccessMask = (bIsRelease) ? VK_ACCESS_2_NONE : VK_ACCESS_2_MEMORY_READ_BIT | VK_ACCESS_2_MEMORY_WRITE_BIT;
+		Barrier.srcQueueFamilyIndex = SrcQueueFamily;
+		Barrier.dstQueueFamilyIndex = DstQueueFamily;
+		Barrier.image = InTexture->GetImage();
+		Barrier.subresourceRange = ImageViewInfo.subresourceRange;
+		Barrier.subresourceRange.baseMipLevel = Mdx;
+		Barrier.subresourceRange.levelCount = 1;
+		Barrier.subresourceRange.baseArrayLayer = 0;
+		Barrier.subresourceRange.layerCount = VK_REMAINING_ARRAY_LAYERS;
+		Barriers.push_back(Barrier);
+	}
+
+	if (Barriers.size() == 0)
+	{
+		return;
+	}
+
+	VkDependencyInfo DependencyInfo{};
+	DependencyInfo.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO;
+	DependencyInfo.imageMemoryBarrierCount = static_cast<uint32_t>(Barriers.size());
+	DependencyInfo.pImageMemoryBarriers = Barriers.data();
+	vkCmdPipelineBarrier2(CmdList, &DependencyInfo);
+}
+
+void UHRenderBuilder::AliasingBarrier(UHTexture* InTexture, VkImageLayout InNewLayout, VkPipelineStageFlags2 SrcStages, VkAccessFlags2 SrcAccess)
+{
+	if (InTexture == nullptr)
+	{
+		return;
+	}
+
+	VkMemoryBarrier2 MemoryBarrier{};
+	MemoryBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER_2;
+	MemoryBarrier.srcStageMask = SrcStages;
+	MemoryBarrier.srcAccessMask = SrcAccess;
+	MemoryBarrier.dstStageMask = LayoutToStageFlags[InNewLayout];
+	MemoryBarrier.dstAccessMask = LayoutToAccessFlags[InNewLayout];
+
+	const VkImageViewCreateInfo ImageViewInfo = InTexture->GetImageViewInfo();
+	std::vector<VkImageMemoryBarrier2> Barriers(InTexture->GetMipMapCount());
+	for (uint32_t Mdx = 0; Mdx < InTexture->GetMipMapCount(); Mdx++)
+	{
+		VkImageMemoryBarrier2& Barrier = Barriers[Mdx];
+		Barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2;
+		Barrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+		Barrier.newLayout = InNewLayout;
+		Barrier.srcStageMask = SrcStages;
+		Barrier.srcAccessMask = SrcAccess;
+		Barrier.dstStageMask = MemoryBarrier.dstStageMask;
+		Barrier.dstAccessMask = MemoryBarrier.dstAccessMask;
+		Barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		Barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		Barrier.image = InTexture->GetImage();
+		Barrier.subresourceRange = ImageViewInfo.subresourceRange;
+		Barrier.subresourceRange.baseMipLevel = Mdx;
+		Barrier.subresourceRange.levelCount = 1;
+		Barrier.subresourceRange.baseArrayLayer = 0;
+		Barrier.subresourceRange.layerCount = VK_REMAINING_ARRAY_LAYERS;
+
+		InTexture->SetImageLayout(InNewLayout, Mdx);
+	}
+
+	VkDependencyInfo DependencyInfo{};
+	DependencyInfo.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO;
+	DependencyInfo.memoryBarrierCount = 1;
+	DependencyInfo.pMemoryBarriers = &MemoryBarrier;
+	DependencyInfo.imageMemoryBarrierCount = static_cast<uint32_t>(Barriers.size());
+	DependencyInfo.pImageMemoryBarriers = Barriers.data();
+	vkCmdPipelineBarrier2(CmdList, &DependencyInfo);
+}
+
+void UHRenderBuilder::GlobalBarrier(VkAccessFlags2 SrcAccess, VkAccessFlags2 DstAccess, VkPipelineStageFlags2 SrcStage, VkPipelineStageFlags2 DstStage)
+{
+	VkMemoryBarrier2 Barrier{};
+	Barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER_2;
+	Barrier.srcAccessMask = SrcAccess;
+	Barrier.dstAccessMask = DstAccess;
+	Barrier.srcStageMask = SrcStage;
+	Barrier.dstStageMask = DstStage;
+
+	VkDependencyInfo DependencyInfo{};
+	DependencyInfo.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO;
+	DependencyInfo.memoryBarrierCount = 1;
+	DependencyInfo.pMemoryBarriers = &Barrier;
+	vkCmdPipelineBarrier2(CmdList, &DependencyInfo);
+}
+
 void UHRenderBuilder::Blit(UHTexture* SrcImage, UHTexture* DstImage, VkFilter InFilter)
 {
 	Blit(SrcImage, DstImage, SrcImage->GetExtent(), DstImage->GetExtent(), 0, 0, InFilter);
@@ -630,10 +815,8 @@ void UHRenderBuilder::Blit(UHTexture* SrcImage, UHTexture* DstImage, VkExtent2D
 	vkCmdBlitImage(CmdList, SrcImage->GetImage(), VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, DstImage->GetImage(), VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL
 		, 1, &BlitInfo, InFilter);
 
-#if WITH_EDITOR
 	// vkCmdBlitImage should be a kind of draw call, add to profile 
 	DrawCalls++;
-#endif
 }
 
 // blit with custom extent
@@ -685,10 +868,8 @@ void UHRenderBuilder::Blit(UHTexture* SrcImage, UHTexture* DstImage, VkExtent2D
 	vkCmdBlitImage(CmdList, SrcImage->GetImage(), VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, DstImage->GetImage(), VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL
 		, 1, &BlitInfo, InFilter);
 
-#if WITH_EDITOR
 	// vkCmdBlitImage should be a kind of draw call, add to profile 
 	DrawCalls++;
-#endif
 }
 
 void UHRenderBuilder::CopyTexture(UHTexture* SrcImage, UHTexture* DstImage, uint32_t MipLevel, uint32_t DstArray, uint32_t SrcArray)
@@ -738,9 +919,7 @@ void UHRenderBuilder::DrawFullScreenQuad()
 	// simply draw 6 vertices, post process shader will setup with SV_VertexID
 	vkCmdDraw(CmdList, 6, 1, 0, 0);
 
-#if WITH_EDITOR
 	DrawCalls++;
-#endif
 }
 
 VkDeviceAddress GetDeviceAddress(VkDevice InDevice, VkBuffer InBuffer)
@@ -752,28 +931,47 @@ VkDeviceAddress GetDeviceAddress(VkDevice InDevice, VkBuffer InBuffer)
 	return vkGetBufferDeviceAddress(InDevice, &AddressInfo);
 }
 
+static void GetShaderTableAddresses(VkDevice InDevice, UHRenderBuffer<UHShaderRecord>* InRayGenTable, UHRenderBuffer<UHShaderRecord>* InMissTable
+	, UHRenderBuffer<UHShaderRecord>* InHitGroupTable, VkStridedDeviceAddressRegionKHR& OutRayGen, VkStridedDeviceAddressRegionKHR& OutMiss
+	, VkStridedDeviceAddressRegionKHR& OutHitGroup)
+{
+	OutRayGen.deviceAddress = GetDeviceAddress(InDevice, InRayGenTable->GetBuffer());
+	OutRayGen.size = InRayGenTable->GetBufferSize();
+	OutRayGen.stride = OutRayGen.size;
+
+	OutMiss.deviceAddress = GetDeviceAddress(InDevice, InMissTable->GetBuffer());
+	OutMiss.size = InMissTable->GetBufferSize();
+	OutMiss.stride = OutMiss.size;
+
+	OutHitGroup.deviceAddress = GetDeviceAddress(InDevice, InHitGroupTable->GetBuffer());
+	OutHitGroup.size = InHitGroupTable->GetBufferSize();
+	OutHitGroup.stride = InHitGroupTable->GetBufferStride();
+}
+
 void UHRenderBuilder::TraceRay(VkExtent2D InExtent, UHRenderBuffer<UHShaderRecord>* InRayGenTable, UHRenderBuffer<UHShaderRecord>* InMissTable
 	, UHRenderBuffer<UHShaderRecord>* InHitGroupTable, const uint32_t InSlices)
 {
 	VkStridedDeviceAddressRegionKHR RayGenAddress{};
-	RayGenAddress.deviceAddress = GetDeviceAddress(LogicalDevice, InRayGenTable->GetBuffer());
-	RayGenAddress.size = InRayGenTable->GetBufferSize();
-	RayGenAddress.stride = RayGenAddress.size;
-
 	VkStridedDeviceAddressRegionKHR MissAddress{};
-	MissAddress.deviceAddress = GetDeviceAddress(LogicalDevice, InMissTable->GetBuffer());
-	MissAddress.size = InMissTable->GetBufferSize();
-	MissAddress.stride = MissAddress.size;
-
 	VkStridedDeviceAddressRegionKHR HitGroupAddress{};
-	HitGroupAddress.deviceAddress = GetDeviceAddress(LogicalDevice, InHitGroupTable->GetBuffer());
-	HitGroupAddress.size = InHitGroupTable->GetBufferSize();
-	HitGroupAddress.stride = InHitGroupTable->GetBufferStride();
+	GetShaderTableAddresses(LogicalDevice, InRayGenTable, InMissTable, InHitGroupTable, RayGenAddress, MissAddress, HitGroupAddress);
 
 	VkStridedDeviceAddressRegionKHR NullAddress{};
 	GVkCmdTraceRaysKHR(CmdList, &RayGenAddress, &MissAddress, &HitGroupAddress, &NullAddress, InExtent.width, InExtent.height, InSlices);
 }
 
+void UHRenderBuilder::TraceRayIndirect(VkBuffer InArgsBuffer, uint64_t InOffset, UHRenderBuffer<UHShaderRecord>* InRayGenTable
+	, UHRenderBuffer<UHShaderRecord>* InMissTable, UHRenderBuffer<UHShaderRecord>* InHitGroupTable)
+{
+	VkStridedDeviceAddressRegionKHR RayGenAddress{};
+	VkStridedDeviceAddressRegionKHR MissAddress{};
+	VkStridedDeviceAddressRegionKHR HitGroupAddress{};
+	GetShaderTableAddresses(LogicalDevice, InRayGenTable, InMissTable, InHitGroupTable, RayGenAddress, MissAddress, HitGroupAddress);
+
+	VkStridedDeviceAddressRegionKHR NullAddress{};
+	GVkCmdTraceRaysIndirectKHR(CmdList, &RayGenAddress, &MissAddress, &HitGroupAddress, &NullAddress, GetDeviceAddress(LogicalDevice, InArgsBuffer) + InOffset);
+}
+
 void UHRenderBuilder::WriteTimeStamp(VkQueryPool InPool, uint32_t InQuery)
 {
 #if WITH_EDITOR
@@ -827,9 +1025,7 @@ void UHRenderBuilder::Dispatch(uint32_t Gx, uint32_t Gy, uint32_t Gz)
 void UHRenderBuilder::DispatchMesh(uint32_t Gx, uint32_t Gy, uint32_t Gz)
 {
 	GVkCmdDrawMeshTasksEXT(CmdList, Gx, Gy, Gz);
-#if WITH_EDITOR
 	DrawCalls++;
-#endif
 }
 
 // occlusion query functions
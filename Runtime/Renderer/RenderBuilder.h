@@ -65,7 +65,10 @@ public:
 	void ExecuteCmd(VkQueue InQueue, VkFence InFence
 		, const std::vector<VkSemaphore>& InWaitSemaphores
 		, const std::vector<VkPipelineStageFlags>& InWaitStageFlags
-		, VkSemaphore InFinishSemaphore);
+		, VkSemaphore InFinishSemaphore
+		, VkSemaphore InTimelineSemaphore = nullptr
+		, uint64_t InTimelineValue = 0
+		, const std::vector<uint64_t>& InWaitValues = {});
 
 	// present to swap chain
 	bool Present(VkSwapchainKHR InSwapChain, VkQueue InQueue, VkSemaphore InFinishSemaphore, uint32_t InImageIdx);
@@ -90,19 +93,28 @@ public:
 	// draw
 	void DrawVertex(uint32_t VertexCount);
 
-	// draw index
-	void DrawIndexed(uint32_t IndicesCount, bool bOcclusionTest = false);
+	// draw index, first instance is used for fetching object constants in shader
+	void DrawIndexed(uint32_t IndicesCount, uint32_t FirstInstance = 0, bool bOcclusionTest = false);
+
+	// draw with the arguments written by GPU
+	void DrawIndirect(VkBuffer InArgsBuffer, VkDeviceSize InOffset);
 
 	// bind descriptors
 	void BindDescriptorSet(VkPipelineLayout InLayout, VkDescriptorSet InSet);
 	void BindDescriptorSet(VkPipelineLayout InLayout, const std::vector<VkDescriptorSet>& InSets, uint32_t FirstSet = 0);
 	void BindDescriptorSetCompute(VkPipelineLayout InLayout, VkDescriptorSet InSet);
+
+	// bind the material arena set of a material shader, the dynamic offset selects the block of its material
+	void BindMaterialArena(const UHShaderClass* InShader, int32_t InFrameIdx);
 	void BindRTDescriptorSet(VkPipelineLayout InLayout, const std::vector<VkDescriptorSet>& InSets);
 
 	// transition image
 	void ResourceBarrier(UHTexture* InTexture, VkImageLayout OldLayout, VkImageLayout NewLayout, uint32_t BaseMipLevel = 0, uint32_t BaseArrayLayer = 0);
 	void ResourceBarrier(std::vector<UHRenderTexture*> InTextures, VkImageLayout OldLayout, VkImageLayout NewLayout, uint32_t BaseMipLevel = 0, uint32_t BaseArrayLayer = 0);
 	void ResourceBarrier(std::vector<UHTexture*> InTextures, VkImageLayout OldLayout, VkImageLayout NewLayout, uint32_t BaseMipLevel = 0, uint32_t BaseArrayLayer = 0);
+	// transition image with explicit stages, for the stages that can't be derived from layout (e.g. task shader reads)
+	void ResourceBarrier(UHTexture* InTexture, VkImageLayout OldLayout, VkImageLayout NewLayout, VkPipelineStageFlags SrcStage, VkPipelineStageFlags DstStage
+		, uint32_t BaseMipLevel, uint32_t MipCount);
 
 	// transition buffer
 	void ResourceBarrier(VkBuffer InBuffer, const uint64_t BufferSize
@@ -111,6 +123,17 @@ public:
 	void PushResourceBarrier(const UHImageBarrier InBarrier);
 	void FlushResourceBarrier();
 
+	// release or acquire the ownership of an exclusive texture between queue families, the layout is kept
+	// the same barrier must be recorded on both queues, the release first
+	void QueueOwnershipBarrier(UHTexture* InTexture, uint32_t SrcQueueFamily, uint32_t DstQueueFamily, bool bIsRelease);
+
+	// discard the content of an aliased texture and transition all its mips to the new layout
+	// the previous alias is another image in the same memory, so a memory barrier waits for its accesses in the given src scope
+	void AliasingBarrier(UHTexture* InTexture, VkImageLayout InNewLayout, VkPipelineStageFlags2 SrcStages, VkAccessFlags2 SrcAccess);
+
+	// memory barrier for all resources, used for the work submitted earlier on the same queue
+	void GlobalBarrier(VkAccessFlags2 SrcAccess, VkAccessFlags2 DstAccess, VkPipelineStageFlags2 SrcStage, VkPipelineStageFlags2 DstStage);
+
 	// blit image
 	void Blit(UHTexture* SrcImage, UHTexture* DstImage, VkFilter InFilter = VK_FILTER_LINEAR);
 	void Blit(UHTexture* SrcImage, UHTexture* DstImage, VkExtent2D SrcExtent, VkExtent2D DstExtent, VkExtent2D DstOffset, VkFilter InFilter = VK_FILTER_LINEAR);
@@ -126,6 +149,10 @@ public:
 	void TraceRay(VkExtent2D InExtent, UHRenderBuffer<UHShaderRecord>* InRayGenTable, UHRenderBuffer<UHShaderRecord>* InMissTable, UHRenderBuffer<UHShaderRecord>* InHitGroupTable
 		, const uint32_t InSlices = 1);
 
+	// trace ray with the dimension stored in a VkTraceRaysIndirectCommandKHR of the args buffer
+	void TraceRayIndirect(VkBuffer InArgsBuffer, uint64_t InOffset, UHRenderBuffer<UHShaderRecord>* InRayGenTable, UHRenderBuffer<UHShaderRecord>* InMissTable
+		, UHRenderBuffer<UHShaderRecord>* InHitGroupTable);
+
 	// write time stamp
 	void WriteTimeStamp(VkQueryPool InPool, uint32_t InQuery);
 
@@ -156,10 +183,9 @@ public:
 	void PushConstant(VkPipelineLayout InPipelineLayout, VkShaderStageFlags InShaderStageFlag, uint32_t InDataSize
 		, const void* Data);
 
-#if WITH_EDITOR
+	// draw call counters for statistics
 	int32_t DrawCalls;
 	int32_t OccludedCalls;
-#endif
 
 private:
 	VkImageMemoryBarrier SetupBarrier(UHTexture* InTexture, VkImageLayout OldLayout, VkImageLayout NewLayout
@@ -0,0 +1,801 @@
+#include "RenderGraph.h"
+#include <algorithm>
+#include "RenderBuilder.h"
+#include "../Engine/TraceProfiler.h"
+
+static uint64_t AlignUp(uint64_t InValue, uint64_t InAlignment)
+{
+	return (InAlignment > 1) ? (InValue + InAlignment - 1) / InAlignment * InAlignment : InValue;
+}
+
+static void AddUnique(std::vector<UHRenderGraphResource>& OutResources, UHRenderGraphResource InResource)
+{
+	if (std::find(OutResources.begin(), OutResources.end(), InResource) == OutResources.end())
+	{
+		OutResources.push_back(InResource);
+	}
+}
+
+// stages and accesses of a use in the given layout, anything unknown falls back to all commands and memory accesses
+static void AppendLayoutScope(VkImageLayout InLayout, UHRenderGraphQueue InQueue, VkPipelineStageFlags2& OutStages, VkAccessFlags2& OutAccess)
+{
+	// graphic stages can't be used in the barriers on async compute queue
+	const VkPipelineStageFlags2 ShaderStages = (InQueue == UHRenderGraphQueue::AsyncCompute)
+		? VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_2_RAY_TRACING_SHADER_BIT_KHR
+		: VK_PIPELINE_STAGE_2_ALL_GRAPHICS_BIT | VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_2_RAY_TRACING_SHADER_BIT_KHR;
+
+	switch (InLayout)
+	{
+	case VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL:
+		OutStages |= VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT;
+		OutAccess |= VK_ACCESS_2_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT;
+		break;
+	case VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL:
+	case VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL:
+		OutStages |= VK_PIPELINE_STAGE_2_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_2_LATE_FRAGMENT_TESTS_BIT;
+		OutAccess |= VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+		break;
+	case VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL:
+		OutStages |= ShaderStages;
+		OutAccess |= VK_ACCESS_2_SHADER_READ_BIT;
+		break;
+	case VK_IMAGE_LAYOUT_GENERAL:
+		OutStages |= ShaderStages;
+		OutAccess |= VK_ACCESS_2_SHADER_READ_BIT | VK_ACCESS_2_SHADER_WRITE_BIT;
+		break;
+	case VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL:
+		OutStages |= VK_PIPELINE_STAGE_2_ALL_TRANSFER_BIT;
+		OutAccess |= VK_ACCESS_2_TRANSFER_READ_BIT;
+		break;
+	case VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL:
+		OutStages |= VK_PIPELINE_STAGE_2_ALL_TRANSFER_BIT;
+		OutAccess |= VK_ACCESS_2_TRANSFER_WRITE_BIT;
+		break;
+	default:
+		OutStages |= VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT;
+		OutAccess |= VK_ACCESS_2_MEMORY_READ_BIT | VK_ACCESS_2_MEMORY_WRITE_BIT;
+		break;
+	}
+}
+
+UHRenderGraph::UHRenderGraph()
+	: TransientHeapSize(0)
+	, bIsCompiled(false)
+{
+	QueueFamilies.fill(0);
+}
+
+void UHRenderGraph::Reset()
+{
+	Passes.clear();
+	Textures.clear();
+	Batches.clear();
+	TransientHeapSize = 0;
+	bIsCompiled = false;
+}
+
+UHRenderGraphResource UHRenderGraph::ImportTexture(std::string InName, UHTexture* InTexture, VkImageLayout InInitialLayout, bool bIsOutput)
+{
+	UHRenderGraphTexture NewTexture{};
+	NewTexture.Name = InName;
+	NewTexture.Texture = InTexture;
+	NewTexture.InitialLayout = InInitialLayout;
+	NewTexture.bIsOutput = bIsOutput;
+	NewTexture.bIsTransient = false;
+	NewTexture.bIsSharedAcrossQueues = false;
+	NewTexture.Size = 0;
+	NewTexture.Alignment = 1;
+	NewTexture.FirstPass = UHINDEXNONE;
+	NewTexture.LastPass = UHINDEXNONE;
+	NewTexture.Offset = ~0;
+	NewTexture.AliasSrcStages = VK_PIPELINE_STAGE_2_NONE;
+	NewTexture.AliasSrcAccess = VK_ACCESS_2_NONE;
+
+	Textures.push_back(NewTexture);
+	bIsCompiled = false;
+	return static_cast<UHRenderGraphResource>(Textures.size() - 1);
+}
+
+UHRenderGraphResource UHRenderGraph::CreateTransientTexture(std::string InName, uint64_t InSize, uint64_t InAlignment)
+{
+	// transient content is always discarded, so it starts from undefined layout
+	UHRenderGraphResource NewResource = ImportTexture(InName, nullptr, VK_IMAGE_LAYOUT_UNDEFINED);
+	Textures[NewResource].bIsTransient = true;
+	Textures[NewResource].Size = InSize;
+	Textures[NewResource].Alignment = (std::max)(InAlignment, static_cast<uint64_t>(1));
+	return NewResource;
+}
+
+void UHRenderGraph::SetTransientTexture(UHRenderGraphResource InResource, UHTexture* InTexture)
+{
+	if (!IsValidResource(InResource) || !Textures[InResource].bIsTransient)
+	{
+		return;
+	}
+
+	Textures[InResource].Texture = InTexture;
+}
+
+int32_t UHRenderGraph::AddPass(std::string InName, UHRenderGraphPassFunc InFunc, bool bHasSideEffect)
+{
+	UHRenderGraphPass NewPass{};
+	NewPass.Name = InName;
+	NewPass.Func = UHMOVE(InFunc);
+	NewPass.bHasSideEffect = bHasSideEffect;
+	NewPass.bIsCulled = false;
+	NewPass.Queue = UHRenderGraphQueue::Graphics;
+
+	Passes.push_back(UHMOVE(NewPass));
+	bIsCompiled = false;
+	return static_cast<int32_t>(Passes.size() - 1);
+}
+
+void UHRenderGraph::SetPassQueue(int32_t InPass, UHRenderGraphQueue InQueue)
+{
+	if (!IsValidPass(InPass) || InQueue == UHRenderGraphQueue::QueueMax)
+	{
+		return;
+	}
+
+	Passes[InPass].Queue = InQueue;
+	bIsCompiled = false;
+}
+
+void UHRenderGraph::SetSharedAcrossQueues(UHRenderGraphResource InResource)
+{
+	if (!IsValidResource(InResource))
+	{
+		return;
+	}
+
+	Textures[InResource].bIsSharedAcrossQueues = true;
+	bIsCompiled = false;
+}
+
+void UHRenderGraph::SetQueueFamilies(uint32_t InGraphicsFamily, uint32_t InComputeFamily)
+{
+	QueueFamilies[UH_ENUM_VALUE(UHRenderGraphQueue::Graphics)] = InGraphicsFamily;
+	QueueFamilies[UH_ENUM_VALUE(UHRenderGraphQueue::AsyncCompute)] = InComputeFamily;
+}
+
+void UHRenderGraph::Read(int32_t InPass, UHRenderGraphResource InResource, VkImageLayout InLayout, VkImageLayout InEndLayout)
+{
+	AddUse(InPass, InResource, InLayout, InEndLayout, false);
+}
+
+void UHRenderGraph::Write(int32_t InPass, UHRenderGraphResource InResource, VkImageLayout InLayout, VkImageLayout InEndLayout)
+{
+	AddUse(InPass, InResource, InLayout, InEndLayout, true);
+}
+
+void UHRenderGraph::AddUse(int32_t InPass, UHRenderGraphResource InResource, VkImageLayout InLayout, VkImageLayout InEndLayout, bool bIsWrite)
+{
+	if (!IsValidPass(InPass) || !IsValidResource(InResource))
+	{
+		UHE_LOG("Invalid render graph pass or resource!\n");
+		return;
+	}
+
+	// merge the uses of the same resource in a pass, a pass can only expect one layout per resource
+	for (UHRenderGraphUse& Use : Passes[InPass].Uses)
+	{
+		if (Use.Resource == InResource)
+		{
+			if (Use.Layout != InLayout)
+			{
+				UHE_LOG("Render graph pass " + Passes[InPass].Name + " expects different layouts for " + Textures[InResource].Name + "\n");
+			}
+
+			Use.bIsWrite |= bIsWrite;
+			Use.EndLayout = (InEndLayout != GRenderGraphAnyLayout) ? InEndLayout : Use.EndLayout;
+			return;
+		}
+	}
+
+	UHRenderGraphUse NewUse{};
+	NewUse.Resource = InResource;
+	NewUse.Layout = InLayout;
+	NewUse.EndLayout = InEndLayout;
+	NewUse.bIsWrite = bIsWrite;
+
+	Passes[InPass].Uses.push_back(NewUse);
+	bIsCompiled = false;
+}
+
+bool UHRenderGraph::Compile()
+{
+	UH_TRACE_SCOPE("RenderGraphCompile");
+
+	CullPasses();
+	ComputeLifetimes();
+
+	// a transient has no content before the graph, so the first live use must write it
+	for (const UHRenderGraphTexture& Texture : Textures)
+	{
+		if (!Texture.bIsTransient || Texture.FirstPass == UHINDEXNONE)
+		{
+			continue;
+		}
+
+		for (const UHRenderGraphUse& Use : Passes[Texture.FirstPass].Uses)
+		{
+			if (&Textures[Use.Resource] == &Texture && !Use.bIsWrite)
+			{
+				UHE_LOG("Transient " + Texture.Name + " is read before written in pass " + Passes[Texture.FirstPass].Name + "\n");
+				bIsCompiled = false;
+				return false;
+			}
+		}
+	}
+
+	PlaceTransients();
+	BuildBarriers();
+	BuildBatches();
+	BuildAliasScopes();
+
+	bIsCompiled = true;
+	return true;
+}
+
+void UHRenderGraph::CullPasses()
+{
+	// walk backward from the outputs, a pass is alive if it has side effect or it writes a resource consumed later
+	std::vector<bool> bIsNeeded(Textures.size(), false);
+	for (size_t Idx = 0; Idx < Textures.size(); Idx++)
+	{
+		bIsNeeded[Idx] = Textures[Idx].bIsOutput;
+	}
+
+	for (int32_t PassIdx = static_cast<int32_t>(Passes.size()) - 1; PassIdx >= 0; PassIdx--)
+	{
+		UHRenderGraphPass& Pass = Passes[PassIdx];
+		bool bIsAlive = Pass.bHasSideEffect;
+
+		for (const UHRenderGraphUse& Use : Pass.Uses)
+		{
+			if (Use.bIsWrite && bIsNeeded[Use.Resource])
+			{
+				bIsAlive = true;
+				break;
+			}
+		}
+
+		Pass.bIsCulled = !bIsAlive;
+		if (!bIsAlive)
+		{
+			continue;
+		}
+
+		// writes aren't assumed to overwrite the whole resource, so the previous writers are kept alive as well
+		for (const UHRenderGraphUse& Use : Pass.Uses)
+		{
+			bIsNeeded[Use.Resource] = true;
+		}
+	}
+}
+
+void UHRenderGraph::ComputeLifetimes()
+{
+	for (UHRenderGraphTexture& Texture : Textures)
+	{
+		Texture.FirstPass = UHINDEXNONE;
+		Texture.LastPass = UHINDEXNONE;
+	}
+
+	for (int32_t PassIdx = 0; PassIdx < static_cast<int32_t>(Passes.size()); PassIdx++)
+	{
+		if (Passes[PassIdx].bIsCulled)
+		{
+			continue;
+		}
+
+		for (const UHRenderGraphUse& Use : Passes[PassIdx].Uses)
+		{
+			UHRenderGraphTexture& Texture = Textures[Use.Resource];
+			Texture.FirstPass = (Texture.FirstPass == UHINDEXNONE) ? PassIdx : Texture.FirstPass;
+			Texture.LastPass = PassIdx;
+		}
+	}
+}
+
+void UHRenderGraph::PlaceTransients()
+{
+	// greedy placement, the largest transient goes first and takes the lowest offset
+	// that doesn't collide with any placed transient whose lifetime overlaps
+	std::vector<int32_t> Order;
+	for (int32_t Idx = 0; Idx < static_cast<int32_t>(Textures.size()); Idx++)
+	{
+		Textures[Idx].Offset = ~0;
+		if (Textures[Idx].bIsTransient && Textures[Idx].FirstPass != UHINDEXNONE)
+		{
+			Order.push_back(Idx);
+		}
+	}
+
+	std::stable_sort(Order.begin(), Order.end(), [this](int32_t A, int32_t B)
+		{
+			return Textures[A].Size > Textures[B].Size;
+		});
+
+	TransientHeapSize = 0;
+	std::vector<int32_t> Placed;
+	std::vector<int32_t> Colliders;
+
+	for (const int32_t Idx : Order)
+	{
+		UHRenderGraphTexture& Texture = Textures[Idx];
+
+		Colliders.clear();
+		for (const int32_t PlacedIdx : Placed)
+		{
+			const UHRenderGraphTexture& Other = Textures[PlacedIdx];
+			if (Other.FirstPass <= Texture.LastPass && Texture.FirstPass <= Other.LastPass)
+			{
+				Colliders.push_back(PlacedIdx);
+			}
+		}
+
+		std::sort(Colliders.begin(), Colliders.end(), [this](int32_t A, int32_t B)
+			{
+				return Textures[A].Offset < Textures[B].Offset;
+			});
+
+		uint64_t Offset = 0;
+		for (const int32_t ColliderIdx : Colliders)
+		{
+			const UHRenderGraphTexture& Other = Textures[ColliderIdx];
+			if (Offset + Texture.Size <= Other.Offset)
+			{
+				break;
+			}
+
+			Offset = (std::max)(Offset, AlignUp(Other.Offset + Other.Size, Texture.Alignment));
+		}
+
+		Texture.Offset = Offset;
+		TransientHeapSize = (std::max)(TransientHeapSize, Offset + Texture.Size);
+		Placed.push_back(Idx);
+	}
+}
+
+void UHRenderGraph::BuildBarriers()
+{
+	std::vector<VkImageLayout> CurrentLayouts(Textures.size());
+	std::vector<bool> bHasAccessed(Textures.size(), false);
+	std::vector<bool> bLastIsWrite(Textures.size(), false);
+
+	for (size_t Idx = 0; Idx < Textures.size(); Idx++)
+	{
+		CurrentLayouts[Idx] = Textures[Idx].InitialLayout;
+	}
+
+	for (UHRenderGraphPass& Pass : Passes)
+	{
+		Pass.Barriers.clear();
+		if (Pass.bIsCulled)
+		{
+			continue;
+		}
+
+		for (const UHRenderGraphUse& Use : Pass.Uses)
+		{
+			const UHRenderGraphResource Res = Use.Resource;
+			if (Use.Layout != GRenderGraphAnyLayout)
+			{
+				UHRenderGraphBarrier Barrier{};
+				Barrier.Resource = Res;
+				Barrier.OldLayout = CurrentLayouts[Res];
+				Barrier.NewLayout = Use.Layout;
+
+				if (CurrentLayouts[Res] != Use.Layout)
+				{
+					Pass.Barriers.push_back(Barrier);
+				}
+				else if (Use.Layout == VK_IMAGE_LAYOUT_GENERAL && bHasAccessed[Res] && (bLastIsWrite[Res] || Use.bIsWrite))
+				{
+					// same layout but storage access hazard (RAW/WAR/WAW), attachment hazards are covered by render pass dependencies
+					Pass.Barriers.push_back(Barrier);
+				}
+			}
+
+			if (Use.EndLayout != GRenderGraphAnyLayout)
+			{
+				CurrentLayouts[Res] = Use.EndLayout;
+			}
+			else
+			{
+				CurrentLayouts[Res] = Use.Layout;
+			}
+
+			bHasAccessed[Res] = true;
+			bLastIsWrite[Res] = Use.bIsWrite;
+		}
+	}
+}
+
+void UHRenderGraph::BuildBatches()
+{
+	Batches.clear();
+
+	int32_t FirstLivePass = UHINDEXNONE;
+	int32_t LastLivePass = UHINDEXNONE;
+	for (int32_t PassIdx = 0; PassIdx < static_cast<int32_t>(Passes.size()); PassIdx++)
+	{
+		if (!Passes[PassIdx].bIsCulled)
+		{
+			FirstLivePass = (FirstLivePass == UHINDEXNONE) ? PassIdx : FirstLivePass;
+			LastLivePass = PassIdx;
+		}
+	}
+
+	// the frame starts and ends on graphic queue
+	for (int32_t PassIdx = 0; PassIdx < static_cast<int32_t>(Passes.size()); PassIdx++)
+	{
+		const UHRenderGraphPass& Pass = Passes[PassIdx];
+		if (Pass.bIsCulled)
+		{
+			continue;
+		}
+
+		UHRenderGraphQueue Queue = Pass.Queue;
+		if (PassIdx == FirstLivePass || PassIdx == LastLivePass)
+		{
+			Queue = UHRenderGraphQueue::Graphics;
+		}
+
+		if (Batches.empty() || Batches.back().Queue != Queue)
+		{
+			UHRenderGraphBatch NewBatch{};
+			NewBatch.Queue = Queue;
+			Batches.push_back(NewBatch);
+		}
+		Batches.back().Passes.push_back(PassIdx);
+	}
+
+	if (Batches.size() < 2)
+	{
+		return;
+	}
+
+	auto AddWait = [this](int32_t InBatch, int32_t InWaitBatch)
+		{
+			if (InWaitBatch != UHINDEXNONE && Batches[InWaitBatch].Queue != Batches[InBatch].Queue)
+			{
+				Batches[InBatch].WaitBatch = (std::max)(Batches[InBatch].WaitBatch, InWaitBatch);
+			}
+		};
+
+	// shared textures only need the waits: a use waits for the last modification on the other queue,
+	// and a modification also waits for the reads on the other queue
+	// exclusive textures are owned by the batch used them last, graphic queue owns them between frames
+	// transients have no content before their first use and after the graph, so they're never transferred at these points
+	// but their memory could be aliased with the transients on the other queue, the first use waits the last transient batch of the other queue
+	std::vector<int32_t> LastModifyBatch(Textures.size(), UHINDEXNONE);
+	std::vector<std::array<int32_t, 2>> LastReadBatch(Textures.size(), { UHINDEXNONE, UHINDEXNONE });
+	std::vector<int32_t> OwnerBatch(Textures.size(), UHINDEXNONE);
+	std::array<int32_t, 2> LastTransientBatch = { UHINDEXNONE, UHINDEXNONE };
+	bool bHasAsyncBatch = false;
+
+	for (int32_t BatchIdx = 0; BatchIdx < static_cast<int32_t>(Batches.size()); BatchIdx++)
+	{
+		UHRenderGraphBatch& Batch = Batches[BatchIdx];
+		const int32_t QueueIdx = UH_ENUM_VALUE(Batch.Queue);
+		const int32_t OtherQueueIdx = 1 - QueueIdx;
+
+		// the first async batch always waits the previous graphic batch, so it never overlaps the previous frame
+		if (Batch.Queue == UHRenderGraphQueue::AsyncCompute && !bHasAsyncBatch)
+		{
+			AddWait(BatchIdx, BatchIdx - 1);
+			bHasAsyncBatch = true;
+		}
+
+		for (const int32_t PassIdx : Batch.Passes)
+		{
+			const UHRenderGraphPass& Pass = Passes[PassIdx];
+			for (const UHRenderGraphUse& Use : Pass.Uses)
+			{
+				const UHRenderGraphResource Res = Use.Resource;
+				if (Textures[Res].bIsTransient)
+				{
+					if (Textures[Res].FirstPass == PassIdx)
+					{
+						AddWait(BatchIdx, LastTransientBatch[OtherQueueIdx]);
+					}
+					LastTransientBatch[QueueIdx] = BatchIdx;
+				}
+
+				if (Textures[Res].bIsSharedAcrossQueues)
+				{
+					bool bIsModify = Use.bIsWrite || Use.Layout == GRenderGraphAnyLayout
+						|| (Use.EndLayout != GRenderGraphAnyLayout && Use.EndLayout != Use.Layout);
+					for (const UHRenderGraphBarrier& Barrier : Pass.Barriers)
+					{
+						bIsModify |= (Barrier.Resource == Res);
+					}
+
+					AddWait(BatchIdx, LastModifyBatch[Res]);
+					if (bIsModify)
+					{
+						AddWait(BatchIdx, LastReadBatch[Res][OtherQueueIdx]);
+						LastModifyBatch[Res] = BatchIdx;
+					}
+					else
+					{
+						LastReadBatch[Res][QueueIdx] = BatchIdx;
+					}
+					continue;
+				}
+
+				int32_t Owner = OwnerBatch[Res];
+				if (Owner == UHINDEXNONE && Batch.Queue == UHRenderGraphQueue::AsyncCompute && !Textures[Res].bIsTransient)
+				{
+					Owner = BatchIdx - 1;
+				}
+
+				if (Owner != UHINDEXNONE && Batches[Owner].Queue != Batch.Queue)
+				{
+					AddUnique(Batches[Owner].Releases, Res);
+					AddUnique(Batch.Acquires, Res);
+					AddWait(BatchIdx, Owner);
+				}
+				OwnerBatch[Res] = BatchIdx;
+			}
+		}
+	}
+
+	// return exclusive textures to graphic queue, and the last batch joins all async work
+	const int32_t LastBatch = static_cast<int32_t>(Batches.size()) - 1;
+	for (UHRenderGraphResource Res = 0; Res < static_cast<UHRenderGraphResource>(Textures.size()); Res++)
+	{
+		const int32_t Owner = OwnerBatch[Res];
+		if (Owner != UHINDEXNONE && Batches[Owner].Queue == UHRenderGraphQueue::AsyncCompute && !Textures[Res].bIsTransient)
+		{
+			AddUnique(Batches[Owner].Releases, Res);
+			AddUnique(Batches[LastBatch].Acquires, Res);
+		}
+	}
+
+	for (int32_t BatchIdx = LastBatch - 1; BatchIdx >= 0; BatchIdx--)
+	{
+		if (Batches[BatchIdx].Queue == UHRenderGraphQueue::AsyncCompute)
+		{
+			AddWait(LastBatch, BatchIdx);
+			break;
+		}
+	}
+}
+
+void UHRenderGraph::BuildAliasScopes()
+{
+	// the queue each live pass actually runs on, the first and last pass could be moved back to graphic queue
+	std::vector<UHRenderGraphQueue> PassQueues(Passes.size(), UHRenderGraphQueue::Graphics);
+	for (const UHRenderGraphBatch& Batch : Batches)
+	{
+		for (const int32_t PassIdx : Batch.Passes)
+		{
+			PassQueues[PassIdx] = Batch.Queue;
+		}
+	}
+
+	for (UHRenderGraphTexture& Texture : Textures)
+	{
+		Texture.AliasSrcStages = VK_PIPELINE_STAGE_2_NONE;
+		Texture.AliasSrcAccess = VK_ACCESS_2_NONE;
+		if (!Texture.bIsTransient || Texture.FirstPass == UHINDEXNONE)
+		{
+			continue;
+		}
+
+		// wait for the last uses of every earlier transient placed in the same memory
+		const UHRenderGraphQueue ThisQueue = PassQueues[Texture.FirstPass];
+		bool bHasPreviousAlias = false;
+		for (const UHRenderGraphTexture& Other : Textures)
+		{
+			if (!Other.bIsTransient || Other.FirstPass == UHINDEXNONE || Other.LastPass >= Texture.FirstPass
+				|| Other.Offset >= Texture.Offset + Texture.Size || Texture.Offset >= Other.Offset + Other.Size)
+			{
+				continue;
+			}
+			bHasPreviousAlias = true;
+
+			// the alias on the other queue is waited by the batch semaphore, chain with it through all commands
+			if (PassQueues[Other.LastPass] != ThisQueue)
+			{
+				Texture.AliasSrcStages |= VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT;
+				Texture.AliasSrcAccess |= VK_ACCESS_2_MEMORY_READ_BIT | VK_ACCESS_2_MEMORY_WRITE_BIT;
+				continue;
+			}
+
+			for (const UHRenderGraphUse& Use : Passes[Other.LastPass].Uses)
+			{
+				if (&Textures[Use.Resource] != &Other)
+				{
+					continue;
+				}
+
+				AppendLayoutScope(Use.Layout, ThisQueue, Texture.AliasSrcStages, Texture.AliasSrcAccess);
+				if (Use.EndLayout != GRenderGraphAnyLayout)
+				{
+					AppendLayoutScope(Use.EndLayout, ThisQueue, Texture.AliasSrcStages, Texture.AliasSrcAccess);
+				}
+			}
+		}
+
+		// without an alias in this graph, the memory was last touched outside of it, e.g. by the previous frame
+		if (!bHasPreviousAlias)
+		{
+			Texture.AliasSrcStages = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT;
+			Texture.AliasSrcAccess = VK_ACCESS_2_MEMORY_READ_BIT | VK_ACCESS_2_MEMORY_WRITE_BIT;
+		}
+	}
+}
+
+void UHRenderGraph::Execute(UHRenderBuilder& RenderBuilder)
+{
+	UH_TRACE_SCOPE("RenderGraphExecute");
+	if (!bIsCompiled)
+	{
+		UHE_LOG("Render graph must be compiled before execution!\n");
+		return;
+	}
+
+	for (int32_t PassIdx = 0; PassIdx < static_cast<int32_t>(Passes.size()); PassIdx++)
+	{
+		if (!Passes[PassIdx].bIsCulled)
+		{
+			ExecutePass(PassIdx, RenderBuilder);
+		}
+	}
+}
+
+void UHRenderGraph::ExecuteBatch(int32_t InBatch, UHRenderBuilder& RenderBuilder)
+{
+	UH_TRACE_SCOPE("RenderGraphExecuteBatch");
+	if (!bIsCompiled || InBatch < 0 || InBatch >= static_cast<int32_t>(Batches.size()))
+	{
+		UHE_LOG("Render graph must be compiled before execution!\n");
+		return;
+	}
+
+	const UHRenderGraphBatch& Batch = Batches[InBatch];
+	const uint32_t ThisFamily = QueueFamilies[UH_ENUM_VALUE(Batch.Queue)];
+	const uint32_t OtherFamily = QueueFamilies[1 - UH_ENUM_VALUE(Batch.Queue)];
+
+	for (const UHRenderGraphResource Res : Batch.Acquires)
+	{
+		RenderBuilder.QueueOwnershipBarrier(Textures[Res].Texture, OtherFamily, ThisFamily, false);
+	}
+
+	for (const int32_t PassIdx : Batch.Passes)
+	{
+		ExecutePass(PassIdx, RenderBuilder);
+	}
+
+	for (const UHRenderGraphResource Res : Batch.Releases)
+	{
+		RenderBuilder.QueueOwnershipBarrier(Textures[Res].Texture, ThisFamily, OtherFamily, true);
+	}
+}
+
+void UHRenderGraph::ExecutePass(int32_t InPass, UHRenderBuilder& RenderBuilder)
+{
+	UHRenderGraphPass& Pass = Passes[InPass];
+
+	// the memory of transient could be touched by other aliased textures, always discard the previous content
+	// and wait for the last use of the previous alias, the passes that transition by themselves start from GENERAL
+	for (const UHRenderGraphUse& Use : Pass.Uses)
+	{
+		UHRenderGraphTexture& Texture = Textures[Use.Resource];
+		if (Texture.bIsTransient && Texture.FirstPass == InPass && Texture.Texture != nullptr)
+		{
+			RenderBuilder.AliasingBarrier(Texture.Texture, (Use.Layout != GRenderGraphAnyLayout) ? Use.Layout : VK_IMAGE_LAYOUT_GENERAL
+				, Texture.AliasSrcStages, Texture.AliasSrcAccess);
+		}
+	}
+
+	// batch all barriers of this pass, the old layout is from the texture itself since passes might transition internally
+	HazardTextures.clear();
+	for (const UHRenderGraphBarrier& Barrier : Pass.Barriers)
+	{
+		UHTexture* Texture = Textures[Barrier.Resource].Texture;
+		if (Texture == nullptr)
+		{
+			continue;
+		}
+
+		if (Barrier.OldLayout == Barrier.NewLayout)
+		{
+			HazardTextures.push_back(Texture);
+		}
+		else
+		{
+			RenderBuilder.PushResourceBarrier(UHImageBarrier(Texture, Barrier.NewLayout));
+		}
+	}
+	RenderBuilder.FlushResourceBarrier();
+	RenderBuilder.ResourceBarrier(HazardTextures, VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_LAYOUT_GENERAL);
+
+	if (Pass.Func)
+	{
+		Pass.Func(RenderBuilder);
+	}
+}
+
+bool UHRenderGraph::IsPassCulled(int32_t InPass) const
+{
+	return IsValidPass(InPass) ? Passes[InPass].bIsCulled : true;
+}
+
+const std::vector<UHRenderGraphBarrier>& UHRenderGraph::GetPassBarriers(int32_t InPass) const
+{
+	static const std::vector<UHRenderGraphBarrier> EmptyBarriers;
+	return IsValidPass(InPass) ? Passes[InPass].Barriers : EmptyBarriers;
+}
+
+uint32_t UHRenderGraph::GetBarrierCount() const
+{
+	uint32_t Count = 0;
+	for (const UHRenderGraphPass& Pass : Passes)
+	{
+		Count += static_cast<uint32_t>(Pass.Barriers.size());
+	}
+
+	return Count;
+}
+
+uint32_t UHRenderGraph::GetLivePassCount() const
+{
+	uint32_t Count = 0;
+	for (const UHRenderGraphPass& Pass : Passes)
+	{
+		Count += Pass.bIsCulled ? 0 : 1;
+	}
+
+	return Count;
+}
+
+uint64_t UHRenderGraph::GetTransientHeapSize() const
+{
+	return TransientHeapSize;
+}
+
+uint64_t UHRenderGraph::GetTransientOffset(UHRenderGraphResource InResource) const
+{
+	return IsValidResource(InResource) ? Textures[InResource].Offset : ~0;
+}
+
+int32_t UHRenderGraph::GetFirstUsePass(UHRenderGraphResource InResource) const
+{
+	return IsValidResource(InResource) ? Textures[InResource].FirstPass : UHINDEXNONE;
+}
+
+int32_t UHRenderGraph::GetLastUsePass(UHRenderGraphResource InResource) const
+{
+	return IsValidResource(InResource) ? Textures[InResource].LastPass : UHINDEXNONE;
+}
+
+void UHRenderGraph::GetAliasSrcScope(UHRenderGraphResource InResource, VkPipelineStageFlags2& OutStages, VkAccessFlags2& OutAccess) const
+{
+	OutStages = IsValidResource(InResource) ? Textures[InResource].AliasSrcStages : VK_PIPELINE_STAGE_2_NONE;
+	OutAccess = IsValidResource(InResource) ? Textures[InResource].AliasSrcAccess : VK_ACCESS_2_NONE;
+}
+
+uint32_t UHRenderGraph::GetBatchCount() const
+{
+	return static_cast<uint32_t>(Batches.size());
+}
+
+const UHRenderGraphBatch& UHRenderGraph::GetBatch(int32_t InBatch) const
+{
+	return Batches[InBatch];
+}
+
+bool UHRenderGraph::IsValidPass(int32_t InPass) const
+{
+	return InPass >= 0 && InPass < static_cast<int32_t>(Passes.size());
+}
+
+bool UHRenderGraph::IsValidResource(UHRenderGraphResource InResource) const
+{
+	return InResource >= 0 && InResource < static_cast<int32_t>(Textures.size());
+}
@@ -0,0 +1,166 @@
+#pragma once
+#include <vulkan/vulkan_core.h>
+#include <cstdint>
+#include <array>
+#include <functional>
+#include <string>
+#include <vector>
+
+class UHTexture;
+class UHRenderBuilder;
+
+// resource handle in a render graph, it's the index of registered resources
+typedef int32_t UHRenderGraphResource;
+typedef std::function<void(UHRenderBuilder&)> UHRenderGraphPassFunc;
+
+// layout used for the uses that manage their own transitions, graph only tracks the dependency
+static const VkImageLayout GRenderGraphAnyLayout = VK_IMAGE_LAYOUT_MAX_ENUM;
+
+// barrier derived by the graph compiler
+// OldLayout could be GRenderGraphAnyLayout if the previous pass manages its own transitions
+struct UHRenderGraphBarrier
+{
+	UHRenderGraphResource Resource = -1;
+	VkImageLayout OldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+	VkImageLayout NewLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+};
+
+// queue a pass is scheduled on
+enum class UHRenderGraphQueue
+{
+	Graphics = 0,
+	AsyncCompute,
+	QueueMax
+};
+
+// consecutive live passes on the same queue are submitted as a batch
+// WaitBatch is the latest batch on the other queue that must be finished before this batch starts
+// exclusive textures crossing queues are acquired before the passes and released after the passes
+struct UHRenderGraphBatch
+{
+	UHRenderGraphQueue Queue = UHRenderGraphQueue::Graphics;
+	std::vector<int32_t> Passes;
+	int32_t WaitBatch = -1;
+	std::vector<UHRenderGraphResource> Acquires;
+	std::vector<UHRenderGraphResource> Releases;
+};
+
+// render graph for Unheard Engine
+// passes are recorded in submission order and declare their reads and writes, Compile() will
+// (1) cull the passes whose outputs are never consumed
+// (2) derive the minimal barriers for every live pass, layout changes and GENERAL hazards are batched per pass
+// (3) compute the lifetime of transient resources and place them in a shared heap, disjoint lifetimes are aliased
+// (4) split the passes into graphic and async compute batches, and derive the cross-queue waits and ownership transfers
+// (5) derive the stages and accesses each transient waits for, from the last uses of the previous aliases in the same memory
+// the compilation is device-independent, so it can be validated on CPU without a Vulkan device
+class UHRenderGraph
+{
+public:
+	UHRenderGraph();
+
+	// clear all passes and resources, the capacity is kept for next frame
+	void Reset();
+
+	// import an existing texture, InTexture can be nullptr for CPU-only compilation
+	// bIsOutput marks the texture is consumed outside of the graph, e.g. history buffers
+	UHRenderGraphResource ImportTexture(std::string InName, UHTexture* InTexture, VkImageLayout InInitialLayout, bool bIsOutput = false);
+
+	// transient texture only lives within the graph, its memory could be aliased with other transients
+	UHRenderGraphResource CreateTransientTexture(std::string InName, uint64_t InSize, uint64_t InAlignment);
+	void SetTransientTexture(UHRenderGraphResource InResource, UHTexture* InTexture);
+
+	// add a pass, passes with side effect (readbacks, AS builds, buffer writes...) are never culled
+	int32_t AddPass(std::string InName, UHRenderGraphPassFunc InFunc, bool bHasSideEffect = false);
+
+	// request a pass to run on async compute queue, the request is ignored for the first and last live pass
+	void SetPassQueue(int32_t InPass, UHRenderGraphQueue InQueue);
+
+	// the texture is created with concurrent sharing, so it only needs synchronization but not ownership transfer between queues
+	void SetSharedAcrossQueues(UHRenderGraphResource InResource);
+	void SetQueueFamilies(uint32_t InGraphicsFamily, uint32_t InComputeFamily);
+
+	// declare the uses of a pass, the layout is the one expected when the pass starts
+	// InEndLayout is the layout when the pass finishes if it transitions the resource internally, it's unchanged by default
+	// GRenderGraphAnyLayout as InLayout means the pass transitions the resource by itself
+	void Read(int32_t InPass, UHRenderGraphResource InResource, VkImageLayout InLayout, VkImageLayout InEndLayout = GRenderGraphAnyLayout);
+	void Write(int32_t InPass, UHRenderGraphResource InResource, VkImageLayout InLayout, VkImageLayout InEndLayout = GRenderGraphAnyLayout);
+
+	bool Compile();
+
+	// execute all passes in one builder, or execute a compiled batch in the builder of its queue
+	void Execute(UHRenderBuilder& RenderBuilder);
+	void ExecuteBatch(int32_t InBatch, UHRenderBuilder& RenderBuilder);
+
+	// compiled results
+	bool IsPassCulled(int32_t InPass) const;
+	const std::vector<UHRenderGraphBarrier>& GetPassBarriers(int32_t InPass) const;
+	uint32_t GetBarrierCount() const;
+	uint32_t GetLivePassCount() const;
+	uint64_t GetTransientHeapSize() const;
+	uint64_t GetTransientOffset(UHRenderGraphResource InResource) const;
+	int32_t GetFirstUsePass(UHRenderGraphResource InResource) const;
+	int32_t GetLastUsePass(UHRenderGraphResource InResource) const;
+	void GetAliasSrcScope(UHRenderGraphResource InResource, VkPipelineStageFlags2& OutStages, VkAccessFlags2& OutAccess) const;
+	uint32_t GetBatchCount() const;
+	const UHRenderGraphBatch& GetBatch(int32_t InBatch) const;
+
+private:
+	struct UHRenderGraphUse
+	{
+		UHRenderGraphResource Resource;
+		VkImageLayout Layout;
+		VkImageLayout EndLayout;
+		bool bIsWrite;
+	};
+
+	struct UHRenderGraphPass
+	{
+		std::string Name;
+		UHRenderGraphPassFunc Func;
+		bool bHasSideEffect;
+		bool bIsCulled;
+		UHRenderGraphQueue Queue;
+		std::vector<UHRenderGraphUse> Uses;
+		std::vector<UHRenderGraphBarrier> Barriers;
+	};
+
+	struct UHRenderGraphTexture
+	{
+		std::string Name;
+		UHTexture* Texture;
+		VkImageLayout InitialLayout;
+		bool bIsOutput;
+		bool bIsTransient;
+		bool bIsSharedAcrossQueues;
+		uint64_t Size;
+		uint64_t Alignment;
+
+		// compiled
+		int32_t FirstPass;
+		int32_t LastPass;
+		uint64_t Offset;
+		VkPipelineStageFlags2 AliasSrcStages;
+		VkAccessFlags2 AliasSrcAccess;
+	};
+
+	bool IsValidPass(int32_t InPass) const;
+	bool IsValidResource(UHRenderGraphResource InResource) const;
+	void AddUse(int32_t InPass, UHRenderGraphResource InResource, VkImageLayout InLayout, VkImageLayout InEndLayout, bool bIsWrite);
+	void CullPasses();
+	void ComputeLifetimes();
+	void PlaceTransients();
+	void BuildBarriers();
+	void BuildBatches();
+	void BuildAliasScopes();
+	void ExecutePass(int32_t InPass, UHRenderBuilder& RenderBuilder);
+
+	std::vector<UHRenderGraphPass> Passes;
+	std::vector<UHRenderGraphTexture> Textures;
+	std::vector<UHRenderGraphBatch> Batches;
+	std::array<uint32_t, static_cast<size_t>(UHRenderGraphQueue::QueueMax)> QueueFamilies;
+	uint64_t TransientHeapSize;
+	bool bIsCompiled;
+
+	// reused during execution
+	std::vector<UHTexture*> HazardTextures;
+};
@@ -0,0 +1,339 @@
+#include "RenderGraphTest.h"
+
+#if WITH_TESTS
+#include "../Classes/TestSuite.h"
+#include "RenderGraph.h"
+#include "../CoreGlobals.h"
+#include <algorithm>
+
+static const UHTestSuite GTestSuite("RenderGraphTest");
+
+static bool Contains(const std::vector<UHRenderGraphResource>& InResources, UHRenderGraphResource InResource)
+{
+	return std::find(InResources.begin(), InResources.end(), InResource) != InResources.end();
+}
+
+bool UHRenderGraphTest::Run()
+{
+	bool bPassed = true;
+	bPassed &= TestCulling();
+	bPassed &= TestBarriers();
+	bPassed &= TestTransientPlacement();
+	bPassed &= TestTransientReadBeforeWrite();
+	bPassed &= TestBatches();
+	bPassed &= TestAsyncTransients();
+	bPassed &= TestAliasScopes();
+
+	return GTestSuite.Report(bPassed);
+}
+
+bool UHRenderGraphTest::TestCulling()
+{
+	const char* TestName = "Culling";
+	UHRenderGraph Graph;
+
+	const UHRenderGraphResource Output = Graph.ImportTexture("Output", nullptr, VK_IMAGE_LAYOUT_UNDEFINED, true);
+	const UHRenderGraphResource Unused = Graph.ImportTexture("Unused", nullptr, VK_IMAGE_LAYOUT_UNDEFINED);
+	const UHRenderGraphResource Temp = Graph.CreateTransientTexture("Temp", 256, 64);
+
+	const int32_t WriteTemp = Graph.AddPass("WriteTemp", nullptr);
+	Graph.Write(WriteTemp, Temp, VK_IMAGE_LAYOUT_GENERAL);
+
+	const int32_t WriteOutput = Graph.AddPass("WriteOutput", nullptr);
+	Graph.Read(WriteOutput, Temp, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+	Graph.Write(WriteOutput, Output, VK_IMAGE_LAYOUT_GENERAL);
+
+	const int32_t WriteUnused = Graph.AddPass("WriteUnused", nullptr);
+	Graph.Write(WriteUnused, Unused, VK_IMAGE_LAYOUT_GENERAL);
+
+	const int32_t SideEffect = Graph.AddPass("SideEffect", nullptr, true);
+	Graph.Read(SideEffect, Unused, VK_IMAGE_LAYOUT_GENERAL);
+
+	const int32_t ReadOnly = Graph.AddPass("ReadOnly", nullptr);
+	Graph.Read(ReadOnly, Output, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+
+	bool bPassed = GTestSuite.Check(Graph.Compile(), TestName, "compile");
+	bPassed &= GTestSuite.Check(!Graph.IsPassCulled(WriteTemp), TestName, "the writer of a consumed transient is kept");
+	bPassed &= GTestSuite.Check(!Graph.IsPassCulled(WriteOutput), TestName, "the writer of an output is kept");
+	bPassed &= GTestSuite.Check(!Graph.IsPassCulled(WriteUnused), TestName, "the writer consumed by a side effect pass is kept");
+	bPassed &= GTestSuite.Check(!Graph.IsPassCulled(SideEffect), TestName, "a side effect pass is kept");
+	bPassed &= GTestSuite.Check(Graph.IsPassCulled(ReadOnly), TestName, "a pass without consumed writes is culled");
+	bPassed &= GTestSuite.Check(Graph.GetLivePassCount() == 4, TestName, "live pass count");
+
+	// without the side effect reader, the unused writer goes away as well
+	Graph.Reset();
+	const UHRenderGraphResource Output2 = Graph.ImportTexture("Output", nullptr, VK_IMAGE_LAYOUT_UNDEFINED, true);
+	const UHRenderGraphResource Unused2 = Graph.ImportTexture("Unused", nullptr, VK_IMAGE_LAYOUT_UNDEFINED);
+	const int32_t WriteOutput2 = Graph.AddPass("WriteOutput", nullptr);
+	Graph.Write(WriteOutput2, Output2, VK_IMAGE_LAYOUT_GENERAL);
+	const int32_t WriteUnused2 = Graph.AddPass("WriteUnused", nullptr);
+	Graph.Write(WriteUnused2, Unused2, VK_IMAGE_LAYOUT_GENERAL);
+
+	bPassed &= GTestSuite.Check(Graph.Compile(), TestName, "compile after reset");
+	bPassed &= GTestSuite.Check(Graph.IsPassCulled(WriteUnused2), TestName, "the writer of a never consumed texture is culled");
+	bPassed &= GTestSuite.Check(Graph.GetLivePassCount() == 1, TestName, "live pass count after reset");
+
+	return bPassed;
+}
+
+bool UHRenderGraphTest::TestBarriers()
+{
+	const char* TestName = "Barriers";
+	UHRenderGraph Graph;
+
+	const UHRenderGraphResource Tex = Graph.ImportTexture("Tex", nullptr, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, true);
+
+	// readers have side effects, otherwise they would be culled
+	const int32_t LayoutChange = Graph.AddPass("LayoutChange", nullptr);
+	Graph.Write(LayoutChange, Tex, VK_IMAGE_LAYOUT_GENERAL);
+	const int32_t WriteAfterWrite = Graph.AddPass("WriteAfterWrite", nullptr);
+	Graph.Write(WriteAfterWrite, Tex, VK_IMAGE_LAYOUT_GENERAL);
+	const int32_t ReadAfterWrite = Graph.AddPass("ReadAfterWrite", nullptr, true);
+	Graph.Read(ReadAfterWrite, Tex, VK_IMAGE_LAYOUT_GENERAL);
+	const int32_t ReadAfterRead = Graph.AddPass("ReadAfterRead", nullptr, true);
+	Graph.Read(ReadAfterRead, Tex, VK_IMAGE_LAYOUT_GENERAL);
+	const int32_t ToShaderRead = Graph.AddPass("ToShaderRead", nullptr, true);
+	Graph.Read(ToShaderRead, Tex, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+	const int32_t SameShaderRead = Graph.AddPass("SameShaderRead", nullptr, true);
+	Graph.Read(SameShaderRead, Tex, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+	const int32_t SelfTransition = Graph.AddPass("SelfTransition", nullptr);
+	Graph.Write(SelfTransition, Tex, GRenderGraphAnyLayout, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL);
+	const int32_t ReadEndLayout = Graph.AddPass("ReadEndLayout", nullptr, true);
+	Graph.Read(ReadEndLayout, Tex, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL);
+
+	bool bPassed = GTestSuite.Check(Graph.Compile(), TestName, "compile");
+
+	const std::vector<UHRenderGraphBarrier>& LayoutBarriers = Graph.GetPassBarriers(LayoutChange);
+	bPassed &= GTestSuite.Check(LayoutBarriers.size() == 1, TestName, "layout change emits a barrier");
+	if (LayoutBarriers.size() == 1)
+	{
+		bPassed &= GTestSuite.Check(LayoutBarriers[0].OldLayout == VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL
+			&& LayoutBarriers[0].NewLayout == VK_IMAGE_LAYOUT_GENERAL, TestName, "layout change starts from the imported layout");
+	}
+
+	bPassed &= GTestSuite.Check(Graph.GetPassBarriers(WriteAfterWrite).size() == 1, TestName, "storage write after write emits a hazard barrier");
+	bPassed &= GTestSuite.Check(Graph.GetPassBarriers(ReadAfterWrite).size() == 1, TestName, "storage read after write emits a hazard barrier");
+	bPassed &= GTestSuite.Check(Graph.GetPassBarriers(ReadAfterRead).empty(), TestName, "storage read after read needs no barrier");
+	bPassed &= GTestSuite.Check(Graph.GetPassBarriers(ToShaderRead).size() == 1, TestName, "transition to shader read");
+	bPassed &= GTestSuite.Check(Graph.GetPassBarriers(SameShaderRead).empty(), TestName, "same read-only layout needs no barrier");
+	bPassed &= GTestSuite.Check(Graph.GetPassBarriers(SelfTransition).empty(), TestName, "self transitioned use emits no barrier");
+	bPassed &= GTestSuite.Check(Graph.GetPassBarriers(ReadEndLayout).empty(), TestName, "the end layout of the previous pass is tracked");
+	bPassed &= GTestSuite.Check(Graph.GetBarrierCount() == 4, TestName, "total barrier count");
+
+	return bPassed;
+}
+
+bool UHRenderGraphTest::TestTransientPlacement()
+{
+	const char* TestName = "TransientPlacement";
+	UHRenderGraph Graph;
+
+	// a chain A -> B -> C -> Output, each transient overlaps its neighbours only
+	const UHRenderGraphResource A = Graph.CreateTransientTexture("A", 1024, 256);
+	const UHRenderGraphResource B = Graph.CreateTransientTexture("B", 512, 256);
+	const UHRenderGraphResource C = Graph.CreateTransientTexture("C", 768, 512);
+	const UHRenderGraphResource Output = Graph.ImportTexture("Output", nullptr, VK_IMAGE_LAYOUT_UNDEFINED, true);
+
+	int32_t Pass = Graph.AddPass("WriteA", nullptr);
+	Graph.Write(Pass, A, VK_IMAGE_LAYOUT_GENERAL);
+
+	Pass = Graph.AddPass("AToB", nullptr);
+	Graph.Read(Pass, A, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+	Graph.Write(Pass, B, VK_IMAGE_LAYOUT_GENERAL);
+
+	Pass = Graph.AddPass("BToC", nullptr);
+	Graph.Read(Pass, B, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+	Graph.Write(Pass, C, VK_IMAGE_LAYOUT_GENERAL);
+
+	Pass = Graph.AddPass("CToOutput", nullptr);
+	Graph.Read(Pass, C, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+	Graph.Write(Pass, Output, VK_IMAGE_LAYOUT_GENERAL);
+
+	bool bPassed = GTestSuite.Check(Graph.Compile(), TestName, "compile");
+	bPassed &= GTestSuite.Check(Graph.GetFirstUsePass(B) == 1 && Graph.GetLastUsePass(B) == 2, TestName, "lifetime of B");
+
+	// A and C never live together so they share offset 0, B overlaps both and goes after the larger one
+	const uint64_t OffsetA = Graph.GetTransientOffset(A);
+	const uint64_t OffsetB = Graph.GetTransientOffset(B);
+	const uint64_t OffsetC = Graph.GetTransientOffset(C);
+	bPassed &= GTestSuite.Check(OffsetA == 0, TestName, "the largest transient is placed first");
+	bPassed &= GTestSuite.Check(OffsetC == 0, TestName, "disjoint lifetimes are aliased");
+	bPassed &= GTestSuite.Check(OffsetB == 1024, TestName, "overlapping lifetimes don't share memory");
+	bPassed &= GTestSuite.Check(OffsetB % 256 == 0 && OffsetC % 512 == 0, TestName, "alignment");
+	bPassed &= GTestSuite.Check(Graph.GetTransientHeapSize() == 1536, TestName, "heap size");
+
+	// an imported texture is never placed
+	bPassed &= GTestSuite.Check(Graph.GetTransientOffset(Output) == static_cast<uint64_t>(~0), TestName, "imported textures have no offset");
+
+	return bPassed;
+}
+
+bool UHRenderGraphTest::TestTransientReadBeforeWrite()
+{
+	const char* TestName = "TransientReadBeforeWrite";
+	UHRenderGraph Graph;
+
+	const UHRenderGraphResource Temp = Graph.CreateTransientTexture("Temp", 256, 64);
+	const int32_t Pass = Graph.AddPass("ReadTemp", nullptr, true);
+	Graph.Read(Pass, Temp, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+
+	return GTestSuite.Check(!Graph.Compile(), TestName, "a transient read before written fails to compile");
+}
+
+bool UHRenderGraphTest::TestBatches()
+{
+	const char* TestName = "Batches";
+	UHRenderGraph Graph;
+	Graph.SetQueueFamilies(0, 1);
+
+	const UHRenderGraphResource Shared = Graph.ImportTexture("Shared", nullptr, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+	Graph.SetSharedAcrossQueues(Shared);
+	const UHRenderGraphResource Exclusive = Graph.ImportTexture("Exclusive", nullptr, VK_IMAGE_LAYOUT_GENERAL);
+	const UHRenderGraphResource Output = Graph.ImportTexture("Output", nullptr, VK_IMAGE_LAYOUT_GENERAL, true);
+
+	// the first and the last live pass always stay on graphic queue
+	const int32_t First = Graph.AddPass("First", nullptr);
+	Graph.Write(First, Shared, GRenderGraphAnyLayout, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+	Graph.Write(First, Exclusive, VK_IMAGE_LAYOUT_GENERAL);
+	Graph.SetPassQueue(First, UHRenderGraphQueue::AsyncCompute);
+
+	const int32_t Async = Graph.AddPass("Async", nullptr);
+	Graph.Read(Async, Shared, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+	Graph.Write(Async, Exclusive, VK_IMAGE_LAYOUT_GENERAL);
+	Graph.SetPassQueue(Async, UHRenderGraphQueue::AsyncCompute);
+
+	const int32_t Graphic = Graph.AddPass("Graphic", nullptr);
+	Graph.Write(Graphic, Output, VK_IMAGE_LAYOUT_GENERAL);
+
+	const int32_t Last = Graph.AddPass("Last", nullptr);
+	Graph.Read(Last, Exclusive, VK_IMAGE_LAYOUT_GENERAL);
+	Graph.Write(Last, Output, VK_IMAGE_LAYOUT_GENERAL);
+	Graph.SetPassQueue(Last, UHRenderGraphQueue::AsyncCompute);
+
+	bool bPassed = GTestSuite.Check(Graph.Compile(), TestName, "compile");
+	bPassed &= GTestSuite.Check(Graph.GetBatchCount() == 3, TestName, "graphic, async and graphic batches");
+	if (Graph.GetBatchCount() != 3)
+	{
+		return false;
+	}
+
+	const UHRenderGraphBatch& Batch0 = Graph.GetBatch(0);
+	const UHRenderGraphBatch& Batch1 = Graph.GetBatch(1);
+	const UHRenderGraphBatch& Batch2 = Graph.GetBatch(2);
+	bPassed &= GTestSuite.Check(Batch0.Queue == UHRenderGraphQueue::Graphics && Batch0.Passes.size() == 1 && Batch0.Passes[0] == First
+		, TestName, "the first pass is kept on graphic queue");
+	bPassed &= GTestSuite.Check(Batch1.Queue == UHRenderGraphQueue::AsyncCompute && Batch1.Passes.size() == 1 && Batch1.Passes[0] == Async
+		, TestName, "the async pass gets its own batch");
+	bPassed &= GTestSuite.Check(Batch2.Queue == UHRenderGraphQueue::Graphics && Batch2.Passes.size() == 2, TestName, "the last pass is kept on graphic queue");
+
+	// the async batch waits the writes of the first batch, the last batch joins the async work
+	bPassed &= GTestSuite.Check(Batch0.WaitBatch == UHINDEXNONE, TestName, "the first batch waits nothing");
+	bPassed &= GTestSuite.Check(Batch1.WaitBatch == 0, TestName, "the async batch waits the previous graphic batch");
+	bPassed &= GTestSuite.Check(Batch2.WaitBatch == 1, TestName, "the last batch waits the async batch");
+
+	// the exclusive texture is transferred to async queue and back, the shared texture only needs waits
+	bPassed &= GTestSuite.Check(Contains(Batch0.Releases, Exclusive) && Contains(Batch1.Acquires, Exclusive), TestName, "exclusive texture goes to async queue");
+	bPassed &= GTestSuite.Check(Contains(Batch1.Releases, Exclusive) && Contains(Batch2.Acquires, Exclusive), TestName, "exclusive texture goes back to graphic queue");
+	bPassed &= GTestSuite.Check(!Contains(Batch0.Releases, Shared) && !Contains(Batch1.Acquires, Shared), TestName, "shared texture has no ownership transfer");
+
+	return bPassed;
+}
+
+bool UHRenderGraphTest::TestAsyncTransients()
+{
+	const char* TestName = "AsyncTransients";
+	UHRenderGraph Graph;
+	Graph.SetQueueFamilies(0, 1);
+
+	const UHRenderGraphResource Output = Graph.ImportTexture("Output", nullptr, VK_IMAGE_LAYOUT_GENERAL, true);
+	const UHRenderGraphResource AsyncTemp = Graph.CreateTransientTexture("AsyncTemp", 512, 256);
+	const UHRenderGraphResource GraphicTemp = Graph.CreateTransientTexture("GraphicTemp", 512, 256);
+
+	const int32_t First = Graph.AddPass("First", nullptr);
+	Graph.Write(First, Output, VK_IMAGE_LAYOUT_GENERAL);
+
+	// a transient on async queue, followed by an aliased transient on graphic queue
+	const int32_t AsyncFilter = Graph.AddPass("AsyncFilter", nullptr, true);
+	Graph.Write(AsyncFilter, AsyncTemp, VK_IMAGE_LAYOUT_GENERAL);
+	Graph.SetPassQueue(AsyncFilter, UHRenderGraphQueue::AsyncCompute);
+
+	const int32_t GraphicFilter = Graph.AddPass("GraphicFilter", nullptr);
+	Graph.Write(GraphicFilter, GraphicTemp, VK_IMAGE_LAYOUT_GENERAL);
+	Graph.Write(GraphicFilter, Output, VK_IMAGE_LAYOUT_GENERAL);
+
+	// an async pass without dependencies in between, so the wait of the graphic filter only comes from the aliasing
+	const int32_t AsyncOther = Graph.AddPass("AsyncOther", nullptr, true);
+	Graph.SetPassQueue(AsyncOther, UHRenderGraphQueue::AsyncCompute);
+
+	const int32_t Last = Graph.AddPass("Last", nullptr);
+	Graph.Write(Last, Output, VK_IMAGE_LAYOUT_GENERAL);
+
+	bool bPassed = GTestSuite.Check(Graph.Compile(), TestName, "compile");
+	bPassed &= GTestSuite.Check(Graph.GetTransientOffset(AsyncTemp) == Graph.GetTransientOffset(GraphicTemp), TestName, "transients on different queues are aliased");
+	bPassed &= GTestSuite.Check(Graph.GetBatchCount() == 5, TestName, "graphic and async batches are interleaved");
+	if (Graph.GetBatchCount() != 5)
+	{
+		return false;
+	}
+
+	const UHRenderGraphBatch& Batch0 = Graph.GetBatch(0);
+	const UHRenderGraphBatch& Batch1 = Graph.GetBatch(1);
+	const UHRenderGraphBatch& Batch2 = Graph.GetBatch(2);
+	const UHRenderGraphBatch& Batch3 = Graph.GetBatch(3);
+	bPassed &= GTestSuite.Check(Batch1.Queue == UHRenderGraphQueue::AsyncCompute && Batch1.Passes.size() == 1 && Batch1.Passes[0] == AsyncFilter
+		, TestName, "the pass using a transient runs on async queue");
+
+	// the content of a transient is discarded, so it's never transferred at its first use or after the graph
+	bPassed &= GTestSuite.Check(!Contains(Batch0.Releases, AsyncTemp) && !Contains(Batch1.Acquires, AsyncTemp), TestName, "no transfer at the first use");
+	bPassed &= GTestSuite.Check(Batch1.Releases.empty(), TestName, "no transfer after the last use");
+
+	bPassed &= GTestSuite.Check(Batch2.WaitBatch == 1, TestName, "the aliased transient waits the async batch");
+	bPassed &= GTestSuite.Check(Batch3.WaitBatch == UHINDEXNONE, TestName, "the later async batch waits nothing");
+
+	return bPassed;
+}
+
+bool UHRenderGraphTest::TestAliasScopes()
+{
+	const char* TestName = "AliasScopes";
+	UHRenderGraph Graph;
+
+	// a transient used as color attachment, followed by an aliased transient used by compute
+	const UHRenderGraphResource Output = Graph.ImportTexture("Output", nullptr, VK_IMAGE_LAYOUT_GENERAL, true);
+	const UHRenderGraphResource Color = Graph.CreateTransientTexture("Color", 1024, 256);
+	const UHRenderGraphResource Reuse = Graph.CreateTransientTexture("Reuse", 1024, 256);
+
+	int32_t Pass = Graph.AddPass("DrawColor", nullptr);
+	Graph.Write(Pass, Color, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL);
+
+	Pass = Graph.AddPass("BlendColor", nullptr);
+	Graph.Write(Pass, Color, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL);
+	Graph.Write(Pass, Output, VK_IMAGE_LAYOUT_GENERAL);
+
+	Pass = Graph.AddPass("WriteReuse", nullptr);
+	Graph.Write(Pass, Reuse, VK_IMAGE_LAYOUT_GENERAL);
+
+	Pass = Graph.AddPass("ReuseToOutput", nullptr);
+	Graph.Read(Pass, Reuse, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+	Graph.Write(Pass, Output, VK_IMAGE_LAYOUT_GENERAL);
+
+	bool bPassed = GTestSuite.Check(Graph.Compile(), TestName, "compile");
+	bPassed &= GTestSuite.Check(Graph.GetTransientOffset(Color) == Graph.GetTransientOffset(Reuse), TestName, "disjoint lifetimes are aliased");
+
+	// the aliased transient waits for the attachment writes of the previous alias
+	VkPipelineStageFlags2 Stages = VK_PIPELINE_STAGE_2_NONE;
+	VkAccessFlags2 Access = VK_ACCESS_2_NONE;
+	Graph.GetAliasSrcScope(Reuse, Stages, Access);
+	bPassed &= GTestSuite.Check((Stages & VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT) != 0, TestName, "waits the attachment output stage of the previous alias");
+	bPassed &= GTestSuite.Check((Access & VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT) != 0, TestName, "waits the attachment writes of the previous alias");
+	bPassed &= GTestSuite.Check((Stages & VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT) == 0, TestName, "a known alias doesn't fall back to all commands");
+
+	// the first transient in the memory could be touched outside of the graph, so it waits everything
+	Graph.GetAliasSrcScope(Color, Stages, Access);
+	bPassed &= GTestSuite.Check(Stages == VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT, TestName, "the first alias waits all commands");
+	bPassed &= GTestSuite.Check(Access == (VK_ACCESS_2_MEMORY_READ_BIT | VK_ACCESS_2_MEMORY_WRITE_BIT), TestName, "the first alias waits all memory accesses");
+
+	return bPassed;
+}
+
+#endif
@@ -0,0 +1,22 @@
+#pragma once
+#if WITH_TESTS
+
+// CPU checks of the render graph compiler, no Vulkan device is needed
+// covers pass culling, barrier derivation, transient placement, aliasing scopes and queue batching
+// run with -validategraph on the Linux target built with tests, or through ctest
+class UHRenderGraphTest
+{
+public:
+	// returns false if any check fails, the failures are printed
+	static bool Run();
+
+private:
+	static bool TestCulling();
+	static bool TestBarriers();
+	static bool TestTransientPlacement();
+	static bool TestTransientReadBeforeWrite();
+	static bool TestBatches();
+	static bool TestAsyncTransients();
+	static bool TestAliasScopes();
+};
+#endif
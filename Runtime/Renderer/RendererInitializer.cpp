@@ -14,11 +14,21 @@ UHDeferredShadingRenderer::UHDeferredShadingRenderer(UHEngine* InEngine)
 	, ConfigInterface(InEngine->GetConfigManager())
 	, TimerInterface(InEngine->GetGameTimer())
 	, RenderResolution(VkExtent2D())
+	, OutputResolution(VkExtent2D())
+	, bEnableTemporalUpscale(false)
 	, RTShadowExtent(VkExtent2D())
 	, RTIndirectLightExtent(VkExtent2D())
+	, RTReflectionMaxTiles(0)
+	, RTIndirectMaxTiles(0)
+	, RTShadowMaxTiles(0)
+	, RTRayPressure(0.5f)
+	, RTIndirectHistoryFrames(0)
+	, bIsRTShadowCacheValid(false)
+	, RTReflectionCacheStride(0)
 	, CurrentFrameGT(0)
 	, CurrentFrameRT(0)
 	, bIsResetNeededShared(false)
+	, OffscreenCapture(nullptr)
 	, CurrentScene(nullptr)
 	, SystemConstantsCPU(UHSystemConstants())
 	, CubeMesh(nullptr)
@@ -29,19 +39,20 @@ UHDeferredShadingRenderer::UHDeferredShadingRenderer(UHEngine* InEngine)
 	, OpaqueSceneTextureIndex(UHINDEXNONE)
 	, PostProcessResultIdx(0)
 	, bIsTemporalReset(true)
+	, bIsHiZValid(false)
 	, RTInstanceCount(0)
 	, NumParallelWorkers(0)
 	, NumParallelRenderSubmitters(0)
+	, NumGameWorkers(0)
 	, RenderThread(nullptr)
 	, bIsSwapChainResetGT(false)
-	, LightCullingTileSize(16)
-	, MaxPointLightPerTile(32)
-	, MaxSpotLightPerTile(32)
+	, DrawCalls(0)
+	, OccludedCalls(0)
 #if WITH_EDITOR
 	, DebugViewIndex(0)
 	, RenderThreadTime(0)
-	, DrawCalls(0)
-	, OccludedCalls(0)
+	, FrameLatency(0)
+	, FramesInFlight(0)
 	, EditorWidthDelta(0)
 	, EditorHeightDelta(0)
 	, bDrawDebugViewRT(true)
@@ -49,8 +60,11 @@ UHDeferredShadingRenderer::UHDeferredShadingRenderer(UHEngine* InEngine)
 	, bHasRefractionMaterialGT(false)
 	, MeshInstanceCount(0)
 	, bNeedGenerateSH9(true)
+	, RTCacheSettingsGT(UHVector4())
+	, bResetRTCacheGT(true)
 	, RTIndirectOcclusionBFConsts(UHBilateralFilterConstants())
 	, RTIndirectDiffuseBFConsts(UHBilateralFilterConstants())
+	, RTFilterTempMemReqs{}
 {
 	for (int32_t Idx = 0; Idx < NumOfPostProcessRT; Idx++)
 	{
@@ -89,9 +103,12 @@ bool UHDeferredShadingRenderer::Initialize(UHScene* InScene)
 	NumParallelRenderSubmitters = ConfigInterface->RenderingSetting().ParallelSubmitters;
 	NumParallelRenderSubmitters = std::clamp(NumParallelRenderSubmitters, 4, NumParallelWorkers);
 
+	// GT workers are appended after the submitters, one for uploading and the rest for culling
+	NumGameWorkers = std::max(NumParallelWorkers - NumParallelRenderSubmitters, 2);
+	NumParallelWorkers = NumParallelRenderSubmitters + NumGameWorkers;
+
 	// store render resolution 
-	RenderResolution.width = ConfigInterface->RenderingSetting().RenderWidth;
-	RenderResolution.height = ConfigInterface->RenderingSetting().RenderHeight;
+	UpdateRenderResolution();
 
 	const bool bIsRendererSuccess = InitQueueSubmitters();
 	if (bIsRendererSuccess)
@@ -105,10 +122,13 @@ bool UHDeferredShadingRenderer::Initialize(UHScene* InScene)
 		CreateThreadObjects();
 
 		// reserve enough space for renderers, save the allocation time
-		OpaquesToRender.reserve(CurrentScene->GetOpaqueRenderers().size());
-		MotionOpaquesToRender.reserve(CurrentScene->GetOpaqueRenderers().size());
-		TranslucentsToRender.reserve(CurrentScene->GetTranslucentRenderers().size());
-		OcclusionRenderers.reserve(CurrentScene->GetAllRendererCount());
+		for (uint32_t Idx = 0; Idx < GMaxFrameInFlight; Idx++)
+		{
+			OpaquesToRender[Idx].reserve(CurrentScene->GetOpaqueRenderers().size());
+			MotionOpaquesToRender[Idx].reserve(CurrentScene->GetOpaqueRenderers().size());
+			TranslucentsToRender[Idx].reserve(CurrentScene->GetTranslucentRenderers().size());
+			OcclusionRenderers[Idx].reserve(CurrentScene->GetAllRendererCount());
+		}
 
 		for (int32_t Idx = 0; Idx < MaxCountingElement; Idx++)
 		{
@@ -142,7 +162,8 @@ void UHDeferredShadingRenderer::Release()
 {
 	VkDevice LogicalDevice = GraphicInterface->GetLogicalDevice();
 
-	// end threads
+	// end threads, WaitGPU shouldn't wait the render thread after it's ended
+	GraphicInterface->SetRenderThreadWait(nullptr);
 	RenderThread->WaitTask();
 	RenderThread->EndThread();
 	for (auto& WorkerThread : WorkerThreads)
@@ -155,11 +176,23 @@ void UHDeferredShadingRenderer::Release()
 	// wait device to finish before release
 	GraphicInterface->WaitGPU();
 
+#if WITH_EDITOR
+	for (uint32_t Idx = 0; Idx < GMaxFrameInFlight; Idx++)
+	{
+		ClearEditorDrawData(Idx);
+	}
+#endif
+
 	RelaseRenderingBuffers();
 	ReleaseDataBuffers();
 	ReleaseRenderPassObjects();
 	ReleaseShaders();
 
+	// pending readbacks wait on the timeline semaphore of scene queue
+	if (OffscreenCapture != nullptr)
+	{
+		OffscreenCapture->Flush();
+	}
 	SceneRenderQueue.Release();
 	TranslucentParallelSubmitter.Release();
 
@@ -195,8 +228,6 @@ void UHDeferredShadingRenderer::PrepareMeshes()
 	// create mesh buffer for all default lit renderers
 	const std::vector<UHMeshRendererComponent*>& Renderers = CurrentScene->GetAllRenderers();
 
-	// needs the cmd buffer
-	VkCommandBuffer CreationCmd = GraphicInterface->BeginOneTimeCmd();
 	CubeMesh = AssetManagerInterface->GetMesh("UHMesh_Cube");
 	CubeMesh->CreateGPUBuffers(GraphicInterface);
 
@@ -212,7 +243,7 @@ void UHDeferredShadingRenderer::PrepareMeshes()
 
 		if (GraphicInterface->IsRayTracingEnabled())
 		{
-			Mesh->CreateBottomLevelAS(GraphicInterface, CreationCmd);
+			Mesh->CreateBottomLevelAS(GraphicInterface);
 		}
 
 		// assign buffer data index
@@ -223,13 +254,23 @@ void UHDeferredShadingRenderer::PrepareMeshes()
 			MeshInUse.push_back(Mesh);
 		}
 	}
-	GraphicInterface->EndOneTimeCmd(CreationCmd);
+
+	// mesh buffers are uploaded on transfer queue, wait for them before AS build and rendering
+	GraphicInterface->GetStagingRing()->FlushAndWait();
 
 	// create top level AS after bottom level AS is done
 	// can't be created in the same command line!! All bottom level AS must be created before creating top level AS
 	if (GraphicInterface->IsRayTracingEnabled())
 	{
-		CreationCmd = GraphicInterface->BeginOneTimeCmd();
+		// batch build & compact the bottom level AS first
+		std::vector<UHAccelerationStructure*> BottomLevelASs;
+		for (const UHMesh* Mesh : MeshInUse)
+		{
+			BottomLevelASs.push_back(Mesh->GetBottomLevelAS());
+		}
+		UHAccelerationStructure::BuildBottomASBatch(GraphicInterface, BottomLevelASs);
+
+		VkCommandBuffer CreationCmd = GraphicInterface->BeginOneTimeCmd();
 		for (int32_t Idx = 0; Idx < GMaxFrameInFlight; Idx++)
 		{
 			UH_SAFE_RELEASE(GTopLevelAS[Idx]);
@@ -237,15 +278,6 @@ void UHDeferredShadingRenderer::PrepareMeshes()
 			RTInstanceCount = GTopLevelAS[Idx]->CreateTopAS(Renderers, CreationCmd);
 		}
 		GraphicInterface->EndOneTimeCmd(CreationCmd);
-
-		// release scratch data of AS after creation
-		for (const UHMeshRendererComponent* Renderer : Renderers)
-		{
-			if (Renderer->GetMesh()->GetBottomLevelAS())
-			{
-				Renderer->GetMesh()->GetBottomLevelAS()->ReleaseScratch();
-			}
-		}
 	}
 
 	// create mesh tables
@@ -458,10 +490,13 @@ void UHDeferredShadingRenderer::PrepareRenderingShaders()
 	if (GraphicInterface->IsMeshShaderSupported())
 	{
 		MeshShaderInstancesCounter.resize(CurrentScene->GetMaterialCount());
-		SortedMeshShaderGroupIndex.resize(CurrentScene->GetMaterialCount());
-		VisibleMeshShaderData.resize(CurrentScene->GetMaterialCount());
-		MotionOpaqueMeshShaderData.resize(CurrentScene->GetMaterialCount());
-		MotionTranslucentMeshShaderData.resize(CurrentScene->GetMaterialCount());
+		for (uint32_t Idx = 0; Idx < GMaxFrameInFlight; Idx++)
+		{
+			SortedMeshShaderGroupIndex[Idx].resize(CurrentScene->GetMaterialCount());
+			VisibleMeshShaderData[Idx].resize(CurrentScene->GetMaterialCount());
+			MotionOpaqueMeshShaderData[Idx].resize(CurrentScene->GetMaterialCount());
+			MotionTranslucentMeshShaderData[Idx].resize(CurrentScene->GetMaterialCount());
+		}
 
 		for (uint32_t Idx = 0; Idx < GMaxFrameInFlight; Idx++)
 		{
@@ -473,6 +508,7 @@ void UHDeferredShadingRenderer::PrepareRenderingShaders()
 		DepthMeshShaders.resize(CurrentScene->GetMaterialCount());
 		BaseMeshShaders.resize(CurrentScene->GetMaterialCount());
 		MotionMeshShaders.resize(CurrentScene->GetMaterialCount());
+		VisibilityResolveShaders.resize(CurrentScene->GetMaterialCount());
 
 		for (UHMaterial* Mat : CurrentScene->GetMaterials())
 		{
@@ -480,12 +516,22 @@ void UHDeferredShadingRenderer::PrepareRenderingShaders()
 		}
 	}
 
-	// light culling and pass shaders
-	LightCullingShader = MakeUnique<UHLightCullingShader>(GraphicInterface, "LightCullingShader");
+	// light pass shaders
 	LightPassShader = MakeUnique<UHLightPassShader>(GraphicInterface, "LightPassShader");
 	ReflectionPassShader = MakeUnique<UHReflectionPassShader>(GraphicInterface, "ReflectionPassShader");
 	RTReflectionMipmapShader = MakeUnique<UHRTReflectionMipmap>(GraphicInterface, "RTReflectionMipmapShader");
 
+	// Hi-Z shader for amplification shader culling
+	if (GraphicInterface->IsMeshShaderSupported())
+	{
+		HiZShader = MakeUnique<UHHiZShader>(GraphicInterface, "HiZShader");
+	}
+
+	if (GraphicInterface->IsVisibilityBufferEnabled())
+	{
+		VisibilityClassifyShader = MakeUnique<UHVisibilityClassifyShader>(GraphicInterface, "VisibilityClassifyShader");
+	}
+
 	// sky pass shader
 	SkyPassShader = MakeUnique<UHSkyPassShader>(GraphicInterface, "SkyPassShader", SkyboxPassObj.RenderPass);
 	SH9Shader = MakeUnique<UHSphericalHarmonicShader>(GraphicInterface, "SH9Shader");
@@ -495,6 +541,7 @@ void UHDeferredShadingRenderer::PrepareRenderingShaders()
 
 	// post processing shaders
 	TemporalAAShader = MakeUnique<UHTemporalAAShader>(GraphicInterface, "TemporalAAShader");
+	TemporalUpscaleShader = MakeUnique<UHTemporalUpscaleShader>(GraphicInterface, "TemporalUpscaleShader");
 	ToneMapShader = MakeUnique<UHToneMappingShader>(GraphicInterface, "ToneMapShader", PostProcessPassObj[0].RenderPass);
 
 	GaussianFilterHShader = MakeUnique<UHGaussianFilterShader>(GraphicInterface, "FilterHShader", UHGaussianFilterType::FilterHorizontal);
@@ -520,6 +567,9 @@ void UHDeferredShadingRenderer::PrepareRenderingShaders()
 		RTSoftShadowShader = MakeUnique<UHRTSoftShadowShader>(GraphicInterface, "RTSoftShadowShader");
 		RTSkyReprojectionShader = MakeUnique<UHRTIndirectReprojectionShader>(GraphicInterface, "RTSkyReprojectionShader", UHRTIndirectReprojectType::SkyReprojection);
 		RTDiffuseReprojectionShader = MakeUnique<UHRTIndirectReprojectionShader>(GraphicInterface, "RTDiffuseReprojectionShader", UHRTIndirectReprojectType::DiffuseReprojection);
+		RTReflectionTileClassifyShader = MakeUnique<UHRTTileClassifyShader>(GraphicInterface, "RTReflectionTileClassifyShader", UHRTTileClassifyType::Reflection);
+		RTIndirectTileClassifyShader = MakeUnique<UHRTTileClassifyShader>(GraphicInterface, "RTIndirectTileClassifyShader", UHRTTileClassifyType::IndirectLight);
+		RTShadowTileClassifyShader = MakeUnique<UHRTTileClassifyShader>(GraphicInterface, "RTShadowTileClassifyShader", UHRTTileClassifyType::Shadow);
 	}
 
 #if WITH_EDITOR
@@ -546,12 +596,22 @@ bool UHDeferredShadingRenderer::InitQueueSubmitters()
 void UHDeferredShadingRenderer::UpdateDescriptors()
 {
 	VkDevice LogicalDevice = GraphicInterface->GetLogicalDevice();
+
+	// accumulate all writes and update them in one call
+	UHDescriptorBatchScope DescriptorBatch(LogicalDevice);
 	GSkyLightCube = GetCurrentSkyCube();
 	const bool bEnableRayTracing = ConfigInterface->RenderingSetting().bEnableRayTracing && GraphicInterface->IsRayTracingEnabled();
 
 	// ------------------------------------------------ Mesh shader descriptor update
 	if (GraphicInterface->IsMeshShaderSupported())
 	{
+		// grow visibility buffers if materials are added after creation
+		if (GraphicInterface->IsVisibilityBufferEnabled() && GVisibilityDrawArgs->GetElementCount() < CurrentScene->GetMaterialCount())
+		{
+			GraphicInterface->WaitGPU();
+			ResizeVisibilityBuffers();
+		}
+
 		for (size_t Idx = 0; Idx < CurrentScene->GetMaterialCount(); Idx++)
 		{
 			if (DepthMeshShaders[Idx] != nullptr)
@@ -568,6 +628,16 @@ void UHDeferredShadingRenderer::UpdateDescriptors()
 			{
 				MotionMeshShaders[Idx]->BindParameters();
 			}
+
+			if (VisibilityResolveShaders[Idx] != nullptr)
+			{
+				VisibilityResolveShaders[Idx]->BindParameters();
+			}
+		}
+
+		if (VisibilityClassifyShader != nullptr)
+		{
+			VisibilityClassifyShader->BindParameters();
 		}
 	}
 	else
@@ -603,9 +673,6 @@ void UHDeferredShadingRenderer::UpdateDescriptors()
 		}
 	}
 
-	// ------------------------------------------------ Lighting culling descriptor update
-	LightCullingShader->BindParameters();
-
 	// ------------------------------------------------ Lighting pass descriptor update
 	LightPassShader->BindParameters(bEnableRayTracing && ConfigInterface->RenderingSetting().bEnableRTShadow
 		, bEnableRayTracing && ConfigInterface->RenderingSetting().bEnableRTIndirectLighting);
@@ -655,22 +722,20 @@ void UHDeferredShadingRenderer::UpdateDescriptors()
 	// the post process RT binding will be in PostProcessRendering.cpp
 	ToneMapShader->BindParameters();
 	TemporalAAShader->BindParameters();
+	TemporalUpscaleShader->BindParameters();
 
 	// ------------------------------------------------ ray tracing pass descriptor update
 	if (GraphicInterface->IsRayTracingEnabled() && RTInstanceCount > 0)
 	{
 		RTMeshInstanceTable->BindStorage(GRendererInstanceBuffer.get(), 0, 0, true);
 
-		// bind RT material data
+		// bind RT material arena
 		for (int32_t FrameIdx = 0; FrameIdx < GMaxFrameInFlight; FrameIdx++)
 		{
-			std::vector<UHRenderBuffer<UHRTMaterialData>*> RTMaterialData;
-			const std::vector<UHMaterial*>& AllMaterials = CurrentScene->GetMaterials();
-			for (size_t Idx = 0; Idx < AllMaterials.size(); Idx++)
+			if (const UHRenderBuffer<UHRTMaterialData>* RTArena = GMaterialArena.GetRTArena(FrameIdx))
 			{
-				RTMaterialData.push_back(AllMaterials[Idx]->GetRTMaterialDataGPU(FrameIdx));
+				RTMaterialDataTable->BindStorage(RTArena, 0, 0, true, FrameIdx);
 			}
-			RTMaterialDataTable->BindStorage(RTMaterialData, 0, FrameIdx);
 		}
 
 		RTShadowShader->BindParameters();
@@ -682,6 +747,9 @@ void UHDeferredShadingRenderer::UpdateDescriptors()
 		RTSmoothSceneNormalHShader->BindParameters();
 		RTSmoothSceneNormalVShader->BindParameters();
 		RTSoftShadowShader->BindParameters();
+		RTReflectionTileClassifyShader->BindParameters();
+		RTIndirectTileClassifyShader->BindParameters();
+		RTShadowTileClassifyShader->BindParameters();
 	}
 
 	// ------------------------------------------------ mesh table descriptor update
@@ -689,12 +757,13 @@ void UHDeferredShadingRenderer::UpdateDescriptors()
 		|| (GraphicInterface->IsMeshShaderSupported() && MeshInstanceCount > 0))
 	{
 		// bind VB/IB table for RT or mesh shader use
-		std::vector<UHRenderBuffer<UHVector3>*> Positions;
-		std::vector<UHRenderBuffer<UHVector2>*> UVs;
-		std::vector<UHRenderBuffer<UHVector3>*> Normals;
-		std::vector<UHRenderBuffer<UHVector4>*> Tangents;
+		std::vector<UHRenderBuffer<uint32_t>*> Positions;
+		std::vector<UHRenderBuffer<uint32_t>*> UVs;
+		std::vector<UHRenderBuffer<uint32_t>*> Normals;
+		std::vector<UHRenderBuffer<uint32_t>*> Tangents;
 		std::vector<VkDescriptorBufferInfo> IndicesInfo;
 		std::vector<UHRenderBuffer<UHMeshlet>*> Meshlets;
+		std::vector<UHRenderBuffer<uint32_t>*> MeshletData;
 
 		// setup mesh data array to bind
 		for (uint32_t Idx = 0; Idx < MeshInstanceCount; Idx++)
@@ -705,6 +774,7 @@ void UHDeferredShadingRenderer::UpdateDescriptors()
 			Normals.push_back(Mesh->GetNormalBuffer());
 			Tangents.push_back(Mesh->GetTangentBuffer());
 			Meshlets.push_back(Mesh->GetMeshletBuffer());
+			MeshletData.push_back(Mesh->GetMeshletDataBuffer());
 
 			// collect index buffer info based on index type
 			VkDescriptorBufferInfo NewInfo{};
@@ -727,6 +797,7 @@ void UHDeferredShadingRenderer::UpdateDescriptors()
 		TangentTable->BindStorage(Tangents, 0);
 		IndicesTable->BindStorage(IndicesInfo, 0);
 		MeshletTable->BindStorage(Meshlets, 0);
+		MeshletDataTable->BindStorage(MeshletData, 0);
 	}
 
 	// ------------------------------------------------ debug passes descriptor update
@@ -749,20 +820,23 @@ void UHDeferredShadingRenderer::ReleaseShaders()
 
 	ClearContainer(BasePassShaders);
 	ClearContainer(BaseMeshShaders);
+	ClearContainer(VisibilityResolveShaders);
 	ClearContainer(MotionOpaqueShaders);
 	ClearContainer(MotionTranslucentShaders);
 	ClearContainer(MotionMeshShaders);
 	ClearContainer(TranslucentPassShaders);
 	ClearContainer(OcclusionPassShaders);
 
-	UH_SAFE_RELEASE(LightCullingShader);
 	UH_SAFE_RELEASE(LightPassShader);
 	UH_SAFE_RELEASE(ReflectionPassShader);
 	UH_SAFE_RELEASE(RTReflectionMipmapShader);
+	UH_SAFE_RELEASE(HiZShader);
+	UH_SAFE_RELEASE(VisibilityClassifyShader);
 	UH_SAFE_RELEASE(SkyPassShader);
 	UH_SAFE_RELEASE(SH9Shader);
 	UH_SAFE_RELEASE(MotionCameraShader);
 	UH_SAFE_RELEASE(TemporalAAShader);
+	UH_SAFE_RELEASE(TemporalUpscaleShader);
 	UH_SAFE_RELEASE(ToneMapShader);
 	UH_SAFE_RELEASE(GaussianFilterHShader);
 	UH_SAFE_RELEASE(GaussianFilterVShader);
@@ -782,6 +856,7 @@ void UHDeferredShadingRenderer::ReleaseShaders()
 		UH_SAFE_RELEASE(TangentTable);
 		UH_SAFE_RELEASE(IndicesTable);
 		UH_SAFE_RELEASE(MeshletTable);
+		UH_SAFE_RELEASE(MeshletDataTable);
 	}
 
 	if (GraphicInterface->IsRayTracingEnabled())
@@ -794,6 +869,9 @@ void UHDeferredShadingRenderer::ReleaseShaders()
 		UH_SAFE_RELEASE(RTIndirectLightShader);
 		UH_SAFE_RELEASE(RTSkyReprojectionShader);
 		UH_SAFE_RELEASE(RTDiffuseReprojectionShader);
+		UH_SAFE_RELEASE(RTReflectionTileClassifyShader);
+		UH_SAFE_RELEASE(RTIndirectTileClassifyShader);
+		UH_SAFE_RELEASE(RTShadowTileClassifyShader);
 		UH_SAFE_RELEASE(RTMeshInstanceTable);
 		UH_SAFE_RELEASE(RTMaterialDataTable);
 		UH_SAFE_RELEASE(CollectPointLightShader);
@@ -812,6 +890,19 @@ void UHDeferredShadingRenderer::ReleaseShaders()
 #endif
 }
 
+void UHDeferredShadingRenderer::UpdateRenderResolution()
+{
+	OutputResolution.width = ConfigInterface->RenderingSetting().RenderWidth;
+	OutputResolution.height = ConfigInterface->RenderingSetting().RenderHeight;
+	bEnableTemporalUpscale = ConfigInterface->RenderingSetting().bEnableTemporalUpscale;
+
+	int32_t InternalWidth = 0;
+	int32_t InternalHeight = 0;
+	ConfigInterface->GetInternalResolution(InternalWidth, InternalHeight);
+	RenderResolution.width = static_cast<uint32_t>(InternalWidth);
+	RenderResolution.height = static_cast<uint32_t>(InternalHeight);
+}
+
 void UHDeferredShadingRenderer::CreateRenderingBuffers()
 {
 	// init formats
@@ -828,25 +919,59 @@ void UHDeferredShadingRenderer::CreateRenderingBuffers()
 	UHRenderTextureSettings RenderTextureSettings{};
 	RenderTextureSettings.bIsReadWrite = true;
 
+	// GBuffers and motion vector are also read by the RT passes on async compute queue, share them instead of transferring ownership
+	UHRenderTextureSettings GBufferSettings{};
+	GBufferSettings.bIsSharedAcrossQueues = ConfigInterface->RenderingSetting().bEnableAsyncCompute;
+
 	// create GBuffers, see shader usage for each of them
-	GSceneDiffuse = GraphicInterface->RequestRenderTexture("GBufferA", RenderResolution, DiffuseFormat);
-	GSceneNormal = GraphicInterface->RequestRenderTexture("GBufferB", RenderResolution, NormalFormat);
-	GSceneMaterial = GraphicInterface->RequestRenderTexture("GBufferC", RenderResolution, SpecularFormat);
+	GSceneDiffuse = GraphicInterface->RequestRenderTexture("GBufferA", RenderResolution, DiffuseFormat, GBufferSettings);
+	GSceneNormal = GraphicInterface->RequestRenderTexture("GBufferB", RenderResolution, NormalFormat, GBufferSettings);
+	GSceneMaterial = GraphicInterface->RequestRenderTexture("GBufferC", RenderResolution, SpecularFormat, GBufferSettings);
 	GSceneResult = GraphicInterface->RequestRenderTexture("SceneResult", RenderResolution, SceneResultFormat, RenderTextureSettings);
-	GSceneMip = GraphicInterface->RequestRenderTexture("SceneMip", RenderResolution, SceneMipFormat);
-	GSceneData = GraphicInterface->RequestRenderTexture("SceneData", RenderResolution, SceneDataFormat);
+	GSceneMip = GraphicInterface->RequestRenderTexture("SceneMip", RenderResolution, SceneMipFormat, GBufferSettings);
+	GSceneData = GraphicInterface->RequestRenderTexture("SceneData", RenderResolution, SceneDataFormat, GBufferSettings);
 
 	// depth buffer, also needs another depth buffer with translucent
-	GSceneDepth = GraphicInterface->RequestRenderTexture("SceneDepth", RenderResolution, DepthFormat);
+	GSceneDepth = GraphicInterface->RequestRenderTexture("SceneDepth", RenderResolution, DepthFormat, GBufferSettings);
 	GSceneMixedDepth = GraphicInterface->RequestRenderTexture("SceneTranslucentDepth", RenderResolution, DepthFormat);
 
 	// post process buffer, use the same format as scene result
-	GPostProcessRT = GraphicInterface->RequestRenderTexture("PostProcessRT", RenderResolution, SceneResultFormat, RenderTextureSettings);
-	GPreviousSceneResult = GraphicInterface->RequestRenderTexture("PreviousResultRT", RenderResolution, HistoryResultFormat);
+	// they're at output resolution, upscaler outputs to post process RT and the rest of post processing ping-pongs with the upscaled result
+	// the history needs alpha for the lock of upscaler
+	GPostProcessRT = GraphicInterface->RequestRenderTexture("PostProcessRT", OutputResolution, SceneResultFormat, RenderTextureSettings);
+	GPreviousSceneResult = GraphicInterface->RequestRenderTexture("PreviousResultRT", OutputResolution
+		, bEnableTemporalUpscale ? SceneResultFormat : HistoryResultFormat);
+	if (bEnableTemporalUpscale)
+	{
+		GUpscaledSceneResult = GraphicInterface->RequestRenderTexture("UpscaledSceneResult", OutputResolution, SceneResultFormat, RenderTextureSettings);
+	}
 	GOpaqueSceneResult = GraphicInterface->RequestRenderTexture("OpaqueSceneResult", RenderResolution, HistoryResultFormat);
 
 	// motion vector buffer
-	GMotionVectorRT = GraphicInterface->RequestRenderTexture("MotionVectorRT", RenderResolution, MotionFormat);
+	GMotionVectorRT = GraphicInterface->RequestRenderTexture("MotionVectorRT", RenderResolution, MotionFormat, GBufferSettings);
+
+	// Hi-Z buffer for meshlet occlusion culling, it starts from half resolution and stores the farthest depth in each mip
+	if (GraphicInterface->IsMeshShaderSupported())
+	{
+		UHRenderTextureSettings HiZSettings{};
+		HiZSettings.bIsReadWrite = true;
+		HiZSettings.bUseMipmap = true;
+
+		VkExtent2D HiZResolution;
+		HiZResolution.width = std::max(RenderResolution.width >> 1, 1u);
+		HiZResolution.height = std::max(RenderResolution.height >> 1, 1u);
+		GHiZBuffer = GraphicInterface->RequestRenderTexture("HiZBuffer", HiZResolution, UHTextureFormat::UH_FORMAT_R32F, HiZSettings);
+	}
+
+	// the content is invalid until it's generated again
+	bIsHiZValid = false;
+
+	// visibility buffer, renderer and triangle IDs are output in depth pre pass
+	if (GraphicInterface->IsVisibilityBufferEnabled())
+	{
+		GSceneVisibility = GraphicInterface->RequestRenderTexture("SceneVisibility", RenderResolution, UHTextureFormat::UH_FORMAT_RG32_UINT, GBufferSettings);
+		ResizeVisibilityBuffers();
+	}
 	
 	// create history depth/normal when necessary
 	if (NeedDepthNormalHistory())
@@ -858,21 +983,16 @@ void UHDeferredShadingRenderer::CreateRenderingBuffers()
 	// rt buffers
 	ResizeRayTracingBuffers(false);
 
-	// create light culling tile buffer
-	uint32_t TileCountX, TileCountY;
-	GetLightCullingTileCount(TileCountX, TileCountY);
-
-	// data size per tile: (MaxPointLightPerTile + 1), the extra one is for the number of lights in this tile
-	// so it's TileCountX * TileCountY * (MaxPointLightPerTile + 1) in total
-	GPointLightListBuffer = GraphicInterface->RequestRenderBuffer<uint32_t>(TileCountX * TileCountY * (MaxPointLightPerTile + 1), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT
-		, "PointLightList");
-	GPointLightListTransBuffer = GraphicInterface->RequestRenderBuffer<uint32_t>(TileCountX * TileCountY * (MaxPointLightPerTile + 1), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT
-		, "PointLightListTrans");
-
-	GSpotLightListBuffer = GraphicInterface->RequestRenderBuffer<uint32_t>(TileCountX * TileCountY * (MaxSpotLightPerTile + 1), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT
-		, "SpotLightList");
-	GSpotLightListTransBuffer = GraphicInterface->RequestRenderBuffer<uint32_t>(TileCountX * TileCountY * (MaxSpotLightPerTile + 1), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT
-		, "SpotLightListTrans");
+	// create light cluster list buffers, the cluster count depends on render resolution
+	// worst case size is the offset table + a count and MaxLightsPerCluster indices for every cluster
+	LightCluster.SetResolution(RenderResolution.width, RenderResolution.height);
+	for (int32_t Idx = 0; Idx < GMaxFrameInFlight; Idx++)
+	{
+		GPointLightListBuffer[Idx] = GraphicInterface->RequestRenderBuffer<uint32_t>(LightCluster.GetListBufferElementCount(), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT
+			, "PointLightList");
+		GSpotLightListBuffer[Idx] = GraphicInterface->RequestRenderBuffer<uint32_t>(LightCluster.GetListBufferElementCount(), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT
+			, "SpotLightList");
+	}
 
 	// setup accessors after initialization
 	GSceneBuffers = { GSceneDiffuse, GSceneNormal, GSceneMaterial, GSceneResult, GSceneMip, GSceneData };
@@ -891,26 +1011,52 @@ void UHDeferredShadingRenderer::RelaseRenderingBuffers()
 	UH_SAFE_RELEASE_TEX(GSceneMixedDepth);
 	UH_SAFE_RELEASE_TEX(GPostProcessRT);
 	UH_SAFE_RELEASE_TEX(GPreviousSceneResult);
+	UH_SAFE_RELEASE_TEX(GUpscaledSceneResult);
 	UH_SAFE_RELEASE_TEX(GOpaqueSceneResult);
 	UH_SAFE_RELEASE_TEX(GMotionVectorRT);
+	UH_SAFE_RELEASE_TEX(GHiZBuffer);
+	UH_SAFE_RELEASE_TEX(GSceneVisibility);
 	UH_SAFE_RELEASE_TEX(GHistoryDepth);
 	UH_SAFE_RELEASE_TEX(GHistoryNormal);
+	UH_SAFE_RELEASE(GVisibilityDrawArgs);
+	UH_SAFE_RELEASE(GVisibilityTileList);
 
 	ReleaseRayTracingBuffers();
 
-	// point light list needs to be resized, so release it here instead in ReleaseDataBuffers()
-	UH_SAFE_RELEASE(GPointLightListBuffer);
-	UH_SAFE_RELEASE(GPointLightListTransBuffer);
-	UH_SAFE_RELEASE(GSpotLightListBuffer);
-	UH_SAFE_RELEASE(GSpotLightListTransBuffer);
+	// light list needs to be resized, so release it here instead in ReleaseDataBuffers()
+	for (int32_t Idx = 0; Idx < GMaxFrameInFlight; Idx++)
+	{
+		UH_SAFE_RELEASE(GPointLightListBuffer[Idx]);
+		UH_SAFE_RELEASE(GSpotLightListBuffer[Idx]);
+	}
+}
+
+void UHDeferredShadingRenderer::ResizeVisibilityBuffers()
+{
+	UH_SAFE_RELEASE(GVisibilityDrawArgs);
+	UH_SAFE_RELEASE(GVisibilityTileList);
+
+	// one draw args per material, and a material can cover all tiles in the worst case
+	const uint32_t MaterialCount = std::max(CurrentScene ? static_cast<uint32_t>(CurrentScene->GetMaterialCount()) : 0u, 1u);
+	const uint32_t TileCount = UHMathHelpers::RoundUpDivide(RenderResolution.width, GThreadGroup2D_X)
+		* UHMathHelpers::RoundUpDivide(RenderResolution.height, GThreadGroup2D_Y);
+
+	GVisibilityDrawArgs = GraphicInterface->RequestRenderBuffer<VkDrawIndirectCommand>(MaterialCount
+		, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT, "VisibilityDrawArgs");
+	GVisibilityTileList = GraphicInterface->RequestRenderBuffer<uint32_t>(static_cast<uint64_t>(MaterialCount) * TileCount
+		, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, "VisibilityTileList");
 }
 
 void UHDeferredShadingRenderer::CreateRenderPasses()
 {
 	// -------------------------------------------------------- Createing render pass after render pass is done -------------------------------------------------------- //
 
-	// depth prepass
-	if (GIsEditor || GraphicInterface->IsDepthPrePassEnabled())
+	// depth prepass, it also outputs visibility buffer if enabled
+	if (GraphicInterface->IsVisibilityBufferEnabled())
+	{
+		DepthPassObj = GraphicInterface->CreateRenderPass(GSceneVisibility, UHTransitionInfo(), GSceneDepth);
+	}
+	else if (GIsEditor || GraphicInterface->IsDepthPrePassEnabled())
 	{
 		DepthPassObj = GraphicInterface->CreateRenderPass(UHTransitionInfo(), GSceneDepth);
 	}
@@ -950,7 +1096,12 @@ void UHDeferredShadingRenderer::CreateRenderPasses()
 void UHDeferredShadingRenderer::CreateRenderFrameBuffers()
 {
 	// depth frame buffer
-	if (GIsEditor || GraphicInterface->IsDepthPrePassEnabled())
+	if (GraphicInterface->IsVisibilityBufferEnabled())
+	{
+		const std::vector<UHRenderTexture*> DepthBuffers = { GSceneVisibility, GSceneDepth };
+		DepthPassObj.FrameBuffer = GraphicInterface->CreateFrameBuffer(DepthBuffers, DepthPassObj.RenderPass, RenderResolution);
+	}
+	else if (GIsEditor || GraphicInterface->IsDepthPrePassEnabled())
 	{
 		DepthPassObj.FrameBuffer = GraphicInterface->CreateFrameBuffer(GSceneDepth, DepthPassObj.RenderPass, RenderResolution);
 	}
@@ -971,8 +1122,10 @@ void UHDeferredShadingRenderer::CreateRenderFrameBuffers()
 	TranslucentPassObj.FrameBuffer = SkyboxPassObj.FrameBuffer;
 
 	// post process pass, use two buffer and blit each other
-	PostProcessPassObj[0].FrameBuffer = GraphicInterface->CreateFrameBuffer(GPostProcessRT, PostProcessPassObj[0].RenderPass, RenderResolution);
-	PostProcessPassObj[1].FrameBuffer = GraphicInterface->CreateFrameBuffer(GSceneResult, PostProcessPassObj[1].RenderPass, RenderResolution);
+	// scene result is replaced by the upscaled result when upscaling, as post processing runs at output resolution
+	PostProcessPassObj[0].FrameBuffer = GraphicInterface->CreateFrameBuffer(GPostProcessRT, PostProcessPassObj[0].RenderPass, OutputResolution);
+	PostProcessPassObj[1].FrameBuffer = GraphicInterface->CreateFrameBuffer(bEnableTemporalUpscale ? GUpscaledSceneResult : GSceneResult
+		, PostProcessPassObj[1].RenderPass, OutputResolution);
 
 	// motion pass framebuffer
 	MotionCameraPassObj.FrameBuffer = GraphicInterface->CreateFrameBuffer(GMotionVectorRT, MotionCameraPassObj.RenderPass, RenderResolution);
@@ -1025,7 +1178,7 @@ void UHDeferredShadingRenderer::CreateDataBuffers()
 	{
 		GSystemConstantBuffer[Idx] = GraphicInterface->RequestRenderBuffer<UHSystemConstants>(1, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT
 			, "SystemConstant");
-		GObjectConstantBuffer[Idx] = GraphicInterface->RequestRenderBuffer<UHObjectConstants>(RendererCount, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT
+		GObjectConstantBuffer[Idx] = GraphicInterface->RequestRenderBuffer<UHObjectConstants>(RendererCount, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT
 			, "ObjectConstant");
 		GDirectionalLightBuffer[Idx] = GraphicInterface->RequestRenderBuffer<UHDirectionalLightConstants>(CurrentScene->GetDirLightCount(), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT
 			, "DirectionalLight");
@@ -1042,6 +1195,9 @@ void UHDeferredShadingRenderer::CreateDataBuffers()
 
 	GSH9Data = GraphicInterface->RequestRenderBuffer<UHSphericalHarmonicData>(1, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, "SH9Data");
 
+	// pack all material parameters into the arena, the content is filled when materials are render dirty
+	GMaterialArena.Build(GraphicInterface, CurrentScene->GetMaterials());
+
 	if (GraphicInterface->IsMeshShaderSupported() || ConfigInterface->RenderingSetting().bEnableRayTracing)
 	{
 		const size_t TotalRenderers = CurrentScene->GetOpaqueRenderers().size() + CurrentScene->GetTranslucentRenderers().size();
@@ -1071,6 +1227,7 @@ void UHDeferredShadingRenderer::CreateDataBuffers()
 			UHRendererInstance RendererInstance;
 			RendererInstance.MeshIndex = Mesh->GetBufferDataIndex();
 			RendererInstance.IndiceType = Mesh->IsIndexBufer32Bit() ? 1 : 0;
+			RendererInstance.MaterialIndex = Mat->GetBufferDataIndex();
 			RendererInstances[Renderers[Idx]->GetBufferDataIndex()] = RendererInstance;
 		}
 
@@ -1083,8 +1240,14 @@ void UHDeferredShadingRenderer::CreateDataBuffers()
 			{
 				GInstanceLightsBuffer[Idx] = GraphicInterface->RequestRenderBuffer<UHInstanceLights>(Renderers.size()
 					, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, "InstanceLights");
+				GRTCacheInvalidationBuffer[Idx] = GraphicInterface->RequestRenderBuffer<UHRTCacheInvalidation>(UHRTTileClassifyShader::MaxCacheInvalidations
+					, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, "RTCacheInvalidation");
 			}
 		}
+
+		// the bounds belong to the previous scene
+		RTCacheBoundsGT.clear();
+		bResetRTCacheGT = true;
 	}
 
 	// create occlusion query anyway in editor build
@@ -1114,7 +1277,7 @@ void UHDeferredShadingRenderer::CreateOcclusionQuery()
 
 		for (uint32_t Idx = 0; Idx < GMaxFrameInFlight; Idx++)
 		{
-			GOcclusionConstantBuffer[Idx] = GraphicInterface->RequestRenderBuffer<UHObjectConstants>(Count, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT
+			GOcclusionConstantBuffer[Idx] = GraphicInterface->RequestRenderBuffer<UHObjectConstants>(Count, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT
 				, "OcclusionConstant");
 		}
 		OcclusionConstantsCPU.resize(Count);
@@ -1164,9 +1327,14 @@ void UHDeferredShadingRenderer::CreateThreadObjects()
 	{
 		GPUTimeQueries[Idx] = GraphicInterface->RequestGPUQuery(2, VK_QUERY_TYPE_TIMESTAMP);
 	}
+#else
+	// only the RT passes are timed outside editor, they feed the adaptive ray budget
+	GPUTimeQueries[UH_ENUM_VALUE(UHRenderPassTypes::RayTracingShadow)] = GraphicInterface->RequestGPUQuery(2, VK_QUERY_TYPE_TIMESTAMP);
+	GPUTimeQueries[UH_ENUM_VALUE(UHRenderPassTypes::RayTracingReflection)] = GraphicInterface->RequestGPUQuery(2, VK_QUERY_TYPE_TIMESTAMP);
+	GPUTimeQueries[UH_ENUM_VALUE(UHRenderPassTypes::RayTracingIndirectLight)] = GraphicInterface->RequestGPUQuery(2, VK_QUERY_TYPE_TIMESTAMP);
+#endif
 	ThreadDrawCalls.resize(NumParallelRenderSubmitters);
 	ThreadOccludedCalls.resize(NumParallelRenderSubmitters);
-#endif
 
 	// create parallel submitter
 	if (GIsEditor || (ConfigInterface->RenderingSetting().bEnableDepthPrePass && !GraphicInterface->IsMeshShaderSupported()))
@@ -1198,6 +1366,7 @@ void UHDeferredShadingRenderer::CreateThreadObjects()
 	RenderThread = MakeUnique<UHThread>();
 	RenderThread->BeginThread(std::thread(&UHDeferredShadingRenderer::RenderThreadLoop, this), GRenderThreadAffinity);
 	GRenderThreadID = RenderThread->GetThreadID();
+	GraphicInterface->SetRenderThreadWait([this]() { WaitPreviousRenderTask(); });
 
 	WorkerThreads.resize(NumParallelWorkers);
 	GWorkerThreadIDs.resize(NumParallelWorkers);
@@ -1221,10 +1390,12 @@ void UHDeferredShadingRenderer::ReleaseDataBuffers()
 		UH_SAFE_RELEASE(GSpotLightBuffer[Idx]);
 		UH_SAFE_RELEASE(GTopLevelAS[Idx]);
 		UH_SAFE_RELEASE(GInstanceLightsBuffer[Idx]);
+		UH_SAFE_RELEASE(GRTCacheInvalidationBuffer[Idx]);
 	}
 
 	UH_SAFE_RELEASE(GRendererInstanceBuffer);
 	UH_SAFE_RELEASE(GSH9Data);
+	GMaterialArena.Release();
 
 	for (uint32_t Idx = 0; Idx < GMaxFrameInFlight; Idx++)
 	{
@@ -1234,10 +1405,13 @@ void UHDeferredShadingRenderer::ReleaseDataBuffers()
 	}
 
 	MeshShaderInstancesCounter.clear();
-	SortedMeshShaderGroupIndex.clear();
-	VisibleMeshShaderData.clear();
-	MotionOpaqueMeshShaderData.clear();
-	MotionTranslucentMeshShaderData.clear();
+	for (uint32_t Idx = 0; Idx < GMaxFrameInFlight; Idx++)
+	{
+		SortedMeshShaderGroupIndex[Idx].clear();
+		VisibleMeshShaderData[Idx].clear();
+		MotionOpaqueMeshShaderData[Idx].clear();
+		MotionTranslucentMeshShaderData[Idx].clear();
+	}
 }
 
 void UHDeferredShadingRenderer::RebuildTextureTable()
@@ -1314,6 +1488,7 @@ void UHDeferredShadingRenderer::RefreshMaterialShaders(UHMaterial* Mat, bool bNe
 
 	GraphicInterface->WaitGPU();
 	CheckTextureReference(std::vector<UHMaterial*>{ Mat });
+	UHDescriptorBatchScope DescriptorBatch(GraphicInterface->GetLogicalDevice());
 
 	const bool bIsOpaque = Mat->IsOpaque();
 	const int32_t MatIndex = Mat->GetBufferDataIndex();
@@ -1327,7 +1502,11 @@ void UHDeferredShadingRenderer::RefreshMaterialShaders(UHMaterial* Mat, bool bNe
 		}
 	}
 
-	if (GraphicInterface->IsMeshShaderSupported())
+	// material might not be in the scene, e.g. an instance that isn't used yet
+	const bool bIsSceneMaterial = MatIndex >= 0 && MatIndex < static_cast<int32_t>(CurrentScene->GetMaterialCount())
+		&& CurrentScene->GetMaterials()[MatIndex] == Mat;
+
+	if (GraphicInterface->IsMeshShaderSupported() && bIsSceneMaterial)
 	{
 		if (CompileFlag == UHMaterialCompileFlag::StateChangedOnly)
 		{
@@ -1341,6 +1520,11 @@ void UHDeferredShadingRenderer::RefreshMaterialShaders(UHMaterial* Mat, bool bNe
 				BaseMeshShaders[MatIndex]->RecreateMaterialState();
 			}
 
+			if (VisibilityResolveShaders[MatIndex])
+			{
+				VisibilityResolveShaders[MatIndex]->RecreateMaterialState();
+			}
+
 			if (MotionMeshShaders[MatIndex])
 			{
 				MotionMeshShaders[MatIndex]->RecreateMaterialState();
@@ -1358,6 +1542,11 @@ void UHDeferredShadingRenderer::RefreshMaterialShaders(UHMaterial* Mat, bool bNe
 				BaseMeshShaders[MatIndex]->BindParameters();
 			}
 
+			if (VisibilityResolveShaders[MatIndex])
+			{
+				VisibilityResolveShaders[MatIndex]->BindParameters();
+			}
+
 			if (MotionMeshShaders[MatIndex])
 			{
 				MotionMeshShaders[MatIndex]->BindParameters();
@@ -1399,7 +1588,30 @@ void UHDeferredShadingRenderer::RefreshMaterialShaders(UHMaterial* Mat, bool bNe
 	// mark render dirties for re-uploading constant and updating TLAS
 	Mat->SetRenderDirties(true);
 
+	// material block size could be changed after compiling, rebuild the arena layout before rebinding descriptors
+	Mat->UpdateMaterialData();
+	GMaterialArena.Build(GraphicInterface, CurrentScene->GetMaterials());
+
 	UpdateDescriptors();
+
+	// instances share the shaders of this material, refresh them as well so they don't hold released shaders
+	if (CompileFlag != UHMaterialCompileFlag::BindOnly)
+	{
+		for (UHMaterial* Instance : Mat->GetMaterialInstances())
+		{
+			if (CompileFlag == UHMaterialCompileFlag::FullCompileResave)
+			{
+				Instance->RebuildFromParent();
+			}
+			else
+			{
+				Instance->SetCullMode(Mat->GetCullMode());
+				Instance->SetBlendMode(Mat->GetBlendMode());
+			}
+			Instance->SetCompileFlag(CompileFlag);
+			RefreshMaterialShaders(Instance, bNeedReassignRendererGroup, bDelayRTShaderCreation);
+		}
+	}
 }
 
 void UHDeferredShadingRenderer::OnRendererMaterialChanged(UHMeshRendererComponent* InRenderer, UHMaterial* OldMat, UHMaterial* NewMat)
@@ -1463,6 +1675,10 @@ void UHDeferredShadingRenderer::OnRendererMaterialChanged(UHMeshRendererComponen
 	}
 	NewMat->AddReferenceObject(InRenderer);
 
+	// refresh material index of the renderer instance, it's used by hit group shaders
+	RendererInstances[RendererBufferIndex].MaterialIndex = NewMat->GetBufferDataIndex();
+	UploadRendererInstances();
+
 	if (bUseMeshShader)
 	{
 		// both old & new mesh shader needs a update
@@ -1574,6 +1790,15 @@ void UHDeferredShadingRenderer::ToggleDepthPrepass()
 			}
 		}
 
+		for (auto& Shader : VisibilityResolveShaders)
+		{
+			if (Shader != nullptr)
+			{
+				Shader->SetNewRenderPass(BasePassObj.RenderPass);
+				Shader->OnCompile();
+			}
+		}
+
 		for (auto& Shader : MotionMeshShaders)
 		{
 			if (Shader->GetMaterialCache()->IsOpaque())
@@ -1612,6 +1837,7 @@ void UHDeferredShadingRenderer::RecreateMeshTables()
 		UH_SAFE_RELEASE(TangentTable);
 		UH_SAFE_RELEASE(IndicesTable);
 		UH_SAFE_RELEASE(MeshletTable);
+		UH_SAFE_RELEASE(MeshletDataTable);
 
 		PositionTable = MakeUnique<UHMeshTable>(GraphicInterface, "PositionTable", MeshInstanceCount);
 		UV0Table = MakeUnique<UHMeshTable>(GraphicInterface, "UV0Table", MeshInstanceCount);
@@ -1619,6 +1845,7 @@ void UHDeferredShadingRenderer::RecreateMeshTables()
 		TangentTable = MakeUnique<UHMeshTable>(GraphicInterface, "TangentTable", MeshInstanceCount);
 		IndicesTable = MakeUnique<UHMeshTable>(GraphicInterface, "IndicesTable", MeshInstanceCount);
 		MeshletTable = MakeUnique<UHMeshTable>(GraphicInterface, "MeshletTable", MeshInstanceCount);
+		MeshletDataTable = MakeUnique<UHMeshTable>(GraphicInterface, "MeshletDataTable", MeshInstanceCount);
 	}
 }
 
@@ -1669,7 +1896,7 @@ void UHDeferredShadingRenderer::RecreateMeshShaders(UHMaterial* InMat)
 		, MeshletTable->GetDescriptorSetLayout()
 		, PositionTable->GetDescriptorSetLayout()
 		, UV0Table->GetDescriptorSetLayout()
-		, IndicesTable->GetDescriptorSetLayout()
+		, MeshletDataTable->GetDescriptorSetLayout()
 	};
 
 	const uint32_t MatDataIndex = InMat->GetBufferDataIndex();
@@ -1681,7 +1908,7 @@ void UHDeferredShadingRenderer::RecreateMeshShaders(UHMaterial* InMat)
 	// create depth and base shader only for the opaque, but motion pass for both opaque/translucent
 	if (InMat->IsOpaque())
 	{
-		if (GIsEditor || ConfigInterface->RenderingSetting().bEnableDepthPrePass)
+		if (GIsEditor || GraphicInterface->IsDepthPrePassEnabled())
 		{
 			UH_SAFE_RELEASE(DepthMeshShaders[MatDataIndex]);
 			DepthMeshShaders[MatDataIndex] = MakeUnique<UHDepthMeshShader>(GraphicInterface, "DepthMeshShader", DepthPassObj.RenderPass, InMat, BindlessLayouts);
@@ -1691,8 +1918,17 @@ void UHDeferredShadingRenderer::RecreateMeshShaders(UHMaterial* InMat)
 		BindlessLayouts.push_back(NormalTable->GetDescriptorSetLayout());
 		BindlessLayouts.push_back(TangentTable->GetDescriptorSetLayout());
 
-		UH_SAFE_RELEASE(BaseMeshShaders[MatDataIndex]);
-		BaseMeshShaders[MatDataIndex] = MakeUnique<UHBaseMeshShader>(GraphicInterface, "BaseMeshShader", BasePassObj.RenderPass, InMat, BindlessLayouts);
+		// visibility buffer resolves the materials instead of base mesh shader
+		if (GraphicInterface->IsVisibilityBufferEnabled())
+		{
+			UH_SAFE_RELEASE(VisibilityResolveShaders[MatDataIndex]);
+			VisibilityResolveShaders[MatDataIndex] = MakeUnique<UHVisibilityResolveShader>(GraphicInterface, "VisibilityResolveShader", BasePassObj.RenderPass, InMat, BindlessLayouts);
+		}
+		else
+		{
+			UH_SAFE_RELEASE(BaseMeshShaders[MatDataIndex]);
+			BaseMeshShaders[MatDataIndex] = MakeUnique<UHBaseMeshShader>(GraphicInterface, "BaseMeshShader", BasePassObj.RenderPass, InMat, BindlessLayouts);
+		}
 	}
 	else
 	{
@@ -1718,8 +1954,8 @@ void UHDeferredShadingRenderer::RecreateMeshShaderData(UHMaterial* InMat)
 
 	const uint32_t MatDataIndex = InMat->GetBufferDataIndex();
 
-	// count total meshlet number of a material group
-	uint32_t MeshletCountOfMaterialGroup = 0;
+	// count total instance number of a material group, meshlets are expanded by amplification shader
+	uint32_t InstanceCountOfMaterialGroup = 0;
 
 	const std::vector<UHObject*>& Objects = InMat->GetReferenceObjects();
 	for (UHObject* Obj : Objects)
@@ -1733,12 +1969,13 @@ void UHDeferredShadingRenderer::RecreateMeshShaderData(UHMaterial* InMat)
 				continue;
 			}
 
-			MeshletCountOfMaterialGroup += Mesh->GetMeshletCount();
+			InstanceCountOfMaterialGroup++;
 
 			// meanwhile, update renderer instance
 			UHRendererInstance RendererInstance;
 			RendererInstance.MeshIndex = Mesh->GetBufferDataIndex();
 			RendererInstance.IndiceType = Mesh->IsIndexBufer32Bit() ? 1 : 0;
+			RendererInstance.MaterialIndex = Mat->GetBufferDataIndex();
 			RendererInstances[Renderer->GetBufferDataIndex()] = RendererInstance;
 		}
 	}
@@ -1747,22 +1984,25 @@ void UHDeferredShadingRenderer::RecreateMeshShaderData(UHMaterial* InMat)
 	for (uint32_t Idx = 0; Idx < GMaxFrameInFlight; Idx++)
 	{
 		UH_SAFE_RELEASE(GMeshShaderData[Idx][MatDataIndex]);
-		GMeshShaderData[Idx][MatDataIndex] = GraphicInterface->RequestRenderBuffer<UHMeshShaderData>(MeshletCountOfMaterialGroup, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT
+		GMeshShaderData[Idx][MatDataIndex] = GraphicInterface->RequestRenderBuffer<UHMeshShaderData>(InstanceCountOfMaterialGroup, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT
 			, "MeshShaderData");
 
 		UH_SAFE_RELEASE(GMotionOpaqueShaderData[Idx][MatDataIndex]);
-		GMotionOpaqueShaderData[Idx][MatDataIndex] = GraphicInterface->RequestRenderBuffer<UHMeshShaderData>(MeshletCountOfMaterialGroup, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT
+		GMotionOpaqueShaderData[Idx][MatDataIndex] = GraphicInterface->RequestRenderBuffer<UHMeshShaderData>(InstanceCountOfMaterialGroup, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT
 			, "MotionOpaqueShaderData");
 
 		UH_SAFE_RELEASE(GMotionTranslucentShaderData[Idx][MatDataIndex]);
-		GMotionTranslucentShaderData[Idx][MatDataIndex] = GraphicInterface->RequestRenderBuffer<UHMeshShaderData>(MeshletCountOfMaterialGroup, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT
+		GMotionTranslucentShaderData[Idx][MatDataIndex] = GraphicInterface->RequestRenderBuffer<UHMeshShaderData>(InstanceCountOfMaterialGroup, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT
 			, "MotionTranslucentShaderData");
 	}
 
 	MeshShaderInstancesCounter[MatDataIndex] = 0;
-	VisibleMeshShaderData[MatDataIndex].reserve(MeshletCountOfMaterialGroup);
-	MotionOpaqueMeshShaderData[MatDataIndex].reserve(MeshletCountOfMaterialGroup);
-	MotionTranslucentMeshShaderData[MatDataIndex].reserve(MeshletCountOfMaterialGroup);
+	for (uint32_t Idx = 0; Idx < GMaxFrameInFlight; Idx++)
+	{
+		VisibleMeshShaderData[Idx][MatDataIndex].reserve(InstanceCountOfMaterialGroup);
+		MotionOpaqueMeshShaderData[Idx][MatDataIndex].reserve(InstanceCountOfMaterialGroup);
+		MotionTranslucentMeshShaderData[Idx][MatDataIndex].reserve(InstanceCountOfMaterialGroup);
+	}
 }
 
 void UHDeferredShadingRenderer::UploadRendererInstances()
@@ -1782,19 +2022,33 @@ void UHDeferredShadingRenderer::RecreateRTShaders(std::vector<UHMaterial*> InMat
 
 	if (bRecreateTable)
 	{
+		// collect hit group materials, material instances share the hit group of their parent
+		std::vector<UHMaterial*> HitGroupMaterials;
+		for (UHMaterial* Mat : CurrentScene->GetMaterials())
+		{
+			UHMaterial* ShaderMat = Mat->GetShaderMaterial();
+			int32_t HitGroupIndex = UHUtilities::FindIndex(HitGroupMaterials, ShaderMat);
+			if (HitGroupIndex == UHINDEXNONE)
+			{
+				HitGroupIndex = static_cast<int32_t>(HitGroupMaterials.size());
+				HitGroupMaterials.push_back(ShaderMat);
+			}
+			Mat->SetHitGroupIndex(HitGroupIndex);
+		}
+
 		// buffer for storing index type, used in hit group shader
 		UH_SAFE_RELEASE(RTMeshInstanceTable);
 		RTMeshInstanceTable = MakeUnique<UHRTMeshInstanceTable>(GraphicInterface, "RTMeshInstanceTable");
 
 		// buffer for storing texture index
 		UH_SAFE_RELEASE(RTMaterialDataTable);
-		RTMaterialDataTable = MakeUnique<UHRTMaterialDataTable>(GraphicInterface, "RTMaterialDataTable", static_cast<uint32_t>(CurrentScene->GetMaterialCount()));
+		RTMaterialDataTable = MakeUnique<UHRTMaterialDataTable>(GraphicInterface, "RTMaterialDataTable");
 
 		UH_SAFE_RELEASE(RTDefaultHitGroupShader);
-		RTDefaultHitGroupShader = MakeUnique<UHRTDefaultHitGroupShader>(GraphicInterface, "RTDefaultHitGroupShader", CurrentScene->GetMaterials());
+		RTDefaultHitGroupShader = MakeUnique<UHRTDefaultHitGroupShader>(GraphicInterface, "RTDefaultHitGroupShader", HitGroupMaterials);
 
 		UH_SAFE_RELEASE(RTMinimalHitGroupShader);
-		RTMinimalHitGroupShader = MakeUnique<UHRTMinimalHitGroupShader>(GraphicInterface, "RTMinimalHitGroupShader", CurrentScene->GetMaterials());
+		RTMinimalHitGroupShader = MakeUnique<UHRTMinimalHitGroupShader>(GraphicInterface, "RTMinimalHitGroupShader", HitGroupMaterials);
 	}
 	else
 	{
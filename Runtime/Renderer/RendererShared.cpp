@@ -8,10 +8,8 @@ UniquePtr<UHRenderBuffer<UHDirectionalLightConstants>> GDirectionalLightBuffer[G
 UniquePtr<UHRenderBuffer<UHPointLightConstants>> GPointLightBuffer[GMaxFrameInFlight];
 UniquePtr<UHRenderBuffer<UHSpotLightConstants>> GSpotLightBuffer[GMaxFrameInFlight];
 
-UniquePtr<UHRenderBuffer<uint32_t>> GPointLightListBuffer;
-UniquePtr<UHRenderBuffer<uint32_t>> GPointLightListTransBuffer;
-UniquePtr<UHRenderBuffer<uint32_t>> GSpotLightListBuffer;
-UniquePtr<UHRenderBuffer<uint32_t>> GSpotLightListTransBuffer;
+UniquePtr<UHRenderBuffer<uint32_t>> GPointLightListBuffer[GMaxFrameInFlight];
+UniquePtr<UHRenderBuffer<uint32_t>> GSpotLightListBuffer[GMaxFrameInFlight];
 
 UHRenderTexture* GSceneDiffuse;
 UHRenderTexture* GSceneNormal;
@@ -24,6 +22,7 @@ UHRenderTexture* GSceneMixedDepth;
 UHRenderTexture* GMotionVectorRT;
 UHRenderTexture* GPostProcessRT;
 UHRenderTexture* GPreviousSceneResult;
+UHRenderTexture* GUpscaledSceneResult;
 
 // accessor for GBuffers
 std::vector<UHRenderTexture*> GSceneBuffers;
@@ -45,6 +44,12 @@ UHRenderTexture* GOpaqueSceneResult;
 UHRenderTexture* GHistoryDepth;
 UHRenderTexture* GHistoryNormal;
 
+// hierarchical z
+UHRenderTexture* GHiZBuffer;
+
+// visibility buffer
+UHRenderTexture* GSceneVisibility;
+
 UHTextureCube* GSkyLightCube;
 
 UHSampler* GPointClampedSampler;
@@ -52,6 +57,7 @@ UHSampler* GLinearClampedSampler;
 UHSampler* GSkyCubeSampler;
 UHSampler* GPointClamped3DSampler;
 UHSampler* GLinearClamped3DSampler;
+UHMaterialArena GMaterialArena;
 UniquePtr<UHRenderBuffer<UHSphericalHarmonicData>> GSH9Data;
 
 UHTexture2D* GBlackTexture;
@@ -71,6 +77,8 @@ std::vector<UniquePtr<UHRenderBuffer<UHMeshShaderData>>> GMeshShaderData[GMaxFra
 std::vector<UniquePtr<UHRenderBuffer<UHMeshShaderData>>> GMotionOpaqueShaderData[GMaxFrameInFlight];
 std::vector<UniquePtr<UHRenderBuffer<UHMeshShaderData>>> GMotionTranslucentShaderData[GMaxFrameInFlight];
 UniquePtr<UHRenderBuffer<UHRendererInstance>> GRendererInstanceBuffer;
+UniquePtr<UHRenderBuffer<VkDrawIndirectCommand>> GVisibilityDrawArgs;
+UniquePtr<UHRenderBuffer<uint32_t>> GVisibilityTileList;
 
 // indirect lighting
 UHRenderTexture* GRTIndirectDiffuse;
@@ -80,6 +88,16 @@ UHRenderTexture* GRTIndirectOcclusionHistory;
 UHRenderTexture* GRTSkyData;
 UHRenderTexture* GRTSkyDiscoverAngle;
 
+// adaptive RT tiles
+UniquePtr<UHRenderBuffer<uint32_t>> GRTReflectionTileList;
+UniquePtr<UHRenderBuffer<uint32_t>> GRTReflectionRayArgs;
+UniquePtr<UHRenderBuffer<uint32_t>> GRTIndirectTileList;
+UniquePtr<UHRenderBuffer<uint32_t>> GRTIndirectRayArgs;
+UHRenderTexture* GRTIndirectTileRate;
+UniquePtr<UHRenderBuffer<uint32_t>> GRTShadowTileList;
+UniquePtr<UHRenderBuffer<uint32_t>> GRTShadowRayArgs;
+UniquePtr<UHRenderBuffer<UHRTCacheInvalidation>> GRTCacheInvalidationBuffer[GMaxFrameInFlight];
+
 VkClearColorValue GBlackClearColor = { 0.0f,0.0f,0.0f,1.0f };
 VkClearColorValue GWhiteClearColor = { 1.0f,1.0f,1.0f,1.0f };
 VkClearColorValue GTransparentClearColor = { 0.0f,0.0f,0.0f,0.0f };
@@ -5,6 +5,7 @@
 #include "../Classes/Sampler.h"
 #include "../Classes/TextureCube.h"
 #include "../Classes/AccelerationStructure.h"
+#include "MaterialArena.h"
 
 // define shared resource in renderer, the goal is to reduce parameter sending between renderer and shader
 extern UniquePtr<UHRenderBuffer<UHSystemConstants>> GSystemConstantBuffer[GMaxFrameInFlight];
@@ -14,11 +15,9 @@ extern UniquePtr<UHRenderBuffer<UHDirectionalLightConstants>> GDirectionalLightB
 extern UniquePtr<UHRenderBuffer<UHPointLightConstants>> GPointLightBuffer[GMaxFrameInFlight];
 extern UniquePtr<UHRenderBuffer<UHSpotLightConstants>> GSpotLightBuffer[GMaxFrameInFlight];
 
-// light culling
-extern UniquePtr<UHRenderBuffer<uint32_t>> GPointLightListBuffer;
-extern UniquePtr<UHRenderBuffer<uint32_t>> GPointLightListTransBuffer;
-extern UniquePtr<UHRenderBuffer<uint32_t>> GSpotLightListBuffer;
-extern UniquePtr<UHRenderBuffer<uint32_t>> GSpotLightListTransBuffer;
+// clustered light lists, uploaded by CPU every frame
+extern UniquePtr<UHRenderBuffer<uint32_t>> GPointLightListBuffer[GMaxFrameInFlight];
+extern UniquePtr<UHRenderBuffer<uint32_t>> GSpotLightListBuffer[GMaxFrameInFlight];
 
 // render textures
 extern UHRenderTexture* GSceneDiffuse;
@@ -34,9 +33,14 @@ extern UHRenderTexture* GSceneMixedDepth;
 extern UHRenderTexture* GMotionVectorRT;
 extern UHRenderTexture* GPostProcessRT;
 extern UHRenderTexture* GPreviousSceneResult;
+extern UHRenderTexture* GUpscaledSceneResult;
 extern UHRenderTexture* GOpaqueSceneResult;
 extern UHRenderTexture* GHistoryDepth;
 extern UHRenderTexture* GHistoryNormal;
+// hierarchical z for meshlet occlusion culling
+extern UHRenderTexture* GHiZBuffer;
+// visibility buffer, x = renderer index + 1 (0 for empty), y = meshlet index * max primitive + primitive index
+extern UHRenderTexture* GSceneVisibility;
 
 // accessor for GBuffers
 extern std::vector<UHRenderTexture*> GSceneBuffers;
@@ -60,6 +64,9 @@ extern UHSampler* GSkyCubeSampler;
 extern UHSampler* GPointClamped3DSampler;
 extern UHSampler* GLinearClamped3DSampler;
 
+// material parameter arena, shared by all material shaders
+extern UHMaterialArena GMaterialArena;
+
 // SH9 data
 extern UniquePtr<UHRenderBuffer<UHSphericalHarmonicData>> GSH9Data;
 
@@ -88,6 +95,10 @@ extern std::vector<UniquePtr<UHRenderBuffer<UHMeshShaderData>>> GMotionTransluce
 // this is also used for ray tracing
 extern UniquePtr<UHRenderBuffer<UHRendererInstance>> GRendererInstanceBuffer;
 
+// visibility buffer material classification, indirect draw args and screen tile list per material
+extern UniquePtr<UHRenderBuffer<VkDrawIndirectCommand>> GVisibilityDrawArgs;
+extern UniquePtr<UHRenderBuffer<uint32_t>> GVisibilityTileList;
+
 // indirect lighting, RT buffers + cache + result buffer
 extern UHRenderTexture* GRTIndirectDiffuse;
 extern UHRenderTexture* GRTIndirectDiffuseHistory;
@@ -96,6 +107,18 @@ extern UHRenderTexture* GRTIndirectOcclusionHistory;
 extern UHRenderTexture* GRTSkyData;
 extern UHRenderTexture* GRTSkyDiscoverAngle;
 
+// adaptive RT tiles, the tile list and trace rays indirect args of each pass, and the tile rates for the indirect light denoiser
+extern UniquePtr<UHRenderBuffer<uint32_t>> GRTReflectionTileList;
+extern UniquePtr<UHRenderBuffer<uint32_t>> GRTReflectionRayArgs;
+extern UniquePtr<UHRenderBuffer<uint32_t>> GRTIndirectTileList;
+extern UniquePtr<UHRenderBuffer<uint32_t>> GRTIndirectRayArgs;
+extern UHRenderTexture* GRTIndirectTileRate;
+extern UniquePtr<UHRenderBuffer<uint32_t>> GRTShadowTileList;
+extern UniquePtr<UHRenderBuffer<uint32_t>> GRTShadowRayArgs;
+
+// world boxes that invalidate the cached RT shadow and reflection results, uploaded by CPU every frame
+extern UniquePtr<UHRenderBuffer<UHRTCacheInvalidation>> GRTCacheInvalidationBuffer[GMaxFrameInFlight];
+
 // common clear colors
 extern VkClearColorValue GBlackClearColor;
 extern VkClearColorValue GWhiteClearColor;
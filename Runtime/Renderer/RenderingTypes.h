@@ -24,6 +24,8 @@ const uint32_t GThreadGroup1D = 64;
 const uint32_t GThreadGroup3D_X = 4;
 const uint32_t GThreadGroup3D_Y = 4;
 const uint32_t GThreadGroup3D_Z = 4;
+// sync with AMPLIFICATION_GROUP_SIZE in UHMeshShaderCommon.hlsli
+const uint32_t GAmplificationGroupSize = 32;
 
 // descriptor set space number
 const uint32_t GTextureTableSpace = 1;
@@ -61,11 +63,11 @@ struct UHSystemConstants
 	float JitterScaleMin;
 	float JitterScaleFactor;
 	uint32_t NumPointLights;
-	uint32_t LightTileCountX;
+	uint32_t LightClusterCountX;
 
-	uint32_t MaxPointLightPerTile;
+	uint32_t LightClusterCountY;
 	uint32_t NumSpotLights;
-	uint32_t MaxSpotLightPerTile;
+	uint32_t LightClusterCountZ;
 	uint32_t FrameNumber;
 	
 	// the feature shall be able to store up to 32 flag bits without issues
@@ -94,20 +96,26 @@ struct UHSystemConstants
 	float ScreenMipCount;
 	float RTReflectionMipCount;
 	float FarPlane;
+
+	// cluster slice = log(view depth) * scale + bias
+	float LightClusterSliceScale;
+	float LightClusterSliceBias;
+	uint32_t LightClusterTileSize;
+	uint32_t LightClusterPadding;
 };
 
+// packed per-renderer record, read as a structured buffer by instance index
+// world matrices are stored as 3x4 affine, normal matrix is reconstructed in shader
 struct UHObjectConstants
 {
-	UHGPUMatrix GWorld;
-	UHGPUMatrix GWorldIT;
-	UHGPUMatrix GPrevWorld;
-	uint32_t InstanceIndex;
+	UHGPUMatrix3x4 GWorld;
+	UHGPUMatrix3x4 GPrevWorld;
 	UHVector3 WorldPos;
+	uint32_t InstanceIndex;
 	UHVector3 BoundExtent;
-	
-	// align to 256 bytes
-	float CPUPadding[9];
+	uint32_t ObjectFlags;
 };
+static_assert(sizeof(UHObjectConstants) == 128, "UHObjectConstants must be 128 bytes, sync with ObjectConstants in UHInputs.hlsli");
 
 struct UHDirectionalLightConstants
 {
@@ -160,8 +168,10 @@ enum class UHRenderPassTypes : uint32_t
 {
 	OcclusionResolve = 0,
 	DepthPrePass,
+	VisibilityClassifyPass,
 	OcclusionPass,
 	BasePass,
+	MaterialResolvePass,
 	UpdateTopLevelAS,
 	CollectLightPass,
 	GenerateSH9,
@@ -172,16 +182,17 @@ enum class UHRenderPassTypes : uint32_t
 	RayTracingIndirectLight,
 	RayTracingReflection,
 	ReflectionBlurPass,
-	LightCulling,
 	LightPass,
 	IndirectLightPass,
 	SkyPass,
 	MotionPass,
+	HiZPass,
 	PreReflectionPass,
 	ReflectionPass,
 	TranslucentPass,
 	ToneMappingPass,
 	TemporalAAPass,
+	TemporalUpscalePass,
 	HistoryCopyingPass,
 	PresentToSwapChain,
 	UHRenderPassMax
@@ -340,9 +351,16 @@ enum class UHSystemRenderFeatureBits : uint32_t
 	FeatureHDR = 1 << 1,
 	FeatureUseSmoothNormalForRaytracing = 1 << 2,
 	FeatureRTIndirectLight = 1 << 3,
+	FeatureVertexCompression = 1 << 4,
 	FeatureDebug = 1U << 31,
 };
 
+// object flags stored in UHObjectConstants, sync with UH_OBJ_ flags in UHInputs.hlsli
+enum class UHObjectFlagBits : uint32_t
+{
+	ObjectMirrored = 1 << 0,
+};
+
 // constant types
 enum class UHConstantTypes : uint32_t
 {
@@ -357,14 +375,38 @@ struct UHRendererInstance
 {
 	uint32_t MeshIndex;
 	uint32_t IndiceType;
+	uint32_t MaterialIndex;
 };
 
-// mesh shader data
+// mesh shader data, one record per visible instance
+// meshlet offset is the prefix sum of meshlet counts in the group, amplification shader expands the instance to meshlets
 struct UHMeshShaderData
 {
 	uint32_t RendererIndex;
-	uint32_t MeshletIndex;
-	uint32_t bDoOcclusionTest;
+	uint32_t MeshletOffset;
+	uint32_t MeshletCount;
+	uint32_t Flags;
+};
+
+// sync with the defines in UHMeshShaderCommon.hlsli
+enum class UHMeshShaderFlagBits : uint32_t
+{
+	OcclusionTest = 1 << 0,
+	ConeCulling = 1 << 1
+};
+
+// push constant for amplification shader
+struct UHMeshShaderConstants
+{
+	uint32_t InstanceCount;
+	uint32_t MeshletCount;
+	uint32_t bEnableHiZ;
+};
+
+// push constant for visibility buffer material resolve, the material index of current draw
+struct UHVisibilityResolveConstants
+{
+	uint32_t MaterialIndex;
 };
 
 // UHInstanceLights to store light indices per-instance
@@ -374,4 +416,19 @@ struct UHInstanceLights
 {
 	uint32_t PointLightIndices[GMaxPointSpotLightPerInstance];
 	uint32_t SpotLightIndices[GMaxPointSpotLightPerInstance];
+};
+
+// RT result cache invalidation flags, sync with RT_CACHE_INVALIDATE_ flags in RTTileClassifyComputeShader.hlsl
+enum class UHRTCacheInvalidationBits : uint32_t
+{
+	InvalidateRenderer = 1 << 0,
+};
+
+// a world box that invalidates the cached RT shadow and reflection results it touches
+struct UHRTCacheInvalidation
+{
+	UHVector3 Center = UHVector3();
+	uint32_t Flags = 0;
+	UHVector3 Extents = UHVector3();
+	float Padding = 0.0f;
 };
\ No newline at end of file
@@ -8,18 +8,19 @@ UHBasePassShader::UHBasePassShader(UHGraphic* InGfx, std::string Name, VkRenderP
 	// DeferredPass: Bind all constants, visiable in VS/PS only
 	for (int32_t Idx = 0; Idx < UH_ENUM_VALUE(UHConstantTypes::ConstantTypeMax); Idx++)
 	{
-		if (Idx != UH_ENUM_VALUE(UHConstantTypes::Material))
+		if (Idx == UH_ENUM_VALUE(UHConstantTypes::Object))
 		{
-			AddLayoutBinding(1, VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER);
+			// object constants are fetched by instance index
+			AddLayoutBinding(1, VK_SHADER_STAGE_VERTEX_BIT, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER);
 		}
-		else
+		else if (Idx != UH_ENUM_VALUE(UHConstantTypes::Material))
 		{
-			AddLayoutBinding(1, VK_SHADER_STAGE_FRAGMENT_BIT, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER);
+			AddLayoutBinding(1, VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER);
 		}
 	}
 
-	// bind UV0/Normal/Tangent buffer
-	AddLayoutBinding(1, VK_SHADER_STAGE_VERTEX_BIT, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER);
+	// bind UV0/Normal/Tangent buffer, binding 2 is left empty as material constants are bound from the material arena set
+	AddLayoutBinding(1, VK_SHADER_STAGE_VERTEX_BIT, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 3);
 	AddLayoutBinding(1, VK_SHADER_STAGE_VERTEX_BIT, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER);
 	AddLayoutBinding(1, VK_SHADER_STAGE_VERTEX_BIT, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER);
 
@@ -44,7 +45,7 @@ void UHBasePassShader::OnCompile()
 	ShaderVS = Gfx->RequestShader("BaseVertexShader", "Shaders/BaseVertexShader.hlsl", "BaseVS", "vs_6_0", MaterialCache->GetShaderDefines());
 	UHMaterialCompileData Data{};
 	Data.MaterialCache = MaterialCache;
-	ShaderPS = Gfx->RequestMaterialShader("BasePixelShader", "Shaders/BasePixelShader.hlsl", "BasePS", "ps_6_0", Data, MaterialCache->GetShaderDefines());
+	ShaderPS = Gfx->RequestMaterialShader("BasePixelShader", "Shaders/BasePixelShader.hlsl", "BasePS", "ps_6_0", Data, GetMaterialDefines());
 	
 	// states
 	MaterialPassInfo = UHRenderPassInfo(RenderPassCache
@@ -65,8 +66,7 @@ void UHBasePassShader::OnCompile()
 void UHBasePassShader::BindParameters(const UHMeshRendererComponent* InRenderer)
 {
 	BindConstant(GSystemConstantBuffer, 0, 0);
-	BindConstant(GObjectConstantBuffer, 1, InRenderer->GetBufferDataIndex());
-	BindConstant(MaterialCache->GetMaterialConst(), 2, 0);
+	BindStorage(GObjectConstantBuffer, 1, 0, true);
 
 	UHMesh* Mesh = InRenderer->GetMesh();
 	BindStorage(Mesh->GetUV0Buffer(), 3, 0, true);
@@ -78,18 +78,22 @@ UHBaseMeshShader::UHBaseMeshShader(UHGraphic* InGfx, std::string Name, VkRenderP
 	: UHShaderClass(InGfx, Name, typeid(UHBaseMeshShader), InMat, InRenderPass)
 {
 	// system
-	AddLayoutBinding(1, VK_SHADER_STAGE_FRAGMENT_BIT | VK_SHADER_STAGE_MESH_BIT_EXT, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER);
+	AddLayoutBinding(1, VK_SHADER_STAGE_FRAGMENT_BIT | VK_SHADER_STAGE_MESH_BIT_EXT | VK_SHADER_STAGE_TASK_BIT_EXT, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER);
 
 	// object constant
-	AddLayoutBinding(1, VK_SHADER_STAGE_MESH_BIT_EXT, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER);
+	AddLayoutBinding(1, VK_SHADER_STAGE_MESH_BIT_EXT | VK_SHADER_STAGE_TASK_BIT_EXT, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER);
 
-	// material
-	AddLayoutBinding(1, VK_SHADER_STAGE_FRAGMENT_BIT, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER);
+	// current mesh shader data, occlusion result, renderer instances and Hi-Z
+	// binding 2 is left empty, material constants are bound from the material arena set
+	AddLayoutBinding(1, VK_SHADER_STAGE_TASK_BIT_EXT, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 3);
+	AddLayoutBinding(1, VK_SHADER_STAGE_TASK_BIT_EXT, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER);
+	AddLayoutBinding(1, VK_SHADER_STAGE_MESH_BIT_EXT | VK_SHADER_STAGE_TASK_BIT_EXT, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER);
+	AddLayoutBinding(1, VK_SHADER_STAGE_TASK_BIT_EXT, VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE);
 
-	// current mesh shader data and renderer instances
-	AddLayoutBinding(1, VK_SHADER_STAGE_MESH_BIT_EXT, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER);
-	AddLayoutBinding(1, VK_SHADER_STAGE_MESH_BIT_EXT, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER);
-	AddLayoutBinding(1, VK_SHADER_STAGE_MESH_BIT_EXT, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER);
+	// instance and meshlet count for amplification shader
+	PushConstantRange.offset = 0;
+	PushConstantRange.stageFlags = VK_SHADER_STAGE_TASK_BIT_EXT;
+	PushConstantRange.size = sizeof(UHMeshShaderConstants);
 
 	CreateLayoutAndDescriptor(ExtraLayouts);
 
@@ -103,16 +107,18 @@ void UHBaseMeshShader::OnCompile()
 	{
 		// restore cached value
 		const UHRenderPassInfo& PassInfo = GetState()->GetRenderPassInfo();
+		ShaderAS = PassInfo.AS;
 		ShaderMS = PassInfo.MS;
 		ShaderPS = PassInfo.PS;
 		MaterialPassInfo = PassInfo;
 		return;
 	}
 
+	ShaderAS = Gfx->RequestShader("BaseAmplificationShader", "Shaders/BaseAmplificationShader.hlsl", "BaseAS", "as_6_5");
 	ShaderMS = Gfx->RequestShader("BaseMeshShader", "Shaders/BaseMeshShader.hlsl", "BaseMS", "ms_6_5", MaterialCache->GetShaderDefines());
 	UHMaterialCompileData Data{};
 	Data.MaterialCache = MaterialCache;
-	ShaderPS = Gfx->RequestMaterialShader("BasePixelShader", "Shaders/BasePixelShader.hlsl", "BasePS", "ps_6_0", Data, MaterialCache->GetShaderDefines());
+	ShaderPS = Gfx->RequestMaterialShader("BasePixelShader", "Shaders/BasePixelShader.hlsl", "BasePS", "ps_6_0", Data, GetMaterialDefines());
 
 	// states
 	MaterialPassInfo = UHRenderPassInfo(RenderPassCache
@@ -124,6 +130,7 @@ void UHBaseMeshShader::OnCompile()
 		, ShaderPS
 		, GNumOfGBuffers
 		, PipelineLayout);
+	MaterialPassInfo.AS = ShaderAS;
 	MaterialPassInfo.MS = ShaderMS;
 	MaterialPassInfo.bIsIntegerBuffer = { false,false,false,false,false,true };
 
@@ -134,7 +141,6 @@ void UHBaseMeshShader::BindParameters()
 {
 	BindConstant(GSystemConstantBuffer, 0, 0);
 	BindStorage(GObjectConstantBuffer, 1, 0, true);
-	BindConstant(MaterialCache->GetMaterialConst(), 2, 0);
 
 	for (uint32_t Idx = 0; Idx < GMaxFrameInFlight; Idx++)
 	{
@@ -149,4 +155,5 @@ void UHBaseMeshShader::BindParameters()
 	}
 
 	BindStorage(GRendererInstanceBuffer.get(), 5, 0, true);
+	BindImage(GHiZBuffer, 6);
 }
\ No newline at end of file
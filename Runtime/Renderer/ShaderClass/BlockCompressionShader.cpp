@@ -1,6 +1,6 @@
 #include "BlockCompressionShader.h"
 
-#if WITH_EDITOR
+#if WITH_EDITOR || WITH_COOKER
 UHBlockCompressionShader::UHBlockCompressionShader(UHGraphic* InGfx, std::string Name, std::string InEntry)
 	: UHShaderClass(InGfx, Name, typeid(UHBlockCompressionShader))
 	, EntryFunction(InEntry)
@@ -1,7 +1,7 @@
 #pragma once
 #include "ShaderClass.h"
 
-#if WITH_EDITOR
+#if WITH_EDITOR || WITH_COOKER
 class UHBlockCompressionShader : public UHShaderClass
 {
 public:
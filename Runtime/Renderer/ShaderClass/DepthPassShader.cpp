@@ -9,18 +9,19 @@ UHDepthPassShader::UHDepthPassShader(UHGraphic* InGfx, std::string Name, VkRende
 	// Depth pass: Bind all constants, visiable in VS/PS only
 	for (int32_t Idx = 0; Idx < UH_ENUM_VALUE(UHConstantTypes::ConstantTypeMax); Idx++)
 	{
-		if (Idx != UH_ENUM_VALUE(UHConstantTypes::Material))
+		if (Idx == UH_ENUM_VALUE(UHConstantTypes::Object))
 		{
-			AddLayoutBinding(1, VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER);
+			// object constants are fetched by instance index
+			AddLayoutBinding(1, VK_SHADER_STAGE_VERTEX_BIT, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER);
 		}
-		else
+		else if (Idx != UH_ENUM_VALUE(UHConstantTypes::Material))
 		{
-			AddLayoutBinding(1, VK_SHADER_STAGE_FRAGMENT_BIT, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER);
+			AddLayoutBinding(1, VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER);
 		}
 	}
 
-	// bind UV0 Buffer
-	AddLayoutBinding(1, VK_SHADER_STAGE_VERTEX_BIT, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER);
+	// bind UV0 Buffer, binding 2 is left empty as material constants are bound from the material arena set
+	AddLayoutBinding(1, VK_SHADER_STAGE_VERTEX_BIT, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 3);
 
 	// textures and samplers will be bound on fly instead, since I go with bindless rendering
 	CreateLayoutAndDescriptor(ExtraLayouts);
@@ -45,7 +46,7 @@ void UHDepthPassShader::OnCompile()
 	{
 		UHMaterialCompileData Data;
 		Data.MaterialCache = MaterialCache;
-		ShaderPS = Gfx->RequestMaterialShader("DepthPassPS", "Shaders/DepthPixelShader.hlsl", "DepthPS", "ps_6_0", Data, MaterialCache->GetShaderDefines());
+		ShaderPS = Gfx->RequestMaterialShader("DepthPassPS", "Shaders/DepthPixelShader.hlsl", "DepthPS", "ps_6_0", Data, GetMaterialDefines());
 	}
 
 	ShaderVS = Gfx->RequestShader("DepthPassVS", "Shaders/DepthVertexShader.hlsl", "DepthVS", "vs_6_0", MaterialCache->GetShaderDefines());
@@ -65,8 +66,7 @@ void UHDepthPassShader::OnCompile()
 void UHDepthPassShader::BindParameters(const UHMeshRendererComponent* InRenderer)
 {
 	BindConstant(GSystemConstantBuffer, 0, 0);
-	BindConstant(GObjectConstantBuffer, 1, InRenderer->GetBufferDataIndex());
-	BindConstant(MaterialCache->GetMaterialConst(), 2, 0);
+	BindStorage(GObjectConstantBuffer, 1, 0, true);
 
 	UHMesh* Mesh = InRenderer->GetMesh();
 	BindStorage(Mesh->GetUV0Buffer(), 3, 0, true);
@@ -77,17 +77,22 @@ UHDepthMeshShader::UHDepthMeshShader(UHGraphic* InGfx, std::string Name, VkRende
 	: UHShaderClass(InGfx, Name, typeid(UHDepthMeshShader), InMat, InRenderPass)
 {
 	// system
-	AddLayoutBinding(1, VK_SHADER_STAGE_FRAGMENT_BIT | VK_SHADER_STAGE_MESH_BIT_EXT, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER);
+	AddLayoutBinding(1, VK_SHADER_STAGE_FRAGMENT_BIT | VK_SHADER_STAGE_MESH_BIT_EXT | VK_SHADER_STAGE_TASK_BIT_EXT, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER);
 
 	// object constant
-	AddLayoutBinding(1, VK_SHADER_STAGE_MESH_BIT_EXT, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER);
+	AddLayoutBinding(1, VK_SHADER_STAGE_MESH_BIT_EXT | VK_SHADER_STAGE_TASK_BIT_EXT, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER);
 
-	// material
-	AddLayoutBinding(1, VK_SHADER_STAGE_FRAGMENT_BIT, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER);
+	// current mesh shader data, occlusion result, renderer instances and Hi-Z
+	// binding 2 is left empty, material constants are bound from the material arena set
+	AddLayoutBinding(1, VK_SHADER_STAGE_TASK_BIT_EXT, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 3);
+	AddLayoutBinding(1, VK_SHADER_STAGE_TASK_BIT_EXT, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER);
+	AddLayoutBinding(1, VK_SHADER_STAGE_MESH_BIT_EXT | VK_SHADER_STAGE_TASK_BIT_EXT, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER);
+	AddLayoutBinding(1, VK_SHADER_STAGE_TASK_BIT_EXT, VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE);
 
-	// current mesh shader data and renderer instances
-	AddLayoutBinding(1, VK_SHADER_STAGE_MESH_BIT_EXT, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER);
-	AddLayoutBinding(1, VK_SHADER_STAGE_MESH_BIT_EXT, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER);
+	// instance and meshlet count for amplification shader
+	PushConstantRange.offset = 0;
+	PushConstantRange.stageFlags = VK_SHADER_STAGE_TASK_BIT_EXT;
+	PushConstantRange.size = sizeof(UHMeshShaderConstants);
 
 	CreateLayoutAndDescriptor(ExtraLayouts);
 
@@ -101,20 +106,30 @@ void UHDepthMeshShader::OnCompile()
 	{
 		// restore cached value
 		const UHRenderPassInfo& PassInfo = GetState()->GetRenderPassInfo();
+		ShaderAS = PassInfo.AS;
 		ShaderMS = PassInfo.MS;
 		ShaderPS = PassInfo.PS;
 		MaterialPassInfo = PassInfo;
 		return;
 	}
 
-	if (MaterialCache->GetBlendMode() == UHBlendMode::Masked)
+	// visibility buffer outputs instance and triangle IDs in depth pass, so the pixel shader is always needed
+	const bool bVisibilityBuffer = Gfx->IsVisibilityBufferEnabled();
+	std::vector<std::string> Defines = GetMaterialDefines();
+	if (bVisibilityBuffer)
+	{
+		Defines.push_back("VISIBILITY_BUFFER");
+	}
+
+	if (MaterialCache->GetBlendMode() == UHBlendMode::Masked || bVisibilityBuffer)
 	{
 		UHMaterialCompileData Data;
 		Data.MaterialCache = MaterialCache;
-		ShaderPS = Gfx->RequestMaterialShader("DepthPassPS", "Shaders/DepthPixelShader.hlsl", "DepthPS", "ps_6_0", Data, MaterialCache->GetShaderDefines());
+		ShaderPS = Gfx->RequestMaterialShader("DepthPassPS", "Shaders/DepthPixelShader.hlsl", "DepthPS", "ps_6_0", Data, Defines);
 	}
 
-	ShaderMS = Gfx->RequestShader("DepthMeshShader", "Shaders/DepthMeshShader.hlsl", "DepthMS", "ms_6_5", MaterialCache->GetShaderDefines());
+	ShaderAS = Gfx->RequestShader("BaseAmplificationShader", "Shaders/BaseAmplificationShader.hlsl", "BaseAS", "as_6_5");
+	ShaderMS = Gfx->RequestShader("DepthMeshShader", "Shaders/DepthMeshShader.hlsl", "DepthMS", "ms_6_5", Defines);
 
 	// states
 	MaterialPassInfo = UHRenderPassInfo(RenderPassCache, UHDepthInfo(true, true, VK_COMPARE_OP_GREATER)
@@ -124,7 +139,12 @@ void UHDepthMeshShader::OnCompile()
 		, ShaderPS
 		, 1
 		, PipelineLayout);
+	MaterialPassInfo.AS = ShaderAS;
 	MaterialPassInfo.MS = ShaderMS;
+	if (bVisibilityBuffer)
+	{
+		MaterialPassInfo.bIsIntegerBuffer = { true };
+	}
 
 	RecreateMaterialState();
 }
@@ -133,12 +153,19 @@ void UHDepthMeshShader::BindParameters()
 {
 	BindConstant(GSystemConstantBuffer, 0, 0);
 	BindStorage(GObjectConstantBuffer, 1, 0, true);
-	BindConstant(MaterialCache->GetMaterialConst(), 2, 0);
 
 	for (uint32_t Idx = 0; Idx < GMaxFrameInFlight; Idx++)
 	{
 		BindStorage(GMeshShaderData[Idx][MaterialCache->GetBufferDataIndex()].get(), 3, 0, true, Idx);
+
+		// use the occlusion result from the previous frame
+		const uint32_t PrevFrame = (Idx - 1) % GMaxFrameInFlight;
+		if (GOcclusionResult[PrevFrame] != nullptr)
+		{
+			BindStorage(GOcclusionResult[PrevFrame].get(), 4, 0, true);
+		}
 	}
 
-	BindStorage(GRendererInstanceBuffer.get(), 4, 0, true);
+	BindStorage(GRendererInstanceBuffer.get(), 5, 0, true);
+	BindImage(GHiZBuffer, 6);
 }
\ No newline at end of file
@@ -0,0 +1,39 @@
+#include "HiZShader.h"
+#include "../RenderBuilder.h"
+
+UHHiZShader::UHHiZShader(UHGraphic* InGfx, std::string Name)
+	: UHShaderClass(InGfx, Name, typeid(UHHiZShader))
+{
+	AddLayoutBinding(1, VK_SHADER_STAGE_COMPUTE_BIT, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE);
+	AddLayoutBinding(1, VK_SHADER_STAGE_COMPUTE_BIT, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE);
+	AddLayoutBinding(1, VK_SHADER_STAGE_COMPUTE_BIT, VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE);
+
+	PushConstantRange.offset = 0;
+	PushConstantRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+	PushConstantRange.size = sizeof(UHHiZConstants);
+	bPushDescriptor = true;
+
+	CreateLayoutAndDescriptor();
+	OnCompile();
+}
+
+void UHHiZShader::OnCompile()
+{
+	ShaderCS = Gfx->RequestShader("HiZShader", "Shaders/HiZ.hlsl", "GenerateHiZCS", "cs_6_0");
+
+	// state
+	UHComputePassInfo Info(PipelineLayout);
+	Info.CS = ShaderCS;
+
+	CreateComputeState(Info);
+}
+
+void UHHiZShader::BindTextures(UHRenderBuilder& RenderBuilder, UHTexture* InDepth, UHTexture* InHiZ, const uint32_t OutputMipIdx)
+{
+	// mip 0 is downsampled from scene depth, the input slot still needs a valid image so simply push the output mip
+	const uint32_t InputMipIdx = (OutputMipIdx > 0) ? OutputMipIdx - 1 : 0;
+	PushImage(InHiZ, 0, true, InputMipIdx);
+	PushImage(InHiZ, 1, true, OutputMipIdx);
+	PushImage(InDepth, 2, false, UHINDEXNONE);
+	FlushPushDescriptor(RenderBuilder.GetCmdList());
+}
@@ -0,0 +1,22 @@
+#pragma once
+#include "ShaderClass.h"
+
+struct UHHiZConstants
+{
+	uint32_t InputWidth;
+	uint32_t InputHeight;
+	uint32_t OutputWidth;
+	uint32_t OutputHeight;
+	uint32_t bFromSceneDepth;
+};
+
+class UHRenderBuilder;
+class UHHiZShader : public UHShaderClass
+{
+public:
+	UHHiZShader(UHGraphic* InGfx, std::string Name);
+
+	virtual void OnCompile() override;
+
+	void BindTextures(UHRenderBuilder& RenderBuilder, UHTexture* InDepth, UHTexture* InHiZ, const uint32_t OutputMipIdx);
+};
@@ -1,12 +0,0 @@
-#pragma once
-#include "ShaderClass.h"
-
-class UHLightCullingShader : public UHShaderClass
-{
-public:
-	UHLightCullingShader(UHGraphic* InGfx, std::string Name);
-
-	virtual void OnCompile() override;
-
-	void BindParameters();
-};
\ No newline at end of file
@@ -50,8 +50,8 @@ void UHLightPassShader::BindParameters(const bool bIsRaytracingEnableRT, const b
 	BindStorage(GDirectionalLightBuffer, 3, 0, true);
 	BindStorage(GPointLightBuffer, 4, 0, true);
 	BindStorage(GSpotLightBuffer, 5, 0, true);
-	BindStorage(GPointLightListBuffer.get(), 6, 0, true);
-	BindStorage(GSpotLightListBuffer.get(), 7, 0, true);
+	BindStorage(GPointLightListBuffer, 6, 0, true);
+	BindStorage(GSpotLightListBuffer, 7, 0, true);
 	BindStorage(GSH9Data.get(), 8, 0, true);
 
 	if (bIsRaytracingEnableRT)
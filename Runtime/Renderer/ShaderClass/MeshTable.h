@@ -11,7 +11,7 @@ public:
 		VkShaderStageFlags FlagBits = VK_SHADER_STAGE_CLOSEST_HIT_BIT_KHR | VK_SHADER_STAGE_ANY_HIT_BIT_KHR;
 		if (InGfx->IsMeshShaderSupported())
 		{
-			FlagBits |= VK_SHADER_STAGE_MESH_BIT_EXT;
+			FlagBits |= VK_SHADER_STAGE_MESH_BIT_EXT | VK_SHADER_STAGE_TASK_BIT_EXT;
 		}
 
 		AddLayoutBinding(NumOfInstances, FlagBits, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 0);
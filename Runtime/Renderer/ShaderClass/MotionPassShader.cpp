@@ -44,18 +44,19 @@ UHMotionObjectPassShader::UHMotionObjectPassShader(UHGraphic* InGfx, std::string
 	// Motion pass: constants + opacity image for cutoff (if there is any)
 	for (uint32_t Idx = 0; Idx < UH_ENUM_VALUE(UHConstantTypes::ConstantTypeMax); Idx++)
 	{
-		if (Idx != UH_ENUM_VALUE(UHConstantTypes::Material))
+		if (Idx == UH_ENUM_VALUE(UHConstantTypes::Object))
 		{
-			AddLayoutBinding(1, VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER);
+			// object constants are fetched by instance index
+			AddLayoutBinding(1, VK_SHADER_STAGE_VERTEX_BIT, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER);
 		}
-		else
+		else if (Idx != UH_ENUM_VALUE(UHConstantTypes::Material))
 		{
-			AddLayoutBinding(1, VK_SHADER_STAGE_FRAGMENT_BIT, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER);
+			AddLayoutBinding(1, VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER);
 		}
 	}
 
-	// UV0/normal/tangent Buffer
-	AddLayoutBinding(1, VK_SHADER_STAGE_VERTEX_BIT, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER);
+	// UV0/normal/tangent Buffer, binding 2 is left empty as material constants are bound from the material arena set
+	AddLayoutBinding(1, VK_SHADER_STAGE_VERTEX_BIT, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 3);
 	AddLayoutBinding(1, VK_SHADER_STAGE_VERTEX_BIT, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER);
 	AddLayoutBinding(1, VK_SHADER_STAGE_VERTEX_BIT, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER);
 
@@ -83,7 +84,7 @@ void UHMotionObjectPassShader::OnCompile()
 
 	UHMaterialCompileData Data;
 	Data.MaterialCache = MaterialCache;
-	ShaderPS = Gfx->RequestMaterialShader("MotionPixelShader", "Shaders/MotionPixelShader.hlsl", "MotionObjectPS", "ps_6_0", Data, MaterialCache->GetShaderDefines());
+	ShaderPS = Gfx->RequestMaterialShader("MotionPixelShader", "Shaders/MotionPixelShader.hlsl", "MotionObjectPS", "ps_6_0", Data, GetMaterialDefines());
 
 	// states, enable depth test, and write depth for translucent object only
 	MaterialPassInfo = UHRenderPassInfo(RenderPassCache,
@@ -107,8 +108,7 @@ void UHMotionObjectPassShader::OnCompile()
 void UHMotionObjectPassShader::BindParameters(const UHMeshRendererComponent* InRenderer)
 {
 	BindConstant(GSystemConstantBuffer, 0, 0);
-	BindConstant(GObjectConstantBuffer, 1, InRenderer->GetBufferDataIndex());
-	BindConstant(MaterialCache->GetMaterialConst(), 2, 0);
+	BindStorage(GObjectConstantBuffer, 1, 0, true);
 
 	BindStorage(InRenderer->GetMesh()->GetUV0Buffer(), 3, 0, true);
 	BindStorage(InRenderer->GetMesh()->GetNormalBuffer(), 4, 0, true);
@@ -120,18 +120,22 @@ UHMotionMeshShader::UHMotionMeshShader(UHGraphic* InGfx, std::string Name, VkRen
 	: UHShaderClass(InGfx, Name, typeid(UHMotionMeshShader), InMat, InRenderPass)
 {
 	// system
-	AddLayoutBinding(1, VK_SHADER_STAGE_FRAGMENT_BIT | VK_SHADER_STAGE_MESH_BIT_EXT, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER);
+	AddLayoutBinding(1, VK_SHADER_STAGE_FRAGMENT_BIT | VK_SHADER_STAGE_MESH_BIT_EXT | VK_SHADER_STAGE_TASK_BIT_EXT, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER);
 
 	// object constant
-	AddLayoutBinding(1, VK_SHADER_STAGE_MESH_BIT_EXT, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER);
+	AddLayoutBinding(1, VK_SHADER_STAGE_MESH_BIT_EXT | VK_SHADER_STAGE_TASK_BIT_EXT, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER);
 
-	// material
-	AddLayoutBinding(1, VK_SHADER_STAGE_FRAGMENT_BIT, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER);
+	// current mesh shader data, occlusion result, renderer instances and Hi-Z
+	// binding 2 is left empty, material constants are bound from the material arena set
+	AddLayoutBinding(1, VK_SHADER_STAGE_TASK_BIT_EXT, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 3);
+	AddLayoutBinding(1, VK_SHADER_STAGE_TASK_BIT_EXT, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER);
+	AddLayoutBinding(1, VK_SHADER_STAGE_MESH_BIT_EXT | VK_SHADER_STAGE_TASK_BIT_EXT, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER);
+	AddLayoutBinding(1, VK_SHADER_STAGE_TASK_BIT_EXT, VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE);
 
-	// current mesh shader data and renderer instances
-	AddLayoutBinding(1, VK_SHADER_STAGE_MESH_BIT_EXT, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER);
-	AddLayoutBinding(1, VK_SHADER_STAGE_MESH_BIT_EXT, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER);
-	AddLayoutBinding(1, VK_SHADER_STAGE_MESH_BIT_EXT, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER);
+	// instance and meshlet count for amplification shader
+	PushConstantRange.offset = 0;
+	PushConstantRange.stageFlags = VK_SHADER_STAGE_TASK_BIT_EXT;
+	PushConstantRange.size = sizeof(UHMeshShaderConstants);
 
 	CreateLayoutAndDescriptor(ExtraLayouts);
 
@@ -148,17 +152,19 @@ void UHMotionMeshShader::OnCompile()
 	{
 		// restore cached value
 		const UHRenderPassInfo& PassInfo = GetState()->GetRenderPassInfo();
+		ShaderAS = PassInfo.AS;
 		ShaderMS = PassInfo.MS;
 		ShaderPS = PassInfo.PS;
 		MaterialPassInfo = PassInfo;
 		return;
 	}
 
+	ShaderAS = Gfx->RequestShader("BaseAmplificationShader", "Shaders/BaseAmplificationShader.hlsl", "BaseAS", "as_6_5");
 	ShaderMS = Gfx->RequestShader("MotionMeshShader", "Shaders/MotionMeshShader.hlsl", "MotionMS", "ms_6_5", MaterialCache->GetShaderDefines());
 
 	UHMaterialCompileData Data;
 	Data.MaterialCache = MaterialCache;
-	ShaderPS = Gfx->RequestMaterialShader("MotionPixelShader", "Shaders/MotionPixelShader.hlsl", "MotionObjectPS", "ps_6_0", Data, MaterialCache->GetShaderDefines());
+	ShaderPS = Gfx->RequestMaterialShader("MotionPixelShader", "Shaders/MotionPixelShader.hlsl", "MotionObjectPS", "ps_6_0", Data, GetMaterialDefines());
 
 	// states, enable depth test, and write depth for translucent object only
 	MaterialPassInfo = UHRenderPassInfo(RenderPassCache,
@@ -169,6 +175,7 @@ void UHMotionMeshShader::OnCompile()
 		, ShaderPS
 		, 1
 		, PipelineLayout);
+	MaterialPassInfo.AS = ShaderAS;
 	MaterialPassInfo.MS = ShaderMS;
 
 	// disable blending intentionally if it's translucent
@@ -184,7 +191,6 @@ void UHMotionMeshShader::BindParameters()
 {
 	BindConstant(GSystemConstantBuffer, 0, 0);
 	BindStorage(GObjectConstantBuffer, 1, 0, true);
-	BindConstant(MaterialCache->GetMaterialConst(), 2, 0);
 
 	for (uint32_t Idx = 0; Idx < GMaxFrameInFlight; Idx++)
 	{
@@ -206,4 +212,5 @@ void UHMotionMeshShader::BindParameters()
 	}
 
 	BindStorage(GRendererInstanceBuffer.get(), 5, 0, true);
+	BindImage(GHiZBuffer, 6);
 }
\ No newline at end of file
@@ -7,9 +7,9 @@ UHGraphicState* UHOcclusionPassShader::OcclusionStateCache;
 UHOcclusionPassShader::UHOcclusionPassShader(UHGraphic* InGfx, std::string Name, VkRenderPass InRenderPass)
 	: UHShaderClass(InGfx, Name, typeid(UHOcclusionPassShader), nullptr, InRenderPass)
 {
-	// only need a system constant buffer
-	AddLayoutBinding(1, VK_SHADER_STAGE_VERTEX_BIT, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER);
+	// only need a system constant buffer and occlusion object buffer
 	AddLayoutBinding(1, VK_SHADER_STAGE_VERTEX_BIT, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER);
+	AddLayoutBinding(1, VK_SHADER_STAGE_VERTEX_BIT, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER);
 
 	CreateLayoutAndDescriptor();
 	OnCompile();
@@ -48,7 +48,7 @@ void UHOcclusionPassShader::OnCompile()
 void UHOcclusionPassShader::BindParameters(const UHMeshRendererComponent* InRenderer)
 {
 	BindConstant(GSystemConstantBuffer, 0, 0);
-	BindConstant(GOcclusionConstantBuffer, 1, InRenderer->GetBufferDataIndex());
+	BindStorage(GOcclusionConstantBuffer, 1, 0, true);
 }
 
 void UHOcclusionPassShader::ResetOcclusionState()
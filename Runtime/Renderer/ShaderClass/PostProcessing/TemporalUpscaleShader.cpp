@@ -0,0 +1,50 @@
+#include "TemporalUpscaleShader.h"
+#include "../../RendererShared.h"
+
+UHTemporalUpscaleShader::UHTemporalUpscaleShader(UHGraphic* InGfx, std::string Name)
+	: UHShaderClass(InGfx, Name, typeid(UHTemporalUpscaleShader), nullptr)
+{
+	// system buffer, output, scene/history/motion/depth/mixed depth and two samplers
+	AddLayoutBinding(1, VK_SHADER_STAGE_COMPUTE_BIT, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER);
+	AddLayoutBinding(1, VK_SHADER_STAGE_COMPUTE_BIT, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE);
+	AddLayoutBinding(1, VK_SHADER_STAGE_COMPUTE_BIT, VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE);
+	AddLayoutBinding(1, VK_SHADER_STAGE_COMPUTE_BIT, VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE);
+	AddLayoutBinding(1, VK_SHADER_STAGE_COMPUTE_BIT, VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE);
+	AddLayoutBinding(1, VK_SHADER_STAGE_COMPUTE_BIT, VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE);
+	AddLayoutBinding(1, VK_SHADER_STAGE_COMPUTE_BIT, VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE);
+	AddLayoutBinding(1, VK_SHADER_STAGE_COMPUTE_BIT, VK_DESCRIPTOR_TYPE_SAMPLER);
+	AddLayoutBinding(1, VK_SHADER_STAGE_COMPUTE_BIT, VK_DESCRIPTOR_TYPE_SAMPLER);
+
+	PushConstantRange.offset = 0;
+	PushConstantRange.size = sizeof(UHTemporalUpscaleConstants);
+	PushConstantRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+
+	CreateLayoutAndDescriptor();
+	OnCompile();
+}
+
+void UHTemporalUpscaleShader::OnCompile()
+{
+	ShaderCS = Gfx->RequestShader("TemporalUpscaleShader", "Shaders/PostProcessing/TemporalUpscaleComputeShader.hlsl", "TemporalUpscaleCS", "cs_6_0");
+
+	// state
+	UHComputePassInfo CInfo = UHComputePassInfo(PipelineLayout);
+	CInfo.CS = ShaderCS;
+
+	CreateComputeState(CInfo);
+}
+
+void UHTemporalUpscaleShader::BindParameters()
+{
+	BindConstant(GSystemConstantBuffer, 0, 0);
+
+	// the output is always the post process RT, the rest of post processing ping-pongs at output resolution
+	BindRWImage(GPostProcessRT, 1);
+	BindImage(GSceneResult, 2);
+	BindImage(GPreviousSceneResult, 3);
+	BindImage(GMotionVectorRT, 4);
+	BindImage(GSceneDepth, 5);
+	BindImage(GSceneMixedDepth, 6);
+	BindSampler(GPointClampedSampler, 7);
+	BindSampler(GLinearClampedSampler, 8);
+}
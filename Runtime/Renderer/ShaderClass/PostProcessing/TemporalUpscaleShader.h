@@ -0,0 +1,21 @@
+#pragma once
+#include "../ShaderClass.h"
+
+struct UHTemporalUpscaleConstants
+{
+	uint32_t OutputResolutionX;
+	uint32_t OutputResolutionY;
+	float InvOutputResolutionX;
+	float InvOutputResolutionY;
+	uint32_t bResetHistory;
+};
+
+// temporal upscaler, it replaces TAA when rendering at a lower resolution than the output
+class UHTemporalUpscaleShader : public UHShaderClass
+{
+public:
+	UHTemporalUpscaleShader(UHGraphic* InGfx, std::string Name);
+	virtual void OnCompile() override;
+
+	void BindParameters();
+};
@@ -44,6 +44,10 @@ UHRTIndirectLightShader::UHRTIndirectLightShader(UHGraphic* InGfx, std::string N
 	AddLayoutBinding(1, VK_SHADER_STAGE_RAYGEN_BIT_KHR, VK_DESCRIPTOR_TYPE_SAMPLER);
 	AddLayoutBinding(1, VK_SHADER_STAGE_RAYGEN_BIT_KHR, VK_DESCRIPTOR_TYPE_SAMPLER);
 
+	// adaptive tile list + ray args
+	AddLayoutBinding(1, VK_SHADER_STAGE_RAYGEN_BIT_KHR, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER);
+	AddLayoutBinding(1, VK_SHADER_STAGE_RAYGEN_BIT_KHR, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER);
+
 	CreateLayoutAndDescriptor(ExtraLayouts);
 
 	ClosestHitIDs = InClosestHits;
@@ -116,14 +120,18 @@ void UHRTIndirectLightShader::BindParameters()
 
 	// light lists (indices)
 	BindStorage(GInstanceLightsBuffer, 14, 0, true);
-	BindStorage(GPointLightListBuffer.get(), 15, 0, true);
-	BindStorage(GSpotLightListBuffer.get(), 16, 0, true);
+	BindStorage(GPointLightListBuffer, 15, 0, true);
+	BindStorage(GSpotLightListBuffer, 16, 0, true);
 
 	// sampler
 	BindSampler(GPointClampedSampler, 17);
 	BindSampler(GLinearClampedSampler, 18);
 	BindSampler(GPointClamped3DSampler, 19);
 	BindSampler(GLinearClamped3DSampler, 20);
+
+	// adaptive tiles
+	BindStorage(GRTIndirectTileList.get(), 21, 0, true);
+	BindStorage(GRTIndirectRayArgs.get(), 22, 0, true);
 }
 
 UHRenderBuffer<UHRTIndirectLightConstants>* UHRTIndirectLightShader::GetConstants(const int32_t FrameIdx) const
@@ -149,6 +157,9 @@ UHRTIndirectReprojectionShader::UHRTIndirectReprojectionShader(UHGraphic* InGfx,
 	AddLayoutBinding(1, VK_SHADER_STAGE_COMPUTE_BIT, VK_DESCRIPTOR_TYPE_SAMPLER);
 	AddLayoutBinding(1, VK_SHADER_STAGE_COMPUTE_BIT, VK_DESCRIPTOR_TYPE_SAMPLER);
 
+	// adaptive tile rates, the skipped tiles reuse the history
+	AddLayoutBinding(1, VK_SHADER_STAGE_COMPUTE_BIT, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE);
+
 	// utilize push constants, so the shader could be reused
 	PushConstantRange.offset = 0;
 	PushConstantRange.size = sizeof(UHRTIndirectReprojectionConstants);
@@ -191,6 +202,7 @@ void UHRTIndirectReprojectionShader::BindParameters(UHRenderBuilder& RenderBuild
 
 	PushSampler(GPointClampedSampler, 8);
 	PushSampler(GLinearClampedSampler, 9);
+	PushImage(GRTIndirectTileRate, 10, true, 0);
 
 	FlushPushDescriptor(RenderBuilder.GetCmdList());
 }
\ No newline at end of file
@@ -4,11 +4,11 @@
 class UHRTMaterialDataTable : public UHShaderClass
 {
 public:
-	UHRTMaterialDataTable(UHGraphic* InGfx, std::string Name, uint32_t NumOfMaterials)
+	UHRTMaterialDataTable(UHGraphic* InGfx, std::string Name)
 		: UHShaderClass(InGfx, Name, typeid(UHRTMaterialDataTable), nullptr)
 	{
-		// simply create layout with number of meshes
-		AddLayoutBinding(NumOfMaterials, VK_SHADER_STAGE_CLOSEST_HIT_BIT_KHR | VK_SHADER_STAGE_ANY_HIT_BIT_KHR, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 0);
+		// all materials are packed in the RT material arena, indexed by material buffer data index
+		AddLayoutBinding(1, VK_SHADER_STAGE_CLOSEST_HIT_BIT_KHR | VK_SHADER_STAGE_ANY_HIT_BIT_KHR, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 0);
 		CreateLayoutAndDescriptor();
 	}
 
@@ -30,7 +30,8 @@ void UHRTMinimalHitGroupShader::UpdateHitShader(UHGraphic* InGfx, UHMaterial* In
 		return;
 	}
 
-	const int32_t Index = UHUtilities::FindIndex(AllMaterials, InMat);
+	// material instances share the hit group of their parent
+	const int32_t Index = UHUtilities::FindIndex(AllMaterials, InMat->GetShaderMaterial());
 	if (Index == UHINDEXNONE)
 	{
 		return;
@@ -39,6 +39,10 @@ UHRTReflectionShader::UHRTReflectionShader(UHGraphic* InGfx, std::string Name
 	AddLayoutBinding(1, VK_SHADER_STAGE_RAYGEN_BIT_KHR, VK_DESCRIPTOR_TYPE_SAMPLER);
 	AddLayoutBinding(1, VK_SHADER_STAGE_RAYGEN_BIT_KHR, VK_DESCRIPTOR_TYPE_SAMPLER);
 
+	// adaptive tile list + ray args
+	AddLayoutBinding(1, VK_SHADER_STAGE_RAYGEN_BIT_KHR, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER);
+	AddLayoutBinding(1, VK_SHADER_STAGE_RAYGEN_BIT_KHR, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER);
+
 	CreateLayoutAndDescriptor(ExtraLayouts);
 
 	ClosestHitIDs = InClosestHits;
@@ -93,11 +97,15 @@ void UHRTReflectionShader::BindParameters()
 
 	// light lists (indices)
 	BindStorage(GInstanceLightsBuffer, 11, 0, true);
-	BindStorage(GPointLightListBuffer.get(), 12, 0, true);
-	BindStorage(GSpotLightListBuffer.get(), 13, 0, true);
+	BindStorage(GPointLightListBuffer, 12, 0, true);
+	BindStorage(GSpotLightListBuffer, 13, 0, true);
 	BindSkyCube();
 	BindSampler(GPointClampedSampler, 16);
 	BindSampler(GLinearClampedSampler, 17);
+
+	// adaptive tiles
+	BindStorage(GRTReflectionTileList.get(), 18, 0, true);
+	BindStorage(GRTReflectionRayArgs.get(), 19, 0, true);
 }
 
 void UHRTReflectionShader::BindSkyCube()
@@ -32,6 +32,10 @@ UHRTShadowShader::UHRTShadowShader(UHGraphic* InGfx, std::string Name
 	AddLayoutBinding(1, VK_SHADER_STAGE_RAYGEN_BIT_KHR, VK_DESCRIPTOR_TYPE_SAMPLER);
 	AddLayoutBinding(1, VK_SHADER_STAGE_RAYGEN_BIT_KHR, VK_DESCRIPTOR_TYPE_SAMPLER);
 
+	// tile list + ray args
+	AddLayoutBinding(1, VK_SHADER_STAGE_RAYGEN_BIT_KHR, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER);
+	AddLayoutBinding(1, VK_SHADER_STAGE_RAYGEN_BIT_KHR, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER);
+
 	CreateLayoutAndDescriptor(ExtraLayouts);
 
 	ClosestHitIDs = InClosestHits;
@@ -76,11 +80,15 @@ void UHRTShadowShader::BindParameters()
 	BindStorage(GDirectionalLightBuffer, 5, 0, true);
 	BindStorage(GPointLightBuffer, 6, 0, true);
 	BindStorage(GSpotLightBuffer, 7, 0, true);
-	BindStorage(GPointLightListBuffer.get(), 8, 0, true);
-	BindStorage(GSpotLightListBuffer.get(), 9, 0, true);
+	BindStorage(GPointLightListBuffer, 8, 0, true);
+	BindStorage(GSpotLightListBuffer, 9, 0, true);
 
 	// translucent buffers and samplers
 	BindImage(GSceneMip, 10);
 	BindSampler(GPointClampedSampler, 11);
 	BindSampler(GLinearClampedSampler, 12);
+
+	// tiles to trace
+	BindStorage(GRTShadowTileList.get(), 13, 0, true);
+	BindStorage(GRTShadowRayArgs.get(), 14, 0, true);
 }
\ No newline at end of file
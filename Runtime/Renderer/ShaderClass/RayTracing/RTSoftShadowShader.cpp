@@ -64,8 +64,8 @@ void UHRTSoftShadowShader::BindParameters()
 	BindStorage(GDirectionalLightBuffer, 6, 0, true);
 	BindStorage(GPointLightBuffer, 7, 0, true);
 	BindStorage(GSpotLightBuffer, 8, 0, true);
-	BindStorage(GPointLightListBuffer.get(), 9, 0, true);
-	BindStorage(GSpotLightListBuffer.get(), 10, 0, true);
+	BindStorage(GPointLightListBuffer, 9, 0, true);
+	BindStorage(GSpotLightListBuffer, 10, 0, true);
 
 	BindSampler(GPointClampedSampler, 11);
 	BindSampler(GLinearClampedSampler, 12);
@@ -0,0 +1,86 @@
+#include "RTTileClassifyShader.h"
+#include "../../RendererShared.h"
+
+UHRTTileClassifyShader::UHRTTileClassifyShader(UHGraphic* InGfx, std::string Name, UHRTTileClassifyType InType)
+	: UHShaderClass(InGfx, Name, typeid(UHRTTileClassifyShader))
+	, ClassifyType(InType)
+{
+	// system, tile list and ray args
+	AddLayoutBinding(1, VK_SHADER_STAGE_COMPUTE_BIT, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER);
+	AddLayoutBinding(1, VK_SHADER_STAGE_COMPUTE_BIT, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER);
+	AddLayoutBinding(1, VK_SHADER_STAGE_COMPUTE_BIT, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER);
+
+	// GBuffers, motion and sampler
+	AddLayoutBinding(GNumOfGBuffersSRV, VK_SHADER_STAGE_COMPUTE_BIT, VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE);
+	AddLayoutBinding(1, VK_SHADER_STAGE_COMPUTE_BIT, VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE);
+	AddLayoutBinding(1, VK_SHADER_STAGE_COMPUTE_BIT, VK_DESCRIPTOR_TYPE_SAMPLER);
+
+	// the layout is cached per shader class, so all types share the bindings and only bind what they use
+	// indirect light outputs the tile rates, so the reprojection knows which tiles reuse the history
+	AddLayoutBinding(1, VK_SHADER_STAGE_COMPUTE_BIT, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE);
+
+	// shadow and reflection cache, history depth, invalidation boxes and directional lights
+	AddLayoutBinding(1, VK_SHADER_STAGE_COMPUTE_BIT, VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE);
+	AddLayoutBinding(1, VK_SHADER_STAGE_COMPUTE_BIT, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER);
+	AddLayoutBinding(1, VK_SHADER_STAGE_COMPUTE_BIT, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER);
+
+	PushConstantRange.offset = 0;
+	PushConstantRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+	PushConstantRange.size = sizeof(UHRTTileClassifyConstants);
+
+	CreateLayoutAndDescriptor();
+	OnCompile();
+}
+
+void UHRTTileClassifyShader::OnCompile()
+{
+	std::string EntryName = "RTIndirectTileClassifyCS";
+	if (ClassifyType == UHRTTileClassifyType::Reflection)
+	{
+		EntryName = "RTReflectionTileClassifyCS";
+	}
+	else if (ClassifyType == UHRTTileClassifyType::Shadow)
+	{
+		EntryName = "RTShadowTileClassifyCS";
+	}
+	ShaderCS = Gfx->RequestShader(Name, "Shaders/RayTracing/RTTileClassifyComputeShader.hlsl", EntryName, "cs_6_0");
+
+	// state
+	UHComputePassInfo Info(PipelineLayout);
+	Info.CS = ShaderCS;
+
+	CreateComputeState(Info);
+}
+
+void UHRTTileClassifyShader::BindParameters()
+{
+	BindConstant(GSystemConstantBuffer, 0, 0);
+
+	if (ClassifyType == UHRTTileClassifyType::Reflection)
+	{
+		BindStorage(GRTReflectionTileList.get(), 1, 0, true);
+		BindStorage(GRTReflectionRayArgs.get(), 2, 0, true);
+	}
+	else if (ClassifyType == UHRTTileClassifyType::Shadow)
+	{
+		BindStorage(GRTShadowTileList.get(), 1, 0, true);
+		BindStorage(GRTShadowRayArgs.get(), 2, 0, true);
+		BindStorage(GDirectionalLightBuffer, 9, 0, true);
+	}
+	else
+	{
+		BindStorage(GRTIndirectTileList.get(), 1, 0, true);
+		BindStorage(GRTIndirectRayArgs.get(), 2, 0, true);
+		BindRWImage(GRTIndirectTileRate, 6);
+	}
+
+	BindImage(GetGBuffersSRV(), 3);
+	BindImage(GMotionVectorRT, 4);
+	BindSampler(GPointClampedSampler, 5);
+
+	if (ClassifyType != UHRTTileClassifyType::IndirectLight)
+	{
+		BindImage(GHistoryDepth, 7);
+		BindStorage(GRTCacheInvalidationBuffer, 8, 0, true);
+	}
+}
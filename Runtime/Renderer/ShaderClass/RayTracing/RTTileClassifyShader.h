@@ -0,0 +1,61 @@
+#pragma once
+#include "../ShaderClass.h"
+
+// adaptive RT tile classification, sync with UHRTTileCommon.hlsli
+enum class UHRTTileClassifyType : uint32_t
+{
+	Reflection,
+	IndirectLight,
+	Shadow
+};
+
+enum class UHRTTileRate : uint32_t
+{
+	Skip,
+	Quarter,
+	Full
+};
+
+struct UHRTTileClassifyConstants
+{
+	uint32_t TraceResolution[2];
+	uint32_t PixelStride;
+	uint32_t MaxTileCount;
+
+	// tiles smoother than this are traced at full rate
+	float QuarterRateSmoothness;
+	// relative depth range of a tile that is considered as an edge
+	float DepthEdgeThreshold;
+	// the history of a tile is stable when its motion is below this
+	float StableMotionThreshold;
+	// 0: stable tiles are traced at full rate, N: stable tiles are traced at quarter rate once per N frames and reuse the history otherwise
+	uint32_t RefreshInterval;
+
+	// number of cache invalidation boxes
+	uint32_t CacheInvalidationCount;
+	// shadow and reflection only, whether the results of last frame can be reused in the unchanged tiles
+	uint32_t bCacheValid;
+	// shadow only, the tiles away from depth edges are traced at quarter rate
+	uint32_t bShadowQuarterRate;
+};
+
+// classifies the screen tiles of a RT pass, and lists the tiles to trace at full or quarter rate
+class UHRTTileClassifyShader : public UHShaderClass
+{
+public:
+	UHRTTileClassifyShader(UHGraphic* InGfx, std::string Name, UHRTTileClassifyType InType);
+	virtual void OnCompile() override;
+
+	void BindParameters();
+
+	// a tile is traced with 8x8 rays at full rate, or one ray per 2x2 quad at quarter rate
+	static constexpr uint32_t TileSize = 8;
+	// full and quarter rate VkTraceRaysIndirectCommandKHR, each is padded with the offset of its tiles in the list
+	static constexpr uint32_t RayArgsStride = 16;
+	static constexpr uint32_t RayArgsCount = 2 * RayArgsStride / sizeof(uint32_t);
+	// the cache is reset instead when there are more boxes in a frame
+	static constexpr uint32_t MaxCacheInvalidations = 256;
+
+private:
+	UHRTTileClassifyType ClassifyType;
+};
@@ -1,5 +1,6 @@
 #include "ShaderClass.h"
 #include "Runtime/Engine/Graphic.h"
+#include "../RendererShared.h"
 
 // layout won't change for the same shaders and can be cached
 std::unordered_map<std::type_index, VkDescriptorSetLayout> UHShaderClass::DescriptorSetLayoutTable;
@@ -26,6 +27,12 @@ void UHShaderClass::ClearGlobalLayoutCache(UHGraphic* InGfx)
 
 	DescriptorSetLayoutTable.clear();
 	PipelineLayoutTable.clear();
+
+	// forget the free sets of destroyed layouts
+	if (UHDescriptorAllocator* Allocator = InGfx->GetDescriptorAllocator())
+	{
+		Allocator->ClearLayoutCache();
+	}
 }
 
 bool UHShaderClass::IsDescriptorLayoutValid(std::type_index InType)
@@ -39,7 +46,6 @@ UHShaderClass::UHShaderClass(UHGraphic* InGfx, std::string InName, std::type_ind
 	, MaterialCache(InMat)
 	, MaterialPassInfo(UHRenderPassInfo())
 	, PipelineLayout(nullptr)
-	, DescriptorPool(nullptr)
 	, ShaderVS(UHINDEXNONE)
 	, ShaderPS(UHINDEXNONE)
 	, ShaderCS(UHINDEXNONE)
@@ -52,6 +58,7 @@ UHShaderClass::UHShaderClass(UHGraphic* InGfx, std::string InName, std::type_ind
 	, RenderPassCache(InRenderPass)
 	, PushConstantRange(VkPushConstantRange{})
 	, bPushDescriptor(false)
+	, MaterialArenaSet(UHINDEXNONE)
 {
 	Name = InName;
 	for (int32_t Idx = 0; Idx < GMaxFrameInFlight; Idx++)
@@ -125,9 +132,12 @@ void UHShaderClass::Release()
 // function to release descriptor only
 void UHShaderClass::ReleaseDescriptor()
 {
-	VkDevice LogicalDevice = Gfx->GetLogicalDevice();
-
-	SafeDestroyDescriptorPool(LogicalDevice, DescriptorPool);
+	// return sets to the shared allocator, they will be reused by shaders with the same layout
+	UHDescriptorAllocator* Allocator = Gfx->GetDescriptorAllocator();
+	if (Allocator != nullptr && IsDescriptorLayoutValid(TypeIndexCache))
+	{
+		Allocator->Free(DescriptorSetLayoutTable[TypeIndexCache], GMaxFrameInFlight, DescriptorSets.data());
+	}
 }
 
 void UHShaderClass::BindImage(const UHTexture* InImage, const int32_t DstBinding)
@@ -473,6 +483,18 @@ const VkPushConstantRange& UHShaderClass::GetPushConstantRange() const
 	return PushConstantRange;
 }
 
+int32_t UHShaderClass::GetMaterialArenaSet() const
+{
+	return MaterialArenaSet;
+}
+
+std::vector<std::string> UHShaderClass::GetMaterialDefines() const
+{
+	std::vector<std::string> Defines = MaterialCache->GetShaderDefines();
+	Defines.push_back("UHMAT_SPACE=space" + std::to_string(MaterialArenaSet));
+	return Defines;
+}
+
 // add layout binding
 void UHShaderClass::AddLayoutBinding(uint32_t DescriptorCount, VkShaderStageFlags StageFlags, VkDescriptorType DescriptorType, int32_t OverrideBind)
 {
@@ -481,10 +503,10 @@ void UHShaderClass::AddLayoutBinding(uint32_t DescriptorCount, VkShaderStageFlag
 	LayoutBinding.stageFlags = StageFlags;
 	LayoutBinding.descriptorType = DescriptorType;
 
-	// binding idx will accumulate during adding
+	// binding idx will accumulate from the previous binding during adding, so an override can leave a gap
 	if (OverrideBind < 0)
 	{
-		LayoutBinding.binding = static_cast<uint32_t>(LayoutBindings.size());
+		LayoutBinding.binding = LayoutBindings.empty() ? 0 : LayoutBindings.back().binding + 1;
 	}
 	else
 	{
@@ -497,6 +519,13 @@ void UHShaderClass::CreateLayoutAndDescriptor(std::vector<VkDescriptorSetLayout>
 {
 	VkDevice LogicalDevice = Gfx->GetLogicalDevice();
 
+	// material constants are bound from the shared arena set instead of the set of this shader
+	if (MaterialCache != nullptr)
+	{
+		MaterialArenaSet = static_cast<int32_t>(1 + AdditionalLayout.size());
+		AdditionalLayout.push_back(GMaterialArena.GetDescriptorSetLayout());
+	}
+
 	// don't duplicate layout
 	if (DescriptorSetLayoutTable.find(TypeIndexCache) == DescriptorSetLayoutTable.end())
 	{
@@ -555,50 +584,14 @@ void UHShaderClass::CreateLayoutAndDescriptor(std::vector<VkDescriptorSetLayout>
 	}
 	PipelineLayout = PipelineLayoutTable[TypeIndexCache];
 
-	// create DescriptorPools
-	std::vector<VkDescriptorPoolSize> PoolSizes;
-
-	// pool type can be single or multiple
-	for (size_t Idx = 0; Idx < LayoutBindings.size(); Idx++)
-	{
-		VkDescriptorPoolSize PoolSize{};
-		PoolSize.type = LayoutBindings[Idx].descriptorType;
-		// number of this count needs to be [Count * GMaxFrameInFlight]
-		PoolSize.descriptorCount = LayoutBindings[Idx].descriptorCount * GMaxFrameInFlight;
-		PoolSizes.push_back(PoolSize);
-	}
-
-	VkDescriptorPoolCreateInfo PoolInfo{};
-	PoolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
-	PoolInfo.poolSizeCount = static_cast<uint32_t>(PoolSizes.size());
-	PoolInfo.pPoolSizes = PoolSizes.data();
-	PoolInfo.maxSets = GMaxFrameInFlight;
-
-	if (vkCreateDescriptorPool(LogicalDevice, &PoolInfo, nullptr, &DescriptorPool) != VK_SUCCESS)
-	{
-		UHE_LOG("Failed to create descriptor pool for shader: " + Name + "\n");
-	}
-
-#if WITH_EDITOR
-	Gfx->SetDebugUtilsObjectName(VK_OBJECT_TYPE_DESCRIPTOR_POOL, (uint64_t)DescriptorPool
-		, Name + "_DescriptorPool");
-#endif
-
 	if (bPushDescriptor)
 	{
 		// skip allocating descriptor if it's pushing
 		return;
 	}
 
-	std::vector<VkDescriptorSetLayout> SetLayouts(GMaxFrameInFlight, DescriptorSetLayoutTable[TypeIndexCache]);
-	VkDescriptorSetAllocateInfo AllocInfo{};
-	AllocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
-	AllocInfo.descriptorPool = DescriptorPool;
-	AllocInfo.descriptorSetCount = GMaxFrameInFlight;
-	AllocInfo.pSetLayouts = SetLayouts.data();
-
-	const VkResult Result = vkAllocateDescriptorSets(LogicalDevice, &AllocInfo, DescriptorSets.data());
-	if (Result != VK_SUCCESS)
+	// allocate sets from the shared allocator instead of creating a pool per shader
+	if (!Gfx->GetDescriptorAllocator()->Allocate(DescriptorSetLayoutTable[TypeIndexCache], LayoutBindings, GMaxFrameInFlight, DescriptorSets.data()))
 	{
 		UHE_LOG("Failed to create descriptor sets for shader: " + Name + "\n");
 	}
@@ -196,14 +196,21 @@ public:
 	VkDescriptorSet GetDescriptorSet(int32_t FrameIdx) const;
 	const VkPushConstantRange& GetPushConstantRange() const;
 
+	// set index of the material arena, UHINDEXNONE if this isn't a material shader
+	int32_t GetMaterialArenaSet() const;
+
 protected:
 	// add layout binding
 	void AddLayoutBinding(uint32_t DescriptorCount, VkShaderStageFlags StageFlags, VkDescriptorType DescriptorType, int32_t OverrideBind = UHINDEXNONE);
 
 	// create descriptor, call this after shader class is done adding the layout binding
 	// each shader is default to one layout, but it can use additional layouts
+	// material shaders get the material arena layout after the additional layouts
 	void CreateLayoutAndDescriptor(std::vector<VkDescriptorSetLayout> AdditionalLayouts = std::vector<VkDescriptorSetLayout>());
 
+	// material defines plus the space of the material arena set, used by the shaders declaring material constants
+	std::vector<std::string> GetMaterialDefines() const;
+
 	// create state functions
 	void CreateGraphicState(UHRenderPassInfo InInfo);
 	void CreateMaterialState(UHRenderPassInfo InInfo);
@@ -222,8 +229,8 @@ protected:
 
 	std::vector<VkDescriptorSetLayoutBinding> LayoutBindings;
 	VkPipelineLayout PipelineLayout;
-	VkDescriptorPool DescriptorPool;
 	std::array<VkDescriptorSet, GMaxFrameInFlight> DescriptorSets;
+	int32_t MaterialArenaSet;
 
 	// store shader's id instead of UHShader*, prevent dangling pointer issue
 	uint32_t ShaderVS;
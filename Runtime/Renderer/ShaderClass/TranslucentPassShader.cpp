@@ -9,18 +9,19 @@ UHTranslucentPassShader::UHTranslucentPassShader(UHGraphic* InGfx, std::string N
 	// sys, obj, mat consts
 	for (int32_t Idx = 0; Idx < UH_ENUM_VALUE(UHConstantTypes::ConstantTypeMax); Idx++)
 	{
-		if (Idx != UH_ENUM_VALUE(UHConstantTypes::Material))
+		if (Idx == UH_ENUM_VALUE(UHConstantTypes::Object))
 		{
-			AddLayoutBinding(1, VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER);
+			// object constants are fetched by instance index
+			AddLayoutBinding(1, VK_SHADER_STAGE_VERTEX_BIT, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER);
 		}
-		else
+		else if (Idx != UH_ENUM_VALUE(UHConstantTypes::Material))
 		{
-			AddLayoutBinding(1, VK_SHADER_STAGE_FRAGMENT_BIT, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER);
+			AddLayoutBinding(1, VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER);
 		}
 	}
 
-	// bind UV0/Normal/Tangent buffer
-	AddLayoutBinding(1, VK_SHADER_STAGE_VERTEX_BIT, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER);
+	// bind UV0/Normal/Tangent buffer, binding 2 is left empty as material constants are bound from the material arena set
+	AddLayoutBinding(1, VK_SHADER_STAGE_VERTEX_BIT, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 3);
 	AddLayoutBinding(1, VK_SHADER_STAGE_VERTEX_BIT, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER);
 	AddLayoutBinding(1, VK_SHADER_STAGE_VERTEX_BIT, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER);
 
@@ -58,7 +59,7 @@ void UHTranslucentPassShader::OnCompile()
 	ShaderVS = Gfx->RequestShader("BaseVertexShader", "Shaders/BaseVertexShader.hlsl", "BaseVS", "vs_6_0", MaterialCache->GetShaderDefines());
 	UHMaterialCompileData Data{};
 	Data.MaterialCache = MaterialCache;
-	ShaderPS = Gfx->RequestMaterialShader("TranslucentPixelShader", "Shaders/TranslucentPixelShader.hlsl", "TranslucentPS", "ps_6_0", Data, MaterialCache->GetShaderDefines());
+	ShaderPS = Gfx->RequestMaterialShader("TranslucentPixelShader", "Shaders/TranslucentPixelShader.hlsl", "TranslucentPS", "ps_6_0", Data, GetMaterialDefines());
 
 	// states
 	MaterialPassInfo = UHRenderPassInfo(RenderPassCache
@@ -77,8 +78,7 @@ void UHTranslucentPassShader::OnCompile()
 void UHTranslucentPassShader::BindParameters(const UHMeshRendererComponent* InRenderer, const bool bIsRaytracingEnableRT)
 {
 	BindConstant(GSystemConstantBuffer, 0, 0);
-	BindConstant(GObjectConstantBuffer, 1, InRenderer->GetBufferDataIndex());
-	BindConstant(MaterialCache->GetMaterialConst(), 2, 0);
+	BindStorage(GObjectConstantBuffer, 1, 0, true);
 
 	UHMesh* Mesh = InRenderer->GetMesh();
 	BindStorage(Mesh->GetUV0Buffer(), 3, 0, true);
@@ -91,8 +91,8 @@ void UHTranslucentPassShader::BindParameters(const UHMeshRendererComponent* InRe
 	BindStorage(GSpotLightBuffer, 8, 0, true);
 	BindStorage(GSH9Data.get(), 9, 0, true);
 
-	BindStorage(GPointLightListTransBuffer.get(), 10, 0, true);
-	BindStorage(GSpotLightListTransBuffer.get(), 11, 0, true);
+	BindStorage(GPointLightListBuffer, 10, 0, true);
+	BindStorage(GSpotLightListBuffer, 11, 0, true);
 	BindSkyCube();
 }
 
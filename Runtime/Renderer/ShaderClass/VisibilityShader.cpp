@@ -0,0 +1,106 @@
+#include "VisibilityShader.h"
+#include "../RendererShared.h"
+
+// -------------------------------------------------------------- UHVisibilityClassifyShader
+UHVisibilityClassifyShader::UHVisibilityClassifyShader(UHGraphic* InGfx, std::string Name)
+	: UHShaderClass(InGfx, Name, typeid(UHVisibilityClassifyShader))
+{
+	// system, visibility buffer, renderer instances, draw args and tile list
+	AddLayoutBinding(1, VK_SHADER_STAGE_COMPUTE_BIT, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER);
+	AddLayoutBinding(1, VK_SHADER_STAGE_COMPUTE_BIT, VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE);
+	AddLayoutBinding(1, VK_SHADER_STAGE_COMPUTE_BIT, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER);
+	AddLayoutBinding(1, VK_SHADER_STAGE_COMPUTE_BIT, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER);
+	AddLayoutBinding(1, VK_SHADER_STAGE_COMPUTE_BIT, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER);
+
+	CreateLayoutAndDescriptor();
+	OnCompile();
+}
+
+void UHVisibilityClassifyShader::OnCompile()
+{
+	ShaderCS = Gfx->RequestShader("VisibilityClassifyShader", "Shaders/VisibilityClassifyComputeShader.hlsl", "VisibilityClassifyCS", "cs_6_0");
+
+	// state
+	UHComputePassInfo Info(PipelineLayout);
+	Info.CS = ShaderCS;
+
+	CreateComputeState(Info);
+}
+
+void UHVisibilityClassifyShader::BindParameters()
+{
+	BindConstant(GSystemConstantBuffer, 0, 0);
+	BindImage(GSceneVisibility, 1);
+	BindStorage(GRendererInstanceBuffer.get(), 2, 0, true);
+	BindStorage(GVisibilityDrawArgs.get(), 3, 0, true);
+	BindStorage(GVisibilityTileList.get(), 4, 0, true);
+}
+
+// -------------------------------------------------------------- UHVisibilityResolveShader
+UHVisibilityResolveShader::UHVisibilityResolveShader(UHGraphic* InGfx, std::string Name, VkRenderPass InRenderPass, UHMaterial* InMat, const std::vector<VkDescriptorSetLayout>& ExtraLayouts)
+	: UHShaderClass(InGfx, Name, typeid(UHVisibilityResolveShader), InMat, InRenderPass)
+{
+	// system
+	AddLayoutBinding(1, VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER);
+
+	// object constant, binding 2 is left empty as material constants are bound from the material arena set
+	AddLayoutBinding(1, VK_SHADER_STAGE_FRAGMENT_BIT, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER);
+
+	// visibility buffer and renderer instances
+	AddLayoutBinding(1, VK_SHADER_STAGE_FRAGMENT_BIT, VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, 3);
+	AddLayoutBinding(1, VK_SHADER_STAGE_FRAGMENT_BIT, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER);
+
+	// tile list for expanding tiles in vertex shader
+	AddLayoutBinding(1, VK_SHADER_STAGE_VERTEX_BIT, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER);
+
+	// material index of current draw
+	PushConstantRange.offset = 0;
+	PushConstantRange.stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
+	PushConstantRange.size = sizeof(UHVisibilityResolveConstants);
+
+	CreateLayoutAndDescriptor(ExtraLayouts);
+
+	OnCompile();
+}
+
+void UHVisibilityResolveShader::OnCompile()
+{
+	// early out if cached
+	if (GetState() != nullptr)
+	{
+		// restore cached value
+		const UHRenderPassInfo& PassInfo = GetState()->GetRenderPassInfo();
+		ShaderVS = PassInfo.VS;
+		ShaderPS = PassInfo.PS;
+		MaterialPassInfo = PassInfo;
+		return;
+	}
+
+	ShaderVS = Gfx->RequestShader("VisibilityResolveVertexShader", "Shaders/VisibilityResolveVertexShader.hlsl", "VisibilityResolveVS", "vs_6_0");
+	UHMaterialCompileData Data{};
+	Data.MaterialCache = MaterialCache;
+	ShaderPS = Gfx->RequestMaterialShader("VisibilityResolvePixelShader", "Shaders/VisibilityResolvePixelShader.hlsl", "VisibilityResolvePS", "ps_6_0", Data
+		, GetMaterialDefines());
+
+	// states, depth is done in prepass and each pixel is shaded once, so depth test and culling are off
+	MaterialPassInfo = UHRenderPassInfo(RenderPassCache
+		, UHDepthInfo(false, false, VK_COMPARE_OP_ALWAYS)
+		, UHCullMode::CullNone
+		, UHBlendMode::Opaque
+		, ShaderVS
+		, ShaderPS
+		, GNumOfGBuffers
+		, PipelineLayout);
+	MaterialPassInfo.bIsIntegerBuffer = { false,false,false,false,false,true };
+
+	RecreateMaterialState();
+}
+
+void UHVisibilityResolveShader::BindParameters()
+{
+	BindConstant(GSystemConstantBuffer, 0, 0);
+	BindStorage(GObjectConstantBuffer, 1, 0, true);
+	BindImage(GSceneVisibility, 3);
+	BindStorage(GRendererInstanceBuffer.get(), 4, 0, true);
+	BindStorage(GVisibilityTileList.get(), 5, 0, true);
+}
@@ -0,0 +1,24 @@
+#pragma once
+#include "ShaderClass.h"
+
+// visibility buffer material classification, appends screen tiles to the lists of materials they contain
+class UHVisibilityClassifyShader : public UHShaderClass
+{
+public:
+	UHVisibilityClassifyShader(UHGraphic* InGfx, std::string Name);
+
+	virtual void OnCompile() override;
+
+	void BindParameters();
+};
+
+// visibility buffer material resolve, reconstructs the attributes from mesh data and outputs GBuffers
+class UHVisibilityResolveShader : public UHShaderClass
+{
+public:
+	UHVisibilityResolveShader(UHGraphic* InGfx, std::string Name, VkRenderPass InRenderPass, UHMaterial* InMat, const std::vector<VkDescriptorSetLayout>& ExtraLayouts);
+
+	virtual void OnCompile() override;
+
+	void BindParameters();
+};
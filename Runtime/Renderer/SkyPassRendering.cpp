@@ -38,10 +38,21 @@ void UHDeferredShadingRenderer::RefreshSkyLight(bool bNeedRecompile)
 		TransShader.second->BindSkyCube();
 	}
 
+	if (GSkyLightCube && GSkyLightCube->HasBakedLighting())
+	{
+		// SH9 is baked with the cube, simply upload it. GPU is idle at this point
+		UHSphericalHarmonicData SH9 = GSkyLightCube->GetBakedSH9();
+		GSH9Data->UploadAllData(&SH9);
+		bNeedGenerateSH9 = false;
+	}
+	else
 	{
 		bNeedGenerateSH9 = true;
 	}
 
+	// cached RT results were lit by the previous sky, a baked sky doesn't go through SH9 generation so reset it here
+	bResetRTCacheGT = true;
+
 	if (RTParams.bEnableRayTracing)
 	{
 		RTReflectionShader->BindSkyCube();
@@ -50,7 +61,7 @@ void UHDeferredShadingRenderer::RefreshSkyLight(bool bNeedRecompile)
 
 void UHDeferredShadingRenderer::GenerateSH9Pass(UHRenderBuilder& RenderBuilder)
 {
-	UHGameTimerScope Scope("GenerateSH9Pass", false);
+	UH_TRACE_SCOPE("GenerateSH9Pass");
 	// generate SH9, this doesn't need to be called every frame
 	UHGPUTimeQueryScope TimeScope(RenderBuilder.GetCmdList(), GPUTimeQueries[UH_ENUM_VALUE(UHRenderPassTypes::GenerateSH9)], "GenerateSH9");
 	if (!RTParams.bEnableSkyLight || !RTParams.bNeedGenerateSH9)
@@ -69,7 +80,7 @@ void UHDeferredShadingRenderer::GenerateSH9Pass(UHRenderBuilder& RenderBuilder)
 
 void UHDeferredShadingRenderer::RenderSkyPass(UHRenderBuilder& RenderBuilder)
 {
-	UHGameTimerScope Scope("RenderSkyPass", false);
+	UH_TRACE_SCOPE("RenderSkyPass");
 	UHGPUTimeQueryScope TimeScope(RenderBuilder.GetCmdList(), GPUTimeQueries[UH_ENUM_VALUE(UHRenderPassTypes::SkyPass)], "SkyPass");
 	if (!RTParams.bEnableSkyLight)
 	{
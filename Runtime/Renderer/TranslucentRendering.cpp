@@ -35,7 +35,7 @@ void UHDeferredShadingRenderer::ScreenshotForRefraction(std::string PassName, UH
 
 void UHDeferredShadingRenderer::RenderTranslucentPass(UHRenderBuilder& RenderBuilder)
 {
-	UHGameTimerScope Scope("RenderTranslucentPass", false);
+	UH_TRACE_SCOPE("RenderTranslucentPass");
 	if (CurrentScene == nullptr)
 	{
 		return;
@@ -52,13 +52,11 @@ void UHDeferredShadingRenderer::RenderTranslucentPass(UHRenderBuilder& RenderBui
 		// Draw the translucent background
 		{
 			RenderBuilder.BeginRenderPass(TranslucentPassObj, RenderResolution, VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);
-#if WITH_EDITOR
 			for (int32_t I = 0; I < NumParallelRenderSubmitters; I++)
 			{
 				ThreadDrawCalls[I] = 0;
 				ThreadOccludedCalls[I] = 0;
 			}
-#endif
 
 			// init and wake tasks
 			static std::vector<UHTranslucentPassAsyncTask> Tasks(NumParallelRenderSubmitters);
@@ -74,13 +72,11 @@ void UHDeferredShadingRenderer::RenderTranslucentPass(UHRenderBuilder& RenderBui
 				WorkerThreads[I]->WaitTask();
 			}
 
-#if WITH_EDITOR
 			for (int32_t I = 0; I < NumParallelRenderSubmitters; I++)
 			{
 				RenderBuilder.DrawCalls += ThreadDrawCalls[I];
 				RenderBuilder.OccludedCalls += ThreadOccludedCalls[I];
 			}
-#endif
 			// execute all recorded batches
 			RenderBuilder.ExecuteBundles(TranslucentParallelSubmitter);
 			RenderBuilder.EndRenderPass();
@@ -92,7 +88,7 @@ void UHDeferredShadingRenderer::RenderTranslucentPass(UHRenderBuilder& RenderBui
 void UHDeferredShadingRenderer::TranslucentPassTask(int32_t ThreadIdx)
 {
 	// simply separate buffer recording into N threads
-	const int32_t MaxCount = static_cast<int32_t>(TranslucentsToRender.size());
+	const int32_t MaxCount = static_cast<int32_t>(TranslucentsToRender[CurrentFrameRT].size());
 	const int32_t RendererCount = (MaxCount + NumParallelRenderSubmitters) / NumParallelRenderSubmitters;
 	const int32_t StartIdx = std::min(RendererCount * ThreadIdx, MaxCount);
 	const int32_t EndIdx = (ThreadIdx == NumParallelRenderSubmitters - 1) ? MaxCount : std::min(StartIdx + RendererCount, MaxCount);
@@ -126,7 +122,7 @@ void UHDeferredShadingRenderer::TranslucentPassTask(int32_t ThreadIdx)
 	const uint32_t PrevFrame = (CurrentFrameRT - 1) % GMaxFrameInFlight;
 	for (int32_t I = StartIdx; I < EndIdx; I++)
 	{
-		const UHMeshRendererComponent* Renderer = TranslucentsToRender[I];
+		const UHMeshRendererComponent* Renderer = TranslucentsToRender[CurrentFrameRT][I];
 		const UHMaterial* Mat = Renderer->GetMaterial();
 		const int32_t RendererIdx = Renderer->GetBufferDataIndex();
 		UHMesh* Mesh = Renderer->GetMesh();
@@ -149,8 +145,9 @@ void UHDeferredShadingRenderer::TranslucentPassTask(int32_t ThreadIdx)
 		RenderBuilder.BindVertexBuffer(Mesh->GetPositionBuffer()->GetBuffer());
 		RenderBuilder.BindIndexBuffer(Mesh);
 		RenderBuilder.BindDescriptorSet(TranslucentShader->GetPipelineLayout(), TranslucentShader->GetDescriptorSet(CurrentFrameRT));
+		RenderBuilder.BindMaterialArena(TranslucentShader, CurrentFrameRT);
 
-		RenderBuilder.DrawIndexed(Mesh->GetIndicesCount());
+		RenderBuilder.DrawIndexed(Mesh->GetIndicesCount(), RendererIdx);
 
 		if (bOcclusionTest)
 		{
@@ -162,8 +159,6 @@ void UHDeferredShadingRenderer::TranslucentPassTask(int32_t ThreadIdx)
 
 	RenderBuilder.EndCommandBuffer();
 
-#if WITH_EDITOR
 	ThreadDrawCalls[ThreadIdx] += RenderBuilder.DrawCalls;
 	ThreadOccludedCalls[ThreadIdx] += RenderBuilder.OccludedCalls;
-#endif
 }
\ No newline at end of file
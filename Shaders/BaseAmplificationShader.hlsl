@@ -1,35 +1,207 @@
 // base amplification shader in UHE
+// it expands visible instances to meshlets and culls them before dispatching mesh shaders
 #include "../Shaders/UHInputs.hlsli"
 #include "../Shaders/UHCommon.hlsli"
 #include "../Shaders/UHMeshShaderCommon.hlsli"
 
-// for occlusion test in AS
+// per-instance mesh shader data, meshlet offsets are prefix-summed on C++ side
 StructuredBuffer<UHMeshShaderData> MeshShaderData : register(t3);
+
+// occlusion result
 ByteAddressBuffer OcclusionResult : register(t4);
 
+// renderer instances
+StructuredBuffer<UHRendererInstance> RendererInstances : register(t5);
+
+// Hi-Z of the previous frame, each mip stores the farthest depth
+Texture2D<float> HiZTexture : register(t6);
+
+// meshlets, fetched by mesh index first
+StructuredBuffer<UHMeshlet> Meshlets[] : register(t0, space3);
+
+[[vk::push_constant]] UHMeshShaderConstants Constants;
+
 groupshared uint GVisibleCount;
 groupshared UHMeshPayload Payload;
 
-// C++ side: Dispatch as (TotalMeshlets / MESHSHADER_GROUP_SIZE)
-[NumThreads(MESHSHADER_GROUP_SIZE, 1, 1)]
+uint FindInstance(uint MeshletIndex)
+{
+    // binary search the last instance whose meshlet offset is less or equal to the meshlet index
+    uint Low = 0;
+    uint High = Constants.InstanceCount - 1;
+    while (Low < High)
+    {
+        uint Mid = (Low + High + 1) >> 1;
+        if (MeshShaderData[Mid].MeshletOffset <= MeshletIndex)
+        {
+            Low = Mid;
+        }
+        else
+        {
+            High = Mid - 1;
+        }
+    }
+
+    return Low;
+}
+
+bool IsSphereInFrustum(float3 Center, float Radius)
+{
+    // extract planes from view projection, the far plane is skipped as reversed infinite z could be used
+    // planes are in the form of "dot(P.xyz, Pos) + P.w >= 0"
+    float4x4 ViewProj = transpose(GViewProj_NonJittered);
+    float4 Planes[5];
+    Planes[0] = ViewProj[3] + ViewProj[0];
+    Planes[1] = ViewProj[3] - ViewProj[0];
+    Planes[2] = ViewProj[3] + ViewProj[1];
+    Planes[3] = ViewProj[3] - ViewProj[1];
+    // near plane is z <= w with reversed z
+    Planes[4] = ViewProj[3] - ViewProj[2];
+
+    UHUNROLL
+    for (uint Idx = 0; Idx < 5; Idx++)
+    {
+        if (dot(Planes[Idx].xyz, Center) + Planes[Idx].w < -Radius * length(Planes[Idx].xyz))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool IsOccludedByHiZ(float3 Center, float Radius)
+{
+    // Hi-Z is built from the previous frame, so project the bound with previous view projection
+    float2 MinUV = 1.0f;
+    float2 MaxUV = 0.0f;
+    float NearestDepth = 0.0f;
+
+    UHUNROLL
+    for (uint Idx = 0; Idx < 8; Idx++)
+    {
+        float3 Corner = Center + Radius * float3((Idx & 1) ? 1.0f : -1.0f, (Idx & 2) ? 1.0f : -1.0f, (Idx & 4) ? 1.0f : -1.0f);
+        float4 ClipPos = mul(float4(Corner, 1.0f), GPrevViewProj_NonJittered);
+
+        // the bound crosses the near plane, treat it as visible
+        if (ClipPos.w <= 0.0f || ClipPos.z > ClipPos.w)
+        {
+            return false;
+        }
+
+        float3 NDCPos = ClipPos.xyz / ClipPos.w;
+        float2 UV = NDCPos.xy * 0.5f + 0.5f;
+        MinUV = min(MinUV, UV);
+        MaxUV = max(MaxUV, UV);
+
+        // reversed z, the nearest depth is the max value
+        NearestDepth = max(NearestDepth, NDCPos.z);
+    }
+    MinUV = saturate(MinUV);
+    MaxUV = saturate(MaxUV);
+
+    // pick the mip that the bound covers at most 2x2 texels
+    uint Width;
+    uint Height;
+    uint MipCount;
+    HiZTexture.GetDimensions(0, Width, Height, MipCount);
+
+    float2 RectSize = (MaxUV - MinUV) * float2(Width, Height);
+    uint MipLevel = (uint)clamp(ceil(log2(max(max(RectSize.x, RectSize.y), 1.0f))), 0.0f, (float)(MipCount - 1));
+
+    uint MipWidth;
+    uint MipHeight;
+    HiZTexture.GetDimensions(MipLevel, MipWidth, MipHeight, MipCount);
+
+    // mip texel covers (1 << MipLevel) texels of mip 0, the last texel also covers the odd edge
+    uint2 MipSize = uint2(MipWidth, MipHeight);
+    uint2 MinTexel = min(uint2(MinUV * float2(Width, Height)) >> MipLevel, MipSize - 1);
+    uint2 MaxTexel = min(uint2(MaxUV * float2(Width, Height)) >> MipLevel, MipSize - 1);
+
+    // the mip is clamped for huge bounds, don't bother testing them
+    if (any(MaxTexel - MinTexel > 1))
+    {
+        return false;
+    }
+
+    float FarthestDepth = min(min(HiZTexture.Load(int3(MinTexel, MipLevel)), HiZTexture.Load(int3(MaxTexel.x, MinTexel.y, MipLevel)))
+        , min(HiZTexture.Load(int3(MinTexel.x, MaxTexel.y, MipLevel)), HiZTexture.Load(int3(MaxTexel, MipLevel))));
+
+    return NearestDepth < FarthestDepth;
+}
+
+bool IsMeshletVisible(UHMeshlet Meshlet, ObjectConstants Obj, uint Flags)
+{
+    // transform bounding sphere to world space, scale the radius with the max axis scale
+    float3 Center = LocalToWorldPos(Meshlet.BoundCenter, Obj);
+    float3 AxisScale = float3(length(float3(Obj.GWorld[0].x, Obj.GWorld[1].x, Obj.GWorld[2].x))
+        , length(float3(Obj.GWorld[0].y, Obj.GWorld[1].y, Obj.GWorld[2].y))
+        , length(float3(Obj.GWorld[0].z, Obj.GWorld[1].z, Obj.GWorld[2].z)));
+    float MaxScale = max(AxisScale.x, max(AxisScale.y, AxisScale.z));
+    float MinScale = min(AxisScale.x, min(AxisScale.y, AxisScale.z));
+    float Radius = Meshlet.BoundRadius * MaxScale;
+
+    if (!IsSphereInFrustum(Center, Radius))
+    {
+        return false;
+    }
+
+    // backface cone culling, the cone is only valid for back-face culled, non-mirrored and uniformly scaled objects
+    bool bCanUseCone = (Flags & UH_MESHSHADER_CONE_CULLING) && !(Obj.GObjectFlags & UH_OBJ_MIRRORED)
+        && (MaxScale - MinScale) <= MaxScale * 0.001f;
+    if (bCanUseCone)
+    {
+        float3 ConeAxis = normalize(LocalToWorldDir(Meshlet.ConeAxis, Obj));
+        float3 ViewVector = Center - GCameraPos;
+        if (dot(ViewVector, ConeAxis) >= Meshlet.ConeCutoff * length(ViewVector) + Radius)
+        {
+            return false;
+        }
+    }
+
+    if (Constants.bEnableHiZ && IsOccludedByHiZ(Center, Radius))
+    {
+        return false;
+    }
+
+    return true;
+}
+
+// C++ side: Dispatch as (TotalMeshlets / AMPLIFICATION_GROUP_SIZE)
+[NumThreads(AMPLIFICATION_GROUP_SIZE, 1, 1)]
 void BaseAS(uint DTid : SV_DispatchThreadID, uint GTid : SV_GroupThreadID)
-{    
+{
     if (GTid == 0)
     {
         GVisibleCount = 0;
     }
     GroupMemoryBarrierWithGroupSync();
-    
-    // @TODO: Check if DTid exceeds MeshShaderData count.
-    
-    // count unoccluded meshlets to dispatch
-    UHMeshShaderData ShaderData = MeshShaderData[DTid];
-    if (ShaderData.bDoOcclusionTest == 0 || OcclusionResult.Load(ShaderData.RendererIndex * 4) > 0)
-    {
-        uint StoreIdx = 0;
-        InterlockedAdd(GVisibleCount, 1, StoreIdx);
-        Payload.ShaderDataIndices[StoreIdx] = DTid;
-    }
-    
+
+    if (DTid < Constants.MeshletCount)
+    {
+        // find the instance and local meshlet index
+        UHMeshShaderData ShaderData = MeshShaderData[FindInstance(DTid)];
+        uint MeshletIndex = DTid - ShaderData.MeshletOffset;
+
+        // instance level occlusion test from the previous frame query
+        bool bVisible = !(ShaderData.Flags & UH_MESHSHADER_OCCLUSION_TEST) || OcclusionResult.Load(ShaderData.RendererIndex * 4) > 0;
+
+        if (bVisible)
+        {
+            UHRendererInstance InInstance = RendererInstances[ShaderData.RendererIndex];
+            UHMeshlet Meshlet = Meshlets[InInstance.MeshIndex][MeshletIndex];
+            bVisible = IsMeshletVisible(Meshlet, UHObjects[ShaderData.RendererIndex], ShaderData.Flags);
+        }
+
+        if (bVisible)
+        {
+            uint StoreIdx = 0;
+            InterlockedAdd(GVisibleCount, 1, StoreIdx);
+            Payload.RendererIndices[StoreIdx] = ShaderData.RendererIndex;
+            Payload.MeshletIndices[StoreIdx] = MeshletIndex;
+        }
+    }
+    GroupMemoryBarrierWithGroupSync();
+
     DispatchMesh(GVisibleCount, 1, 1, Payload);
-}
\ No newline at end of file
+}
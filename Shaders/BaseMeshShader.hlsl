@@ -3,99 +3,71 @@
 #include "../Shaders/UHCommon.hlsli"
 #include "../Shaders/UHMeshShaderCommon.hlsli"
 
-// object constants
-StructuredBuffer<ObjectConstants> RendererConstants : register(t1);
-
-// mesh shader data to lookup renderer index & meshlet index
-// this should be accessed via Gid, since C++ side is dispatching (TotalMeshlets,1,1)
-StructuredBuffer<UHMeshShaderData> MeshShaderData : register(t3);
-
-// occlusion result
-ByteAddressBuffer OcclusionResult : register(t4);
-
 // renderer instances
 StructuredBuffer<UHRendererInstance> RendererInstances : register(t5);
 
 // all mesh data, fetched by mesh index first
 StructuredBuffer<UHMeshlet> Meshlets[] : register(t0, space3);
-StructuredBuffer<float3> PositionBuffer[] : register(t0, space4);
-StructuredBuffer<float2> UV0Buffer[] : register(t0, space5);
-ByteAddressBuffer IndicesBuffer[] : register(t0, space6);
-StructuredBuffer<float3> NormalBuffer[] : register(t0, space7);
-StructuredBuffer<float4> TangentBuffer[] : register(t0, space8);
+ByteAddressBuffer PositionBuffer[] : register(t0, space4);
+ByteAddressBuffer UV0Buffer[] : register(t0, space5);
+ByteAddressBuffer MeshletData[] : register(t0, space6);
+ByteAddressBuffer NormalBuffer[] : register(t0, space7);
+ByteAddressBuffer TangentBuffer[] : register(t0, space8);
 
 // entry point for mesh shader
 // each group should process all verts and prims of a meshlet, up to MESHSHADER_MAX_VERTEX & MESHSHADER_MAX_PRIMITIVE
+// the visible meshlets are output from amplification shader
 [NumThreads(MESHSHADER_GROUP_SIZE, 1, 1)]
 [OutputTopology("triangle")]
 void BaseMS(
     uint Gid : SV_GroupID,
     uint GTid : SV_GroupThreadID,
+    in payload UHMeshPayload Payload,
     out vertices VertexOutput OutVerts[MESHSHADER_MAX_VERTEX],
     out indices uint3 OutTris[MESHSHADER_MAX_PRIMITIVE]
 )
 {     
     // fetch data and set mesh outputs
-    UHMeshShaderData ShaderData = MeshShaderData[Gid];        
-    UHRendererInstance InInstance = RendererInstances[ShaderData.RendererIndex];
-    UHMeshlet Meshlet = Meshlets[InInstance.MeshIndex][ShaderData.MeshletIndex];
+    uint RendererIndex = Payload.RendererIndices[Gid];
+    UHRendererInstance InInstance = RendererInstances[RendererIndex];
+    UHMeshlet Meshlet = Meshlets[InInstance.MeshIndex][Payload.MeshletIndices[Gid]];
     SetMeshOutputCounts(Meshlet.VertexCount, Meshlet.PrimitiveCount);
     
-    // occlusion test check, not every objects have the occlusion test enabled, so need another bDoOcclusionTest flag to check
-    if (ShaderData.bDoOcclusionTest == 1 && OcclusionResult.Load(ShaderData.RendererIndex * 4) == 0)
-    {
-        // workaround for some hardware (E.g. AMD integrated GPU), it would TDR if I output nothing or set 0 output counts.
-        // I should really move culling stuff to the amplification shader someday.
-        if (GTid < Meshlet.VertexCount)
-        {
-            OutVerts[GTid] = (VertexOutput)0;
-        }
-    
-        if (GTid < Meshlet.PrimitiveCount)
-        {
-            OutTris[GTid] = 0;
-        }
-        
-        return;
-    }
-    
     // output triangles first
     if (GTid < Meshlet.PrimitiveCount)
     {
-        // output triangle indices in order, the vertex output below will get the correct unique vertex to output
-        // so I don't need to mess around here
-        OutTris[GTid] = uint3(GTid * 3 + 0, GTid * 3 + 1, GTid * 3 + 2);
+        // output meshlet-local triangle indices, they index to the unique vertices output below
+        OutTris[GTid] = GetMeshletTriangle(MeshletData[InInstance.MeshIndex], Meshlet, GTid);
     }
     
     // output vertrex next
     if (GTid < Meshlet.VertexCount)
     {
         // convert local index to vertex index, and lookup the corresponding vertex
-        // it's like outputting the "IndicesData" in UHMesh class, which holds the unique vertex indices
-        uint VertexIndex = GetVertexIndex(IndicesBuffer[InInstance.MeshIndex], GTid + Meshlet.VertexOffset, InInstance.IndiceType);
+        uint VertexIndex = GetMeshletVertexIndex(MeshletData[InInstance.MeshIndex], Meshlet, GTid);
         
         // fetch vertex data and output
         VertexOutput Output = (VertexOutput)0;
-        Output.Position.xyz = PositionBuffer[InInstance.MeshIndex][VertexIndex];
-        Output.UV0 = UV0Buffer[InInstance.MeshIndex][VertexIndex];
+        Output.Position.xyz = LoadVertexPosition(PositionBuffer[InInstance.MeshIndex], VertexIndex);
+        Output.UV0 = LoadVertexUV0(UV0Buffer[InInstance.MeshIndex], VertexIndex);
         
         // transformation
-        ObjectConstants Constant = RendererConstants[ShaderData.RendererIndex];
-        float3 WorldPos = mul(float4(Output.Position.xyz, 1.0f), Constant.GWorld).xyz;
+        ObjectConstants Constant = UHObjects[RendererIndex];
+        float3 WorldPos = LocalToWorldPos(Output.Position.xyz, Constant);
 
         float4x4 JitterMatrix = GetDistanceScaledJitterMatrix(length(WorldPos - GCameraPos));
         Output.Position = mul(float4(WorldPos, 1.0f), GViewProj_NonJittered);
         Output.Position = mul(Output.Position, JitterMatrix);
         
-        float3 Normal = LocalToWorldNormalMS(NormalBuffer[InInstance.MeshIndex][VertexIndex], (float3x3)Constant.GWorldIT);
+        float3 Normal = LocalToWorldNormal(LoadVertexNormal(NormalBuffer[InInstance.MeshIndex], VertexIndex), Constant);
 #if TANGENT_SPACE
 	    // calculate world TBN if normal map is used
-        Output.WorldTBN = CreateTBNMS(Normal, TangentBuffer[InInstance.MeshIndex][VertexIndex], (float3x3)Constant.GWorld);
+        Output.WorldTBN = CreateTBN(Normal, LoadVertexTangent(TangentBuffer[InInstance.MeshIndex], VertexIndex), Constant);
 #endif
         
         // transform normal by world IT
         Output.Normal = Normal;
-        Output.InstanceIndex = ShaderData.RendererIndex;
+        Output.InstanceIndex = RendererIndex;
         
         OutVerts[GTid] = Output;
     }
@@ -1,15 +1,18 @@
 #include "UHInputs.hlsli"
 #include "UHCommon.hlsli"
+#include "UHMeshShaderCommon.hlsli"
 
-StructuredBuffer<float2> UV0Buffer : register(t3);
-StructuredBuffer<float3> NormalBuffer : register(t4);
-StructuredBuffer<float4> TangentBuffer : register(t5);
+ByteAddressBuffer UV0Buffer : register(t3);
+ByteAddressBuffer NormalBuffer : register(t4);
+ByteAddressBuffer TangentBuffer : register(t5);
 
-VertexOutput BaseVS(float3 Position : POSITION, uint Vid : SV_VertexID)
+VertexOutput BaseVS(float3 Position : POSITION, uint Vid : SV_VertexID, uint InstanceID : SV_InstanceID)
 {
 	VertexOutput Vout = (VertexOutput)0;
 
-	float3 WorldPos = mul(float4(Position, 1.0f), GWorld).xyz;
+	// object constants are fetched by the first instance set on C++ side
+	ObjectConstants Obj = UHObjects[InstanceID];
+	float3 WorldPos = LocalToWorldPos(Position, Obj);
 
 	// calculate jitter
 	float4x4 JitterMatrix = GetDistanceScaledJitterMatrix(length(WorldPos - GCameraPos));
@@ -17,16 +20,16 @@ VertexOutput BaseVS(float3 Position : POSITION, uint Vid : SV_VertexID)
 	// pass through the vertex data
 	Vout.Position = mul(float4(WorldPos, 1.0f), GViewProj_NonJittered);
 	Vout.Position = mul(Vout.Position, JitterMatrix);
-	Vout.UV0 = UV0Buffer[Vid];
+	Vout.UV0 = LoadVertexUV0(UV0Buffer, Vid);
 
 #if TANGENT_SPACE
 	// calculate world TBN if normal map is used
-    Vout.WorldTBN = CreateTBN(LocalToWorldNormal(NormalBuffer[Vid]), TangentBuffer[Vid]);
+    Vout.WorldTBN = CreateTBN(LocalToWorldNormal(LoadVertexNormal(NormalBuffer, Vid), Obj), LoadVertexTangent(TangentBuffer, Vid), Obj);
 #endif
 
 	// transform normal by world IT
-    Vout.Normal = LocalToWorldNormal(NormalBuffer[Vid]);
-    Vout.InstanceIndex = GInstanceIndex;
+    Vout.Normal = LocalToWorldNormal(LoadVertexNormal(NormalBuffer, Vid), Obj);
+    Vout.InstanceIndex = Obj.GInstanceIndex;
 #if TRANSLUCENT
 	Vout.WorldPos = WorldPos;
 #endif
@@ -3,69 +3,72 @@
 #include "../Shaders/UHCommon.hlsli"
 #include "../Shaders/UHMeshShaderCommon.hlsli"
 
-// object constants
-StructuredBuffer<ObjectConstants> RendererConstants : register(t1);
-
-// mesh shader data to lookup renderer index & meshlet index
-// this should be accessed via Gid, since C++ side is dispatching (TotalMeshlets,1,1)
-StructuredBuffer<UHMeshShaderData> MeshShaderData : register(t3);
-
 // renderer instances
-StructuredBuffer<UHRendererInstance> RendererInstances : register(t4);
+StructuredBuffer<UHRendererInstance> RendererInstances : register(t5);
 
 // all mesh data, fetched by mesh index first
 StructuredBuffer<UHMeshlet> Meshlets[] : register(t0, space3);
-StructuredBuffer<float3> PositionBuffer[] : register(t0, space4);
-StructuredBuffer<float2> UV0Buffer[] : register(t0, space5);
-ByteAddressBuffer IndicesBuffer[] : register(t0, space6);
+ByteAddressBuffer PositionBuffer[] : register(t0, space4);
+ByteAddressBuffer UV0Buffer[] : register(t0, space5);
+ByteAddressBuffer MeshletData[] : register(t0, space6);
 
 // entry point for mesh shader
 // each group should process all verts and prims of a meshlet, up to MESHSHADER_MAX_VERTEX & MESHSHADER_MAX_PRIMITIVE
+// the visible meshlets are output from amplification shader
 [NumThreads(MESHSHADER_GROUP_SIZE, 1, 1)]
 [OutputTopology("triangle")]
 void DepthMS(
     uint Gid : SV_GroupID,
     uint GTid : SV_GroupThreadID,
+    in payload UHMeshPayload Payload,
     out vertices DepthVertexOutput OutVerts[MESHSHADER_MAX_VERTEX],
     out indices uint3 OutTris[MESHSHADER_MAX_PRIMITIVE]
+#if VISIBILITY_BUFFER
+    , out primitives VisibilityPrimitiveOutput OutPrims[MESHSHADER_MAX_PRIMITIVE]
+#endif
 )
 {
     // fetch data and set mesh outputs
-    UHMeshShaderData ShaderData = MeshShaderData[Gid];
-    UHRendererInstance InInstance = RendererInstances[ShaderData.RendererIndex];
-    UHMeshlet Meshlet = Meshlets[InInstance.MeshIndex][ShaderData.MeshletIndex];
-    
+    uint RendererIndex = Payload.RendererIndices[Gid];
+    uint MeshletIndex = Payload.MeshletIndices[Gid];
+    UHRendererInstance InInstance = RendererInstances[RendererIndex];
+    UHMeshlet Meshlet = Meshlets[InInstance.MeshIndex][MeshletIndex];
     SetMeshOutputCounts(Meshlet.VertexCount, Meshlet.PrimitiveCount);
     
     // output triangles first
     if (GTid < Meshlet.PrimitiveCount)
     {
-        // output triangle indices in order, the vertex output below will get the correct unique vertex to output
-        // so I don't need to mess around here
-        OutTris[GTid] = uint3(GTid * 3 + 0, GTid * 3 + 1, GTid * 3 + 2);
+        // output meshlet-local triangle indices, they index to the unique vertices output below
+        OutTris[GTid] = GetMeshletTriangle(MeshletData[InInstance.MeshIndex], Meshlet, GTid);
+#if VISIBILITY_BUFFER
+        // triangle ID within the mesh, the material resolve pass finds the meshlet and the triangle with it
+        OutPrims[GTid].PrimitiveID = MeshletIndex * MESHSHADER_MAX_PRIMITIVE + GTid;
+#endif
     }
     
     // output vertrex next
     if (GTid < Meshlet.VertexCount)
     {
         // convert local index to vertex index, and lookup the corresponding vertex
-        // it's like outputting the "IndicesData" in UHMesh class, which holds the unique vertex indices
-        uint VertexIndex = GetVertexIndex(IndicesBuffer[InInstance.MeshIndex], GTid + Meshlet.VertexOffset, InInstance.IndiceType);
+        uint VertexIndex = GetMeshletVertexIndex(MeshletData[InInstance.MeshIndex], Meshlet, GTid);
         
         // fetch vertex data and output
         DepthVertexOutput Output = (DepthVertexOutput)0;
-        Output.Position.xyz = PositionBuffer[InInstance.MeshIndex][VertexIndex];
+        Output.Position.xyz = LoadVertexPosition(PositionBuffer[InInstance.MeshIndex], VertexIndex);
 #if MASKED
-        Output.UV0 = UV0Buffer[InInstance.MeshIndex][VertexIndex];
+        Output.UV0 = LoadVertexUV0(UV0Buffer[InInstance.MeshIndex], VertexIndex);
 #endif
         
         // transformation
-        ObjectConstants Constant = RendererConstants[ShaderData.RendererIndex];
-        float3 WorldPos = mul(float4(Output.Position.xyz, 1.0f), Constant.GWorld).xyz;
+        ObjectConstants Constant = UHObjects[RendererIndex];
+        float3 WorldPos = LocalToWorldPos(Output.Position.xyz, Constant);
 
         float4x4 JitterMatrix = GetDistanceScaledJitterMatrix(length(WorldPos - GCameraPos));
         Output.Position = mul(float4(WorldPos, 1.0f), GViewProj_NonJittered);
         Output.Position = mul(Output.Position, JitterMatrix);
+#if VISIBILITY_BUFFER
+        Output.RendererIndex = RendererIndex;
+#endif
         
         OutVerts[GTid] = Output;
     }
@@ -18,6 +18,17 @@ UHMaterialInputs GetMaterialInput(float2 UV0)
 	return (UHMaterialInputs)0;
 }
 
+#if VISIBILITY_BUFFER
+// output renderer index + 1 and triangle ID, 0 is reserved for empty pixels
+uint2 DepthPS(DepthVertexOutput Vin, uint PrimitiveID : SV_PrimitiveID) : SV_Target0
+{
+#if MASKED
+	UHMaterialInputs MaterialInput = GetMaterialInput(Vin.UV0);
+	clip(MaterialInput.Opacity - GCutoff);
+#endif
+	return uint2(Vin.RendererIndex + 1, PrimitiveID);
+}
+#else
 void DepthPS(DepthVertexOutput Vin)
 {
 	// only alpha test will have this pixel shader, do cutoff anyway
@@ -25,4 +36,5 @@ void DepthPS(DepthVertexOutput Vin)
 	UHMaterialInputs MaterialInput = GetMaterialInput(Vin.UV0);
 	clip(MaterialInput.Opacity - GCutoff);
 #endif
-}
\ No newline at end of file
+}
+#endif
\ No newline at end of file
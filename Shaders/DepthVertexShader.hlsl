@@ -1,13 +1,15 @@
 #include "../Shaders/UHInputs.hlsli"
 #include "../Shaders/UHCommon.hlsli"
+#include "../Shaders/UHMeshShaderCommon.hlsli"
 
-StructuredBuffer<float2> UV0Buffer : register(t3);
+ByteAddressBuffer UV0Buffer : register(t3);
 
-DepthVertexOutput DepthVS(float3 Position : POSITION, uint Vid : SV_VertexID)
+DepthVertexOutput DepthVS(float3 Position : POSITION, uint Vid : SV_VertexID, uint InstanceID : SV_InstanceID)
 {
 	DepthVertexOutput Vout = (DepthVertexOutput)0;
 
-	float3 WorldPos = mul(float4(Position, 1.0f), GWorld).xyz;
+	ObjectConstants Obj = UHObjects[InstanceID];
+	float3 WorldPos = LocalToWorldPos(Position, Obj);
 
 	// calculate jitter
 	float4x4 JitterMatrix = GetDistanceScaledJitterMatrix(length(WorldPos - GCameraPos));
@@ -16,7 +18,7 @@ DepthVertexOutput DepthVS(float3 Position : POSITION, uint Vid : SV_VertexID)
 	Vout.Position = mul(float4(WorldPos, 1.0f), GViewProj_NonJittered);
 	Vout.Position = mul(Vout.Position, JitterMatrix);
 #if MASKED
-	Vout.UV0 = UV0Buffer[Vid];
+	Vout.UV0 = LoadVertexUV0(UV0Buffer, Vid);
 #endif
 
 	return Vout;
@@ -0,0 +1,57 @@
+// shader to generate hierarchical Z buffer, each texel stores the farthest depth of its footprint
+// UHE uses reversed z, so the farthest depth is the min value
+#include "UHInputs.hlsli"
+
+RWTexture2D<float> InputMip : register(u0);
+RWTexture2D<float> OutputMip : register(u1);
+Texture2D<float> SceneDepth : register(t2);
+
+struct HiZConstants
+{
+    uint InputWidth;
+    uint InputHeight;
+    uint OutputWidth;
+    uint OutputHeight;
+    uint bFromSceneDepth;
+};
+[[vk::push_constant]] HiZConstants Constants;
+
+float LoadInputDepth(int2 Pos)
+{
+    Pos = min(Pos, int2(Constants.InputWidth, Constants.InputHeight) - 1);
+
+    UHBRANCH
+    if (Constants.bFromSceneDepth)
+    {
+        return SceneDepth[Pos];
+    }
+
+    return InputMip[Pos];
+}
+
+[numthreads(UHTHREAD_GROUP2D_X, UHTHREAD_GROUP2D_Y, 1)]
+void GenerateHiZCS(uint3 DTid : SV_DispatchThreadID)
+{
+    if (DTid.x >= Constants.OutputWidth || DTid.y >= Constants.OutputHeight)
+    {
+        return;
+    }
+
+    // the last texel also covers the extra row/column when input size is odd
+    // so the coarser mips are still conservative
+    int2 BasePos = DTid.xy * 2;
+    int2 Extent;
+    Extent.x = (DTid.x == Constants.OutputWidth - 1 && (Constants.InputWidth & 1)) ? 3 : 2;
+    Extent.y = (DTid.y == Constants.OutputHeight - 1 && (Constants.InputHeight & 1)) ? 3 : 2;
+
+    float OutDepth = 1.0f;
+    for (int I = 0; I < Extent.x; I++)
+    {
+        for (int J = 0; J < Extent.y; J++)
+        {
+            OutDepth = min(OutDepth, LoadInputDepth(BasePos + int2(I, J)));
+        }
+    }
+
+    OutputMip[DTid.xy] = OutDepth;
+}
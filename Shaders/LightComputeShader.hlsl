@@ -90,20 +90,18 @@ void LightCS(uint3 DTid : SV_DispatchThreadID, uint3 GTid : SV_GroupThreadID)
         }
     }
     
-    // fetch tiles for positional lights
-    uint TileX = CoordToTileX(PixelCoord.x);
-    uint TileY = CoordToTileY(PixelCoord.y);
-    uint TileIndex = TileX + TileY * GLightTileCountX;
-    uint TileOffset = GetPointLightOffset(TileIndex);
-    uint PointLightCount = PointLightList.Load(TileOffset);
-    TileOffset += 4;
+    // fetch clusters for positional lights, use world pos so it matches the cluster in shadow tracing
+    uint ClusterIndex = GetClusterIndexFromWorldPos(WorldPos);
+    uint ListOffset = GetLightListOffset(PointLightList, ClusterIndex);
+    uint PointLightCount = PointLightList.Load(ListOffset);
+    ListOffset += 4;
     
-    uint ClosestPointLightIndex = GetClosestPointLightIndex(PointLightList, TileIndex, WorldPos);
+    uint ClosestPointLightIndex = GetClosestPointLightIndex(PointLightList, ClusterIndex, WorldPos);
     UHLOOP
     for (Ldx = 0; Ldx < PointLightCount; Ldx++)
     {
-        uint PointLightIdx = PointLightList.Load(TileOffset);
-        TileOffset += 4;
+        uint PointLightIdx = PointLightList.Load(ListOffset);
+        ListOffset += 4;
        
         UHPointLight PointLight = UHPointLights[PointLightIdx];
         if (PointLight.bIsEnabled)
@@ -123,16 +121,16 @@ void LightCS(uint3 DTid : SV_DispatchThreadID, uint3 GTid : SV_GroupThreadID)
         }
     }
     
-    TileOffset = GetSpotLightOffset(TileIndex);
-    uint SpotLightCount = SpotLightList.Load(TileOffset);
-    TileOffset += 4;
+    ListOffset = GetLightListOffset(SpotLightList, ClusterIndex);
+    uint SpotLightCount = SpotLightList.Load(ListOffset);
+    ListOffset += 4;
     
-    uint ClosestSpotLightIndex = GetClosestSpotLightIndex(SpotLightList, TileIndex, WorldPos);
+    uint ClosestSpotLightIndex = GetClosestSpotLightIndex(SpotLightList, ClusterIndex, WorldPos);
     UHLOOP
     for (Ldx = 0; Ldx < SpotLightCount; Ldx++)
     {
-        uint SpotLightIdx = SpotLightList.Load(TileOffset);
-        TileOffset += 4;
+        uint SpotLightIdx = SpotLightList.Load(ListOffset);
+        ListOffset += 4;
         
         UHSpotLight SpotLight = UHSpotLights[SpotLightIdx];
         if (SpotLight.bIsEnabled)
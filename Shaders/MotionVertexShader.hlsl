@@ -1,16 +1,18 @@
 #include "UHInputs.hlsli"
 #include "UHCommon.hlsli"
+#include "UHMeshShaderCommon.hlsli"
 
-StructuredBuffer<float2> UV0Buffer : register(t3);
-StructuredBuffer<float3> NormalBuffer : register(t4);
-StructuredBuffer<float4> TangentBuffer : register(t5);
+ByteAddressBuffer UV0Buffer : register(t3);
+ByteAddressBuffer NormalBuffer : register(t4);
+ByteAddressBuffer TangentBuffer : register(t5);
 
-MotionVertexOutput MotionObjectVS(float3 Position : POSITION, uint Vid : SV_VertexID)
+MotionVertexOutput MotionObjectVS(float3 Position : POSITION, uint Vid : SV_VertexID, uint InstanceID : SV_InstanceID)
 {
 	MotionVertexOutput Vout = (MotionVertexOutput)0;
 
-	float3 WorldPos = mul(float4(Position, 1.0f), GWorld).xyz;
-	float3 PrevWorldPos = mul(float4(Position, 1.0f), GPrevWorld).xyz;
+	ObjectConstants Obj = UHObjects[InstanceID];
+	float3 WorldPos = LocalToWorldPos(Position, Obj);
+	float3 PrevWorldPos = PrevLocalToWorldPos(Position, Obj);
 
 	// calculate jitter
 	float4x4 JitterMatrix = GetDistanceScaledJitterMatrix(length(WorldPos - GCameraPos));
@@ -21,11 +23,11 @@ MotionVertexOutput MotionObjectVS(float3 Position : POSITION, uint Vid : SV_Vert
 	Vout.PrevPos = mul(float4(PrevWorldPos, 1.0f), GPrevViewProj_NonJittered);
 
 	Vout.Position = mul(Vout.Position, JitterMatrix);
-	Vout.UV0 = UV0Buffer[Vid];
+	Vout.UV0 = LoadVertexUV0(UV0Buffer, Vid);
 	
 #if TANGENT_SPACE && TRANSLUCENT
 	// calculate world TBN if normal map is used
-    Vout.WorldTBN = CreateTBN(Vout.Normal, TangentBuffer[Vid]);
+    Vout.WorldTBN = CreateTBN(Vout.Normal, LoadVertexTangent(TangentBuffer, Vid), Obj);
 #endif
 
 	return Vout;
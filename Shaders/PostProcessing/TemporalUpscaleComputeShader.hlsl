@@ -0,0 +1,203 @@
+#include "../UHInputs.hlsli"
+#include "../UHCommon.hlsli"
+
+// temporal upscaler, the jittered scene result at render resolution is reconstructed at output resolution
+// and accumulated with the history, the lock of thin features is stored in history alpha
+RWTexture2D<float4> OutputResult : register(u1);
+Texture2D SceneTexture : register(t2);
+Texture2D HistoryTexture : register(t3);
+Texture2D MotionTexture : register(t4);
+Texture2D DepthTexture : register(t5);
+Texture2D MixedDepthTexture : register(t6);
+SamplerState PointSampler : register(s7);
+SamplerState LinearSampler : register(s8);
+
+struct TemporalUpscaleConstants
+{
+    uint2 OutputResolution;
+    float2 InvOutputResolution;
+    uint bResetHistory;
+};
+[[vk::push_constant]] TemporalUpscaleConstants Constants;
+
+static const float GHistoryWeightMin = 0.8f;
+static const float GHistoryWeightMax = 0.95f;
+static const float GMotionDiffScale = 50.0f;
+static const float GLockDecay = 0.05f;
+static const float GLockLumaThreshold = 0.1f;
+static const float GReactiveStrength = 0.5f;
+
+// jitter of a pixel in render resolution pixels, it's scaled by distance the same as GetDistanceScaledJitterMatrix()
+float2 GetPixelJitter(float2 UV, float Depth)
+{
+    float Dist = length(ComputeWorldPositionFromDeviceZ_UV(UV, Depth) - GCameraPos);
+    float DistFactor = saturate(Dist * GJitterScaleFactor);
+    DistFactor *= DistFactor;
+
+    float2 Offset = float2(GJitterOffsetX, GJitterOffsetY);
+    Offset = lerp(Offset, Offset * GJitterScaleMin, DistFactor);
+
+    // the jitter is applied as NDC offset
+    return Offset * 0.5f * GResolution.xy;
+}
+
+// 5-tap Catmull-Rom, the bilinear history gets blurry quickly when it's upscaled
+float4 SampleHistoryCatmullRom(float2 UV)
+{
+    float2 HistorySize = float2(Constants.OutputResolution);
+    float2 SamplePos = UV * HistorySize;
+    float2 TexPos1 = floor(SamplePos - 0.5f) + 0.5f;
+    float2 F = SamplePos - TexPos1;
+
+    float2 W0 = F * (-0.5f + F * (1.0f - 0.5f * F));
+    float2 W1 = 1.0f + F * F * (-2.5f + 1.5f * F);
+    float2 W2 = F * (0.5f + F * (2.0f - 1.5f * F));
+    float2 W3 = F * F * (-0.5f + 0.5f * F);
+
+    float2 W12 = W1 + W2;
+    float2 TexPos0 = (TexPos1 - 1.0f) * Constants.InvOutputResolution;
+    float2 TexPos3 = (TexPos1 + 2.0f) * Constants.InvOutputResolution;
+    float2 TexPos12 = (TexPos1 + W2 / W12) * Constants.InvOutputResolution;
+
+    float4 Result = 0;
+    Result += HistoryTexture.SampleLevel(LinearSampler, float2(TexPos12.x, TexPos0.y), 0) * W12.x * W0.y;
+    Result += HistoryTexture.SampleLevel(LinearSampler, float2(TexPos0.x, TexPos12.y), 0) * W0.x * W12.y;
+    Result += HistoryTexture.SampleLevel(LinearSampler, float2(TexPos12.x, TexPos12.y), 0) * W12.x * W12.y;
+    Result += HistoryTexture.SampleLevel(LinearSampler, float2(TexPos3.x, TexPos12.y), 0) * W3.x * W12.y;
+    Result += HistoryTexture.SampleLevel(LinearSampler, float2(TexPos12.x, TexPos3.y), 0) * W12.x * W3.y;
+
+    // the corner taps are skipped, normalize the weights
+    float WeightSum = W12.x * W0.y + W0.x * W12.y + W12.x * W12.y + W3.x * W12.y + W12.x * W3.y;
+    return max(Result / WeightSum, 0);
+}
+
+// a thin feature has no similar neighbor quad around it, e.g. wires and specular sparkles
+// they are locked so the history isn't clamped away
+bool IsThinFeature(float Luma[9])
+{
+    // 0 1 2
+    // 3 4 5
+    // 6 7 8
+    static const uint4 Quads[4] = { uint4(0, 1, 3, 4), uint4(1, 2, 4, 5), uint4(3, 4, 6, 7), uint4(4, 5, 7, 8) };
+
+    bool bHasSimilarQuad = false;
+    UHUNROLL
+    for (uint Idx = 0; Idx < 4; Idx++)
+    {
+        bool bSimilar = true;
+        UHUNROLL
+        for (uint Jdx = 0; Jdx < 4; Jdx++)
+        {
+            float Neighbor = Luma[Quads[Idx][Jdx]];
+            bSimilar = bSimilar && abs(Neighbor - Luma[4]) <= GLockLumaThreshold * max(max(Neighbor, Luma[4]), 1e-4f);
+        }
+        bHasSimilarQuad = bHasSimilarQuad || bSimilar;
+    }
+
+    return !bHasSimilarQuad;
+}
+
+[numthreads(UHTHREAD_GROUP2D_X, UHTHREAD_GROUP2D_Y, 1)]
+void TemporalUpscaleCS(uint3 DTid : SV_DispatchThreadID)
+{
+    if (any(DTid.xy >= Constants.OutputResolution))
+    {
+        return;
+    }
+
+    float2 UV = (float2(DTid.xy) + 0.5f) * Constants.InvOutputResolution;
+    float2 InputPos = UV * GResolution.xy;
+    int2 InputMax = int2(GResolution.xy) - 1;
+    int2 CenterPos = clamp(int2(InputPos), 0, InputMax);
+
+    // pick the closest depth in 3x3 for motion, so the edges of foreground objects don't leave trails
+    float ClosestDepth = 0.0f;
+    int2 ClosestPos = CenterPos;
+    UHUNROLL
+    for (int Idx = -1; Idx <= 1; Idx++)
+    {
+        UHUNROLL
+        for (int Jdx = -1; Jdx <= 1; Jdx++)
+        {
+            int2 Pos = clamp(CenterPos + int2(Jdx, Idx), 0, InputMax);
+            float Depth = DepthTexture[Pos].r;
+
+            // reversed-z, closer is larger
+            if (Depth > ClosestDepth)
+            {
+                ClosestDepth = Depth;
+                ClosestPos = Pos;
+            }
+        }
+    }
+
+    // the samples are rendered with jitter, find the samples around the unjittered output position
+    float2 Jitter = GetPixelJitter(UV, DepthTexture[CenterPos].r);
+    int2 SamplePos = int2(floor(InputPos + Jitter));
+
+    float3 ColorSum = 0;
+    float WeightSum = 0;
+    float SampleConfidence = 0;
+    float3 MinColor = UH_FLOAT_MAX;
+    float3 MaxColor = -UH_FLOAT_MAX;
+    float Luma[9];
+
+    UHUNROLL
+    for (int Idx = -1; Idx <= 1; Idx++)
+    {
+        UHUNROLL
+        for (int Jdx = -1; Jdx <= 1; Jdx++)
+        {
+            int2 Pos = clamp(SamplePos + int2(Jdx, Idx), 0, InputMax);
+            float3 Color = SceneTexture[Pos].rgb;
+
+            // gaussian fit of Blackman-Harris, the distance is from the unjittered sample location to output pixel
+            float2 Dist = (float2(Pos) + 0.5f - Jitter) - InputPos;
+            float Weight = exp(-2.29f * dot(Dist, Dist));
+
+            ColorSum += Color * Weight;
+            WeightSum += Weight;
+            SampleConfidence = max(SampleConfidence, Weight);
+            MinColor = min(MinColor, Color);
+            MaxColor = max(MaxColor, Color);
+            Luma[(Idx + 1) * 3 + (Jdx + 1)] = RGBToLuminance(Color);
+        }
+    }
+    float3 Result = ColorSum / max(WeightSum, 1e-4f);
+
+    // reactive mask, history of translucent surfaces isn't reliable as their motion isn't the motion of what's behind
+    float Reactive = (MixedDepthTexture[CenterPos].r != DepthTexture[CenterPos].r) ? GReactiveStrength : 0.0f;
+
+    float2 Motion = MotionTexture[ClosestPos].rg;
+    float2 HistoryUV = UV - Motion;
+    bool bHistoryValid = (Constants.bResetHistory == 0) && IsUVInsideScreen(HistoryUV);
+    if (!bHistoryValid)
+    {
+        OutputResult[DTid.xy] = float4(Result, 0);
+        return;
+    }
+
+    // adjust the history weight based on the motion amount, make it less blurry when moving the camera
+    float WeightBlend = 1.0f - saturate(length(Motion) * GMotionDiffScale);
+    float HistoryWeight = lerp(GHistoryWeightMin, GHistoryWeightMax, WeightBlend * WeightBlend);
+
+    float4 History = SampleHistoryCatmullRom(HistoryUV);
+    float3 ClampedHistory = clamp(History.rgb, MinColor, MaxColor);
+
+    // lock is created on thin features and decays over time, it's removed when the history is rejected anyway
+    float Lock = saturate(History.a - GLockDecay);
+    if (IsThinFeature(Luma))
+    {
+        Lock = 1.0f;
+    }
+    float LumaDiff = abs(RGBToLuminance(History.rgb) - RGBToLuminance(Result)) / max(RGBToLuminance(Result), 1e-4f);
+    Lock *= (LumaDiff < 1.0f && Reactive == 0.0f) ? 1.0f : 0.0f;
+    History.rgb = lerp(ClampedHistory, History.rgb, Lock);
+
+    // the closer a sample is to the output pixel, the more it contributes
+    float CurrentWeight = (1.0f - HistoryWeight) * SampleConfidence;
+    CurrentWeight = lerp(CurrentWeight, 1.0f, Reactive);
+
+    float3 Accumulation = lerp(History.rgb, Result, saturate(CurrentWeight));
+    OutputResult[DTid.xy] = float4(Accumulation, Lock);
+}
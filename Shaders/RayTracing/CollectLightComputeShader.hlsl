@@ -1,6 +1,7 @@
 // shader to collect light for ray tracing instance use
 #define UHPOINTLIGHT_BIND t2
 #define UHSPOTLIGHT_BIND t3
+#define UHOBJ_BIND t4
 #include "../UHInputs.hlsli"
 #include "../UHCommon.hlsli"
 #include "../UHLightCommon.hlsli"
@@ -9,7 +10,6 @@
 
 // each instance will hold point/spot light indices that intersects it
 RWStructuredBuffer<UHInstanceLights> Result : register(u1);
-StructuredBuffer<ObjectConstants> UHObjects : register(t4);
 
 groupshared uint GLightCount;
 
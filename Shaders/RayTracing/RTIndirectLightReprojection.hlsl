@@ -2,6 +2,7 @@
 // the pass should be added before Bilateral filtering
 #include "../UHInputs.hlsli"
 #include "../UHCommon.hlsli"
+#include "UHRTTileCommon.hlsli"
 
 RWTexture2D<float4> OutResult : register(u1);
 Texture2D HistoryResult : register(t2);
@@ -13,6 +14,8 @@ Texture2D HistoryNormal : register(t7);
 
 SamplerState PointClampped : register(s8);
 SamplerState LinearClampped : register(s9);
+// adaptive tile rates from the classification, the skipped tiles aren't traced this frame
+RWTexture2D<uint> TileRate : register(u10);
 
 struct RTIndirectReprojectionConstants
 {
@@ -35,7 +38,7 @@ struct RTReprojectionData
     float3 PrevNormal;
 };
 
-RTReprojectionData GetReprojectionData(uint2 PixelCoord, float2 ScreenUV)
+RTReprojectionData GetReprojectionData(uint2 PixelCoord, float2 ScreenUV, float4 DefaultResult)
 {
     RTReprojectionData Data = (RTReprojectionData)0;
     
@@ -66,6 +69,12 @@ RTReprojectionData GetReprojectionData(uint2 PixelCoord, float2 ScreenUV)
         Data.PrevNormal = Data.CurrNormal;
     }
     
+    // the skipped tiles reuse the history as current result, or the cleared value for the sky
+    if (TileRate[PixelCoord / RT_TILE_SIZE] == RT_TILE_RATE_SKIP)
+    {
+        Data.CurrResult = (Data.CurrDepth == 0.0f) ? DefaultResult : Data.PrevResult;
+    }
+    
     return Data;
 }
 
@@ -81,7 +90,7 @@ void RTSkyReprojectionCS(uint3 DTid : SV_DispatchThreadID)
     float2 ScreenUV = (float2(PixelCoord) + 0.5f) / float2(Constants.Resolution);
     
     // fetch data
-    RTReprojectionData ReproData = GetReprojectionData(PixelCoord, ScreenUV);
+    RTReprojectionData ReproData = GetReprojectionData(PixelCoord, ScreenUV, 1.0f);
     
     float Confidence = max(ReproData.CurrResult.g, ReproData.PrevResult.g);
     float AlphaBright = Constants.AlphaMax;
@@ -132,7 +141,7 @@ void RTDiffuseReprojectionCS(uint3 DTid : SV_DispatchThreadID, uint3 GTid : SV_G
     float2 ScreenUV = (float2(PixelCoord) + 0.5f) / float2(Constants.Resolution);
     
     // fetch data
-    RTReprojectionData ReproData = GetReprojectionData(PixelCoord, ScreenUV);
+    RTReprojectionData ReproData = GetReprojectionData(PixelCoord, ScreenUV, 0.0f);
     GColorCache[GTid.x + GTid.y * UHTHREAD_GROUP2D_X] = ReproData.CurrResult.rgb;
     GroupMemoryBarrierWithGroupSync();
     
@@ -204,12 +204,8 @@ void SoftRTShadowCS(uint3 DTid : SV_DispatchThreadID)
     }
     
     // point lights
-    uint2 TileCoordinate = PixelCoord.xy * GResolution.xy * GShadowResolution.zw;
-    uint TileX = CoordToTileX(TileCoordinate.x);
-    uint TileY = CoordToTileY(TileCoordinate.y);
-    uint TileIndex = TileX + TileY * GLightTileCountX;
-    
-    uint ClosestPointLightIndex = GetClosestPointLightIndex(PointLightList, TileIndex, WorldPos);
+    uint ClusterIndex = GetClusterIndexFromWorldPos(WorldPos);
+    uint ClosestPointLightIndex = GetClosestPointLightIndex(PointLightList, ClusterIndex, WorldPos);
     UHBRANCH
     if (ClosestPointLightIndex != ~0 && SoftShadowCount < GMaxSoftShadowLightsPerPixel)
     {
@@ -219,7 +215,7 @@ void SoftRTShadowCS(uint3 DTid : SV_DispatchThreadID)
     }
     
     // spot lights
-    uint ClosestSpotLightIndex = GetClosestSpotLightIndex(SpotLightList, TileIndex, WorldPos);
+    uint ClosestSpotLightIndex = GetClosestSpotLightIndex(SpotLightList, ClusterIndex, WorldPos);
     UHBRANCH
     if (ClosestSpotLightIndex != ~0 && SoftShadowCount < GMaxSoftShadowLightsPerPixel)
     {
@@ -0,0 +1,306 @@
+// adaptive RT tile classification, each group is a screen tile at the trace resolution of a RT pass
+// the tile is appended to the full or quarter rate list, and the RT pass traces the lists with indirect args
+#define UHDIRLIGHT_BIND t9
+#include "../UHInputs.hlsli"
+#include "../UHCommon.hlsli"
+#include "UHRTCommon.hlsli"
+#include "UHRTTileCommon.hlsli"
+
+RWStructuredBuffer<uint> TileList : register(u1);
+// full and quarter rate VkTraceRaysIndirectCommandKHR, cleared to 0 before dispatch
+RWByteAddressBuffer RayArgs : register(u2);
+Texture2D MotionTexture : register(t4);
+SamplerState PointClampped : register(s5);
+// indirect light only, the reprojection reuses the history for the skipped tiles
+RWTexture2D<uint> TileRateOutput : register(u6);
+
+// shadow and reflection only, the tiles with valid cached results keep the output of last frame
+Texture2D HistoryDepthTexture : register(t7);
+
+// world boxes that invalidate the cached results they touch, sync with UHRTCacheInvalidation in C++
+#define RT_CACHE_INVALIDATE_RENDERER 1
+struct UHRTCacheInvalidation
+{
+    float3 Center;
+    uint Flags;
+    float3 Extents;
+    float Padding;
+};
+StructuredBuffer<UHRTCacheInvalidation> CacheInvalidations : register(t8);
+
+// the cached result is only reused for an unchanged view, the depth tolerance absorbs the jitter
+static const float GRTCacheMaxMotion = 1e-6f;
+static const float GRTCacheDepthTolerance = 0.01f;
+
+struct RTTileClassifyConstants
+{
+    uint2 TraceResolution;
+    uint PixelStride;
+    uint MaxTileCount;
+
+    float QuarterRateSmoothness;
+    float DepthEdgeThreshold;
+    float StableMotionThreshold;
+    uint RefreshInterval;
+
+    // number of invalidation boxes, and whether the output of last frame can be reused at all
+    uint CacheInvalidationCount;
+    uint bCacheValid;
+    uint bShadowQuarterRate;
+};
+[[vk::push_constant]] RTTileClassifyConstants Constants;
+
+// the values are positive floats, so they're compared as uint
+groupshared uint GHasGeometry;
+groupshared uint GHasSky;
+groupshared uint GMinDepth;
+groupshared uint GMaxDepth;
+groupshared uint GMaxSmoothness;
+groupshared uint GMaxMotion;
+groupshared uint GHistoryInvalid;
+groupshared uint GCacheInvalid;
+
+void WriteRayArgs(uint2 Gid, uint GIndex)
+{
+    // the counts are accumulated by all groups, the first group fills the rest
+    if (all(Gid == 0) && GIndex == 0)
+    {
+        RayArgs.Store(RT_FULL_RATE_ARGS, RT_FULL_RATE_RAYS);
+        RayArgs.Store(RT_FULL_RATE_ARGS + 8, 1);
+        RayArgs.Store(RT_FULL_RATE_ARGS + 12, 0);
+        RayArgs.Store(RT_QUARTER_RATE_ARGS, RT_QUARTER_RATE_RAYS);
+        RayArgs.Store(RT_QUARTER_RATE_ARGS + 8, 1);
+        RayArgs.Store(RT_QUARTER_RATE_ARGS + 12, Constants.MaxTileCount);
+    }
+}
+
+void GatherTileData(uint2 DTid, uint GIndex)
+{
+    if (GIndex == 0)
+    {
+        GHasGeometry = 0;
+        GHasSky = 0;
+        GMinDepth = asuint(UH_FLOAT_MAX);
+        GMaxDepth = 0;
+        GMaxSmoothness = 0;
+        GMaxMotion = 0;
+        GHistoryInvalid = 0;
+        GCacheInvalid = 0;
+    }
+    GroupMemoryBarrierWithGroupSync();
+
+    if (all(DTid < Constants.TraceResolution))
+    {
+        uint2 PixelCoord = DTid * Constants.PixelStride;
+        float2 UV = (float2(PixelCoord) + 0.5f) * GResolution.zw;
+
+        // the same test as the ray generation
+        float4 OpaqueBump = SceneBuffers[1].SampleLevel(PointClampped, UV, 0);
+        if (OpaqueBump.a > 0)
+        {
+            float Depth = SceneBuffers[3].SampleLevel(PointClampped, UV, 0).r;
+            float Smoothness = SceneBuffers[2].SampleLevel(PointClampped, UV, 0).a;
+            float2 Motion = MotionTexture.SampleLevel(PointClampped, UV, 0).rg;
+
+            InterlockedOr(GHasGeometry, 1);
+            InterlockedMin(GMinDepth, asuint(Depth));
+            InterlockedMax(GMaxDepth, asuint(Depth));
+            InterlockedMax(GMaxSmoothness, asuint(saturate(Smoothness)));
+            InterlockedMax(GMaxMotion, asuint(length(Motion)));
+
+            if (!IsUVInsideScreen(UV - Motion))
+            {
+                InterlockedOr(GHistoryInvalid, 1);
+            }
+        }
+        else
+        {
+            InterlockedOr(GHasSky, 1);
+        }
+    }
+    GroupMemoryBarrierWithGroupSync();
+}
+
+// segment and box intersection with the slab method
+bool IsSegmentHitBox(float3 Origin, float3 Dir, float Length, float3 BoxCenter, float3 BoxExtents)
+{
+    float3 InvDir = 1.0f / Dir;
+    float3 T0 = (BoxCenter - BoxExtents - Origin) * InvDir;
+    float3 T1 = (BoxCenter + BoxExtents - Origin) * InvDir;
+    float3 TMin = min(T0, T1);
+    float3 TMax = max(T0, T1);
+
+    float TEnter = max(max(TMin.x, TMin.y), max(TMin.z, 0.0f));
+    float TExit = min(min(TMax.x, TMax.y), min(TMax.z, Length));
+    return TEnter <= TExit;
+}
+
+bool IsPointInBox(float3 Point, float3 BoxCenter, float3 BoxExtents)
+{
+    return all(abs(Point - BoxCenter) <= BoxExtents);
+}
+
+// a pixel keeps its cached result when the view and the surface are unchanged, and no invalidation box touches its rays
+// shadow tests the directional light rays against the renderer boxes, and the pixel against the light range boxes
+// reflection tests the reflection ray against all boxes
+void GatherCacheValidity(uint2 DTid, bool bShadowRays)
+{
+    if (Constants.bCacheValid != 0 && all(DTid < Constants.TraceResolution))
+    {
+        uint2 PixelCoord = DTid * Constants.PixelStride;
+        float2 UV = (float2(PixelCoord) + 0.5f) * GResolution.zw;
+
+        float Depth = SceneBuffers[3].SampleLevel(PointClampped, UV, 0).r;
+        float HistoryDepth = HistoryDepthTexture.SampleLevel(PointClampped, UV, 0).r;
+        bool bInvalid = abs(Depth - HistoryDepth) > max(Depth, HistoryDepth) * GRTCacheDepthTolerance;
+
+        // sky pixels are not traced, the matching history depth is enough
+        UHBRANCH
+        if (!bInvalid && Depth > 0)
+        {
+            float2 Motion = MotionTexture.SampleLevel(PointClampped, UV, 0).rg;
+            bInvalid = length(Motion) > GRTCacheMaxMotion;
+
+            float3 WorldPos = ComputeWorldPositionFromDeviceZ_UV(UV, Depth, true);
+            float3 WorldNormal = DecodeNormal(SceneBuffers[1].SampleLevel(PointClampped, UV, 0).xyz);
+            float3 ReflectDir = reflect(normalize(WorldPos - GCameraPos), WorldNormal);
+
+            for (uint Idx = 0; Idx < Constants.CacheInvalidationCount && !bInvalid; Idx++)
+            {
+                UHRTCacheInvalidation Box = CacheInvalidations[Idx];
+                if (!bShadowRays)
+                {
+                    bInvalid = IsSegmentHitBox(WorldPos, ReflectDir, GRTReflectionRayTMax, Box.Center, Box.Extents);
+                    continue;
+                }
+
+                bInvalid = IsPointInBox(WorldPos, Box.Center, Box.Extents);
+                if (Box.Flags & RT_CACHE_INVALIDATE_RENDERER)
+                {
+                    for (uint Ldx = 0; Ldx < min(GNumDirLights, GRTMaxDirLight) && !bInvalid; Ldx++)
+                    {
+                        UHDirectionalLight DirLight = UHDirLights[Ldx];
+                        bInvalid = DirLight.bIsEnabled && IsSegmentHitBox(WorldPos, -DirLight.Dir, GDirectionalShadowRayTMax, Box.Center, Box.Extents);
+                    }
+                }
+            }
+        }
+
+        if (bInvalid)
+        {
+            InterlockedOr(GCacheInvalid, 1);
+        }
+    }
+    GroupMemoryBarrierWithGroupSync();
+}
+
+bool IsTileCached()
+{
+    return Constants.bCacheValid != 0 && GCacheInvalid == 0;
+}
+
+bool IsDepthEdge()
+{
+    // a tile mixed with the sky is an edge too, a quad shouldn't spread its result to the sky
+    if (GHasSky != 0)
+    {
+        return true;
+    }
+
+    // reversed-z, the relative range doesn't change with distance
+    float MinDepth = asfloat(GMinDepth);
+    float MaxDepth = asfloat(GMaxDepth);
+    return (MaxDepth - MinDepth) > MaxDepth * Constants.DepthEdgeThreshold;
+}
+
+void AppendTile(uint2 Tile, uint Rate)
+{
+    uint ArgsOffset = (Rate == RT_TILE_RATE_QUARTER) ? RT_QUARTER_RATE_ARGS : RT_FULL_RATE_ARGS;
+    uint ListOffset = (Rate == RT_TILE_RATE_QUARTER) ? Constants.MaxTileCount : 0;
+
+    // height of the trace args is the tile count
+    uint TileIndex;
+    RayArgs.InterlockedAdd(ArgsOffset + 4, 1, TileIndex);
+    TileList[ListOffset + TileIndex] = PackRTTile(Tile);
+}
+
+[numthreads(RT_TILE_SIZE, RT_TILE_SIZE, 1)]
+void RTReflectionTileClassifyCS(uint3 DTid : SV_DispatchThreadID, uint3 Gid : SV_GroupID, uint GIndex : SV_GroupIndex)
+{
+    WriteRayArgs(Gid.xy, GIndex);
+    GatherTileData(DTid.xy, GIndex);
+    GatherCacheValidity(DTid.xy, false);
+    if (GIndex != 0 || IsTileCached())
+    {
+        return;
+    }
+
+    // pixels below the cutoff aren't traced, so is the tile when none of them is smooth enough
+    // the output isn't cleared when the cache is valid, such tiles are still listed so the ray generation clears them
+    float MaxSmoothness = asfloat(GMaxSmoothness);
+    if (GHasGeometry == 0 || MaxSmoothness <= GRTReflectionSmoothCutoff)
+    {
+        if (Constants.bCacheValid != 0)
+        {
+            AppendTile(Gid.xy, RT_TILE_RATE_QUARTER);
+        }
+        return;
+    }
+
+    // rough reflections are blurred by the mips anyway, while edges keep the full rate
+    bool bQuarterRate = MaxSmoothness < Constants.QuarterRateSmoothness && !IsDepthEdge();
+    AppendTile(Gid.xy, bQuarterRate ? RT_TILE_RATE_QUARTER : RT_TILE_RATE_FULL);
+}
+
+[numthreads(RT_TILE_SIZE, RT_TILE_SIZE, 1)]
+void RTIndirectTileClassifyCS(uint3 DTid : SV_DispatchThreadID, uint3 Gid : SV_GroupID, uint GIndex : SV_GroupIndex)
+{
+    WriteRayArgs(Gid.xy, GIndex);
+    GatherTileData(DTid.xy, GIndex);
+    if (GIndex != 0)
+    {
+        return;
+    }
+
+    // sky tiles aren't traced, the reprojection outputs the cleared values
+    uint Rate = RT_TILE_RATE_FULL;
+    if (GHasGeometry == 0)
+    {
+        Rate = RT_TILE_RATE_SKIP;
+    }
+    else if (Constants.RefreshInterval > 0 && GHistoryInvalid == 0 && !IsDepthEdge() && asfloat(GMaxMotion) <= Constants.StableMotionThreshold)
+    {
+        // the history is reliable, trace at quarter rate once per interval and reuse the history in other frames
+        // the refresh frame is staggered across tiles, so the cost of every frame is even
+        uint RefreshPhase = (Gid.x * 7 + Gid.y * 13 + GFrameNumber) % Constants.RefreshInterval;
+        Rate = (RefreshPhase == 0) ? RT_TILE_RATE_QUARTER : RT_TILE_RATE_SKIP;
+    }
+
+    TileRateOutput[Gid.xy] = Rate;
+    if (Rate != RT_TILE_RATE_SKIP)
+    {
+        AppendTile(Gid.xy, Rate);
+    }
+}
+
+[numthreads(RT_TILE_SIZE, RT_TILE_SIZE, 1)]
+void RTShadowTileClassifyCS(uint3 DTid : SV_DispatchThreadID, uint3 Gid : SV_GroupID, uint GIndex : SV_GroupIndex)
+{
+    WriteRayArgs(Gid.xy, GIndex);
+    GatherTileData(DTid.xy, GIndex);
+    GatherCacheValidity(DTid.xy, true);
+    if (GIndex != 0)
+    {
+        return;
+    }
+
+    // the tiles with valid cached results are skipped
+    if (IsTileCached())
+    {
+        return;
+    }
+
+    // shadows have no temporal filter, so only the flat tiles are lowered under pressure and the soft shadow pass blurs the quads
+    bool bQuarterRate = Constants.bShadowQuarterRate != 0 && GHasGeometry != 0 && !IsDepthEdge();
+    AppendTile(Gid.xy, bQuarterRate ? RT_TILE_RATE_QUARTER : RT_TILE_RATE_FULL);
+}
@@ -1,6 +1,7 @@
 #include "../Shaders/UHInputs.hlsli"
 #include "../Shaders/UHCommon.hlsli"
 #include "../Shaders/UHMaterialCommon.hlsli"
+#include "../Shaders/UHMeshShaderCommon.hlsli"
 #include "../Shaders/RayTracing/UHRTCommon.hlsli"
 
 // TLAS
@@ -15,21 +16,23 @@ SamplerState UHSamplerTable[] : register(t0, space2);
 StructuredBuffer<UHRendererInstance> UHRendererInstances : register(t0, space3);
 
 // VB & IB data, access them with UHRendererInstance.MeshIndex
-StructuredBuffer<float2> UHUV0Table[] : register(t0, space4);
-StructuredBuffer<float3> UHNormalTable[] : register(t0, space5);
-StructuredBuffer<float4> UHTangentTable[] : register(t0, space6);
+ByteAddressBuffer UHUV0Table[] : register(t0, space4);
+ByteAddressBuffer UHNormalTable[] : register(t0, space5);
+ByteAddressBuffer UHTangentTable[] : register(t0, space6);
 ByteAddressBuffer UHIndicesTable[] : register(t0, space7);
 
-#define SAFE_INSTANCE_ID NonUniformResourceIndex(InstanceID())
-#define SAFE_INSTANCE_INDEX NonUniformResourceIndex(InstanceIndex())
+// TLAS instances are compacted on C++ side, so InstanceIndex() isn't the renderer index anymore
+// the renderer index is stored as custom index instead, and material index is fetched from renderer instance
+#define SAFE_INSTANCE_INDEX NonUniformResourceIndex(InstanceID())
+#define SAFE_MATERIAL_INDEX UHRendererInstances[SAFE_INSTANCE_INDEX].MaterialIndex
 
-// another descriptor array for matching, since Vulkan doesn't implement local descriptor yet, I need this to fetch data
-// access via SAFE_INSTANCE_ID[0] first, the data will be filled by the systtem on C++ side
+// material data arena for matching, since Vulkan doesn't implement local descriptor yet, I need this to fetch data
+// access via SAFE_MATERIAL_INDEX, the data will be filled by the material arena on C++ side
 struct MaterialData
 {
     uint Data[RT_MATERIALDATA_SLOT];
 };
-StructuredBuffer<MaterialData> UHMaterialDataTable[] : register(t0, space8);
+StructuredBuffer<MaterialData> UHMaterialDataTable : register(t0, space8);
 
 // hit group shader, shared used for all RT shaders
 // attribute structure for feteching mesh data
@@ -57,7 +60,7 @@ void UnpackMaterialData(MaterialData MatData, inout MaterialUsage Usages)
 // get material input, the simple version that has opacity only
 UHMaterialInputs GetMaterialOpacity(float2 UV0, float MipLevel, out MaterialUsage Usages)
 {
-    MaterialData MatData = UHMaterialDataTable[SAFE_INSTANCE_ID][0];
+    MaterialData MatData = UHMaterialDataTable[SAFE_MATERIAL_INDEX];
     UnpackMaterialData(MatData, Usages);
 	
 	// TextureIndexStart in TextureNode.cpp decides where the first index of texture will start in MaterialData.Data[]
@@ -69,7 +72,7 @@ UHMaterialInputs GetMaterialOpacity(float2 UV0, float MipLevel, out MaterialUsag
 // get only the bump normal from the material
 UHMaterialInputs GetMaterialBumpNormal(float2 UV0, float MipLevel, out MaterialUsage Usages)
 {
-    MaterialData MatData = UHMaterialDataTable[SAFE_INSTANCE_ID][0];
+    MaterialData MatData = UHMaterialDataTable[SAFE_MATERIAL_INDEX];
     UnpackMaterialData(MatData, Usages);
     
     // material input code will be generated in C++ side
@@ -79,7 +82,7 @@ UHMaterialInputs GetMaterialBumpNormal(float2 UV0, float MipLevel, out MaterialU
 // get material input fully
 UHMaterialInputs GetMaterialInput(float2 UV0, float MipLevel, out MaterialUsage Usages)
 {
-    MaterialData MatData = UHMaterialDataTable[SAFE_INSTANCE_ID][0];
+    MaterialData MatData = UHMaterialDataTable[SAFE_MATERIAL_INDEX];
     UnpackMaterialData(MatData, Usages);
     
     // material input code will be generated in C++ side
@@ -88,7 +91,7 @@ UHMaterialInputs GetMaterialInput(float2 UV0, float MipLevel, out MaterialUsage
 
 UHMaterialInputs GetMaterialSmoothness(float2 UV0, float MipLevel, out MaterialUsage Usages)
 {
-    MaterialData MatData = UHMaterialDataTable[SAFE_INSTANCE_ID][0];
+    MaterialData MatData = UHMaterialDataTable[SAFE_MATERIAL_INDEX];
     UnpackMaterialData(MatData, Usages);
     
     // material input code will be generated in C++ side
@@ -139,12 +142,16 @@ float2 GetHitUV0(uint3 PrimIndices, Attribute Attr)
 {
     UHRendererInstance RendererInstances = UHRendererInstances[SAFE_INSTANCE_INDEX];
 
-    StructuredBuffer<float2> UV0 = UHUV0Table[RendererInstances.MeshIndex];
+    ByteAddressBuffer UV0Buffer = UHUV0Table[RendererInstances.MeshIndex];
+    float2 UV0[3];
+    UV0[0] = LoadVertexUV0(UV0Buffer, PrimIndices[0]);
+    UV0[1] = LoadVertexUV0(UV0Buffer, PrimIndices[1]);
+    UV0[2] = LoadVertexUV0(UV0Buffer, PrimIndices[2]);
 	float2 OutUV = 0;
 
 	// interpolate data according to barycentric coordinate
-    OutUV = UV0[PrimIndices[0]] + Attr.Bary.x * (UV0[PrimIndices[1]] - UV0[PrimIndices[0]])
-		+ Attr.Bary.y * (UV0[PrimIndices[2]] - UV0[PrimIndices[0]]);
+    OutUV = UV0[0] + Attr.Bary.x * (UV0[1] - UV0[0])
+		+ Attr.Bary.y * (UV0[2] - UV0[0]);
 
 	return OutUV;
 }
@@ -153,11 +160,15 @@ float3 GetHitVertexNormal(uint3 PrimIndices, Attribute Attr)
 {
     UHRendererInstance RendererInstances = UHRendererInstances[SAFE_INSTANCE_INDEX];
     
-    StructuredBuffer<float3> Normal = UHNormalTable[RendererInstances.MeshIndex];
+    ByteAddressBuffer NormalBuffer = UHNormalTable[RendererInstances.MeshIndex];
+    float3 Normal[3];
+    Normal[0] = LoadVertexNormal(NormalBuffer, PrimIndices[0]);
+    Normal[1] = LoadVertexNormal(NormalBuffer, PrimIndices[1]);
+    Normal[2] = LoadVertexNormal(NormalBuffer, PrimIndices[2]);
     float3 OutNormal = float3(0, 0, 1);
     
-    OutNormal = Normal[PrimIndices[0]] + Attr.Bary.x * (Normal[PrimIndices[1]] - Normal[PrimIndices[0]])
-		+ Attr.Bary.y * (Normal[PrimIndices[2]] - Normal[PrimIndices[0]]);
+    OutNormal = Normal[0] + Attr.Bary.x * (Normal[1] - Normal[0])
+		+ Attr.Bary.y * (Normal[2] - Normal[0]);
     
     return OutNormal;
 }
@@ -166,11 +177,15 @@ float4 GetHitTangent(uint3 PrimIndices, Attribute Attr)
 {
     UHRendererInstance RendererInstances = UHRendererInstances[SAFE_INSTANCE_INDEX];
     
-    StructuredBuffer<float4> Tangent = UHTangentTable[RendererInstances.MeshIndex];
+    ByteAddressBuffer TangentBuffer = UHTangentTable[RendererInstances.MeshIndex];
+    float4 Tangent[3];
+    Tangent[0] = LoadVertexTangent(TangentBuffer, PrimIndices[0]);
+    Tangent[1] = LoadVertexTangent(TangentBuffer, PrimIndices[1]);
+    Tangent[2] = LoadVertexTangent(TangentBuffer, PrimIndices[2]);
     float4 OutTangent = float4(1, 0, 0, 1);
     
-    OutTangent = Tangent[PrimIndices[0]] + Attr.Bary.x * (Tangent[PrimIndices[1]] - Tangent[PrimIndices[0]])
-		+ Attr.Bary.y * (Tangent[PrimIndices[2]] - Tangent[PrimIndices[0]]);
+    OutTangent = Tangent[0] + Attr.Bary.x * (Tangent[1] - Tangent[0])
+		+ Attr.Bary.y * (Tangent[2] - Tangent[0]);
     
     return OutTangent;
 }
@@ -181,7 +196,8 @@ float3 CalculateBumpNormal(float3 InBump, float3 VertexNormal, in Attribute Attr
     
     // tangent to world space
     float4 VertexTangent = GetHitTangent(PrimIndices, Attr);
-    VertexTangent.xyz = mul(VertexTangent.xyz, (float3x3) ObjectToWorld3x4());
+    // normalize since the object to world could contain the position decode scale
+    VertexTangent.xyz = normalize(mul(VertexTangent.xyz, (float3x3) ObjectToWorld3x4()));
             
     float3 Binormal = cross(VertexNormal, VertexTangent.xyz) * VertexTangent.w;
             
@@ -195,7 +211,7 @@ float3 CalculateBumpNormal(float3 InBump, float3 VertexNormal, in Attribute Attr
 
 void CalculateMaterial(inout UHDefaultPayload Payload, float3 WorldPos, in Attribute Attr, bool bMergeDiffuseEmissive = false)
 {    
-    MaterialData MatData = UHMaterialDataTable[SAFE_INSTANCE_ID][0];
+    MaterialData MatData = UHMaterialDataTable[SAFE_MATERIAL_INDEX];
     bool bIsOpaque = MatData.Data[1] <= UH_ISMASKED;
 	
 	// fetch material data
@@ -302,7 +318,7 @@ void RTDefaultClosestHit(inout UHDefaultPayload Payload, in Attribute Attr)
     }
     
     // set hit T, instance index and hit alpha
-    Payload.HitInstanceIndex = InstanceIndex();
+    Payload.HitInstanceIndex = InstanceID();
     Payload.HitAlpha = 1.0f;
 
     bool bIsReflection = (Payload.PayloadData & PAYLOAD_ISREFLECTION) > 0;
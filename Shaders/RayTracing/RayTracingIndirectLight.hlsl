@@ -4,9 +4,12 @@
 #define UHPOINTLIGHT_BIND t7
 #define UHSPOTLIGHT_BIND t8
 #define SH9_BIND t9
+#define RTTILE_LIST_BIND t21
+#define RTTILE_ARGS_BIND t22
 #include "../UHInputs.hlsli"
 #include "../UHSphericalHamonricCommon.hlsli"
 #include "UHRTCommon.hlsli"
+#include "UHRTTileCommon.hlsli"
 #include "../UHLightCommon.hlsli"
 #include "../UHMaterialCommon.hlsli"
 
@@ -215,9 +218,7 @@ float3 CalculateIndirectLighting(in UHDefaultPayload OldPayload
     // light calculation, be sure to normalize normal vector before using it
     // the specular part can also be ignored as that's not necessary for indirect diffuse
     uint2 HitPixelCoord = uint2(HitScreenUV * GResolution.xy);
-    uint TileX = CoordToTileX(HitPixelCoord.x);
-    uint TileY = CoordToTileY(HitPixelCoord.y);
-    uint TileIndex = TileX + TileY * GLightTileCountX;
+    uint ClusterIndex = GetClusterIndexFromWorldPos(HitWorldPos);
     
     UHLightInfo IndirectLightInfo;
     IndirectLightInfo.Diffuse = OldPayload.HitDiffuse.rgb;
@@ -255,18 +256,18 @@ float3 CalculateIndirectLighting(in UHDefaultPayload OldPayload
     // point indirect light
     if (GNumPointLights > 0)
     {
-        uint TileOffset = GetPointLightOffset(TileIndex);
-        uint PointLightCount = PointLightList.Load(TileOffset);
-        TileOffset += 4;
+        uint ListOffset = GetLightListOffset(PointLightList, ClusterIndex);
+        uint PointLightCount = PointLightList.Load(ListOffset);
+        ListOffset += 4;
         
-        // fetch tiled point light if the hit point is inside screen, otherwise need to lookup from instance lights
+        // fetch clustered point light if the hit point is inside screen, otherwise need to lookup from instance lights
         UHBRANCH
         if (bIsInsideScreen && PointLightCount > 0)
         {
             for (uint Ldx = 0; Ldx < PointLightCount; Ldx++)
             {
-                uint PointLightIdx = PointLightList.Load(TileOffset);
-                TileOffset += 4;
+                uint PointLightIdx = PointLightList.Load(ListOffset);
+                ListOffset += 4;
        
                 UHPointLight PointLight = UHPointLights[PointLightIdx];
                 UHBRANCH
@@ -312,17 +313,17 @@ float3 CalculateIndirectLighting(in UHDefaultPayload OldPayload
     // spot indirect light
     if (GNumSpotLights > 0)
     {
-        uint TileOffset = GetSpotLightOffset(TileIndex);
-        uint SpotLightCount = SpotLightList.Load(TileOffset);
-        TileOffset += 4;
+        uint ListOffset = GetLightListOffset(SpotLightList, ClusterIndex);
+        uint SpotLightCount = SpotLightList.Load(ListOffset);
+        ListOffset += 4;
         
         UHBRANCH
         if (bIsInsideScreen && SpotLightCount > 0)
         {
             for (uint Ldx = 0; Ldx < SpotLightCount; Ldx++)
             {
-                uint SpotLightIdx = SpotLightList.Load(TileOffset);
-                TileOffset += 4;
+                uint SpotLightIdx = SpotLightList.Load(ListOffset);
+                ListOffset += 4;
         
                 UHSpotLight SpotLight = UHSpotLights[SpotLightIdx];
                 UHBRANCH
@@ -377,9 +378,17 @@ float3 CalculateIndirectLighting(in UHDefaultPayload OldPayload
 [shader("raygeneration")]
 void RTIndirectLightRayGen()
 {
-    uint2 OutputCoord = DispatchRaysIndex().xy;
-    OutDiffuse[OutputCoord] = 0;
-    OutSkyData[OutputCoord] = 1;
+    // rays are dispatched per classified tile, stable tiles are traced at quarter rate
+    uint2 TraceResolution = uint2(GResolution.xy) / GIndirectDownsampleFactor;
+    uint2 OutputCoord;
+    uint2 QuadOrigin;
+    bool bQuarterRate;
+    if (!GetRTTileCoord(TraceResolution, OutputCoord, QuadOrigin, bQuarterRate))
+    {
+        return;
+    }
+    WriteRTTileResult(OutDiffuse, QuadOrigin, bQuarterRate, TraceResolution, 1, 0);
+    WriteRTTileResult(OutSkyData, QuadOrigin, bQuarterRate, TraceResolution, 1, 1);
     
     uint2 PixelCoord = OutputCoord * GIndirectDownsampleFactor;
     float2 ScreenUV = float2(PixelCoord + 0.5f) * GResolution.zw;
@@ -422,7 +431,8 @@ void RTIndirectLightRayGen()
     float3 Result = 0;
    
     // ------------ the first phase - trace sky visibility
-    OutSkyData[OutputCoord] = TraceSkyVisibility(OutputCoord, SceneWorldPos, SceneNormal, ScreenUV, RayGap);
+    float2 SkyVisibility = TraceSkyVisibility(OutputCoord, SceneWorldPos, SceneNormal, ScreenUV, RayGap);
+    WriteRTTileResult(OutSkyData, QuadOrigin, bQuarterRate, TraceResolution, 1, SkyVisibility);
     
     // debugging
     if (false)
@@ -468,7 +478,7 @@ void RTIndirectLightRayGen()
                     , HitWorldPos, Smoothness, MipLevel, RayGap, OutputCoord);
         }
         
-        OutDiffuse[OutputCoord] = float4(Result, 1.0f);
+        WriteRTTileResult(OutDiffuse, QuadOrigin, bQuarterRate, TraceResolution, 1, float4(Result, 1.0f));
     }
 }
 
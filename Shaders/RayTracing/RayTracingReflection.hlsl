@@ -4,8 +4,11 @@
 #define UHPOINTLIGHT_BIND t5
 #define UHSPOTLIGHT_BIND t6
 #define SH9_BIND t7
+#define RTTILE_LIST_BIND t18
+#define RTTILE_ARGS_BIND t19
 #include "../UHInputs.hlsli"
 #include "UHRTCommon.hlsli"
+#include "UHRTTileCommon.hlsli"
 #include "../UHLightCommon.hlsli"
 #include "../UHMaterialCommon.hlsli"
 #include "../UHSphericalHamonricCommon.hlsli"
@@ -35,21 +38,21 @@ SamplerState LinearClampped : register(s17);
 static const float GShadowRayGap = 0.01f;
 static const float GMaxEnv = 100.0f;
 
-void ConditionalCalculatePointLight(uint TileIndex, in UHDefaultPayload Payload, UHLightInfo LightInfo
+void ConditionalCalculatePointLight(uint ClusterIndex, in UHDefaultPayload Payload, UHLightInfo LightInfo
     , float MipLevel, bool bIsInsideScreen, inout float3 Result)
 {
-    // fetch tiled point light
-    uint TileOffset = GetPointLightOffset(TileIndex);
-    uint PointLightCount = PointLightList.Load(TileOffset);
-    TileOffset += 4;
+    // fetch clustered point light
+    uint ListOffset = GetLightListOffset(PointLightList, ClusterIndex);
+    uint PointLightCount = PointLightList.Load(ListOffset);
+    ListOffset += 4;
     
     UHBRANCH
     if (bIsInsideScreen && PointLightCount > 0)
     {
         for (uint Ldx = 0; Ldx < PointLightCount; Ldx++)
         {
-            uint PointLightIdx = PointLightList.Load(TileOffset);
-            TileOffset += 4;
+            uint PointLightIdx = PointLightList.Load(ListOffset);
+            ListOffset += 4;
        
             UHPointLight PointLight = UHPointLights[PointLightIdx];
             UHBRANCH
@@ -90,21 +93,21 @@ void ConditionalCalculatePointLight(uint TileIndex, in UHDefaultPayload Payload,
     }
 }
 
-void ConditionalCalculateSpotLight(uint TileIndex, in UHDefaultPayload Payload, UHLightInfo LightInfo
+void ConditionalCalculateSpotLight(uint ClusterIndex, in UHDefaultPayload Payload, UHLightInfo LightInfo
     , float MipLevel, bool bIsInsideScreen, inout float3 Result)
 {
-    // fetch tiled spot light
-    uint TileOffset = GetSpotLightOffset(TileIndex);
-    uint SpotLightCount = SpotLightList.Load(TileOffset);
-    TileOffset += 4;
+    // fetch clustered spot light
+    uint ListOffset = GetLightListOffset(SpotLightList, ClusterIndex);
+    uint SpotLightCount = SpotLightList.Load(ListOffset);
+    ListOffset += 4;
     
     UHBRANCH
     if (bIsInsideScreen && SpotLightCount > 0)
     {        
         for (uint Ldx = 0; Ldx < SpotLightCount; Ldx++)
         {
-            uint SpotLightIdx = SpotLightList.Load(TileOffset);
-            TileOffset += 4;
+            uint SpotLightIdx = SpotLightList.Load(ListOffset);
+            ListOffset += 4;
         
             UHSpotLight SpotLight = UHSpotLights[SpotLightIdx];
             UHBRANCH
@@ -213,12 +216,10 @@ float4 CalculateReflectionLighting(in UHDefaultPayload Payload
         }
     }
     
-    // for point lights and spot lights, fetch from tile-based light if it's inside screen
-    // otherwise, fetch from the closest lights to current camera for now
+    // for point lights and spot lights, fetch from the cluster of hit position if it's inside screen
+    // otherwise, fetch from the instance lights
     uint2 PixelCoord = uint2(HitScreenUV * GResolution.xy);
-    uint TileX = CoordToTileX(PixelCoord.x);
-    uint TileY = CoordToTileY(PixelCoord.y);
-    uint TileIndex = TileX + TileY * GLightTileCountX;
+    uint ClusterIndex = GetClusterIndexFromWorldPos(LightInfo.WorldPos);
     
     // noise setup for color banding
     LightInfo.AttenNoise = GetAttenuationNoise(PixelCoord.xy) * 0.1f;
@@ -246,13 +247,13 @@ float4 CalculateReflectionLighting(in UHDefaultPayload Payload
     // point lights
     if (GNumPointLights > 0)
     {
-        ConditionalCalculatePointLight(TileIndex, Payload, LightInfo, MipLevel, bInsideScreen, Result);
+        ConditionalCalculatePointLight(ClusterIndex, Payload, LightInfo, MipLevel, bInsideScreen, Result);
     }
     
     // spot lights
     if (GNumSpotLights > 0)
     {
-        ConditionalCalculateSpotLight(TileIndex, Payload, LightInfo, MipLevel, bInsideScreen, Result);
+        ConditionalCalculateSpotLight(ClusterIndex, Payload, LightInfo, MipLevel, bInsideScreen, Result);
     }
     
     // indirect light and emissive
@@ -295,12 +296,21 @@ float4 CalculateReflectionLighting(in UHDefaultPayload Payload
 void RTReflectionRayGen()
 {
     bool bHalfQuality = GRTReflectionQuality == 1;
+    uint PixelStride = bHalfQuality ? 2 : 1;
+    uint2 TraceResolution = uint2(GResolution.xy) / PixelStride;
     
-    uint2 PixelCoord = DispatchRaysIndex().xy;
-    if (bHalfQuality)
+    // rays are dispatched per classified tile, rough tiles are traced at quarter rate
+    uint2 TraceCoord;
+    uint2 QuadOrigin;
+    bool bQuarterRate;
+    if (!GetRTTileCoord(TraceResolution, TraceCoord, QuadOrigin, bQuarterRate))
     {
-        PixelCoord *= 2;
+        return;
     }
+
+    // the output isn't cleared when the cached results are reused, clear the listed tiles instead
+    WriteRTTileResult(OutResult, QuadOrigin, bQuarterRate, TraceResolution, PixelStride, 0);
+    uint2 PixelCoord = TraceCoord * PixelStride;
     
     // To UV
     float2 ScreenUV = (PixelCoord + 0.5f) * GResolution.zw;
@@ -380,7 +390,8 @@ void RTReflectionRayGen()
     if (Payload.IsHit())
     {
         float3 HitWorldPos = ReflectRay.Origin + ReflectRay.Direction * Payload.HitT;
-        OutResult[PixelCoord] = CalculateReflectionLighting(Payload, HitWorldPos, MipLevel, ReflectRay.Direction);
+        float4 Result = CalculateReflectionLighting(Payload, HitWorldPos, MipLevel, ReflectRay.Direction);
+        WriteRTTileResult(OutResult, QuadOrigin, bQuarterRate, TraceResolution, PixelStride, Result);
     }
 }
 
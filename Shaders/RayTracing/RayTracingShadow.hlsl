@@ -21,12 +21,43 @@ Texture2D SceneMipTexture : register(t10);
 SamplerState PointClampped : register(s11);
 SamplerState LinearClampped : register(s12);
 
+#define RTTILE_LIST_BIND t13
+#define RTTILE_ARGS_BIND t14
+
 #include "../UHInputs.hlsli"
 #include "UHRTCommon.hlsli"
+#include "UHRTTileCommon.hlsli"
 #include "../UHLightCommon.hlsli"
 #include "../UHMaterialCommon.hlsli"
 
-void TraceShadow(uint2 PixelCoord, uint2 OutputCoord, float2 ScreenUV, float MipRate, float MipLevel)
+// at quarter rate, the traced pixel writes the whole quad
+void WriteShadowData(uint2 QuadOrigin, bool bQuarterRate, uint Slice, float2 Value)
+{
+    uint2 TraceResolution = uint2(GShadowResolution.xy);
+    for (uint Idx = 0; Idx < GetRTQuadPixelCount(bQuarterRate); Idx++)
+    {
+        uint2 Coord;
+        if (GetRTQuadPixel(QuadOrigin, Idx, TraceResolution, Coord))
+        {
+            OutShadowData[uint3(Coord, Slice)] = Value;
+        }
+    }
+}
+
+void WriteReceiveLightBits(uint2 QuadOrigin, bool bQuarterRate, uint Value)
+{
+    uint2 TraceResolution = uint2(GShadowResolution.xy);
+    for (uint Idx = 0; Idx < GetRTQuadPixelCount(bQuarterRate); Idx++)
+    {
+        uint2 Coord;
+        if (GetRTQuadPixel(QuadOrigin, Idx, TraceResolution, Coord))
+        {
+            OutReceiveLightBits[Coord] = Value;
+        }
+    }
+}
+
+void TraceShadow(uint2 PixelCoord, uint2 QuadOrigin, bool bQuarterRate, float2 ScreenUV, float MipRate, float MipLevel)
 {
     float SceneDepth = SceneBuffers[3].SampleLevel(PointClampped, ScreenUV, 0).r;
 
@@ -66,7 +97,7 @@ void TraceShadow(uint2 PixelCoord, uint2 OutputCoord, float2 ScreenUV, float Mip
             // output shadow to specific slice and set receive light bit
             if (SoftShadowCount < GMaxSoftShadowLightsPerPixel)
             {
-                OutShadowData[uint3(OutputCoord, SoftShadowCount++)] = float2(HitDist, Atten);
+                WriteShadowData(QuadOrigin, bQuarterRate, SoftShadowCount++, float2(HitDist, Atten));
             }
             
             ReceiveLightBit |= (Atten > 0.0f) ? 1u << TraceCount : 0;
@@ -75,19 +106,16 @@ void TraceShadow(uint2 PixelCoord, uint2 OutputCoord, float2 ScreenUV, float Mip
     }
     
 	// ------------------------------------------------------------------------------------------ Point Light Tracing
-    uint2 TileCoordinate = PixelCoord.xy;
-    uint TileX = CoordToTileX(TileCoordinate.x);
-    uint TileY = CoordToTileY(TileCoordinate.y);
-    uint TileIndex = TileX + TileY * GLightTileCountX;
-    uint TileOffset = GetPointLightOffset(TileIndex);
-    uint LightCount = PointLightList.Load(TileOffset);
-    TileOffset += 4;
+    uint ClusterIndex = GetClusterIndexFromWorldPos(WorldPos);
+    uint ListOffset = GetLightListOffset(PointLightList, ClusterIndex);
+    uint LightCount = PointLightList.Load(ListOffset);
+    ListOffset += 4;
 	
-    uint ClosestPointLightIndex = GetClosestPointLightIndex(PointLightList, TileIndex, WorldPos);
+    uint ClosestPointLightIndex = GetClosestPointLightIndex(PointLightList, ClusterIndex, WorldPos);
     for (Ldx = 0; Ldx < LightCount; Ldx++)
     {
-        uint PointLightIdx = PointLightList.Load(TileOffset);
-        TileOffset += 4;
+        uint PointLightIdx = PointLightList.Load(ListOffset);
+        ListOffset += 4;
 		
         UHPointLight PointLight = UHPointLights[PointLightIdx];
         UHBRANCH
@@ -100,7 +128,7 @@ void TraceShadow(uint2 PixelCoord, uint2 OutputCoord, float2 ScreenUV, float Mip
             // soft shadow for the closest point light 
             if (ClosestPointLightIndex == PointLightIdx && SoftShadowCount < GMaxSoftShadowLightsPerPixel)
             {
-                OutShadowData[uint3(OutputCoord, SoftShadowCount++)] = float2(HitDist, Atten);
+                WriteShadowData(QuadOrigin, bQuarterRate, SoftShadowCount++, float2(HitDist, Atten));
             }
             
             // accumulate atten and max dist
@@ -110,15 +138,15 @@ void TraceShadow(uint2 PixelCoord, uint2 OutputCoord, float2 ScreenUV, float Mip
     }
 	
 	// ------------------------------------------------------------------------------------------ Spot Light Tracing
-    TileOffset = GetSpotLightOffset(TileIndex);
-    LightCount = SpotLightList.Load(TileOffset);
-    TileOffset += 4;
+    ListOffset = GetLightListOffset(SpotLightList, ClusterIndex);
+    LightCount = SpotLightList.Load(ListOffset);
+    ListOffset += 4;
 	
-    uint ClosestSpotLightIndex = GetClosestSpotLightIndex(SpotLightList, TileIndex, WorldPos);
+    uint ClosestSpotLightIndex = GetClosestSpotLightIndex(SpotLightList, ClusterIndex, WorldPos);
     for (Ldx = 0; Ldx < LightCount; Ldx++)
     {
-        uint SpotLightIdx = SpotLightList.Load(TileOffset);
-        TileOffset += 4;
+        uint SpotLightIdx = SpotLightList.Load(ListOffset);
+        ListOffset += 4;
 		
         UHSpotLight SpotLight = UHSpotLights[SpotLightIdx];
         UHBRANCH
@@ -131,7 +159,7 @@ void TraceShadow(uint2 PixelCoord, uint2 OutputCoord, float2 ScreenUV, float Mip
             // soft shadow for the closest point light 
             if (ClosestSpotLightIndex == SpotLightIdx && SoftShadowCount < GMaxSoftShadowLightsPerPixel)
             {
-                OutShadowData[uint3(OutputCoord, SoftShadowCount++)] = float2(HitDist, Atten);
+                WriteShadowData(QuadOrigin, bQuarterRate, SoftShadowCount++, float2(HitDist, Atten));
             }
             
             // accumulate atten and max dist
@@ -140,18 +168,28 @@ void TraceShadow(uint2 PixelCoord, uint2 OutputCoord, float2 ScreenUV, float Mip
         }
     }
     
-    OutReceiveLightBits[OutputCoord] = ReceiveLightBit;
+    WriteReceiveLightBits(QuadOrigin, bQuarterRate, ReceiveLightBit);
 }
 
 [shader("raygeneration")]
 void RTShadowRayGen() 
 {
-    uint2 OutputCoord = DispatchRaysIndex().xy;
+    // rays are dispatched per classified tile, the tiles with valid cached results aren't listed
+    // flat tiles are traced at quarter rate under ray pressure
+    uint2 TraceResolution = uint2(GShadowResolution.xy);
+    uint2 OutputCoord;
+    uint2 QuadOrigin;
+    bool bQuarterRate;
+    if (!GetRTTileCoord(TraceResolution, OutputCoord, QuadOrigin, bQuarterRate))
+    {
+        return;
+    }
+
     for (uint Idx = 0; Idx < GMaxSoftShadowLightsPerPixel; Idx++)
     {
-        OutShadowData[uint3(OutputCoord, Idx)] = float2(0.0f, 1.0f);
+        WriteShadowData(QuadOrigin, bQuarterRate, Idx, float2(0.0f, 1.0f));
     }
-    OutReceiveLightBits[OutputCoord] = 0;
+    WriteReceiveLightBits(QuadOrigin, bQuarterRate, 0);
 	
 	// early return if no lights
 	UHBRANCH
@@ -170,7 +208,7 @@ void RTShadowRayGen()
     float MipLevel = max(0.5f * log2(MipRate * MipRate), 0) * GScreenMipCount + GRTMipBias;
 
     // trace direct light
-    TraceShadow(PixelCoord, OutputCoord, ScreenUV, MipRate, MipLevel);
+    TraceShadow(PixelCoord, QuadOrigin, bQuarterRate, ScreenUV, MipRate, MipLevel);
 }
 
 [shader("miss")]
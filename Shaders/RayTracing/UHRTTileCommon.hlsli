@@ -0,0 +1,111 @@
+#ifndef UHRTTILECOMMON_H
+#define UHRTTILECOMMON_H
+
+#include "../UHInputs.hlsli"
+
+// adaptive RT tiles, sync with RTTileClassifyShader.h
+#define RT_TILE_SIZE 8
+#define RT_TILE_RATE_SKIP 0
+#define RT_TILE_RATE_QUARTER 1
+#define RT_TILE_RATE_FULL 2
+
+// full and quarter rate VkTraceRaysIndirectCommandKHR, the 4th uint is the offset of their tiles in the list
+#define RT_RAY_ARGS_STRIDE 16
+#define RT_FULL_RATE_ARGS 0
+#define RT_QUARTER_RATE_ARGS RT_RAY_ARGS_STRIDE
+#define RT_FULL_RATE_RAYS (RT_TILE_SIZE * RT_TILE_SIZE)
+#define RT_QUARTER_RATE_RAYS (RT_FULL_RATE_RAYS / 4)
+
+uint PackRTTile(uint2 Tile)
+{
+    return Tile.x | (Tile.y << 16);
+}
+
+uint2 UnpackRTTile(uint PackedTile)
+{
+    return uint2(PackedTile & 0xffff, PackedTile >> 16);
+}
+
+// the traced pixel of a 2x2 quad at quarter rate, it rotates every frame so the temporal filters see every pixel
+uint2 GetRTQuadPhase()
+{
+    return uint2(GFrameNumber & 1, (GFrameNumber >> 1) & 1);
+}
+
+// pixels written by a traced ray, the whole 2x2 quad at quarter rate
+uint GetRTQuadPixelCount(bool bQuarterRate)
+{
+    return bQuarterRate ? 4 : 1;
+}
+
+// the Nth pixel of the quad in row order, false if it's outside the trace resolution
+bool GetRTQuadPixel(uint2 QuadOrigin, uint Index, uint2 TraceResolution, out uint2 OutCoord)
+{
+    OutCoord = QuadOrigin + uint2(Index & 1, Index >> 1);
+    return all(OutCoord < TraceResolution);
+}
+
+#ifdef RTTILE_LIST_BIND
+StructuredBuffer<uint> RTTileList : register(RTTILE_LIST_BIND);
+ByteAddressBuffer RTRayArgs : register(RTTILE_ARGS_BIND);
+
+// maps the ray of a tile dispatch to a trace coordinate, the dispatch width tells the rate
+// at quarter rate, one pixel of the 2x2 quad is traced and the result is written to the whole quad
+bool GetRTTileCoord(uint2 TraceResolution, out uint2 OutTraceCoord, out uint2 OutQuadOrigin, out bool bOutQuarterRate)
+{
+    uint2 RayIndex = DispatchRaysIndex().xy;
+    bOutQuarterRate = DispatchRaysDimensions().x == RT_QUARTER_RATE_RAYS;
+    uint ArgsOffset = bOutQuarterRate ? RT_QUARTER_RATE_ARGS : RT_FULL_RATE_ARGS;
+
+    OutTraceCoord = 0;
+    OutQuadOrigin = 0;
+
+    // without indirect tracing the dispatch covers the max tile count, the rays beyond the listed tiles return here
+    if (RayIndex.y >= RTRayArgs.Load(ArgsOffset + 4))
+    {
+        return false;
+    }
+
+    uint2 TileOrigin = UnpackRTTile(RTTileList[RTRayArgs.Load(ArgsOffset + 12) + RayIndex.y]) * RT_TILE_SIZE;
+    if (bOutQuarterRate)
+    {
+        uint QuadsPerRow = RT_TILE_SIZE / 2;
+        OutQuadOrigin = TileOrigin + uint2(RayIndex.x % QuadsPerRow, RayIndex.x / QuadsPerRow) * 2;
+        OutTraceCoord = min(OutQuadOrigin + GetRTQuadPhase(), TraceResolution - 1);
+    }
+    else
+    {
+        OutTraceCoord = TileOrigin + uint2(RayIndex.x % RT_TILE_SIZE, RayIndex.x / RT_TILE_SIZE);
+        OutQuadOrigin = OutTraceCoord;
+    }
+
+    return all(OutQuadOrigin < TraceResolution);
+}
+
+// the output can be larger than the trace resolution, e.g. half res reflection is upsampled from every other pixel
+void WriteRTTileResult(RWTexture2D<float4> Output, uint2 QuadOrigin, bool bQuarterRate, uint2 TraceResolution, uint Stride, float4 Value)
+{
+    for (uint Idx = 0; Idx < GetRTQuadPixelCount(bQuarterRate); Idx++)
+    {
+        uint2 Coord;
+        if (GetRTQuadPixel(QuadOrigin, Idx, TraceResolution, Coord))
+        {
+            Output[Coord * Stride] = Value;
+        }
+    }
+}
+
+void WriteRTTileResult(RWTexture2D<float2> Output, uint2 QuadOrigin, bool bQuarterRate, uint2 TraceResolution, uint Stride, float2 Value)
+{
+    for (uint Idx = 0; Idx < GetRTQuadPixelCount(bQuarterRate); Idx++)
+    {
+        uint2 Coord;
+        if (GetRTQuadPixel(QuadOrigin, Idx, TraceResolution, Coord))
+        {
+            Output[Coord * Stride] = Value;
+        }
+    }
+}
+#endif
+
+#endif
@@ -8,8 +8,8 @@
 #include "../Shaders/UHMaterialCommon.hlsli"
 #include "../Shaders/UHSphericalHamonricCommon.hlsli"
 
-ByteAddressBuffer PointLightListTrans : register(t10);
-ByteAddressBuffer SpotLightListTrans : register(t11);
+ByteAddressBuffer PointLightList : register(t10);
+ByteAddressBuffer SpotLightList : register(t11);
 TextureCube EnvCube : register(t12);
 
 // texture/sampler tables for bindless rendering
@@ -162,18 +162,16 @@ float4 TranslucentPS(VertexOutput Vin, bool bIsFrontFace : SV_IsFrontFace) : SV_
     }
 	
 	// ------------------------------------------------------------------------------------------ point lights accumulation
-	// point lights accumulation, fetch the tile index here, note that the system culls at half resolution
-    uint TileX = CoordToTileX(uint(Vin.Position.x + 0.5f));
-    uint TileY = CoordToTileY(uint(Vin.Position.y + 0.5f));
-    uint TileIndex = TileX + TileY * GLightTileCountX;
-    uint TileOffset = GetPointLightOffset(TileIndex);
-    uint PointLightCount = PointLightListTrans.Load(TileOffset);
-    TileOffset += 4;
+	// point lights accumulation, fetch the cluster index here, SV_Position.w is the view depth
+    uint ClusterIndex = GetClusterIndex(Vin.Position.xy, Vin.Position.w);
+    uint ListOffset = GetLightListOffset(PointLightList, ClusterIndex);
+    uint PointLightCount = PointLightList.Load(ListOffset);
+    ListOffset += 4;
     
     for (Ldx = 0; Ldx < PointLightCount; Ldx++)
     {
-        uint PointLightIdx = PointLightListTrans.Load(TileOffset);
-        TileOffset += 4;
+        uint PointLightIdx = PointLightList.Load(ListOffset);
+        ListOffset += 4;
        
         UHPointLight PointLight = UHPointLights[PointLightIdx];
         Result += CalculatePointLight(PointLight, LightInfo);
@@ -181,15 +179,15 @@ float4 TranslucentPS(VertexOutput Vin, bool bIsFrontFace : SV_IsFrontFace) : SV_
 	
 	// ------------------------------------------------------------------------------------------ spot lights accumulation
 	// similar as the point light but giving it angle attenuation as well
-    TileOffset = GetSpotLightOffset(TileIndex);
-    uint SpotLightCount = SpotLightListTrans.Load(TileOffset);
-    TileOffset += 4;
+    ListOffset = GetLightListOffset(SpotLightList, ClusterIndex);
+    uint SpotLightCount = SpotLightList.Load(ListOffset);
+    ListOffset += 4;
     
     UHLOOP
     for (Ldx = 0; Ldx < SpotLightCount; Ldx++)
     {
-        uint SpotLightIdx = SpotLightListTrans.Load(TileOffset);
-        TileOffset += 4;
+        uint SpotLightIdx = SpotLightList.Load(ListOffset);
+        ListOffset += 4;
         
         UHSpotLight SpotLight = UHSpotLights[SpotLightIdx];
         Result += CalculateSpotLight(SpotLight, LightInfo);
@@ -16,6 +16,8 @@ struct UHRendererInstance
     uint MeshIndex;
     // indice type
     uint IndiceType;
+    // material index to lookup material data
+    uint MaterialIndex;
 };
 
 static const float4 GBoxOffset[8] =
@@ -75,15 +77,33 @@ float3 ComputeSpecularColor(float3 Specular, float3 BaseColor, float Metallic)
 	return lerp(Specular * 0.05f, BaseColor, Metallic.rrr);
 }
 
-float3 LocalToWorldNormal(float3 Normal)
+float3 LocalToWorldPos(float3 Pos, ObjectConstants Obj)
 {
-	// mul(IT_M, norm) => mul(norm, I_M) => {dot(norm, I_M.col0), dot(norm, I_M.col1), dot(norm, I_M.col2)}
-	return normalize(mul(Normal, (float3x3)GWorldIT));
+	float4 P = float4(Pos, 1.0f);
+	return float3(dot(Obj.GWorld[0], P), dot(Obj.GWorld[1], P), dot(Obj.GWorld[2], P));
 }
 
-float3 LocalToWorldDir(float3 Dir)
+float3 PrevLocalToWorldPos(float3 Pos, ObjectConstants Obj)
 {
-	return normalize(mul(Dir, (float3x3)GWorld));
+	float4 P = float4(Pos, 1.0f);
+	return float3(dot(Obj.GPrevWorld[0], P), dot(Obj.GPrevWorld[1], P), dot(Obj.GPrevWorld[2], P));
+}
+
+float3 LocalToWorldNormal(float3 Normal, ObjectConstants Obj)
+{
+	// inverse-transpose is cofactor / det, the scale of det is gone after normalize and only its sign matters
+	float3 R0 = Obj.GWorld[0].xyz;
+	float3 R1 = Obj.GWorld[1].xyz;
+	float3 R2 = Obj.GWorld[2].xyz;
+	float3 N = float3(dot(cross(R1, R2), Normal), dot(cross(R2, R0), Normal), dot(cross(R0, R1), Normal));
+
+	float Sign = (Obj.GObjectFlags & UH_OBJ_MIRRORED) ? -1.0f : 1.0f;
+	return normalize(N) * Sign;
+}
+
+float3 LocalToWorldDir(float3 Dir, ObjectConstants Obj)
+{
+	return normalize(float3(dot(Obj.GWorld[0].xyz, Dir), dot(Obj.GWorld[1].xyz, Dir), dot(Obj.GWorld[2].xyz, Dir)));
 }
 
 float3 WorldToViewPos(float3 Pos)
@@ -93,9 +113,9 @@ float3 WorldToViewPos(float3 Pos)
     return mul(GView, float4(Pos, 1.0f)).xyz * float3(1, 1, -1);
 }
 
-float3x3 CreateTBN(float3 InWorldNormal, float4 InTangent)
+float3x3 CreateTBN(float3 InWorldNormal, float4 InTangent, ObjectConstants Obj)
 {
-	float3 Tangent = LocalToWorldDir(InTangent.xyz);
+	float3 Tangent = LocalToWorldDir(InTangent.xyz, Obj);
 	float3 Binormal = cross(InWorldNormal, Tangent) * InTangent.w;
     Tangent = cross(Binormal, InWorldNormal) * InTangent.w;
 
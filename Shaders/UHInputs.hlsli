@@ -9,11 +9,16 @@
 #endif
 
 #ifndef UHOBJ_BIND
-#define UHOBJ_BIND b1
+#define UHOBJ_BIND t1
+#endif
+
+// material constants are in the shared material arena set, the shader class defines its space
+#ifndef UHMAT_SPACE
+#define UHMAT_SPACE space3
 #endif
 
 #ifndef UHMAT_BIND
-#define UHMAT_BIND b2
+#define UHMAT_BIND b0, UHMAT_SPACE
 #endif
 
 #ifndef UHGBUFFER_BIND
@@ -39,8 +44,13 @@
 #define UH_HDR 1 << 1
 #define UH_USE_SMOOTH_NORMAL_RAYTRACING 1 << 2
 #define UH_RT_INDIRECTLIGHT 1 << 3
+#define UH_VERTEX_COMPRESSION 1 << 4
 #define UH_DEBUGING 1 << 31
 
+// object flag bits, used by GObjectFlags in object constants
+// this needs to sync with UHObjectFlagBits in C++ side
+#define UH_OBJ_MIRRORED 1 << 0
+
 struct VertexOutput
 {
 	float4 Position : SV_POSITION;
@@ -68,6 +78,15 @@ struct DepthVertexOutput
 #if MASKED
 	float2 UV0 : TEXCOORD0;
 #endif
+#if VISIBILITY_BUFFER
+	nointerpolation uint RendererIndex : UHINSTANCEINDEX;
+#endif
+};
+
+// per-primitive output of depth mesh shader, the triangle ID for visibility buffer
+struct VisibilityPrimitiveOutput
+{
+	uint PrimitiveID : SV_PrimitiveID;
 };
 
 struct MotionVertexOutput
@@ -110,11 +129,11 @@ cbuffer SystemConstants : register(UHSYSTEM_BIND)
 	float GJitterScaleMin;	// minimum jitter scale
 	float GJitterScaleFactor;	// jitter scale factorto multiply with
     uint GNumPointLights;
-    uint GLightTileCountX;
+    uint GLightClusterCountX;
 	
-    uint GMaxPointLightPerTile;
+    uint GLightClusterCountY;
     uint GNumSpotLights;
-    uint GMaxSpotLightPerTile;
+    uint GLightClusterCountZ;
 	uint GFrameNumber;
 	
     uint GSystemRenderFeature;
@@ -142,18 +161,26 @@ cbuffer SystemConstants : register(UHSYSTEM_BIND)
     float GScreenMipCount;
     float GRTReflectionMipCount;
     float GFarPlane;
+	
+    float GLightClusterSliceScale;	// cluster slice = log(view depth) * scale + bias
+    float GLightClusterSliceBias;
+    uint GLightClusterTileSize;
+    uint GLightClusterPadding;
 }
 
-// IT means inverse-transposed
-cbuffer ObjectConstants : register(UHOBJ_BIND)
+// packed object constants, 128 bytes per renderer and fetched by instance index
+// world matrices are 3x4 affine rows, normal matrix is reconstructed from world with LocalToWorldNormal()
+// the structure must be the same as c++ define
+struct ObjectConstants
 {
-	float4x4 GWorld;
-	float4x4 GWorldIT;
-	float4x4 GPrevWorld;
-	uint GInstanceIndex;
+    float4 GWorld[3];
+    float4 GPrevWorld[3];
     float3 GWorldPos;
+    uint GInstanceIndex;
     float3 GBoundExtent;
-}
+    uint GObjectFlags;
+};
+StructuredBuffer<ObjectConstants> UHObjects : register(UHOBJ_BIND);
 
 // 0: Color + AO
 // 1: Normal
@@ -1,10 +1,6 @@
 #ifndef UHLIGHTCOMMON_H
 #define UHLIGHTCOMMON_H
 
-#define UHLIGHTCULLING_TILEX 16
-#define UHLIGHTCULLING_TILEY 16
-#define UHLIGHTCULLING_UPSCALE 2
-
 #include "UHInputs.hlsli"
 #include "UHCommon.hlsli"
 #ifndef UHDIRLIGHT_BIND
@@ -120,39 +116,36 @@ float3 LightBRDF(UHLightInfo LightInfo, bool bDiffuseOnly = false)
     return LightInfo.Diffuse * LightDiffuse + LightSpecular;
 }
 
-uint GetPointLightOffset(uint InIndex)
-{
-    return InIndex * (GMaxPointLightPerTile * 4 + 4);
-}
-
-uint GetSpotLightOffset(uint InIndex)
-{
-    return InIndex * (GMaxSpotLightPerTile * 4 + 4);
-}
-
-bool HasLighting()
-{
-    return GNumDirLights > 0 || GNumPointLights > 0 || GNumSpotLights > 0;
-}
-
-uint CoordToTileX(uint InX)
+// light lists are built on CPU, the first ClusterCount uints are byte offsets to [LightCount, LightIndices...]
+uint GetLightListOffset(in ByteAddressBuffer LightList, uint ClusterIndex)
 {
-    return InX / UHLIGHTCULLING_TILEX / UHLIGHTCULLING_UPSCALE;
+    return LightList.Load(ClusterIndex * 4);
 }
 
-uint CoordToTileY(uint InY)
+// cluster index from pixel coordinate and linear view depth, the slice is logarithmic
+// this must sync with UHLightCluster::GetSlice() on c++ side
+uint GetClusterIndex(float2 PixelCoord, float ViewDepth)
 {
-    return InY / UHLIGHTCULLING_TILEY / UHLIGHTCULLING_UPSCALE;
+    uint2 Tile = min(uint2(max(PixelCoord, 0.0f)) / GLightClusterTileSize, uint2(GLightClusterCountX, GLightClusterCountY) - 1);
+    float Slice = log(max(ViewDepth, GNearPlane)) * GLightClusterSliceScale + GLightClusterSliceBias;
+    uint SliceIndex = min(uint(max(Slice, 0.0f)), GLightClusterCountZ - 1);
+    
+    return Tile.x + Tile.y * GLightClusterCountX + SliceIndex * GLightClusterCountX * GLightClusterCountY;
 }
 
-float TileToCoordX(uint InX)
+// cluster index from world position, positions outside screen are clamped to the border clusters
+uint GetClusterIndexFromWorldPos(float3 WorldPos)
 {
-    return InX * UHLIGHTCULLING_TILEX;
+    float4 ClipPos = mul(float4(WorldPos, 1.0f), GViewProj_NonJittered);
+    float2 ScreenUV = saturate(ClipPos.xy / max(ClipPos.w, UH_FLOAT_EPSILON) * 0.5f + 0.5f);
+    float ViewDepth = dot(WorldPos - GCameraPos, GCameraDir);
+    
+    return GetClusterIndex(ScreenUV * GResolution.xy, ViewDepth);
 }
 
-float TileToCoordY(uint InY)
+bool HasLighting()
 {
-    return InY * UHLIGHTCULLING_TILEY;
+    return GNumDirLights > 0 || GNumPointLights > 0 || GNumSpotLights > 0;
 }
 
 float CalculatePointLightAttenuation(float Radius, float AttenNoise, float3 LightToWorld)
@@ -231,19 +224,19 @@ float3 CalculateSpotLight(UHSpotLight SpotLight, UHLightInfo LightInfo, bool bDi
 }
 
 // GetClosestPointLightIndex from a world pos
-uint GetClosestPointLightIndex(in ByteAddressBuffer PointLightList, uint TileIndex, float3 WorldPos)
+uint GetClosestPointLightIndex(in ByteAddressBuffer PointLightList, uint ClusterIndex, float3 WorldPos)
 {
-    uint TileOffset = GetPointLightOffset(TileIndex);
-    uint LightCount = PointLightList.Load(TileOffset);
-    TileOffset += 4;
+    uint ListOffset = GetLightListOffset(PointLightList, ClusterIndex);
+    uint LightCount = PointLightList.Load(ListOffset);
+    ListOffset += 4;
 	
     uint ClosestIndex = ~0;
     float LightToWorldDist = UH_FLOAT_MAX;
     
     for (uint Ldx = 0; Ldx < LightCount; Ldx++)
     {
-        uint PointLightIdx = PointLightList.Load(TileOffset);
-        TileOffset += 4;
+        uint PointLightIdx = PointLightList.Load(ListOffset);
+        ListOffset += 4;
 		
         UHPointLight PointLight = UHPointLights[PointLightIdx];
         UHBRANCH
@@ -263,19 +256,19 @@ uint GetClosestPointLightIndex(in ByteAddressBuffer PointLightList, uint TileInd
 }
 
 // GetClosestSpotLightIndex from a world pos
-uint GetClosestSpotLightIndex(in ByteAddressBuffer SpotLightList, uint TileIndex, float3 WorldPos)
+uint GetClosestSpotLightIndex(in ByteAddressBuffer SpotLightList, uint ClusterIndex, float3 WorldPos)
 {
-    uint TileOffset = GetSpotLightOffset(TileIndex);
-    uint LightCount = SpotLightList.Load(TileOffset);
-    TileOffset += 4;
+    uint ListOffset = GetLightListOffset(SpotLightList, ClusterIndex);
+    uint LightCount = SpotLightList.Load(ListOffset);
+    ListOffset += 4;
 	
     uint ClosestIndex = ~0;
     float LightToWorldDist = UH_FLOAT_MAX;
     
     for (uint Ldx = 0; Ldx < LightCount; Ldx++)
     {
-        uint SpotLightIdx = SpotLightList.Load(TileOffset);
-        TileOffset += 4;
+        uint SpotLightIdx = SpotLightList.Load(ListOffset);
+        ListOffset += 4;
 		
         UHSpotLight SpotLight = UHSpotLights[SpotLightIdx];
         UHBRANCH
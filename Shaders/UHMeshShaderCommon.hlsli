@@ -7,39 +7,51 @@
 #define MESHSHADER_MAX_VERTEX 126
 #define MESHSHADER_MAX_PRIMITIVE 42
 
-// on the C++ side, it will count total number of meshlets to dispatch for each material group
-// and this is the list to store the shader to meshlet and renderer data
+// each amplification thread processes a meshlet
+#define AMPLIFICATION_GROUP_SIZE 32
+
+// sync with UHMeshShaderFlagBits
+#define UH_MESHSHADER_OCCLUSION_TEST 1 << 0
+#define UH_MESHSHADER_CONE_CULLING 1 << 1
+
+// on the C++ side, it will collect one record per visible instance for each material group
+// the meshlet offset is prefix-summed, amplification shader finds the instance of a meshlet with it
 struct UHMeshShaderData
 {
     uint RendererIndex;
-    uint MeshletIndex;
-    uint bDoOcclusionTest;
+    uint MeshletOffset;
+    uint MeshletCount;
+    uint Flags;
 };
 
-// meshlet data
+// meshlet data, offsets are in the meshlet data buffer
+// which stores unique vertex indices first, then the local triangles packed as 3x8-bit
+// bounding sphere and cone are in the vertex stream space
 struct UHMeshlet
 {
     uint VertexCount;
     uint VertexOffset;
     uint PrimitiveCount;
+    uint PrimitiveOffset;
+    float3 BoundCenter;
+    float BoundRadius;
+    float3 ConeAxis;
+    float ConeCutoff;
 };
 
-struct ObjectConstants
+// push constant for amplification shader
+struct UHMeshShaderConstants
 {
-    float4x4 GWorld;
-    float4x4 GWorldIT;
-    float4x4 GPrevWorld;
-    uint GInstanceIndex;
-    float3 GWorldPos;
-    float3 GBoundExtent;
-    
-    // align to 256 bytes, the buffer is used as storage in mesh shader, the structure must be the same as c++ define
-    float CPUPadding[9];
+    uint InstanceCount;
+    uint MeshletCount;
+    uint bEnableHiZ;
 };
 
+// visible meshlets output from amplification shader, mesh shader fetches them by group ID
 struct UHMeshPayload
 {
-    uint ShaderDataIndices[MESHSHADER_GROUP_SIZE];
+    uint RendererIndices[AMPLIFICATION_GROUP_SIZE];
+    uint MeshletIndices[AMPLIFICATION_GROUP_SIZE];
 };
 
 uint3 GetIndices(ByteAddressBuffer InBuffer, uint InPrimIndex, uint InIndiceType)
@@ -80,48 +92,87 @@ uint3 GetIndices(ByteAddressBuffer InBuffer, uint InPrimIndex, uint InIndiceType
     return Indices;
 }
 
-uint GetVertexIndex(ByteAddressBuffer InBuffer, uint InIndex, uint InIndiceType)
+uint GetMeshletVertexIndex(ByteAddressBuffer InBuffer, UHMeshlet InMeshlet, uint InLocalIndex)
 {
-    uint IbStride = 4;
-    uint Index = 0;
-    
-    if (InIndiceType == 1)
-    {
-        Index = InBuffer.Load(InIndex * IbStride);
-    }
-    else
-    {
-        // similar calculation as GetIndices(), but only return one index
-        uint WorldOffset = (InIndex & 1);
-        uint ByteOffset = (InIndex / 2) * IbStride;
+    return InBuffer.Load((InMeshlet.VertexOffset + InLocalIndex) * 4);
+}
+
+uint3 GetMeshletTriangle(ByteAddressBuffer InBuffer, UHMeshlet InMeshlet, uint InPrimIndex)
+{
+    uint Packed = InBuffer.Load((InMeshlet.PrimitiveOffset + InPrimIndex) * 4);
+    return uint3(Packed & 0xff, (Packed >> 8) & 0xff, (Packed >> 16) & 0xff);
+}
+
+// vertex decoding, this needs to sync with the packing in UHMesh
+// vertex streams are always bound as ByteAddressBuffer, the layout depends on UH_VERTEX_COMPRESSION
+bool IsVertexCompressed()
+{
+    return (GSystemRenderFeature & UH_VERTEX_COMPRESSION) > 0;
+}
+
+float2 UnpackSnorm16x2(uint InValue)
+{
+    // shift to the high bits first for sign extension
+    int2 Value = int2(InValue << 16, InValue) >> 16;
+    return max(float2(Value) / 32767.0f, -1.0f);
+}
+
+float3 DecodeOctahedral(float2 E)
+{
+    float3 N = float3(E.xy, 1.0f - abs(E.x) - abs(E.y));
+    float T = saturate(-N.z);
+    N.x += (N.x >= 0.0f) ? -T : T;
+    N.y += (N.y >= 0.0f) ? -T : T;
+    return normalize(N);
+}
 
-        // Grab a pair of 16-bit indices, and mask out proper 16-bits.
-        const uint Two16BitIndices = InBuffer.Load(ByteOffset);
-        Index = (Two16BitIndices >> (WorldOffset * 16)) & 0xffff;
+float3 LoadVertexPosition(ByteAddressBuffer InBuffer, uint InIndex)
+{
+    // compressed position stays in the quantized range, its decode is merged into world matrix on C++ side
+    if (IsVertexCompressed())
+    {
+        uint2 Packed = InBuffer.Load2(InIndex * 8);
+        return float3(UnpackSnorm16x2(Packed.x), UnpackSnorm16x2(Packed.y).x);
     }
     
-    return Index;
+    return asfloat(InBuffer.Load3(InIndex * 12));
 }
 
-float3 LocalToWorldNormalMS(float3 Normal, float3x3 WorldIT)
+float2 LoadVertexUV0(ByteAddressBuffer InBuffer, uint InIndex)
 {
-	// mul(IT_M, norm) => mul(norm, I_M) => {dot(norm, I_M.col0), dot(norm, I_M.col1), dot(norm, I_M.col2)}
-    return normalize(mul(Normal, (float3x3)WorldIT));
+    if (IsVertexCompressed())
+    {
+        uint Packed = InBuffer.Load(InIndex * 4);
+        return f16tof32(uint2(Packed, Packed >> 16));
+    }
+    
+    return asfloat(InBuffer.Load2(InIndex * 8));
 }
 
-float3 LocalToWorldDirMS(float3 Dir, float3x3 World)
+float3 LoadVertexNormal(ByteAddressBuffer InBuffer, uint InIndex)
 {
-    return normalize(mul(Dir, (float3x3)World));
+    // octahedral unorm16 x2
+    if (IsVertexCompressed())
+    {
+        uint Packed = InBuffer.Load(InIndex * 4);
+        float2 E = float2(Packed & 0xffff, Packed >> 16) / 65535.0f;
+        return DecodeOctahedral(E * 2.0f - 1.0f);
+    }
+    
+    return asfloat(InBuffer.Load3(InIndex * 12));
 }
 
-float3x3 CreateTBNMS(float3 InWorldNormal, float4 InTangent, float3x3 World)
+float4 LoadVertexTangent(ByteAddressBuffer InBuffer, uint InIndex)
 {
-    float3 Tangent = LocalToWorldDirMS(InTangent.xyz, World);
-    float3 Binormal = cross(InWorldNormal, Tangent) * InTangent.w;
-    Tangent = cross(Binormal, InWorldNormal) * InTangent.w;
-
-    float3x3 TBN = float3x3(Tangent, Binormal, InWorldNormal);
-    return TBN;
+    // octahedral unorm15 x2 + sign bit
+    if (IsVertexCompressed())
+    {
+        uint Packed = InBuffer.Load(InIndex * 4);
+        float2 E = float2(Packed & 0x7fff, (Packed >> 15) & 0x7fff) / 32767.0f;
+        return float4(DecodeOctahedral(E * 2.0f - 1.0f), (Packed >> 31) ? -1.0f : 1.0f);
+    }
+    
+    return asfloat(InBuffer.Load4(InIndex * 16));
 }
 
 #endif
\ No newline at end of file
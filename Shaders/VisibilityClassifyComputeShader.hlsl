@@ -0,0 +1,68 @@
+// visibility buffer material classification
+// each group is a screen tile, the tile is appended to the list of every material it contains
+// the material resolve pass then draws the tiles of a material with the indirect args
+#include "UHInputs.hlsli"
+#include "UHCommon.hlsli"
+
+Texture2D<uint2> SceneVisibility : register(t1);
+StructuredBuffer<UHRendererInstance> RendererInstances : register(t2);
+// VkDrawIndirectCommand per material, cleared to 0 before dispatch
+RWByteAddressBuffer DrawArgs : register(u3);
+// packed tile coordinates, TileCount slots per material
+RWByteAddressBuffer TileList : register(u4);
+
+#define DRAW_ARGS_STRIDE 16
+#define VERTEX_PER_TILE 6
+#define EMPTY_MATERIAL 0xffffffff
+
+groupshared uint GTileMaterials[UHTHREAD_GROUP2D_X * UHTHREAD_GROUP2D_Y];
+
+[numthreads(UHTHREAD_GROUP2D_X, UHTHREAD_GROUP2D_Y, 1)]
+void VisibilityClassifyCS(uint3 DTid : SV_DispatchThreadID, uint3 Gid : SV_GroupID, uint GIndex : SV_GroupIndex)
+{
+    uint MaterialIndex = EMPTY_MATERIAL;
+    if (DTid.x < (uint)GResolution.x && DTid.y < (uint)GResolution.y)
+    {
+        uint2 Visibility = SceneVisibility[DTid.xy];
+        if (Visibility.x > 0)
+        {
+            MaterialIndex = RendererInstances[Visibility.x - 1].MaterialIndex;
+        }
+    }
+
+    GTileMaterials[GIndex] = MaterialIndex;
+    GroupMemoryBarrierWithGroupSync();
+
+    if (MaterialIndex == EMPTY_MATERIAL)
+    {
+        return;
+    }
+
+    // only the first pixel of a material in this tile appends the tile
+    for (uint Idx = 0; Idx < GIndex; Idx++)
+    {
+        if (GTileMaterials[Idx] == MaterialIndex)
+        {
+            return;
+        }
+    }
+
+    uint DrawArgsSize;
+    DrawArgs.GetDimensions(DrawArgsSize);
+    if (MaterialIndex >= DrawArgsSize / DRAW_ARGS_STRIDE)
+    {
+        return;
+    }
+
+    // vertex count is the first member of draw args, instance count is always 1
+    uint VertexOffset;
+    DrawArgs.InterlockedAdd(MaterialIndex * DRAW_ARGS_STRIDE, VERTEX_PER_TILE, VertexOffset);
+    if (VertexOffset == 0)
+    {
+        DrawArgs.Store(MaterialIndex * DRAW_ARGS_STRIDE + 4, 1);
+    }
+
+    uint2 TileCount = (uint2(GResolution.xy) + uint2(UHTHREAD_GROUP2D_X, UHTHREAD_GROUP2D_Y) - 1) / uint2(UHTHREAD_GROUP2D_X, UHTHREAD_GROUP2D_Y);
+    uint TileIndex = MaterialIndex * TileCount.x * TileCount.y + VertexOffset / VERTEX_PER_TILE;
+    TileList.Store(TileIndex * 4, Gid.x | (Gid.y << 16));
+}
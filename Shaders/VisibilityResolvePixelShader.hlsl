@@ -0,0 +1,192 @@
+// pixel shader of visibility buffer material resolve
+// the triangle of each pixel is fetched with the IDs from depth pre pass, and the attributes are reconstructed from mesh data
+// so the material is evaluated only once per pixel and outputs the same GBuffers as base pass
+#include "../Shaders/UHInputs.hlsli"
+#include "../Shaders/UHCommon.hlsli"
+#include "../Shaders/UHLightCommon.hlsli"
+#include "../Shaders/UHMaterialCommon.hlsli"
+#include "../Shaders/UHMeshShaderCommon.hlsli"
+
+// texture/sampler tables for bindless rendering
+Texture2D UHTextureTable[] : register(t0, space1);
+SamplerState UHSamplerTable[] : register(t0, space2);
+
+Texture2D<uint2> SceneVisibility : register(t3);
+StructuredBuffer<UHRendererInstance> RendererInstances : register(t4);
+
+// all mesh data, fetched by mesh index first
+StructuredBuffer<UHMeshlet> Meshlets[] : register(t0, space3);
+ByteAddressBuffer PositionBuffer[] : register(t0, space4);
+ByteAddressBuffer UV0Buffer[] : register(t0, space5);
+ByteAddressBuffer MeshletData[] : register(t0, space6);
+ByteAddressBuffer NormalBuffer[] : register(t0, space7);
+ByteAddressBuffer TangentBuffer[] : register(t0, space8);
+
+cbuffer PassConstant : register(UHMAT_BIND)
+{
+	//%UHS_CBUFFERDEFINE
+}
+
+struct VisibilityResolveConstants
+{
+	uint MaterialIndex;
+};
+[[vk::push_constant]] VisibilityResolveConstants Constants;
+
+// there are no hardware derivatives of the mesh UV here, material textures are sampled with the analytic UV0 gradients
+static float2 GUV0Ddx;
+static float2 GUV0Ddy;
+
+#define Sample(InSampler, InUV) SampleGrad(InSampler, InUV, GUV0Ddx, GUV0Ddy)
+UHMaterialInputs GetMaterialInput(float2 UV0)
+{
+	// material input code will be generated in C++ side
+	//%UHS_INPUT
+}
+#undef Sample
+
+struct UHBarycentricDeriv
+{
+	float3 Lambda;
+	float3 Ddx;
+	float3 Ddy;
+};
+
+// perspective-correct barycentrics of a clip space triangle at the pixel, and their change per pixel in x/y
+UHBarycentricDeriv CalcFullBarycentric(float4 Pos0, float4 Pos1, float4 Pos2, float2 PixelNdc)
+{
+	UHBarycentricDeriv Result;
+
+	float3 InvW = rcp(float3(Pos0.w, Pos1.w, Pos2.w));
+	float2 Ndc0 = Pos0.xy * InvW.x;
+	float2 Ndc1 = Pos1.xy * InvW.y;
+	float2 Ndc2 = Pos2.xy * InvW.z;
+
+	float InvDet = rcp(determinant(float2x2(Ndc2 - Ndc1, Ndc0 - Ndc1)));
+	Result.Ddx = float3(Ndc1.y - Ndc2.y, Ndc2.y - Ndc0.y, Ndc0.y - Ndc1.y) * InvDet * InvW;
+	Result.Ddy = float3(Ndc2.x - Ndc1.x, Ndc0.x - Ndc2.x, Ndc1.x - Ndc0.x) * InvDet * InvW;
+	float DdxSum = dot(Result.Ddx, float3(1, 1, 1));
+	float DdySum = dot(Result.Ddy, float3(1, 1, 1));
+
+	float2 DeltaVec = PixelNdc - Ndc0;
+	float InterpInvW = InvW.x + DeltaVec.x * DdxSum + DeltaVec.y * DdySum;
+	float InterpW = rcp(InterpInvW);
+
+	Result.Lambda.x = InterpW * (InvW.x + DeltaVec.x * Result.Ddx.x + DeltaVec.y * Result.Ddy.x);
+	Result.Lambda.y = InterpW * (DeltaVec.x * Result.Ddx.y + DeltaVec.y * Result.Ddy.y);
+	Result.Lambda.z = InterpW * (DeltaVec.x * Result.Ddx.z + DeltaVec.y * Result.Ddy.z);
+
+	// scale to a pixel step, NDC Y goes down as the screen in Vulkan so no flip is needed
+	Result.Ddx *= 2.0f * GResolution.z;
+	Result.Ddy *= 2.0f * GResolution.w;
+	DdxSum *= 2.0f * GResolution.z;
+	DdySum *= 2.0f * GResolution.w;
+
+	float InterpDdxW = rcp(InterpInvW + DdxSum);
+	float InterpDdyW = rcp(InterpInvW + DdySum);
+	Result.Ddx = InterpDdxW * (Result.Lambda * InterpInvW + Result.Ddx) - Result.Lambda;
+	Result.Ddy = InterpDdyW * (Result.Lambda * InterpInvW + Result.Ddy) - Result.Lambda;
+
+	return Result;
+}
+
+void VisibilityResolvePS(float4 Position : SV_POSITION
+	, out float4 OutColor : SV_Target0
+	, out float4 OutNormal : SV_Target1
+	, out float4 OutMaterial : SV_Target2
+	, out float4 OutEmissive : SV_Target3
+	, out float OutMip : SV_Target4
+	, out uint OutData : SV_Target5)
+{
+	// a tile can contain other materials and empty pixels
+	uint2 Visibility = SceneVisibility[uint2(Position.xy)];
+	if (Visibility.x == 0)
+	{
+		discard;
+	}
+
+	uint RendererIndex = Visibility.x - 1;
+	UHRendererInstance InInstance = RendererInstances[RendererIndex];
+	if (InInstance.MaterialIndex != Constants.MaterialIndex)
+	{
+		discard;
+	}
+
+	// find the triangle with the IDs, see DepthMeshShader.hlsl
+	UHMeshlet Meshlet = Meshlets[InInstance.MeshIndex][Visibility.y / MESHSHADER_MAX_PRIMITIVE];
+	uint3 LocalTriangle = GetMeshletTriangle(MeshletData[InInstance.MeshIndex], Meshlet, Visibility.y % MESHSHADER_MAX_PRIMITIVE);
+	ObjectConstants Constant = UHObjects[RendererIndex];
+
+	// transform the vertices exactly as the mesh shader, so the result matches the depth
+	float4 ClipPos[3];
+	float2 UV0s[3];
+	float3 Normals[3];
+#if TANGENT_SPACE
+	float3x3 WorldTBNs[3];
+#endif
+
+	UHUNROLL
+	for (uint Idx = 0; Idx < 3; Idx++)
+	{
+		uint VertexIndex = GetMeshletVertexIndex(MeshletData[InInstance.MeshIndex], Meshlet, LocalTriangle[Idx]);
+		float3 WorldPos = LocalToWorldPos(LoadVertexPosition(PositionBuffer[InInstance.MeshIndex], VertexIndex), Constant);
+
+		float4x4 JitterMatrix = GetDistanceScaledJitterMatrix(length(WorldPos - GCameraPos));
+		ClipPos[Idx] = mul(float4(WorldPos, 1.0f), GViewProj_NonJittered);
+		ClipPos[Idx] = mul(ClipPos[Idx], JitterMatrix);
+
+		UV0s[Idx] = LoadVertexUV0(UV0Buffer[InInstance.MeshIndex], VertexIndex);
+		Normals[Idx] = LocalToWorldNormal(LoadVertexNormal(NormalBuffer[InInstance.MeshIndex], VertexIndex), Constant);
+#if TANGENT_SPACE
+		WorldTBNs[Idx] = CreateTBN(Normals[Idx], LoadVertexTangent(TangentBuffer[InInstance.MeshIndex], VertexIndex), Constant);
+#endif
+	}
+
+	float2 PixelNdc = Position.xy * GResolution.zw * 2.0f - 1.0f;
+	UHBarycentricDeriv Bary = CalcFullBarycentric(ClipPos[0], ClipPos[1], ClipPos[2], PixelNdc);
+
+	float2 UV0 = UV0s[0] * Bary.Lambda.x + UV0s[1] * Bary.Lambda.y + UV0s[2] * Bary.Lambda.z;
+	GUV0Ddx = UV0s[0] * Bary.Ddx.x + UV0s[1] * Bary.Ddx.y + UV0s[2] * Bary.Ddx.z;
+	GUV0Ddy = UV0s[0] * Bary.Ddy.x + UV0s[1] * Bary.Ddy.y + UV0s[2] * Bary.Ddy.z;
+
+	// front face is clockwise on screen, the homogeneous determinant keeps the sign when a vertex is behind the camera
+	bool bIsFrontFace = determinant(float3x3(ClipPos[0].xyw, ClipPos[1].xyw, ClipPos[2].xyw)) > 0.0f;
+
+	// fetch material input, masked pixels are already clipped in depth pre pass
+	UHMaterialInputs MaterialInput = GetMaterialInput(UV0);
+
+	float3 BaseColor = MaterialInput.Diffuse;
+	float Occlusion = MaterialInput.Occlusion;
+	float Metallic = MaterialInput.Metallic;
+	float Roughness = MaterialInput.Roughness;
+	float Smoothness = 1.0f - Roughness;
+	uint PackedData = 0;
+
+	BaseColor = BaseColor - BaseColor * Metallic;
+	OutColor = float4(saturate(BaseColor), Occlusion);
+
+	// output normal in [0,1], also be sure to flip normal based on face
+	float3 VertexNormal = normalize(Normals[0] * Bary.Lambda.x + Normals[1] * Bary.Lambda.y + Normals[2] * Bary.Lambda.z);
+	VertexNormal *= (bIsFrontFace) ? 1 : -1;
+
+	float3 BumpNormal = VertexNormal;
+#if TANGENT_SPACE
+	float3x3 WorldTBN = WorldTBNs[0] * Bary.Lambda.x + WorldTBNs[1] * Bary.Lambda.y + WorldTBNs[2] * Bary.Lambda.z;
+	BumpNormal = mul(MaterialInput.Normal, WorldTBN);
+	BumpNormal *= (bIsFrontFace) ? 1 : -1;
+	PackedData |= UH_HAS_BUMP;
+#endif
+
+	// output specular color and smoothness
+	float3 Specular = ComputeSpecularColor(MaterialInput.Specular, MaterialInput.Diffuse, Metallic);
+	OutMaterial = float4(Specular, Smoothness);
+
+	// output emissive color and fresnel factor
+	OutEmissive = float4(MaterialInput.Emissive.rgb, MaterialInput.FresnelFactor);
+
+	// store the max change rate of UV for mip outside pixel shader
+	OutMip = max(length(GUV0Ddx), length(GUV0Ddy));
+
+	OutData = PackedData;
+	OutNormal = float4(EncodeNormal(BumpNormal), UH_OPAQUE_MASK);
+}
@@ -0,0 +1,35 @@
+// vertex shader of visibility buffer material resolve
+// the draw is issued with indirect args, every 6 vertices expand a screen tile of current material to a quad
+#include "UHInputs.hlsli"
+
+ByteAddressBuffer TileList : register(t5);
+
+struct VisibilityResolveConstants
+{
+    uint MaterialIndex;
+};
+[[vk::push_constant]] VisibilityResolveConstants Constants;
+
+static const float2 GTileCorners[6] =
+{
+    float2(0.0f, 1.0f),
+    float2(0.0f, 0.0f),
+    float2(1.0f, 0.0f),
+    float2(0.0f, 1.0f),
+    float2(1.0f, 0.0f),
+    float2(1.0f, 1.0f)
+};
+
+float4 VisibilityResolveVS(uint Vid : SV_VertexID) : SV_POSITION
+{
+    uint2 TileSize = uint2(UHTHREAD_GROUP2D_X, UHTHREAD_GROUP2D_Y);
+    uint2 TileCount = (uint2(GResolution.xy) + TileSize - 1) / TileSize;
+    uint PackedTile = TileList.Load((Constants.MaterialIndex * TileCount.x * TileCount.y + Vid / 6) * 4);
+    uint2 Tile = uint2(PackedTile & 0xffff, PackedTile >> 16);
+
+    // clamp the tiles at the edge, and convert to NDC with Y at left upper corner
+    float2 Pixel = min((float2(Tile) + GTileCorners[Vid % 6]) * float2(TileSize), GResolution.xy);
+    float2 UV = Pixel * GResolution.zw;
+
+    return float4(2.0f * UV.x - 1.0f, 2.0f * UV.y - 1.0f, 0.0f, 1.0f);
+}
@@ -1,5 +1,9 @@
 // UnheardEngine.cpp : Defines the entry point for the application.
 #include "Runtime/Application.h"
+#if WITH_TESTS
+#include "Runtime/Renderer/RenderGraphTest.h"
+#include "Runtime/Classes/AccelerationStructureTest.h"
+#endif
 
 #ifdef _WIN32
 #include <Windows.h>
@@ -9,9 +13,43 @@ int APIENTRY wWinMain(_In_ HINSTANCE hInstance,
     _In_ int       nCmdShow)
 {
 #else
-int main()
+int main(int argc, char* argv[])
 {
 #endif
     UHApplication App;
+
+#ifndef _WIN32
+#if WITH_TESTS
+    // CPU validation of render graph compiler, no window or device is created
+    if (argc > 1 && std::string(argv[1]) == "-validategraph")
+    {
+        return UHRenderGraphTest::Run() ? 0 : 1;
+    }
+
+    // CPU validation of top level AS instance tracking
+    if (argc > 1 && std::string(argv[1]) == "-validatetopas")
+    {
+        return UHAccelerationStructureTest::Run() ? 0 : 1;
+    }
+#endif
+
+    // command line is only parsed for the Linux target for now, e.g. benchmark mode
+    // offscreen arguments are consumed first, the rest goes to benchmark parser
+    UHHeadlessSettings HeadlessSettings;
+    std::vector<char*> BenchmarkArgs;
+    if (!UHHeadless::ParseCommandLine(argc, argv, HeadlessSettings, BenchmarkArgs))
+    {
+        return 1;
+    }
+
+    UHBenchmarkSettings BenchmarkSettings;
+    if (!UHBenchmark::ParseCommandLine(static_cast<int32_t>(BenchmarkArgs.size()), BenchmarkArgs.data(), BenchmarkSettings))
+    {
+        return 1;
+    }
+    App.SetBenchmarkSettings(BenchmarkSettings);
+    App.SetHeadlessSettings(HeadlessSettings);
+#endif
+
     return App.Run();
 }
@@ -13,9 +13,9 @@
 
 #if WITH_EDITOR
 	#define LogMessage( str ) OutputDebugString( str );
-#elif LINUX_DEBUG
+#elif LINUX_DEBUG || WITH_COOKER
 	#include <iostream>
-	// Linux Debug
+	// Linux Debug, the cooker is a command line tool so it always logs
 	#define LogMessage( str ) std::cout << str;
 #else
 	#define LogMessage( str )
@@ -40,7 +40,7 @@ inline std::mutex GLogMutex;
 
 inline void UHE_LOG(std::string InString)
 {
-#if LINUX_DEBUG
+#if LINUX_DEBUG || WITH_COOKER
 	LogMessage(InString.c_str());
 #endif
 
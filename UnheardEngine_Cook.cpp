@@ -0,0 +1,14 @@
+// UnheardEngine_Cook.cpp : Defines the entry point for the standalone asset cooker.
+#include "Cook/Classes/AssetCooker.h"
+
+int main(int argc, char* argv[])
+{
+    UHCookSettings Settings;
+    if (!UHAssetCooker::ParseCommandLine(argc, argv, Settings))
+    {
+        return 1;
+    }
+
+    UHAssetCooker Cooker(Settings);
+    return Cooker.Run() ? 0 : 1;
+}